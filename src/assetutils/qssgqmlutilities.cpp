@@ -12,7 +12,8 @@
 #include <QRegularExpression>
 #include <QtCore/qdir.h>
 #include <QtCore/qfile.h>
-#include <QtCore/qbuffer.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qthreadpool.h>
 
 #include <QtGui/qimage.h>
 #include <QtGui/qimagereader.h>
@@ -27,6 +28,8 @@
 #include <QtQuickTimeline/private/qquicktimeline_p.h>
 #endif // QT_QUICK3D_ENABLE_RT_ANIMATIONS
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 using namespace Qt::StringLiterals;
@@ -392,6 +395,9 @@ struct OutputContext
     Type type = NodeTree;
     quint8 options = Options::None;
     quint16 scopeDepth = 0;
+    // Directory with the mesh files written up front, named by index in the
+    // mesh storage, see serializeMeshes().
+    QString serializedMeshDir;
 };
 
 template<QSSGSceneDesc::Material::RuntimeType T>
@@ -805,7 +811,32 @@ QString asString(QSSGSceneDesc::Animation::Channel::TargetProperty prop)
     return QStringLiteral("unknown");
 }
 
-static std::pair<QString, QString> meshAssetName(const QSSGSceneDesc::Scene &scene, const QSSGSceneDesc::Mesh &meshNode, const QDir &outdir)
+static QString serializedMeshPath(const QString &dir, qsizetype index)
+{
+    return dir + QDir::separator() + QString::number(index) + QStringLiteral(".mesh");
+}
+
+static void serializeMeshes(const QSSGSceneDesc::Scene::MeshStorage &meshStorage, const QString &dir, int workerCount)
+{
+    // Each mesh is written to a file of its own as soon as it is done, so
+    // that only the meshes being written are held in memory. The files are
+    // moved to their final names when the mesh is referenced.
+    QThreadPool pool;
+    if (workerCount > 0)
+        pool.setMaxThreadCount(workerCount);
+    for (qsizetype i = 0, end = meshStorage.size(); i != end; ++i) {
+        pool.start([&meshStorage, path = serializedMeshPath(dir, i), i] {
+            QFile file(path);
+            if (!file.open(QIODevice::WriteOnly))
+                return;
+            if (meshStorage.at(i).save(&file) == 0)
+                file.remove();
+        });
+    }
+    pool.waitForDone();
+}
+
+static std::pair<QString, QString> meshAssetName(const QSSGSceneDesc::Scene &scene, const QSSGSceneDesc::Mesh &meshNode, const OutputContext &output)
 {
     // Returns {name, notValidReason}
 
@@ -814,6 +845,7 @@ static std::pair<QString, QString> meshAssetName(const QSSGSceneDesc::Scene &sce
     const auto meshSourceName = QSSGQmlUtilities::getMeshSourceName(meshId);
     Q_ASSERT(scene.meshStorage.size() > meshNode.idx);
     const auto &mesh = scene.meshStorage.at(meshNode.idx);
+    const QDir &outdir = output.outdir;
 
            // If a mesh folder does not exist, then create one
     if (!outdir.exists(meshFolder) && !outdir.mkdir(meshFolder)) {
@@ -822,14 +854,22 @@ static std::pair<QString, QString> meshAssetName(const QSSGSceneDesc::Scene &sce
     }
 
     const QString path = outdir.path() + QDir::separator() + meshSourceName;
+    if (!output.serializedMeshDir.isEmpty()) {
+        const QString serializedPath = serializedMeshPath(output.serializedMeshDir, meshNode.idx);
+        if (QFile::exists(serializedPath)) {
+            QFile::remove(path);
+            if (QFile::rename(serializedPath, path))
+                return {meshSourceName, QString()};
+        }
+    }
+
     QFile file(path);
     if (!file.open(QIODevice::WriteOnly)) {
         return {QString(), QStringLiteral("Failed to find mesh at ") + path};
     }
 
-    if (mesh.save(&file) == 0) {
+    if (mesh.save(&file) == 0)
         return {};
-    }
 
     return {meshSourceName, QString()};
 };
@@ -1062,7 +1102,7 @@ static ValueToQmlResult valueToQml(const QSSGSceneDesc::Node &target, const QSSG
             Q_ASSERT(meshNode->nodeType == QSSGSceneDesc::Node::Type::Mesh);
             Q_ASSERT(meshNode->scene);
             const auto &scene = *meshNode->scene;
-            const auto& [meshSourceName, notValidReason] = meshAssetName(scene, *meshNode, output.outdir);
+            const auto& [meshSourceName, notValidReason] = meshAssetName(scene, *meshNode, output);
             result.notValidReason = notValidReason;
             if (!meshSourceName.isEmpty()) {
                 result.value = toQuotedString(meshSourceName);
@@ -1601,6 +1641,20 @@ void writeQml(const QSSGSceneDesc::Scene &scene, QTextStream &stream, const QDir
 
     OutputContext output { stream, outdir, scene.sourceDir, 0, OutputContext::Header, outputOptions };
 
+    // Created next to the output, so that the files can be moved rather than
+    // copied. Removed along with the meshes that were never referenced.
+    std::unique_ptr<QTemporaryDir> serializedMeshDir;
+    if (scene.meshStorage.size() > 1) {
+        int meshWorkerCount = 0;
+        if (auto it = options.constFind(QLatin1String("meshWorkerCount")), end = options.constEnd(); it != end)
+            meshWorkerCount = qMax(0, it->isObject() ? it->toObject().value(QLatin1String("value")).toInt() : it->toInt());
+        serializedMeshDir = std::make_unique<QTemporaryDir>(outdir.filePath(QStringLiteral(".meshes-XXXXXX")));
+        if (serializedMeshDir->isValid()) {
+            output.serializedMeshDir = serializedMeshDir->path();
+            serializeMeshes(scene.meshStorage, output.serializedMeshDir, meshWorkerCount);
+        }
+    }
+
     writeImportHeader(output, scene.animations.count() > 0);
 
     output.type = OutputContext::RootNode;
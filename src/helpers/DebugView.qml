@@ -130,6 +130,10 @@ Pane {
                             text: root.source.renderStats.drawVertexCount + " vertices"
                             visible: root.resourceDetailsVisible
                         }
+                        Label {
+                            text: root.source.renderStats.bufferBindCount + " vertex and index buffer binds"
+                            visible: root.resourceDetailsVisible
+                        }
                         Label {
                             text: "Image assets: " + (root.source.renderStats.imageDataSize / 1024).toFixed(2) + " KB"
                             visible: root.resourceDetailsVisible
@@ -138,6 +142,13 @@ Pane {
                             text: "Mesh assets: " + (root.source.renderStats.meshDataSize / 1024).toFixed(2) + " KB"
                             visible: root.resourceDetailsVisible
                         }
+                        Label {
+                            text: "Mesh pool: " + root.source.renderStats.meshPoolAllocationCount + " meshes in "
+                                  + root.source.renderStats.meshPoolBufferCount + " buffers, "
+                                  + (root.source.renderStats.meshPoolUsedSize / 1024).toFixed(2) + " of "
+                                  + (root.source.renderStats.meshPoolReservedSize / 1024).toFixed(2) + " KB used"
+                            visible: root.resourceDetailsVisible && root.source.renderStats.meshPoolBufferCount > 0
+                        }
                         Label {
                             text: "Pipelines: " + root.source.renderStats.pipelineCount
                             visible: root.resourceDetailsVisible
@@ -190,6 +201,9 @@ Pane {
                             ListElement {
                                 columnWidth: 60 // draw calls
                             }
+                            ListElement {
+                                columnWidth: 60 // buffer binds
+                            }
                         }
                         Item {
                             Layout.fillHeight: true
@@ -197,8 +211,8 @@ Pane {
                             TableView {
                                 id: passesTableView
                                 anchors.fill: parent
-                                // name, size, vertices, draw calls
-                                property var columnFactors: [58, 14, 12, 12]; // == 96, leave space for the scrollbar
+                                // name, size, vertices, draw calls, buffer binds
+                                property var columnFactors: [48, 12, 12, 12, 12]; // == 96, leave space for the scrollbar
                                 columnWidthProvider: function (column) {
                                     return passesPane.width * (columnFactors[column] / 100.0);
                                 }
@@ -249,7 +263,7 @@ Pane {
                                 id: texturesTableView
                                 anchors.fill: parent
                                 // name, size, format, miplevels, flags
-                                property var columnFactors: [48, 12, 12, 12, 12]; // == 96, leave space for the scrollbar
+                                property var columnFactors: [40, 12, 12, 10, 12, 10]; // == 96, leave space for the scrollbar
                                 columnWidthProvider: function (column) {
                                     return texturesPane.width * (columnFactors[column] / 100.0);
                                 }
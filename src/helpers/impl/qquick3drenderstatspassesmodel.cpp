@@ -21,7 +21,7 @@ int QQuick3DRenderStatsPassesModel::rowCount(const QModelIndex &parent) const
 int QQuick3DRenderStatsPassesModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return 4;
+    return 5;
 }
 
 QVariant QQuick3DRenderStatsPassesModel::data(const QModelIndex &index, int role) const
@@ -45,6 +45,9 @@ QVariant QQuick3DRenderStatsPassesModel::data(const QModelIndex &index, int role
         // DrawCalls 3
         if (column == 3)
             return m_data[row].drawCalls;
+        // BufferBinds 4
+        if (column == 4)
+            return m_data[row].bufferBinds;
     }
 
     return QVariant();
@@ -52,7 +55,7 @@ QVariant QQuick3DRenderStatsPassesModel::data(const QModelIndex &index, int role
 
 QVariant QQuick3DRenderStatsPassesModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section > 4)
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section > 5)
         return QVariant();
 
     switch (section) {
@@ -64,6 +67,8 @@ QVariant QQuick3DRenderStatsPassesModel::headerData(int section, Qt::Orientation
         return QStringLiteral("Vertices");
     case 3:
         return QStringLiteral("Draw Calls");
+    case 4:
+        return QStringLiteral("Buffer Binds");
     default:
         Q_UNREACHABLE();
         return QVariant();
@@ -91,7 +96,7 @@ void QQuick3DRenderStatsPassesModel::setPassData(const QString &newPassData)
             for (qsizetype i = 2; i < lines.size(); ++i) {
                 const auto &line = lines.at(i);
                 auto fields = line.split(QLatin1Char('|'), Qt::SkipEmptyParts);
-                if (fields.size() != 4)
+                if (fields.size() != 5)
                     continue;
                 Data data;
                 bool isUInt64 = false;
@@ -104,6 +109,9 @@ void QQuick3DRenderStatsPassesModel::setPassData(const QString &newPassData)
                 data.drawCalls = fields[3].toULong(&isUint32);
                 if (!isUint32)
                     continue;
+                data.bufferBinds = fields[4].toULongLong(&isUInt64);
+                if (!isUInt64)
+                    continue;
                 newData.append(data);
             }
         }
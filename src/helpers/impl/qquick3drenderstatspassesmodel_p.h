@@ -47,6 +47,7 @@ private:
         QString size;
         quint64 vertices;
         quint32 drawCalls;
+        quint64 bufferBinds;
     };
     QVector<Data> m_data;
     QString m_passData;
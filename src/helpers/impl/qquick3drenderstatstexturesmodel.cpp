@@ -21,7 +21,7 @@ int QQuick3DRenderStatsTexturesModel::rowCount(const QModelIndex &parent) const
 int QQuick3DRenderStatsTexturesModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return 5;
+    return 6;
 }
 
 QVariant QQuick3DRenderStatsTexturesModel::data(const QModelIndex &index, int role) const
@@ -45,8 +45,11 @@ QVariant QQuick3DRenderStatsTexturesModel::data(const QModelIndex &index, int ro
         // Mip Levels 3
         if (column == 3)
             return m_data[row].mipLevels;
-        // Flags 4
+        // Load Time 4
         if (column == 4)
+            return m_data[row].loadTime;
+        // Flags 5
+        if (column == 5)
             return m_data[row].flags;
     }
 
@@ -55,7 +58,7 @@ QVariant QQuick3DRenderStatsTexturesModel::data(const QModelIndex &index, int ro
 
 QVariant QQuick3DRenderStatsTexturesModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section > 5)
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section > 6)
         return QVariant();
 
     switch (section) {
@@ -68,6 +71,8 @@ QVariant QQuick3DRenderStatsTexturesModel::headerData(int section, Qt::Orientati
     case 3:
         return QStringLiteral("Mip Levels");
     case 4:
+        return QStringLiteral("Load Time");
+    case 5:
         return QStringLiteral("Flags");
     default:
         Q_UNREACHABLE();
@@ -96,7 +101,7 @@ void QQuick3DRenderStatsTexturesModel::setTextureData(const QString &newTextureD
             for (qsizetype i = 2; i < lines.size(); ++i) {
                 const auto &line = lines.at(i);
                 auto fields = line.split(QLatin1Char('|'), Qt::SkipEmptyParts);
-                if (fields.size() < 4) // flags field can be empty
+                if (fields.size() < 5) // flags field can be empty
                     continue;
                 Data data;
                 bool isUInt32 = false;
@@ -106,8 +111,9 @@ void QQuick3DRenderStatsTexturesModel::setTextureData(const QString &newTextureD
                 data.mipLevels = fields[3].toULong(&isUInt32);
                 if (!isUInt32)
                     continue;
-                if (fields.size() == 5)
-                    data.flags = fields[4];
+                data.loadTime = fields[4];
+                if (fields.size() == 6)
+                    data.flags = fields[5];
                 newData.append(data);
             }
         }
@@ -48,6 +48,7 @@ private:
         QString size;
         QString format;
         quint32 mipLevels;
+        QString loadTime;
         QString flags;
     };
     QVector<Data> m_data;
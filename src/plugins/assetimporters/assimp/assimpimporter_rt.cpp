@@ -7,6 +7,8 @@
 
 #include <QtCore/qurl.h>
 #include <QtCore/qbytearrayalgorithms.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
 #include <QtGui/QQuaternion>
 #include <QtQml/QQmlFile>
 
@@ -136,6 +138,10 @@ struct SceneInfo
         bool generateMeshLODs = false;
         float lodNormalMergeAngle = 60.0;
         float lodNormalSplitAngle = 25.0;
+
+        AssimpUtils::MeshOptimizations meshOptimizations;
+
+        int meshWorkerCount = 0; // 0 is one per core
     };
 
     using MaterialMap = QVarLengthArray<QPair<const aiMaterial *, QSSGSceneDesc::Material *>>;
@@ -150,6 +156,9 @@ struct SceneInfo
     };
     using SkinMap = QVarLengthArray<skinData>;
     using Mesh2SkinMap = QVarLengthArray<qint16>;
+    // Index in the scene's mesh storage and the meshes to combine there. The
+    // mesh data is generated for all of them once the scene is processed.
+    using MeshDataJobs = QVector<QPair<qsizetype, AssimpUtils::MeshList>>;
 
     const aiScene &scene;
     MaterialMap &materialMap;
@@ -158,6 +167,7 @@ struct SceneInfo
     TextureMap &textureMap;
     SkinMap &skinMap;
     Mesh2SkinMap &mesh2skin;
+    MeshDataJobs &meshDataJobs;
     QDir workingDir;
     Options opt;
 };
@@ -1237,8 +1247,6 @@ static void setModelProperties(QSSGSceneDesc::Model &target, const aiNode &sourc
     QVarLengthArray<QSSGSceneDesc::Material *> materials;
     materials.reserve(source.mNumMeshes); // Assumig there's max one material per mesh.
 
-    QString errorString;
-
     const auto ensureMaterial = [&](qsizetype materialIndex) {
         // Get the material for the mesh
         auto &material = materialMap[materialIndex];
@@ -1288,16 +1296,10 @@ static void setModelProperties(QSSGSceneDesc::Model &target, const aiNode &sourc
     };
 
     const auto createMeshNode = [&](const aiString &name) {
-        auto meshData = AssimpUtils::generateMeshData(srcScene,
-                                                      meshes,
-                                                      sceneInfo.opt.useFloatJointIndices,
-                                                      sceneInfo.opt.generateMeshLODs,
-                                                      sceneInfo.opt.lodNormalMergeAngle,
-                                                      sceneInfo.opt.lodNormalSplitAngle,
-                                                      errorString);
-        meshStorage.push_back(std::move(meshData));
+        meshStorage.push_back(QSSGMesh::Mesh());
 
         const auto idx = meshStorage.size() - 1;
+        sceneInfo.meshDataJobs.push_back({ idx, meshes });
         // For multimeshes we'll use the model name, but for single meshes we'll use the mesh name.
         return new QSSGSceneDesc::Mesh(fromAiString(name), idx);
     };
@@ -1670,6 +1672,14 @@ static SceneInfo::Options processSceneOptions(const QJsonObject &optionsObject)
             sceneOptions.lodNormalSplitAngle = 0.0;
         }
     }
+
+    sceneOptions.meshOptimizations.optimizeOverdraw = checkBooleanOption(QStringLiteral("optimizeOverdraw"), options);
+    sceneOptions.meshOptimizations.optimizeVertexFetch = checkBooleanOption(QStringLiteral("optimizeVertexFetch"), options);
+    // Lightmap baking needs 32-bit float normals and UVs
+    sceneOptions.meshOptimizations.quantizeVertexAttributes = checkBooleanOption(QStringLiteral("quantizeVertexAttributes"), options)
+            && !sceneOptions.generateLightmapUV;
+
+    sceneOptions.meshWorkerCount = qMax(0, int(getRealOption(QStringLiteral("meshWorkerCount"), options)));
     return sceneOptions;
 }
 
@@ -1835,8 +1845,10 @@ static QString importImp(const QUrl &url, const QJsonObject &options, QSSGSceneD
     else if (extension == QStringLiteral("fbx"))
         opt.fbxMode = true;
 
+    SceneInfo::MeshDataJobs meshDataJobs;
+
     SceneInfo sceneInfo { *sourceScene, materials, meshes, embeddedTextures,
-                          textureMap, skins, mesh2skin, sourceFile.dir(), opt };
+                          textureMap, skins, mesh2skin, meshDataJobs, sourceFile.dir(), opt };
 
     if (!qFuzzyCompare(opt.globalScaleValue, 1.0f) && !qFuzzyCompare(opt.globalScaleValue, 0.0f)) {
         const auto gscale = opt.globalScaleValue;
@@ -1846,6 +1858,31 @@ static QString importImp(const QUrl &url, const QJsonObject &options, QSSGSceneD
     // Now lets go through the scene
     if (sourceScene->mRootNode)
         processNode(sceneInfo, *sourceScene->mRootNode, *targetScene.root, nodeMap, animatingNodes);
+
+    // Simplification and vertex cache optimization of the meshes are by far
+    // the most expensive part of the import. Each job writes to its own slot in
+    // the mesh storage, so the result does not depend on the worker count.
+    {
+        // The importing thread works on the meshes too, so the pool gets one
+        // thread less than the workers wanted
+        QThreadPool meshThreadPool;
+        const int workerCount = opt.meshWorkerCount > 0 ? opt.meshWorkerCount : QThread::idealThreadCount();
+        meshThreadPool.setMaxThreadCount(qMax(0, workerCount - 1));
+        QSSGMesh::Mesh *meshStorage = targetScene.meshStorage.data();
+        AssimpUtils::parallelFor(&meshThreadPool, meshDataJobs.size(), [&](qsizetype i) {
+            const auto &job = meshDataJobs.at(i);
+            QString errorString;
+            meshStorage[job.first] = AssimpUtils::generateMeshData(*sourceScene,
+                                                                   job.second,
+                                                                   opt.useFloatJointIndices,
+                                                                   opt.generateMeshLODs,
+                                                                   opt.lodNormalMergeAngle,
+                                                                   opt.lodNormalSplitAngle,
+                                                                   opt.meshOptimizations,
+                                                                   errorString,
+                                                                   &meshThreadPool);
+        });
+    }
     // skins
     for (It i = 0, endI = skins.size(); i != endI; ++i) {
         const auto &skin = skins[i];
@@ -7,12 +7,15 @@
 #include <QtCore/qglobal.h>
 #include <QtQuick3DUtils/private/qssgmesh_p.h>
 
+#include <functional>
+
 struct aiScene;
 struct aiMesh;
 
 QT_BEGIN_NAMESPACE
 
 class QString;
+class QThreadPool;
 
 namespace AssimpUtils
 {
@@ -20,13 +23,27 @@ namespace AssimpUtils
 using BoneIndexMap = QHash<QString, qint32>;
 using MeshList = QVector<const aiMesh *>;
 
+// Optional passes on the generated vertex and index data
+struct MeshOptimizations
+{
+    bool optimizeOverdraw = false;
+    bool optimizeVertexFetch = false;
+    bool quantizeVertexAttributes = false; // half float normals, tangents and UVs
+};
+
 QSSGMesh::Mesh generateMeshData(const aiScene &scene,
                                 const MeshList &meshes,
                                 bool useFloatJointIndices,
                                 bool generateLevelsOfDetail,
                                 float normalMergeAngle,
                                 float normalSplitAngle,
-                                QString &errorString);
+                                const MeshOptimizations &optimizations,
+                                QString &errorString,
+                                QThreadPool *threadPool = nullptr);
+
+// Calls fn for 0 to count - 1 on the calling thread and the idle threads of
+// threadPool, serially when threadPool is null. Safe to nest.
+void parallelFor(QThreadPool *threadPool, qsizetype count, const std::function<void(qsizetype)> &fn);
 
 }
 
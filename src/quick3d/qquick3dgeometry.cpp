@@ -388,9 +388,13 @@ void QQuick3DGeometry::setVertexData(const QByteArray &data)
     greater than the current size of the buffer, the overshooting data will
     be ignored.
 
+    As long as nothing else about the geometry changes, such as the stride,
+    the attributes, or the size of the vertex and index data, only the changed
+    ranges are uploaded to the existing graphics buffers.
+
     \note The partial update functions for vertex, index and morph target data
     do not offer any guarantee on how such changes are implemented internally.
-    depending on the underlying implementation, even partial changes may lead
+    Depending on the underlying implementation, even partial changes may lead
     to updating the entire graphics resource.
 */
 void QQuick3DGeometry::setVertexData(int offset, const QByteArray &data)
@@ -402,7 +406,7 @@ void QQuick3DGeometry::setVertexData(int offset, const QByteArray &data)
     const size_t len = qMin(d->m_vertexBuffer.size() - offset, data.size());
     memcpy(d->m_vertexBuffer.data() + offset, data.data(), len);
 
-    d->m_geometryChanged = true;
+    d->markRangeDirty(d->m_dirtyVertexRanges, quint32(offset), quint32(len));
 }
 
 /*!
@@ -469,6 +473,10 @@ void QQuick3DGeometry::setIndexData(const QByteArray &data)
     greater than the current size of the buffer, the overshooting data will
     be ignored.
 
+    As long as nothing else about the geometry changes, such as the stride,
+    the attributes, or the size of the vertex and index data, only the changed
+    ranges are uploaded to the existing graphics buffers.
+
     \note The partial update functions for vertex, index and morph target data
     do not offer any guarantee on how such changes are implemented internally.
     Depending on the underlying implementation, even partial changes may lead
@@ -483,7 +491,7 @@ void QQuick3DGeometry::setIndexData(int offset, const QByteArray &data)
     const size_t len = qMin(d->m_indexBuffer.size() - offset, data.size());
     memcpy(d->m_indexBuffer.data() + offset, data.data(), len);
 
-    d->m_geometryChanged = true;
+    d->markRangeDirty(d->m_dirtyIndexRanges, quint32(offset), quint32(len));
 }
 
 /*!
@@ -951,6 +959,18 @@ QSSGRenderGraphObject *QQuick3DGeometry::updateSpatialNode(QSSGRenderGraphObject
                 geometry->addSubset(s.offset, s.count, s.boundsMin, s.boundsMax, s.name);
         }
         d->m_geometryChanged = false;
+        d->m_dirtyVertexRanges.clear();
+        d->m_dirtyIndexRanges.clear();
+        emit geometryChanged();
+    } else if (!d->m_dirtyVertexRanges.isEmpty() || !d->m_dirtyIndexRanges.isEmpty()) {
+        const QByteArrayView vertexData(d->m_vertexBuffer);
+        for (const auto &range : std::as_const(d->m_dirtyVertexRanges))
+            geometry->updateVertexData(range.offset, vertexData.sliced(range.offset, range.size));
+        const QByteArrayView indexData(d->m_indexBuffer);
+        for (const auto &range : std::as_const(d->m_dirtyIndexRanges))
+            geometry->updateIndexData(range.offset, indexData.sliced(range.offset, range.size));
+        d->m_dirtyVertexRanges.clear();
+        d->m_dirtyIndexRanges.clear();
         emit geometryChanged();
     }
     if (d->m_geometryBoundsChanged) {
@@ -975,6 +995,23 @@ QSSGRenderGraphObject *QQuick3DGeometry::updateSpatialNode(QSSGRenderGraphObject
     return node;
 }
 
+void QQuick3DGeometryPrivate::markRangeDirty(QList<QSSGRenderGeometry::DirtyRange> &ranges, quint32 offset, quint32 size)
+{
+    // A full update is pending anyway
+    if (m_geometryChanged || size == 0)
+        return;
+
+    // Lots of tiny updates between two frames are better handled as a full
+    // update than as a long list of ranges.
+    constexpr qsizetype MaxRangeCount = 256;
+    if (ranges.size() >= MaxRangeCount) {
+        m_geometryChanged = true;
+        return;
+    }
+
+    ranges.append({ offset, size });
+}
+
 QQuick3DGeometry::Attribute::Semantic QQuick3DGeometryPrivate::semanticFromName(const QByteArray &name)
 {
     static QMap<const QByteArray, QQuick3DGeometry::Attribute::Semantic> semanticMap;
@@ -54,6 +54,12 @@ public:
     bool m_geometryBoundsChanged = true;
     bool m_targetChanged = true;
     bool m_usesOldTargetSemantics = false;
+    // Byte ranges changed by the partial update functions since the last
+    // sync. Only used while m_geometryChanged is false.
+    QList<QSSGRenderGeometry::DirtyRange> m_dirtyVertexRanges;
+    QList<QSSGRenderGeometry::DirtyRange> m_dirtyIndexRanges;
+
+    void markRangeDirty(QList<QSSGRenderGeometry::DirtyRange> &ranges, quint32 offset, quint32 size);
 
     static QQuick3DGeometry::Attribute::Semantic semanticFromName(const QByteArray &name);
     static QQuick3DGeometry::Attribute::ComponentType toComponentType(QSSGMesh::Mesh::ComponentType componentType);
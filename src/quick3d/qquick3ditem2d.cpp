@@ -13,8 +13,18 @@
 
 #include <QtGui/rhi/qrhi.h>
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
+// Unique across all the items, so that content cached for an item is never
+// mistaken for the content of a later one at the same address.
+static quint64 nextContentVersion()
+{
+    static std::atomic<quint64> version = 0;
+    return ++version;
+}
+
 /*
 internal
 */
@@ -114,6 +124,7 @@ QSSGRenderGraphObject *QQuick3DItem2D::updateSpatialNode(QSSGRenderGraphObject *
     if (!node) {
         markAllDirty();
         node = new QSSGRenderItem2D();
+        static_cast<QSSGRenderItem2D *>(node)->m_contentVersion = nextContentVersion();
     }
 
     QQuick3DNode::updateSpatialNode(node);
@@ -130,6 +141,19 @@ QSSGRenderGraphObject *QQuick3DItem2D::updateSpatialNode(QSSGRenderGraphObject *
         m_renderer = rc->createRenderer(QSGRendererInterface::RenderMode3D);
         connect(window, &QQuickWindow::sceneGraphInvalidated, this, &QQuick3DItem2D::invalidated, Qt::DirectConnection);
         connect(m_renderer, &QSGAbstractRenderer::sceneGraphChanged, this, &QQuick3DObject::update);
+        // The 2D scene graph is synchronized, and so the signal emitted, on
+        // the render thread. Bump the version right away, the update() above
+        // only gets to the GUI thread after this frame is rendered.
+        connect(
+                m_renderer,
+                &QSGAbstractRenderer::sceneGraphChanged,
+                this,
+                [this]() {
+                    auto itemNode = static_cast<QSSGRenderItem2D *>(QQuick3DObjectPrivate::get(this)->spatialNode);
+                    if (itemNode)
+                        itemNode->m_contentVersion = nextContentVersion();
+                },
+                Qt::DirectConnection);
 
         // item2D rendernode has its own render pass descriptor and it should
         // be removed before deleting rhi context.
@@ -174,6 +198,7 @@ QSSGRenderGraphObject *QQuick3DItem2D::updateSpatialNode(QSSGRenderGraphObject *
     }
 
     itemNode->m_renderer = m_renderer;
+    itemNode->m_contentRect = m_contentItem->childrenRect();
 
     return node;
 }
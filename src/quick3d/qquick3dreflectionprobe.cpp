@@ -82,6 +82,16 @@ QColor QQuick3DReflectionProbe::clearColor() const
 
     The default value is \c ReflectionProbe.EveryFrame
     \note Use \c ReflectionProbe.FirstFrame for improved performance.
+
+    Probes with \c ReflectionProbe.FirstFrame can also be baked ahead of time:
+    running the application with the \c{--bake-reflection-probes} command line
+    argument, or with the \c QT_QUICK3D_BAKE_REFLECTION_PROBES environment
+    variable set to \c 1, renders and prefilters them once, writes the result
+    to \c{qrp_<key>.ktx} files, and exits. The files are written to the
+    directory given in \c QT_QUICK3D_REFLECTION_PROBE_BAKE_PATH, or the current
+    directory, and are loaded from there at run time instead of rendering the
+    probe. The key is derived from the contents of the scene, so a probe whose
+    surroundings have changed since it was baked is rendered as usual.
 */
 QQuick3DReflectionProbe::ReflectionRefreshMode QQuick3DReflectionProbe::refreshMode() const
 {
@@ -99,6 +99,284 @@ float QQuick3DRenderStats::maxFrameTime() const
     return m_maxFrameTime;
 }
 
+/*!
+    \qmlproperty int QtQuick3D::RenderStats::frameTimeWindow
+
+    This property holds the number of most recent frames frameTimeP50,
+    frameTimeP95, frameTimeP99 and frameTimeHistogram are calculated from.
+
+    The default value is 240.
+
+    \since 6.9
+*/
+int QQuick3DRenderStats::frameTimeWindow() const
+{
+    return m_frameTimeWindow.load(std::memory_order_relaxed);
+}
+
+void QQuick3DRenderStats::setFrameTimeWindow(int frameCount)
+{
+    frameCount = qMax(1, frameCount);
+    if (m_frameTimeWindow.load(std::memory_order_relaxed) == frameCount)
+        return;
+
+    // applied on the render thread with the next frame
+    m_frameTimeWindow.store(frameCount, std::memory_order_relaxed);
+    emit frameTimeWindowChanged();
+}
+
+/*!
+    \qmlproperty float QtQuick3D::RenderStats::frameTimeP50
+    \readonly
+
+    This property holds the median of frameTime over the last frameTimeWindow
+    frames, in milliseconds.
+
+    \since 6.9
+    \sa frameTimeP95, frameTimeP99
+*/
+float QQuick3DRenderStats::frameTimeP50() const
+{
+    return m_notifiedResults.frameTimePercentiles.p50;
+}
+
+/*!
+    \qmlproperty float QtQuick3D::RenderStats::frameTimeP95
+    \readonly
+
+    This property holds the 95th percentile of frameTime over the last
+    frameTimeWindow frames, in milliseconds: 5% of the frames took longer.
+
+    \since 6.9
+    \sa frameTimeP50, frameTimeP99
+*/
+float QQuick3DRenderStats::frameTimeP95() const
+{
+    return m_notifiedResults.frameTimePercentiles.p95;
+}
+
+/*!
+    \qmlproperty float QtQuick3D::RenderStats::frameTimeP99
+    \readonly
+
+    This property holds the 99th percentile of frameTime over the last
+    frameTimeWindow frames, in milliseconds. Unlike maxFrameTime it ignores
+    the slowest 1% of the frames, while still showing uneven frame pacing.
+
+    \since 6.9
+    \sa frameTimeP50, frameTimeP95
+*/
+float QQuick3DRenderStats::frameTimeP99() const
+{
+    return m_notifiedResults.frameTimePercentiles.p99;
+}
+
+/*!
+    \qmlproperty list<int> QtQuick3D::RenderStats::frameTimeHistogram
+    \readonly
+
+    This property holds the number of frames by frame time over the last
+    frameTimeWindow frames. Each of the 26 entries covers 4 milliseconds, the
+    first one frames faster than 4 ms, the second one frames from 4 ms up to 8
+    ms, and so on. The last entry holds all frames that took 100 ms or more.
+
+    \since 6.9
+*/
+QList<int> QQuick3DRenderStats::frameTimeHistogram() const
+{
+    return m_notifiedResults.frameTimeHistogram;
+}
+
+/*!
+    \qmlproperty float QtQuick3D::RenderStats::hitchThreshold
+
+    This property holds the frame time, in milliseconds, above which a frame is
+    recorded in \l hitches.
+
+    The default value is 33.3, missing the display refresh twice at 60 Hz.
+
+    \since 6.9
+*/
+float QQuick3DRenderStats::hitchThreshold() const
+{
+    return m_hitchThreshold.load(std::memory_order_relaxed);
+}
+
+void QQuick3DRenderStats::setHitchThreshold(float msecs)
+{
+    if (qFuzzyCompare(m_hitchThreshold.load(std::memory_order_relaxed), msecs))
+        return;
+    m_hitchThreshold.store(msecs, std::memory_order_relaxed);
+    emit hitchThresholdChanged();
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::hitchUploadThreshold
+
+    This property holds the size in bytes from which texture and mesh uploads
+    are listed with the events of a hitch. Smaller uploads are left out.
+
+    The default value is 1048576, 1 MB.
+
+    \since 6.9
+    \sa hitches
+*/
+quint64 QQuick3DRenderStats::hitchUploadThreshold() const
+{
+    return m_hitchUploadThreshold.load(std::memory_order_relaxed);
+}
+
+void QQuick3DRenderStats::setHitchUploadThreshold(quint64 bytes)
+{
+    if (m_hitchUploadThreshold.load(std::memory_order_relaxed) == bytes)
+        return;
+    m_hitchUploadThreshold.store(bytes, std::memory_order_relaxed);
+    emit hitchUploadThresholdChanged();
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::hitchCount
+    \readonly
+
+    This property holds the number of frames that took longer than
+    hitchThreshold since rendering started.
+
+    \since 6.9
+    \sa hitches
+*/
+quint64 QQuick3DRenderStats::hitchCount() const
+{
+    return m_notifiedResults.hitchCount;
+}
+
+static QString expensiveEventTypeName(QSSGRhiContextStats::ExpensiveEventInfo::Type type)
+{
+    switch (type) {
+    case QSSGRhiContextStats::ExpensiveEventInfo::PipelineCreation:
+        return QStringLiteral("pipelineCreation");
+    case QSSGRhiContextStats::ExpensiveEventInfo::ShaderGeneration:
+        return QStringLiteral("shaderGeneration");
+    case QSSGRhiContextStats::ExpensiveEventInfo::TextureUpload:
+        return QStringLiteral("textureUpload");
+    case QSSGRhiContextStats::ExpensiveEventInfo::MeshUpload:
+        return QStringLiteral("meshUpload");
+    case QSSGRhiContextStats::ExpensiveEventInfo::BvhBuild:
+        return QStringLiteral("bvhBuild");
+    }
+    return QString();
+}
+
+/*!
+    \qmlproperty list<var> QtQuick3D::RenderStats::hitches
+    \readonly
+
+    This property holds the most recent frames, up to 32, that took longer
+    than hitchThreshold. Each entry has the following properties:
+
+    \list
+    \li \c frame - the number of the frame, counted from the first frame
+    \li \c frameTime - the time of the frame in milliseconds
+    \li \c events - the expensive work done in the frame
+    \endlist
+
+    Each of the events has a \c type, one of \c pipelineCreation, \c
+    shaderGeneration, \c textureUpload, \c meshUpload and \c bvhBuild, the
+    \c name of the resource where known, the \c time it took in milliseconds,
+    and for uploads the \c size in bytes. Uploads smaller than
+    hitchUploadThreshold are not listed.
+
+    The events are collected only when extendedDataCollectionEnabled is
+    enabled, otherwise the list of events is empty.
+
+    \since 6.9
+*/
+QVariantList QQuick3DRenderStats::hitches() const
+{
+    QVariantList result;
+    for (const Hitch &hitch : m_notifiedResults.hitches) {
+        QVariantList events;
+        for (const auto &event : hitch.events) {
+            QVariantMap map;
+            map.insert(QStringLiteral("type"), expensiveEventTypeName(event.type));
+            map.insert(QStringLiteral("name"), QString::fromUtf8(event.name));
+            map.insert(QStringLiteral("time"), event.time / 1000000.0);
+            if (event.size)
+                map.insert(QStringLiteral("size"), event.size);
+            events.append(map);
+        }
+        QVariantMap map;
+        map.insert(QStringLiteral("frame"), hitch.frame);
+        map.insert(QStringLiteral("frameTime"), hitch.frameTime);
+        map.insert(QStringLiteral("events"), events);
+        result.append(map);
+    }
+    return result;
+}
+
+/*!
+    \internal
+
+    Returns the most recent frames that took longer than hitchThreshold, the
+    C++ counterpart of \l hitches.
+*/
+QList<QQuick3DRenderStats::Hitch> QQuick3DRenderStats::hitchList() const
+{
+    return m_notifiedResults.hitches;
+}
+
+void QQuick3DRenderStats::processHitch()
+{
+    // Take the events of this frame in any case, so they are not
+    // attributed to a later frame
+    if (!m_contextStats)
+        return;
+    const auto &events = m_contextStats->expensiveEvents;
+    const quint64 offset = m_contextStats->expensiveEventOffset;
+    const quint64 end = offset + quint64(events.size());
+    const quint64 first = qMax(m_expensiveEventCursor, offset); // the rest was dropped unseen
+    m_expensiveEventCursor = end;
+
+    if (m_results.frameTime <= m_hitchThreshold.load(std::memory_order_relaxed))
+        return;
+
+    const quint64 uploadThreshold = m_hitchUploadThreshold.load(std::memory_order_relaxed);
+    Hitch hitch;
+    hitch.frame = m_renderedFrameCount;
+    hitch.frameTime = m_results.frameTime;
+    for (quint64 i = first; i < end; ++i) {
+        const auto &event = events.at(qsizetype(i - offset));
+        const bool upload = event.type == QSSGRhiContextStats::ExpensiveEventInfo::TextureUpload
+                || event.type == QSSGRhiContextStats::ExpensiveEventInfo::MeshUpload;
+        if (!upload || event.size >= uploadThreshold)
+            hitch.events.append(event);
+    }
+
+    ++m_results.hitchCount;
+    m_results.hitches.append(hitch);
+    if (m_results.hitches.size() > MaxHitchCount)
+        m_results.hitches.removeFirst();
+}
+
+void QQuick3DRenderStats::notifyFrameTimeDistribution()
+{
+    m_results.frameTimePercentiles = { m_frameTimeHistory.percentile(50) / 1000.0f,
+                                       m_frameTimeHistory.percentile(95) / 1000.0f,
+                                       m_frameTimeHistory.percentile(99) / 1000.0f };
+    QList<int> histogram(FrameTimeHistogramBucketCount, 0);
+    for (qint64 usecs : m_frameTimeHistory.samples())
+        ++histogram[qMin(int(usecs / (FrameTimeHistogramBucketSize * 1000)), FrameTimeHistogramBucketCount - 1)];
+    m_results.frameTimeHistogram = histogram;
+
+    if (m_results.frameTimeHistogram != m_notifiedResults.frameTimeHistogram
+            || m_results.frameTimePercentiles.p50 != m_notifiedResults.frameTimePercentiles.p50
+            || m_results.frameTimePercentiles.p95 != m_notifiedResults.frameTimePercentiles.p95
+            || m_results.frameTimePercentiles.p99 != m_notifiedResults.frameTimePercentiles.p99) {
+        m_notifiedResults.frameTimePercentiles = m_results.frameTimePercentiles;
+        m_notifiedResults.frameTimeHistogram = m_results.frameTimeHistogram;
+        emit frameTimeDistributionChanged();
+    }
+}
+
 float QQuick3DRenderStats::timestamp() const
 {
     return m_frameTimer.nsecsElapsed() / 1000000.0f;
@@ -164,6 +442,13 @@ void QQuick3DRenderStats::onFrameSwapped()
 
         m_results.renderTime = m_results.frameTime - m_renderStartTime;
 
+        ++m_renderedFrameCount;
+        const int frameTimeWindow = m_frameTimeWindow.load(std::memory_order_relaxed);
+        if (m_frameTimeHistory.capacity() != frameTimeWindow)
+            m_frameTimeHistory = QSSGRhiContextStats::TimingHistory(frameTimeWindow);
+        m_frameTimeHistory.add(qint64(m_results.frameTime * 1000.0f));
+        processHitch();
+
         processRhiContextStats();
 
         if (m_window) {
@@ -172,8 +457,10 @@ void QQuick3DRenderStats::onFrameSwapped()
                 QRhiCommandBuffer *cb = sc->currentFrameCommandBuffer();
                 if (cb) {
                     const float msecs = float(cb->lastCompletedGpuTime() * 1000.0);
-                    if (!qFuzzyIsNull(msecs))
+                    if (!qFuzzyIsNull(msecs)) {
                         m_results.lastCompletedGpuTime = msecs;
+                        m_gpuTimeHistory.add(qint64(cb->lastCompletedGpuTime() * 1000000000.0));
+                    }
                 }
             }
         }
@@ -203,6 +490,14 @@ void QQuick3DRenderStats::onFrameSwapped()
                 emit lastCompletedGpuTimeChanged();
             }
 
+            notifyFrameTimeDistribution();
+
+            if (m_results.hitchCount != m_notifiedResults.hitchCount) {
+                m_notifiedResults.hitchCount = m_results.hitchCount;
+                m_notifiedResults.hitches = m_results.hitches;
+                emit hitchesChanged();
+            }
+
             notifyRhiContextStats();
         }
 
@@ -231,7 +526,12 @@ void QQuick3DRenderStats::setRhiContext(QSSGRhiContext *ctx, QSSGRenderLayer *la
     // called from synchronize(), so on the render thread with gui blocked
 
     m_layer = layer;
-    m_contextStats = &QSSGRhiContextStats::get(*ctx);
+    QSSGRhiContextStats *contextStats = &QSSGRhiContextStats::get(*ctx);
+    if (m_contextStats != contextStats) {
+        // Only what happens from now on belongs to the frames measured here
+        m_expensiveEventCursor = contextStats->expensiveEventOffset + quint64(contextStats->expensiveEvents.size());
+        m_contextStats = contextStats;
+    }
 
     // setExtendedDataCollectionEnabled will likely get called at some point
     // before this (so too early), sync the flag here as well now that we know
@@ -397,12 +697,20 @@ static const char *textureFormatStr(QRhiTexture::Format format)
 
 static inline void printRenderPassDetails(QString *dst, const QSSGRhiContextStats::RenderPassInfo &rp)
 {
-    *dst += QString::asprintf("| %s | %dx%d | %llu | %llu |\n",
+    *dst += QString::asprintf("| %s | %dx%d | %llu | %llu | %llu |\n",
                               rp.rtName.constData(),
                               rp.pixelSize.width(),
                               rp.pixelSize.height(),
                               QSSGRhiContextStats::totalVertexCountForPass(rp),
-                              QSSGRhiContextStats::totalDrawCallCountForPass(rp));
+                              QSSGRhiContextStats::totalDrawCallCountForPass(rp),
+                              rp.bufferBindCount);
+}
+
+static QQuick3DRenderStats::TimingPercentiles timingPercentiles(const QSSGRhiContextStats::TimingHistory &history)
+{
+    return { history.percentile(50) / 1000000.0f,
+             history.percentile(95) / 1000000.0f,
+             history.percentile(99) / 1000000.0f };
 }
 
 static inline QByteArray nameForRenderMesh(const QSSGRenderMesh *mesh)
@@ -434,12 +742,15 @@ void QQuick3DRenderStats::processRhiContextStats()
 
     m_results.drawCallCount = 0;
     m_results.drawVertexCount = 0;
+    m_results.bufferBindCount = 0;
     for (const auto &pass : data.renderPasses) {
         m_results.drawCallCount += QSSGRhiContextStats::totalDrawCallCountForPass(pass);
         m_results.drawVertexCount += QSSGRhiContextStats::totalVertexCountForPass(pass);
+        m_results.bufferBindCount += pass.bufferBindCount;
     }
     m_results.drawCallCount += QSSGRhiContextStats::totalDrawCallCountForPass(data.externalRenderPass);
     m_results.drawVertexCount += QSSGRhiContextStats::totalVertexCountForPass(data.externalRenderPass);
+    m_results.bufferBindCount += data.externalRenderPass.bufferBindCount;
 
     m_results.imageDataSize = globalData.imageDataSize;
     m_results.meshDataSize = globalData.meshDataSize;
@@ -448,8 +759,8 @@ void QQuick3DRenderStats::processRhiContextStats()
             + (data.externalRenderPass.pixelSize.isEmpty() ? 0 : 1);
 
     QString renderPassDetails = QLatin1String(R"(
-| Name | Size | Vertices | Draw calls |
-| ---- | ---- | -------- | ---------- |
+| Name | Size | Vertices | Draw calls | Buffer binds |
+| ---- | ---- | -------- | ---------- | ------------ |
 )");
 
     if (!data.externalRenderPass.pixelSize.isEmpty())
@@ -461,11 +772,81 @@ void QQuick3DRenderStats::processRhiContextStats()
     renderPassDetails += QString::asprintf("\nGenerated from QSSGRenderLayer %p", m_layer);
     m_results.renderPassDetails = renderPassDetails;
 
+    if (data.reflectionProbes.isEmpty()) {
+        m_results.reflectionProbeDetails.clear();
+    } else {
+        QString reflectionProbeDetails = QLatin1String(R"(
+| Name | Age (frames) | Faces rendered | Priority |
+| ---- | ------------ | -------------- | -------- |
+)");
+        for (const auto &probe : data.reflectionProbes) {
+            reflectionProbeDetails += QString::asprintf("| %s | %u | %d | %.2f |\n",
+                                                        probe.name.constData(),
+                                                        probe.age,
+                                                        probe.renderedFaceCount,
+                                                        probe.priority);
+        }
+        reflectionProbeDetails += QString::asprintf("\nGenerated from QSSGRenderLayer %p", m_layer);
+        m_results.reflectionProbeDetails = reflectionProbeDetails;
+    }
+
+    if (data.item2DAtlas.atlasSize.isEmpty()) {
+        m_results.item2DAtlasDetails.clear();
+    } else {
+        const auto &atlas = data.item2DAtlas;
+        const qint64 atlasPixelCount = qint64(atlas.atlasSize.width()) * atlas.atlasSize.height();
+        QString item2DAtlasDetails = QLatin1String(R"(
+| Atlas size | Cached items | Rendered items | Inline items | Used |
+| ---------- | ------------ | -------------- | ------------ | ---- |
+)");
+        item2DAtlasDetails += QString::asprintf("| %dx%d | %d | %d | %d | %.1f%% |\n",
+                                                atlas.atlasSize.width(),
+                                                atlas.atlasSize.height(),
+                                                atlas.cachedItemCount,
+                                                atlas.renderedItemCount,
+                                                atlas.inlineItemCount,
+                                                100.0 * double(atlas.usedPixelCount) / double(atlasPixelCount));
+        item2DAtlasDetails += QString::asprintf("\nGenerated from QSSGRenderLayer %p", m_layer);
+        m_results.item2DAtlasDetails = item2DAtlasDetails;
+    }
+
+    m_results.passTimings.clear();
+    m_results.passTimingDetails.clear();
+    m_results.gpuTimePercentiles = timingPercentiles(m_gpuTimeHistory);
+    if (!data.passTimings.isEmpty()) {
+        QString passTimingDetails = QLatin1String(R"(
+| Pass | Prepare (ms) | Record (ms) | p50 (ms) | p95 (ms) | p99 (ms) |
+| ---- | ------------ | ----------- | -------- | -------- | -------- |
+)");
+        for (const auto &pass : data.passTimings) {
+            const PassTiming timing { pass.name,
+                                      pass.prepareTime / 1000000.0f,
+                                      pass.recordTime / 1000000.0f,
+                                      timingPercentiles(data.passTimingHistory.value(pass.name)) };
+            passTimingDetails += QString::asprintf("| %s | %.3f | %.3f | %.3f | %.3f | %.3f |\n",
+                                                   timing.name.constData(),
+                                                   timing.prepareTime,
+                                                   timing.recordTime,
+                                                   timing.totalTime.p50,
+                                                   timing.totalTime.p95,
+                                                   timing.totalTime.p99);
+            m_results.passTimings.append(timing);
+        }
+        if (m_gpuTimeHistory.size()) {
+            passTimingDetails += QString::asprintf("\nGPU frame time: p50 %.3f ms, p95 %.3f ms, p99 %.3f ms\n",
+                                                   m_results.gpuTimePercentiles.p50,
+                                                   m_results.gpuTimePercentiles.p95,
+                                                   m_results.gpuTimePercentiles.p99);
+        }
+        passTimingDetails += QString::asprintf("\nGenerated from QSSGRenderLayer %p", m_layer);
+        m_results.passTimingDetails = passTimingDetails;
+    }
+
     if (m_results.activeTextures != textures) {
         m_results.activeTextures = textures;
         QString texDetails = QLatin1String(R"(
-| Name | Size | Format | Mip | Flags |
-| ---- | ---- | ------ | --- | ----- |
+| Name | Size | Format | Mip | Load | Flags |
+| ---- | ---- | ------ | --- | ---- | ----- |
 )");
         QList<QRhiTexture *> textureList = textures.values();
         std::sort(textureList.begin(), textureList.end(), [](QRhiTexture *a, QRhiTexture *b) {
@@ -479,12 +860,20 @@ void QQuick3DRenderStats::processRhiContextStats()
             QByteArray flagMsg;
             if (flags.testFlag(QRhiTexture::CubeMap))
                 flagMsg += QByteArrayLiteral("[cube]");
-            texDetails += QString::asprintf("| %s | %dx%d | %s | %d | %s |\n",
+            QByteArray loadMsg = QByteArrayLiteral("-");
+            const auto load = m_contextStats->textureLoads.constFind(tex);
+            if (load != m_contextStats->textureLoads.cend()) {
+                loadMsg = QByteArray::number(load->loadTime / 1000.0, 'f', 2) + QByteArrayLiteral(" ms");
+                if (load->cooked)
+                    flagMsg += QByteArrayLiteral("[cooked]");
+            }
+            texDetails += QString::asprintf("| %s | %dx%d | %s | %d | %s | %s |\n",
                                             tex->name().constData(),
                                             tex->pixelSize().width(),
                                             tex->pixelSize().height(),
                                             textureFormatStr(tex->format()),
                                             mipCount,
+                                            loadMsg.constData(),
                                             flagMsg.constData());
         }
         texDetails += QString::asprintf("\nAsset textures registered with QSSGRhiContext %p", m_contextStats->rhiCtx);
@@ -511,12 +900,18 @@ void QQuick3DRenderStats::processRhiContextStats()
                 for (const QSSGRenderSubset &subset : std::as_const(mesh->subsets))
                     vertexCount += subset.count;
                 // submeshes ref into the same vertex and index buffer
-                const QSSGRhiBuffer *vbuf = mesh->subsets[0].rhi.vertexBuffer.get();
-                if (vbuf)
-                    vbufSize = vbuf->buffer()->size();
-                const QSSGRhiBuffer *ibuf = mesh->subsets[0].rhi.indexBuffer.get();
-                if (ibuf)
-                    ibufSize = ibuf->buffer()->size();
+                if (mesh->pooledVertexData.isValid()) {
+                    // only a part of a shared buffer
+                    vbufSize = mesh->pooledVertexData.size;
+                    ibufSize = mesh->pooledIndexData.size;
+                } else {
+                    const QSSGRhiBuffer *vbuf = mesh->subsets[0].rhi.vertexBuffer.get();
+                    if (vbuf)
+                        vbufSize = vbuf->buffer()->size();
+                    const QSSGRhiBuffer *ibuf = mesh->subsets[0].rhi.indexBuffer.get();
+                    if (ibuf)
+                        ibufSize = ibuf->buffer()->size();
+                }
             }
             meshDetails += QString::asprintf("| %s | %d | %llu | %u | %u |\n",
                                              name.constData(),
@@ -535,6 +930,17 @@ void QQuick3DRenderStats::processRhiContextStats()
     m_results.materialGenerationTime = m_contextStats->globalInfo.materialGenerationTime;
     m_results.effectGenerationTime = m_contextStats->globalInfo.effectGenerationTime;
 
+    m_results.residencyCacheHits = globalData.residencyHits;
+    m_results.residencyCacheMisses = globalData.residencyMisses;
+    m_results.residencyCacheEvictions = globalData.residencyEvictions;
+    m_results.residencyCacheSize = globalData.residencyCachedSize;
+    m_results.geometryUploadSize = globalData.geometryUploadedSize;
+    m_results.geometryPartialUpdateCount = globalData.geometryPartialUpdates;
+    m_results.meshPoolBufferCount = globalData.meshPoolBufferCount;
+    m_results.meshPoolAllocationCount = globalData.meshPoolAllocationCount;
+    m_results.meshPoolReservedSize = globalData.meshPoolReservedSize;
+    m_results.meshPoolUsedSize = globalData.meshPoolUsedSize;
+
     m_results.rhiStats = m_contextStats->rhiCtx->rhi()->statistics();
 }
 
@@ -553,6 +959,11 @@ void QQuick3DRenderStats::notifyRhiContextStats()
         emit drawVertexCountChanged();
     }
 
+    if (m_results.bufferBindCount != m_notifiedResults.bufferBindCount) {
+        m_notifiedResults.bufferBindCount = m_results.bufferBindCount;
+        emit bufferBindCountChanged();
+    }
+
     if (m_results.imageDataSize != m_notifiedResults.imageDataSize) {
         m_notifiedResults.imageDataSize = m_results.imageDataSize;
         emit imageDataSizeChanged();
@@ -583,6 +994,23 @@ void QQuick3DRenderStats::notifyRhiContextStats()
         emit meshDetailsChanged();
     }
 
+    if (m_results.reflectionProbeDetails != m_notifiedResults.reflectionProbeDetails) {
+        m_notifiedResults.reflectionProbeDetails = m_results.reflectionProbeDetails;
+        emit reflectionProbeDetailsChanged();
+    }
+
+    if (m_results.item2DAtlasDetails != m_notifiedResults.item2DAtlasDetails) {
+        m_notifiedResults.item2DAtlasDetails = m_results.item2DAtlasDetails;
+        emit item2DAtlasDetailsChanged();
+    }
+
+    if (m_results.passTimingDetails != m_notifiedResults.passTimingDetails) {
+        m_notifiedResults.passTimingDetails = m_results.passTimingDetails;
+        m_notifiedResults.passTimings = m_results.passTimings;
+        m_notifiedResults.gpuTimePercentiles = m_results.gpuTimePercentiles;
+        emit passTimingsChanged();
+    }
+
     if (m_results.pipelineCount != m_notifiedResults.pipelineCount) {
         m_notifiedResults.pipelineCount = m_results.pipelineCount;
         emit pipelineCountChanged();
@@ -598,6 +1026,47 @@ void QQuick3DRenderStats::notifyRhiContextStats()
         emit effectGenerationTimeChanged();
     }
 
+    if (m_results.residencyCacheHits != m_notifiedResults.residencyCacheHits) {
+        m_notifiedResults.residencyCacheHits = m_results.residencyCacheHits;
+        emit residencyCacheHitsChanged();
+    }
+
+    if (m_results.residencyCacheMisses != m_notifiedResults.residencyCacheMisses) {
+        m_notifiedResults.residencyCacheMisses = m_results.residencyCacheMisses;
+        emit residencyCacheMissesChanged();
+    }
+
+    if (m_results.residencyCacheEvictions != m_notifiedResults.residencyCacheEvictions) {
+        m_notifiedResults.residencyCacheEvictions = m_results.residencyCacheEvictions;
+        emit residencyCacheEvictionsChanged();
+    }
+
+    if (m_results.residencyCacheSize != m_notifiedResults.residencyCacheSize) {
+        m_notifiedResults.residencyCacheSize = m_results.residencyCacheSize;
+        emit residencyCacheSizeChanged();
+    }
+
+    if (m_results.geometryUploadSize != m_notifiedResults.geometryUploadSize) {
+        m_notifiedResults.geometryUploadSize = m_results.geometryUploadSize;
+        emit geometryUploadSizeChanged();
+    }
+
+    if (m_results.geometryPartialUpdateCount != m_notifiedResults.geometryPartialUpdateCount) {
+        m_notifiedResults.geometryPartialUpdateCount = m_results.geometryPartialUpdateCount;
+        emit geometryPartialUpdateCountChanged();
+    }
+
+    if (m_results.meshPoolBufferCount != m_notifiedResults.meshPoolBufferCount
+            || m_results.meshPoolAllocationCount != m_notifiedResults.meshPoolAllocationCount
+            || m_results.meshPoolReservedSize != m_notifiedResults.meshPoolReservedSize
+            || m_results.meshPoolUsedSize != m_notifiedResults.meshPoolUsedSize) {
+        m_notifiedResults.meshPoolBufferCount = m_results.meshPoolBufferCount;
+        m_notifiedResults.meshPoolAllocationCount = m_results.meshPoolAllocationCount;
+        m_notifiedResults.meshPoolReservedSize = m_results.meshPoolReservedSize;
+        m_notifiedResults.meshPoolUsedSize = m_results.meshPoolUsedSize;
+        emit meshPoolChanged();
+    }
+
     if (m_results.rhiStats.totalPipelineCreationTime != m_notifiedResults.rhiStats.totalPipelineCreationTime) {
         m_notifiedResults.rhiStats.totalPipelineCreationTime = m_results.rhiStats.totalPipelineCreationTime;
         emit pipelineCreationTimeChanged();
@@ -652,6 +1121,28 @@ quint64 QQuick3DRenderStats::drawVertexCount() const
     return m_results.drawVertexCount;
 }
 
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::bufferBindCount
+    \readonly
+
+    This property holds the number of times a different vertex or index buffer
+    got bound for the draw calls that were registered during the last render of
+    the \l View3D. Binding the same buffers again for consecutive draw calls is
+    not counted.
+
+    When mesh buffer pooling is enabled, meshes sharing a pool buffer can be
+    drawn without rebinding, which shows as a value lower than drawCallCount.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.9
+    \sa meshPoolBufferCount
+*/
+quint64 QQuick3DRenderStats::bufferBindCount() const
+{
+    return m_results.bufferBindCount;
+}
+
 /*!
     \qmlproperty quint64 QtQuick3D::RenderStats::imageDataSize
     \readonly
@@ -751,6 +1242,90 @@ QString QQuick3DRenderStats::meshDetails() const
     return m_results.meshDetails;
 }
 
+/*!
+    \qmlproperty string QtQuick3D::RenderStats::reflectionProbeDetails
+    \readonly
+
+    This property holds a table of the reflection probes that render their
+    cube map, with the number of frames since each was last updated, the
+    number of cube faces it rendered in the last frame and its priority
+    when the probe updates are limited to a per-frame budget.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \internal
+    \since 6.9
+*/
+QString QQuick3DRenderStats::reflectionProbeDetails() const
+{
+    return m_results.reflectionProbeDetails;
+}
+
+/*!
+    \qmlproperty string QtQuick3D::RenderStats::item2DAtlasDetails
+    \readonly
+
+    This property holds a table with the usage of the texture atlas the 2D
+    content of Item2Ds is cached in, when the caching is enabled: the number
+    of items in the atlas, how many of them were rendered again in the last
+    frame because their content changed, how many did not fit and were
+    rendered inline, and the share of the atlas in use.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \internal
+    \since 6.9
+*/
+QString QQuick3DRenderStats::item2DAtlasDetails() const
+{
+    return m_results.item2DAtlasDetails;
+}
+
+/*!
+    \qmlproperty string QtQuick3D::RenderStats::passTimingDetails
+    \readonly
+
+    This property holds a table with the CPU time spent on each render pass of
+    the View3D in the last frame, split into preparing the pass and recording
+    its commands, followed by percentiles of the sum of the two over the last
+    240 frames. Post-processing effects are listed as one pass. When the
+    graphics API reports it, the percentiles of the GPU time of the whole frame
+    are included as well, the time of individual passes on the GPU is not
+    available.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \internal
+    \since 6.9
+*/
+QString QQuick3DRenderStats::passTimingDetails() const
+{
+    return m_notifiedResults.passTimingDetails;
+}
+
+/*!
+    \internal
+
+    Returns the per-pass timings in the order the passes ran, the C++
+    counterpart of passTimingDetails. Like the other values, these are updated
+    at most every 200 ms, passTimingsChanged() is emitted when they change.
+*/
+QList<QQuick3DRenderStats::PassTiming> QQuick3DRenderStats::passTimings() const
+{
+    return m_notifiedResults.passTimings;
+}
+
+/*!
+    \internal
+
+    Returns the percentiles of lastCompletedGpuTime over the last 240 frames,
+    all zero when the graphics API does not report GPU times.
+*/
+QQuick3DRenderStats::TimingPercentiles QQuick3DRenderStats::gpuTimePercentiles() const
+{
+    return m_notifiedResults.gpuTimePercentiles;
+}
+
 /*!
     \qmlproperty int QtQuick3D::RenderStats::pipelineCount
     \readonly
@@ -943,6 +1518,211 @@ float QQuick3DRenderStats::lastCompletedGpuTime() const
     return m_results.lastCompletedGpuTime;
 }
 
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::residencyCacheHits
+    \readonly
+
+    This property holds the number of times a mesh or texture that was no
+    longer referenced by the scene, but was kept resident due to the residency
+    budget, got used again without having to be reloaded and re-uploaded.
+
+    The residency budget is disabled by default. It can be enabled by setting
+    the environment variable \c QT_QUICK3D_RESIDENCY_BUDGET_MB to the number of
+    megabytes of mesh and texture data that is allowed to stay resident.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis. If there are
+    multiple View3D instances within the same window, the DebugView shows the
+    same value for all those View3Ds.
+
+    \since 6.9
+*/
+quint64 QQuick3DRenderStats::residencyCacheHits() const
+{
+    return m_results.residencyCacheHits;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::residencyCacheMisses
+    \readonly
+
+    This property holds the number of times a mesh or texture had to be loaded
+    and uploaded because it was not resident.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa residencyCacheHits
+*/
+quint64 QQuick3DRenderStats::residencyCacheMisses() const
+{
+    return m_results.residencyCacheMisses;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::residencyCacheEvictions
+    \readonly
+
+    This property holds the number of unreferenced meshes and textures that
+    were released, in least recently used order, because the total size of the
+    mesh and texture data exceeded the residency budget.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa residencyCacheHits
+*/
+quint64 QQuick3DRenderStats::residencyCacheEvictions() const
+{
+    return m_results.residencyCacheEvictions;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::residencyCacheSize
+    \readonly
+
+    This property holds the approximate size in bytes of the mesh and texture
+    data that is not referenced by the scene anymore, but is kept resident.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa residencyCacheHits
+*/
+quint64 QQuick3DRenderStats::residencyCacheSize() const
+{
+    return m_results.residencyCacheSize;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::geometryUploadSize
+    \readonly
+
+    This property holds the total number of bytes of vertex and index data
+    that was uploaded for custom geometry (QQuick3DGeometry) so far.
+
+    When only parts of the data are changed with the partial update functions
+    of QQuick3DGeometry, only the changed ranges are uploaded, and this value
+    grows only by their size.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa geometryPartialUpdateCount
+*/
+quint64 QQuick3DRenderStats::geometryUploadSize() const
+{
+    return m_results.geometryUploadSize;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::geometryPartialUpdateCount
+    \readonly
+
+    This property holds the number of times the graphics buffers of custom
+    geometry were updated in place by uploading only the changed ranges,
+    instead of being recreated.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa geometryUploadSize
+*/
+quint64 QQuick3DRenderStats::geometryPartialUpdateCount() const
+{
+    return m_results.geometryPartialUpdateCount;
+}
+
+/*!
+    \qmlproperty quint32 QtQuick3D::RenderStats::meshPoolBufferCount
+    \readonly
+
+    This property holds the number of shared vertex and index buffers that
+    mesh data is sub-allocated from.
+
+    Mesh buffer pooling is disabled by default. It can be enabled by setting
+    the environment variable \c QT_QUICK3D_MESH_BUFFER_POOLING to \c 1.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa meshPoolAllocationCount, meshPoolReservedSize, meshPoolUsedSize
+*/
+quint32 QQuick3DRenderStats::meshPoolBufferCount() const
+{
+    return m_results.meshPoolBufferCount;
+}
+
+/*!
+    \qmlproperty quint32 QtQuick3D::RenderStats::meshPoolAllocationCount
+    \readonly
+
+    This property holds the number of vertex and index data ranges that are
+    allocated from the shared mesh buffers.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa meshPoolBufferCount
+*/
+quint32 QQuick3DRenderStats::meshPoolAllocationCount() const
+{
+    return m_results.meshPoolAllocationCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::meshPoolReservedSize
+    \readonly
+
+    This property holds the total size in bytes of the shared mesh buffers.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa meshPoolUsedSize
+*/
+quint64 QQuick3DRenderStats::meshPoolReservedSize() const
+{
+    return m_results.meshPoolReservedSize;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::meshPoolUsedSize
+    \readonly
+
+    This property holds the number of bytes of the shared mesh buffers that
+    are allocated to meshes. The difference to meshPoolReservedSize is free
+    space within the buffers.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \note The value is reported on a per-QQuickWindow basis.
+
+    \since 6.9
+    \sa meshPoolReservedSize
+*/
+quint64 QQuick3DRenderStats::meshPoolUsedSize() const
+{
+    return m_results.meshPoolUsedSize;
+}
+
 /*!
     \internal
  */
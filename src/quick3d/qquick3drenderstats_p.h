@@ -17,9 +17,12 @@
 
 #include <QtQuick3D/qtquick3dglobal.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qvariant.h>
 #include <ssg/qssgrendercontextcore.h>
 #include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 struct QSSGRenderLayer;
@@ -34,16 +37,29 @@ class Q_QUICK3D_EXPORT QQuick3DRenderStats : public QObject
     Q_PROPERTY(float renderPrepareTime READ renderPrepareTime NOTIFY renderTimeChanged)
     Q_PROPERTY(float syncTime READ syncTime NOTIFY syncTimeChanged)
     Q_PROPERTY(float maxFrameTime READ maxFrameTime NOTIFY maxFrameTimeChanged)
+    Q_PROPERTY(int frameTimeWindow READ frameTimeWindow WRITE setFrameTimeWindow NOTIFY frameTimeWindowChanged)
+    Q_PROPERTY(float frameTimeP50 READ frameTimeP50 NOTIFY frameTimeDistributionChanged)
+    Q_PROPERTY(float frameTimeP95 READ frameTimeP95 NOTIFY frameTimeDistributionChanged)
+    Q_PROPERTY(float frameTimeP99 READ frameTimeP99 NOTIFY frameTimeDistributionChanged)
+    Q_PROPERTY(QList<int> frameTimeHistogram READ frameTimeHistogram NOTIFY frameTimeDistributionChanged)
+    Q_PROPERTY(float hitchThreshold READ hitchThreshold WRITE setHitchThreshold NOTIFY hitchThresholdChanged)
+    Q_PROPERTY(quint64 hitchUploadThreshold READ hitchUploadThreshold WRITE setHitchUploadThreshold NOTIFY hitchUploadThresholdChanged)
+    Q_PROPERTY(quint64 hitchCount READ hitchCount NOTIFY hitchesChanged)
+    Q_PROPERTY(QVariantList hitches READ hitches NOTIFY hitchesChanged)
 
     Q_PROPERTY(bool extendedDataCollectionEnabled READ extendedDataCollectionEnabled WRITE setExtendedDataCollectionEnabled NOTIFY extendedDataCollectionEnabledChanged)
     Q_PROPERTY(quint64 drawCallCount READ drawCallCount NOTIFY drawCallCountChanged)
     Q_PROPERTY(quint64 drawVertexCount READ drawVertexCount NOTIFY drawVertexCountChanged)
+    Q_PROPERTY(quint64 bufferBindCount READ bufferBindCount NOTIFY bufferBindCountChanged)
     Q_PROPERTY(quint64 imageDataSize READ imageDataSize NOTIFY imageDataSizeChanged)
     Q_PROPERTY(quint64 meshDataSize READ meshDataSize NOTIFY meshDataSizeChanged)
     Q_PROPERTY(int renderPassCount READ renderPassCount NOTIFY renderPassCountChanged)
     Q_PROPERTY(QString renderPassDetails READ renderPassDetails NOTIFY renderPassDetailsChanged)
     Q_PROPERTY(QString textureDetails READ textureDetails NOTIFY textureDetailsChanged)
     Q_PROPERTY(QString meshDetails READ meshDetails NOTIFY meshDetailsChanged)
+    Q_PROPERTY(QString reflectionProbeDetails READ reflectionProbeDetails NOTIFY reflectionProbeDetailsChanged)
+    Q_PROPERTY(QString item2DAtlasDetails READ item2DAtlasDetails NOTIFY item2DAtlasDetailsChanged)
+    Q_PROPERTY(QString passTimingDetails READ passTimingDetails NOTIFY passTimingsChanged)
     Q_PROPERTY(int pipelineCount READ pipelineCount NOTIFY pipelineCountChanged)
     Q_PROPERTY(qint64 materialGenerationTime READ materialGenerationTime NOTIFY materialGenerationTimeChanged)
     Q_PROPERTY(qint64 effectGenerationTime READ effectGenerationTime NOTIFY effectGenerationTimeChanged)
@@ -52,8 +68,43 @@ class Q_QUICK3D_EXPORT QQuick3DRenderStats : public QObject
     Q_PROPERTY(quint64 vmemUsedBytes READ vmemUsedBytes NOTIFY vmemUsedBytesChanged)
     Q_PROPERTY(QString graphicsApiName READ graphicsApiName NOTIFY graphicsApiNameChanged)
     Q_PROPERTY(float lastCompletedGpuTime READ lastCompletedGpuTime NOTIFY lastCompletedGpuTimeChanged)
+    Q_PROPERTY(quint64 residencyCacheHits READ residencyCacheHits NOTIFY residencyCacheHitsChanged)
+    Q_PROPERTY(quint64 residencyCacheMisses READ residencyCacheMisses NOTIFY residencyCacheMissesChanged)
+    Q_PROPERTY(quint64 residencyCacheEvictions READ residencyCacheEvictions NOTIFY residencyCacheEvictionsChanged)
+    Q_PROPERTY(quint64 residencyCacheSize READ residencyCacheSize NOTIFY residencyCacheSizeChanged)
+    Q_PROPERTY(quint64 geometryUploadSize READ geometryUploadSize NOTIFY geometryUploadSizeChanged)
+    Q_PROPERTY(quint64 geometryPartialUpdateCount READ geometryPartialUpdateCount NOTIFY geometryPartialUpdateCountChanged)
+    Q_PROPERTY(quint32 meshPoolBufferCount READ meshPoolBufferCount NOTIFY meshPoolChanged)
+    Q_PROPERTY(quint32 meshPoolAllocationCount READ meshPoolAllocationCount NOTIFY meshPoolChanged)
+    Q_PROPERTY(quint64 meshPoolReservedSize READ meshPoolReservedSize NOTIFY meshPoolChanged)
+    Q_PROPERTY(quint64 meshPoolUsedSize READ meshPoolUsedSize NOTIFY meshPoolChanged)
 
 public:
+    // Times in milliseconds
+    struct TimingPercentiles {
+        float p50 = 0;
+        float p95 = 0;
+        float p99 = 0;
+    };
+    struct PassTiming {
+        QByteArray name;
+        float prepareTime = 0; // in the last frame
+        float recordTime = 0; // in the last frame
+        TimingPercentiles totalTime; // prepareTime + recordTime over the last frames
+    };
+    // A frame that took longer than hitchThreshold
+    struct Hitch {
+        quint64 frame = 0; // counted from the first frame rendered
+        float frameTime = 0;
+        // The expensive events in the frame, uploads only when they are at
+        // least hitchUploadThreshold bytes
+        QList<QSSGRhiContextStats::ExpensiveEventInfo> events;
+    };
+
+    static constexpr int FrameTimeHistogramBucketSize = 4; // milliseconds
+    static constexpr int FrameTimeHistogramBucketCount = 26; // the last one holds all frames from 100 ms
+    static constexpr int MaxHitchCount = 32; // most recent ones kept
+
     QQuick3DRenderStats(QObject *parent = nullptr);
 
     int fps() const;
@@ -63,6 +114,20 @@ public:
     float syncTime() const;
     float maxFrameTime() const;
 
+    int frameTimeWindow() const;
+    void setFrameTimeWindow(int frameCount);
+    float frameTimeP50() const;
+    float frameTimeP95() const;
+    float frameTimeP99() const;
+    QList<int> frameTimeHistogram() const;
+    float hitchThreshold() const;
+    void setHitchThreshold(float msecs);
+    quint64 hitchUploadThreshold() const;
+    void setHitchUploadThreshold(quint64 bytes);
+    quint64 hitchCount() const;
+    QVariantList hitches() const;
+    QList<Hitch> hitchList() const;
+
     void startSync();
     void endSync(bool dump = false);
 
@@ -78,12 +143,18 @@ public:
 
     quint64 drawCallCount() const;
     quint64 drawVertexCount() const;
+    quint64 bufferBindCount() const;
     quint64 imageDataSize() const;
     quint64 meshDataSize() const;
     int renderPassCount() const;
     QString renderPassDetails() const;
     QString textureDetails() const;
     QString meshDetails() const;
+    QString reflectionProbeDetails() const;
+    QString item2DAtlasDetails() const;
+    QString passTimingDetails() const;
+    QList<PassTiming> passTimings() const;
+    TimingPercentiles gpuTimePercentiles() const;
     int pipelineCount() const;
     qint64 materialGenerationTime() const;
     qint64 effectGenerationTime() const;
@@ -92,6 +163,16 @@ public:
     quint64 vmemUsedBytes() const;
     QString graphicsApiName() const;
     float lastCompletedGpuTime() const;
+    quint64 residencyCacheHits() const;
+    quint64 residencyCacheMisses() const;
+    quint64 residencyCacheEvictions() const;
+    quint64 residencyCacheSize() const;
+    quint64 geometryUploadSize() const;
+    quint64 geometryPartialUpdateCount() const;
+    quint32 meshPoolBufferCount() const;
+    quint32 meshPoolAllocationCount() const;
+    quint64 meshPoolReservedSize() const;
+    quint64 meshPoolUsedSize() const;
 
     Q_INVOKABLE void releaseCachedResources();
 
@@ -103,15 +184,24 @@ Q_SIGNALS:
     void renderTimeChanged();
     void syncTimeChanged();
     void maxFrameTimeChanged();
+    void frameTimeWindowChanged();
+    void frameTimeDistributionChanged();
+    void hitchThresholdChanged();
+    void hitchUploadThresholdChanged();
+    void hitchesChanged();
     void extendedDataCollectionEnabledChanged();
     void drawCallCountChanged();
     void drawVertexCountChanged();
+    void bufferBindCountChanged();
     void imageDataSizeChanged();
     void meshDataSizeChanged();
     void renderPassCountChanged();
     void renderPassDetailsChanged();
     void textureDetailsChanged();
     void meshDetailsChanged();
+    void reflectionProbeDetailsChanged();
+    void item2DAtlasDetailsChanged();
+    void passTimingsChanged();
     void pipelineCountChanged();
     void materialGenerationTimeChanged();
     void effectGenerationTimeChanged();
@@ -120,6 +210,13 @@ Q_SIGNALS:
     void vmemUsedBytesChanged();
     void graphicsApiNameChanged();
     void lastCompletedGpuTimeChanged();
+    void residencyCacheHitsChanged();
+    void residencyCacheMissesChanged();
+    void residencyCacheEvictionsChanged();
+    void residencyCacheSizeChanged();
+    void geometryUploadSizeChanged();
+    void geometryPartialUpdateCountChanged();
+    void meshPoolChanged();
 
 private Q_SLOTS:
     void onFrameSwapped();
@@ -128,6 +225,8 @@ private:
     float timestamp() const;
     void processRhiContextStats();
     void notifyRhiContextStats();
+    void processHitch();
+    void notifyFrameTimeDistribution();
 
     QElapsedTimer m_frameTimer;
     int m_frameCount = 0;
@@ -148,19 +247,39 @@ private:
         float renderPrepareTime = 0;
         float syncTime = 0;
         float lastCompletedGpuTime = 0;
+        TimingPercentiles frameTimePercentiles;
+        QList<int> frameTimeHistogram;
+        quint64 hitchCount = 0;
+        QList<Hitch> hitches;
         quint64 drawCallCount = 0;
         quint64 drawVertexCount = 0;
+        quint64 bufferBindCount = 0;
         quint64 imageDataSize = 0;
         quint64 meshDataSize = 0;
         int renderPassCount = 0;
         QString renderPassDetails;
         QString textureDetails;
         QString meshDetails;
+        QString reflectionProbeDetails;
+        QString item2DAtlasDetails;
+        QString passTimingDetails;
+        QList<PassTiming> passTimings;
+        TimingPercentiles gpuTimePercentiles;
         QSet<QRhiTexture *> activeTextures;
         QSet<QSSGRenderMesh *> activeMeshes;
         int pipelineCount = 0;
         qint64 materialGenerationTime = 0;
         qint64 effectGenerationTime = 0;
+        quint64 residencyCacheHits = 0;
+        quint64 residencyCacheMisses = 0;
+        quint64 residencyCacheEvictions = 0;
+        quint64 residencyCacheSize = 0;
+        quint64 geometryUploadSize = 0;
+        quint64 geometryPartialUpdateCount = 0;
+        quint32 meshPoolBufferCount = 0;
+        quint32 meshPoolAllocationCount = 0;
+        quint64 meshPoolReservedSize = 0;
+        quint64 meshPoolUsedSize = 0;
         QRhiStats rhiStats;
     };
 
@@ -173,6 +292,14 @@ private:
     QQuickWindow *m_window = nullptr;
     bool m_renderingThisFrame = false;
     QString m_graphicsApiName;
+    QSSGRhiContextStats::TimingHistory m_gpuTimeHistory; // nanoseconds
+    QSSGRhiContextStats::TimingHistory m_frameTimeHistory; // microseconds
+    // Set on the main thread, read on the render thread with each frame
+    std::atomic<int> m_frameTimeWindow = QSSGRhiContextStats::TimingHistory::SampleCount;
+    std::atomic<float> m_hitchThreshold = 33.3f;
+    std::atomic<quint64> m_hitchUploadThreshold = 1024 * 1024;
+    quint64 m_renderedFrameCount = 0;
+    quint64 m_expensiveEventCursor = 0; // in QSSGRhiContextStats::expensiveEvents
 };
 
 QT_END_NAMESPACE
@@ -38,6 +38,7 @@
 #include <qtquick3d_tracepoints_p.h>
 
 #include <QtCore/QObject>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qqueue.h>
 
 QT_BEGIN_NAMESPACE
@@ -369,10 +370,13 @@ QRhiTexture *QQuick3DSceneRenderer::renderToRhiTexture(QQuickWindow *qw)
             QRhiTexture *theDepthTexture = theRenderData->getRenderResult(QSSGFrameData::RenderResult::DepthTexture)->texture;
             QVector2D cameraClipRange(m_layer->renderedCameras[0]->clipNear, m_layer->renderedCameras[0]->clipFar);
 
+            QElapsedTimer effectTimer;
+            effectTimer.start();
             currentTexture = m_effectSystem->process(*m_layer->firstEffect,
                                                      currentTexture,
                                                      theDepthTexture,
                                                      cameraClipRange);
+            QSSGRHICTX_STAT(rhiCtx, passRecorded("Effects", effectTimer.nsecsElapsed()));
         }
 
         // The only difference between temporal and progressive AA at this point is that tempAA always
@@ -213,6 +213,8 @@ QT_BEGIN_NAMESPACE
 */
 
 
+static QSSGRenderTextureFormat::Format convertToBackendFormat(QQuick3DTextureData::Format format);
+
 QQuick3DTextureDataPrivate::QQuick3DTextureDataPrivate()
     : QQuick3DObjectPrivate(QQuick3DTextureDataPrivate::Type::TextureData)
 {
@@ -252,6 +254,81 @@ void QQuick3DTextureData::setTextureData(const QByteArray &data)
     Q_D(QQuick3DTextureData);
     d->textureData = data;
     d->textureDataDirty = true;
+    d->dirtyRegions.clear();
+    update();
+}
+
+/*!
+    \since 6.9
+    \overload
+
+    Updates the pixels inside \a rect of the texture data with \a data. For a
+    3D texture \a depthSlice specifies the slice to update.
+
+    \a data must hold the pixels of \a rect in the current \l format, row by
+    row. For 2D textures each row starts at a 4 byte aligned offset, the same
+    way as in the full texture data. Parts of \a rect outside of the texture
+    are ignored.
+
+    As long as the size, the depth and the format of the texture data stay the
+    same, only the changed regions are uploaded to the existing texture. This
+    makes it well suited for data that changes partially every frame, such as
+    video-like content, heat maps or lookup tables. When the texture uses
+    mipmaps, the mip levels still need to be generated again after each
+    update.
+
+    \note Compressed formats are not supported by this function.
+
+    \sa textureData()
+*/
+void QQuick3DTextureData::setTextureData(const QRect &rect, const QByteArray &data, int depthSlice)
+{
+    Q_D(QQuick3DTextureData);
+    const QSSGRenderTextureFormat format = convertToBackendFormat(d->format);
+    if (format.isCompressedTextureFormat()) {
+        qWarning("Partial texture data updates are not supported for compressed formats");
+        return;
+    }
+    if (depthSlice < 0 || depthSlice >= qMax(1, d->depth))
+        return;
+
+    const QRect r = rect.intersected(QRect(QPoint(0, 0), d->size));
+    if (r.isEmpty())
+        return;
+
+    const qsizetype pixelSize = format.getSizeofFormat();
+    const qsizetype lineSize = QSSGRenderTextureData::bytesPerLine(d->size.width(), d->depth, format);
+    const qsizetype rowSize = rect.width() * pixelSize;
+    const qsizetype srcLineSize = d->depth > 0 ? rowSize : (rowSize + 3) & ~3;
+    const qsizetype sliceSize = lineSize * d->size.height();
+    if (d->textureData.size() < sliceSize * qMax(1, d->depth)) {
+        qWarning("Texture data is smaller than its size and format require");
+        return;
+    }
+    if (data.size() < srcLineSize * (rect.height() - 1) + rowSize) {
+        qWarning("Not enough data for the updated region");
+        return;
+    }
+
+    const char *src = data.constData() + (r.y() - rect.y()) * srcLineSize + (r.x() - rect.x()) * pixelSize;
+    char *dst = d->textureData.data() + depthSlice * sliceSize + r.y() * lineSize + r.x() * pixelSize;
+    for (int y = 0; y < r.height(); ++y) {
+        memcpy(dst, src, r.width() * pixelSize);
+        src += srcLineSize;
+        dst += lineSize;
+    }
+
+    if (!d->textureDataDirty) {
+        // Many small updates between two frames are better handled as one
+        // full update.
+        constexpr qsizetype MaxRegionCount = 64;
+        if (d->dirtyRegions.size() >= MaxRegionCount) {
+            d->textureDataDirty = true;
+            d->dirtyRegions.clear();
+        } else {
+            d->dirtyRegions.append({ r, depthSlice });
+        }
+    }
     update();
 }
 
@@ -438,12 +515,24 @@ QSSGRenderGraphObject *QQuick3DTextureData::updateSpatialNode(QSSGRenderGraphObj
 
     bool changed = false;
 
+    // Partial updates only apply when the layout of the data is unchanged
+    const QSSGRenderTextureFormat format = convertToBackendFormat(d->format);
+    if (!d->dirtyRegions.isEmpty()
+            && (d->size != textureData->size() || d->depth != textureData->depth() || format != textureData->format())) {
+        d->textureDataDirty = true;
+    }
+
     // Use a dirty flag so we don't compare large buffer values
     if (d->textureDataDirty) {
         d->textureDataDirty = false;
         textureData->setTextureData(d->textureData);
         changed = true;
+    } else if (!d->dirtyRegions.isEmpty()) {
+        for (const auto &region : std::as_const(d->dirtyRegions))
+            textureData->updateTextureData(region.rect, region.slice, d->textureData);
+        changed = true;
     }
+    d->dirtyRegions.clear();
 
     // Can't use qUpdateIfNeeded unfortunately
     if (d->size != textureData->size()) {
@@ -456,7 +545,6 @@ QSSGRenderGraphObject *QQuick3DTextureData::updateSpatialNode(QSSGRenderGraphObj
         changed = true;
     }
 
-    QSSGRenderTextureFormat format = convertToBackendFormat(d->format);
     if (format != textureData->format()) {
         textureData->setFormat(format);
         changed = true;
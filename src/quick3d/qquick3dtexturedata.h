@@ -65,6 +65,7 @@ public:
 
     const QByteArray textureData() const;
     void setTextureData(const QByteArray &data);
+    void setTextureData(const QRect &rect, const QByteArray &data, int depthSlice = 0);
 
     QSize size() const;
     void setSize(const QSize &size);
@@ -20,6 +20,7 @@
 
 #include <QtQuick3D/QQuick3DTextureData>
 #include <QtQuick3D/private/qquick3dobject_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendertexturedata_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -34,6 +35,9 @@ public:
     QQuick3DTextureData::Format format = QQuick3DTextureData::RGBA8;
     bool hasTransparency = false;
     bool textureDataDirty = false;
+    // Regions changed by the partial update function since the last sync.
+    // Only used while textureDataDirty is false.
+    QList<QSSGRenderTextureData::DirtyRegion> dirtyRegions;
 };
 
 QT_END_NAMESPACE
@@ -517,16 +517,22 @@ void QQuick3DParticleSystem::updateCurrentTime(int currentTime)
     m_updates++;
 
     m_perfTimer.restart();
+    m_lastUpdateTimings = {};
 
     // Emit new particles
     for (auto emitter : std::as_const(m_emitters))
         emitter->emitParticles();
+    qint64 stageEnd = m_perfTimer.nsecsElapsed();
+    m_lastUpdateTimings.emitParticles = stageEnd;
 
     // Prepare Affectors
     for (auto affector : std::as_const(m_affectors)) {
         if (affector->m_enabled)
             affector->prepareToAffect();
     }
+    qint64 stageStart = stageEnd;
+    stageEnd = m_perfTimer.nsecsElapsed();
+    m_lastUpdateTimings.prepareAffectors = stageEnd - stageStart;
 
     // Animate current particles
     for (auto particle : std::as_const(m_particles)) {
@@ -547,19 +553,27 @@ void QQuick3DParticleSystem::updateCurrentTime(int currentTime)
 
         m_particlesMax += particle->maxAmount();
 
+        // Times only the processing of this particle
+        stageStart = m_perfTimer.nsecsElapsed();
         QQuick3DParticleSpriteParticle *spriteParticle = qobject_cast<QQuick3DParticleSpriteParticle *>(particle);
         if (spriteParticle) {
             processSpriteParticle(spriteParticle, trailEmits, timeS);
+            stageEnd = m_perfTimer.nsecsElapsed();
+            m_lastUpdateTimings.spriteParticles += stageEnd - stageStart;
             continue;
         }
         QQuick3DParticleModelParticle *modelParticle = qobject_cast<QQuick3DParticleModelParticle *>(particle);
         if (modelParticle) {
             processModelParticle(modelParticle, trailEmits, timeS);
+            stageEnd = m_perfTimer.nsecsElapsed();
+            m_lastUpdateTimings.modelParticles += stageEnd - stageStart;
             continue;
         }
         QQuick3DParticleModelBlendParticle *mbp = qobject_cast<QQuick3DParticleModelBlendParticle *>(particle);
         if (mbp) {
             processModelBlendParticle(mbp, trailEmits, timeS);
+            stageEnd = m_perfTimer.nsecsElapsed();
+            m_lastUpdateTimings.modelBlendParticles += stageEnd - stageStart;
             continue;
         }
     }
@@ -96,6 +96,17 @@ public:
         int amount = 0;
     };
 
+    // Time spent in each stage of the last updateCurrentTime(), in nanoseconds.
+    // Trail emitting is part of processing the particles they follow.
+    struct UpdateTimings {
+        qint64 emitParticles = 0;
+        qint64 prepareAffectors = 0;
+        qint64 spriteParticles = 0;
+        qint64 modelParticles = 0;
+        qint64 modelBlendParticles = 0;
+    };
+    const UpdateTimings &lastUpdateTimings() const { return m_lastUpdateTimings; }
+
     Q_INVOKABLE void reset();
 
 public Q_SLOTS:
@@ -173,6 +184,7 @@ private:
     QElapsedTimer m_perfTimer;
     QTimer m_loggingTimer;
     qint64 m_timeAnimation = 0;
+    UpdateTimings m_lastUpdateTimings;
     int m_particlesMax = 0;
     int m_particlesUsed = 0;
     int m_updates = 0;
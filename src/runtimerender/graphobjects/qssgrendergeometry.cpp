@@ -181,6 +181,11 @@ uint32_t QSSGRenderGeometry::generationId() const
     return m_generationId;
 }
 
+uint32_t QSSGRenderGeometry::dataGenerationId() const
+{
+    return m_dataGenerationId;
+}
+
 const QSSGMesh::RuntimeMeshData &QSSGRenderGeometry::meshData() const
 {
     return m_meshData;
@@ -204,7 +209,63 @@ void QSSGRenderGeometry::setTargetData(const QByteArray &data)
     markDirty();
 }
 
+static void updateBufferRange(QByteArray &buffer, QList<QSSGRenderGeometry::DirtyRange> &ranges, quint32 offset, QByteArrayView data)
+{
+    if (offset >= quint32(buffer.size()) || data.isEmpty())
+        return;
+
+    const quint32 size = quint32(qMin(qsizetype(buffer.size() - offset), data.size()));
+    memcpy(buffer.data() + offset, data.data(), size);
+
+    // Merge with the last range when they touch, which is the common case for
+    // data that is streamed in sequentially.
+    if (!ranges.isEmpty()) {
+        QSSGRenderGeometry::DirtyRange &last = ranges.last();
+        if (offset <= last.offset + last.size && last.offset <= offset + size) {
+            const quint32 end = qMax(last.offset + last.size, offset + size);
+            last.offset = qMin(last.offset, offset);
+            last.size = end - last.offset;
+            return;
+        }
+    }
+
+    // Many small scattered ranges are cheaper to upload as one
+    constexpr qsizetype MaxRangeCount = 64;
+    if (ranges.size() >= MaxRangeCount) {
+        quint32 start = offset;
+        quint32 end = offset + size;
+        for (const QSSGRenderGeometry::DirtyRange &r : std::as_const(ranges)) {
+            start = qMin(start, r.offset);
+            end = qMax(end, r.offset + r.size);
+        }
+        ranges = { { start, end - start } };
+        return;
+    }
+
+    ranges.append({ offset, size });
+}
+
+void QSSGRenderGeometry::updateVertexData(quint32 offset, QByteArrayView data)
+{
+    updateBufferRange(m_meshData.m_vertexBuffer, m_dirtyVertexRanges, offset, data);
+    m_dataGenerationId++;
+}
+
+void QSSGRenderGeometry::updateIndexData(quint32 offset, QByteArrayView data)
+{
+    updateBufferRange(m_meshData.m_indexBuffer, m_dirtyIndexRanges, offset, data);
+    m_dataGenerationId++;
+}
+
+void QSSGRenderGeometry::clearDirtyRanges()
+{
+    m_dirtyVertexRanges.clear();
+    m_dirtyIndexRanges.clear();
+}
+
 void QSSGRenderGeometry::markDirty()
 {
     m_generationId++;
+    // Everything gets uploaded again, no need to track ranges anymore
+    clearDirtyRanges();
 }
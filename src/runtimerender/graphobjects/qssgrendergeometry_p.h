@@ -22,6 +22,7 @@
 #include <QtQuick3DUtils/private/qssgmesh_p.h>
 
 #include <QtCore/qbytearray.h>
+#include <QtCore/qlist.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -38,6 +39,10 @@ public:
         Attribute attr;
         int stride = 0;
     };
+    struct DirtyRange {
+        quint32 offset = 0; // in bytes
+        quint32 size = 0; // in bytes
+    };
 
     explicit QSSGRenderGeometry();
     virtual ~QSSGRenderGeometry();
@@ -70,6 +75,7 @@ public:
     void clearAttributes();
 
     uint32_t generationId() const;
+    uint32_t dataGenerationId() const;
     const QSSGMesh::RuntimeMeshData &meshData() const;
 
     QString debugObjectName;
@@ -83,12 +89,25 @@ public:
                             int stride = 0);
     void addTargetAttribute(const TargetAttribute &att);
 
+    // Partial updates patch the vertex or index data in place without changing
+    // the generationId. The changed byte ranges are collected until the
+    // buffer manager has uploaded them (or until the next full change, which
+    // invalidates them).
+    void updateVertexData(quint32 offset, QByteArrayView data);
+    void updateIndexData(quint32 offset, QByteArrayView data);
+    const QList<DirtyRange> &dirtyVertexRanges() const { return m_dirtyVertexRanges; }
+    const QList<DirtyRange> &dirtyIndexRanges() const { return m_dirtyIndexRanges; }
+    void clearDirtyRanges();
+
 protected:
     Q_DISABLE_COPY(QSSGRenderGeometry)
 
     void markDirty();
 
     uint32_t m_generationId = 1;
+    uint32_t m_dataGenerationId = 1;
+    QList<DirtyRange> m_dirtyVertexRanges;
+    QList<DirtyRange> m_dirtyIndexRanges;
     QSSGMesh::RuntimeMeshData m_meshData;
     QSSGBounds3 m_bounds;
 };
@@ -20,6 +20,7 @@
 #include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
 
 #include <QtCore/qpointer.h>
+#include <QtCore/qrect.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -38,6 +39,11 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderItem2D : public QSSGRenderNode
     QPointer<QSGRenderer> m_renderer;
     QRhiRenderPassDescriptor *m_rp = nullptr;
 
+    // For caching the rendered content, see QSSGRhiItem2DCache. The version
+    // changes whenever the 2D scene graph of the item does.
+    quint64 m_contentVersion = 0;
+    QRectF m_contentRect;
+
     QSSGRenderItem2D();
     ~QSSGRenderItem2D();
 };
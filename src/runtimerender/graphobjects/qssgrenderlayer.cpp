@@ -9,6 +9,22 @@
 
 QT_BEGIN_NAMESPACE
 
+// The environment is only read once, not for every layer
+static qint32 defaultAoResolutionDivisor()
+{
+    static const qint32 divisor = [] {
+        const int value = qEnvironmentVariableIntValue("QT_QUICK3D_SSAO_RESOLUTION_DIVISOR");
+        return (value == 2 || value == 4) ? value : 1;
+    }();
+    return divisor;
+}
+
+static bool defaultAoTemporalAccumulation()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_QUICK3D_SSAO_TEMPORAL") > 0;
+    return enabled;
+}
+
 QSSGRenderLayer::QSSGRenderLayer()
     : QSSGRenderNode(QSSGRenderNode::Type::Layer)
     , firstEffect(nullptr)
@@ -23,6 +39,9 @@ QSSGRenderLayer::QSSGRenderLayer()
     , tonemapMode(TonemapMode::Linear)
 {
     flags = { FlagT(LocalState::Active) | FlagT(GlobalState::Active) }; // The layer node is alway active and not dirty.
+
+    aoResolutionDivisor = defaultAoResolutionDivisor();
+    aoTemporalAccumulation = defaultAoTemporalAccumulation();
 }
 
 QSSGRenderLayer::~QSSGRenderLayer()
@@ -141,6 +141,13 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderLayer : public QSSGRenderNode
     qint32 aoSamplerate = 2;
     bool aoDither = false;
     bool aoEnabled = false;
+    // 2 and 4 render the occlusion at half and quarter size, followed by a
+    // depth-aware upsampling. Defaults to QT_QUICK3D_SSAO_RESOLUTION_DIVISOR.
+    // Ignored when there is no float render target for the reduced depth.
+    qint32 aoResolutionDivisor = 1;
+    // Blends the occlusion with the reprojected result of the previous
+    // frames. Defaults to QT_QUICK3D_SSAO_TEMPORAL.
+    bool aoTemporalAccumulation = false;
 
     constexpr bool ssaoEnabled() const { return aoEnabled && (aoStrength > 0.0f && aoDistance > 0.0f); }
 
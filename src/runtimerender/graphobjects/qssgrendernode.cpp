@@ -8,6 +8,7 @@
 #include <QtQuick3DUtils/private/qssgutils_p.h>
 
 #include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderskeleton_p.h>
 
 #include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
 
@@ -161,6 +162,15 @@ QMatrix4x4 QSSGRenderNode::calculateTransformMatrix(QVector3D position, QVector3
     return transform;
 }
 
+// Skeletons keep a flattened copy of the nodes below them
+static void markJointsDirty(QSSGRenderNode *node)
+{
+    for (; node; node = node->parent) {
+        if (node->type == QSSGRenderGraphObject::Type::Skeleton)
+            static_cast<QSSGRenderSkeleton *>(node)->jointsDirty = true;
+    }
+}
+
 void QSSGRenderNode::addChild(QSSGRenderNode &inChild)
 {
     // Adding children to a layer does not reset parent
@@ -172,6 +182,7 @@ void QSSGRenderNode::addChild(QSSGRenderNode &inChild)
     }
     children.push_back(inChild);
     inChild.markDirty(DirtyFlag::GlobalValuesDirty);
+    markJointsDirty(this);
 }
 
 void QSSGRenderNode::removeChild(QSSGRenderNode &inChild)
@@ -184,6 +195,7 @@ void QSSGRenderNode::removeChild(QSSGRenderNode &inChild)
     inChild.parent = nullptr;
     children.remove(inChild);
     inChild.markDirty(DirtyFlag::GlobalValuesDirty);
+    markJointsDirty(this);
 }
 
 void QSSGRenderNode::removeFromGraph()
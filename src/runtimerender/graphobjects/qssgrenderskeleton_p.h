@@ -28,12 +28,26 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderSkeleton : public QSSGRenderNode
     ~QSSGRenderSkeleton();
     Q_DISABLE_COPY(QSSGRenderSkeleton)
 
+    // A joint, or a node on the path from the skeleton to a joint
+    struct FlatJoint {
+        QSSGRenderNode *node = nullptr;
+        qint32 parent = -1; // index into joints, -1 when the parent is the skeleton
+        bool isJoint = false;
+    };
+
     int maxIndex = -1;
 
     bool boneTransformsDirty = false;
     bool skinningDirty = false;
     bool containsNonJointNodes = false;
+    // Set when nodes are added to or removed from the skeleton's subtree
+    bool jointsDirty = true;
+    bool paletteQueued = false;
+    // Parents come before their children, see QSSGSkinningSystem
+    QList<FlatJoint> joints;
+    QList<float> jointTransforms; // global transform (4x4) per entry in joints
     QByteArray boneData;
+    QByteArray pendingBoneData;
     QSSGRenderTextureData boneTexData;
     quint32 boneCount = 0;
 };
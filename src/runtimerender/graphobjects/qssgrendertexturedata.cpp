@@ -3,6 +3,8 @@
 
 #include "qssgrendertexturedata_p.h"
 
+#include <QtQuick3DUtils/private/qssgassert_p.h>
+
 QT_BEGIN_NAMESPACE
 
 QSSGRenderTextureData::QSSGRenderTextureData()
@@ -32,6 +34,47 @@ void QSSGRenderTextureData::setTextureData(const QByteArray &data)
     m_textureData = data;
     // Bump the version number
     ++m_textureDataVersion;
+    // Everything gets uploaded again
+    m_dirtyRegions.clear();
+}
+
+void QSSGRenderTextureData::updateTextureData(const QRect &rect, int slice, const QByteArray &data)
+{
+    QSSG_ASSERT(!m_format.isCompressedTextureFormat(), return);
+    QSSG_ASSERT(data.size() == m_textureData.size(), return);
+
+    const QRect r = rect.intersected(QRect(QPoint(0, 0), m_size));
+    if (r.isEmpty() || slice < 0 || slice >= qMax(1, m_depth))
+        return;
+
+    const qsizetype pixelSize = m_format.getSizeofFormat();
+    const qsizetype lineSize = bytesPerLine(m_size.width(), m_depth, m_format);
+    const qsizetype offset = slice * lineSize * m_size.height() + r.y() * lineSize + r.x() * pixelSize;
+    const qsizetype rowSize = r.width() * pixelSize;
+    char *dst = m_textureData.data() + offset;
+    const char *src = data.constData() + offset;
+    for (int y = 0; y < r.height(); ++y) {
+        memcpy(dst, src, rowSize);
+        dst += lineSize;
+        src += lineSize;
+    }
+
+    // Past a point, uploading everything once is cheaper than many regions
+    constexpr qsizetype MaxRegionCount = 64;
+    if (m_dirtyRegions.size() >= MaxRegionCount) {
+        m_dirtyRegions.clear();
+        ++m_textureDataVersion;
+        return;
+    }
+
+    m_dirtyRegions.append({ r, slice });
+    ++m_updateVersion;
+}
+
+qsizetype QSSGRenderTextureData::bytesPerLine(int width, int depth, QSSGRenderTextureFormat format)
+{
+    const qsizetype line = qsizetype(width) * format.getSizeofFormat();
+    return depth > 0 ? line : (line + 3) & ~3;
 }
 
 void QSSGRenderTextureData::setSize(const QSize &size)
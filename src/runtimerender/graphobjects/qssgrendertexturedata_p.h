@@ -20,6 +20,8 @@
 #include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
 #include <QtQuick3DUtils/private/qssgrenderbasetypes_p.h>
 #include <QtCore/qsize.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qlist.h>
 #include <QtCore/qbytearray.h>
 
 QT_BEGIN_NAMESPACE
@@ -27,6 +29,11 @@ QT_BEGIN_NAMESPACE
 class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderTextureData : public QSSGRenderGraphObject
 {
 public:
+    struct DirtyRegion {
+        QRect rect;
+        int slice = 0; // depth slice for 3D textures
+    };
+
     explicit QSSGRenderTextureData();
     virtual ~QSSGRenderTextureData();
 
@@ -48,6 +55,19 @@ public:
     // We use a version number to track changes in the texture data.
     [[nodiscard]] quint32 version() const { return m_textureDataVersion; }
 
+    // Partial updates copy the pixels of rect (and slice) from data, which
+    // has the same size and layout as the texture data, without changing the
+    // version. The regions are collected until the buffer manager has
+    // uploaded them, or until the next full change, which invalidates them.
+    void updateTextureData(const QRect &rect, int slice, const QByteArray &data);
+    [[nodiscard]] quint32 updateVersion() const { return m_updateVersion; }
+    const QList<DirtyRegion> &dirtyRegions() const { return m_dirtyRegions; }
+    void clearDirtyRegions() { m_dirtyRegions.clear(); }
+
+    // The layout of uncompressed data: rows of 2D textures are 4 byte
+    // aligned, slices of 3D textures are tightly packed.
+    static qsizetype bytesPerLine(int width, int depth, QSSGRenderTextureFormat format);
+
     QString debugObjectName;
 
 protected:
@@ -60,6 +80,8 @@ protected:
     QSize m_size;
     int m_depth = 0;
     quint32 m_textureDataVersion = 0;
+    quint32 m_updateVersion = 0;
+    QList<DirtyRegion> m_dirtyRegions;
     QSSGRenderTextureFormat m_format = QSSGRenderTextureFormat::Unknown;
     bool m_hasTransparency = false;
 };
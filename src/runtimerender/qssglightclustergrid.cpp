@@ -0,0 +1,228 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssglightclustergrid_p.h"
+
+#include <QtCore/qmath.h>
+#include <QtGui/qvector2d.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+// Returns the point on the line through a and b (both in view space) that is
+// viewDepth units in front of the camera.
+QVector3D pointAtDepth(const QVector3D &a, const QVector3D &b, float viewDepth)
+{
+    const float dz = b.z() - a.z();
+    const float t = qFuzzyIsNull(dz) ? 0.0f : (-viewDepth - a.z()) / dz;
+    return a + (b - a) * t;
+}
+
+bool sphereIntersectsBox(const QVector3D &center, float radiusSq, const QSSGBounds3 &box)
+{
+    float distSq = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+        const float v = center[i];
+        if (v < box.minimum[i])
+            distSq += (box.minimum[i] - v) * (box.minimum[i] - v);
+        else if (v > box.maximum[i])
+            distSq += (v - box.maximum[i]) * (v - box.maximum[i]);
+    }
+    return distSq <= radiusSq;
+}
+
+int tileForNdc(float ndc, int tileCount)
+{
+    return qBound(0, int((ndc * 0.5f + 0.5f) * tileCount), tileCount - 1);
+}
+}
+
+QSSGLightClusterGrid::QSSGLightClusterGrid()
+{
+    m_clusterBounds.resize(ClusterCount);
+    m_clusters.resize(ClusterCount);
+}
+
+void QSSGLightClusterGrid::setup(const QMatrix4x4 &view, const QMatrix4x4 &projection, float clipNear, float clipFar)
+{
+    m_view = view;
+    clipNear = qMax(clipNear, 0.0001f);
+    clipFar = qMax(clipFar, clipNear * 1.001f);
+
+    // The view space bounds only depend on the projection, so they survive
+    // camera movement.
+    if (m_boundsDirty || projection != m_projection || clipNear != m_clipNear || clipFar != m_clipFar) {
+        m_projection = projection;
+        m_clipNear = clipNear;
+        m_clipFar = clipFar;
+        m_sliceScale = SliceCount / std::log(clipFar / clipNear);
+        m_sliceBias = -std::log(clipNear) * m_sliceScale;
+        updateClusterBounds();
+        m_boundsDirty = false;
+    }
+}
+
+void QSSGLightClusterGrid::updateClusterBounds()
+{
+    const QMatrix4x4 inverseProjection = m_projection.inverted();
+    for (int y = 0; y < TileCountY; ++y) {
+        const float ndcY0 = 2.0f * y / TileCountY - 1.0f;
+        const float ndcY1 = 2.0f * (y + 1) / TileCountY - 1.0f;
+        for (int x = 0; x < TileCountX; ++x) {
+            const float ndcX0 = 2.0f * x / TileCountX - 1.0f;
+            const float ndcX1 = 2.0f * (x + 1) / TileCountX - 1.0f;
+            // The four edges of the tile, each given by a point on the near
+            // and one on the far plane
+            const QVector2D corners[4] = { { ndcX0, ndcY0 }, { ndcX1, ndcY0 }, { ndcX0, ndcY1 }, { ndcX1, ndcY1 } };
+            QVector3D nearPoints[4];
+            QVector3D farPoints[4];
+            for (int i = 0; i < 4; ++i) {
+                nearPoints[i] = inverseProjection.map(QVector3D(corners[i], -1.0f));
+                farPoints[i] = inverseProjection.map(QVector3D(corners[i], 1.0f));
+            }
+            for (int z = 0; z < SliceCount; ++z) {
+                const float depth0 = m_clipNear * std::pow(m_clipFar / m_clipNear, float(z) / SliceCount);
+                const float depth1 = m_clipNear * std::pow(m_clipFar / m_clipNear, float(z + 1) / SliceCount);
+                QSSGBounds3 bounds;
+                for (int i = 0; i < 4; ++i) {
+                    bounds.include(pointAtDepth(nearPoints[i], farPoints[i], depth0));
+                    bounds.include(pointAtDepth(nearPoints[i], farPoints[i], depth1));
+                }
+                m_clusterBounds[clusterIndex(x, y, z)] = bounds;
+            }
+        }
+    }
+}
+
+void QSSGLightClusterGrid::assign(const QList<LightVolume> &lights)
+{
+    m_hits.clear();
+    const qsizetype lightCount = qMin<qsizetype>(lights.size(), MaxLightCount);
+    for (qsizetype lightIdx = 0; lightIdx < lightCount; ++lightIdx) {
+        const LightVolume &light = lights[lightIdx];
+        if (!(light.radius > 0.0f))
+            continue;
+
+        const QVector3D center = m_view.map(light.center);
+        const float depth = -center.z();
+        if (depth + light.radius < m_clipNear || depth - light.radius > m_clipFar)
+            continue;
+
+        const int z0 = sliceForDepth(depth - light.radius);
+        const int z1 = sliceForDepth(depth + light.radius);
+
+        // Narrow down the tiles by projecting the sphere's bounding box, this
+        // is only valid when the whole box is in front of the camera.
+        int x0 = 0;
+        int x1 = TileCountX - 1;
+        int y0 = 0;
+        int y1 = TileCountY - 1;
+        if (depth - light.radius > 0.0f && qIsFinite(light.radius)) {
+            float minX = std::numeric_limits<float>::max();
+            float maxX = -std::numeric_limits<float>::max();
+            float minY = minX;
+            float maxY = maxX;
+            for (int i = 0; i < 8; ++i) {
+                const QVector3D corner(center.x() + ((i & 1) ? light.radius : -light.radius),
+                                       center.y() + ((i & 2) ? light.radius : -light.radius),
+                                       center.z() + ((i & 4) ? light.radius : -light.radius));
+                const QVector3D ndc = m_projection.map(corner);
+                minX = qMin(minX, ndc.x());
+                maxX = qMax(maxX, ndc.x());
+                minY = qMin(minY, ndc.y());
+                maxY = qMax(maxY, ndc.y());
+            }
+            if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+                continue;
+            x0 = tileForNdc(minX, TileCountX);
+            x1 = tileForNdc(maxX, TileCountX);
+            y0 = tileForNdc(minY, TileCountY);
+            y1 = tileForNdc(maxY, TileCountY);
+        }
+
+        const float radiusSq = light.radius * light.radius;
+        for (int z = z0; z <= z1; ++z) {
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    const int cluster = clusterIndex(x, y, z);
+                    if (sphereIntersectsBox(center, radiusSq, m_clusterBounds[cluster]))
+                        m_hits.append({ quint32(cluster), quint32(lightIdx) });
+                }
+            }
+        }
+    }
+
+    // Counting sort of the hits into per-cluster ranges, the hits are
+    // already ordered by light index within each cluster.
+    for (Cluster &cluster : m_clusters)
+        cluster = {};
+    for (const auto &hit : std::as_const(m_hits)) {
+        Cluster &cluster = m_clusters[hit.first];
+        if (cluster.count < quint32(MaxLightsPerCluster))
+            ++cluster.count;
+    }
+    quint32 offset = 0;
+    for (Cluster &cluster : m_clusters) {
+        cluster.offset = offset;
+        offset += cluster.count;
+        cluster.count = 0;
+    }
+    m_lightIndices.resize(offset);
+    for (const auto &hit : std::as_const(m_hits)) {
+        Cluster &cluster = m_clusters[hit.first];
+        if (cluster.count < quint32(MaxLightsPerCluster))
+            m_lightIndices[cluster.offset + cluster.count++] = hit.second;
+    }
+}
+
+void QSSGLightClusterGrid::clear()
+{
+    m_hits.clear();
+    m_lightIndices.clear();
+    for (Cluster &cluster : m_clusters)
+        cluster = {};
+}
+
+QVector4D QSSGLightClusterGrid::viewDepthPlane() const
+{
+    return -m_view.row(2);
+}
+
+int QSSGLightClusterGrid::sliceForDepth(float viewDepth) const
+{
+    if (!(viewDepth > m_clipNear))
+        return 0;
+    if (viewDepth >= m_clipFar)
+        return SliceCount - 1;
+    return qBound(0, int(std::log(viewDepth) * m_sliceScale + m_sliceBias), SliceCount - 1);
+}
+
+int QSSGLightClusterGrid::clusterForPosition(const QVector3D &worldPos) const
+{
+    const QVector3D ndc = viewProjection().map(worldPos);
+    const float depth = QVector4D::dotProduct(viewDepthPlane(), QVector4D(worldPos, 1.0f));
+    return clusterIndex(tileForNdc(ndc.x(), TileCountX),
+                        tileForNdc(ndc.y(), TileCountY),
+                        sliceForDepth(depth));
+}
+
+float QSSGLightClusterGrid::lightRange(const QVector3D &color, float constantAttenuation, float linearAttenuation, float quadraticAttenuation)
+{
+    const float intensity = qMax(color.x(), qMax(color.y(), color.z()));
+    // Solve intensity / (c + l * d + q * d * d) = cutoff for d
+    const float c = constantAttenuation - intensity / AttenuationCutoff;
+    if (c >= 0.0f)
+        return 0.0f;
+    if (quadraticAttenuation > 0.0f) {
+        const float l = linearAttenuation;
+        const float q = quadraticAttenuation;
+        return (-l + std::sqrt(l * l - 4.0f * q * c)) / (2.0f * q);
+    }
+    if (linearAttenuation > 0.0f)
+        return -c / linearAttenuation;
+    return std::numeric_limits<float>::infinity();
+}
+
+QT_END_NAMESPACE
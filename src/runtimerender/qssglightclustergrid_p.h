@@ -0,0 +1,109 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGLIGHTCLUSTERGRID_P_H
+#define QSSGLIGHTCLUSTERGRID_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+#include <QtQuick3DUtils/private/qssgbounds3_p.h>
+
+#include <QtCore/qlist.h>
+#include <QtGui/qmatrix4x4.h>
+#include <QtGui/qvector4d.h>
+
+QT_BEGIN_NAMESPACE
+
+// Assigns lights to the cells ("clusters") of a grid that subdivides the view
+// frustum into TileCountX * TileCountY screen space tiles and SliceCount depth
+// slices. The slices are distributed exponentially between the near and far
+// clip planes so that the clusters stay roughly cube shaped. A light is
+// represented by a bounding sphere (world space) and it is added to every
+// cluster its sphere touches. The result is a flat list of light indices plus
+// an (offset, count) range into that list per cluster, which is what the
+// generated fragment shaders read for the clustered lights.
+//
+// QSSGLayerRenderData::prepareLightClusters() fills in the light volumes and
+// uploads the result to the light and grid textures every frame.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGLightClusterGrid
+{
+public:
+    static constexpr int TileCountX = 16;
+    static constexpr int TileCountY = 8;
+    static constexpr int SliceCount = 24;
+    static constexpr int ClusterCount = TileCountX * TileCountY * SliceCount;
+    // Upper limit for the number of lights taking part in the clustering
+    static constexpr int MaxLightCount = 1024;
+    // Lights beyond this in a single cluster are dropped, in input order
+    static constexpr int MaxLightsPerCluster = 64;
+    // Intensity below which a point or spot light is considered to have no
+    // visible contribution anymore, used to derive the light's range.
+    static constexpr float AttenuationCutoff = 1.0f / 256.0f;
+
+    struct LightVolume {
+        QVector3D center; // world space
+        float radius = 0.0f;
+    };
+
+    struct Cluster {
+        quint32 offset = 0; // into lightIndices()
+        quint32 count = 0;
+    };
+
+    QSSGLightClusterGrid();
+
+    // projection is expected to follow the OpenGL conventions (as returned
+    // by QSSGRenderCamera), i.e. without the clip space correction matrix.
+    void setup(const QMatrix4x4 &view, const QMatrix4x4 &projection, float clipNear, float clipFar);
+    void assign(const QList<LightVolume> &lights);
+    void clear();
+
+    const QList<Cluster> &clusters() const { return m_clusters; }
+    const QList<quint32> &lightIndices() const { return m_lightIndices; }
+    QSSGBounds3 clusterBounds(int index) const { return m_clusterBounds[index]; } // view space
+
+    // What the shader needs to find the cluster for a world space position
+    QMatrix4x4 viewProjection() const { return m_projection * m_view; }
+    QVector4D viewDepthPlane() const; // dot with (worldPos, 1) gives the view depth
+    float sliceScale() const { return m_sliceScale; }
+    float sliceBias() const { return m_sliceBias; }
+
+    int sliceForDepth(float viewDepth) const;
+    int clusterForPosition(const QVector3D &worldPos) const;
+    static constexpr int clusterIndex(int x, int y, int z) { return (z * TileCountY + y) * TileCountX + x; }
+
+    // Distance at which a light with the given (brightness scaled) color and
+    // attenuation falls below AttenuationCutoff. Returns 0 when the light is
+    // never visible and infinity when it does not fall off at all.
+    static float lightRange(const QVector3D &color, float constantAttenuation, float linearAttenuation, float quadraticAttenuation);
+
+private:
+    void updateClusterBounds();
+
+    QMatrix4x4 m_view;
+    QMatrix4x4 m_projection;
+    float m_clipNear = 0.0f;
+    float m_clipFar = 0.0f;
+    float m_sliceScale = 0.0f;
+    float m_sliceBias = 0.0f;
+    bool m_boundsDirty = true;
+    QList<QSSGBounds3> m_clusterBounds;
+    QList<Cluster> m_clusters;
+    QList<quint32> m_lightIndices;
+    QList<std::pair<quint32, quint32>> m_hits; // (cluster, light), reused between frames
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGLIGHTCLUSTERGRID_P_H
@@ -0,0 +1,391 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgreflectionprobebaker_p.h"
+#include "qssgrenderreflectionmap_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderlayer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderreflectionprobe_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderdefaultmaterial_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendercustommaterial_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderlight_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgruntimerenderlogging_p.h>
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+// Part of the content key, bump when what the baked files contain changes
+static constexpr char BakerVersion[] = "2";
+
+struct QSSGReflectionProbeBaker::Job
+{
+    QString path;
+    QByteArray contentKey;
+    QSize size;
+    std::vector<QRhiReadbackResult> results; // six faces per level
+    int pending = 0;
+};
+
+QSSGReflectionProbeBaker::QSSGReflectionProbeBaker() = default;
+
+QSSGReflectionProbeBaker::~QSSGReflectionProbeBaker() = default;
+
+bool QSSGReflectionProbeBaker::bakeRequested()
+{
+    static const bool requested = QCoreApplication::arguments().contains(QStringLiteral("--bake-reflection-probes"))
+            || qEnvironmentVariableIntValue("QT_QUICK3D_BAKE_REFLECTION_PROBES");
+    return requested;
+}
+
+QString QSSGReflectionProbeBaker::bakedMapPath(const QByteArray &contentKey)
+{
+    const QString fileName = QStringLiteral("qrp_") + QString::fromLatin1(contentKey.toHex()) + QStringLiteral(".ktx");
+    const QString dir = qEnvironmentVariable("QT_QUICK3D_REFLECTION_PROBE_BAKE_PATH");
+    return dir.isEmpty() ? fileName : QDir(dir).filePath(fileName);
+}
+
+static void addMatrix(QCryptographicHash &hash, const QMatrix4x4 &m)
+{
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(m.constData()), 16 * sizeof(float)));
+}
+
+template<typename T>
+static void addValue(QCryptographicHash &hash, const T &value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(&value), sizeof(T)));
+}
+
+// Images are identified by their source, those made from data or from a
+// QSGTexture have nothing that stays the same between runs.
+static bool addImage(QCryptographicHash &hash, const QSSGRenderImage *image)
+{
+    if (!image) {
+        hash.addData("-");
+        return true;
+    }
+    if (image->m_qsgTexture || image->m_rawTextureData || image->m_imagePath.isNull())
+        return false;
+    hash.addData(image->m_imagePath.path().toUtf8());
+    addMatrix(hash, image->m_textureTransform);
+    return true;
+}
+
+static bool addMaterial(QCryptographicHash &hash, const QSSGRenderGraphObject &material)
+{
+    addValue(hash, material.type);
+    if (material.type == QSSGRenderGraphObject::Type::CustomMaterial) {
+        const auto &customMaterial = static_cast<const QSSGRenderCustomMaterial &>(material);
+        hash.addData(customMaterial.m_shaderPathKey[0]);
+        hash.addData(customMaterial.m_shaderPathKey[1]);
+        QByteArray properties;
+        QDataStream stream(&properties, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        for (const auto &property : customMaterial.m_properties)
+            stream << property.name << property.value;
+        hash.addData(properties);
+        addValue(hash, customMaterial.m_cullMode);
+        addValue(hash, customMaterial.m_shadingMode);
+        addValue(hash, customMaterial.m_renderFlags.toInt());
+        for (const auto &property : customMaterial.m_textureProperties) {
+            hash.addData(property.name);
+            if (!addImage(hash, property.texImage))
+                return false;
+        }
+        return true;
+    }
+
+    const auto &defaultMaterial = static_cast<const QSSGRenderDefaultMaterial &>(material);
+    addValue(hash, defaultMaterial.lighting);
+    addValue(hash, defaultMaterial.color);
+    addValue(hash, defaultMaterial.emissiveColor);
+    addValue(hash, defaultMaterial.specularTint);
+    addValue(hash, defaultMaterial.specularAmount);
+    addValue(hash, defaultMaterial.specularRoughness);
+    addValue(hash, defaultMaterial.metalnessAmount);
+    addValue(hash, defaultMaterial.opacity);
+    addValue(hash, defaultMaterial.ior);
+    addValue(hash, defaultMaterial.clearcoatAmount);
+    addValue(hash, defaultMaterial.clearcoatRoughnessAmount);
+    addValue(hash, defaultMaterial.clearcoatNormalStrength);
+    addValue(hash, defaultMaterial.transmissionFactor);
+    addValue(hash, defaultMaterial.thicknessFactor);
+    addValue(hash, defaultMaterial.attenuationDistance);
+    addValue(hash, defaultMaterial.attenuationColor);
+    addValue(hash, defaultMaterial.heightAmount);
+    addValue(hash, defaultMaterial.bumpAmount);
+    addValue(hash, defaultMaterial.occlusionAmount);
+    addValue(hash, defaultMaterial.alphaCutoff);
+    addValue(hash, defaultMaterial.alphaMode);
+    addValue(hash, defaultMaterial.specularModel);
+    addValue(hash, defaultMaterial.cullMode);
+    addValue(hash, defaultMaterial.blendMode);
+    addValue(hash, defaultMaterial.vertexColorsEnabled);
+    addValue(hash, defaultMaterial.vertexColorsMaskEnabled);
+    addValue(hash, defaultMaterial.vertexColorRedMask.toInt());
+    addValue(hash, defaultMaterial.vertexColorGreenMask.toInt());
+    addValue(hash, defaultMaterial.vertexColorBlueMask.toInt());
+    addValue(hash, defaultMaterial.vertexColorAlphaMask.toInt());
+    for (const QSSGRenderImage *image : { defaultMaterial.colorMap, defaultMaterial.emissiveMap,
+                                          defaultMaterial.specularReflection, defaultMaterial.specularMap,
+                                          defaultMaterial.roughnessMap, defaultMaterial.metalnessMap,
+                                          defaultMaterial.opacityMap, defaultMaterial.bumpMap,
+                                          defaultMaterial.normalMap, defaultMaterial.translucencyMap,
+                                          defaultMaterial.occlusionMap, defaultMaterial.heightMap,
+                                          defaultMaterial.clearcoatMap, defaultMaterial.clearcoatRoughnessMap,
+                                          defaultMaterial.clearcoatNormalMap, defaultMaterial.transmissionMap,
+                                          defaultMaterial.thicknessMap }) {
+        if (!addImage(hash, image))
+            return false;
+    }
+    return true;
+}
+
+// The lights a renderable is lit by, as the shaders see them
+static void addLights(QCryptographicHash &hash, const QSSGShaderLightListView &lights)
+{
+    addValue(hash, lights.size());
+    for (const QSSGShaderLight &shaderLight : lights) {
+        const QSSGRenderLight &light = *shaderLight.light;
+        addValue(hash, light.type);
+        addMatrix(hash, light.globalTransform);
+        addValue(hash, light.m_diffuseColor);
+        addValue(hash, light.m_specularColor);
+        addValue(hash, light.m_ambientColor);
+        addValue(hash, light.m_brightness);
+        addValue(hash, light.m_constantFade);
+        addValue(hash, light.m_linearFade);
+        addValue(hash, light.m_quadraticFade);
+        addValue(hash, light.m_coneAngle);
+        addValue(hash, light.m_innerConeAngle);
+        addValue(hash, shaderLight.shadows);
+        if (shaderLight.shadows) {
+            addValue(hash, light.m_shadowBias);
+            addValue(hash, light.m_shadowFactor);
+            addValue(hash, light.m_shadowMapRes);
+            addValue(hash, light.m_shadowMapFar);
+            addValue(hash, light.m_shadowFilter);
+            addValue(hash, light.m_softShadowQuality);
+            addValue(hash, light.m_pcfFactor);
+        }
+    }
+}
+
+static QByteArray renderableDigest(const QSSGRenderableObject &object)
+{
+    if (object.type != QSSGRenderableObject::Type::DefaultMaterialMeshSubset
+            && object.type != QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
+        return {};
+    }
+
+    const auto &renderable = static_cast<const QSSGSubsetRenderable &>(object);
+    const QSSGRenderModel &model = renderable.modelContext.model;
+    if (model.usesBoneTexture() || !model.morphWeights.isEmpty() || model.instanceTable || model.particleBuffer)
+        return {};
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (model.geometry) {
+        hash.addData(model.geometry->vertexBuffer());
+        hash.addData(model.geometry->indexBuffer());
+    } else if (!model.meshPath.isNull()) {
+        hash.addData(model.meshPath.path().toUtf8());
+    } else {
+        return {};
+    }
+    addValue(hash, renderable.subset.offset);
+    addValue(hash, renderable.subset.count);
+    addMatrix(hash, renderable.globalTransform);
+    addValue(hash, renderable.opacity);
+    addLights(hash, renderable.lights);
+    if (!addMaterial(hash, renderable.getMaterial()))
+        return {};
+    return hash.result();
+}
+
+QByteArray QSSGReflectionProbeBaker::contentKey(const QSSGRenderReflectionProbe &probe,
+                                                const QSSGRenderLayer &layer,
+                                                const QSSGRenderableObjectList &reflectionCasters)
+{
+    // The casters come sorted by their distance to the camera, which is not
+    // something the key should depend on.
+    QList<QByteArray> digests;
+    digests.reserve(reflectionCasters.size());
+    for (const auto &handle : reflectionCasters) {
+        const QByteArray digest = renderableDigest(*handle.obj);
+        if (digest.isEmpty())
+            return {};
+        digests.append(digest);
+    }
+    std::sort(digests.begin(), digests.end());
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(BakerVersion);
+    addMatrix(hash, probe.globalTransform);
+    addValue(hash, probe.reflectionMapRes);
+    addValue(hash, probe.clearColor.rgba64());
+    addValue(hash, layer.background);
+    // The light probe lights the materials with any background, and is the
+    // sky box with the SkyBox one.
+    if (!addImage(hash, layer.lightProbe))
+        return {};
+    if (layer.lightProbe) {
+        addValue(hash, layer.lightProbeSettings.probeExposure);
+        addValue(hash, layer.lightProbeSettings.probeHorizon);
+        addValue(hash, layer.lightProbeSettings.probeOrientation);
+    }
+    if (layer.background == QSSGRenderLayer::Background::SkyBoxCubeMap && !addImage(hash, layer.skyBoxCubeMap))
+        return {};
+    for (const QByteArray &digest : std::as_const(digests))
+        hash.addData(digest);
+    return hash.result();
+}
+
+static void appendUInt32(QByteArray &data, quint32 value)
+{
+    const quint32 littleEndian = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char *>(&littleEndian), sizeof(littleEndian));
+}
+
+QByteArray QSSGReflectionProbeBaker::ktxData(const QSize &size, const QList<QByteArray> &faces, const QByteArray &contentKey)
+{
+    return ktxData(size, faces, { { QByteArrayLiteral("QT_REFLECTION_PROBE_BAKER_VERSION"), QByteArray(BakerVersion) },
+                                  { QByteArrayLiteral("QT_REFLECTION_PROBE_CONTENT_KEY"), contentKey.toHex() } });
+}
+
+QByteArray QSSGReflectionProbeBaker::ktxData(const QSize &size, const QList<QByteArray> &faces, const KeyValueList &keyValues)
+{
+    constexpr int FaceCount = 6;
+    const int levelCount = int(faces.size() / FaceCount);
+
+    QByteArray keyValueData;
+    for (const auto &[key, value] : keyValues) {
+        const quint32 keyAndValueByteSize = quint32(key.size() + 1 + value.size() + 1);
+        appendUInt32(keyValueData, keyAndValueByteSize);
+        keyValueData.append(key).append('\0');
+        keyValueData.append(value).append('\0');
+        // Pad until next multiple of 4
+        keyValueData.append(QByteArray(3 - ((keyAndValueByteSize + 3) % 4), '\0'));
+    }
+
+    static const char identifier[12] = { '\xAB', 'K', 'T', 'X', ' ', '1', '1', '\xBB', '\r', '\n', '\x1A', '\n' };
+    QByteArray data(identifier, sizeof(identifier));
+    appendUInt32(data, 0x04030201); // endianness
+    appendUInt32(data, 0x140B); // glType: GL_HALF_FLOAT
+    appendUInt32(data, 2); // glTypeSize
+    appendUInt32(data, 0x1908); // glFormat: GL_RGBA
+    appendUInt32(data, 0x881A); // glInternalFormat: GL_RGBA16F
+    appendUInt32(data, 0x1908); // glBaseInternalFormat: GL_RGBA
+    appendUInt32(data, quint32(size.width()));
+    appendUInt32(data, quint32(size.height()));
+    appendUInt32(data, 0); // pixelDepth
+    appendUInt32(data, 0); // numberOfArrayElements
+    appendUInt32(data, FaceCount);
+    appendUInt32(data, quint32(levelCount));
+    appendUInt32(data, quint32(keyValueData.size()));
+    data.append(keyValueData);
+
+    for (int level = 0; level < levelCount; ++level) {
+        const int width = qMax(1, size.width() >> level);
+        const int height = qMax(1, size.height() >> level);
+        // 8 bytes per pixel, the rows need no padding
+        const qsizetype imageSize = qsizetype(width) * height * 8;
+        appendUInt32(data, quint32(imageSize));
+        for (int face = 0; face < FaceCount; ++face) {
+            const QByteArray &faceData = faces.at(level * FaceCount + face);
+            data.append(faceData.first(qMin(imageSize, faceData.size())));
+            if (faceData.size() < imageSize)
+                data.append(QByteArray(imageSize - faceData.size(), '\0'));
+        }
+    }
+
+    return data;
+}
+
+void QSSGReflectionProbeBaker::bake(QSSGRhiContext *rhiCtx, const QSSGReflectionMapEntry &entry, const QByteArray &contentKey)
+{
+    // Jobs cannot be removed from their own completion callbacks
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), [](const std::unique_ptr<Job> &job) { return job->pending == 0; }),
+                 m_jobs.end());
+
+    QRhiTexture *prefilteredCube = entry.m_rhiPrefilteredCube;
+    const int levelCount = entry.m_prefilterMipLevelSizes.size();
+    if (!prefilteredCube || levelCount == 0)
+        return;
+
+    auto job = std::make_unique<Job>();
+    job->path = bakedMapPath(contentKey);
+    job->contentKey = contentKey;
+    job->size = prefilteredCube->pixelSize();
+    job->results.resize(levelCount * 6);
+    job->pending = levelCount * 6;
+    Job *pendingJob = job.get();
+    m_jobs.push_back(std::move(job));
+
+    QRhiResourceUpdateBatch *rub = rhiCtx->rhi()->nextResourceUpdateBatch();
+    for (int level = 0; level < levelCount; ++level) {
+        for (int face = 0; face < 6; ++face) {
+            QRhiReadbackResult &result = pendingJob->results[level * 6 + face];
+            result.completed = [this, pendingJob] {
+                if (--pendingJob->pending == 0)
+                    jobDone(pendingJob);
+            };
+            QRhiReadbackDescription desc(prefilteredCube);
+            desc.setLayer(face);
+            desc.setLevel(level);
+            rub->readBackTexture(desc, &result);
+        }
+    }
+    rhiCtx->commandBuffer()->resourceUpdate(rub);
+}
+
+void QSSGReflectionProbeBaker::jobDone(Job *job)
+{
+    QList<QByteArray> faces;
+    faces.reserve(qsizetype(job->results.size()));
+    for (QRhiReadbackResult &result : job->results) {
+        faces.append(result.data);
+        result.data.clear();
+    }
+
+    QFile file(job->path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(ktxData(job->size, faces, job->contentKey));
+        ++m_bakedCount;
+    } else {
+        qWarning("Failed to write baked reflection probe %s: %s", qPrintable(job->path), qPrintable(file.errorString()));
+    }
+
+    maybeQuit();
+}
+
+void QSSGReflectionProbeBaker::finishFrame()
+{
+    m_frameFinished = true;
+    maybeQuit();
+}
+
+void QSSGReflectionProbeBaker::maybeQuit()
+{
+    if (!m_frameFinished || m_quitRequested)
+        return;
+    for (const auto &job : m_jobs) {
+        if (job->pending > 0)
+            return;
+    }
+    m_quitRequested = true;
+    qCDebug(PERF_INFO, "Reflection probe baking done (%d written), exiting application", m_bakedCount);
+    QMetaObject::invokeMethod(qApp, "quit");
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,97 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGREFLECTIONPROBEBAKER_P_H
+#define QSSGREFLECTIONPROBEBAKER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderableobjects_p.h>
+
+#include <QtCore/qlist.h>
+#include <QtCore/qsize.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QSSGRhiContext;
+struct QSSGRenderLayer;
+struct QSSGRenderReflectionProbe;
+struct QSSGReflectionMapEntry;
+
+// Offline baking of reflection probes, the counterpart of the lightmap baking
+// for probes with the FirstFrame refresh mode.
+//
+// When started with --bake-reflection-probes (or QT_QUICK3D_BAKE_REFLECTION_PROBES=1)
+// such probes are rendered and prefiltered as usual in the first frame, then
+// the prefiltered cube map is read back and written to qrp_<key>.ktx, and the
+// application exits once all files are written. The key is a hash of what the
+// probe sees, so a file is only picked up at run time as long as the scene
+// around the probe is unchanged; an edited scene falls back to rendering the
+// probe until it is baked again.
+//
+// The files are written to, and loaded from, the directory given in
+// QT_QUICK3D_REFLECTION_PROBE_BAKE_PATH, or the current directory.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGReflectionProbeBaker
+{
+public:
+    QSSGReflectionProbeBaker();
+    ~QSSGReflectionProbeBaker();
+
+    static bool bakeRequested();
+
+    static QString bakedMapPath(const QByteArray &contentKey);
+
+    // Stable between runs, unlike the keys used for invalidating the maps at
+    // run time: no pointers, only the data the renderables are made from.
+    // Empty when something the probe sees can not be baked (particles,
+    // skinned, morphed or instanced models, textures given as data).
+    static QByteArray contentKey(const QSSGRenderReflectionProbe &probe,
+                                 const QSSGRenderLayer &layer,
+                                 const QSSGRenderableObjectList &reflectionCasters);
+
+    // KTX 1.1 cube map in RGBA16F, faces holds the six faces of each mip
+    // level, level by level.
+    static QByteArray ktxData(const QSize &size, const QList<QByteArray> &faces, const QByteArray &contentKey);
+
+    // The same with arbitrary key-value metadata, for other prefiltered cube
+    // maps stored in the same layout (see QSSGEnvironmentMapCache).
+    using KeyValueList = QList<std::pair<QByteArray, QByteArray>>;
+    static QByteArray ktxData(const QSize &size, const QList<QByteArray> &faces, const KeyValueList &keyValues);
+
+    // Reads back the prefiltered cube map of the entry and writes it to
+    // bakedMapPath(contentKey) once the data has arrived.
+    void bake(QSSGRhiContext *rhiCtx, const QSSGReflectionMapEntry &entry, const QByteArray &contentKey);
+
+    // Called after the reflection maps of a frame were recorded. Exits the
+    // application as soon as all files of the frame are written.
+    void finishFrame();
+
+private:
+    struct Job;
+    void jobDone(Job *job);
+    void maybeQuit();
+
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    int m_bakedCount = 0;
+    bool m_frameFinished = false;
+    bool m_quitRequested = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGREFLECTIONPROBEBAKER_P_H
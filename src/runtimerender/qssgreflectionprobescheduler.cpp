@@ -0,0 +1,108 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgreflectionprobescheduler_p.h"
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+// Weight of a probe whose content changed since it was last rendered,
+// relative to one that only got older.
+static constexpr float ContentChangedWeight = 4.0f;
+// Distance (in scene units) at which the proximity term has fallen to half
+static constexpr float HalfProximityDistance = 1000.0f;
+// Weight of the latest sample in the face time estimate
+static constexpr float FaceTimeSmoothing = 0.2f;
+
+QSSGReflectionProbeScheduler::QSSGReflectionProbeScheduler() = default;
+
+void QSSGReflectionProbeScheduler::setBudgetFromEnvironment()
+{
+    static const int faceBudget = qEnvironmentVariableIntValue("QT_QUICK3D_REFLECTION_PROBE_FACE_BUDGET");
+    static const float timeBudget = qEnvironmentVariable("QT_QUICK3D_REFLECTION_PROBE_TIME_BUDGET").toFloat();
+    setBudget(faceBudget, timeBudget);
+}
+
+void QSSGReflectionProbeScheduler::setBudget(int faceBudget, float timeBudget)
+{
+    m_faceBudget = qMax(0, faceBudget);
+    m_timeBudget = qMax(0.0f, timeBudget);
+}
+
+float QSSGReflectionProbeScheduler::priority(const Candidate &candidate)
+{
+    const float proximity = 1.0f / (1.0f + qMax(0.0f, candidate.distance) / HalfProximityDistance);
+    const float weight = candidate.contentChanged ? ContentChangedWeight : 1.0f;
+    // The age makes every probe come up eventually, also when others are
+    // closer, bigger on screen or changing all the time.
+    return weight * (1.0f + float(candidate.age)) * (candidate.screenCoverage + proximity);
+}
+
+qsizetype QSSGReflectionProbeScheduler::schedule(QList<Candidate> &candidates) const
+{
+    for (Candidate &candidate : candidates)
+        candidate.priority = priority(candidate);
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        if (a.forced != b.forced)
+            return a.forced;
+        return a.priority > b.priority;
+    });
+
+    if (!hasBudget())
+        return candidates.size();
+
+    int faceCount = 0;
+    qsizetype count = 0;
+    for (const Candidate &candidate : std::as_const(candidates)) {
+        const int faces = faceCount + candidate.faceCount;
+        const bool fitsFaces = m_faceBudget <= 0 || faces <= m_faceBudget;
+        const bool fitsTime = m_timeBudget <= 0.0f || float(faces) * m_faceTime <= m_timeBudget;
+        if (count > 0 && !(fitsFaces && fitsTime))
+            break;
+        faceCount = faces;
+        ++count;
+    }
+    return count;
+}
+
+void QSSGReflectionProbeScheduler::recordFaceTime(float milliseconds, int faceCount)
+{
+    if (faceCount <= 0)
+        return;
+    const float faceTime = milliseconds / float(faceCount);
+    m_faceTime = m_faceTime > 0.0f ? m_faceTime + FaceTimeSmoothing * (faceTime - m_faceTime)
+                                   : faceTime;
+}
+
+float QSSGReflectionProbeScheduler::screenCoverage(const QSSGBounds3 &box, const QMatrix4x4 &viewProjection)
+{
+    if (box.isEmpty())
+        return 0.0f;
+
+    float minX = 1.0f;
+    float minY = 1.0f;
+    float maxX = -1.0f;
+    float maxY = -1.0f;
+    for (const QVector3D &corner : box.toQSSGBoxPointsNoEmptyCheck()) {
+        const QVector4D p = viewProjection.map(QVector4D(corner, 1.0f));
+        if (p.w() <= 0.0f)
+            return 1.0f;
+        const float x = p.x() / p.w();
+        const float y = p.y() / p.w();
+        minX = qMin(minX, x);
+        minY = qMin(minY, y);
+        maxX = qMax(maxX, x);
+        maxY = qMax(maxY, y);
+    }
+
+    const float width = qMin(maxX, 1.0f) - qMax(minX, -1.0f);
+    const float height = qMin(maxY, 1.0f) - qMax(minY, -1.0f);
+    if (width <= 0.0f || height <= 0.0f)
+        return 0.0f;
+    // NDC spans 2x2
+    return width * height / 4.0f;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,88 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGREFLECTIONPROBESCHEDULER_P_H
+#define QSSGREFLECTIONPROBESCHEDULER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+#include <QtQuick3DUtils/private/qssgbounds3_p.h>
+
+#include <QtCore/qlist.h>
+#include <QtGui/qmatrix4x4.h>
+
+QT_BEGIN_NAMESPACE
+
+// Decides which of the reflection probes that want to be re-rendered in a
+// frame actually are, so that a scene with many EveryFrame probes does not
+// render all their cube faces and prefilter all their mips in the same frame.
+//
+// The budget is given in cube faces and/or in milliseconds, 0 means no limit.
+// The time budget is checked against an estimate of the CPU time it takes to
+// record one face (including its share of the prefiltering), which is learnt
+// from the previous frames. Probes that do not fit are left for a following
+// frame, where they are more likely to fit since their age increases.
+//
+// RenderHelpers::rhiRenderReflectionMap() fills in the candidates and feeds
+// back the recording times every frame, with one scheduler per layer.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGReflectionProbeScheduler
+{
+public:
+    struct Candidate {
+        int probeIndex = -1;
+        int faceCount = 6; // 1 when the probe renders one face per frame
+        float distance = 0.0f; // from the camera to the probe's box
+        float screenCoverage = 0.0f; // of the probe's box, 0..1
+        quint32 age = 0; // frames since the probe was last rendered
+        bool contentChanged = true;
+        // Probes that were never rendered, or have an update scheduled, are
+        // rendered before any other.
+        bool forced = false;
+        float priority = 0.0f; // set by schedule()
+    };
+
+    QSSGReflectionProbeScheduler();
+
+    // QT_QUICK3D_REFLECTION_PROBE_FACE_BUDGET and
+    // QT_QUICK3D_REFLECTION_PROBE_TIME_BUDGET (milliseconds)
+    void setBudgetFromEnvironment();
+    void setBudget(int faceBudget, float timeBudget);
+    int faceBudget() const { return m_faceBudget; }
+    float timeBudget() const { return m_timeBudget; }
+    bool hasBudget() const { return m_faceBudget > 0 || m_timeBudget > 0.0f; }
+
+    // Sorts the candidates by priority, the first returned count of them are
+    // to be rendered this frame. At least one is, even when it does not fit,
+    // so that no probe is starved by a too small budget.
+    qsizetype schedule(QList<Candidate> &candidates) const;
+
+    // Feeds the time it took to record faceCount faces into the estimate.
+    void recordFaceTime(float milliseconds, int faceCount);
+    float estimatedFaceTime() const { return m_faceTime; }
+
+    static float priority(const Candidate &candidate);
+
+    // Fraction of the viewport the box covers, based on the screen space
+    // rectangle of its corners. 1 when the box reaches behind the camera.
+    static float screenCoverage(const QSSGBounds3 &box, const QMatrix4x4 &viewProjection);
+
+private:
+    int m_faceBudget = 0;
+    float m_timeBudget = 0.0f;
+    float m_faceTime = 0.0f;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGREFLECTIONPROBESCHEDULER_P_H
@@ -777,6 +777,82 @@ static void calculatePointLightAttenuation(QSSGStageGeneratorBase &fragmentShade
                    << lightVarNames.lightQuadraticAttenuation << "), " << lightVarNames.relativeDistance << ");\n";
 }
 
+// Point and spot lights without shadows that were binned into the light
+// clusters (see QSSGLightClusterGrid) instead of being part of the per-model
+// light list. Only the lights of the fragment's cluster are evaluated, with the
+// same code as for regular lights, but reading the light properties from the
+// qt_lightClusterLights texture.
+static void generateClusteredLightCalculation(QSSGStageGeneratorBase &fragmentShader,
+                                              QSSGMaterialVertexPipeline &vertexShader,
+                                              const QSSGShaderDefaultMaterialKey &inKey,
+                                              QSSGShaderMaterialAdapter *materialAdapter,
+                                              QSSGShaderLibraryManager &shaderLibraryManager,
+                                              QSSGRenderableImage *translucencyImage,
+                                              bool hasCustomFrag,
+                                              bool usesSharedVar,
+                                              bool specularLightingEnabled,
+                                              bool enableClearcoat,
+                                              bool enableTransmission)
+{
+    vertexShader.generateWorldPosition(inKey);
+    fragmentShader.addInclude("lightClusters.glsllib");
+
+    QSSGMaterialShaderGenerator::LightVariableNames lightVarNames;
+    lightVarNames.lightPos = QByteArrayLiteral("qt_clusterLightPos");
+    lightVarNames.lightDirection = QByteArrayLiteral("qt_clusterLightDir");
+    lightVarNames.lightColor = QByteArrayLiteral("qt_clusterLightColor");
+    lightVarNames.lightSpecularColor = QByteArrayLiteral("qt_clusterLightSpecular");
+    lightVarNames.lightConeAngle = QByteArrayLiteral("qt_clusterLightDir.w");
+    lightVarNames.lightInnerConeAngle = QByteArrayLiteral("qt_clusterLightColor.w");
+    lightVarNames.lightConstantAttenuation = QByteArrayLiteral("qt_clusterLightAtten.x");
+    lightVarNames.lightLinearAttenuation = QByteArrayLiteral("qt_clusterLightAtten.y");
+    lightVarNames.lightQuadraticAttenuation = QByteArrayLiteral("qt_clusterLightAtten.z");
+
+    fragmentShader << "    //Clustered lights\n"
+                   << "    ivec2 qt_clusterRange = qt_lightClusterRange(qt_varWorldPos);\n"
+                   << "    for (int qt_clusterIter = 0; qt_clusterIter < qt_clusterRange.y; ++qt_clusterIter) {\n"
+                   << "    int qt_clusterLightIdx = qt_lightClusterLightIndex(qt_clusterRange.x + qt_clusterIter);\n"
+                   << "    vec4 qt_clusterLightPos = texelFetch(qt_lightClusterLights, ivec2(0, qt_clusterLightIdx), 0);\n"
+                   << "    vec4 qt_clusterLightDir = texelFetch(qt_lightClusterLights, ivec2(1, qt_clusterLightIdx), 0);\n"
+                   << "    vec4 qt_clusterLightColor = texelFetch(qt_lightClusterLights, ivec2(2, qt_clusterLightIdx), 0);\n"
+                   << "    vec4 qt_clusterLightSpecular = texelFetch(qt_lightClusterLights, ivec2(3, qt_clusterLightIdx), 0);\n"
+                   << "    vec4 qt_clusterLightAtten = texelFetch(qt_lightClusterLights, ivec2(4, qt_clusterLightIdx), 0);\n"
+                   << "    qt_shadow_map_occl = 1.0;\n";
+
+    generateTempLightColor(fragmentShader, lightVarNames, materialAdapter);
+
+    const QByteArray lightVarPrefix = QByteArrayLiteral("qt_clusterLight_");
+    generateDirections(fragmentShader, lightVarNames, lightVarPrefix, vertexShader, inKey);
+
+    calculatePointLightAttenuation(fragmentShader, lightVarNames);
+
+    addTranslucencyIrradiance(fragmentShader, translucencyImage, lightVarNames);
+
+    fragmentShader << "    if (qt_clusterLightPos.w > 0.5) {\n";
+    handleSpotLight(fragmentShader,
+                    lightVarNames,
+                    lightVarPrefix,
+                    materialAdapter,
+                    shaderLibraryManager,
+                    usesSharedVar,
+                    hasCustomFrag,
+                    specularLightingEnabled,
+                    enableClearcoat,
+                    enableTransmission);
+    fragmentShader << "    } else {\n";
+    handlePointLight(fragmentShader,
+                     lightVarNames,
+                     materialAdapter,
+                     shaderLibraryManager,
+                     usesSharedVar,
+                     hasCustomFrag,
+                     specularLightingEnabled,
+                     enableClearcoat,
+                     enableTransmission);
+    fragmentShader << "    }\n";
+    fragmentShader << "    }\n";
+}
+
 static void generateMainLightCalculation(QSSGStageGeneratorBase &fragmentShader,
                                            QSSGMaterialVertexPipeline &vertexShader,
                                            const QSSGShaderDefaultMaterialKey &inKey,
@@ -788,6 +864,7 @@ static void generateMainLightCalculation(QSSGStageGeneratorBase &fragmentShader,
                                            bool usesSharedVar,
                                            bool enableLightmap,
                                            bool enableShadowMaps,
+                                           bool enableClusteredLights,
                                            bool specularLightingEnabled,
                                            bool enableClearcoat,
                                            bool enableTransmission)
@@ -881,6 +958,20 @@ static void generateMainLightCalculation(QSSGStageGeneratorBase &fragmentShader,
         }
     }
 
+    if (enableClusteredLights) {
+        generateClusteredLightCalculation(fragmentShader,
+                                          vertexShader,
+                                          inKey,
+                                          materialAdapter,
+                                          shaderLibraryManager,
+                                          translucencyImage,
+                                          hasCustomFrag,
+                                          usesSharedVar,
+                                          specularLightingEnabled,
+                                          enableClearcoat,
+                                          enableTransmission);
+    }
+
     fragmentShader.append("");
 }
 
@@ -1044,6 +1135,9 @@ static void generateFragmentShader(QSSGStageGeneratorBase &fragmentShader,
     const int viewCount = featureSet.isSet(QSSGShaderFeatures::Feature::DisableMultiView)
         ? 1 : keyProps.m_viewCount.getValue(inKey);
 
+    // The light clusters are built for a single view
+    const bool enableClusteredLights = featureSet.isSet(QSSGShaderFeatures::Feature::ClusteredLights) && viewCount < 2;
+
     // Morphing
     if (numMorphTargets > 0 || hasCustomVert) {
         vertexShader.addDefinition(QByteArrayLiteral("QT_MORPH_MAX_COUNT"),
@@ -1503,7 +1597,7 @@ static void generateFragmentShader(QSSGStageGeneratorBase &fragmentShader,
 
         fragmentShader.append("    vec3 global_specular_light = vec3(0.0);");
 
-        if (!lights.isEmpty() || hasCustomFrag) {
+        if (!lights.isEmpty() || enableClusteredLights || hasCustomFrag) {
             fragmentShader.append("    float qt_shadow_map_occl = 1.0;");
             fragmentShader.append("    float qt_lightAttenuation = 1.0;");
         }
@@ -1704,7 +1798,7 @@ static void generateFragmentShader(QSSGStageGeneratorBase &fragmentShader,
         if (specularLightingEnabled) {
             if (materialAdapter->isPrincipled() || materialAdapter->isSpecularGlossy()) {
                 fragmentShader.addInclude("principledMaterialFresnel.glsllib");
-                const bool useF90 = !lights.isEmpty() || enableTransmission;
+                const bool useF90 = !lights.isEmpty() || enableClusteredLights || enableTransmission;
                 addLocalVariable(fragmentShader, "qt_f0", "vec3");
                 if (useF90)
                     addLocalVariable(fragmentShader, "qt_f90", "vec3");
@@ -1767,7 +1861,7 @@ static void generateFragmentShader(QSSGStageGeneratorBase &fragmentShader,
             }
         }
 
-        if (!lights.isEmpty()) {
+        if (!lights.isEmpty() || enableClusteredLights) {
             generateMainLightCalculation(fragmentShader,
                                          vertexShader,
                                          inKey,
@@ -1779,6 +1873,7 @@ static void generateFragmentShader(QSSGStageGeneratorBase &fragmentShader,
                                          usesSharedVar,
                                          enableLightmap,
                                          enableShadowMaps,
+                                         enableClusteredLights,
                                          specularLightingEnabled,
                                          enableClearcoat,
                                          enableTransmission);
@@ -2111,6 +2206,7 @@ void QSSGMaterialShaderGenerator::setRhiMaterialProperties(const QSSGRenderConte
                                                            QSSGRenderableImage *inFirstImage,
                                                            float inOpacity,
                                                            const QSSGLayerRenderData &inRenderProperties,
+                                                           const QSSGShaderFeatures &featureSet,
                                                            const QSSGShaderLightListView &inLights,
                                                            const QSSGShaderReflectionProbe &reflectionProbe,
                                                            bool receivesShadows,
@@ -2403,6 +2499,28 @@ void QSSGMaterialShaderGenerator::setRhiMaterialProperties(const QSSGRenderConte
     shaders.setScreenTexture(screenTexture->texture);
     shaders.setLightmapTexture(lightmapTexture);
 
+    // Only when the shaders of this pass read the clusters. Passes rendering
+    // from another camera, like the reflection probe faces, light the objects
+    // without them.
+    if (featureSet.isSet(QSSGShaderFeatures::Feature::ClusteredLights) && viewCount < 2) {
+        const auto &lightClusters = inRenderProperties.lightClusters;
+        shaders.setLightClusterTextures(lightClusters.gridTexture, lightClusters.lightsTexture);
+        const QMatrix4x4 clusterViewProjection = lightClusters.grid.viewProjection();
+        shaders.setUniform(ubufData, "qt_lightClusterViewProjection", clusterViewProjection.constData(), 16 * sizeof(float), &cui.lightClusterViewProjectionIdx);
+        const QVector4D clusterDepthPlane = lightClusters.grid.viewDepthPlane();
+        shaders.setUniform(ubufData, "qt_lightClusterDepthPlane", &clusterDepthPlane, 4 * sizeof(float), &cui.lightClusterDepthPlaneIdx);
+        const float clusterProperties[4] = {
+            lightClusters.grid.sliceScale(),
+            lightClusters.grid.sliceBias(),
+            float(QSSGLightClusterGrid::ClusterCount),
+            0.0f
+        };
+        shaders.setUniform(ubufData, "qt_lightClusterProperties", clusterProperties, 4 * sizeof(float), &cui.lightClusterPropertiesIdx);
+        theLightAmbientTotal += lightClusters.ambientTotal;
+    } else {
+        shaders.setLightClusterTextures(nullptr, nullptr);
+    }
+
     const QSSGRenderLayer &layer = QSSGLayerRenderData::getCurrent(*renderContext.renderer())->layer;
     QSSGRenderImage *theLightProbe = layer.lightProbe;
     const auto &lightProbeData = layer.lightProbeSettings;
@@ -90,6 +90,7 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGMaterialShaderGenerator
                                          QSSGRenderableImage *inFirstImage,
                                          float inOpacity,
                                          const QSSGLayerRenderData &inRenderProperties,
+                                         const QSSGShaderFeatures &featureSet,
                                          const QSSGShaderLightListView &inLights,
                                          const QSSGShaderReflectionProbe &reflectionProbe,
                                          bool receivesShadows,
@@ -17,6 +17,7 @@
 //
 
 #include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhimeshpool_p.h>
 
 #include <QtQuick3DUtils/private/qssgbounds3_p.h>
 #include <QtQuick3DUtils/private/qssgmeshbvh_p.h>
@@ -34,6 +35,9 @@ struct QSSGRenderSubset
         QSSGRhiBufferPtr indexBuffer;
         QSSGRhiInputAssemblerState ia;
         QRhiTexture *targetsTexture = nullptr;
+        // Non-zero when the data lives in a pooled buffer shared with other meshes
+        quint32 baseVertex = 0;
+        quint32 baseIndex = 0;
     } rhi;
 
     struct Lod {
@@ -99,6 +103,9 @@ struct QSSGRenderMesh
     QSSGRenderWinding winding;
     std::unique_ptr<QSSGMeshBVH> bvh;
     QSize lightmapSizeHint;
+    // Valid when the vertex/index data is sub-allocated from the mesh pool
+    QSSGRhiMeshPool::Allocation pooledVertexData;
+    QSSGRhiMeshPool::Allocation pooledIndexData;
 
     QSSGRenderMesh(QSSGRenderDrawMode inDrawMode, QSSGRenderWinding inWinding)
         : drawMode(inDrawMode), winding(inWinding)
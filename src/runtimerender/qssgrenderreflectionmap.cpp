@@ -13,6 +13,7 @@ const int prefilterSampleCount = 16;
 QSSGRenderReflectionMap::QSSGRenderReflectionMap(const QSSGRenderContextInterface &inContext)
     : m_context(inContext)
 {
+    m_scheduler.setBudgetFromEnvironment();
 }
 
 QSSGRenderReflectionMap::~QSSGRenderReflectionMap()
@@ -65,12 +66,18 @@ void QSSGRenderReflectionMap::addReflectionMapEntry(qint32 probeIdx, const QSSGR
     QSize pixelSize(mapRes, mapRes);
     QSSGReflectionMapEntry *pEntry = reflectionMapEntry(probeIdx);
 
+    // Baking reads the prefiltered map back
+    const bool bakeRequested = QSSGReflectionProbeBaker::bakeRequested();
+    QRhiTexture::Flags prefilteredFlags = QRhiTexture::RenderTarget | QRhiTexture::CubeMap
+            | QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips;
+    if (bakeRequested)
+        prefilteredFlags |= QRhiTexture::UsedAsTransferSource;
+
     if (!pEntry) {
         QRhiRenderBuffer *depthStencil = allocateRhiReflectionRenderBuffer(rhi, QRhiRenderBuffer::DepthStencil, pixelSize);
         QRhiTexture *map = allocateRhiReflectionTexture(rhi, rhiFormat, pixelSize, QRhiTexture::RenderTarget | QRhiTexture::CubeMap
                                                                     | QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips);
-        QRhiTexture *prefiltered = allocateRhiReflectionTexture(rhi, rhiFormat, pixelSize, QRhiTexture::RenderTarget | QRhiTexture::CubeMap
-                                                                            | QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips);
+        QRhiTexture *prefiltered = allocateRhiReflectionTexture(rhi, rhiFormat, pixelSize, prefilteredFlags);
         m_reflectionMapList.push_back(QSSGReflectionMapEntry::withRhiCubeMap(probeIdx, map, prefiltered, depthStencil));
 
         pEntry = &m_reflectionMapList.back();
@@ -84,11 +91,11 @@ void QSSGRenderReflectionMap::addReflectionMapEntry(qint32 probeIdx, const QSSGR
 
         if (!pEntry->m_rhiDepthStencil || mapRes != pEntry->m_rhiCube->pixelSize().width()) {
             pEntry->destroyRhiResources();
+            pEntry->m_baked = false;
             pEntry->m_rhiDepthStencil = allocateRhiReflectionRenderBuffer(rhi, QRhiRenderBuffer::DepthStencil, pixelSize);
             pEntry->m_rhiCube = allocateRhiReflectionTexture(rhi, rhiFormat, pixelSize, QRhiTexture::RenderTarget | QRhiTexture::CubeMap
                                                                          | QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips);
-            pEntry->m_rhiPrefilteredCube = allocateRhiReflectionTexture(rhi, rhiFormat, pixelSize, QRhiTexture::RenderTarget | QRhiTexture::CubeMap
-                                                                                    | QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips);
+            pEntry->m_rhiPrefilteredCube = allocateRhiReflectionTexture(rhi, rhiFormat, pixelSize, prefilteredFlags);
         }
 
         // Additional graphics resources: samplers, render targets.
@@ -251,7 +258,9 @@ void QSSGRenderReflectionMap::addReflectionMapEntry(qint32 probeIdx, const QSSGR
                 qWarning("failed to create irradiance reflection map pipeline state");
         }
 
-        pEntry->m_timeSlicing = probe.timeSlicing;
+        // The baked map has to be complete after the first frame
+        pEntry->m_timeSlicing = bakeRequested ? QSSGRenderReflectionProbe::ReflectionTimeSlicing::None
+                                              : probe.timeSlicing;
         pEntry->m_probeIndex = probeIdx;
         Q_QUICK3D_PROFILE_ASSIGN_ID(&probe, pEntry);
     }
@@ -274,6 +283,27 @@ void QSSGRenderReflectionMap::addTexturedReflectionMapEntry(qint32 probeIdx, con
     }
 }
 
+bool QSSGRenderReflectionMap::addBakedReflectionMapEntry(qint32 probeIdx, const QByteArray &contentKey)
+{
+    const QSSGRenderImageTexture bakedTexture = m_context.bufferManager()->loadBakedReflectionMap(QSSGReflectionProbeBaker::bakedMapPath(contentKey));
+    if (!bakedTexture.m_texture)
+        return false;
+
+    QSSGReflectionMapEntry *pEntry = reflectionMapEntry(probeIdx);
+    if (!pEntry) {
+        m_reflectionMapList.push_back(QSSGReflectionMapEntry::withRhiTexturedCubeMap(probeIdx, bakedTexture.m_texture));
+        pEntry = &m_reflectionMapList.back();
+    } else {
+        if (pEntry->m_rhiDepthStencil)
+            pEntry->destroyRhiResources();
+        pEntry->m_rhiPrefilteredCube = bakedTexture.m_texture;
+    }
+    pEntry->m_bakeKey = contentKey;
+    pEntry->m_baked = true;
+    pEntry->m_needsRender = false;
+    return true;
+}
+
 QSSGReflectionMapEntry *QSSGRenderReflectionMap::reflectionMapEntry(int probeIdx)
 {
     Q_ASSERT(probeIdx >= 0);
@@ -608,6 +638,7 @@ QSSGReflectionMapEntry QSSGReflectionMapEntry::withRhiCubeMap(quint32 probeIdx,
 
 void QSSGReflectionMapEntry::destroyRhiResources()
 {
+    m_contentKey = 0;
     delete m_rhiCube;
     m_rhiCube = nullptr;
     // Without depth stencil the prefiltered cubemap is assumed to be not owned here and shouldn't be deleted
@@ -17,6 +17,8 @@
 
 #include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderreflectionprobe_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgreflectionprobescheduler_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgreflectionprobebaker_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -73,6 +75,13 @@ struct QSSGReflectionMapEntry
 
     bool m_needsRender = false;
     bool m_rendered = false;
+    // Frames since the cube map was last rendered, and a key for what it saw
+    quint32 m_framesSinceUpdate = 0;
+    size_t m_contentKey = 0;
+    // Set for static probes: the key of the baked map in use, or in bake mode
+    // the key the rendered map is to be baked with.
+    QByteArray m_bakeKey;
+    bool m_baked = false;
 
     QSSGRenderReflectionProbe::ReflectionTimeSlicing m_timeSlicing = QSSGRenderReflectionProbe::ReflectionTimeSlicing::None;
     int m_timeSliceFrame = 1;
@@ -94,13 +103,21 @@ public:
 
     void addReflectionMapEntry(qint32 probeIdx, const QSSGRenderReflectionProbe &probe);
     void addTexturedReflectionMapEntry(qint32 probeIdx, const QSSGRenderReflectionProbe &probe);
+    // Uses the map baked for the content key instead of rendering the probe.
+    // Returns false when there is no such map.
+    bool addBakedReflectionMapEntry(qint32 probeIdx, const QByteArray &contentKey);
 
     QSSGReflectionMapEntry *reflectionMapEntry(int probeIdx);
 
     qint32 reflectionMapEntryCount() { return m_reflectionMapList.size(); }
 
+    QSSGReflectionProbeScheduler &scheduler() { return m_scheduler; }
+    QSSGReflectionProbeBaker &baker() { return m_baker; }
+
 private:
     TReflectionMapEntryList m_reflectionMapList;
+    QSSGReflectionProbeScheduler m_scheduler;
+    QSSGReflectionProbeBaker m_baker;
 };
 
 using QSSGRenderReflectionMapPtr = std::shared_ptr<QSSGRenderReflectionMap>;
@@ -78,6 +78,7 @@ static constexpr DefineEntry DefineTable[] {
     { "QSSG_ENABLE_LIGHTMAP", QSSGShaderFeatures::Feature::Lightmap },
     { "QSSG_DISABLE_MULTIVIEW", QSSGShaderFeatures::Feature::DisableMultiView },
     { "QSSG_FORCE_IBL_EXPOSURE", QSSGShaderFeatures::Feature::ForceIblExposure },
+    { "QSSG_ENABLE_CLUSTERED_LIGHTS", QSSGShaderFeatures::Feature::ClusteredLights },
 };
 
 static_assert(std::size(DefineTable) == QSSGShaderFeatures::Count, "Missing feature define?");
@@ -382,6 +383,75 @@ QByteArray QSSGShaderCache::shaderCollectionFile()
     return QByteArrayLiteral("qtappshaders.qsbc");
 }
 
+void QSSGShaderCache::initRhiBaker(QShaderBaker *baker, int viewCount, bool perTargetCompilation) const
+{
+#ifdef QT_QUICK3D_HAS_RUNTIME_SHADERS
+    m_initBaker(baker, m_rhiContext.rhi());
+
+    // If requested, per-target compilation allows doing things like #if
+    // QSHADER_HLSL in the shader code, at the expense of spending more time in
+    // bake())
+    baker->setPerTargetCompilation(perTargetCompilation);
+
+    // This is in the shader key, but cannot query that here anymore now that it's serialized.
+    // So we get it as a dedicated argument.
+    baker->setMultiViewCount(viewCount);
+
+    // For fragment shaders for GLSL ES (but only ES) we can make the generated
+    // sources contain 'precision mediump float' instead of 'precision highp float'.
+    const bool mediumPrecision = qEnvironmentVariableIntValue("QT_QUICK3D_MEDIUM_PRECISION");
+    if (mediumPrecision)
+        baker->setGlslOptions(QShaderBaker::GlslOption::GlslEsFragDefaultFloatPrecisionMedium);
+#else
+    Q_UNUSED(baker);
+    Q_UNUSED(viewCount);
+    Q_UNUSED(perTargetCompilation);
+#endif
+}
+
+bool QSSGShaderCache::bakeForRhi(const QByteArray &vertexCode,
+                                 const QByteArray &fragmentCode,
+                                 int viewCount,
+                                 bool perTargetCompilation,
+                                 QShader *vertexShader,
+                                 QShader *fragmentShader,
+                                 QString *errorMessage) const
+{
+#ifdef QT_QUICK3D_HAS_RUNTIME_SHADERS
+    // Does not touch any state of the cache, so it is safe to call from
+    // multiple threads as long as the init baker function is. Each call has
+    // its own QShaderBaker. glslang is initialized for the process on the
+    // first compilation, which callers should not run concurrently.
+    QShaderBaker baker;
+    initRhiBaker(&baker, viewCount, perTargetCompilation);
+
+    baker.setSourceString(vertexCode, QShader::VertexStage);
+    *vertexShader = baker.bake();
+    if (!vertexShader->isValid()) {
+        *errorMessage = QLatin1String("Failed to compile vertex shader: ") + baker.errorMessage();
+        return false;
+    }
+
+    baker.setSourceString(fragmentCode, QShader::FragmentStage);
+    *fragmentShader = baker.bake();
+    if (!fragmentShader->isValid()) {
+        *errorMessage = QLatin1String("Failed to compile fragment shader: ") + baker.errorMessage();
+        return false;
+    }
+
+    return true;
+#else
+    Q_UNUSED(vertexCode);
+    Q_UNUSED(fragmentCode);
+    Q_UNUSED(viewCount);
+    Q_UNUSED(perTargetCompilation);
+    Q_UNUSED(vertexShader);
+    Q_UNUSED(fragmentShader);
+    *errorMessage = QLatin1String("Shader Tools are not available");
+    return false;
+#endif
+}
+
 QSSGRhiShaderPipelinePtr QSSGShaderCache::compileForRhi(const QByteArray &inKey, const QByteArray &inVert, const QByteArray &inFrag,
                                                         const QSSGShaderFeatures &inFeatures, QSSGRhiShaderPipeline::StageFlags stageFlags,
                                                         int viewCount,
@@ -407,26 +477,18 @@ QSSGRhiShaderPipelinePtr QSSGShaderCache::compileForRhi(const QByteArray &inKey,
 
     // lo and behold the final shader strings are ready
 
+    if (m_deferredBake) {
+        // The empty pipeline is cached as well so that each variant is handed
+        // out only once.
+        m_deferredBake(inKey, inFeatures, vertexCode, fragmentCode, viewCount, perTargetCompilation);
+        return m_rhiShaders.insert(tempKey, std::make_shared<QSSGRhiShaderPipeline>(m_rhiContext)).value();
+    }
+
     QSSGRhiShaderPipelinePtr shaders;
     QString vertErr, fragErr;
 
     QShaderBaker baker;
-    m_initBaker(&baker, m_rhiContext.rhi());
-
-    // If requested, per-target compilation allows doing things like #if
-    // QSHADER_HLSL in the shader code, at the expense of spending more time in
-    // bake())
-    baker.setPerTargetCompilation(perTargetCompilation);
-
-    // This is in the shader key, but cannot query that here anymore now that it's serialized.
-    // So we get it as a dedicated argument.
-    baker.setMultiViewCount(viewCount);
-
-    // For fragment shaders for GLSL ES (but only ES) we can make the generated
-    // sources contain 'precision mediump float' instead of 'precision highp float'.
-    const bool mediumPrecision = qEnvironmentVariableIntValue("QT_QUICK3D_MEDIUM_PRECISION");
-    if (mediumPrecision)
-        baker.setGlslOptions(QShaderBaker::GlslOption::GlslEsFragDefaultFloatPrecisionMedium);
+    initRhiBaker(&baker, viewCount, perTargetCompilation);
 
     const bool editorMode = QSSGRhiContextPrivate::editorMode();
     // Shader debug is disabled in editor mode
@@ -683,6 +745,30 @@ QSSGRhiShaderPipelinePtr QSSGShaderCache::loadBuiltinUncached(const QByteArray &
     return shaders;
 }
 
+QShader QSSGShaderCache::loadBuiltinComputeUncached(const QByteArray &inKey)
+{
+    const bool shaderDebug = !QSSGRhiContextPrivate::editorMode() && QSSGRhiContextPrivate::shaderDebuggingEnabled();
+    if (shaderDebug)
+        qDebug("Loading builtin rhi compute shader: %s", inKey.constData());
+
+    Q_TRACE_SCOPE(QSSG_loadShader);
+    Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DLoadShader);
+
+    // inKey is a prefix of a .qsb file, so "abc" means we should look for abc.comp.qsb
+    QShader computeShader;
+    QFile f(QString::fromUtf8(resourceFolder() + inKey) + QLatin1String(".comp.qsb"));
+    if (f.open(QIODevice::ReadOnly)) {
+        computeShader = QShader::fromSerialized(f.readAll());
+        f.close();
+    } else {
+        qWarning("Failed to open %s", qPrintable(f.fileName()));
+    }
+
+    Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DLoadShader, 0, inKey);
+
+    return computeShader;
+}
+
 namespace QtQuick3DEditorHelpers {
 void ShaderBaker::setStatusCallback(StatusCallback cb)
 {
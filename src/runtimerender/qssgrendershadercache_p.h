@@ -28,6 +28,8 @@
 #include <QtCore/QSharedPointer>
 #include <QtCore/QVector>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 
 class QSSGRenderContextInterface;
@@ -83,6 +85,7 @@ enum class Feature : FlagType
     Lightmap = (1 << 23) + 15,
     DisableMultiView = (1 << 24) + 16,
     ForceIblExposure = (1 << 25) + 17,
+    ClusteredLights = (1 << 26) + 18,
 
     LastFeature
 };
@@ -172,6 +175,12 @@ public:
     };
 
     using InitBakerFunc = void (*)(QShaderBaker *baker, QRhi *rhi);
+    using DeferredBakeFunc = std::function<void(const QByteArray &inKey,
+                                                const QSSGShaderFeatures &inFeatures,
+                                                const QByteArray &vertexCode,
+                                                const QByteArray &fragmentCode,
+                                                int viewCount,
+                                                bool perTargetCompilation)>;
 private:
     friend class QSSGBuiltInRhiShaderCache;
 
@@ -181,11 +190,13 @@ private:
     QByteArray m_insertStr;   // member to potentially reuse the allocation after clear
     QByteArray m_cacheKeyStr; // same here
     InitBakerFunc m_initBaker;
+    DeferredBakeFunc m_deferredBake;
     QQsbInMemoryCollection m_persistentShaderBakingCache;
     QString m_persistentShaderStorageFileName;
     QSSGBuiltInRhiShaderCache m_builtInShaders;
 
     QSSGRhiShaderPipelinePtr loadBuiltinUncached(const QByteArray &inKey, int viewCount);
+    QShader loadBuiltinComputeUncached(const QByteArray &inKey);
 
     void addShaderPreprocessor(QByteArray &str,
                                const QByteArray &inKey,
@@ -193,6 +204,8 @@ private:
                                const QSSGShaderFeatures &inFeatures,
                                int viewCount);
 
+    void initRhiBaker(QShaderBaker *baker, int viewCount, bool perTargetCompilation) const;
+
 public:
     QSSGShaderCache(QSSGRhiContext &ctx,
                     const InitBakerFunc initBakeFn = nullptr);
@@ -224,6 +237,19 @@ public:
                                            int viewCount,
                                            bool perTargetCompilation);
 
+    // For offline tools (shadergen): when set, compileForRhi() does not bake
+    // but passes the final sources to the callback and returns an empty
+    // pipeline. The sources can then be baked later with bakeForRhi(), on
+    // any thread once the first bake (which initializes glslang) is done.
+    void setDeferredBakeFunc(DeferredBakeFunc bakeFn) { m_deferredBake = std::move(bakeFn); }
+    bool bakeForRhi(const QByteArray &vertexCode,
+                    const QByteArray &fragmentCode,
+                    int viewCount,
+                    bool perTargetCompilation,
+                    QShader *vertexShader,
+                    QShader *fragmentShader,
+                    QString *errorMessage) const;
+
     QSSGBuiltInRhiShaderCache &getBuiltInRhiShaders() { return m_builtInShaders; }
 
     static QByteArray resourceFolder();
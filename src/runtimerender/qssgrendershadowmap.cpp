@@ -56,6 +56,7 @@ static quint32 indexToMapSize(quint8 index)
 QSSGRenderShadowMap::QSSGRenderShadowMap(const QSSGRenderContextInterface &inContext)
     : m_context(inContext)
 {
+    m_cachingEnabled = qEnvironmentVariableIntValue("QT_QUICK3D_NO_SHADOW_MAP_CACHE") == 0;
 }
 
 QSSGRenderShadowMap::~QSSGRenderShadowMap()
@@ -75,6 +76,16 @@ void QSSGRenderShadowMap::releaseCachedResources()
     m_shadowMapList.clear();
 }
 
+void QSSGRenderShadowMap::setCachingEnabled(bool enable)
+{
+    if (m_cachingEnabled == enable)
+        return;
+
+    m_cachingEnabled = enable;
+    for (QSSGShadowMapEntry &entry : m_shadowMapList)
+        entry.m_renderedContentKey = {};
+}
+
 void QSSGRenderShadowMap::addShadowMaps(const QSSGShaderLightList &renderableLights)
 {
     QRhi *rhi = m_context.rhiContext()->rhi();
@@ -219,7 +230,10 @@ QSSGShadowMapEntry *QSSGRenderShadowMap::addDirectionalShadowMap(qint32 lightIdx
             qWarning("Failed to build shadow map render target");
 
         const QByteArray rtName = renderNodeObjName.toLatin1();
-        rt->setName(rtName + QByteArrayLiteral(" shadow map"));
+        if (csmNumSplits > 0)
+            rt->setName(rtName + QByteArrayLiteral(" shadow map cascade: ") + QByteArray::number(splitIndex));
+        else
+            rt->setName(rtName + QByteArrayLiteral(" shadow map"));
     }
 
     pEntry->m_lightIndex = lightIdx;
@@ -66,6 +66,10 @@ struct QSSGShadowMapEntry
     float m_csmSplits[4] = {};
     float m_csmActive[4] = {};
     float m_shadowMapFar = 0.f;
+
+    // Identifies what was last rendered into each cascade (VSM) or cube face
+    // (CUBE). 0 means the content must be rendered.
+    std::array<size_t, 6> m_renderedContentKey = {};
 };
 
 class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderShadowMap
@@ -84,12 +88,18 @@ public:
 
     qsizetype shadowMapEntryCount() { return m_shadowMapList.size(); }
 
+    // When enabled, shadow maps are only re-rendered when the light, the
+    // shadow cameras or the shadow casting objects have changed.
+    bool isCachingEnabled() const { return m_cachingEnabled; }
+    void setCachingEnabled(bool enable);
+
 private:
     QSSGShadowMapEntry *addDirectionalShadowMap(qint32 lightIdx, QSize size, quint32 layerStartIndex, quint32 csmNumSplits, const QString &renderNodeObjName);
     QSSGShadowMapEntry *addCubeShadowMap(qint32 lightIdx, QSize size, const QString &renderNodeObjName);
 
     QVector<QSSGShadowMapEntry> m_shadowMapList;
     QHash<QSize, QRhiTexture *> m_depthTextureArrays;
+    bool m_cachingEnabled = true;
 };
 
 using QSSGRenderShadowMapPtr = std::shared_ptr<QSSGRenderShadowMap>;
@@ -3,6 +3,7 @@
 
 #include "qssgrhicontext_p.h"
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qvariant.h>
 #include <QtGui/private/qrhi_p.h>
 
@@ -11,10 +12,14 @@
 #include <QtQuick3DUtils/private/qssgassert_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderableimage_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendermesh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhimeshpool_p.h>
 #include <QtQuick3DUtils/private/qssgutils_p.h>
 #include <QtQuick3DUtils/private/qssgassert_p.h>
 #include <qtquick3d_tracepoints_p.h>
 
+#include <algorithm>
+#include <cmath>
+
 QT_BEGIN_NAMESPACE
 
 Q_TRACE_POINT(qtquick3d, QSSG_renderPass_entry, const QString &renderPass);
@@ -294,6 +299,19 @@ QRhiVertexInputAttribute::Format toVertexInputFormat(QSSGRenderComponentType com
         default:
             break;
         }
+    } else if (compType == QSSGRenderComponentType::Float16) {
+        switch (numComps) {
+        case 1:
+            return QRhiVertexInputAttribute::Half;
+        case 2:
+            return QRhiVertexInputAttribute::Half2;
+        case 3:
+            return QRhiVertexInputAttribute::Half3;
+        case 4:
+            return QRhiVertexInputAttribute::Half4;
+        default:
+            break;
+        }
     }
     Q_ASSERT(false);
     return QRhiVertexInputAttribute::Float4;
@@ -1050,6 +1068,7 @@ QSSGRhiContext::~QSSGRhiContext()
 
     qDeleteAll(d->m_textures);
     qDeleteAll(d->m_meshes);
+    delete d->m_meshPool;
 }
 
 /*!
@@ -1196,6 +1215,13 @@ void QSSGRhiContextPrivate::releaseCachedResources()
     }
 
     m_instanceBuffersLod.clear();
+
+    for (const auto &skinnedData : std::as_const(m_skinnedVertexData)) {
+        delete skinnedData.buffer;
+        delete skinnedData.ubuf;
+    }
+
+    m_skinnedVertexData.clear();
 }
 
 QRhiShaderResourceBindings *QSSGRhiContextPrivate::srb(const QSSGRhiShaderResourceBindingList &bindings)
@@ -1338,6 +1364,7 @@ void QSSGRhiContextPrivate::registerTexture(QRhiTexture *texture)
 void QSSGRhiContextPrivate::releaseTexture(QRhiTexture *texture)
 {
     m_textures.remove(texture);
+    m_stats.textureLoads.remove(texture);
     delete texture;
 }
 
@@ -1358,10 +1385,21 @@ void QSSGRhiContextPrivate::releaseMesh(QSSGRenderMesh *mesh)
             }
         }
     }
+    if (mesh && m_meshPool) {
+        m_meshPool->release(mesh->pooledVertexData);
+        m_meshPool->release(mesh->pooledIndexData);
+    }
     m_meshes.remove(mesh);
     delete mesh;
 }
 
+QSSGRhiMeshPool *QSSGRhiContextPrivate::meshPool()
+{
+    if (!m_meshPool)
+        m_meshPool = new QSSGRhiMeshPool(*q_ptr);
+    return m_meshPool;
+}
+
 void QSSGRhiContextPrivate::cleanupDrawCallData(const QSSGRenderModel *model)
 {
     // Find all QSSGRhiUniformBufferSet that reference model
@@ -1443,6 +1481,22 @@ QSSGRhiParticleData &QSSGRhiContextPrivate::particleData(const QSSGRenderGraphOb
     return m_particleData[particlesOrModel];
 }
 
+QSSGRhiSkinnedVertexData &QSSGRhiContextPrivate::skinnedVertexData(const QSSGRenderModel *model)
+{
+    return m_skinnedVertexData[model];
+}
+
+void QSSGRhiContextPrivate::releaseSkinnedVertexData(const QSSGRenderModel *model)
+{
+    auto it = m_skinnedVertexData.find(model);
+    if (it != m_skinnedVertexData.end()) {
+        releaseCachedSrb(it->bindings);
+        delete it->buffer;
+        delete it->ubuf;
+        m_skinnedVertexData.erase(it);
+    }
+}
+
 void QSSGRhiContextStats::start(QSSGRenderLayer *layer)
 {
     layerKey = layer;
@@ -1450,6 +1504,9 @@ void QSSGRhiContextStats::start(QSSGRenderLayer *layer)
     info.renderPasses.clear();
     info.externalRenderPass = {};
     info.currentRenderPassIndex = -1;
+    info.reflectionProbes.clear();
+    info.item2DAtlas = {};
+    info.passTimings.clear();
 }
 
 void QSSGRhiContextStats::stop(QSSGRenderLayer *layer)
@@ -1472,6 +1529,10 @@ void QSSGRhiContextStats::stop(QSSGRenderLayer *layer)
         }
     }
 
+    PerLayerInfo &info(perLayerInfo[layer]);
+    for (const PassTimingInfo &pass : std::as_const(info.passTimings))
+        info.passTimingHistory[pass.name].add(pass.prepareTime + pass.recordTime);
+
     // a new start() may preceed stop() for the previous View3D, must handle this gracefully
     if (layerKey == layer)
         layerKey = nullptr;
@@ -1501,6 +1562,71 @@ void QSSGRhiContextStats::endRenderPass()
     info.currentRenderPassIndex = -1;
 }
 
+static QSSGRhiContextStats::PassTimingInfo &passTiming(QSSGRhiContextStats::PerLayerInfo &info, const char *name)
+{
+    // A handful of passes, a pass may run more than once
+    for (auto &pass : info.passTimings) {
+        if (pass.name == name)
+            return pass;
+    }
+    info.passTimings.append({ QByteArray(name), 0, 0 });
+    return info.passTimings.last();
+}
+
+void QSSGRhiContextStats::passPrepared(const char *name, qint64 nsecs)
+{
+    passTiming(perLayerInfo[layerKey], name).prepareTime += nsecs;
+}
+
+void QSSGRhiContextStats::passRecorded(const char *name, qint64 nsecs)
+{
+    passTiming(perLayerInfo[layerKey], name).recordTime += nsecs;
+}
+
+void QSSGRhiContextStats::TimingHistory::add(qint64 value)
+{
+    if (m_samples.size() < m_capacity) {
+        m_samples.append(value);
+    } else {
+        m_samples[m_next] = value;
+        m_next = (m_next + 1) % m_capacity;
+    }
+}
+
+void QSSGRhiContextStats::expensiveEvent(ExpensiveEventInfo::Type type, const QByteArray &name, qint64 nsecs, quint64 size)
+{
+    // Keeps enough for a few frames even when loading a scene, when nobody
+    // reads them they are dropped in batches.
+    static constexpr qsizetype MaxEventCount = 1024;
+    if (expensiveEvents.size() >= MaxEventCount) {
+        expensiveEvents.remove(0, MaxEventCount / 2);
+        expensiveEventOffset += MaxEventCount / 2;
+    }
+    expensiveEvents.append({ type, name, nsecs, size });
+}
+
+qint64 QSSGRhiContextStats::TimingHistory::percentile(int p) const
+{
+    if (m_samples.isEmpty())
+        return 0;
+    QList<qint64> sorted = m_samples;
+    const qsizetype rank = qBound(qsizetype(0), qsizetype(std::ceil(qBound(0, p, 100) / 100.0 * sorted.size())) - 1, sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted.at(rank);
+}
+
+void QSSGRhiContextStats::reflectionProbeScheduled(const ReflectionProbeInfo &probe)
+{
+    PerLayerInfo &info(perLayerInfo[layerKey]);
+    info.reflectionProbes.append(probe);
+}
+
+void QSSGRhiContextStats::item2DAtlasUpdated(const Item2DAtlasInfo &atlas)
+{
+    PerLayerInfo &info(perLayerInfo[layerKey]);
+    info.item2DAtlas = atlas;
+}
+
 QSSGRhiContextStats &QSSGRhiContextStats::get(QSSGRhiContext &rhiCtx)
 {
     return QSSGRhiContextPrivate::get(&rhiCtx)->m_stats;
@@ -1559,12 +1685,28 @@ void QSSGRhiContextStats::draw(quint32 vertexCount, quint32 instanceCount)
     }
 }
 
+void QSSGRhiContextStats::bindVertexInput(const QRhiBuffer *vertexBuffer, const QRhiBuffer *indexBuffer)
+{
+    PerLayerInfo &info(perLayerInfo[layerKey]);
+    RenderPassInfo &rp(info.currentRenderPassIndex >= 0 ? info.renderPasses[info.currentRenderPassIndex] : info.externalRenderPass);
+    // QRhi skips redundant binds, so only changes are counted
+    if (vertexBuffer != rp.lastVertexBuffer) {
+        rp.lastVertexBuffer = vertexBuffer;
+        rp.bufferBindCount += 1;
+    }
+    if (indexBuffer && indexBuffer != rp.lastIndexBuffer) {
+        rp.lastIndexBuffer = indexBuffer;
+        rp.bufferBindCount += 1;
+    }
+}
+
 void QSSGRhiContextStats::printRenderPass(const QSSGRhiContextStats::RenderPassInfo &rp)
 {
     qDebug("%llu indexed draw calls with %llu indices in total, "
            "%llu non-indexed draw calls with %llu vertices in total",
            rp.indexedDraws.callCount, rp.indexedDraws.vertexOrIndexCount,
            rp.draws.callCount, rp.draws.vertexOrIndexCount);
+    qDebug("%llu vertex and index buffer binds", rp.bufferBindCount);
     if (rp.instancedIndexedDraws.callCount || rp.instancedDraws.callCount) {
         qDebug("%llu instanced indexed draw calls with %llu indices and %llu instances in total, "
                "%llu instanced non-indexed draw calls with %llu indices and %llu instances in total",
@@ -1610,6 +1752,42 @@ void QSSGRhiShaderResourceBindingList::addTexture(int binding, QRhiShaderResourc
     d->u.stex.texSamplers[0].sampler = sampler;
 }
 
+void QSSGRhiShaderResourceBindingList::addBufferLoad(int binding, QRhiShaderResourceBinding::StageFlags stage, QRhiBuffer *buf)
+{
+#ifdef QT_DEBUG
+    if (p == QSSGRhiShaderResourceBindingList::MAX_SIZE) {
+        qWarning("Out of shader resource bindings slots (max is %d)", MAX_SIZE);
+        return;
+    }
+#endif
+    QRhiShaderResourceBinding::Data *d = QRhiImplementation::shaderResourceBindingData(v[p++]);
+    h ^= qintptr(buf);
+    d->binding = binding;
+    d->stage = stage;
+    d->type = QRhiShaderResourceBinding::BufferLoad;
+    d->u.sbuf.buf = buf;
+    d->u.sbuf.offset = 0;
+    d->u.sbuf.maybeSize = 0; // 0 = all
+}
+
+void QSSGRhiShaderResourceBindingList::addBufferStore(int binding, QRhiShaderResourceBinding::StageFlags stage, QRhiBuffer *buf)
+{
+#ifdef QT_DEBUG
+    if (p == QSSGRhiShaderResourceBindingList::MAX_SIZE) {
+        qWarning("Out of shader resource bindings slots (max is %d)", MAX_SIZE);
+        return;
+    }
+#endif
+    QRhiShaderResourceBinding::Data *d = QRhiImplementation::shaderResourceBindingData(v[p++]);
+    h ^= qintptr(buf);
+    d->binding = binding;
+    d->stage = stage;
+    d->type = QRhiShaderResourceBinding::BufferStore;
+    d->u.sbuf.buf = buf;
+    d->u.sbuf.offset = 0;
+    d->u.sbuf.maybeSize = 0; // 0 = all
+}
+
 QT_END_NAMESPACE
 
 bool QSSGRhiContextPrivate::shaderDebuggingEnabled()
@@ -1633,6 +1811,8 @@ QRhiGraphicsPipeline *QSSGRhiContextPrivate::pipeline(const QSSGGraphicsPipeline
         return it.value();
 
            // Build a new one. This is potentially expensive.
+    QElapsedTimer timer;
+    timer.start();
     QRhiGraphicsPipeline *ps = m_rhi->newGraphicsPipeline();
     const auto &ia = QSSGRhiInputAssemblerStatePrivate::get(key.state);
 
@@ -1689,6 +1869,8 @@ QRhiGraphicsPipeline *QSSGRhiContextPrivate::pipeline(const QSSGGraphicsPipeline
     }
 
     m_pipelines.insert(key, ps);
+    QSSGRHICTX_STAT(q_ptr, expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::PipelineCreation,
+                                          QByteArray(), timer.nsecsElapsed()));
     return ps;
 }
 
@@ -1698,6 +1880,8 @@ QRhiComputePipeline *QSSGRhiContextPrivate::computePipeline(const QSSGComputePip
     if (it != m_computePipelines.constEnd())
         return it.value();
 
+    QElapsedTimer timer;
+    timer.start();
     QRhiComputePipeline *computePipeline = m_rhi->newComputePipeline();
     computePipeline->setShaderResourceBindings(srb);
     computePipeline->setShaderStage({ QRhiShaderStage::Compute, key.shader });
@@ -1707,6 +1891,8 @@ QRhiComputePipeline *QSSGRhiContextPrivate::computePipeline(const QSSGComputePip
         return nullptr;
     }
     m_computePipelines.insert(key, computePipeline);
+    QSSGRHICTX_STAT(q_ptr, expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::PipelineCreation,
+                                          QByteArrayLiteral("compute"), timer.nsecsElapsed()));
     return computePipeline;
 }
 
@@ -28,6 +28,7 @@ struct QSSGRenderInstanceTable;
 struct QSSGRenderModel;
 struct QSSGRenderMesh;
 class QSSGRenderGraphObject;
+class QSSGRhiMeshPool;
 
 struct QSSGRhiInputAssemblerStatePrivate
 {
@@ -265,6 +266,8 @@ enum class QSSGRhiSamplerBindingHints
     DepthTextureArray,
     ScreenTextureArray,
     AoTextureArray,
+    LightClusterGrid,
+    LightClusterLights,
 
     BindingMapSize
 };
@@ -432,6 +435,9 @@ public:
         int fogDepthPropertiesIdx = -1;
         int fogHeightPropertiesIdx = -1;
         int fogTransmitPropertiesIdx = -1;
+        int lightClusterViewProjectionIdx = -1;
+        int lightClusterDepthPlaneIdx = -1;
+        int lightClusterPropertiesIdx = -1;
 
         struct ImageIndices
         {
@@ -495,6 +501,10 @@ public:
     void setLightmapTexture(QRhiTexture *texture) { m_lightmapTexture = texture; }
     QRhiTexture *lightmapTexture() const { return m_lightmapTexture; }
 
+    void setLightClusterTextures(QRhiTexture *grid, QRhiTexture *lights) { m_lightClusterGridTexture = grid; m_lightClusterLightsTexture = lights; }
+    QRhiTexture *lightClusterGridTexture() const { return m_lightClusterGridTexture; }
+    QRhiTexture *lightClusterLightsTexture() const { return m_lightClusterLightsTexture; }
+
     void resetExtraTextures() { m_extraTextures.clear(); }
     void addExtraTexture(const QSSGRhiTexture &t) { m_extraTextures.append(t); }
     int extraTextureCount() const { return m_extraTextures.size(); }
@@ -533,6 +543,8 @@ private:
     QRhiTexture *m_depthTexture = nullptr;
     QRhiTexture *m_ssaoTexture = nullptr;
     QRhiTexture *m_lightmapTexture = nullptr;
+    QRhiTexture *m_lightClusterGridTexture = nullptr;
+    QRhiTexture *m_lightClusterLightsTexture = nullptr;
     QVarLengthArray<QSSGRhiTexture, 8> m_extraTextures;
 };
 
@@ -575,6 +587,8 @@ public:
 
     void addUniformBuffer(int binding, QRhiShaderResourceBinding::StageFlags stage, QRhiBuffer *buf, int offset = 0 , int size = 0);
     void addTexture(int binding, QRhiShaderResourceBinding::StageFlags stage, QRhiTexture *tex, QRhiSampler *sampler);
+    void addBufferLoad(int binding, QRhiShaderResourceBinding::StageFlags stage, QRhiBuffer *buf);
+    void addBufferStore(int binding, QRhiShaderResourceBinding::StageFlags stage, QRhiBuffer *buf);
 };
 
 inline bool operator==(const QSSGRhiShaderResourceBindingList &a, const QSSGRhiShaderResourceBindingList &b) Q_DECL_NOTHROW
@@ -672,6 +686,19 @@ struct QSSGRhiParticleData
     bool sorting = false;
 };
 
+struct QSSGRhiSkinnedVertexData
+{
+    QRhiBuffer *buffer = nullptr; // owned, the skinned and morphed vertices
+    QRhiBuffer *ubuf = nullptr; // owned
+    QSSGRhiShaderResourceBindingList bindings;
+    // The inputs of the last dispatch
+    const QRhiBuffer *source = nullptr;
+    quint32 sourceDataVersion = 0; // partial updates of custom geometry keep the buffer
+    const QRhiTexture *boneTexture = nullptr;
+    quint32 boneDataVersion = 0;
+    size_t morphWeightsHash = 0;
+};
+
 class QSSGComputePipelineStateKey
 {
 public:
@@ -793,6 +820,57 @@ public:
         DrawInfo draws;
         InstancedDrawInfo instancedIndexedDraws;
         InstancedDrawInfo instancedDraws;
+        // Number of times a different vertex or index buffer got bound
+        quint64 bufferBindCount = 0;
+        const QRhiBuffer *lastVertexBuffer = nullptr;
+        const QRhiBuffer *lastIndexBuffer = nullptr;
+    };
+    struct ReflectionProbeInfo {
+        QByteArray name;
+        quint32 age = 0; // frames since the last update
+        int renderedFaceCount = 0; // in this frame, 0 when deferred or up to date
+        float priority = 0.0f;
+    };
+    struct Item2DAtlasInfo {
+        QSize atlasSize;
+        int cachedItemCount = 0;
+        int renderedItemCount = 0; // in this frame
+        int inlineItemCount = 0; // did not fit into the atlas
+        qint64 usedPixelCount = 0;
+    };
+    struct PassTimingInfo {
+        QByteArray name; // QSSGRenderPass::debugName()
+        qint64 prepareTime = 0; // nanoseconds spent in renderPrep()
+        qint64 recordTime = 0; // nanoseconds spent recording commands in renderPass()
+    };
+    // The last capacity() values, for percentiles over a rolling window
+    class Q_QUICK3DRUNTIMERENDER_EXPORT TimingHistory {
+    public:
+        static constexpr int SampleCount = 240;
+        explicit TimingHistory(int capacity = SampleCount) : m_capacity(qMax(1, capacity)) { }
+        void add(qint64 value);
+        qint64 percentile(int p) const; // nearest rank, 0 when empty
+        int size() const { return int(m_samples.size()); }
+        int capacity() const { return m_capacity; }
+        const QList<qint64> &samples() const { return m_samples; } // not in the order added
+    private:
+        QList<qint64> m_samples;
+        int m_next = 0;
+        int m_capacity;
+    };
+    // One-off work that can make a frame take longer than usual
+    struct ExpensiveEventInfo {
+        enum Type : quint8 {
+            PipelineCreation,
+            ShaderGeneration,
+            TextureUpload,
+            MeshUpload,
+            BvhBuild
+        };
+        Type type = PipelineCreation;
+        QByteArray name; // the resource, may be empty
+        qint64 time = 0; // nanoseconds
+        quint64 size = 0; // bytes, for uploads
     };
     struct PerLayerInfo {
         PerLayerInfo()
@@ -810,16 +888,51 @@ public:
         RenderPassInfo externalRenderPass;
 
         int currentRenderPassIndex = -1;
+
+        // Reflection probes that render their cube map
+        QVector<ReflectionProbeInfo> reflectionProbes;
+
+        // Item2Ds cached in a texture atlas, when enabled
+        Item2DAtlasInfo item2DAtlas;
+
+        // CPU time of each QSSGRenderPass in this frame, in execution
+        // order, plus post-processing effects
+        QVector<PassTimingInfo> passTimings;
+
+        // prepareTime + recordTime of the passes over the last frames,
+        // kept across frames
+        QHash<QByteArray, TimingHistory> passTimingHistory;
     };
     struct GlobalInfo { // global as in per QSSGRhiContext which is per-QQuickWindow
         quint64 meshDataSize = 0;
         quint64 imageDataSize = 0;
         qint64 materialGenerationTime = 0;
         qint64 effectGenerationTime = 0;
+        quint64 residencyHits = 0;
+        quint64 residencyMisses = 0;
+        quint64 residencyEvictions = 0;
+        quint64 residencyCachedSize = 0;
+        quint32 meshPoolBufferCount = 0;
+        quint32 meshPoolAllocationCount = 0;
+        quint64 meshPoolReservedSize = 0;
+        quint64 meshPoolUsedSize = 0;
+        quint64 geometryUploadedSize = 0;
+        quint64 geometryPartialUpdates = 0;
+    };
+    struct TextureLoadInfo {
+        qint64 loadTime = 0; // microseconds, from opening the file to queuing the upload
+        bool cooked = false; // uploaded from a file written by QSSGTextureCooker
     };
 
     QHash<QSSGRenderLayer *, PerLayerInfo> perLayerInfo;
     GlobalInfo globalInfo;
+    // Textures loaded from files, removed when the texture is released
+    QHash<const QRhiTexture *, TextureLoadInfo> textureLoads;
+    // Recent expensive events, recorded when isEnabled(). Readers keep the
+    // number of events they have seen, expensiveEventOffset events were
+    // dropped from the front already.
+    QVector<ExpensiveEventInfo> expensiveEvents;
+    quint64 expensiveEventOffset = 0;
 
     QSSGRhiContextStats(QSSGRhiContext &context)
         : rhiCtx(&context)
@@ -845,6 +958,7 @@ public:
     bool isEnabled() const;
     void drawIndexed(quint32 indexCount, quint32 instanceCount);
     void draw(quint32 vertexCount, quint32 instanceCount);
+    void bindVertexInput(const QRhiBuffer *vertexBuffer, const QRhiBuffer *indexBuffer);
 
     void meshDataSizeChanges(quint64 newSize) // can be called outside start-stop
     {
@@ -856,6 +970,35 @@ public:
         globalInfo.imageDataSize = newSize;
     }
 
+    void residencyStatsChanged(quint64 hits, quint64 misses, quint64 evictions, quint64 cachedSize) // can be called outside start-stop
+    {
+        globalInfo.residencyHits = hits;
+        globalInfo.residencyMisses = misses;
+        globalInfo.residencyEvictions = evictions;
+        globalInfo.residencyCachedSize = cachedSize;
+    }
+
+    void meshPoolStatsChanged(quint32 bufferCount, quint32 allocationCount, quint64 reservedSize, quint64 usedSize) // can be called outside start-stop
+    {
+        globalInfo.meshPoolBufferCount = bufferCount;
+        globalInfo.meshPoolAllocationCount = allocationCount;
+        globalInfo.meshPoolReservedSize = reservedSize;
+        globalInfo.meshPoolUsedSize = usedSize;
+    }
+
+    void geometryUploadStatsChanged(quint64 uploadedSize, quint64 partialUpdates) // can be called outside start-stop
+    {
+        globalInfo.geometryUploadedSize = uploadedSize;
+        globalInfo.geometryPartialUpdates = partialUpdates;
+    }
+
+    void textureLoaded(const QRhiTexture *texture, qint64 loadTime, bool cooked) // can be called outside start-stop
+    {
+        textureLoads.insert(texture, { loadTime, cooked });
+    }
+
+    void expensiveEvent(ExpensiveEventInfo::Type type, const QByteArray &name, qint64 nsecs, quint64 size = 0); // can be called outside start-stop
+
     void registerMaterialShaderGenerationTime(qint64 ms)
     {
         globalInfo.materialGenerationTime += ms;
@@ -886,6 +1029,10 @@ public:
     void stop(QSSGRenderLayer *layer);
     void beginRenderPass(QRhiTextureRenderTarget *rt);
     void endRenderPass();
+    void passPrepared(const char *name, qint64 nsecs);
+    void passRecorded(const char *name, qint64 nsecs);
+    void reflectionProbeScheduled(const ReflectionProbeInfo &probe);
+    void item2DAtlasUpdated(const Item2DAtlasInfo &atlas);
     void printRenderPass(const RenderPassInfo &rp);
     void cleanupLayerInfo(QSSGRenderLayer *layer);
 
@@ -956,6 +1103,11 @@ public:
 
     QSSGRhiParticleData &particleData(const QSSGRenderGraphObject *particlesOrModel);
 
+    QSSGRhiSkinnedVertexData &skinnedVertexData(const QSSGRenderModel *model);
+    void releaseSkinnedVertexData(const QSSGRenderModel *model);
+
+    QSSGRhiMeshPool *meshPool();
+
     QSSGRhiContext *q_ptr = nullptr;
     QRhi *m_rhi = nullptr;
 
@@ -977,6 +1129,8 @@ public:
     QHash<QSSGRenderInstanceTable *, QSSGRhiInstanceBufferData> m_instanceBuffers;
     QHash<const QSSGRenderModel *, QSSGRhiInstanceBufferData> m_instanceBuffersLod;
     QHash<const QSSGRenderGraphObject *, QSSGRhiParticleData> m_particleData;
+    QHash<const QSSGRenderModel *, QSSGRhiSkinnedVertexData> m_skinnedVertexData;
+    QSSGRhiMeshPool *m_meshPool = nullptr; // owned, created on first use
     QSSGRhiContextStats m_stats;
 };
 
@@ -105,6 +105,10 @@ QSSGRhiShaderPipelinePtr QSSGCustomMaterialSystem::shadersForCustomMaterial(QSSG
                                                                                     *context->shaderLibraryManager(),
                                                                                     *context->shaderCache());
             Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DGenerateShader, 0, material.profilingId);
+            QSSGRHICTX_STAT(context->rhiContext().get(),
+                            expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::ShaderGeneration,
+                                           material.debugObjectName.toUtf8(),
+                                           timer.nsecsElapsed()));
         }
 
         // make skey useable as a key for the QHash (makes a copy of the materialKey, instead of just referencing)
@@ -132,6 +136,7 @@ void QSSGCustomMaterialSystem::updateUniformsForCustomMaterial(QSSGRhiShaderPipe
                                                                QSSGRhiGraphicsPipelineState *ps,
                                                                const QSSGRenderCustomMaterial &material,
                                                                QSSGSubsetRenderable &renderable,
+                                                               const QSSGShaderFeatures &featureSet,
                                                                const QSSGRenderCameraList &cameras,
                                                                const QVector2D *depthAdjust,
                                                                const QMatrix4x4 *alteredModelViewProjection)
@@ -169,6 +174,7 @@ void QSSGCustomMaterialSystem::updateUniformsForCustomMaterial(QSSGRhiShaderPipe
                                                           renderable.firstImage,
                                                           renderable.opacity,
                                                           inData,
+                                                          featureSet,
                                                           renderable.lights,
                                                           renderable.reflectionProbe,
                                                           true,
@@ -233,10 +239,10 @@ void QSSGCustomMaterialSystem::rhiPrepareRenderable(QSSGRhiGraphicsPipelineState
         shaderPipeline->ensureCombinedUniformBuffer(&dcd.ubuf);
         char *ubufData = dcd.ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
         if (!alteredCamera) {
-            updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, layerData, ubufData, ps, material, renderable, layerData.renderedCameras, nullptr, nullptr);
+            updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, layerData, ubufData, ps, material, renderable, featureSet, layerData.renderedCameras, nullptr, nullptr);
         } else {
             QSSGRenderCameraList cameras({ alteredCamera });
-            updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, layerData, ubufData, ps, material, renderable, cameras, nullptr, alteredModelViewProjection);
+            updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, layerData, ubufData, ps, material, renderable, featureSet, cameras, nullptr, alteredModelViewProjection);
         }
         if (blendParticles)
             QSSGParticleRenderer::updateUniformsForParticleModel(*shaderPipeline, ubufData, &renderable.modelContext.model, renderable.subset.offset);
@@ -461,6 +467,23 @@ void QSSGCustomMaterialSystem::rhiPrepareRenderable(QSSGRhiGraphicsPipelineState
             } // else ignore, not an error
         }
 
+        if (shaderPipeline->lightClusterGridTexture()) {
+            const int gridBinding = shaderPipeline->bindingForTexture("qt_lightClusterGrid", int(QSSGRhiSamplerBindingHints::LightClusterGrid));
+            const int lightsBinding = shaderPipeline->bindingForTexture("qt_lightClusterLights", int(QSSGRhiSamplerBindingHints::LightClusterLights));
+            if (gridBinding >= 0 && lightsBinding >= 0) {
+                samplerBindingsSpecified.setBit(gridBinding);
+                samplerBindingsSpecified.setBit(lightsBinding);
+                QRhiSampler *sampler = rhiCtx->sampler({ QRhiSampler::Nearest, QRhiSampler::Nearest, QRhiSampler::None,
+                                                         QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge, QRhiSampler::Repeat });
+                bindings.addTexture(gridBinding,
+                                    QRhiShaderResourceBinding::FragmentStage,
+                                    shaderPipeline->lightClusterGridTexture(), sampler);
+                bindings.addTexture(lightsBinding,
+                                    QRhiShaderResourceBinding::FragmentStage,
+                                    shaderPipeline->lightClusterLightsTexture(), sampler);
+            } // else ignore, not an error
+        }
+
         const int shadowMapCount = shaderPipeline->shadowMapCount();
         for (int i = 0; i < shadowMapCount; ++i) {
             QSSGRhiShadowMapProperties &shadowMapProperties(shaderPipeline->shadowMapAt(i));
@@ -652,7 +675,7 @@ void QSSGCustomMaterialSystem::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
         return;
 
     Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderCall);
-    QRhiBuffer *vertexBuffer = renderable.subset.rhi.vertexBuffer->buffer();
+    QRhiBuffer *vertexBuffer = renderable.vertexBuffer();
     QRhiBuffer *indexBuffer = renderable.subset.rhi.indexBuffer ? renderable.subset.rhi.indexBuffer->buffer() : nullptr;
 
     QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
@@ -675,11 +698,14 @@ void QSSGCustomMaterialSystem::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
     }
     if (indexBuffer) {
         cb->setVertexInput(0, vertexBufferCount, vertexBuffers, indexBuffer, 0, renderable.subset.rhi.indexBuffer->indexFormat());
-        cb->drawIndexed(renderable.subset.count, instances, renderable.subset.offset);
+        QSSGRHICTX_STAT(rhiCtx, bindVertexInput(vertexBuffer, indexBuffer));
+        cb->drawIndexed(renderable.subset.count, instances, renderable.subset.rhi.baseIndex + renderable.subset.offset,
+                        qint32(renderable.baseVertex()));
         QSSGRHICTX_STAT(rhiCtx, drawIndexed(renderable.subset.count, instances));
     } else {
         cb->setVertexInput(0, vertexBufferCount, vertexBuffers);
-        cb->draw(renderable.subset.count, instances, renderable.subset.offset);
+        QSSGRHICTX_STAT(rhiCtx, bindVertexInput(vertexBuffer, nullptr));
+        cb->draw(renderable.subset.count, instances, renderable.baseVertex() + renderable.subset.offset);
         QSSGRHICTX_STAT(rhiCtx, draw(renderable.subset.count, instances));
     }
     Q_QUICK3D_PROFILE_END_WITH_IDS(QQuick3DProfiler::Quick3DRenderCall, (renderable.subset.count | quint64(instances) << 32),
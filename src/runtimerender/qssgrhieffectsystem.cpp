@@ -12,6 +12,7 @@
 #include <QtQuick3DUtils/private/qssgassert_p.h>
 
 #include <QtCore/qloggingcategory.h>
+#include <QtCore/qvarlengtharray.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -27,6 +28,7 @@ struct QSSGRhiEffectTexture
 
     QSSGRhiSamplerDescription desc;
     QSSGAllocateBufferFlags flags;
+    quint32 lastUsedFrame = 0;
 
     ~QSSGRhiEffectTexture()
     {
@@ -70,42 +72,54 @@ QSSGRhiEffectTexture *QSSGRhiEffectSystem::getTexture(const QByteArray &bufferNa
                                                       bool isFinalOutput,
                                                       const QSSGRenderEffect *inEffect)
 {
+    const auto &rhiCtx = m_sgContext->rhiContext();
+    QRhi *rhi = rhiCtx->rhi();
+    const int viewCount = rhiCtx->mainPassViewCount();
+
+    QRhiTexture::Flags flags = QRhiTexture::RenderTarget;
+    if (isFinalOutput) // play nice with progressive/temporal AA
+        flags |= QRhiTexture::UsedAsTransferSource;
+    if (viewCount >= 2)
+        flags |= QRhiTexture::TextureArray;
+
     QSSGRhiEffectTexture *result = findTexture(bufferName);
     const bool gotMatch = result != nullptr;
 
-    // If not found, look for an unused texture
+    // If not found, look for an unused texture with the same size, format
+    // and flags. Buffers and outputs that are not alive at the same time
+    // share textures this way, without having to recreate them.
     if (!result) {
-        // ### This could be enhanced to try to find a texture with the right
-        // size/format/flags first. It is not essential because the texture will be
-        // recreated below if the size or format does not match, but it would
-        // be more optimal (for Effects with Buffers with sizeMultipliers on
-        // them, or ones that use different formats) to look for a matching
-        // size/format too instead of picking the first unused texture.
-        auto findUnused = [](const QSSGRhiEffectTexture *rt){ return rt->name.isEmpty(); };
+        auto findUnused = [&](const QSSGRhiEffectTexture *rt) {
+            return rt->name.isEmpty()
+                    && rt->texture->pixelSize() == size
+                    && rt->texture->format() == format
+                    && rt->texture->flags() == flags
+                    && rt->texture->arraySize() == (viewCount >= 2 ? viewCount : 0);
+        };
         const auto found = std::find_if(m_textures.cbegin(), m_textures.cend(), findUnused);
         if (found != m_textures.cend()) {
             result = *found;
             result->desc = {};
+            result->flags = {};
         }
     }
 
+    // Otherwise add a new one, unused textures that do not match anything
+    // anymore are dropped at the end of the frame instead (see trimTextures()).
     if (!result) {
         result = new QSSGRhiEffectTexture {};
         m_textures.append(result);
+        qCDebug(lcEffectSystem) << "Created effect texture" << size << format << "total" << m_textures.size();
     }
 
-    const auto &rhiCtx = m_sgContext->rhiContext();
-    QRhi *rhi = rhiCtx->rhi();
+    result->lastUsedFrame = m_frameCounter;
+
     const bool formatChanged = result->texture && result->texture->format() != format;
     const bool needsRebuild = result->texture && (result->texture->pixelSize() != size || formatChanged);
 
-    QRhiTexture::Flags flags = QRhiTexture::RenderTarget;
-    if (isFinalOutput) // play nice with progressive/temporal AA
-        flags |= QRhiTexture::UsedAsTransferSource;
-
     if (!result->texture) {
-        if (rhiCtx->mainPassViewCount() >= 2)
-            result->texture = rhi->newTextureArray(format, rhiCtx->mainPassViewCount(), size, 1, flags);
+        if (viewCount >= 2)
+            result->texture = rhi->newTextureArray(format, viewCount, size, 1, flags);
         else
             result->texture = rhi->newTexture(format, size, 1, flags);
         result->texture->create();
@@ -160,6 +174,20 @@ void QSSGRhiEffectSystem::releaseTextures()
         releaseTexture(t);
 }
 
+void QSSGRhiEffectSystem::trimTextures()
+{
+    // Unused textures that were not needed in this and the previous frame
+    // (for example because the output size changed) are not coming back.
+    for (qsizetype i = m_textures.size() - 1; i >= 0; --i) {
+        QSSGRhiEffectTexture *t = m_textures.at(i);
+        if (t->name.isEmpty() && t->lastUsedFrame + 1 < m_frameCounter) {
+            m_pendingClears.remove(t->renderTarget);
+            m_textures.removeAt(i);
+            delete t;
+        }
+    }
+}
+
 QRhiTexture *QSSGRhiEffectSystem::process(const QSSGRenderEffect &firstEffect,
                                           QRhiTexture *inTexture,
                                           QRhiTexture *inDepthTexture,
@@ -174,6 +202,7 @@ QRhiTexture *QSSGRhiEffectSystem::process(const QSSGRenderEffect &firstEffect,
     m_cameraClipRange = cameraClipRange;
 
     m_currentUbufIndex = 0;
+    ++m_frameCounter;
     auto *currentEffect = &firstEffect;
     QSSGRhiEffectTexture firstTex{ inTexture, nullptr, nullptr, {}, {}, {} };
     auto *latestOutput = doRenderEffect(currentEffect, &firstTex);
@@ -186,6 +215,7 @@ QRhiTexture *QSSGRhiEffectSystem::process(const QSSGRenderEffect &firstEffect,
     }
 
     releaseTextures();
+    trimTextures();
     return latestOutput ? latestOutput->texture : nullptr;
 }
 
@@ -219,13 +249,14 @@ QSSGRhiEffectTexture *QSSGRhiEffectSystem::doRenderEffect(const QSSGRenderEffect
     QSSGRhiEffectTexture *finalOutputTexture = nullptr;
     QSSGRhiEffectTexture *currentOutput = nullptr;
     QSSGRhiEffectTexture *currentInput = inTexture;
+    QVarLengthArray<QSSGRhiEffectTexture *, 8> allocatedBuffers;
     for (const QSSGRenderEffect::Command &c : inEffect->commands) {
         QSSGCommand *theCommand = c.command;
         qCDebug(lcEffectSystem).noquote() << "    >" << theCommand->typeAsString() << "--" << theCommand->debugString();
 
         switch (theCommand->m_type) {
         case CommandType::AllocateBuffer:
-            allocateBufferCmd(static_cast<QSSGAllocateBuffer *>(theCommand), inTexture, inEffect);
+            allocatedBuffers.append(allocateBufferCmd(static_cast<QSSGAllocateBuffer *>(theCommand), inTexture, inEffect));
             break;
 
         case CommandType::ApplyBufferValue: {
@@ -294,12 +325,17 @@ QSSGRhiEffectTexture *QSSGRhiEffectSystem::doRenderEffect(const QSSGRenderEffect
             break;
         }
     }
-    // TODO: release textures used by this effect now, instead of after processing all the effects
+    // The buffers of this effect are not needed by the next one, so let it
+    // reuse them right away instead of keeping them until the end of the chain.
+    for (QSSGRhiEffectTexture *buffer : std::as_const(allocatedBuffers)) {
+        if (buffer != finalOutputTexture)
+            releaseTexture(buffer);
+    }
     qCDebug(lcEffectSystem) << "END effect " << inEffect->className;
     return finalOutputTexture;
 }
 
-void QSSGRhiEffectSystem::allocateBufferCmd(const QSSGAllocateBuffer *inCmd, QSSGRhiEffectTexture *inTexture, const QSSGRenderEffect *inEffect)
+QSSGRhiEffectTexture *QSSGRhiEffectSystem::allocateBufferCmd(const QSSGAllocateBuffer *inCmd, QSSGRhiEffectTexture *inTexture, const QSSGRenderEffect *inEffect)
 {
     // Note: Allocate is used both to allocate new, and refer to buffer created earlier
     QSize bufferSize(m_outSize * qreal(inCmd->m_sizeMultiplier));
@@ -313,6 +349,7 @@ void QSSGRhiEffectSystem::allocateBufferCmd(const QSSGAllocateBuffer *inCmd, QSS
     auto tiling = QSSGRhiHelpers::toRhi(inCmd->m_texCoordOp);
     buf->desc = { filter, filter, QRhiSampler::None, tiling, tiling, QRhiSampler::Repeat };
     buf->flags = inCmd->m_bufferFlags;
+    return buf;
 }
 
 void QSSGRhiEffectSystem::applyInstanceValueCmd(const QSSGApplyInstanceValue *inCmd, const QSSGRenderEffect *inEffect)
@@ -500,6 +537,10 @@ void QSSGRhiEffectSystem::bindShaderCmd(const QSSGBindShader *inCmd, const QSSGR
             m_currentShaderPipeline = stages.get();
         }
         Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DGenerateShader, 0, inEffect->profilingId);
+        QSSGRHICTX_STAT(m_sgContext->rhiContext().get(),
+                        expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::ShaderGeneration,
+                                       inEffect->debugObjectName.toUtf8(),
+                                       timer.nsecsElapsed()));
     }
 
     const auto &rhiContext = m_sgContext->rhiContext();
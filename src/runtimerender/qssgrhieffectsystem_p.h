@@ -86,7 +86,7 @@ private:
     QSSGRhiEffectTexture *doRenderEffect(const QSSGRenderEffect *inEffect,
                         QSSGRhiEffectTexture *inTexture);
 
-    void allocateBufferCmd(const QSSGAllocateBuffer *inCmd, QSSGRhiEffectTexture *inTexture, const QSSGRenderEffect *inEffect);
+    QSSGRhiEffectTexture *allocateBufferCmd(const QSSGAllocateBuffer *inCmd, QSSGRhiEffectTexture *inTexture, const QSSGRenderEffect *inEffect);
     void applyInstanceValueCmd(const QSSGApplyInstanceValue *inCmd, const QSSGRenderEffect *inEffect);
     void applyValueCmd(const QSSGApplyValue *inCmd, const QSSGRenderEffect *inEffect);
     void bindShaderCmd(const QSSGBindShader *inCmd, const QSSGRenderEffect *inEffect);
@@ -101,6 +101,7 @@ private:
                                      const QSSGRenderEffect *inEffect);
     void releaseTexture(QSSGRhiEffectTexture *texture);
     void releaseTextures();
+    void trimTextures();
 
     QSize m_outSize;
     std::shared_ptr<QSSGRenderContextInterface> m_sgContext;
@@ -113,6 +114,7 @@ private:
     char *m_currentUBufData = nullptr;
     QHash<QByteArray, QSSGRhiTexture> m_currentTextures;
     QSet<QRhiTextureRenderTarget *> m_pendingClears;
+    quint32 m_frameCounter = 0;
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,373 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgrhiitem2dcache_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderitem2d_p.h>
+#include <QtQuick/private/qsgrenderer_p.h>
+
+#include <QtCore/qmath.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+
+// Transparent texels around each slot, so that the bilinear filtering at the
+// edges of the quads fades out instead of picking up the neighbouring slot.
+static constexpr int SlotPadding = 1;
+
+// mat4 mvp[viewCount], vec4 contentRect, vec4 uvRect
+static inline quint32 ubufSize(int viewCount)
+{
+    return quint32(64 * viewCount + 16 + 16);
+}
+
+void QSSGItem2DAtlasPacker::reset(const QSize &size)
+{
+    m_size = size;
+    m_shelves.clear();
+    m_nextShelfY = 0;
+    m_usedPixelCount = 0;
+}
+
+QRect QSSGItem2DAtlasPacker::allocate(const QSize &size)
+{
+    if (size.isEmpty() || size.width() > m_size.width() || size.height() > m_size.height())
+        return {};
+
+    // The lowest shelf the rectangle fits on, to waste as little height as possible
+    Shelf *best = nullptr;
+    for (Shelf &shelf : m_shelves) {
+        if (shelf.height >= size.height() && m_size.width() - shelf.x >= size.width()) {
+            if (!best || shelf.height < best->height)
+                best = &shelf;
+        }
+    }
+
+    if (!best) {
+        if (m_size.height() - m_nextShelfY < size.height())
+            return {};
+        m_shelves.append({ m_nextShelfY, size.height(), 0 });
+        m_nextShelfY += size.height();
+        best = &m_shelves.last();
+    }
+
+    const QRect rect(QPoint(best->x, best->y), size);
+    best->x += size.width();
+    m_usedPixelCount += qint64(size.width()) * size.height();
+    return rect;
+}
+
+QSSGRhiItem2DCache::QSSGRhiItem2DCache()
+{
+    const int size = qEnvironmentVariableIntValue("QT_QUICK3D_ITEM2D_ATLAS_SIZE");
+    m_atlasSize = size > 0 ? QSize(size, size) : QSize(2048, 2048);
+}
+
+QSSGRhiItem2DCache::~QSSGRhiItem2DCache()
+{
+    releaseAtlas();
+}
+
+static std::atomic<bool> &cacheEnabled()
+{
+    static std::atomic<bool> enabled = qEnvironmentVariableIntValue("QT_QUICK3D_CACHED_ITEM2D") > 0;
+    return enabled;
+}
+
+bool QSSGRhiItem2DCache::isEnabled()
+{
+    return cacheEnabled().load(std::memory_order_relaxed);
+}
+
+void QSSGRhiItem2DCache::setEnabled(bool enabled)
+{
+    cacheEnabled().store(enabled, std::memory_order_relaxed);
+}
+
+void QSSGRhiItem2DCache::releaseAtlas()
+{
+    for (Slot &slot : m_slots)
+        delete slot.srb;
+    m_slots.clear();
+    m_overflowItems.clear();
+
+    delete m_ubuf;
+    m_ubuf = nullptr;
+    delete m_sgRpDesc;
+    m_sgRpDesc = nullptr;
+    delete m_rpDesc;
+    m_rpDesc = nullptr;
+    delete m_rt;
+    m_rt = nullptr;
+    delete m_depthStencil;
+    m_depthStencil = nullptr;
+    delete m_texture;
+    m_texture = nullptr;
+}
+
+bool QSSGRhiItem2DCache::ensureAtlas(QSSGRhiContext *rhiCtx)
+{
+    if (m_rt)
+        return true;
+
+    QRhi *rhi = rhiCtx->rhi();
+    const int maxSize = rhi->resourceLimit(QRhi::TextureSizeMax);
+    m_atlasSize = m_atlasSize.boundedTo(QSize(maxSize, maxSize));
+
+    m_texture = rhi->newTexture(QRhiTexture::RGBA8, m_atlasSize, 1, QRhiTexture::RenderTarget);
+    m_texture->setName(QByteArrayLiteral("Item2D atlas"));
+    m_depthStencil = rhi->newRenderBuffer(QRhiRenderBuffer::DepthStencil, m_atlasSize);
+    if (!m_texture->create() || !m_depthStencil->create()) {
+        releaseAtlas();
+        return false;
+    }
+
+    QRhiTextureRenderTargetDescription rtDesc(QRhiColorAttachment(m_texture));
+    rtDesc.setDepthStencilBuffer(m_depthStencil);
+    // Only the slots with changed content are rendered in a frame, the other
+    // slots must stay as they are.
+    m_rt = rhi->newTextureRenderTarget(rtDesc, QRhiTextureRenderTarget::PreserveColorContents);
+    m_rt->setName(QByteArrayLiteral("Item2D atlas"));
+    m_rpDesc = m_rt->newCompatibleRenderPassDescriptor();
+    m_rt->setRenderPassDescriptor(m_rpDesc);
+    if (!m_rt->create()) {
+        releaseAtlas();
+        return false;
+    }
+    // Like for the main pass, the Qt Quick renderers get their own object,
+    // see Item2DPass::renderPrep()
+    m_sgRpDesc = m_rpDesc->newCompatibleRenderPassDescriptor();
+
+    m_packer.reset(m_atlasSize);
+    return true;
+}
+
+QSize QSSGRhiItem2DCache::slotSize(const QRectF &contentRect, float devicePixelRatio) const
+{
+    if (contentRect.isEmpty())
+        return {};
+    return QSize(qCeil(contentRect.width() * devicePixelRatio) + 2 * SlotPadding,
+                 qCeil(contentRect.height() * devicePixelRatio) + 2 * SlotPadding);
+}
+
+void QSSGRhiItem2DCache::repack(const QList<QSSGRenderItem2D *> &items, float devicePixelRatio)
+{
+    m_packer.reset(m_atlasSize);
+    m_overflowItems.clear();
+    for (QSSGRenderItem2D *item : items) {
+        auto it = m_slots.find(item);
+        if (it == m_slots.end())
+            continue;
+        it->rect = m_packer.allocate(slotSize(item->m_contentRect, devicePixelRatio));
+        it->needsRender = true;
+        if (it->rect.isEmpty()) {
+            // Stays inline until the atlas has room again, instead of
+            // repacking and rendering everything again in every frame.
+            m_overflowItems.insert(item);
+            delete it->srb;
+            m_slots.erase(it);
+        }
+    }
+}
+
+QRect QSSGRhiItem2DCache::slotViewport(QRhi *rhi, const Slot &slot) const
+{
+    // The Qt Quick renderer takes a top-left based viewport, and so does the
+    // slot rectangle in the atlas texture's memory. With OpenGL the rows of
+    // the framebuffer go bottom to top, flip so that the content lands in the
+    // same texels as with the other APIs.
+    const QRect inner = slot.rect.adjusted(SlotPadding, SlotPadding, -SlotPadding, -SlotPadding);
+    if (rhi->isYUpInFramebuffer())
+        return QRect(inner.x(), m_atlasSize.height() - inner.y() - inner.height(), inner.width(), inner.height());
+    return inner;
+}
+
+QMatrix4x4 QSSGRhiItem2DCache::slotProjection(QRhi *rhi, const Slot &slot) const
+{
+    // Maps the content rectangle onto the viewport, with the top of the
+    // content at the lowest texel row of the slot, so that the slot can be
+    // sampled the same way with all the APIs.
+    const QRectF &r = slot.contentRect;
+    const float top = (rhi->isYUpInNDC() != rhi->isYUpInFramebuffer()) ? 1.0f : -1.0f;
+    const float w = float(r.width());
+    const float h = float(r.height());
+    return QMatrix4x4(2.0f / w, 0.0f, 0.0f, -1.0f - 2.0f * float(r.x()) / w,
+                      0.0f, -2.0f * top / h, 0.0f, top * (1.0f + 2.0f * float(r.y()) / h),
+                      0.0f, 0.0f, 0.0f, 0.0f,
+                      0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+void QSSGRhiItem2DCache::prepare(QSSGRhiContext *rhiCtx,
+                                 const QList<QSSGRenderItem2D *> &items,
+                                 float devicePixelRatio)
+{
+    QRhi *rhi = rhiCtx->rhi();
+    if (!ensureAtlas(rhiCtx))
+        return;
+
+    const int viewCount = rhiCtx->mainPassViewCount();
+
+    // The items that can be cached, in the order they are drawn in
+    QList<QSSGRenderItem2D *> cachedItems;
+    int inlineItemCount = 0;
+    for (Slot &slot : m_slots)
+        slot.used = false;
+    for (QSSGRenderItem2D *item : items) {
+        if (!item->m_renderer || item->m_renderer->currentRhi() != rhi || item->mvps.count() != viewCount)
+            continue;
+        const QSize size = slotSize(item->m_contentRect, devicePixelRatio);
+        if (size.isEmpty() || size.width() > m_atlasSize.width() || size.height() > m_atlasSize.height()
+                || m_overflowItems.contains(item))
+        {
+            ++inlineItemCount;
+            continue;
+        }
+        cachedItems.append(item);
+        auto it = m_slots.find(item);
+        if (it != m_slots.end())
+            it->used = true;
+    }
+
+    // Drop the slots of the items that are gone or not visible. Their space
+    // is reclaimed by the next repack, which the overflowing items may now
+    // fit into.
+    for (auto it = m_slots.begin(); it != m_slots.end(); ) {
+        if (!it->used) {
+            delete it->srb;
+            it = m_slots.erase(it);
+            m_overflowItems.clear();
+        } else {
+            ++it;
+        }
+    }
+
+    bool needsRepack = false;
+    for (QSSGRenderItem2D *item : std::as_const(cachedItems)) {
+        const QSize size = slotSize(item->m_contentRect, devicePixelRatio);
+        Slot &slot = m_slots[item];
+        if (slot.rect.size() != size) {
+            slot.rect = m_packer.allocate(size);
+            slot.needsRender = true;
+            if (slot.rect.isEmpty())
+                needsRepack = true;
+        }
+    }
+    if (needsRepack)
+        repack(cachedItems, devicePixelRatio);
+
+    const quint32 stride = rhi->ubufAligned(ubufSize(viewCount));
+    const quint32 requiredSize = qMax<quint32>(stride * quint32(m_slots.size()), stride);
+    bool recreateSrbs = false;
+    if (!m_ubuf || m_ubuf->size() < requiredSize) {
+        delete m_ubuf;
+        m_ubuf = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, requiredSize * 2);
+        m_ubuf->setName(QByteArrayLiteral("Item2D atlas quads"));
+        m_ubuf->create();
+        recreateSrbs = true;
+    }
+
+    QRhiSampler *sampler = rhiCtx->sampler({ QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
+                                             QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge, QRhiSampler::Repeat });
+    const float atlasWidth = float(m_atlasSize.width());
+    const float atlasHeight = float(m_atlasSize.height());
+
+    QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+    QVarLengthArray<QSSGRenderItem2D *, 16> itemsToRender;
+    quint32 offset = 0;
+    char *ubufData = m_ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
+    for (QSSGRenderItem2D *item : std::as_const(cachedItems)) {
+        auto it = m_slots.find(item);
+        if (it == m_slots.end()) {
+            ++inlineItemCount;
+            continue;
+        }
+        Slot &slot = *it;
+        if (slot.contentVersion != item->m_contentVersion
+                || slot.contentRect != item->m_contentRect
+                || slot.devicePixelRatio != devicePixelRatio)
+        {
+            slot.needsRender = true;
+        }
+        slot.contentVersion = item->m_contentVersion;
+        slot.contentRect = item->m_contentRect;
+        slot.devicePixelRatio = devicePixelRatio;
+
+        const QRect inner = slot.rect.adjusted(SlotPadding, SlotPadding, -SlotPadding, -SlotPadding);
+        const QVector4D contentRect(slot.contentRect.x(), slot.contentRect.y(),
+                                    slot.contentRect.width(), slot.contentRect.height());
+        const QVector4D uvRect(inner.left() / atlasWidth, inner.top() / atlasHeight,
+                               (inner.left() + inner.width()) / atlasWidth,
+                               (inner.top() + inner.height()) / atlasHeight);
+        for (int viewIndex = 0; viewIndex < viewCount; ++viewIndex)
+            memcpy(ubufData + offset + viewIndex * 64, item->mvps[viewIndex].constData(), 64);
+        memcpy(ubufData + offset + viewCount * 64, &contentRect, 16);
+        memcpy(ubufData + offset + viewCount * 64 + 16, &uvRect, 16);
+
+        if (recreateSrbs || !slot.srb || slot.ubufOffset != offset) {
+            delete slot.srb;
+            slot.ubufOffset = offset;
+            slot.srb = rhi->newShaderResourceBindings();
+            slot.srb->setBindings({
+                QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::VertexStage, m_ubuf, offset, ubufSize(viewCount)),
+                QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage, m_texture, sampler)
+            });
+            slot.srb->create();
+        }
+        offset += stride;
+
+        if (slot.needsRender) {
+            // Clear the slot including its padding, the pass preserves the
+            // rest of the atlas.
+            QRhiTextureSubresourceUploadDescription clearDesc(QByteArray(slot.rect.width() * slot.rect.height() * 4, 0));
+            clearDesc.setSourceSize(slot.rect.size());
+            clearDesc.setDestinationTopLeft(slot.rect.topLeft());
+            rub->uploadTexture(m_texture, QRhiTextureUploadDescription(QRhiTextureUploadEntry(0, 0, clearDesc)));
+            itemsToRender.append(item);
+        }
+    }
+    m_ubuf->endFullDynamicBufferUpdateForCurrentFrame();
+
+    QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
+    if (itemsToRender.isEmpty()) {
+        cb->resourceUpdate(rub);
+    } else {
+        cb->debugMarkBegin(QByteArrayLiteral("Quick3D render 2D sub-scenes to atlas"));
+        for (QSSGRenderItem2D *item : std::as_const(itemsToRender)) {
+            Slot &slot = m_slots[item];
+            QSGRenderer *renderer = item->m_renderer;
+            renderer->setDevicePixelRatio(devicePixelRatio);
+            renderer->setDeviceRect(QRect(QPoint(0, 0), m_atlasSize));
+            renderer->setViewportRect(slotViewport(rhi, slot));
+            renderer->setProjectionMatrix(slotProjection(rhi, slot), 0);
+            QSGRenderTarget sgRt(m_rt, m_sgRpDesc, cb);
+            sgRt.multiViewCount = 1;
+            renderer->setRenderTarget(sgRt);
+            renderer->prepareSceneInline();
+            slot.needsRender = false;
+        }
+
+        cb->beginPass(m_rt, Qt::transparent, { 1.0f, 0 }, rub, rhiCtx->commonPassFlags());
+        QSSGRHICTX_STAT(rhiCtx, beginRenderPass(m_rt));
+        for (QSSGRenderItem2D *item : std::as_const(itemsToRender))
+            item->m_renderer->renderSceneInline();
+        cb->endPass();
+        QSSGRHICTX_STAT(rhiCtx, endRenderPass());
+        cb->debugMarkEnd();
+    }
+
+    QSSGRHICTX_STAT(rhiCtx, item2DAtlasUpdated({ m_atlasSize,
+                                                 int(m_slots.size()),
+                                                 int(itemsToRender.size()),
+                                                 inlineItemCount,
+                                                 m_packer.usedPixelCount() }));
+}
+
+QRhiShaderResourceBindings *QSSGRhiItem2DCache::srbForItem(QSSGRenderItem2D *item) const
+{
+    const auto it = m_slots.constFind(item);
+    return it != m_slots.cend() ? it->srb : nullptr;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,127 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGRHIITEM2DCACHE_P_H
+#define QSSGRHIITEM2DCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qset.h>
+
+QT_BEGIN_NAMESPACE
+
+struct QSSGRenderItem2D;
+
+// Shelf packing of rectangles into a fixed size atlas. Rectangles are never
+// freed one by one, the atlas is reset and everything packed again instead,
+// which is cheap compared to the rendering that follows anyway.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGItem2DAtlasPacker
+{
+public:
+    QSSGItem2DAtlasPacker() = default;
+    explicit QSSGItem2DAtlasPacker(const QSize &size) { reset(size); }
+
+    void reset(const QSize &size);
+    QSize size() const { return m_size; }
+
+    // An empty rectangle when it does not fit.
+    QRect allocate(const QSize &size);
+
+    qint64 usedPixelCount() const { return m_usedPixelCount; }
+
+private:
+    struct Shelf {
+        int y = 0;
+        int height = 0;
+        int x = 0; // the next free column
+    };
+
+    QSize m_size;
+    QList<Shelf> m_shelves;
+    int m_nextShelfY = 0;
+    qint64 m_usedPixelCount = 0;
+};
+
+// Renders the 2D content of Item2Ds into slots of a texture atlas, and draws
+// the slots as quads in the main pass, instead of rendering the 2D scene
+// graph of every item inline in every frame. An item is only rendered again
+// when its content version changes, so static labels and panels cost one
+// textured quad per frame.
+//
+// Opt-in with QT_QUICK3D_CACHED_ITEM2D=1. The atlas size defaults to 2048
+// and can be changed with QT_QUICK3D_ITEM2D_ATLAS_SIZE. Items that do not fit
+// into the atlas are rendered inline as before.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRhiItem2DCache
+{
+public:
+    QSSGRhiItem2DCache();
+    ~QSSGRhiItem2DCache();
+
+    static bool isEnabled();
+    // Overrides QT_QUICK3D_CACHED_ITEM2D, takes effect from the next frame.
+    static void setEnabled(bool enabled);
+
+    // Renders the items with changed content into the atlas and prepares the
+    // quads of all the cached items. Must be called outside of a render pass.
+    void prepare(QSSGRhiContext *rhiCtx,
+                 const QList<QSSGRenderItem2D *> &items,
+                 float devicePixelRatio);
+
+    // Null when the item is to be rendered inline.
+    QRhiShaderResourceBindings *srbForItem(QSSGRenderItem2D *item) const;
+
+    QRhiTexture *atlasTexture() const { return m_texture; }
+
+private:
+    struct Slot {
+        QRect rect; // including the padding
+        QRectF contentRect;
+        quint64 contentVersion = 0;
+        float devicePixelRatio = 0.0f;
+        bool needsRender = true;
+        bool used = false;
+        QRhiShaderResourceBindings *srb = nullptr;
+        quint32 ubufOffset = 0;
+    };
+
+    bool ensureAtlas(QSSGRhiContext *rhiCtx);
+    void releaseAtlas();
+    QSize slotSize(const QRectF &contentRect, float devicePixelRatio) const;
+    void repack(const QList<QSSGRenderItem2D *> &items, float devicePixelRatio);
+    QMatrix4x4 slotProjection(QRhi *rhi, const Slot &slot) const;
+    QRect slotViewport(QRhi *rhi, const Slot &slot) const;
+
+    QSize m_atlasSize;
+    QSSGItem2DAtlasPacker m_packer;
+    QHash<QSSGRenderItem2D *, Slot> m_slots;
+    QSet<QSSGRenderItem2D *> m_overflowItems;
+
+    QRhiTexture *m_texture = nullptr;
+    QRhiRenderBuffer *m_depthStencil = nullptr;
+    QRhiTextureRenderTarget *m_rt = nullptr;
+    QRhiRenderPassDescriptor *m_rpDesc = nullptr;
+    // Given to the Qt Quick renderers, see Item2DPass
+    QRhiRenderPassDescriptor *m_sgRpDesc = nullptr;
+    QRhiBuffer *m_ubuf = nullptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGRHIITEM2DCACHE_P_H
@@ -0,0 +1,215 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgrhimeshpool_p.h"
+
+#include <numeric>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+enum class PoolKind : quint64 {
+    Vertex = 1,
+    Index = 2
+};
+
+constexpr quint64 poolKey(PoolKind kind, quint32 strideOrFormat)
+{
+    return (quint64(kind) << 32) | strideOrFormat;
+}
+
+constexpr quint32 alignUp(quint32 v, quint32 alignment)
+{
+    return ((v + alignment - 1) / alignment) * alignment;
+}
+}
+
+QSSGRhiMeshPool::QSSGRhiMeshPool(QSSGRhiContext &context)
+    : m_context(context)
+{
+}
+
+QSSGRhiMeshPool::~QSSGRhiMeshPool()
+{
+    releaseAll();
+}
+
+bool QSSGRhiMeshPool::isSupported(QRhi *rhi)
+{
+    // Meshes are drawn from the middle of a shared buffer by passing a base
+    // vertex to drawIndexed(), so there is no point without that.
+    return rhi && rhi->isFeatureSupported(QRhi::BaseVertex);
+}
+
+QSSGRhiMeshPool::Allocation QSSGRhiMeshPool::allocateVertexData(quint32 stride, const QByteArray &data, QRhiResourceUpdateBatch *rub)
+{
+    if (stride == 0)
+        return {};
+
+    // The offset must be a multiple of the stride (to be expressible as a
+    // base vertex) and of 4 (some APIs require 4 byte aligned offsets).
+    const quint32 alignment = std::lcm(stride, 4u);
+    return allocate(poolKey(PoolKind::Vertex, stride),
+                    QRhiBuffer::VertexBuffer,
+                    stride,
+                    QRhiCommandBuffer::IndexUInt16,
+                    alignment,
+                    data,
+                    rub);
+}
+
+QSSGRhiMeshPool::Allocation QSSGRhiMeshPool::allocateIndexData(QRhiCommandBuffer::IndexFormat format, const QByteArray &data, QRhiResourceUpdateBatch *rub)
+{
+    return allocate(poolKey(PoolKind::Index, quint32(format)),
+                    QRhiBuffer::IndexBuffer,
+                    0,
+                    format,
+                    4,
+                    data,
+                    rub);
+}
+
+bool QSSGRhiMeshPool::allocateInBlock(Block &block, quint32 size, quint32 alignment, quint32 *offset)
+{
+    // First fit
+    for (auto it = block.freeRanges.begin(), end = block.freeRanges.end(); it != end; ++it) {
+        const quint32 rangeStart = it.key();
+        const quint32 rangeEnd = rangeStart + it.value();
+        const quint32 start = alignUp(rangeStart, alignment);
+        if (start >= rangeEnd || rangeEnd - start < size)
+            continue;
+
+        block.freeRanges.erase(it);
+        // Keep the padding in front and the remainder after the allocation
+        if (start > rangeStart)
+            block.freeRanges.insert(rangeStart, start - rangeStart);
+        if (rangeEnd > start + size)
+            block.freeRanges.insert(start + size, rangeEnd - (start + size));
+
+        block.usedSize += size;
+        ++block.allocationCount;
+        *offset = start;
+        return true;
+    }
+    return false;
+}
+
+QSSGRhiMeshPool::Allocation QSSGRhiMeshPool::allocate(quint64 poolKey,
+                                                      QRhiBuffer::UsageFlags usage,
+                                                      quint32 stride,
+                                                      QRhiCommandBuffer::IndexFormat indexFormat,
+                                                      quint32 alignment,
+                                                      const QByteArray &data,
+                                                      QRhiResourceUpdateBatch *rub)
+{
+    const quint32 size = quint32(data.size());
+    if (size == 0 || size > MaxAllocationSize)
+        return {};
+
+    QList<Block> &blocks = m_pools[poolKey];
+    quint32 offset = 0;
+    Block *block = nullptr;
+    for (Block &b : blocks) {
+        if (allocateInBlock(b, size, alignment, &offset)) {
+            block = &b;
+            break;
+        }
+    }
+
+    if (!block) {
+        Block newBlock;
+        newBlock.buffer = std::make_shared<QSSGRhiBuffer>(m_context,
+                                                          QRhiBuffer::Static,
+                                                          usage,
+                                                          stride,
+                                                          BlockSize,
+                                                          indexFormat);
+        newBlock.buffer->buffer()->setName(usage.testFlag(QRhiBuffer::VertexBuffer)
+                                           ? QByteArrayLiteral("Mesh pool (vertices)")
+                                           : QByteArrayLiteral("Mesh pool (indices)"));
+        newBlock.freeRanges.insert(0, BlockSize);
+        blocks.append(newBlock);
+        block = &blocks.last();
+        const bool ok = allocateInBlock(*block, size, alignment, &offset);
+        Q_ASSERT(ok);
+        Q_UNUSED(ok);
+    }
+
+    rub->uploadStaticBuffer(block->buffer->buffer(), offset, size, data.constData());
+
+    Allocation result;
+    result.buffer = block->buffer;
+    result.poolKey = poolKey;
+    result.offset = offset;
+    result.size = size;
+    return result;
+}
+
+void QSSGRhiMeshPool::release(const Allocation &allocation)
+{
+    if (!allocation.isValid())
+        return;
+
+    auto poolIt = m_pools.find(allocation.poolKey);
+    if (poolIt == m_pools.end())
+        return;
+
+    QList<Block> &blocks = poolIt.value();
+    for (qsizetype i = 0, count = blocks.size(); i != count; ++i) {
+        Block &block = blocks[i];
+        if (block.buffer != allocation.buffer)
+            continue;
+
+        block.usedSize -= allocation.size;
+        --block.allocationCount;
+        if (block.allocationCount == 0) {
+            // Nothing lives in the block anymore, give the memory back.
+            // Subsets still holding on to the buffer keep it alive until
+            // they are gone.
+            blocks.removeAt(i);
+            if (blocks.isEmpty())
+                m_pools.erase(poolIt);
+            return;
+        }
+
+        // Merge with the neighboring free ranges to counter fragmentation
+        quint32 start = allocation.offset;
+        quint32 size = allocation.size;
+        auto next = block.freeRanges.lowerBound(start);
+        if (next != block.freeRanges.begin()) {
+            auto prev = std::prev(next);
+            if (prev.key() + prev.value() == start) {
+                start = prev.key();
+                size += prev.value();
+                block.freeRanges.erase(prev);
+            }
+        }
+        if (next != block.freeRanges.end() && start + size == next.key()) {
+            size += next.value();
+            block.freeRanges.erase(next);
+        }
+        block.freeRanges.insert(start, size);
+        return;
+    }
+}
+
+void QSSGRhiMeshPool::releaseAll()
+{
+    m_pools.clear();
+}
+
+QSSGRhiMeshPool::Stats QSSGRhiMeshPool::stats() const
+{
+    Stats s;
+    for (const QList<Block> &blocks : m_pools) {
+        for (const Block &block : blocks) {
+            ++s.bufferCount;
+            s.allocationCount += block.allocationCount;
+            s.reservedSize += BlockSize;
+            s.usedSize += block.usedSize;
+        }
+    }
+    return s;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,94 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGRHIMESHPOOL_P_H
+#define QSSGRHIMESHPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+
+#include <QtCore/qmap.h>
+
+QT_BEGIN_NAMESPACE
+
+// Sub-allocates the vertex and index data of static meshes from a small
+// number of large, shared QRhiBuffers. Vertex data is pooled per stride and
+// index data per index format, so that meshes sharing a pool block can be
+// drawn with the same vertex input bindings by passing a base vertex and a
+// first index offset to the draw call. Free space in a block is tracked as a
+// sorted list of ranges that are merged with their neighbors on release, and
+// a block is destroyed as soon as it becomes empty.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRhiMeshPool
+{
+    Q_DISABLE_COPY(QSSGRhiMeshPool)
+public:
+    static constexpr quint32 BlockSize = 4 * 1024 * 1024;
+    // Larger meshes gain little from pooling, they get a buffer on their own
+    static constexpr quint32 MaxAllocationSize = BlockSize / 4;
+
+    struct Allocation {
+        QSSGRhiBufferPtr buffer;
+        quint64 poolKey = 0;
+        quint32 offset = 0; // in bytes
+        quint32 size = 0; // in bytes
+        bool isValid() const { return buffer != nullptr; }
+    };
+
+    struct Stats {
+        quint32 bufferCount = 0;
+        quint32 allocationCount = 0;
+        quint64 reservedSize = 0;
+        quint64 usedSize = 0;
+    };
+
+    explicit QSSGRhiMeshPool(QSSGRhiContext &context);
+    ~QSSGRhiMeshPool();
+
+    static bool isSupported(QRhi *rhi);
+
+    // Both return an invalid Allocation when the data cannot be pooled, in
+    // which case the caller is expected to create a dedicated buffer.
+    Allocation allocateVertexData(quint32 stride, const QByteArray &data, QRhiResourceUpdateBatch *rub);
+    Allocation allocateIndexData(QRhiCommandBuffer::IndexFormat format, const QByteArray &data, QRhiResourceUpdateBatch *rub);
+
+    void release(const Allocation &allocation);
+    void releaseAll();
+
+    Stats stats() const;
+
+private:
+    struct Block {
+        QSSGRhiBufferPtr buffer;
+        QMap<quint32, quint32> freeRanges; // offset -> size
+        quint32 usedSize = 0;
+        quint32 allocationCount = 0;
+    };
+
+    Allocation allocate(quint64 poolKey,
+                        QRhiBuffer::UsageFlags usage,
+                        quint32 stride,
+                        QRhiCommandBuffer::IndexFormat indexFormat,
+                        quint32 alignment,
+                        const QByteArray &data,
+                        QRhiResourceUpdateBatch *rub);
+    static bool allocateInBlock(Block &block, quint32 size, quint32 alignment, quint32 *offset);
+
+    QSSGRhiContext &m_context;
+    QHash<quint64, QList<Block>> m_pools;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGRHIMESHPOOL_P_H
@@ -0,0 +1,286 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgrhiskinning_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermesh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderskin_p.h>
+
+QT_BEGIN_NAMESPACE
+
+// The uniform block of skinning.comp. Offsets are in 32-bit words from the
+// start of a vertex, -1 when the attribute is absent. Morph targets are given
+// as the first layer of the attribute in the targets texture, -1 when the
+// attribute is not morphed.
+struct SkinningUniforms
+{
+    quint32 vertexCount;
+    quint32 strideInWords;
+    quint32 firstSourceWord;
+    quint32 flags;
+    qint32 vectorOffsets[4]; // position, normal, tangent, binormal
+    qint32 extraOffsets[4]; // texcoord0, texcoord1, color, target count
+    qint32 skinOffsets[4]; // joints, weights
+    qint32 vectorTargets[4];
+    qint32 extraTargets[4];
+    float morphWeights[QSSGRhiSkinning::MaxMorphTargetCount];
+};
+
+static_assert(sizeof(SkinningUniforms) == 224, "SkinningUniforms must match the std140 layout of skinning.comp");
+
+enum SkinningFlag : quint32 {
+    Skinning = 0x1,
+    FloatJoints = 0x2
+};
+
+static const QRhiShaderResourceBinding::StageFlags COMPUTE_STAGE = QRhiShaderResourceBinding::ComputeStage;
+
+namespace {
+struct VertexLayout
+{
+    qint32 offsets[QSSGRhiInputAssemblerState::TexCoordLightmapSemantic + 1];
+    bool floatJoints = false;
+    bool valid = true;
+};
+}
+
+// All the attributes the compute shader reads or writes must be 32-bit
+// floats, except for the joint indices which may be integers as well.
+static VertexLayout vertexLayout(const QSSGRhiInputAssemblerState &ia)
+{
+    VertexLayout layout;
+    std::fill(std::begin(layout.offsets), std::end(layout.offsets), -1);
+    for (qsizetype i = 0, count = ia.inputs.size(); i < count; ++i) {
+        const QSSGRhiInputAssemblerState::InputSemantic sem = ia.inputs.at(i);
+        const QRhiVertexInputAttribute *attr = ia.inputLayout.attributeAt(i);
+        if (attr->offset() % 4 != 0) {
+            layout.valid = false;
+            break;
+        }
+        QRhiVertexInputAttribute::Format expected = QRhiVertexInputAttribute::Float4;
+        switch (sem) {
+        case QSSGRhiInputAssemblerState::PositionSemantic:
+        case QSSGRhiInputAssemblerState::NormalSemantic:
+        case QSSGRhiInputAssemblerState::TangentSemantic:
+        case QSSGRhiInputAssemblerState::BinormalSemantic:
+            expected = QRhiVertexInputAttribute::Float3;
+            break;
+        case QSSGRhiInputAssemblerState::TexCoord0Semantic:
+        case QSSGRhiInputAssemblerState::TexCoord1Semantic:
+            expected = QRhiVertexInputAttribute::Float2;
+            break;
+        case QSSGRhiInputAssemblerState::JointSemantic:
+            layout.floatJoints = attr->format() == QRhiVertexInputAttribute::Float4;
+            if (attr->format() == QRhiVertexInputAttribute::SInt4 || attr->format() == QRhiVertexInputAttribute::UInt4)
+                expected = attr->format();
+            break;
+        case QSSGRhiInputAssemblerState::TexCoordLightmapSemantic:
+            // Copied as is
+            expected = attr->format();
+            break;
+        default:
+            break;
+        }
+        if (attr->format() != expected) {
+            layout.valid = false;
+            break;
+        }
+        layout.offsets[sem] = qint32(attr->offset() / 4);
+    }
+    return layout;
+}
+
+static quint32 boneDataVersion(const QSSGRenderModel &model)
+{
+    if (model.skin)
+        return model.skin->version();
+    if (model.skeleton)
+        return model.skeleton->boneTexData.version();
+    return 0;
+}
+
+static quint32 sourceDataVersion(const QSSGRenderModel &model)
+{
+    return model.geometry ? model.geometry->dataGenerationId() : 0;
+}
+
+static size_t morphWeightsHash(const QSSGRenderModel &model, int targetCount)
+{
+    const qsizetype count = qMin(model.morphWeights.size(), qsizetype(targetCount));
+    return qHashRange(model.morphWeights.cbegin(), model.morphWeights.cbegin() + count);
+}
+
+bool QSSGRhiSkinning::isEnabled(QRhi *rhi)
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_QUICK3D_COMPUTE_SKINNING");
+    return enabled && rhi && rhi->isFeatureSupported(QRhi::Compute);
+}
+
+bool QSSGRhiSkinning::needsStorageVertexData(QRhi *rhi, bool hasJointsAndWeights, bool hasMorphTargets)
+{
+    return (hasJointsAndWeights || hasMorphTargets) && isEnabled(rhi);
+}
+
+QRhiBuffer *QSSGRhiSkinning::prepareModel(QSSGRhiContext *rhiCtx,
+                                          const QSSGRenderModel &model,
+                                          const QSSGRenderSubset &subset,
+                                          QRhiTexture *boneTexture,
+                                          QList<Dispatch> &dispatches)
+{
+    QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(rhiCtx);
+    QRhi *rhi = rhiCtx->rhi();
+    if (!isEnabled(rhi) || !subset.rhi.vertexBuffer)
+        return nullptr;
+
+    const QSSGRhiInputAssemblerState &ia = subset.rhi.ia;
+    const bool hasJointsAndWeights = ia.inputs.contains(QSSGRhiInputAssemblerState::JointSemantic)
+            && ia.inputs.contains(QSSGRhiInputAssemblerState::WeightSemantic);
+    const bool skinning = boneTexture && hasJointsAndWeights;
+    const bool morphing = subset.rhi.targetsTexture && ia.targetCount > 0;
+    if (!skinning && !morphing)
+        return nullptr;
+
+    // Anything the compute shader cannot handle keeps evaluating the
+    // animation in the vertex shader.
+    QRhiBuffer *source = subset.rhi.vertexBuffer->buffer();
+    const quint32 stride = subset.rhi.vertexBuffer->stride();
+    if (!source->usage().testFlag(QRhiBuffer::StorageBuffer) || subset.rhi.baseVertex != 0 || stride % 4 != 0)
+        return nullptr;
+    if (ia.targetCount > MaxMorphTargetCount)
+        return nullptr;
+    const VertexLayout layout = vertexLayout(ia);
+    if (!layout.valid || layout.offsets[QSSGRhiInputAssemblerState::PositionSemantic] < 0)
+        return nullptr;
+
+    QSSGRhiSkinnedVertexData &data = rhiCtxD->skinnedVertexData(&model);
+    if (!data.buffer || data.buffer->size() != source->size()) {
+        rhiCtxD->releaseCachedSrb(data.bindings);
+        data.bindings.clear();
+        delete data.buffer;
+        data.buffer = rhi->newBuffer(QRhiBuffer::Static,
+                                     QRhiBuffer::VertexBuffer | QRhiBuffer::StorageBuffer,
+                                     source->size());
+        data.buffer->setName(QByteArrayLiteral("Skinned vertex buffer"));
+        data.source = nullptr;
+        if (!data.buffer->create()) {
+            qWarning("Failed to build skinned vertex buffer of size %u", source->size());
+            rhiCtxD->releaseSkinnedVertexData(&model);
+            return nullptr;
+        }
+    }
+
+    if (!data.ubuf) {
+        data.ubuf = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, sizeof(SkinningUniforms));
+        data.ubuf->create();
+    }
+
+    const bool dirty = data.source != source
+            || data.sourceDataVersion != sourceDataVersion(model)
+            || data.boneTexture != (skinning ? boneTexture : nullptr)
+            || (skinning && data.boneDataVersion != boneDataVersion(model))
+            || (morphing && data.morphWeightsHash != morphWeightsHash(model, ia.targetCount));
+    if (dirty)
+        dispatches.append({ &model, &subset, skinning ? boneTexture : nullptr });
+
+    return data.buffer;
+}
+
+void QSSGRhiSkinning::dispatch(QSSGRhiContext *rhiCtx, const QShader &shader, const QList<Dispatch> &dispatches)
+{
+    if (dispatches.isEmpty() || !shader.isValid())
+        return;
+
+    QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(rhiCtx);
+    QRhi *rhi = rhiCtx->rhi();
+    QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
+    QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+
+    QRhiSampler *sampler = rhiCtx->sampler({ QRhiSampler::Nearest,
+                                             QRhiSampler::Nearest,
+                                             QRhiSampler::None,
+                                             QRhiSampler::ClampToEdge,
+                                             QRhiSampler::ClampToEdge,
+                                             QRhiSampler::ClampToEdge });
+    QRhiTexture *dummyBoneTexture = rhiCtx->dummyTexture({}, rub);
+    QRhiTexture *dummyTargetsTexture = rhiCtx->dummyTexture({}, rub, QSize(64, 64), Qt::black, 2);
+
+    struct Work {
+        QRhiShaderResourceBindings *srb;
+        quint32 vertexCount;
+    };
+    QVarLengthArray<Work, 16> work;
+
+    for (const Dispatch &d : dispatches) {
+        const QSSGRenderModel &model = *d.model;
+        const QSSGRenderSubset &subset = *d.subset;
+        const QSSGRhiInputAssemblerState &ia = subset.rhi.ia;
+        QSSGRhiSkinnedVertexData &data = rhiCtxD->skinnedVertexData(&model);
+        const bool morphing = subset.rhi.targetsTexture && ia.targetCount > 0;
+        const VertexLayout layout = vertexLayout(ia);
+
+        SkinningUniforms uniforms;
+        uniforms.vertexCount = subset.rhi.vertexBuffer->numVertices();
+        uniforms.strideInWords = subset.rhi.vertexBuffer->stride() / 4;
+        uniforms.firstSourceWord = 0;
+        uniforms.flags = (d.boneTexture ? Skinning : 0) | (layout.floatJoints ? FloatJoints : 0);
+
+        using IA = QSSGRhiInputAssemblerState;
+        const IA::InputSemantic vectors[4] = { IA::PositionSemantic, IA::NormalSemantic,
+                                               IA::TangentSemantic, IA::BinormalSemantic };
+        const IA::InputSemantic extras[3] = { IA::TexCoord0Semantic, IA::TexCoord1Semantic, IA::ColorSemantic };
+        const auto firstLayer = [&ia, morphing, &layout](IA::InputSemantic sem) {
+            const quint8 offset = ia.targetOffsets[sem];
+            return (morphing && offset != UINT8_MAX && layout.offsets[sem] >= 0) ? qint32(offset) : -1;
+        };
+        for (int i = 0; i < 4; ++i) {
+            uniforms.vectorOffsets[i] = layout.offsets[vectors[i]];
+            uniforms.vectorTargets[i] = firstLayer(vectors[i]);
+        }
+        for (int i = 0; i < 3; ++i) {
+            uniforms.extraOffsets[i] = layout.offsets[extras[i]];
+            uniforms.extraTargets[i] = firstLayer(extras[i]);
+        }
+        uniforms.extraOffsets[3] = morphing ? qint32(ia.targetCount) : 0;
+        uniforms.extraTargets[3] = -1;
+        uniforms.skinOffsets[0] = layout.offsets[IA::JointSemantic];
+        uniforms.skinOffsets[1] = layout.offsets[IA::WeightSemantic];
+        uniforms.skinOffsets[2] = uniforms.skinOffsets[3] = -1;
+        // Missing weights are zero, as in the vertex shader
+        for (int i = 0; i < MaxMorphTargetCount; ++i)
+            uniforms.morphWeights[i] = (morphing && i < model.morphWeights.size()) ? model.morphWeights.at(i) : 0.0f;
+
+        rub->updateDynamicBuffer(data.ubuf, 0, sizeof(SkinningUniforms), &uniforms);
+
+        QSSGRhiShaderResourceBindingList bindings;
+        bindings.addUniformBuffer(0, COMPUTE_STAGE, data.ubuf);
+        bindings.addBufferLoad(1, COMPUTE_STAGE, subset.rhi.vertexBuffer->buffer());
+        bindings.addBufferStore(2, COMPUTE_STAGE, data.buffer);
+        bindings.addTexture(3, COMPUTE_STAGE, d.boneTexture ? d.boneTexture : dummyBoneTexture, sampler);
+        bindings.addTexture(4, COMPUTE_STAGE, morphing ? subset.rhi.targetsTexture : dummyTargetsTexture, sampler);
+        if (!(bindings == data.bindings)) {
+            rhiCtxD->releaseCachedSrb(data.bindings);
+            data.bindings = bindings;
+        }
+
+        work.append({ rhiCtxD->srb(bindings), uniforms.vertexCount });
+
+        data.source = subset.rhi.vertexBuffer->buffer();
+        data.sourceDataVersion = sourceDataVersion(model);
+        data.boneTexture = d.boneTexture;
+        data.boneDataVersion = d.boneTexture ? boneDataVersion(model) : 0;
+        data.morphWeightsHash = morphing ? morphWeightsHash(model, ia.targetCount) : 0;
+    }
+
+    cb->beginComputePass(rub);
+    for (const Work &w : work) {
+        if (!w.srb)
+            continue;
+        cb->setComputePipeline(rhiCtxD->computePipeline(shader, w.srb));
+        cb->setShaderResources(w.srb);
+        cb->dispatch(int((w.vertexCount + WorkgroupSize - 1) / WorkgroupSize), 1, 1);
+    }
+    cb->endComputePass();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,72 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGRHISKINNING_P_H
+#define QSSGRHISKINNING_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+
+QT_BEGIN_NAMESPACE
+
+struct QSSGRenderModel;
+struct QSSGRenderSubset;
+
+// Optional compute stage (QT_QUICK3D_COMPUTE_SKINNING) that skins and morphs
+// the vertices of a model once per frame into a vertex buffer of its own,
+// which has the same layout as the mesh. Every pass then draws the model from
+// that buffer with the pipeline of a static mesh, instead of evaluating the
+// bones and morph targets in the vertex shader of each pass. The buffer is
+// only recomputed when the bone texture, the morph weights or the mesh change.
+//
+// The vertex data of such meshes is not pooled, and is created with storage
+// buffer usage so that the compute shader can read it.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRhiSkinning
+{
+public:
+    static constexpr int MaxMorphTargetCount = 32;
+    static constexpr int WorkgroupSize = 64;
+
+    struct Dispatch {
+        const QSSGRenderModel *model = nullptr;
+        // Any of the model's subsets, they share the vertex data
+        const QSSGRenderSubset *subset = nullptr;
+        QRhiTexture *boneTexture = nullptr;
+    };
+
+    static bool isEnabled(QRhi *rhi);
+
+    // Whether the vertex data of a mesh with these attributes is to be made
+    // readable by the compute stage.
+    static bool needsStorageVertexData(QRhi *rhi, bool hasJointsAndWeights, bool hasMorphTargets);
+
+    // Returns the buffer the subsets of the model are to be drawn from, or
+    // nullptr when the model is not skinned or morphed, or cannot be handled
+    // by the compute stage. Appends to dispatches when the vertices need to
+    // be recomputed.
+    static QRhiBuffer *prepareModel(QSSGRhiContext *rhiCtx,
+                                    const QSSGRenderModel &model,
+                                    const QSSGRenderSubset &subset,
+                                    QRhiTexture *boneTexture,
+                                    QList<Dispatch> &dispatches);
+
+    // Records one compute pass for all the dispatches. Must be called outside
+    // of a render pass, before the models are drawn.
+    static void dispatch(QSSGRhiContext *rhiCtx, const QShader &shader, const QList<Dispatch> &dispatches);
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGRHISKINNING_P_H
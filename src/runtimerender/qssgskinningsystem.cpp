@@ -0,0 +1,251 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgskinningsystem_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderskeleton_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderjoint_p.h>
+
+#include <QtCore/qmath.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthreadpool.h>
+#include <qsimd.h>
+
+#include <atomic>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+// In floats, two 4x4 matrices per bone
+#define POS4BONETRANS(x)    (16 * (x) * 2)
+#define POS4BONENORM(x)     (16 * ((x) * 2 + 1))
+
+namespace {
+struct FlattenEntry {
+    QSSGRenderSkeleton::FlatJoint joint;
+    bool hasJointDescendants = false;
+};
+
+void collectNodes(QSSGRenderNode *node, qint32 parent, QList<FlattenEntry> &entries)
+{
+    const qint32 index = qint32(entries.size());
+    entries.append({ { node, parent, node->type == QSSGRenderGraphObject::Type::Joint } });
+    for (auto &child : node->children)
+        collectNodes(&child, index, entries);
+}
+
+// out = a * b, all column-major 4x4. out must not alias a or b.
+inline void multiplyMatrix(const float *a, const float *b, float *out)
+{
+#ifdef __SSE2__
+    const __m128 a0 = _mm_loadu_ps(a);
+    const __m128 a1 = _mm_loadu_ps(a + 4);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+    const __m128 a3 = _mm_loadu_ps(a + 12);
+    for (int c = 0; c < 4; ++c) {
+        const float *bc = b + 4 * c;
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        _mm_storeu_ps(out + 4 * c, r);
+    }
+#else
+    for (int c = 0; c < 4; ++c) {
+        const float *bc = b + 4 * c;
+        for (int r = 0; r < 4; ++r)
+            out[4 * c + r] = a[r] * bc[0] + a[4 + r] * bc[1] + a[8 + r] * bc[2] + a[12 + r] * bc[3];
+    }
+#endif
+}
+
+// Inverse transpose of the upper 3x3 of m, written as three columns with a
+// zero fourth component. The columns of the inverse transpose are the cross
+// products of the columns of m, divided by the determinant.
+inline void normalMatrix(const float *m, float *out)
+{
+    const QVector3D c0(m[0], m[1], m[2]);
+    const QVector3D c1(m[4], m[5], m[6]);
+    const QVector3D c2(m[8], m[9], m[10]);
+    const QVector3D n0 = QVector3D::crossProduct(c1, c2);
+    const float det = QVector3D::dotProduct(c0, n0);
+    // Same as QMatrix4x4::normalMatrix(), which returns identity for singular matrices
+    if (qFuzzyIsNull(double(det))) {
+        const float identity[12] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+        memcpy(out, identity, sizeof(identity));
+        return;
+    }
+    const float invDet = 1.0f / det;
+    const QVector3D n1 = QVector3D::crossProduct(c2, c0);
+    const QVector3D n2 = QVector3D::crossProduct(c0, c1);
+    const float columns[12] = { n0.x() * invDet, n0.y() * invDet, n0.z() * invDet, 0.0f,
+                                n1.x() * invDet, n1.y() * invDet, n1.z() * invDet, 0.0f,
+                                n2.x() * invDet, n2.y() * invDet, n2.z() * invDet, 0.0f };
+    memcpy(out, columns, sizeof(columns));
+}
+}
+
+void QSSGSkinningSystem::flatten(QSSGRenderSkeleton &skeleton)
+{
+    QList<FlattenEntry> entries;
+    for (auto &child : skeleton.children)
+        collectNodes(&child, -1, entries);
+
+    // Only the joints and the nodes on the way to them affect the palette
+    for (qsizetype i = entries.size() - 1; i >= 0; --i) {
+        const FlattenEntry &entry = entries.at(i);
+        if ((entry.joint.isJoint || entry.hasJointDescendants) && entry.joint.parent >= 0)
+            entries[entry.joint.parent].hasJointDescendants = true;
+    }
+
+    skeleton.joints.clear();
+    skeleton.containsNonJointNodes = false;
+    QList<qint32> remap(entries.size(), -1);
+    for (qsizetype i = 0, count = entries.size(); i < count; ++i) {
+        const FlattenEntry &entry = entries.at(i);
+        if (!entry.joint.isJoint && !entry.hasJointDescendants)
+            continue;
+        remap[i] = qint32(skeleton.joints.size());
+        QSSGRenderSkeleton::FlatJoint joint = entry.joint;
+        // A kept node's parent has joint descendants, so it is kept as well
+        joint.parent = joint.parent >= 0 ? remap.at(joint.parent) : -1;
+        skeleton.joints.append(joint);
+        skeleton.containsNonJointNodes |= !joint.isJoint;
+    }
+
+    skeleton.jointsDirty = false;
+}
+
+bool QSSGSkinningSystem::hasDirtyNonJointNodes(const QSSGRenderSkeleton &skeleton)
+{
+    // Note! The frontend clears TransformDirty. Use dirty instead.
+    if (skeleton.joints.isEmpty())
+        return false;
+    if (skeleton.isDirty())
+        return true;
+    for (const QSSGRenderSkeleton::FlatJoint &joint : skeleton.joints) {
+        if (!joint.isJoint && joint.node->isDirty())
+            return true;
+    }
+    return false;
+}
+
+void QSSGSkinningSystem::prepare(QSSGRenderSkeleton &skeleton)
+{
+    if (skeleton.jointsDirty)
+        flatten(skeleton);
+
+    skeleton.calculateGlobalVariables();
+    // The joints themselves are evaluated from their local transforms, but
+    // the other nodes are brought up to date here, so that they do not keep
+    // the skeleton dirty.
+    if (skeleton.containsNonJointNodes) {
+        for (const QSSGRenderSkeleton::FlatJoint &joint : std::as_const(skeleton.joints)) {
+            if (!joint.isJoint && joint.node->isDirty())
+                joint.node->calculateGlobalVariables();
+        }
+    }
+
+    const int boneCount = skeleton.maxIndex + 1;
+    const int textureWidth = paletteTextureWidth(boneCount);
+    const qsizetype paletteSize = qsizetype(textureWidth) * textureWidth * 16;
+    // Zero filled, so that the unused parts compare equal in commitPalette()
+    if (skeleton.pendingBoneData.size() != paletteSize)
+        skeleton.pendingBoneData = QByteArray(paletteSize, '\0');
+    skeleton.jointTransforms.resize(skeleton.joints.size() * 16);
+}
+
+void QSSGSkinningSystem::evaluatePalette(QSSGRenderSkeleton &skeleton, const QList<QMatrix4x4> &inverseBindPoses)
+{
+    const auto &joints = skeleton.joints;
+    float *transforms = skeleton.jointTransforms.data();
+    float *palette = reinterpret_cast<float *>(skeleton.pendingBoneData.data());
+    const float *skeletonTransform = skeleton.globalTransform.constData();
+
+    for (qsizetype i = 0, count = joints.size(); i < count; ++i) {
+        const QSSGRenderSkeleton::FlatJoint &joint = joints.at(i);
+        const float *parentTransform = joint.parent >= 0 ? transforms + 16 * joint.parent : skeletonTransform;
+        float *transform = transforms + 16 * i;
+        multiplyMatrix(parentTransform, joint.node->localTransform.constData(), transform);
+        if (!joint.isJoint)
+            continue;
+
+        const int index = static_cast<const QSSGRenderJoint *>(joint.node)->index;
+        if (index < 0 || index > skeleton.maxIndex)
+            continue;
+        float *bone = palette + POS4BONETRANS(index);
+        // if user doesn't give the inverseBindPose, identity matrices are used.
+        if (index < inverseBindPoses.size())
+            multiplyMatrix(transform, inverseBindPoses.at(index).constData(), bone);
+        else
+            memcpy(bone, transform, 16 * sizeof(float));
+        // only upper 3x3 is meaningful
+        normalMatrix(bone, palette + POS4BONENORM(index));
+    }
+}
+
+void QSSGSkinningSystem::evaluatePalettes(const QList<SkeletonPose> &poses)
+{
+    static const QList<QMatrix4x4> noPoses;
+    const auto evaluate = [&poses](qsizetype i) {
+        const SkeletonPose &pose = poses.at(i);
+        evaluatePalette(*pose.skeleton, pose.inverseBindPoses ? *pose.inverseBindPoses : noPoses);
+    };
+
+    qsizetype jointCount = 0;
+    for (const SkeletonPose &pose : poses)
+        jointCount += pose.skeleton->joints.size();
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int workerCount = qMin(pool->maxThreadCount(), int(poses.size())) - 1;
+    if (jointCount < MinParallelJointCount || workerCount < 1) {
+        for (qsizetype i = 0, count = poses.size(); i < count; ++i)
+            evaluate(i);
+        return;
+    }
+
+    // The skeletons are handed out one by one, the calling thread takes part
+    // as well. Only threads that are free right now are used, so waiting for
+    // them does not depend on whatever else is queued in the pool.
+    std::atomic<qsizetype> next = 0;
+    const auto work = [&evaluate, &next, count = poses.size()] {
+        for (qsizetype i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            evaluate(i);
+    };
+    QSemaphore done;
+    int startedCount = 0;
+    for (int i = 0; i < workerCount; ++i) {
+        if (!pool->tryStart([&work, &done] { work(); done.release(); }))
+            break;
+        ++startedCount;
+    }
+    work();
+    done.acquire(startedCount);
+}
+
+bool QSSGSkinningSystem::commitPalette(QSSGRenderSkeleton &skeleton)
+{
+    const int boneCount = skeleton.maxIndex + 1;
+    skeleton.boneCount = quint32(qMax(0, boneCount));
+    if (skeleton.pendingBoneData == skeleton.boneData)
+        return false;
+
+    // The previous data becomes the buffer for the next evaluation, once the
+    // texture data no longer shares it.
+    std::swap(skeleton.boneData, skeleton.pendingBoneData);
+    const int textureWidth = paletteTextureWidth(boneCount);
+    skeleton.boneTexData.setSize(QSize(textureWidth, textureWidth));
+    skeleton.boneTexData.setTextureData(skeleton.boneData);
+    return true;
+}
+
+int QSSGSkinningSystem::paletteTextureWidth(int boneCount)
+{
+    // Two matrices of four RGBA32F texels each per bone
+    return boneCount > 0 ? qCeil(qSqrt(boneCount * 4 * 2)) : 0;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,73 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGSKINNINGSYSTEM_P_H
+#define QSSGSKINNINGSYSTEM_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+
+#include <QtCore/qlist.h>
+#include <QtGui/qmatrix4x4.h>
+
+QT_BEGIN_NAMESPACE
+
+struct QSSGRenderSkeleton;
+
+// Evaluates the bone palettes (the data of the skeleton's bone texture) of
+// skeletons. Each skeleton is flattened into an array of its joints, and the
+// nodes between them, where parents come before their children. The palette
+// is then computed in one pass over that array, without touching the rest of
+// the node graph. The flattened array is only rebuilt when the subtree of the
+// skeleton changes.
+//
+// The palette has two 4x4 matrices per joint index: the joint's global
+// transform multiplied by its inverse bind pose, followed by the normal matrix
+// (upper 3x3). It is padded to fill a square RGBA32F texture.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGSkinningSystem
+{
+public:
+    struct SkeletonPose {
+        QSSGRenderSkeleton *skeleton = nullptr;
+        const QList<QMatrix4x4> *inverseBindPoses = nullptr;
+    };
+
+    // Below this many joints in total the palettes are evaluated on the
+    // calling thread only
+    static constexpr qsizetype MinParallelJointCount = 512;
+
+    static void flatten(QSSGRenderSkeleton &skeleton);
+    static bool hasDirtyNonJointNodes(const QSSGRenderSkeleton &skeleton);
+
+    // Flattens the skeleton if needed and brings the global transforms of the
+    // skeleton and its non-joint nodes up to date. Must be called on the
+    // render thread before evaluatePalette().
+    static void prepare(QSSGRenderSkeleton &skeleton);
+
+    // Computes the palette into skeleton.pendingBoneData. Only touches data
+    // owned by the skeleton, so different skeletons can be evaluated on
+    // different threads.
+    static void evaluatePalette(QSSGRenderSkeleton &skeleton, const QList<QMatrix4x4> &inverseBindPoses);
+    static void evaluatePalettes(const QList<SkeletonPose> &poses);
+
+    // Makes the pending palette the skeleton's texture data, unless it is the
+    // same as the current one. Returns true when the texture data changed.
+    static bool commitPalette(QSSGRenderSkeleton &skeleton);
+
+    static int paletteTextureWidth(int boneCount);
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGSKINNINGSYSTEM_P_H
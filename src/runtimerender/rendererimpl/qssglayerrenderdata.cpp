@@ -22,6 +22,8 @@
 #include <QtQuick3DRuntimeRender/private/qssgperframeallocator_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgruntimerenderlogging_p.h>
 #include <QtQuick3DRuntimeRender/private/qssglightmapper_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgreflectionprobebaker_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgskinningsystem_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgdebugdrawsystem_p.h>
 
 #include <QtQuick3DUtils/private/qssgutils_p.h>
@@ -32,6 +34,8 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QBitArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/qmath.h>
 #include <array>
 
 #include "qssgrenderpass_p.h"
@@ -41,10 +45,6 @@ QT_BEGIN_NAMESPACE
 
 Q_STATIC_LOGGING_CATEGORY(lcQuick3DRender, "qt.quick3d.render");
 
-#define POS4BONETRANS(x)    (sizeof(float) * 16 * (x) * 2)
-#define POS4BONENORM(x)     (sizeof(float) * 16 * ((x) * 2 + 1))
-#define BONEDATASIZE4ID(x)  POS4BONETRANS(x + 1)
-
 static bool checkParticleSupport(QRhi *rhi)
 {
     QSSG_ASSERT(rhi, return false);
@@ -118,54 +118,6 @@ qsizetype QSSGLayerRenderData::frustumCullingInline(const QSSGClippingFrustum &c
     return lhs.cameraDistanceSq > rhs.cameraDistanceSq;
 }
 
-static void collectBoneTransforms(QSSGRenderNode *node, QSSGRenderSkeleton *skeletonNode, const QVector<QMatrix4x4> &poses)
-{
-    if (node->type == QSSGRenderGraphObject::Type::Joint) {
-        QSSGRenderJoint *jointNode = static_cast<QSSGRenderJoint *>(node);
-        jointNode->calculateGlobalVariables();
-        QMatrix4x4 globalTrans = jointNode->globalTransform;
-        // if user doesn't give the inverseBindPose, identity matrices are used.
-        if (poses.size() > jointNode->index)
-            globalTrans *= poses[jointNode->index];
-        memcpy(skeletonNode->boneData.data() + POS4BONETRANS(jointNode->index),
-               reinterpret_cast<const void *>(globalTrans.constData()),
-               sizeof(float) * 16);
-        // only upper 3x3 is meaningful
-        memcpy(skeletonNode->boneData.data() + POS4BONENORM(jointNode->index),
-               reinterpret_cast<const void *>(QMatrix4x4(globalTrans.normalMatrix()).constData()),
-               sizeof(float) * 11);
-    } else {
-        skeletonNode->containsNonJointNodes = true;
-    }
-    for (auto &child : node->children)
-        collectBoneTransforms(&child, skeletonNode, poses);
-}
-
-static bool hasDirtyNonJointNodes(QSSGRenderNode *node, bool &hasChildJoints)
-{
-    if (!node)
-        return false;
-    // we might be non-joint dirty node, but if we do not have child joints we need to return false
-    // Note! The frontend clears TransformDirty. Use dirty instead.
-    bool dirtyNonJoint = ((node->type != QSSGRenderGraphObject::Type::Joint)
-                                              && node->isDirty());
-
-    // Tell our parent we are joint
-    if (node->type == QSSGRenderGraphObject::Type::Joint)
-        hasChildJoints = true;
-    bool nodeHasChildJoints = false;
-    for (auto &child : node->children) {
-        bool ret = hasDirtyNonJointNodes(&child, nodeHasChildJoints);
-        // return if we have child joints and non-joint dirty nodes, else check other children
-        hasChildJoints |= nodeHasChildJoints;
-        if (ret && nodeHasChildJoints)
-            return true;
-    }
-    // return true if we have child joints and we are dirty non-joint
-    hasChildJoints |= nodeHasChildJoints;
-    return dirtyNonJoint && nodeHasChildJoints;
-}
-
 template<typename T, typename V>
 inline void collectNode(V node, QVector<T> &dst, int &dstPos)
 {
@@ -500,6 +452,7 @@ QSSGPrepContextId QSSGLayerRenderData::getOrCreateExtensionContext(const QSSGRen
         sortedScreenTextureObjectCache.emplace_back();
         sortedOpaqueDepthPrepassCache.emplace_back();
         sortedDepthWriteCache.emplace_back();
+        shadowCasterObjectCache.emplace_back();
         QSSG_ASSERT(renderableModelStore.size() == extContexts.size(), renderableModelStore.resize(extContexts.size()));
         QSSG_ASSERT(modelContextStore.size() == extContexts.size(), modelContextStore.resize(extContexts.size()));
         QSSG_ASSERT(renderableObjectStore.size() == extContexts.size(), renderableObjectStore.resize(extContexts.size()));
@@ -511,6 +464,7 @@ QSSGPrepContextId QSSGLayerRenderData::getOrCreateExtensionContext(const QSSGRen
         QSSG_ASSERT(sortedScreenTextureObjectCache.size() == extContexts.size(), sortedScreenTextureObjectCache.resize(extContexts.size()));
         QSSG_ASSERT(sortedOpaqueDepthPrepassCache.size() == extContexts.size(), sortedOpaqueDepthPrepassCache.resize(extContexts.size()));
         QSSG_ASSERT(sortedDepthWriteCache.size() == extContexts.size(), sortedDepthWriteCache.resize(extContexts.size()));
+        QSSG_ASSERT(shadowCasterObjectCache.size() == extContexts.size(), shadowCasterObjectCache.resize(extContexts.size()));
     }
 
     return createPrepId(it->index, frame);
@@ -825,6 +779,37 @@ const QSSGRenderableObjectList &QSSGLayerRenderData::getSortedrenderedOpaqueDept
     return sortedOpaqueDepthPrepassCache[index][&camera];;
 }
 
+const QSSGRenderableObjectList &QSSGLayerRenderData::getShadowCasterObjects(size_t index)
+{
+    index = index * size_t(index < shadowCasterObjectCache.size());
+    auto &shadowCasters = shadowCasterObjectCache[index];
+    if (!shadowCasters.isEmpty())
+        return shadowCasters;
+
+    // Same selection as for the depth lists, minus the frustum culling.
+    if (layer.layerFlags.testFlag(QSSGRenderLayer::LayerFlag::EnableDepthTest)) {
+        const auto collect = [&shadowCasters](const QSSGRenderableObjectList &objects, bool opaque) {
+            for (const auto &handle : objects) {
+                if (!handle.obj->renderableFlags.castsShadows())
+                    continue;
+                const auto depthMode = handle.obj->depthWriteMode;
+                if (depthMode == QSSGDepthDrawMode::Always || depthMode == QSSGDepthDrawMode::OpaquePrePass
+                        || (opaque && depthMode == QSSGDepthDrawMode::OpaqueOnly)) {
+                    shadowCasters.append(handle);
+                }
+            }
+        };
+        if (hasDepthWriteObjects || (depthPrepassObjectsState & DepthPrepassObjectStateT(DepthPrepassObject::Opaque)) != 0)
+            collect(std::as_const(opaqueObjectStore)[index], true);
+        if (hasDepthWriteObjects || (depthPrepassObjectsState & DepthPrepassObjectStateT(DepthPrepassObject::Transparent)) != 0)
+            collect(std::as_const(transparentObjectStore)[index], false);
+        if (hasDepthWriteObjects || (depthPrepassObjectsState & DepthPrepassObjectStateT(DepthPrepassObject::ScreenTexture)) != 0)
+            collect(std::as_const(screenTextureObjectStore)[index], true);
+    }
+
+    return shadowCasters;
+}
+
 /**
  * Usage: T *ptr = RENDER_FRAME_NEW<T>(context, arg0, arg1, ...); is equivalent to: T *ptr = new T(arg0, arg1, ...);
  * so RENDER_FRAME_NEW() takes the RCI + T's arguments
@@ -1466,6 +1451,8 @@ void QSSGLayerRenderData::prepareModelMeshes(const QSSGRenderContextInterface &c
             if (canModelBePickable) {
                 // Check if there is BVH data, if not generate it
                 if (!theMesh->bvh) {
+                    QElapsedTimer bvhTimer;
+                    bvhTimer.start();
                     if (!model.meshPath.isNull())
                         theMesh->bvh = bufferManager->loadMeshBVH(model.meshPath);
                     else if (model.geometry)
@@ -1475,6 +1462,11 @@ void QSSGLayerRenderData::prepareModelMeshes(const QSSGRenderContextInterface &c
                         const auto &roots = theMesh->bvh->roots();
                         for (qsizetype i = 0, end = qsizetype(roots.size()); i < end; ++i)
                             theMesh->subsets[i].bvhRoot = roots[i];
+                        QSSGRHICTX_STAT(contextInterface.rhiContext().get(),
+                                        expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::BvhBuild,
+                                                       model.meshPath.isNull() ? model.geometry->debugObjectName.toUtf8()
+                                                                               : model.meshPath.path().toUtf8(),
+                                                       bvhTimer.nsecsElapsed()));
                     }
                 }
             }
@@ -1583,6 +1575,22 @@ bool QSSGLayerRenderData::prepareModelsForRender(QSSGRenderContextInterface &con
             setBonemapTexture(theModelContext, nullptr);
         }
 
+        // Skinning and morphing by the compute pass, when enabled. All the
+        // subsets share the vertex data.
+        const auto usesCustomVertexShader = [](const QSSGRenderGraphObject *material) {
+            return material && material->type == QSSGRenderGraphObject::Type::CustomMaterial
+                    && static_cast<const QSSGRenderCustomMaterial *>(material)->m_customShaderPresence.testFlag(
+                            QSSGRenderCustomMaterial::CustomShaderPresenceFlag::Vertex);
+        };
+        QRhiBuffer *skinnedVertexBuffer = nullptr;
+        if (meshSubsetCount > 0 && !std::all_of(renderable.materials.cbegin(), renderable.materials.cend(), usesCustomVertexShader)) {
+            skinnedVertexBuffer = QSSGRhiSkinning::prepareModel(rhiCtx.get(),
+                                                                model,
+                                                                meshSubsets.at(0),
+                                                                getBonemapTexture(theModelContext),
+                                                                skinningDispatches);
+        }
+
         // many renderableFlags are the same for all the subsets
         QSSGRenderableObjectFlags renderableFlagsForModel;
 
@@ -1662,6 +1670,18 @@ bool QSSGLayerRenderData::prepareModelsForRender(QSSGRenderContextInterface &con
             float subsetOpacity = modelOpacity;
 
             renderableFlags.setPointsTopology(theSubset.rhi.ia.topology == QRhiGraphicsPipeline::Points);
+
+            // A subset drawn from the vertices animated by the compute pass
+            // gets the shaders of a static mesh.
+            static const QSSGRhiInputAssemblerState staticInputAssembler;
+            const bool preSkinned = skinnedVertexBuffer && !usesCustomVertexShader(theMaterialObject);
+            const QSSGRhiInputAssemblerState &keyInputAssembler = preSkinned ? staticInputAssembler : theSubset.rhi.ia;
+            const quint32 boneCount = preSkinned ? 0 : model.skin ? model.skin->boneCount
+                                                                  : model.skeleton ? model.skeleton->boneCount : 0;
+            if (preSkinned) {
+                renderableFlags.setHasAttributeJointAndWeight(false);
+                renderableFlags.setHasAttributeMorphTarget(false);
+            }
             QSSGRenderableObject *theRenderableObject = &renderableSubsets[subsetIdx++];
 
             bool usesInstancing = theModelContext.model.instancing()
@@ -1759,11 +1779,9 @@ bool QSSGLayerRenderData::prepareModelsForRender(QSSGRenderContextInterface &con
                 defaultMaterialShaderKeyProperties.m_blendParticles.setValue(theGeneratedKey, usesBlendParticles);
 
                 // Skin
-                const auto boneCount = model.skin ? model.skin->boneCount :
-                                                    model.skeleton ? model.skeleton->boneCount : 0;
                 defaultMaterialShaderKeyProperties.m_boneCount.setValue(theGeneratedKey, boneCount);
-                if (auto idJoint = theSubset.rhi.ia.inputs.indexOf(QSSGRhiInputAssemblerState::JointSemantic); idJoint != -1) {
-                    const auto attr = theSubset.rhi.ia.inputLayout.attributeAt(idJoint);
+                if (auto idJoint = keyInputAssembler.inputs.indexOf(QSSGRhiInputAssemblerState::JointSemantic); idJoint != -1) {
+                    const auto attr = keyInputAssembler.inputLayout.attributeAt(idJoint);
                     defaultMaterialShaderKeyProperties.m_usesFloatJointIndices.setValue(theGeneratedKey, checkF32TypeIndex(attr->format()));
                 }
 
@@ -1771,21 +1789,21 @@ bool QSSGLayerRenderData::prepareModelsForRender(QSSGRenderContextInterface &con
                 defaultMaterialShaderKeyProperties.m_usesInstancing.setValue(theGeneratedKey, usesInstancing);
                 // Morphing
                 defaultMaterialShaderKeyProperties.m_targetCount.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetCount);
+                                        keyInputAssembler.targetCount);
                 defaultMaterialShaderKeyProperties.m_targetPositionOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::PositionSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::PositionSemantic]);
                 defaultMaterialShaderKeyProperties.m_targetNormalOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::NormalSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::NormalSemantic]);
                 defaultMaterialShaderKeyProperties.m_targetTangentOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::TangentSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::TangentSemantic]);
                 defaultMaterialShaderKeyProperties.m_targetBinormalOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::BinormalSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::BinormalSemantic]);
                 defaultMaterialShaderKeyProperties.m_targetTexCoord0Offset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::TexCoord0Semantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::TexCoord0Semantic]);
                 defaultMaterialShaderKeyProperties.m_targetTexCoord1Offset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::TexCoord1Semantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::TexCoord1Semantic]);
                 defaultMaterialShaderKeyProperties.m_targetColorOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::ColorSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::ColorSemantic]);
 
                 new (theRenderableObject) QSSGSubsetRenderable(QSSGSubsetRenderable::Type::DefaultMaterialMeshSubset,
                                                                renderableFlags,
@@ -1799,6 +1817,8 @@ bool QSSGLayerRenderData::prepareModelsForRender(QSSGRenderContextInterface &con
                                                                firstImage,
                                                                theGeneratedKey,
                                                                lights);
+                if (preSkinned)
+                    static_cast<QSSGSubsetRenderable *>(theRenderableObject)->skinnedVertexBuffer = skinnedVertexBuffer;
                 wasDirty = wasDirty || renderableFlags.isDirty();
             } else if (theMaterialObject->type == QSSGRenderGraphObject::Type::CustomMaterial) {
                 QSSGRenderCustomMaterial &theMaterial(static_cast<QSSGRenderCustomMaterial &>(*theMaterialObject));
@@ -1820,11 +1840,9 @@ bool QSSGLayerRenderData::prepareModelsForRender(QSSGRenderContextInterface &con
                     defaultMaterialShaderKeyProperties.m_blendParticles.setValue(theGeneratedKey, false);
 
                 // Skin
-                const auto boneCount = model.skin ? model.skin->boneCount :
-                                                    model.skeleton ? model.skeleton->boneCount : 0;
                 defaultMaterialShaderKeyProperties.m_boneCount.setValue(theGeneratedKey, boneCount);
-                if (auto idJoint = theSubset.rhi.ia.inputs.indexOf(QSSGRhiInputAssemblerState::JointSemantic); idJoint != -1) {
-                    const auto attr = theSubset.rhi.ia.inputLayout.attributeAt(idJoint);
+                if (auto idJoint = keyInputAssembler.inputs.indexOf(QSSGRhiInputAssemblerState::JointSemantic); idJoint != -1) {
+                    const auto attr = keyInputAssembler.inputLayout.attributeAt(idJoint);
                     defaultMaterialShaderKeyProperties.m_usesFloatJointIndices.setValue(theGeneratedKey, checkF32TypeIndex(attr->format()));
                 }
 
@@ -1834,21 +1852,21 @@ bool QSSGLayerRenderData::prepareModelsForRender(QSSGRenderContextInterface &con
                 defaultMaterialShaderKeyProperties.m_usesInstancing.setValue(theGeneratedKey, usesInstancing);
                 // Morphing
                 defaultMaterialShaderKeyProperties.m_targetCount.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetCount);
+                                        keyInputAssembler.targetCount);
                 defaultMaterialShaderKeyProperties.m_targetPositionOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::PositionSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::PositionSemantic]);
                 defaultMaterialShaderKeyProperties.m_targetNormalOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::NormalSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::NormalSemantic]);
                 defaultMaterialShaderKeyProperties.m_targetTangentOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::TangentSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::TangentSemantic]);
                 defaultMaterialShaderKeyProperties.m_targetBinormalOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::BinormalSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::BinormalSemantic]);
                 defaultMaterialShaderKeyProperties.m_targetTexCoord0Offset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::TexCoord0Semantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::TexCoord0Semantic]);
                 defaultMaterialShaderKeyProperties.m_targetTexCoord1Offset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::TexCoord1Semantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::TexCoord1Semantic]);
                 defaultMaterialShaderKeyProperties.m_targetColorOffset.setValue(theGeneratedKey,
-                                        theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::ColorSemantic]);
+                                        keyInputAssembler.targetOffsets[QSSGRhiInputAssemblerState::ColorSemantic]);
 
                 if (theMaterial.m_iblProbe)
                     theMaterial.m_iblProbe->clearDirty();
@@ -1865,6 +1883,8 @@ bool QSSGLayerRenderData::prepareModelsForRender(QSSGRenderContextInterface &con
                                                                firstImage,
                                                                theGeneratedKey,
                                                                lights);
+                if (preSkinned)
+                    static_cast<QSSGSubsetRenderable *>(theRenderableObject)->skinnedVertexBuffer = skinnedVertexBuffer;
             }
             if (theRenderableObject) // NOTE: Should just go in with the ctor args
                 theRenderableObject->camdistSq = getCameraDistanceSq(*theRenderableObject, allCameraData[0]);
@@ -2017,11 +2037,148 @@ void QSSGLayerRenderData::prepareResourceLoaders()
         bufferManager->processResourceLoader(static_cast<QSSGRenderResourceLoader *>(resourceLoader));
 }
 
+void QSSGLayerRenderData::prepareLightClusters()
+{
+    lightClusters.ambientTotal = QVector3D();
+    if (lightClusters.lights.isEmpty()) {
+        lightClusters.grid.clear();
+        return;
+    }
+
+    features.set(QSSGShaderFeatures::Feature::ClusteredLights, true);
+
+    const QSSGRenderCamera *camera = renderedCameras[0];
+    const QMatrix4x4 &globalTransform = camera->globalTransform;
+    QMatrix4x4 nonScaledGlobal(Qt::Uninitialized);
+    nonScaledGlobal.setColumn(0, globalTransform.column(0).normalized());
+    nonScaledGlobal.setColumn(1, globalTransform.column(1).normalized());
+    nonScaledGlobal.setColumn(2, globalTransform.column(2).normalized());
+    nonScaledGlobal.setColumn(3, globalTransform.column(3));
+    lightClusters.grid.setup(nonScaledGlobal.inverted(), camera->projection, camera->clipNear, camera->clipFar);
+
+    QList<QSSGLightClusterGrid::LightVolume> &volumes = lightClusters.volumes;
+    volumes.clear();
+    for (const QSSGShaderLight &shaderLight : std::as_const(lightClusters.lights)) {
+        const QSSGRenderLight *light = shaderLight.light;
+        const float constantAttenuation = QSSGUtils::aux::translateConstantAttenuation(light->m_constantFade);
+        const float linearAttenuation = QSSGUtils::aux::translateLinearAttenuation(light->m_linearFade);
+        const float quadraticAttenuation = QSSGUtils::aux::translateQuadraticAttenuation(light->m_quadraticFade);
+        const float diffuseRange = QSSGLightClusterGrid::lightRange(light->m_diffuseColor * light->m_brightness,
+                                                                    constantAttenuation, linearAttenuation, quadraticAttenuation);
+        const float specularRange = QSSGLightClusterGrid::lightRange(light->m_specularColor * light->m_brightness,
+                                                                     constantAttenuation, linearAttenuation, quadraticAttenuation);
+        volumes.append({ light->getGlobalPos(), qMax(diffuseRange, specularRange) });
+        // The clustered lights are never scoped, so their ambient applies to all models
+        lightClusters.ambientTotal += light->m_ambientColor;
+    }
+
+    lightClusters.grid.assign(volumes);
+}
+
+void QSSGLayerRenderData::rhiPrepareSkinnedVertices()
+{
+    if (skinningDispatches.isEmpty())
+        return;
+
+    QSSGRenderContextInterface *ctx = renderer->contextInterface();
+    QSSGRhiContext *rhiCtx = ctx->rhiContext().get();
+    const QShader shader = ctx->shaderCache()->getBuiltInRhiShaders().getRhiSkinningComputeShader();
+    QSSGRhiSkinning::dispatch(rhiCtx, shader, skinningDispatches);
+    skinningDispatches.clear();
+}
+
+void QSSGLayerRenderData::rhiPrepareLightClusters()
+{
+    if (!features.isSet(QSSGShaderFeatures::Feature::ClusteredLights))
+        return;
+
+    // Must match the layout described in lightClusters.glsllib
+    static constexpr int LightTexelCount = 5;
+    static constexpr int GridTextureWidth = 256;
+
+    QSSGRhiContext *rhiCtx = renderer->contextInterface()->rhiContext().get();
+    QRhi *rhi = rhiCtx->rhi();
+
+    // Grows in power of two steps so that a few more lights do not mean a new texture every frame
+    const auto ensureTexture = [rhi](QRhiTexture *&texture, int width, int height, const char *name) {
+        if (texture && texture->pixelSize().height() >= height)
+            return;
+        delete texture;
+        texture = rhi->newTexture(QRhiTexture::RGBA32F, QSize(width, int(qNextPowerOfTwo(quint32(height - 1)))));
+        texture->setName(name);
+        texture->create();
+    };
+
+    const QSSGShaderLightList &lights = lightClusters.lights;
+    const int lightCount = int(lights.size());
+    QList<QVector4D> lightData;
+    lightData.reserve(lightCount * LightTexelCount);
+    for (const QSSGShaderLight &shaderLight : lights) {
+        const QSSGRenderLight *light = shaderLight.light;
+        const bool isSpot = light->type == QSSGRenderLight::Type::SpotLight;
+        float coneAngle = 180.0f;
+        float innerConeAngle = 0.0f;
+        if (isSpot) {
+            coneAngle = qCos(qDegreesToRadians(light->m_coneAngle));
+            innerConeAngle = qCos(qDegreesToRadians(qMin(light->m_innerConeAngle, light->m_coneAngle)));
+        }
+        lightData.append(QVector4D(light->getGlobalPos(), isSpot ? 1.0f : 0.0f));
+        lightData.append(QVector4D(shaderLight.direction, coneAngle));
+        lightData.append(QVector4D(light->m_diffuseColor * light->m_brightness, innerConeAngle));
+        lightData.append(QVector4D(light->m_specularColor * light->m_brightness, 0.0f));
+        lightData.append(QVector4D(QSSGUtils::aux::translateConstantAttenuation(light->m_constantFade),
+                                   QSSGUtils::aux::translateLinearAttenuation(light->m_linearFade),
+                                   QSSGUtils::aux::translateQuadraticAttenuation(light->m_quadraticFade),
+                                   0.0f));
+    }
+
+    const auto &clusters = lightClusters.grid.clusters();
+    const auto &lightIndices = lightClusters.grid.lightIndices();
+    const int gridTexelCount = QSSGLightClusterGrid::ClusterCount + int((lightIndices.size() + 3) / 4);
+    const int gridRows = (gridTexelCount + GridTextureWidth - 1) / GridTextureWidth;
+    QList<QVector4D> gridData(gridRows * GridTextureWidth);
+    for (int i = 0; i < QSSGLightClusterGrid::ClusterCount; ++i)
+        gridData[i] = QVector4D(float(clusters[i].offset), float(clusters[i].count), 0.0f, 0.0f);
+    for (qsizetype i = 0, count = lightIndices.size(); i < count; ++i)
+        gridData[QSSGLightClusterGrid::ClusterCount + i / 4][int(i % 4)] = float(lightIndices[i]);
+
+    ensureTexture(lightClusters.lightsTexture, LightTexelCount, lightCount, "Light clusters (lights)");
+    ensureTexture(lightClusters.gridTexture, GridTextureWidth, gridRows, "Light clusters (grid)");
+
+    QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+    QRhiTextureSubresourceUploadDescription lightsDesc(lightData.constData(), quint32(lightData.size() * sizeof(QVector4D)));
+    lightsDesc.setSourceSize(QSize(LightTexelCount, lightCount));
+    rub->uploadTexture(lightClusters.lightsTexture, QRhiTextureUploadEntry(0, 0, lightsDesc));
+    QRhiTextureSubresourceUploadDescription gridDesc(gridData.constData(), quint32(gridData.size() * sizeof(QVector4D)));
+    gridDesc.setSourceSize(QSize(GridTextureWidth, gridRows));
+    rub->uploadTexture(lightClusters.gridTexture, QRhiTextureUploadEntry(0, 0, gridDesc));
+    rhiCtx->commandBuffer()->resourceUpdate(rub);
+}
+
 void QSSGLayerRenderData::prepareReflectionProbesForRender()
 {
     const auto probeCount = reflectionProbes.size();
     requestReflectionMapManager(); // ensure that we have a reflection map manager
 
+    // Static probes show a baked map when there is one for what they see. The
+    // key covers every object casting reflections, and is only computed when a
+    // probe is new or has an update scheduled.
+    const bool bakeRequested = QSSGReflectionProbeBaker::bakeRequested();
+    QSSGRenderableObjectList reflectionCasters;
+    bool reflectionCastersCollected = false;
+    const auto bakeKeyForProbe = [&](const QSSGRenderReflectionProbe &probe) {
+        if (!reflectionCastersCollected) {
+            reflectionCastersCollected = true;
+            for (const auto *store : { &opaqueObjectStore[0], &transparentObjectStore[0], &screenTextureObjectStore[0] }) {
+                for (const auto &handle : *store) {
+                    if (handle.obj->renderableFlags.testFlag(QSSGRenderableObjectFlag::CastsReflections))
+                        reflectionCasters.push_back(handle);
+                }
+            }
+        }
+        return QSSGReflectionProbeBaker::contentKey(probe, layer, reflectionCasters);
+    };
+
     for (int i = 0; i < probeCount; i++) {
         QSSGRenderReflectionProbe* probe = reflectionProbes.at(i);
 
@@ -2071,10 +2228,25 @@ void QSSGLayerRenderData::prepareReflectionProbesForRender()
         for (const auto &handle : std::as_const(screenTextureObjects))
             injectProbe(handle);
 
-        if (probe->texture)
+        if (probe->texture) {
             reflectionMapManager->addTexturedReflectionMapEntry(i, *probe);
-        else if (reflectionObjectCount > 0)
-            reflectionMapManager->addReflectionMapEntry(i, *probe);
+        } else if (reflectionObjectCount > 0) {
+            QByteArray bakeKey;
+            if (probe->refreshMode == QSSGRenderReflectionProbe::ReflectionRefreshMode::FirstFrame) {
+                const QSSGReflectionMapEntry *entry = reflectionMapManager->reflectionMapEntry(i);
+                if (entry && !probe->hasScheduledUpdate && !bakeRequested)
+                    bakeKey = entry->m_bakeKey;
+                else
+                    bakeKey = bakeKeyForProbe(*probe);
+            }
+            if (!bakeRequested && !bakeKey.isEmpty() && reflectionMapManager->addBakedReflectionMapEntry(i, bakeKey)) {
+                probe->hasScheduledUpdate = false;
+            } else {
+                reflectionMapManager->addReflectionMapEntry(i, *probe);
+                if (QSSGReflectionMapEntry *entry = reflectionMapManager->reflectionMapEntry(i))
+                    entry->m_bakeKey = bakeRequested ? bakeKey : QByteArray();
+            }
+        }
     }
 }
 
@@ -2091,6 +2263,21 @@ static bool scopeLight(QSSGRenderNode *node, QSSGRenderNode *lightScope)
 
 static const int REDUCED_MAX_LIGHT_COUNT_THRESHOLD_BYTES = 4096; // 256 vec4
 
+static bool useClusteredLighting(QRhi *rhi)
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_QUICK3D_CLUSTERED_LIGHTING") > 0;
+    // The light data is read with texelFetch from 32-bit float textures
+    return enabled && rhi && rhi->isFeatureSupported(QRhi::TexelFetch)
+            && rhi->isTextureFormatSupported(QRhiTexture::RGBA32F);
+}
+
+static inline bool canClusterLight(const QSSGRenderLight &light)
+{
+    // Anything that needs per-light shader code stays in the per-model light list
+    return (light.type == QSSGRenderLight::Type::PointLight || light.type == QSSGRenderLight::Type::SpotLight)
+            && !light.m_castShadow && !light.m_scope && !light.m_fullyBaked;
+}
+
 static inline int effectiveMaxLightCount(const QSSGShaderFeatures &features)
 {
     if (features.isSet(QSSGShaderFeatures::Feature::ReduceMaxNumLights))
@@ -2101,37 +2288,26 @@ static inline int effectiveMaxLightCount(const QSSGShaderFeatures &features)
 
 void updateDirtySkeletons(const QVector<QSSGRenderableNodeEntry> &renderableNodes)
 {
-    // First model using skeleton clears the dirty flag so we need another mechanism
-    // to tell to the other models the skeleton is dirty.
-    QSet<QSSGRenderSkeleton *> dirtySkeletons;
+    // First model using skeleton clears the dirty flag, so each dirty skeleton
+    // is collected once, with the inverse bind poses of that model.
+    QList<QSSGSkinningSystem::SkeletonPose> dirtySkeletons;
     for (const auto &node : std::as_const(renderableNodes)) {
         if (node.node->type == QSSGRenderGraphObject::Type::Model) {
             auto modelNode = static_cast<QSSGRenderModel *>(node.node);
             auto skeletonNode = modelNode->skeleton;
-            bool hcj = false;
-            if (skeletonNode) {
-                const bool dirtySkeleton = dirtySkeletons.contains(skeletonNode);
+            if (skeletonNode && !skeletonNode->paletteQueued) {
+                if (skeletonNode->jointsDirty)
+                    QSSGSkinningSystem::flatten(*skeletonNode);
                 const bool hasDirtyNonJoints = (skeletonNode->containsNonJointNodes
-                                                && (hasDirtyNonJointNodes(skeletonNode, hcj) || dirtySkeleton));
+                                                && QSSGSkinningSystem::hasDirtyNonJointNodes(*skeletonNode));
                 const bool dirtyTransform = skeletonNode->isDirty(QSSGRenderNode::DirtyFlag::TransformDirty);
                 if (skeletonNode->skinningDirty || hasDirtyNonJoints || dirtyTransform) {
                     skeletonNode->boneTransformsDirty = false;
-                    if (hasDirtyNonJoints && !dirtySkeleton)
-                        dirtySkeletons.insert(skeletonNode);
                     skeletonNode->skinningDirty = false;
-                    const qsizetype dataSize = BONEDATASIZE4ID(skeletonNode->maxIndex);
-                    if (skeletonNode->boneData.size() < dataSize)
-                        skeletonNode->boneData.resize(dataSize);
-                    skeletonNode->calculateGlobalVariables();
-                    skeletonNode->containsNonJointNodes = false;
-                    for (auto &child : skeletonNode->children)
-                        collectBoneTransforms(&child, skeletonNode, modelNode->inverseBindPoses);
+                    skeletonNode->paletteQueued = true;
+                    QSSGSkinningSystem::prepare(*skeletonNode);
+                    dirtySkeletons.append({ skeletonNode, &modelNode->inverseBindPoses });
                 }
-                skeletonNode->boneCount = skeletonNode->boneData.size() / 2 / 4 / 16;
-                const int boneTexWidth = qCeil(qSqrt(skeletonNode->boneCount * 4 * 2));
-                skeletonNode->boneTexData.setSize(QSize(boneTexWidth, boneTexWidth));
-                skeletonNode->boneData.resize(boneTexWidth * boneTexWidth * 16);
-                skeletonNode->boneTexData.setTextureData(skeletonNode->boneData);
             }
             const int numMorphTarget = modelNode->morphTargets.size();
             for (int i = 0; i < numMorphTarget; ++i) {
@@ -2146,7 +2322,12 @@ void updateDirtySkeletons(const QVector<QSSGRenderableNodeEntry> &renderableNode
         }
     }
 
-    dirtySkeletons.clear();
+    QSSGSkinningSystem::evaluatePalettes(dirtySkeletons);
+    // Skeletons whose palette did not change are not uploaded again
+    for (const auto &pose : std::as_const(dirtySkeletons)) {
+        QSSGSkinningSystem::commitPalette(*pose.skeleton);
+        pose.skeleton->paletteQueued = false;
+    }
 }
 
 void QSSGLayerRenderData::prepareForRender()
@@ -2354,21 +2535,27 @@ void QSSGLayerRenderData::prepareForRender()
     // Determine how many lights will need shadow maps
     // NOTE: This culling is specific to our Forward renderer
     const int maxLightCount = effectiveMaxLightCount(features);
-    const bool showLightCountWarning = !tooManyLightsWarningShown && (lights.size() > maxLightCount);
-    if (showLightCountWarning) {
-        qWarning("Too many lights in scene, maximum is %d", maxLightCount);
-        tooManyLightsWarningShown = true;
-    }
+    const bool clusterLights = useClusteredLighting(renderer->contextInterface()->rhi()) && renderedCameras.size() == 1;
 
     QSSGShaderLightList renderableLights; // All lights (upto 'maxLightCount')
+    lightClusters.lights.clear();
 
     // List should contain only enabled lights (active && birghtness > 0).
     {
-        auto it = lights.crbegin();
-        const auto end = it + qMin(maxLightCount, lights.size());
-
-        for (; it != end; ++it) {
+        qsizetype skippedLightCount = 0;
+        for (auto it = lights.crbegin(), end = lights.crend(); it != end; ++it) {
             QSSGRenderLight *renderLight = (*it);
+            if (clusterLights && canClusterLight(*renderLight)) {
+                if (lightClusters.lights.size() < QSSGLightClusterGrid::MaxLightCount)
+                    lightClusters.lights.push_back(QSSGShaderLight{ renderLight, false, renderLight->getScalingCorrectDirection() });
+                else
+                    ++skippedLightCount;
+                continue;
+            }
+            if (renderableLights.size() == maxLightCount) {
+                ++skippedLightCount;
+                continue;
+            }
             hasScopedLights |= (renderLight->m_scope != nullptr);
             const bool mightCastShadows = renderLight->m_castShadow && !renderLight->m_fullyBaked;
             const bool shadows = mightCastShadows && (shadowMapCount < QSSG_MAX_NUM_SHADOW_MAPS);
@@ -2377,6 +2564,11 @@ void QSSGLayerRenderData::prepareForRender()
             renderableLights.push_back(QSSGShaderLight{ renderLight, shadows, direction });
         }
 
+        if (skippedLightCount > 0 && !tooManyLightsWarningShown) {
+            qWarning("Too many lights in scene, maximum is %d", clusterLights ? maxLightCount + QSSGLightClusterGrid::MaxLightCount : maxLightCount);
+            tooManyLightsWarningShown = true;
+        }
+
         if ((shadowMapCount >= QSSG_MAX_NUM_SHADOW_MAPS) && !tooManyShadowLightsWarningShown) {
             qWarning("Too many shadow casting lights in scene, maximum is %d", QSSG_MAX_NUM_SHADOW_MAPS);
             tooManyShadowLightsWarningShown = true;
@@ -2446,6 +2638,8 @@ void QSSGLayerRenderData::prepareForRender()
         prepareLights(renderableParticles);
     }
 
+    prepareLightClusters();
+
     bool hasUserExtensions = false;
 
     {
@@ -2628,6 +2822,7 @@ void QSSGLayerRenderData::resetForFrame()
     renderableItem2Ds.clear();
     lightmapTextures.clear();
     bonemapTextures.clear();
+    skinningDispatches.clear();
     globalLights.clear();
     modelContexts.clear();
     features = QSSGShaderFeatures();
@@ -2646,6 +2841,7 @@ void QSSGLayerRenderData::resetForFrame()
     clearTable(sortedScreenTextureObjectCache);
     clearTable(sortedOpaqueDepthPrepassCache);
     clearTable(sortedDepthWriteCache);
+    clearTable(shadowCasterObjectCache);
 }
 
 QSSGLayerRenderPreparationResult::QSSGLayerRenderPreparationResult(const QRectF &inViewport, QSSGRenderLayer &inLayer)
@@ -2693,11 +2889,15 @@ QSSGLayerRenderData::QSSGLayerRenderData(QSSGRenderLayer &inLayer, QSSGRenderer
 QSSGLayerRenderData::~QSSGLayerRenderData()
 {
     delete m_lightmapper;
+    delete lightClusters.gridTexture;
+    delete lightClusters.lightsTexture;
     for (auto &pass : activePasses)
         pass->resetForFrame();
 
     for (auto &renderResult : renderResults)
         renderResult.reset();
+
+    ssaoMapPass.releaseResources();
 }
 
 static void sortInstances(QByteArray &sortedData, QList<QSSGRhiSortData> &sortData, const void *instances,
@@ -30,6 +30,8 @@
 #include <QtQuick3DRuntimeRender/private/qssgperframeallocator_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgshadermapkey_p.h>
 #include <QtQuick3DRuntimeRender/private/qssglightmapper_p.h>
+#include <QtQuick3DRuntimeRender/private/qssglightclustergrid_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhiskinning_p.h>
 #include <ssg/qssgrenderextensions.h>
 
 #include <QtQuick3DUtils/private/qssgrenderbasetypes_p.h>
@@ -215,6 +217,7 @@ public:
                                  const RenderableItem2DEntries &renderableItem2Ds);
 
     void prepareResourceLoaders();
+    void prepareLightClusters();
 
     void prepareForRender();
     // Helper function used during prepareForRender
@@ -233,11 +236,18 @@ public:
     const RenderableItem2DEntries &getRenderableItem2Ds();
     const QSSGRenderableObjectList &getSortedRenderedDepthWriteObjects(const QSSGRenderCamera &camera, size_t index = 0);
     const QSSGRenderableObjectList &getSortedrenderedOpaqueDepthPrepassObjects(const QSSGRenderCamera &camera, size_t index = 0);
+    // Depth writing objects that cast shadows. Not culled against the camera frustum
+    // as objects outside of the view can still cast shadows into it. Not sorted.
+    const QSSGRenderableObjectList &getShadowCasterObjects(size_t index = 0);
 
     void resetForFrame();
 
     void maybeBakeLightmap();
 
+    void rhiPrepareLightClusters();
+
+    void rhiPrepareSkinnedVertices();
+
     QSSGFrameData &getFrameData();
 
     ShadowMapPass shadowMapPass;
@@ -277,6 +287,17 @@ public:
     QSSGRenderCameraList renderedCameras; // multiple items with multiview, one otherwise (or zero if no cameras at all)
     QSSGShaderLightList globalLights; // All non-scoped lights
 
+    // Point and spot lights that are not in the per-model light lists, but
+    // binned into the grid instead (QT_QUICK3D_CLUSTERED_LIGHTING).
+    struct LightClusters {
+        QSSGLightClusterGrid grid;
+        QSSGShaderLightList lights;
+        QList<QSSGLightClusterGrid::LightVolume> volumes;
+        QVector3D ambientTotal;
+        QRhiTexture *gridTexture = nullptr;
+        QRhiTexture *lightsTexture = nullptr;
+    } lightClusters;
+
     QVector<QSSGBakedLightingModel> bakedLightingModels;
     // Sorted lists of the rendered objects.  There may be other transforms applied so
     // it is simplest to duplicate the lists.
@@ -425,6 +446,7 @@ private:
     std::vector<PerCameraCache> sortedScreenTextureObjectCache { { /* 0 - Always available */ } };
     std::vector<PerCameraCache> sortedOpaqueDepthPrepassCache { { /* 0 - Always available */ } };
     std::vector<PerCameraCache> sortedDepthWriteCache { { /* 0 - Always available */ } };
+    std::vector<QSSGRenderableObjectList> shadowCasterObjectCache { { /* 0 - Always available */ } };
 
     [[nodiscard]] const QSSGRenderCameraDataList &getCachedCameraDatas();
     void ensureCachedCameraDatas();
@@ -480,6 +502,8 @@ private:
     QSSGRenderReflectionMapPtr reflectionMapManager;
     QHash<const QSSGModelContext *, QRhiTexture *> lightmapTextures;
     QHash<const QSSGModelContext *, QRhiTexture *> bonemapTextures;
+    // Models whose vertices are to be skinned or morphed by the compute pass
+    QList<QSSGRhiSkinning::Dispatch> skinningDispatches;
     QSSGRhiRenderableTexture renderResults[3] {};
 };
 
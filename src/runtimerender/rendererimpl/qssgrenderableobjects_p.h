@@ -332,6 +332,8 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGSubsetRenderable : public QSSGRenderabl
     const QSSGModelContext &modelContext;
     const QSSGRenderSubset &subset;
     QRhiBuffer *instanceBuffer = nullptr;
+    // Not owned, set when the vertices are skinned and morphed by QSSGRhiSkinning
+    QRhiBuffer *skinnedVertexBuffer = nullptr;
     float opacity;
     const QSSGRenderGraphObject &material;
     QSSGRenderableImage *firstImage;
@@ -374,6 +376,13 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGSubsetRenderable : public QSSGRenderabl
                          const QSSGShaderLightListView &inLights);
 
     [[nodiscard]] const QSSGRenderGraphObject &getMaterial() const { return material; }
+
+    // The buffer and base vertex the subset is drawn with
+    [[nodiscard]] QRhiBuffer *vertexBuffer() const
+    {
+        return skinnedVertexBuffer ? skinnedVertexBuffer : subset.rhi.vertexBuffer->buffer();
+    }
+    [[nodiscard]] quint32 baseVertex() const { return skinnedVertexBuffer ? 0 : subset.rhi.baseVertex; }
 };
 
 Q_STATIC_ASSERT(std::is_trivially_destructible<QSSGSubsetRenderable>::value);
@@ -32,6 +32,7 @@
 
 #include <QtCore/QMutexLocker>
 #include <QtCore/QBitArray>
+#include <QtCore/QElapsedTimer>
 
 #include <cstdlib>
 #include <algorithm>
@@ -117,16 +118,30 @@ void QSSGRenderer::rhiPrepare(QSSGRenderLayer &inLayer)
         QSSGRhiContext *rhiCtx = contextInterface()->rhiContext().get();
         QSSG_ASSERT(rhiCtx->isValid() && rhiCtx->rhi()->isRecordingFrame(), return);
         theRenderData->maybeBakeLightmap();
+        theRenderData->rhiPrepareLightClusters();
+        theRenderData->rhiPrepareSkinnedVertices();
         beginLayerRender(*theRenderData);
         // Process active passes. "PreMain" passes are individual passes
         // that does can and should be done in the rhi prepare phase.
         // It is assumed that passes are sorted in the list with regards to
         // execution order.
         const auto &activePasses = theRenderData->activePasses;
+        QSSGRhiContextStats &stats = QSSGRhiContextStats::get(*rhiCtx);
+        const bool timePasses = stats.isEnabled();
+        QElapsedTimer passTimer;
         for (const auto &pass : activePasses) {
+            if (timePasses)
+                passTimer.start();
             pass->renderPrep(*this, *theRenderData);
-            if (pass->passType() == QSSGRenderPass::Type::Standalone)
+            if (timePasses)
+                stats.passPrepared(pass->debugName(), passTimer.nsecsElapsed());
+            if (pass->passType() == QSSGRenderPass::Type::Standalone) {
+                if (timePasses)
+                    passTimer.start();
                 pass->renderPass(*this);
+                if (timePasses)
+                    stats.passRecorded(pass->debugName(), passTimer.nsecsElapsed());
+            }
         }
 
         endLayerRender();
@@ -141,9 +156,17 @@ void QSSGRenderer::rhiRender(QSSGRenderLayer &inLayer)
     if (theRenderData->layerPrepResult.isLayerVisible()) {
         beginLayerRender(*theRenderData);
         const auto &activePasses = theRenderData->activePasses;
+        QSSGRhiContextStats &stats = QSSGRhiContextStats::get(*contextInterface()->rhiContext());
+        const bool timePasses = stats.isEnabled();
+        QElapsedTimer passTimer;
         for (const auto &pass : activePasses) {
-            if (pass->passType() == QSSGRenderPass::Type::Main || pass->passType() == QSSGRenderPass::Type::Extension)
+            if (pass->passType() == QSSGRenderPass::Type::Main || pass->passType() == QSSGRenderPass::Type::Extension) {
+                if (timePasses)
+                    passTimer.start();
                 pass->renderPass(*this);
+                if (timePasses)
+                    stats.passRecorded(pass->debugName(), passTimer.nsecsElapsed());
+            }
         }
         endLayerRender();
     }
@@ -165,6 +188,7 @@ static void cleanupResourcesImpl(const QSSGRenderContextInterface &rci, const Co
         } else if (resource->type == QSSGRenderGraphObject::Type::Model) {
             auto model = static_cast<QSSGRenderModel*>(resource);
             QSSGRhiContextPrivate::get(rhiCtx.get())->cleanupDrawCallData(model);
+            QSSGRhiContextPrivate::get(rhiCtx.get())->releaseSkinnedVertexData(model);
             delete model->particleBuffer;
         } else if (resource->type == QSSGRenderGraphObject::Type::TextureData || resource->type == QSSGRenderGraphObject::Type::Skin) {
             static_assert(std::is_base_of_v<QSSGRenderTextureData, QSSGRenderSkin>, "QSSGRenderSkin is expected to be a QSSGRenderTextureData type!");
@@ -595,7 +619,11 @@ QSSGRhiShaderPipelinePtr QSSGRendererPrivate::getShaderPipelineForDefaultMateria
         Q_TRACE_SCOPE(QSSG_generateShader);
         Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DGenerateShader);
         shaderPipeline = QSSGRendererPrivate::generateRhiShaderPipeline(renderer, inRenderable, inFeatureSet);
-        Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DGenerateShader, 0, inRenderable.material.profilingId);
+        Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DGenerateShader, quint64(skey.m_hashCode), inRenderable.material.profilingId);
+        QSSGRHICTX_STAT(renderer.m_contextInterface->rhiContext().get(),
+                        expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::ShaderGeneration,
+                                       QByteArray::number(quint64(skey.m_hashCode), 16),
+                                       timer.nsecsElapsed()));
         // make skey useable as a key for the QHash (makes a copy of the materialKey, instead of just referencing)
         skey.detach();
         // insert it no matter what, no point in trying over and over again
@@ -47,6 +47,9 @@ public:
     QSSGRhiShaderPipelinePtr getRhiOrthographicShadowBlurXShader();
     QSSGRhiShaderPipelinePtr getRhiOrthographicShadowBlurYShader();
     QSSGRhiShaderPipelinePtr getRhiSsaoShader(int viewCount);
+    QSSGRhiShaderPipelinePtr getRhiSsaoDepthDownsampleShader();
+    QSSGRhiShaderPipelinePtr getRhiSsaoTemporalShader();
+    QSSGRhiShaderPipelinePtr getRhiSsaoUpsampleShader();
     QSSGRhiShaderPipelinePtr getRhiSkyBoxCubeShader(int viewCount);
     QSSGRhiShaderPipelinePtr getRhiSkyBoxShader(QSSGRenderLayer::TonemapMode tonemapMode, bool isRGBE, int viewCount);
     QSSGRhiShaderPipelinePtr getRhiSupersampleResolveShader(int viewCount);
@@ -56,10 +59,13 @@ public:
     QSSGRhiShaderPipelinePtr getRhiLightmapUVRasterizationShader(LightmapUVRasterizationShaderMode mode);
     QSSGRhiShaderPipelinePtr getRhiLightmapDilateShader();
     QSSGRhiShaderPipelinePtr getRhiDebugObjectShader();
+    QSSGRhiShaderPipelinePtr getRhiItem2DAtlasShader(int viewCount);
     QSSGRhiShaderPipelinePtr getRhiReflectionprobePreFilterShader();
     QSSGRhiShaderPipelinePtr getRhienvironmentmapPreFilterShader(bool isRGBE);
     QSSGRhiShaderPipelinePtr getRhiEnvironmentmapShader();
 
+    QShader getRhiSkinningComputeShader();
+
 private:
     QSSGShaderCache &m_shaderCache; // We're owned by the shadercache
 
@@ -74,6 +80,12 @@ private:
                                                 BuiltinShader &storage,
                                                 int viewCount = 1);
 
+    struct BuiltinComputeShader {
+        // Loading is attempted only once, shader is invalid if it failed.
+        QShader shader;
+        bool loaded = false;
+    };
+
     struct {
         BuiltinShader cubemapShadowBlurXRhiShader;
         BuiltinShader cubemapShadowBlurYRhiShader;
@@ -81,6 +93,9 @@ private:
         BuiltinShader orthographicShadowBlurXRhiShader;
         BuiltinShader orthographicShadowBlurYRhiShader;
         BuiltinShader ssaoRhiShader;
+        BuiltinShader ssaoDepthDownsampleRhiShader;
+        BuiltinShader ssaoTemporalRhiShader;
+        BuiltinShader ssaoUpsampleRhiShader;
         BuiltinShader skyBoxRhiShader[QSSGRenderLayer::TonemapModeCount * 2 /* rgbe+hdr */];
         BuiltinShader skyBoxCubeRhiShader;
         BuiltinShader supersampleResolveRhiShader;
@@ -92,6 +107,7 @@ private:
         BuiltinShader lightmapUVRasterShader_uv_tangent;
         BuiltinShader lightmapDilateShader;
         BuiltinShader debugObjectShader;
+        BuiltinShader item2DAtlasShader;
 
         BuiltinShader reflectionprobePreFilterShader;
         BuiltinShader environmentmapPreFilterShader[2];
@@ -109,6 +125,8 @@ private:
         BuiltinShader lineParticlesVLightRhiShader;
         BuiltinShader lineParticlesMappedVLightRhiShader;
         BuiltinShader lineParticlesAnimatedVLightRhiShader;
+
+        BuiltinComputeShader skinningComputeShader;
     } m_cache;
 };
 
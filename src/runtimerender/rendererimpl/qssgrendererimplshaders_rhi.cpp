@@ -69,6 +69,21 @@ QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiSsaoShader(int viewCou
     return getBuiltinRhiShader(QByteArrayLiteral("ssao"), m_cache.ssaoRhiShader, viewCount);
 }
 
+QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiSsaoDepthDownsampleShader()
+{
+    return getBuiltinRhiShader(QByteArrayLiteral("ssaodepthdownsample"), m_cache.ssaoDepthDownsampleRhiShader);
+}
+
+QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiSsaoTemporalShader()
+{
+    return getBuiltinRhiShader(QByteArrayLiteral("ssaotemporal"), m_cache.ssaoTemporalRhiShader);
+}
+
+QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiSsaoUpsampleShader()
+{
+    return getBuiltinRhiShader(QByteArrayLiteral("ssaoupsample"), m_cache.ssaoUpsampleRhiShader);
+}
+
 QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiSkyBoxCubeShader(int viewCount)
 {
     return getBuiltinRhiShader(QByteArrayLiteral("skyboxcube"), m_cache.skyBoxCubeRhiShader, viewCount);
@@ -198,6 +213,11 @@ QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiDebugObjectShader()
     return getBuiltinRhiShader(QByteArrayLiteral("debugobject"), m_cache.debugObjectShader);
 }
 
+QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiItem2DAtlasShader(int viewCount)
+{
+    return getBuiltinRhiShader(QByteArrayLiteral("item2datlas"), m_cache.item2DAtlasShader, viewCount);
+}
+
 QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiReflectionprobePreFilterShader()
 {
     return getBuiltinRhiShader(QByteArrayLiteral("reflectionprobeprefilter"), m_cache.reflectionprobePreFilterShader);
@@ -215,4 +235,14 @@ QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiEnvironmentmapShader()
     return getBuiltinRhiShader(QByteArrayLiteral("environmentmap"), m_cache.environmentmapShader);
 }
 
+QShader QSSGBuiltInRhiShaderCache::getRhiSkinningComputeShader()
+{
+    BuiltinComputeShader &storage = m_cache.skinningComputeShader;
+    if (!storage.loaded) {
+        storage.shader = m_shaderCache.loadBuiltinComputeUncached(QByteArrayLiteral("skinning"));
+        storage.loaded = true;
+    }
+    return storage.shader;
+}
+
 QT_END_NAMESPACE
@@ -14,8 +14,10 @@
 #include "../qssgrenderdefaultmaterialshadergenerator_p.h"
 #include "rendererimpl/qssgshadowmaphelpers_p.h"
 #include <QtQuick3DUtils/private/qssgassert_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendertexturedata_p.h>
 
 #include <QtCore/qbitarray.h>
+#include <QtCore/qelapsedtimer.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -54,6 +56,7 @@ static void updateUniformsForDefaultMaterial(QSSGRhiShaderPipeline &shaderPipeli
                                              char *ubufData,
                                              QSSGRhiGraphicsPipelineState *ps,
                                              QSSGSubsetRenderable &subsetRenderable,
+                                             const QSSGShaderFeatures &featureSet,
                                              const QSSGRenderCameraList &cameras,
                                              const QVector2D *depthAdjust,
                                              const QMatrix4x4 *alteredModelViewProjection)
@@ -89,6 +92,7 @@ static void updateUniformsForDefaultMaterial(QSSGRhiShaderPipeline &shaderPipeli
                                                           subsetRenderable.firstImage,
                                                           subsetRenderable.opacity,
                                                           inData,
+                                                          featureSet,
                                                           subsetRenderable.lights,
                                                           subsetRenderable.reflectionProbe,
                                                           subsetRenderable.renderableFlags.receivesShadows(),
@@ -599,15 +603,13 @@ static void rhiPrepareResourcesForReflectionMap(QSSGRhiContext *rhiCtx,
     // because of alteredCamera/alteredMvp below
     features.set(QSSGShaderFeatures::Feature::DisableMultiView, true);
 
-    const auto &defaultMaterialShaderKeyProperties = inData.getDefaultMaterialPropertyTable();
-
     for (const auto &handle : sortedOpaqueObjects) {
         QSSGRenderableObject &inObject = *handle.obj;
 
         QMatrix4x4 modelViewProjection;
         if (inObject.type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset || inObject.type == QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
             QSSGSubsetRenderable &renderable(static_cast<QSSGSubsetRenderable &>(inObject));
-            const bool hasSkinning = defaultMaterialShaderKeyProperties.m_boneCount.getValue(renderable.shaderDescription) > 0;
+            const bool hasSkinning = renderable.modelContext.model.usesBoneTexture();
             modelViewProjection = hasSkinning ? pEntry->m_viewProjection
                                               : pEntry->m_viewProjection * renderable.globalTransform;
         }
@@ -699,7 +701,7 @@ static void rhiPrepareResourcesForShadowMap(QSSGRhiContext *rhiCtx,
         QMatrix4x4 modelViewProjection;
         QSSGSubsetRenderable &renderable(static_cast<QSSGSubsetRenderable &>(*theObject));
         if (theObject->type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset || theObject->type == QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
-            const bool hasSkinning = defaultMaterialShaderKeyProperties.m_boneCount.getValue(renderable.shaderDescription) > 0;
+            const bool hasSkinning = renderable.modelContext.model.usesBoneTexture();
             modelViewProjection = hasSkinning ? pEntry->m_lightViewProjection[cascadeIndex]
                                               : pEntry->m_lightViewProjection[cascadeIndex] * renderable.globalTransform;
             // cascadeIndex is 0..3 for directional light and 0 for the pointlight & spotlight
@@ -724,7 +726,7 @@ static void rhiPrepareResourcesForShadowMap(QSSGRhiContext *rhiCtx,
             char *ubufData = dcd->ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
             // calls updateUni with an alteredCamera and alteredModelViewProjection
             QSSGRenderCameraList cameras({ &inCamera });
-            updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, cameras, depthAdjust, &modelViewProjection);
+            updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, objectFeatureSet, cameras, depthAdjust, &modelViewProjection);
             if (blendParticles)
                 QSSGParticleRenderer::updateUniformsForParticleModel(*shaderPipeline, ubufData, &subsetRenderable.modelContext.model, subsetRenderable.subset.offset);
             dcd->ubuf->endFullDynamicBufferUpdateForCurrentFrame();
@@ -743,7 +745,7 @@ static void rhiPrepareResourcesForShadowMap(QSSGRhiContext *rhiCtx,
             // inCamera is the shadow camera, not the same as inData.renderedCameras
             QSSGRenderCameraList cameras({ &inCamera });
             customMaterialSystem.updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, material, subsetRenderable,
-                                                                 cameras, depthAdjust, &modelViewProjection);
+                                                                 objectFeatureSet, cameras, depthAdjust, &modelViewProjection);
             dcd->ubuf->endFullDynamicBufferUpdateForCurrentFrame();
         }
 
@@ -880,6 +882,10 @@ void RenderHelpers::rhiPrepareRenderable(QSSGRhiContext *rhiCtx,
 {
     const auto &defaultMaterialShaderKeyProperties = inData.getDefaultMaterialPropertyTable();
 
+    // The light clusters are only valid for the layer's camera
+    if (alteredCamera || cubeFace != QSSGRenderTextureCubeFaceNone)
+        featureSet.set(QSSGShaderFeatures::Feature::ClusteredLights, false);
+
     switch (inObject.type) {
     case QSSGRenderableObject::Type::DefaultMaterialMeshSubset:
     {
@@ -929,10 +935,10 @@ void RenderHelpers::rhiPrepareRenderable(QSSGRhiContext *rhiCtx,
             if (alteredCamera) {
                 Q_ASSERT(alteredModelViewProjection);
                 QSSGRenderCameraList cameras({ alteredCamera });
-                updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, cameras, nullptr, alteredModelViewProjection);
+                updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, featureSet, cameras, nullptr, alteredModelViewProjection);
             } else {
                 Q_ASSERT(!alteredModelViewProjection);
-                updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, inData.renderedCameras, nullptr, nullptr);
+                updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, featureSet, inData.renderedCameras, nullptr, nullptr);
             }
 
             if (blendParticles)
@@ -1123,6 +1129,21 @@ void RenderHelpers::rhiPrepareRenderable(QSSGRhiContext *rhiCtx,
                                             shaderPipeline->lightmapTexture(), sampler);
                     } // else ignore, not an error
                 }
+
+                if (shaderPipeline->lightClusterGridTexture()) {
+                    const int gridBinding = shaderPipeline->bindingForTexture("qt_lightClusterGrid", int(QSSGRhiSamplerBindingHints::LightClusterGrid));
+                    const int lightsBinding = shaderPipeline->bindingForTexture("qt_lightClusterLights", int(QSSGRhiSamplerBindingHints::LightClusterLights));
+                    if (gridBinding >= 0 && lightsBinding >= 0) {
+                        QRhiSampler *sampler = rhiCtx->sampler({ QRhiSampler::Nearest, QRhiSampler::Nearest, QRhiSampler::None,
+                                                                 QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge, QRhiSampler::Repeat });
+                        bindings.addTexture(gridBinding,
+                                            QRhiShaderResourceBinding::FragmentStage,
+                                            shaderPipeline->lightClusterGridTexture(), sampler);
+                        bindings.addTexture(lightsBinding,
+                                            QRhiShaderResourceBinding::FragmentStage,
+                                            shaderPipeline->lightClusterLightsTexture(), sampler);
+                    } // else ignore, not an error
+                }
             }
 
             // Depth and SSAO textures
@@ -1239,7 +1260,7 @@ void RenderHelpers::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
         if (!ps || !srb)
             return;
 
-        QRhiBuffer *vertexBuffer = subsetRenderable.subset.rhi.vertexBuffer->buffer();
+        QRhiBuffer *vertexBuffer = subsetRenderable.vertexBuffer();
         QRhiBuffer *indexBuffer = subsetRenderable.subset.rhi.indexBuffer ? subsetRenderable.subset.rhi.indexBuffer->buffer() : nullptr;
 
         QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
@@ -1274,11 +1295,15 @@ void RenderHelpers::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
             cb->setStencilRef(state.stencilRef);
         if (indexBuffer) {
             cb->setVertexInput(0, vertexBufferCount, vertexBuffers, indexBuffer, 0, subsetRenderable.subset.rhi.indexBuffer->indexFormat());
-            cb->drawIndexed(subsetRenderable.subset.lodCount(subsetRenderable.subsetLevelOfDetail), instances, subsetRenderable.subset.lodOffset(subsetRenderable.subsetLevelOfDetail));
+            QSSGRHICTX_STAT(rhiCtx, bindVertexInput(vertexBuffer, indexBuffer));
+            cb->drawIndexed(subsetRenderable.subset.lodCount(subsetRenderable.subsetLevelOfDetail), instances,
+                            subsetRenderable.subset.rhi.baseIndex + subsetRenderable.subset.lodOffset(subsetRenderable.subsetLevelOfDetail),
+                            qint32(subsetRenderable.baseVertex()));
             QSSGRHICTX_STAT(rhiCtx, drawIndexed(subsetRenderable.subset.lodCount(subsetRenderable.subsetLevelOfDetail), instances));
         } else {
             cb->setVertexInput(0, vertexBufferCount, vertexBuffers);
-            cb->draw(subsetRenderable.subset.count, instances, subsetRenderable.subset.offset);
+            QSSGRHICTX_STAT(rhiCtx, bindVertexInput(vertexBuffer, nullptr));
+            cb->draw(subsetRenderable.subset.count, instances, subsetRenderable.baseVertex() + subsetRenderable.subset.offset);
             QSSGRHICTX_STAT(rhiCtx, draw(subsetRenderable.subset.count, instances));
         }
         Q_QUICK3D_PROFILE_END_WITH_IDS(QQuick3DProfiler::Quick3DRenderCall, (subsetRenderable.subset.count | quint64(instances) << 32),
@@ -1302,6 +1327,125 @@ void RenderHelpers::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
     }
 }
 
+// Objects outside of the clip volume of a shadow or reflection probe camera
+// do not contribute to its map, so all six planes (including the near plane)
+// are used.
+static QSSGClippingFrustum clipVolumeFrustum(const QMatrix4x4 &viewProjection)
+{
+    const float *m = viewProjection.constData();
+    QSSGClipPlane nearPlane;
+    nearPlane.normal = QVector3D(m[3] + m[2], m[7] + m[6], m[11] + m[10]);
+    const float length = nearPlane.normal.length();
+    nearPlane.d = (m[15] + m[14]) / (length > 0.0f ? length : 1.0f);
+    nearPlane.normal.normalize();
+    // the near plane's bbox edges are calculated in the clipping frustum's
+    // constructor.
+    return QSSGClippingFrustum(viewProjection, nearPlane);
+}
+
+static inline size_t hashMatrix(const QMatrix4x4 &m, size_t seed)
+{
+    return qHashBits(m.constData(), 16 * sizeof(float), seed);
+}
+
+// The identity of a texture and of the data it is made from. False when the
+// content may change without either, like that of a texture provider item.
+static bool hashImage(const QSSGRenderImage &image, QRhiTexture *texture, size_t *h)
+{
+    if (image.m_qsgTexture)
+        return false;
+    *h = qHashMulti(*h, &image, texture, image.m_imagePath);
+    // Sub-rectangle updates do not change the version
+    if (image.m_rawTextureData)
+        *h = qHashMulti(*h, image.m_rawTextureData, image.m_rawTextureData->version(), image.m_rawTextureData->updateVersion());
+    *h = hashMatrix(image.m_textureTransform, *h);
+    return true;
+}
+
+// Alpha tested and blended casters leave holes in the maps where their
+// textures are transparent, so those textures are part of the key. Custom
+// materials may discard based on any of their textures.
+static bool hashAlphaTextures(const QSSGSubsetRenderable &renderable, size_t *h)
+{
+    const QSSGRenderGraphObject &material = renderable.getMaterial();
+    if (material.type == QSSGRenderGraphObject::Type::CustomMaterial) {
+        const auto &customMaterial = static_cast<const QSSGRenderCustomMaterial &>(material);
+        for (const auto &property : customMaterial.m_textureProperties) {
+            if (property.texImage && !hashImage(*property.texImage, nullptr, h))
+                return false;
+        }
+        return true;
+    }
+
+    if (static_cast<const QSSGRenderDefaultMaterial &>(material).alphaMode == QSSGRenderDefaultMaterial::Opaque)
+        return true;
+    for (const QSSGRenderableImage *image = renderable.firstImage; image; image = image->m_nextImage) {
+        if (image->m_mapType != QSSGRenderableImage::Type::Diffuse
+                && image->m_mapType != QSSGRenderableImage::Type::BaseColor
+                && image->m_mapType != QSSGRenderableImage::Type::Opacity) {
+            continue;
+        }
+        if (!hashImage(image->m_imageNode, image->m_texture.m_texture, h))
+            return false;
+    }
+    return true;
+}
+
+// Returns a key that changes whenever something about the objects changes
+// that affects what they render into a shadow or reflection map, or 0 when
+// they have to be rendered regardless (animated skinning, particles, dirty
+// materials, textures that can change by themselves).
+static size_t renderableContentKey(const QSSGRenderableObjectList &objects)
+{
+    // The list is sorted by the distance to the camera, so the per-object
+    // hashes are combined in an order independent way.
+    size_t key = qHash(objects.size());
+    for (const auto &handle : objects) {
+        const QSSGRenderableObject *theObject = handle.obj;
+        if (theObject->type != QSSGRenderableObject::Type::DefaultMaterialMeshSubset
+                && theObject->type != QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
+            continue;
+        }
+
+        const QSSGSubsetRenderable &renderable(static_cast<const QSSGSubsetRenderable &>(*theObject));
+        const QSSGRenderModel &model = renderable.modelContext.model;
+        if (model.usesBoneTexture() || model.particleBuffer)
+            return 0;
+
+        const QSSGRenderGraphObject &material = renderable.getMaterial();
+        const bool materialDirty = (material.type == QSSGRenderGraphObject::Type::CustomMaterial)
+                ? static_cast<const QSSGRenderCustomMaterial &>(material).isDirty()
+                : static_cast<const QSSGRenderDefaultMaterial &>(material).isDirty();
+        if (materialDirty)
+            return 0;
+
+        const QSSGRhiBuffer *vertexBuffer = renderable.subset.rhi.vertexBuffer.get();
+        size_t h = qHashMulti(0,
+                              &model,
+                              &material,
+                              vertexBuffer,
+                              vertexBuffer ? vertexBuffer->buffer() : nullptr,
+                              renderable.skinnedVertexBuffer,
+                              renderable.subset.rhi.baseVertex,
+                              renderable.subset.offset,
+                              renderable.subset.count,
+                              int(renderable.depthWriteMode));
+        h = hashMatrix(renderable.globalTransform, h);
+        if (model.instanceTable)
+            h = qHashMulti(h, model.instanceTable, model.instanceTable->serial());
+        // Partial updates of custom geometry change the data in place
+        if (model.geometry)
+            h = qHashMulti(h, model.geometry->generationId(), model.geometry->dataGenerationId());
+        if (!model.morphWeights.isEmpty())
+            h = qHashRange(model.morphWeights.cbegin(), model.morphWeights.cend(), h);
+        if (!hashAlphaTextures(renderable, &h))
+            return 0;
+        key += h;
+    }
+    // 0 is reserved for "needs rendering"
+    return key ? key : 1;
+}
+
 void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
                                        QSSGPassKey passKey,
                                        QSSGRhiGraphicsPipelineState &ps,
@@ -1329,7 +1473,7 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
             if (theObject->type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset || theObject->type == QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
                 QSSGSubsetRenderable *renderable(static_cast<QSSGSubsetRenderable *>(theObject));
 
-                QRhiBuffer *vertexBuffer = renderable->subset.rhi.vertexBuffer->buffer();
+                QRhiBuffer *vertexBuffer = renderable->vertexBuffer();
                 QRhiBuffer *indexBuffer = renderable->subset.rhi.indexBuffer
                         ? renderable->subset.rhi.indexBuffer->buffer()
                         : nullptr;
@@ -1361,11 +1505,14 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
                 }
                 if (indexBuffer) {
                     cb->setVertexInput(0, vertexBufferCount, vertexBuffers, indexBuffer, 0, renderable->subset.rhi.indexBuffer->indexFormat());
-                    cb->drawIndexed(renderable->subset.count, instances, renderable->subset.offset);
+                    QSSGRHICTX_STAT(rhiCtx, bindVertexInput(vertexBuffer, indexBuffer));
+                    cb->drawIndexed(renderable->subset.count, instances, renderable->subset.rhi.baseIndex + renderable->subset.offset,
+                                    qint32(renderable->baseVertex()));
                     QSSGRHICTX_STAT(rhiCtx, drawIndexed(renderable->subset.count, instances));
                 } else {
                     cb->setVertexInput(0, vertexBufferCount, vertexBuffers);
-                    cb->draw(renderable->subset.count, instances, renderable->subset.offset);
+                    QSSGRHICTX_STAT(rhiCtx, bindVertexInput(vertexBuffer, nullptr));
+                    cb->draw(renderable->subset.count, instances, renderable->baseVertex() + renderable->subset.offset);
                     QSSGRHICTX_STAT(rhiCtx, draw(renderable->subset.count, instances));
                 }
                 Q_QUICK3D_PROFILE_END_WITH_IDS(QQuick3DProfiler::Quick3DRenderCall, (renderable->subset.count | quint64(instances) << 32),
@@ -1404,6 +1551,25 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
     if (drawShadowReceivingBounds)
         ShadowmapHelpers::addDebugBox(receivingObjectsBox.toQSSGBoxPointsNoEmptyCheck(), QColorConstants::Green, debugDrawSystem);
 
+    const bool cachingEnabled = shadowMapManager.isCachingEnabled();
+    // Combines the state of the casters with the state of a shadow camera.
+    // The result is 0 (never matching) when the casters can not be cached.
+    const auto shadowMapContentKey = [cachingEnabled](const QSSGRenderableObjectList &casters, const QSSGRenderLight *light, const QMatrix4x4 &viewProjection, float shadowMapFar) -> size_t {
+        const size_t casterContentKey = cachingEnabled ? renderableContentKey(casters) : 0;
+        if (!casterContentKey)
+            return 0;
+        const size_t key = hashMatrix(viewProjection, qHashMulti(casterContentKey, light, shadowMapFar));
+        return key ? key : 1;
+    };
+
+    // The casters are not culled against the camera, only objects within a
+    // shadow camera's frustum need to be drawn into its map.
+    QSSGRenderableObjectList culledCasters;
+    const auto cullCasters = [&culledCasters, &sortedOpaqueObjects](const QMatrix4x4 &viewProjection) {
+        culledCasters.clear();
+        QSSGLayerRenderData::frustumCulling(clipVolumeFrustum(viewProjection), sortedOpaqueObjects, culledCasters);
+    };
+
     // Create shadow map for each light in the scene
     for (int i = 0, ie = globalLights.size(); i != ie; ++i) {
         if (!globalLights[i].shadows || globalLights[i].light->m_fullyBaked)
@@ -1484,17 +1650,27 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
                 pEntry->m_csmActive[cascadeIndex] = 1.f;
                 cascadeCamera->calculateViewProjectionMatrix(pEntry->m_lightViewProjection[cascadeIndex]);
                 pEntry->m_lightView = cascadeCamera->globalTransform.inverted(); // pre-calculate this for the material
-                const bool isOrtho = cascadeCamera->type == QSSGRenderGraphObject::Type::OrthographicCamera;
-                rhiPrepareResourcesForShadowMap(rhiCtx, layerData, passKey, pEntry, &ps, &depthAdjust, sortedOpaqueObjects, *cascadeCamera, isOrtho, QSSGRenderTextureCubeFaceNone, cascadeIndex);
-                // Render into the 2D texture pEntry->m_rhiDepthMap, using
-                // pEntry->m_rhiDepthStencil as the (throwaway) depth/stencil buffer.
-                QRhiTextureRenderTarget *rt = pEntry->m_rhiRenderTargets[cascadeIndex];
-                cb->beginPass(rt, Qt::white, { 1.0f, 0 }, nullptr, rhiCtx->commonPassFlags());
-                Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
-                QSSGRHICTX_STAT(rhiCtx, beginRenderPass(rt));
-                rhiRenderOneShadowMap(rhiCtx, &ps, sortedOpaqueObjects, 0);
-                cb->endPass();
-                QSSGRHICTX_STAT(rhiCtx, endRenderPass());
+
+                cullCasters(pEntry->m_lightViewProjection[cascadeIndex]);
+
+                // Nothing to do if the cascade still holds what it would render now
+                const size_t contentKey = shadowMapContentKey(culledCasters, light, pEntry->m_lightViewProjection[cascadeIndex], pEntry->m_shadowMapFar);
+                const bool needsRender = !contentKey || contentKey != pEntry->m_renderedContentKey[cascadeIndex];
+                pEntry->m_renderedContentKey[cascadeIndex] = contentKey;
+
+                if (needsRender) {
+                    const bool isOrtho = cascadeCamera->type == QSSGRenderGraphObject::Type::OrthographicCamera;
+                    rhiPrepareResourcesForShadowMap(rhiCtx, layerData, passKey, pEntry, &ps, &depthAdjust, culledCasters, *cascadeCamera, isOrtho, QSSGRenderTextureCubeFaceNone, cascadeIndex);
+                    // Render into the 2D texture pEntry->m_rhiDepthMap, using
+                    // pEntry->m_rhiDepthStencil as the (throwaway) depth/stencil buffer.
+                    QRhiTextureRenderTarget *rt = pEntry->m_rhiRenderTargets[cascadeIndex];
+                    cb->beginPass(rt, Qt::white, { 1.0f, 0 }, nullptr, rhiCtx->commonPassFlags());
+                    Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
+                    QSSGRHICTX_STAT(rhiCtx, beginRenderPass(rt));
+                    rhiRenderOneShadowMap(rhiCtx, &ps, culledCasters, 0);
+                    cb->endPass();
+                    QSSGRHICTX_STAT(rhiCtx, endRenderPass());
+                }
 
                 if (drawDirectionalLightShadowBoxes)
                     ShadowmapHelpers::addDirectionalLightDebugBox(computeFrustumBounds(*cascadeCamera), debugDrawSystem);
@@ -1518,8 +1694,18 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
 
             const bool swapYFaces = !rhi->isYUpInFramebuffer();
             for (const auto face : QSSGRenderTextureCubeFaces) {
-                theCameras[quint8(face)].calculateViewProjectionMatrix(pEntry->m_lightViewProjection[0]);
-                pEntry->m_lightCubeView[quint8(face)] = theCameras[quint8(face)].globalTransform.inverted(); // pre-calculate this for the material
+                const quint8 faceIndex = quint8(face);
+                theCameras[faceIndex].calculateViewProjectionMatrix(pEntry->m_lightViewProjection[0]);
+                pEntry->m_lightCubeView[faceIndex] = theCameras[faceIndex].globalTransform.inverted(); // pre-calculate this for the material
+
+                cullCasters(pEntry->m_lightViewProjection[0]);
+
+                // Nothing to do if the face still holds what it would render now
+                const size_t contentKey = shadowMapContentKey(culledCasters, light, pEntry->m_lightViewProjection[0], shadowMapFar);
+                const bool needsRender = !contentKey || contentKey != pEntry->m_renderedContentKey[faceIndex];
+                pEntry->m_renderedContentKey[faceIndex] = contentKey;
+                if (!needsRender)
+                    continue;
 
                 rhiPrepareResourcesForShadowMap(rhiCtx,
                                                 layerData,
@@ -1527,14 +1713,12 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
                                                 pEntry,
                                                 &ps,
                                                 &depthAdjust,
-                                                sortedOpaqueObjects,
-                                                theCameras[quint8(face)],
+                                                culledCasters,
+                                                theCameras[faceIndex],
                                                 false,
                                                 face,
                                                 0);
-            }
 
-            for (const auto face : QSSGRenderTextureCubeFaces) {
                 // Render into one face of the cubemap texture pEntry->m_rhiDephCube, using
                 // pEntry->m_rhiDepthStencil as the (throwaway) depth/stencil buffer.
 
@@ -1565,7 +1749,7 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
                 cb->beginPass(rt, Qt::white, { 1.0f, 0 }, nullptr, rhiCtx->commonPassFlags());
                 QSSGRHICTX_STAT(rhiCtx, beginRenderPass(rt));
                 Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
-                rhiRenderOneShadowMap(rhiCtx, &ps, sortedOpaqueObjects, quint8(face));
+                rhiRenderOneShadowMap(rhiCtx, &ps, culledCasters, faceIndex);
                 cb->endPass();
                 QSSGRHICTX_STAT(rhiCtx, endRenderPass());
                 Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DRenderPass, 0, QSSG_RENDERPASS_NAME("shadow_cube", 0, outFace));
@@ -1574,6 +1758,26 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
     }
 }
 
+// Returns a key for what a probe's cube map shows, or 0 when it has to be
+// rendered regardless.
+static size_t reflectionProbeContentKey(const QSSGRenderReflectionProbe &probe,
+                                        const std::array<QSSGRenderableObjectList, 6> &faceObjects)
+{
+    size_t key = hashMatrix(probe.globalTransform, qHashMulti(0, probe.clearColor.rgba(), probe.reflectionMapRes));
+    for (const QSSGRenderableObjectList &objects : faceObjects) {
+        for (const auto &handle : objects) {
+            if (handle.obj->type == QSSGRenderableObject::Type::Particles)
+                return 0;
+        }
+        const size_t objectsKey = renderableContentKey(objects);
+        if (!objectsKey)
+            return 0;
+        key = qHashMulti(key, objectsKey);
+    }
+    // 0 is reserved for "needs rendering"
+    return key ? key : 1;
+}
+
 void RenderHelpers::rhiRenderReflectionMap(QSSGRhiContext *rhiCtx,
                                            QSSGPassKey passKey,
                                            const QSSGLayerRenderData &inData,
@@ -1590,20 +1794,81 @@ void RenderHelpers::rhiRenderReflectionMap(QSSGRhiContext *rhiCtx,
                                inData.layer.background == QSSGRenderLayer::Background::SkyBoxCubeMap)
             && rhiCtx->rhi()->isFeatureSupported(QRhi::TexelFetch);
 
-    for (int i = 0, ie = reflectionProbes.size(); i != ie; ++i) {
+    QMatrix4x4 cameraViewProjection;
+    QVector3D cameraPosition;
+    if (const QSSGRenderCamera *camera = inData.activeCamera()) {
+        camera->calculateViewProjectionMatrix(cameraViewProjection);
+        cameraPosition = camera->getGlobalPos();
+    }
+
+    // Each face only prepares and draws the objects within its frustum. The
+    // culled lists also tell what changed for a probe since its last update.
+    const auto probeCount = reflectionProbes.size();
+    QList<std::array<QSSGRenderableObjectList, 6>> faceObjects(probeCount);
+    QVarLengthArray<size_t, 16> contentKeys(probeCount);
+    QList<QSSGReflectionProbeScheduler::Candidate> candidates;
+    for (int i = 0; i != probeCount; ++i) {
         QSSGReflectionMapEntry *pEntry = reflectionMapManager.reflectionMapEntry(i);
-        if (!pEntry)
+        if (!pEntry || reflectionProbes[i]->texture || pEntry->m_baked)
             continue;
 
-        if (!pEntry->m_needsRender)
-            continue;
+        ++pEntry->m_framesSinceUpdate;
 
-        if (reflectionProbes[i]->refreshMode == QSSGRenderReflectionProbe::ReflectionRefreshMode::FirstFrame && pEntry->m_rendered)
+        if (!pEntry->m_needsRender
+                || (reflectionProbes[i]->refreshMode == QSSGRenderReflectionProbe::ReflectionRefreshMode::FirstFrame && pEntry->m_rendered)) {
+            QSSGRHICTX_STAT(rhiCtx, reflectionProbeScheduled({ reflectionProbes[i]->debugObjectName.toLatin1(),
+                                                               pEntry->m_framesSinceUpdate, 0, 0.0f }));
             continue;
+        }
 
-        if (reflectionProbes[i]->texture)
+        QSSGRenderCamera theCameras[6] { QSSGRenderCamera{QSSGRenderCamera::Type::PerspectiveCamera},
+                                         QSSGRenderCamera{QSSGRenderCamera::Type::PerspectiveCamera},
+                                         QSSGRenderCamera{QSSGRenderCamera::Type::PerspectiveCamera},
+                                         QSSGRenderCamera{QSSGRenderCamera::Type::PerspectiveCamera},
+                                         QSSGRenderCamera{QSSGRenderCamera::Type::PerspectiveCamera},
+                                         QSSGRenderCamera{QSSGRenderCamera::Type::PerspectiveCamera} };
+        setupCubeReflectionCameras(reflectionProbes[i], theCameras);
+        for (int face = 0; face < 6; ++face) {
+            QMatrix4x4 viewProjection;
+            theCameras[face].calculateViewProjectionMatrix(viewProjection);
+            QSSGLayerRenderData::frustumCulling(clipVolumeFrustum(viewProjection), reflectionPassObjects, faceObjects[i][face]);
+        }
+
+        const QVector3D probeExtent = reflectionProbes[i]->boxSize / 2;
+        const QSSGBounds3 probeBox = QSSGBounds3::centerExtents(reflectionProbes[i]->getGlobalPos() + reflectionProbes[i]->boxOffset, probeExtent);
+        QSSGReflectionProbeScheduler::Candidate candidate;
+        candidate.probeIndex = i;
+        candidate.faceCount = pEntry->m_timeSlicing == QSSGRenderReflectionProbe::ReflectionTimeSlicing::IndividualFaces ? 1 : 6;
+        candidate.distance = qMax(0.0f, cameraPosition.distanceToPoint(probeBox.center()) - probeExtent.length());
+        candidate.screenCoverage = QSSGReflectionProbeScheduler::screenCoverage(probeBox, cameraViewProjection);
+        candidate.age = pEntry->m_framesSinceUpdate;
+        contentKeys[i] = reflectionProbeContentKey(*reflectionProbes[i], faceObjects[i]);
+        candidate.contentChanged = !contentKeys[i] || contentKeys[i] != pEntry->m_contentKey;
+        candidate.forced = reflectionProbes[i]->hasScheduledUpdate || !pEntry->m_contentKey;
+        candidates.append(candidate);
+    }
+
+    QSSGReflectionProbeScheduler &scheduler = reflectionMapManager.scheduler();
+    const bool bakeRequested = QSSGReflectionProbeBaker::bakeRequested();
+    // Everything is baked in the first frame, regardless of the budget
+    const qsizetype scheduledCount = bakeRequested ? candidates.size() : scheduler.schedule(candidates);
+
+    QElapsedTimer timer;
+    for (qsizetype c = 0, ce = candidates.size(); c != ce; ++c) {
+        const QSSGReflectionProbeScheduler::Candidate &candidate = candidates.at(c);
+        const int i = candidate.probeIndex;
+        QSSGReflectionMapEntry *pEntry = reflectionMapManager.reflectionMapEntry(i);
+
+        const bool scheduled = c < scheduledCount;
+        QSSGRHICTX_STAT(rhiCtx, reflectionProbeScheduled({ reflectionProbes[i]->debugObjectName.toLatin1(),
+                                                           scheduled ? 0 : candidate.age,
+                                                           scheduled ? candidate.faceCount : 0,
+                                                           candidate.priority }));
+        if (!scheduled)
             continue;
 
+        timer.start();
+
         Q_ASSERT(pEntry->m_rhiDepthStencil);
         Q_ASSERT(pEntry->m_rhiCube);
 
@@ -1618,16 +1883,19 @@ void RenderHelpers::rhiRenderReflectionMap(QSSGRhiContext *rhiCtx,
                                          QSSGRenderCamera{QSSGRenderCamera::Type::PerspectiveCamera} };
         setupCubeReflectionCameras(reflectionProbes[i], theCameras);
         const bool swapYFaces = !rhi->isYUpInFramebuffer();
+        const bool individualFaces = pEntry->m_timeSlicing == QSSGRenderReflectionProbe::ReflectionTimeSlicing::IndividualFaces;
         for (const auto face : QSSGRenderTextureCubeFaces) {
+            if (individualFaces && face != pEntry->m_timeSliceFace)
+                continue;
             const auto cubeFaceIdx = QSSGBaseTypeHelpers::indexOfCubeFace(face);
             theCameras[cubeFaceIdx].calculateViewProjectionMatrix(pEntry->m_viewProjection);
 
             rhiPrepareResourcesForReflectionMap(rhiCtx, passKey, inData, pEntry, ps,
-                                                reflectionPassObjects, theCameras[cubeFaceIdx], renderer, face);
+                                                faceObjects[i][cubeFaceIdx], theCameras[cubeFaceIdx], renderer, face);
         }
         QRhiRenderPassDescriptor *renderPassDesc = nullptr;
         for (auto face : QSSGRenderTextureCubeFaces) {
-            if (pEntry->m_timeSlicing == QSSGRenderReflectionProbe::ReflectionTimeSlicing::IndividualFaces)
+            if (individualFaces)
                 face = pEntry->m_timeSliceFace;
 
             QSSGRenderTextureCubeFace outFace = face;
@@ -1660,7 +1928,7 @@ void RenderHelpers::rhiRenderReflectionMap(QSSGRhiContext *rhiCtx,
             }
 
             bool needsSetViewport = true;
-            for (const auto &handle : reflectionPassObjects)
+            for (const auto &handle : std::as_const(faceObjects[i][QSSGBaseTypeHelpers::indexOfCubeFace(face)]))
                 rhiRenderRenderable(rhiCtx, *ps, *handle.obj, &needsSetViewport, face);
 
             cb->endPass();
@@ -1675,6 +1943,9 @@ void RenderHelpers::rhiRenderReflectionMap(QSSGRhiContext *rhiCtx,
 
         pEntry->renderMips(rhiCtx);
 
+        if (bakeRequested && !pEntry->m_bakeKey.isEmpty())
+            reflectionMapManager.baker().bake(rhiCtx, *pEntry, pEntry->m_bakeKey);
+
         if (pEntry->m_timeSlicing == QSSGRenderReflectionProbe::ReflectionTimeSlicing::IndividualFaces)
             pEntry->m_timeSliceFace = QSSGBaseTypeHelpers::next(pEntry->m_timeSliceFace); // Wraps
 
@@ -1683,21 +1954,32 @@ void RenderHelpers::rhiRenderReflectionMap(QSSGRhiContext *rhiCtx,
 
         reflectionProbes[i]->hasScheduledUpdate = false;
         pEntry->m_needsRender = false;
+        pEntry->m_framesSinceUpdate = 0;
+        pEntry->m_contentKey = contentKeys[i] ? contentKeys[i] : 1;
+
+        scheduler.recordFaceTime(float(timer.nsecsElapsed()) / 1000000.0f, candidate.faceCount);
     }
+
+    if (bakeRequested)
+        reflectionMapManager.baker().finishFrame();
 }
 
-bool RenderHelpers::rhiPrepareAoTexture(QSSGRhiContext *rhiCtx, const QSize &size, QSSGRhiRenderableTexture *renderableTex)
+bool RenderHelpers::rhiPrepareAoTexture(QSSGRhiContext *rhiCtx, const QSize &size, QSSGRhiRenderableTexture *renderableTex,
+                                        QRhiTexture::Format format)
 {
     QRhi *rhi = rhiCtx->rhi();
     bool needsBuild = false;
 
+    if (renderableTex->texture && renderableTex->texture->format() != format)
+        renderableTex->reset();
+
     if (!renderableTex->texture) {
         QRhiTexture::Flags flags = QRhiTexture::RenderTarget;
         // the ambient occlusion texture is always non-msaa, even if multisampling is used in the main pass
         if (rhiCtx->mainPassViewCount() <= 1)
-            renderableTex->texture = rhi->newTexture(QRhiTexture::RGBA8, size, 1, flags);
+            renderableTex->texture = rhi->newTexture(format, size, 1, flags);
         else
-            renderableTex->texture = rhi->newTextureArray(QRhiTexture::RGBA8, rhiCtx->mainPassViewCount(), size, 1, flags);
+            renderableTex->texture = rhi->newTextureArray(format, rhiCtx->mainPassViewCount(), size, 1, flags);
         needsBuild = true;
     } else if (renderableTex->texture->pixelSize() != size) {
         renderableTex->texture->setPixelSize(size);
@@ -1737,7 +2019,8 @@ void RenderHelpers::rhiRenderAoTexture(QSSGRhiContext *rhiCtx,
                                        const QSSGAmbientOcclusionSettings &ao,
                                        const QSSGRhiRenderableTexture &rhiAoTexture,
                                        const QSSGRhiRenderableTexture &rhiDepthTexture,
-                                       const QSSGRenderCamera &camera)
+                                       const QSSGRenderCamera &camera,
+                                       float sampleRotation)
 {
     QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(rhiCtx);
 
@@ -1763,7 +2046,7 @@ void RenderHelpers::rhiRenderAoTexture(QSSGRhiContext *rhiCtx,
     const float invFocalLenX = tanHalfFovY * (rw / rh);
 
     const QVector4D aoProps(ao.aoStrength * 0.01f, ao.aoDistance * 0.4f, ao.aoSoftness * 0.02f, ao.aoBias);
-    const QVector4D aoProps2(float(ao.aoSamplerate), (ao.aoDither) ? 1.0f : 0.0f, 0.0f, 0.0f);
+    const QVector4D aoProps2(float(ao.aoSamplerate), (ao.aoDither) ? 1.0f : 0.0f, sampleRotation, 0.0f);
     const QVector4D aoScreenConst(1.0f / R2, rh / (2.0f * tanHalfFovY), 1.0f / rw, 1.0f / rh);
     const QVector4D uvToEyeConst(2.0f * invFocalLenX, -2.0f * tanHalfFovY, -invFocalLenX, tanHalfFovY);
     const QVector2D cameraProps(camera.clipNear, camera.clipFar);
@@ -1803,6 +2086,164 @@ void RenderHelpers::rhiRenderAoTexture(QSSGRhiContext *rhiCtx,
     renderer.rhiQuadRenderer()->recordRenderQuadPass(rhiCtx, &ps, srb, rhiAoTexture.rt, {});
 }
 
+static QRhiViewport aoTextureViewport(const QSSGRhiRenderableTexture &renderableTex)
+{
+    const QSize size = renderableTex.texture->pixelSize();
+    return QRhiViewport(0, 0, float(size.width()), float(size.height()));
+}
+
+void RenderHelpers::rhiDownsampleAoDepthTexture(QSSGRhiContext *rhiCtx,
+                                                QSSGPassKey passKey,
+                                                QSSGRenderer &renderer,
+                                                QSSGRhiShaderPipeline &shaderPipeline,
+                                                QSSGRhiGraphicsPipelineState &ps,
+                                                int resolutionDivisor,
+                                                const QSSGRhiRenderableTexture &rhiDepthTexture,
+                                                const QSSGRhiRenderableTexture &rhiReducedDepthTexture)
+{
+    QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(rhiCtx);
+
+    QSSGRhiGraphicsPipelineStatePrivate::setShaderPipeline(ps, &shaderPipeline);
+    ps.viewport = aoTextureViewport(rhiReducedDepthTexture);
+
+    //    layout(std140, binding = 0) uniform buf {
+    //        vec4 downsampleProperties;
+
+    const QSize depthSize = rhiDepthTexture.texture->pixelSize();
+    const QVector4D downsampleProps(float(resolutionDivisor), float(depthSize.width() - 1), float(depthSize.height() - 1), 0.0f);
+
+    QSSGRhiDrawCallData &dcd(rhiCtxD->drawCallData({ passKey, nullptr, nullptr, 1 }));
+    if (!dcd.ubuf) {
+        dcd.ubuf = rhiCtx->rhi()->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, 16);
+        dcd.ubuf->create();
+    }
+
+    char *ubufData = dcd.ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
+    memcpy(ubufData, &downsampleProps, 16);
+    dcd.ubuf->endFullDynamicBufferUpdateForCurrentFrame();
+
+    QRhiSampler *sampler = rhiCtx->sampler({ QRhiSampler::Nearest, QRhiSampler::Nearest, QRhiSampler::None,
+                                             QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge, QRhiSampler::Repeat });
+    QSSGRhiShaderResourceBindingList bindings;
+    bindings.addUniformBuffer(0, QRhiShaderResourceBinding::FragmentStage, dcd.ubuf);
+    bindings.addTexture(1, QRhiShaderResourceBinding::FragmentStage, rhiDepthTexture.texture, sampler);
+    QRhiShaderResourceBindings *srb = rhiCtxD->srb(bindings);
+
+    renderer.rhiQuadRenderer()->prepareQuad(rhiCtx, nullptr);
+    renderer.rhiQuadRenderer()->recordRenderQuadPass(rhiCtx, &ps, srb, rhiReducedDepthTexture.rt, {});
+}
+
+void RenderHelpers::rhiAccumulateAoTexture(QSSGRhiContext *rhiCtx,
+                                           QSSGPassKey passKey,
+                                           QSSGRenderer &renderer,
+                                           QSSGRhiShaderPipeline &shaderPipeline,
+                                           QSSGRhiGraphicsPipelineState &ps,
+                                           const QMatrix4x4 &reprojection,
+                                           bool historyValid,
+                                           float currentFrameWeight,
+                                           const QSSGRhiRenderableTexture &rhiAoTexture,
+                                           const QSSGRhiRenderableTexture &rhiDepthTexture,
+                                           const QSSGRhiRenderableTexture &rhiHistoryTexture,
+                                           const QSSGRhiRenderableTexture &rhiAccumulatedAoTexture)
+{
+    QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(rhiCtx);
+    QRhi *rhi = rhiCtx->rhi();
+
+    QSSGRhiGraphicsPipelineStatePrivate::setShaderPipeline(ps, &shaderPipeline);
+    ps.viewport = aoTextureViewport(rhiAccumulatedAoTexture);
+
+    //    layout(std140, binding = 0) uniform buf {
+    //        mat4 reprojection;
+    //        vec4 temporalProperties;
+    //        vec4 textureSizeProperties;
+
+    const QSize size = rhiAoTexture.texture->pixelSize();
+    const bool flipY = rhi->isYUpInNDC() != rhi->isYUpInFramebuffer();
+    const QVector4D temporalProps(currentFrameWeight,
+                                  historyValid ? 1.0f : 0.0f,
+                                  flipY ? 1.0f : 0.0f,
+                                  rhi->isClipDepthZeroToOne() ? 1.0f : 0.0f);
+    const QVector4D textureSizeProps(1.0f / float(size.width()), 1.0f / float(size.height()),
+                                     float(size.width() - 1), float(size.height() - 1));
+
+    const int UBUF_SIZE = 96;
+    QSSGRhiDrawCallData &dcd(rhiCtxD->drawCallData({ passKey, nullptr, nullptr, 2 }));
+    if (!dcd.ubuf) {
+        dcd.ubuf = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, UBUF_SIZE);
+        dcd.ubuf->create();
+    }
+
+    char *ubufData = dcd.ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
+    memcpy(ubufData, reprojection.constData(), 64);
+    memcpy(ubufData + 64, &temporalProps, 16);
+    memcpy(ubufData + 80, &textureSizeProps, 16);
+    dcd.ubuf->endFullDynamicBufferUpdateForCurrentFrame();
+
+    QRhiSampler *nearestSampler = rhiCtx->sampler({ QRhiSampler::Nearest, QRhiSampler::Nearest, QRhiSampler::None,
+                                                    QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge, QRhiSampler::Repeat });
+    QRhiSampler *linearSampler = rhiCtx->sampler({ QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
+                                                   QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge, QRhiSampler::Repeat });
+    QSSGRhiShaderResourceBindingList bindings;
+    bindings.addUniformBuffer(0, QRhiShaderResourceBinding::FragmentStage, dcd.ubuf);
+    bindings.addTexture(1, QRhiShaderResourceBinding::FragmentStage, rhiAoTexture.texture, nearestSampler);
+    bindings.addTexture(2, QRhiShaderResourceBinding::FragmentStage, rhiDepthTexture.texture, nearestSampler);
+    bindings.addTexture(3, QRhiShaderResourceBinding::FragmentStage, rhiHistoryTexture.texture, linearSampler);
+    QRhiShaderResourceBindings *srb = rhiCtxD->srb(bindings);
+
+    renderer.rhiQuadRenderer()->prepareQuad(rhiCtx, nullptr);
+    renderer.rhiQuadRenderer()->recordRenderQuadPass(rhiCtx, &ps, srb, rhiAccumulatedAoTexture.rt, {});
+}
+
+void RenderHelpers::rhiUpsampleAoTexture(QSSGRhiContext *rhiCtx,
+                                         QSSGPassKey passKey,
+                                         QSSGRenderer &renderer,
+                                         QSSGRhiShaderPipeline &shaderPipeline,
+                                         QSSGRhiGraphicsPipelineState &ps,
+                                         int resolutionDivisor,
+                                         const QSSGRhiRenderableTexture &rhiReducedAoTexture,
+                                         const QSSGRhiRenderableTexture &rhiReducedDepthTexture,
+                                         const QSSGRhiRenderableTexture &rhiDepthTexture,
+                                         const QSSGRhiRenderableTexture &rhiAoTexture,
+                                         const QSSGRenderCamera &camera)
+{
+    QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(rhiCtx);
+
+    QSSGRhiGraphicsPipelineStatePrivate::setShaderPipeline(ps, &shaderPipeline);
+    ps.viewport = aoTextureViewport(rhiAoTexture);
+
+    //    layout(std140, binding = 0) uniform buf {
+    //        vec4 upsampleProperties;
+    //        vec2 cameraProperties;
+
+    const QSize reducedSize = rhiReducedAoTexture.texture->pixelSize();
+    const QVector4D upsampleProps(float(resolutionDivisor), float(reducedSize.width() - 1), float(reducedSize.height() - 1), 0.0f);
+    const QVector2D cameraProps(camera.clipNear, camera.clipFar);
+
+    const int UBUF_SIZE = 24;
+    QSSGRhiDrawCallData &dcd(rhiCtxD->drawCallData({ passKey, nullptr, nullptr, 3 }));
+    if (!dcd.ubuf) {
+        dcd.ubuf = rhiCtx->rhi()->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, UBUF_SIZE);
+        dcd.ubuf->create();
+    }
+
+    char *ubufData = dcd.ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
+    memcpy(ubufData, &upsampleProps, 16);
+    memcpy(ubufData + 16, &cameraProps, 8);
+    dcd.ubuf->endFullDynamicBufferUpdateForCurrentFrame();
+
+    QRhiSampler *sampler = rhiCtx->sampler({ QRhiSampler::Nearest, QRhiSampler::Nearest, QRhiSampler::None,
+                                             QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge, QRhiSampler::Repeat });
+    QSSGRhiShaderResourceBindingList bindings;
+    bindings.addUniformBuffer(0, QRhiShaderResourceBinding::FragmentStage, dcd.ubuf);
+    bindings.addTexture(1, QRhiShaderResourceBinding::FragmentStage, rhiReducedAoTexture.texture, sampler);
+    bindings.addTexture(2, QRhiShaderResourceBinding::FragmentStage, rhiReducedDepthTexture.texture, sampler);
+    bindings.addTexture(3, QRhiShaderResourceBinding::FragmentStage, rhiDepthTexture.texture, sampler);
+    QRhiShaderResourceBindings *srb = rhiCtxD->srb(bindings);
+
+    renderer.rhiQuadRenderer()->prepareQuad(rhiCtx, nullptr);
+    renderer.rhiQuadRenderer()->recordRenderQuadPass(rhiCtx, &ps, srb, rhiAoTexture.rt, {});
+}
+
 bool RenderHelpers::rhiPrepareScreenTexture(QSSGRhiContext *rhiCtx, const QSize &size, bool wantsMips, QSSGRhiRenderableTexture *renderableTex)
 {
     QRhi *rhi = rhiCtx->rhi();
@@ -2112,7 +2553,7 @@ bool RenderHelpers::rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
             if (shaderPipeline) {
                 shaderPipeline->ensureCombinedUniformBuffer(&dcd->ubuf);
                 char *ubufData = dcd->ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
-                updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, inData.renderedCameras, nullptr, nullptr);
+                updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, featureSet, inData.renderedCameras, nullptr, nullptr);
                 dcd->ubuf->endFullDynamicBufferUpdateForCurrentFrame();
             } else {
                 return false;
@@ -2131,7 +2572,7 @@ bool RenderHelpers::rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
                 shaderPipeline->ensureCombinedUniformBuffer(&dcd->ubuf);
                 char *ubufData = dcd->ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
                 customMaterialSystem.updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, customMaterial, subsetRenderable,
-                                                                     inData.renderedCameras, nullptr, nullptr);
+                                                                     featureSet, inData.renderedCameras, nullptr, nullptr);
                 dcd->ubuf->endFullDynamicBufferUpdateForCurrentFrame();
             } else {
                 return false;
@@ -2253,7 +2694,7 @@ void RenderHelpers::rhiRenderDepthPass(QSSGRhiContext *rhiCtx,
                 QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
                 QSSGSubsetRenderable *subsetRenderable(static_cast<QSSGSubsetRenderable *>(obj));
 
-                QRhiBuffer *vertexBuffer = subsetRenderable->subset.rhi.vertexBuffer->buffer();
+                QRhiBuffer *vertexBuffer = subsetRenderable->vertexBuffer();
                 QRhiBuffer *indexBuffer = subsetRenderable->subset.rhi.indexBuffer
                         ? subsetRenderable->subset.rhi.indexBuffer->buffer()
                         : nullptr;
@@ -2287,11 +2728,14 @@ void RenderHelpers::rhiRenderDepthPass(QSSGRhiContext *rhiCtx,
 
                 if (indexBuffer) {
                     cb->setVertexInput(0, vertexBufferCount, vertexBuffers, indexBuffer, 0, subsetRenderable->subset.rhi.indexBuffer->indexFormat());
-                    cb->drawIndexed(subsetRenderable->subset.count, instances, subsetRenderable->subset.offset);
+                    QSSGRHICTX_STAT(rhiCtx, bindVertexInput(vertexBuffer, indexBuffer));
+                    cb->drawIndexed(subsetRenderable->subset.count, instances, subsetRenderable->subset.rhi.baseIndex + subsetRenderable->subset.offset,
+                                    qint32(subsetRenderable->baseVertex()));
                     QSSGRHICTX_STAT(rhiCtx, drawIndexed(subsetRenderable->subset.count, instances));
                 } else {
                     cb->setVertexInput(0, vertexBufferCount, vertexBuffers);
-                    cb->draw(subsetRenderable->subset.count, instances, subsetRenderable->subset.offset);
+                    QSSGRHICTX_STAT(rhiCtx, bindVertexInput(vertexBuffer, nullptr));
+                    cb->draw(subsetRenderable->subset.count, instances, subsetRenderable->baseVertex() + subsetRenderable->subset.offset);
                     QSSGRHICTX_STAT(rhiCtx, draw(subsetRenderable->subset.count, instances));
                 }
                 Q_QUICK3D_PROFILE_END_WITH_IDS(QQuick3DProfiler::Quick3DRenderCall, (subsetRenderable->subset.count | quint64(instances) << 32),
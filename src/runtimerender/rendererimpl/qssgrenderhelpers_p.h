@@ -72,7 +72,8 @@ void rhiRenderDepthPass(QSSGRhiContext *rhiCtx, const QSSGRhiGraphicsPipelineSta
                         const QSSGRenderableObjectList &sortedTransparentObjects,
                         bool *needsSetViewport);
 
-bool rhiPrepareAoTexture(QSSGRhiContext *rhiCtx, const QSize &size, QSSGRhiRenderableTexture *renderableTex);
+bool rhiPrepareAoTexture(QSSGRhiContext *rhiCtx, const QSize &size, QSSGRhiRenderableTexture *renderableTex,
+                         QRhiTexture::Format format = QRhiTexture::RGBA8);
 
 void rhiRenderAoTexture(QSSGRhiContext *rhiCtx,
                         QSSGPassKey passKey,
@@ -82,7 +83,45 @@ void rhiRenderAoTexture(QSSGRhiContext *rhiCtx,
                         const QSSGAmbientOcclusionSettings &ao,
                         const QSSGRhiRenderableTexture &rhiAoTexture,
                         const QSSGRhiRenderableTexture &rhiDepthTexture,
-                        const QSSGRenderCamera &camera);
+                        const QSSGRenderCamera &camera,
+                        float sampleRotation = 0.0f);
+
+// Ambient occlusion at a reduced resolution: the depth is downsampled, the
+// occlusion is rendered from the reduced depth, optionally accumulated over
+// frames, and upsampled into the full resolution AO texture again.
+void rhiDownsampleAoDepthTexture(QSSGRhiContext *rhiCtx,
+                                 QSSGPassKey passKey,
+                                 QSSGRenderer &renderer,
+                                 QSSGRhiShaderPipeline &shaderPipeline,
+                                 QSSGRhiGraphicsPipelineState &ps,
+                                 int resolutionDivisor,
+                                 const QSSGRhiRenderableTexture &rhiDepthTexture,
+                                 const QSSGRhiRenderableTexture &rhiReducedDepthTexture);
+
+void rhiAccumulateAoTexture(QSSGRhiContext *rhiCtx,
+                            QSSGPassKey passKey,
+                            QSSGRenderer &renderer,
+                            QSSGRhiShaderPipeline &shaderPipeline,
+                            QSSGRhiGraphicsPipelineState &ps,
+                            const QMatrix4x4 &reprojection,
+                            bool historyValid,
+                            float currentFrameWeight,
+                            const QSSGRhiRenderableTexture &rhiAoTexture,
+                            const QSSGRhiRenderableTexture &rhiDepthTexture,
+                            const QSSGRhiRenderableTexture &rhiHistoryTexture,
+                            const QSSGRhiRenderableTexture &rhiAccumulatedAoTexture);
+
+void rhiUpsampleAoTexture(QSSGRhiContext *rhiCtx,
+                          QSSGPassKey passKey,
+                          QSSGRenderer &renderer,
+                          QSSGRhiShaderPipeline &shaderPipeline,
+                          QSSGRhiGraphicsPipelineState &ps,
+                          int resolutionDivisor,
+                          const QSSGRhiRenderableTexture &rhiReducedAoTexture,
+                          const QSSGRhiRenderableTexture &rhiReducedDepthTexture,
+                          const QSSGRhiRenderableTexture &rhiDepthTexture,
+                          const QSSGRhiRenderableTexture &rhiAoTexture,
+                          const QSSGRenderCamera &camera);
 
 bool rhiPrepareScreenTexture(QSSGRhiContext *rhiCtx, const QSize &size, bool wantsMips, QSSGRhiRenderableTexture *renderableTex);
 
@@ -47,17 +47,10 @@ void ShadowMapPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data
     QSSG_ASSERT(!data.renderedCameras.isEmpty(), return);
     camera = data.renderedCameras[0];
 
-    const auto &renderedDepthWriteObjects = data.getSortedRenderedDepthWriteObjects(*camera);
-    const auto &renderedOpaqueDepthPrepassObjects = data.getSortedrenderedOpaqueDepthPrepassObjects(*camera);
-
     QSSG_ASSERT(shadowPassObjects.isEmpty(), shadowPassObjects.clear());
 
-    for (const auto &handles : { &renderedDepthWriteObjects, &renderedOpaqueDepthPrepassObjects }) {
-        for (const auto &handle : *handles) {
-            if (handle.obj->renderableFlags.castsShadows())
-                shadowPassObjects.push_back(handle);
-        }
-    }
+    // Not culled against the camera, each shadow map culls these against its own frustum.
+    shadowPassObjects = data.getShadowCasterObjects();
 
     globalLights = data.globalLights;
 
@@ -74,10 +67,11 @@ void ShadowMapPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data
 
         const auto &sortedOpaqueObjects = data.getSortedOpaqueRenderableObjects(*camera);
         const auto &sortedTransparentObjects = data.getSortedTransparentRenderableObjects(*camera);
-        const auto [casting, receiving] = calculateSortedObjectBounds(sortedOpaqueObjects,
-                                                                      sortedTransparentObjects);
-        castingObjectsBox = casting;
-        receivingObjectsBox = receiving;
+        receivingObjectsBox = calculateSortedObjectBounds(sortedOpaqueObjects, sortedTransparentObjects).second;
+        // Casters outside of the view still need to be covered by the shadow cameras
+        castingObjectsBox = {};
+        for (const auto &handle : std::as_const(shadowPassObjects))
+            castingObjectsBox.include(handle.obj->globalBounds);
 
         if (!debugCamera) {
             debugCamera = std::make_unique<QSSGRenderCamera>(QSSGRenderGraphObject::Type::OrthographicCamera);
@@ -311,6 +305,57 @@ void SSAOMapPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
 
     if (Q_UNLIKELY(!ready))
         rhiAoTexture = nullptr;
+
+    // Multiview always renders the occlusion at full resolution, as does
+    // anything without texelFetch, which gets a cleared AO texture anyway.
+    QRhi *rhi = rhiCtx->rhi();
+    const bool hasRgba16fTarget = rhi->isTextureFormatSupported(QRhiTexture::RGBA16F, QRhiTexture::RenderTarget);
+    // The reduced depth needs a float render target, R32F is not
+    // renderable everywhere. Without either it stays at full resolution.
+    QRhiTexture::Format reducedDepthFormat = QRhiTexture::R32F;
+    if (!rhi->isTextureFormatSupported(reducedDepthFormat, QRhiTexture::RenderTarget))
+        reducedDepthFormat = QRhiTexture::RGBA16F;
+    const bool canReduce = reducedDepthFormat == QRhiTexture::R32F || hasRgba16fTarget;
+    const int divisor = canReduce ? data.layer.aoResolutionDivisor : 1;
+    const bool wantsTemporal = data.layer.aoTemporalAccumulation;
+    if (ready && (divisor > 1 || wantsTemporal)
+            && rhiCtx->mainPassViewCount() <= 1 && rhi->isFeatureSupported(QRhi::TexelFetch)) {
+        const QSize size = layerPrepResult.textureDimensions();
+        const QSize reducedSize((size.width() + divisor - 1) / divisor, (size.height() + divisor - 1) / divisor);
+        bool ok = true;
+        if (divisor > 1)
+            ok = rhiPrepareAoTexture(rhiCtx.get(), reducedSize, &rhiReducedDepthTexture, reducedDepthFormat);
+        ok = ok && rhiPrepareAoTexture(rhiCtx.get(), reducedSize, &rhiReducedAoTexture);
+        if (ok && wantsTemporal) {
+            const QRhiTexture::Format historyFormat = hasRgba16fTarget ? QRhiTexture::RGBA16F : QRhiTexture::RGBA8;
+            for (QSSGRhiRenderableTexture &history : rhiAoHistoryTextures) {
+                if (!history.texture || history.texture->pixelSize() != reducedSize)
+                    historyValid = false;
+                ok = ok && rhiPrepareAoTexture(rhiCtx.get(), reducedSize, &history, historyFormat);
+            }
+        }
+        if (ok) {
+            resolutionDivisor = divisor;
+            temporalAccumulation = wantsTemporal;
+            auto &builtInShaders = shaderCache->getBuiltInRhiShaders();
+            if (divisor > 1)
+                depthDownsampleShaderPipeline = builtInShaders.getRhiSsaoDepthDownsampleShader();
+            if (wantsTemporal)
+                temporalShaderPipeline = builtInShaders.getRhiSsaoTemporalShader();
+            upsampleShaderPipeline = builtInShaders.getRhiSsaoUpsampleShader();
+        }
+    }
+
+    if (temporalAccumulation) {
+        QMatrix4x4 viewProjection;
+        camera->calculateViewProjectionMatrix(viewProjection);
+        viewProjection = rhi->clipSpaceCorrMatrix() * viewProjection;
+        reprojection = previousViewProjection * viewProjection.inverted();
+        previousViewProjection = viewProjection;
+    } else {
+        // Start over when accumulating again
+        historyValid = false;
+    }
 }
 
 void SSAOMapPass::renderPass(QSSGRenderer &renderer)
@@ -337,15 +382,53 @@ void SSAOMapPass::renderPass(QSSGRenderer &renderer)
     Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
 
     if (Q_LIKELY(rhiAoTexture && rhiAoTexture->isValid())) {
-        rhiRenderAoTexture(rhiCtx.get(),
-                           this,
-                           renderer,
-                           *ssaoShaderPipeline,
-                           ps,
-                           aoSettings,
-                           *rhiAoTexture,
-                           *rhiDepthTexture,
-                           *camera);
+        if (resolutionDivisor > 1 || temporalAccumulation) {
+            // Every quad pass adds to the input assembler state, so each one
+            // starts from a copy.
+            QSSGRhiGraphicsPipelineState passPs = ps;
+            const QSSGRhiRenderableTexture *aoDepthTexture = rhiDepthTexture;
+            if (resolutionDivisor > 1) {
+                rhiDownsampleAoDepthTexture(rhiCtx.get(), this, renderer, *depthDownsampleShaderPipeline, passPs,
+                                            resolutionDivisor, *rhiDepthTexture, rhiReducedDepthTexture);
+                aoDepthTexture = &rhiReducedDepthTexture;
+            }
+
+            // Rotating the sampling pattern every frame lets the accumulated
+            // result converge towards eight times the samples of one frame.
+            const float sampleRotation = temporalAccumulation ? float(frameIndex++ % 8) * qDegreesToRadians(11.25f) : 0.0f;
+            passPs = ps;
+            const QSize reducedSize = rhiReducedAoTexture.texture->pixelSize();
+            passPs.viewport = QRhiViewport(0, 0, float(reducedSize.width()), float(reducedSize.height()));
+            rhiRenderAoTexture(rhiCtx.get(), this, renderer, *ssaoShaderPipeline, passPs, aoSettings,
+                               rhiReducedAoTexture, *aoDepthTexture, *camera, sampleRotation);
+
+            const QSSGRhiRenderableTexture *reducedAoTexture = &rhiReducedAoTexture;
+            if (temporalAccumulation) {
+                const QSSGRhiRenderableTexture &history = rhiAoHistoryTextures[currentHistory];
+                const QSSGRhiRenderableTexture &accumulated = rhiAoHistoryTextures[1 - currentHistory];
+                passPs = ps;
+                rhiAccumulateAoTexture(rhiCtx.get(), this, renderer, *temporalShaderPipeline, passPs,
+                                       reprojection, historyValid, 0.125f,
+                                       rhiReducedAoTexture, *aoDepthTexture, history, accumulated);
+                reducedAoTexture = &accumulated;
+                currentHistory = 1 - currentHistory;
+                historyValid = true;
+            }
+
+            passPs = ps;
+            rhiUpsampleAoTexture(rhiCtx.get(), this, renderer, *upsampleShaderPipeline, passPs, resolutionDivisor,
+                                 *reducedAoTexture, *aoDepthTexture, *rhiDepthTexture, *rhiAoTexture, *camera);
+        } else {
+            rhiRenderAoTexture(rhiCtx.get(),
+                               this,
+                               renderer,
+                               *ssaoShaderPipeline,
+                               ps,
+                               aoSettings,
+                               *rhiAoTexture,
+                               *rhiDepthTexture,
+                               *camera);
+        }
     }
 
     cb->debugMarkEnd();
@@ -359,6 +442,17 @@ void SSAOMapPass::resetForFrame()
     camera = nullptr;
     ps = {};
     aoSettings = {};
+    resolutionDivisor = 1;
+    temporalAccumulation = false;
+}
+
+void SSAOMapPass::releaseResources()
+{
+    rhiReducedDepthTexture.reset();
+    rhiReducedAoTexture.reset();
+    for (QSSGRhiRenderableTexture &history : rhiAoHistoryTextures)
+        history.reset();
+    historyValid = false;
 }
 
 // DEPTH TEXTURE PASS
@@ -926,6 +1020,26 @@ void Item2DPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
     ps.flags.setFlag(QSSGRhiGraphicsPipelineState::Flag::BlendEnabled, false);
 
     item2Ds = data.getRenderableItem2Ds();
+
+    QRhiRenderTarget *renderTarget = rhiCtx->renderTarget();
+
+    // The scissor workaround below needs the items to be rendered inline
+    if (QSSGRhiItem2DCache::isEnabled() && !layer.scissorRect.isValid()) {
+        if (!atlasCache)
+            atlasCache = std::make_unique<QSSGRhiItem2DCache>();
+        atlasCache->prepare(rhiCtx.get(), item2Ds, renderTarget->devicePixelRatio());
+
+        const auto &shaderCache = renderer.contextInterface()->shaderCache();
+        atlasShader = shaderCache->getBuiltInRhiShaders().getRhiItem2DAtlasShader(rhiCtx->mainPassViewCount());
+        atlasPs = data.getPipelineState();
+        atlasPs.samples = rhiCtx->mainPassSampleCount();
+        atlasPs.viewCount = rhiCtx->mainPassViewCount();
+        QSSGRhiGraphicsPipelineStatePrivate::setShaderPipeline(atlasPs, atlasShader.get());
+        renderer.rhiQuadRenderer()->prepareQuad(rhiCtx.get(), nullptr);
+    } else {
+        atlasCache.reset();
+    }
+
     for (const auto &item2D: std::as_const(item2Ds)) {
         // Set the projection matrix
         if (!item2D->m_renderer)
@@ -938,10 +1052,11 @@ void Item2DPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
             }
             continue;
         }
+        if (atlasCache && atlasShader && atlasCache->srbForItem(item2D))
+            continue;
 
         auto layerPrepResult = data.layerPrepResult;
 
-        QRhiRenderTarget *renderTarget = rhiCtx->renderTarget();
         item2D->m_renderer->setDevicePixelRatio(renderTarget->devicePixelRatio());
         const QRect deviceRect(QPoint(0, 0), renderTarget->pixelSize());
         const int viewCount = rhiCtx->mainPassViewCount();
@@ -997,8 +1112,18 @@ void Item2DPass::renderPass(QSSGRenderer &renderer)
     Q_TRACE_SCOPE(QSSG_renderPass, QStringLiteral("Quick3D render 2D sub-scene"));
     for (const auto &item : std::as_const(item2Ds)) {
         QSSGRenderItem2D *item2D = static_cast<QSSGRenderItem2D *>(item);
-        if (item2D->m_renderer && item2D->m_renderer->currentRhi() == renderer.contextInterface()->rhiContext()->rhi())
+        if (!item2D->m_renderer || item2D->m_renderer->currentRhi() != renderer.contextInterface()->rhiContext()->rhi())
+            continue;
+        // Cached content is a textured quad, tested against the depth of
+        // the 3D scene but not written, just like the inline 2D rendering.
+        QRhiShaderResourceBindings *srb = (atlasCache && atlasShader) ? atlasCache->srbForItem(item2D) : nullptr;
+        if (srb) {
+            QSSGRhiGraphicsPipelineState quadPs = atlasPs;
+            renderer.rhiQuadRenderer()->recordRenderQuad(rhiCtx.get(), &quadPs, srb, rhiCtx->mainRenderPassDescriptor(),
+                                                         { QSSGRhiQuadRenderer::UvCoords | QSSGRhiQuadRenderer::DepthTest | QSSGRhiQuadRenderer::PremulBlend });
+        } else {
             item2D->m_renderer->renderSceneInline();
+        }
     }
     cb->debugMarkEnd();
     Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DRenderPass, 0, QByteArrayLiteral("2D_sub_scene"));
@@ -1008,6 +1133,8 @@ void Item2DPass::resetForFrame()
 {
     item2Ds.clear();
     ps = {};
+    atlasPs = {};
+    atlasShader = nullptr;
 }
 
 void InfiniteGridPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
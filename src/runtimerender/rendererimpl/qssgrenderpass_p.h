@@ -22,6 +22,7 @@
 #include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderableobjects_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhiitem2dcache_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -47,6 +48,7 @@ public:
     virtual void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) = 0;
     virtual void renderPass(QSSGRenderer &renderer) = 0;
     virtual Type passType() const = 0;
+    virtual const char *debugName() const = 0; // in statistics
     virtual void resetForFrame() = 0;
 
     // Output:
@@ -62,6 +64,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Standalone; }
+    const char *debugName() const final { return "ShadowMap"; }
     void resetForFrame() final;
 
     std::shared_ptr<QSSGRenderShadowMap> shadowMapManager;
@@ -81,6 +84,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Standalone; }
+    const char *debugName() const final { return "ReflectionMap"; }
     void resetForFrame() final;
 
     std::shared_ptr<QSSGRenderReflectionMap> reflectionMapManager;
@@ -95,6 +99,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "ZPrePass"; }
     void resetForFrame() final;
 
     QSSGRenderableObjectList renderedDepthWriteObjects;
@@ -109,6 +114,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Standalone; }
+    const char *debugName() const final { return "SSAO"; }
     void resetForFrame() final;
 
     const QSSGRhiRenderableTexture *rhiDepthTexture = nullptr;
@@ -117,6 +123,25 @@ public:
     QSSGRhiGraphicsPipelineState ps;
     QSSGRhiRenderableTexture *rhiAoTexture = nullptr;
     QSSGRhiShaderPipelinePtr ssaoShaderPipeline;
+
+    // Reduced resolution and temporal accumulation, see
+    // QSSGRenderLayer::aoResolutionDivisor. The textures are kept between
+    // frames, releaseResources() frees them.
+    void releaseResources();
+
+    int resolutionDivisor = 1;
+    bool temporalAccumulation = false;
+    QSSGRhiShaderPipelinePtr depthDownsampleShaderPipeline;
+    QSSGRhiShaderPipelinePtr temporalShaderPipeline;
+    QSSGRhiShaderPipelinePtr upsampleShaderPipeline;
+    QSSGRhiRenderableTexture rhiReducedDepthTexture;
+    QSSGRhiRenderableTexture rhiReducedAoTexture;
+    QSSGRhiRenderableTexture rhiAoHistoryTextures[2];
+    int currentHistory = 0;
+    bool historyValid = false;
+    QMatrix4x4 previousViewProjection;
+    QMatrix4x4 reprojection;
+    quint32 frameIndex = 0;
 };
 
 class Q_QUICK3DRUNTIMERENDER_EXPORT DepthMapPass : public QSSGRenderPass
@@ -125,6 +150,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Standalone; }
+    const char *debugName() const final { return "DepthTexture"; }
     void resetForFrame() final;
 
     QSSGRenderableObjectList sortedOpaqueObjects;
@@ -139,6 +165,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "Skybox"; }
     void resetForFrame() final;
 
     QSSGRenderLayer *layer = nullptr;
@@ -154,6 +181,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "SkyboxCubeMap"; }
     void resetForFrame() final;
 
     QSSGRhiShaderPipelinePtr skyBoxCubeShader;
@@ -169,6 +197,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Standalone; }
+    const char *debugName() const final { return "ScreenTexture"; }
     void resetForFrame() final;
 
     QSSGRhiRenderableTexture *rhiScreenTexture = nullptr;
@@ -187,6 +216,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "ScreenTextureDependent"; }
     void resetForFrame() final;
 
     QSSGRenderableObjectList sortedScreenTextureObjects;
@@ -212,6 +242,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "Opaque"; }
     void resetForFrame() final;
 
     QSSGRenderableObjectList sortedOpaqueObjects;
@@ -240,6 +271,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "Transparent"; }
     void resetForFrame() final;
 
     QSSGRenderableObjectList sortedTransparentObjects;
@@ -253,10 +285,16 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "Item2D"; }
     void resetForFrame() final;
 
     QList<QSSGRenderItem2D *> item2Ds;
     QSSGRhiGraphicsPipelineState ps {};
+
+    // Persists between frames, created when QSSGRhiItem2DCache::isEnabled()
+    std::unique_ptr<QSSGRhiItem2DCache> atlasCache;
+    QSSGRhiShaderPipelinePtr atlasShader;
+    QSSGRhiGraphicsPipelineState atlasPs {};
 };
 
 class InfiniteGridPass : public QSSGRenderPass
@@ -265,6 +303,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "InfiniteGrid"; }
     void resetForFrame() final;
 
     QSSGRhiShaderPipelinePtr gridShader;
@@ -278,6 +317,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Main; }
+    const char *debugName() const final { return "DebugDraw"; }
     void resetForFrame() final;
 
     QSSGRhiShaderPipelinePtr debugObjectShader;
@@ -292,6 +332,7 @@ public:
     void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
     void renderPass(QSSGRenderer &renderer) final;
     Type passType() const final { return Type::Extension; }
+    const char *debugName() const final { return "Extension"; }
     void resetForFrame() final;
 
     bool hasData() const { return extensions.size() != 0; }
@@ -0,0 +1,13 @@
+#version 440
+
+layout(location = 0) in vec2 uv_coord;
+
+layout(location = 0) out vec4 fragOutput;
+
+layout(binding = 1) uniform sampler2D atlas;
+
+void main()
+{
+    // premultiplied alpha, as rendered by Qt Quick
+    fragOutput = texture(atlas, uv_coord);
+}
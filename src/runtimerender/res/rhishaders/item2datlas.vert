@@ -0,0 +1,34 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#version 440
+
+layout(location = 0) in vec3 attr_pos;
+layout(location = 1) in vec2 attr_uv;
+
+layout(std140, binding = 0) uniform buf {
+#if QSHADER_VIEW_COUNT >= 2
+    mat4 mvp[QSHADER_VIEW_COUNT];
+#else
+    mat4 mvp;
+#endif
+    // x, y, width, height of the 2D content, in the item's coordinates
+    vec4 contentRect;
+    // top left and bottom right of the content in the atlas
+    vec4 uvRect;
+} ubuf;
+
+layout(location = 0) out vec2 uv_coord;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main()
+{
+    vec2 pos = ubuf.contentRect.xy + attr_uv * ubuf.contentRect.zw;
+    uv_coord = mix(ubuf.uvRect.xy, ubuf.uvRect.zw, attr_uv);
+#if QSHADER_VIEW_COUNT >= 2
+    gl_Position = ubuf.mvp[gl_ViewIndex] * vec4(pos, 0.0, 1.0);
+#else
+    gl_Position = ubuf.mvp * vec4(pos, 0.0, 1.0);
+#endif
+}
@@ -84,7 +84,7 @@ vec3 getViewSpacePos( sampler2D depthSampler, vec2 camProps, vec2 UV, vec4 UvToE
 
 vec2 computeDir( vec2 baseDir, int v )
 {
-    float ang = 3.1415926535 * hashRot( gl_FragCoord.xy ) + float(v - 1);
+    float ang = 3.1415926535 * hashRot( gl_FragCoord.xy ) + float(v - 1) + ubuf.aoProperties2.z;
     vec2 vX = vec2(cos(ang), sin(ang));
     vec2 vY = vec2(-sin(ang), cos(ang));
 
@@ -93,7 +93,7 @@ vec2 computeDir( vec2 baseDir, int v )
 
 vec2 offsetDir( vec2 baseDir, int v )
 {
-    float ang = float(v - 1);
+    float ang = float(v - 1) + ubuf.aoProperties2.z;
     vec2 vX = vec2(cos(ang), sin(ang));
     vec2 vY = vec2(-sin(ang), cos(ang));
 
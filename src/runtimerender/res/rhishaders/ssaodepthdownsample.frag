@@ -0,0 +1,27 @@
+#version 440
+
+layout(location = 0) out vec4 fragOutput;
+
+layout(std140, binding = 0) uniform buf {
+    // x: resolution divisor, yz: largest texel coordinate of depthTexture
+    vec4 downsampleProperties;
+} ubuf;
+
+layout(binding = 1) uniform sampler2D depthTexture;
+
+void main()
+{
+    int divisor = int(ubuf.downsampleProperties.x);
+    ivec2 maxCoords = ivec2(ubuf.downsampleProperties.yz);
+    ivec2 baseCoords = ivec2(gl_FragCoord.xy) * divisor;
+
+    // Keep the closest depth of the footprint, so thin foreground
+    // geometry does not disappear from the occlusion
+    float depth = 1.0;
+    for (int y = 0; y < divisor; ++y) {
+        for (int x = 0; x < divisor; ++x)
+            depth = min(depth, texelFetch(depthTexture, min(baseCoords + ivec2(x, y), maxCoords), 0).x);
+    }
+
+    fragOutput = vec4(depth, 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,60 @@
+#version 440
+
+layout(location = 0) out vec4 fragOutput;
+
+layout(std140, binding = 0) uniform buf {
+    // normalized device coordinates of this frame to clip space of the previous one
+    mat4 reprojection;
+    // x: weight of this frame, y: 1 when the history is valid,
+    // z: 1 when the y axis of the framebuffer and the NDC differ, w: 1 when the clip depth is 0..1
+    vec4 temporalProperties;
+    // xy: 1 / texture size, zw: largest texel coordinate
+    vec4 textureSizeProperties;
+} ubuf;
+
+layout(binding = 1) uniform sampler2D aoTexture;
+layout(binding = 2) uniform sampler2D depthTexture;
+layout(binding = 3) uniform sampler2D historyTexture;
+
+void main()
+{
+    ivec2 coords = ivec2(gl_FragCoord.xy);
+    ivec2 maxCoords = ivec2(ubuf.textureSizeProperties.zw);
+    float ao = texelFetch(aoTexture, coords, 0).x;
+
+    // The sampling pattern changes every frame, so limiting the history to
+    // the range of the neighborhood keeps the noise while rejecting most of
+    // the ghosting of disoccluded areas.
+    float aoMin = ao;
+    float aoMax = ao;
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            float neighbor = texelFetch(aoTexture, clamp(coords + ivec2(x, y), ivec2(0), maxCoords), 0).x;
+            aoMin = min(aoMin, neighbor);
+            aoMax = max(aoMax, neighbor);
+        }
+    }
+
+    float result = ao;
+    if (ubuf.temporalProperties.y > 0.0) {
+        float depth = texelFetch(depthTexture, coords, 0).x;
+        vec3 ndc = vec3(gl_FragCoord.xy * ubuf.textureSizeProperties.xy * 2.0 - 1.0,
+                        ubuf.temporalProperties.w > 0.0 ? depth : depth * 2.0 - 1.0);
+        if (ubuf.temporalProperties.z > 0.0)
+            ndc.y = -ndc.y;
+
+        vec4 previous = ubuf.reprojection * vec4(ndc, 1.0);
+        if (previous.w > 0.0) {
+            vec2 previousUV = previous.xy / previous.w;
+            if (ubuf.temporalProperties.z > 0.0)
+                previousUV.y = -previousUV.y;
+            previousUV = previousUV * 0.5 + 0.5;
+            if (all(greaterThanEqual(previousUV, vec2(0.0))) && all(lessThanEqual(previousUV, vec2(1.0)))) {
+                float history = clamp(texture(historyTexture, previousUV).x, aoMin, aoMax);
+                result = mix(history, ao, ubuf.temporalProperties.x);
+            }
+        }
+    }
+
+    fragOutput = vec4(result, result, result, 1.0);
+}
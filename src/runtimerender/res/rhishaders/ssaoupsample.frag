@@ -0,0 +1,52 @@
+#version 440
+
+layout(location = 0) out vec4 fragOutput;
+
+layout(std140, binding = 0) uniform buf {
+    // x: resolution divisor, yz: largest texel coordinate of the reduced textures
+    vec4 upsampleProperties;
+    vec2 cameraProperties;
+} ubuf;
+
+layout(binding = 1) uniform sampler2D aoTexture;
+layout(binding = 2) uniform sampler2D depthTexture;
+layout(binding = 3) uniform sampler2D fullDepthTexture;
+
+float linearDepth(float depthSample)
+{
+    float zNear = ubuf.cameraProperties.x;
+    float zFar = ubuf.cameraProperties.y;
+    float z_n = 2.0 * depthSample - 1.0;
+    return 2.0 * zNear * zFar / (zFar + zNear - z_n * (zFar - zNear));
+}
+
+void addSample(ivec2 coords, float bilinearWeight, float depth, inout float ao, inout float totalWeight)
+{
+    coords = clamp(coords, ivec2(0), ivec2(ubuf.upsampleProperties.yz));
+    float sampleDepth = linearDepth(texelFetch(depthTexture, coords, 0).x);
+    // Samples from other surfaces than the one of this pixel contribute next to nothing
+    float weight = bilinearWeight / (0.001 + abs(sampleDepth - depth) / depth);
+    ao += weight * texelFetch(aoTexture, coords, 0).x;
+    totalWeight += weight;
+}
+
+void main()
+{
+    float depth = linearDepth(texelFetch(fullDepthTexture, ivec2(gl_FragCoord.xy), 0).x);
+
+    // The texel centers of the reduced textures are at (i + 0.5) * divisor
+    vec2 coords = gl_FragCoord.xy / ubuf.upsampleProperties.x - 0.5;
+    vec2 baseCoords = floor(coords);
+    vec2 f = coords - baseCoords;
+    ivec2 base = ivec2(baseCoords);
+
+    float ao = 0.0;
+    float totalWeight = 0.0;
+    addSample(base, (1.0 - f.x) * (1.0 - f.y), depth, ao, totalWeight);
+    addSample(base + ivec2(1, 0), f.x * (1.0 - f.y), depth, ao, totalWeight);
+    addSample(base + ivec2(0, 1), (1.0 - f.x) * f.y, depth, ao, totalWeight);
+    addSample(base + ivec2(1, 1), f.x * f.y, depth, ao, totalWeight);
+    ao /= totalWeight;
+
+    fragOutput = vec4(ao, ao, ao, 1.0);
+}
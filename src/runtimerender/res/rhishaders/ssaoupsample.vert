@@ -0,0 +1,11 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#version 440
+
+layout(location = 0) in vec3 attr_pos;
+
+void main()
+{
+    gl_Position = vec4(attr_pos.xy, 0.5, 1.0 );
+}
@@ -0,0 +1,141 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgenvironmentmapcache_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderloadedtexture_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgreflectionprobebaker_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qthreadpool.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+// Part of the key, bump when the prefiltering in QSSGBufferManager changes
+// (sample count, face size, number of mip levels) so stale files are not used.
+static constexpr char CacheVersion[] = "1";
+
+struct QSSGEnvironmentMapCache::Job
+{
+    QString path;
+    QSize size;
+    std::vector<QRhiReadbackResult> results; // six faces per level
+    int pending = 0;
+};
+
+QSSGEnvironmentMapCache::QSSGEnvironmentMapCache() = default;
+
+QSSGEnvironmentMapCache::~QSSGEnvironmentMapCache()
+{
+    // Jobs with readbacks in flight are kept alive by their own callbacks,
+    // the rest are released here.
+    for (const std::shared_ptr<Job> &job : m_jobs) {
+        if (job->pending == 0)
+            job->results.clear();
+    }
+}
+
+bool QSSGEnvironmentMapCache::isEnabled()
+{
+    static const bool enabled = !qEnvironmentVariableIsEmpty("QT_QUICK3D_IBL_CACHE_PATH");
+    return enabled;
+}
+
+QByteArray QSSGEnvironmentMapCache::sourceKey(const QString &sourcePath, const QSSGRenderTextureFormat &format)
+{
+    const QSharedPointer<QIODevice> stream = QSSGInputUtil::getStreamForFile(sourcePath, true);
+    if (!stream)
+        return {};
+    return sourceKey(stream->readAll(), format);
+}
+
+QByteArray QSSGEnvironmentMapCache::sourceKey(const QByteArray &sourceData, const QSSGRenderTextureFormat &format)
+{
+    if (sourceData.isEmpty())
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(CacheVersion);
+    const qint32 requestedFormat = qint32(format.format);
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(&requestedFormat), sizeof(requestedFormat)));
+    hash.addData(sourceData);
+    return hash.result();
+}
+
+QString QSSGEnvironmentMapCache::cachedMapPath(const QByteArray &sourceKey)
+{
+    const QString fileName = QStringLiteral("qibl_") + QString::fromLatin1(sourceKey.toHex()) + QStringLiteral(".ktx");
+    return QDir(qEnvironmentVariable("QT_QUICK3D_IBL_CACHE_PATH")).filePath(fileName);
+}
+
+bool QSSGEnvironmentMapCache::canStore(const QRhiTexture *environmentMap)
+{
+    return environmentMap
+            && environmentMap->format() == QRhiTexture::RGBA16F
+            && environmentMap->flags().testFlag(QRhiTexture::UsedAsTransferSource);
+}
+
+void QSSGEnvironmentMapCache::store(QSSGRhiContext *rhiCtx, QRhiTexture *environmentMap, int mipmapCount, const QString &path)
+{
+    // The callbacks of a job hold a reference to it, and cannot be destroyed
+    // from within themselves. Finished jobs are released here instead.
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(),
+                                [](const std::shared_ptr<Job> &job) {
+                                    if (job->pending > 0)
+                                        return false;
+                                    job->results.clear();
+                                    return true;
+                                }),
+                 m_jobs.end());
+
+    if (!canStore(environmentMap) || mipmapCount <= 0)
+        return;
+
+    // The results are written by QRhi, so the job has to outlive the
+    // readbacks even when the cache is destroyed before they complete.
+    auto pendingJob = std::make_shared<Job>();
+    pendingJob->path = path;
+    pendingJob->size = environmentMap->pixelSize();
+    pendingJob->results.resize(mipmapCount * 6);
+    pendingJob->pending = mipmapCount * 6;
+    m_jobs.push_back(pendingJob);
+
+    QRhiResourceUpdateBatch *rub = rhiCtx->rhi()->nextResourceUpdateBatch();
+    for (int level = 0; level < mipmapCount; ++level) {
+        for (int face = 0; face < 6; ++face) {
+            QRhiReadbackResult &result = pendingJob->results[level * 6 + face];
+            result.completed = [pendingJob] {
+                if (--pendingJob->pending > 0)
+                    return;
+                QList<QByteArray> faces;
+                faces.reserve(qsizetype(pendingJob->results.size()));
+                for (QRhiReadbackResult &faceResult : pendingJob->results) {
+                    faces.append(faceResult.data);
+                    faceResult.data.clear();
+                }
+                // Encoding and writing a few megabytes is left to a worker
+                QThreadPool::globalInstance()->start([path = pendingJob->path, size = pendingJob->size, faces] {
+                    const QByteArray data = QSSGReflectionProbeBaker::ktxData(size, faces,
+                            { { QByteArrayLiteral("QT_IBL_BAKER_VERSION"), QByteArrayLiteral("1") },
+                              { QByteArrayLiteral("QT_IBL_CACHE_VERSION"), QByteArray(CacheVersion) } });
+                    QDir().mkpath(QFileInfo(path).absolutePath());
+                    QSaveFile file(path);
+                    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+                        qWarning("Failed to write cached environment map %s: %s", qPrintable(path), qPrintable(file.errorString()));
+                });
+            };
+            QRhiReadbackDescription desc(environmentMap);
+            desc.setLayer(face);
+            desc.setLevel(level);
+            rub->readBackTexture(desc, &result);
+        }
+    }
+    rhiCtx->commandBuffer()->resourceUpdate(rub);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,72 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGENVIRONMENTMAPCACHE_P_H
+#define QSSGENVIRONMENTMAPCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+#include <QtQuick3DUtils/private/qssgrenderbasetypes_p.h>
+
+#include <QtCore/qstring.h>
+
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QSSGRhiContext;
+class QRhiTexture;
+
+// Disk cache for the prefiltered environment maps of light probes, so that
+// the equirectangular to cube map conversion and the prefiltering only run the
+// first time an image is used as a light probe.
+//
+// Once an environment map is created, its mip levels are read back and
+// written, in the same format as the offline IBL baker produces, to
+// qibl_<key>.ktx in the directory given in QT_QUICK3D_IBL_CACHE_PATH. The key
+// is a hash of the contents of the source image and of the parameters of the
+// prefiltering, so an edited image is simply a cache miss. Only RGBA16F maps
+// are cached, which covers .hdr light probes with the default settings.
+//
+// The cache is disabled when QT_QUICK3D_IBL_CACHE_PATH is not set.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGEnvironmentMapCache
+{
+public:
+    QSSGEnvironmentMapCache();
+    ~QSSGEnvironmentMapCache();
+
+    static bool isEnabled();
+
+    // Empty when the source can not be read.
+    static QByteArray sourceKey(const QString &sourcePath, const QSSGRenderTextureFormat &format);
+    static QByteArray sourceKey(const QByteArray &sourceData, const QSSGRenderTextureFormat &format);
+
+    static QString cachedMapPath(const QByteArray &sourceKey);
+
+    static bool canStore(const QRhiTexture *environmentMap);
+
+    // Reads back the mip levels of the environment map and writes them to
+    // path once the data has arrived. The file is written on a worker thread.
+    void store(QSSGRhiContext *rhiCtx, QRhiTexture *environmentMap, int mipmapCount, const QString &path);
+
+private:
+    struct Job;
+
+    std::vector<std::shared_ptr<Job>> m_jobs;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGENVIRONMENTMAPCACHE_P_H
@@ -5,6 +5,8 @@
 #include "qssgrenderbuffermanager_p.h"
 
 #include <QtQuick3DRuntimeRender/private/qssgrenderloadedtexture_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgenvironmentmapcache_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgtexturecooker_p.h>
 
 #include <QtQuick3DRuntimeRender/private/qssgruntimerenderlogging_p.h>
 #include <QtQuick3DUtils/private/qssgmeshbvhbuilder_p.h>
@@ -14,6 +16,7 @@
 #include <QtQuick/QSGTexture>
 
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtGui/private/qimage_p.h>
 #include <QtQuick/private/qsgtexture_p.h>
 #include <QtQuick/private/qsgcompressedtexture_p.h>
@@ -26,6 +29,8 @@
 #include "../qssgrendercontextcore.h"
 #include <QtQuick3DRuntimeRender/private/qssglightmapper_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderresourceloader_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhimeshpool_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhiskinning_p.h>
 #include <qtquick3d_tracepoints_p.h>
 #include "../extensionapi/qssgrenderextensions.h"
 
@@ -126,8 +131,147 @@ static constexpr QSize sizeForMipLevel(int mipLevel, const QSize &baseLevelSize)
     return QSize(qMax(1, baseLevelSize.width() >> mipLevel), qMax(1, baseLevelSize.height() >> mipLevel));
 }
 
+static inline quint64 textureMemorySize(QRhiTexture *texture)
+{
+    quint64 s = 0;
+    if (!texture)
+        return s;
+
+    auto format = texture->format();
+    if (format == QRhiTexture::UnknownFormat)
+        return 0;
+
+    s = texture->pixelSize().width() * texture->pixelSize().height();
+    /*
+        UnknownFormat,
+        RGBA8,
+        BGRA8,
+        R8,
+        RG8,
+        R16,
+        RG16,
+        RED_OR_ALPHA8,
+        RGBA16F,
+        RGBA32F,
+        R16F,
+        R32F,
+        RGB10A2,
+        R8UI,
+        D16,
+        D24,
+        D24S8,
+        D32F,
+        D32FS8*/
+    static const quint64 pixelSizes[] = {0, 4, 4, 1, 2, 2, 4, 1, 2, 4, 2, 4, 4, 1, 2, 4, 4, 4, 8};
+    /*
+        BC1,
+        BC2,
+        BC3,
+        BC4,
+        BC5,
+        BC6H,
+        BC7,
+        ETC2_RGB8,
+        ETC2_RGB8A1,
+        ETC2_RGBA8,*/
+    static const quint64 blockSizes[] = {8, 16, 16, 8, 16, 16, 16, 8, 8, 16};
+    Q_STATIC_ASSERT_X(QRhiTexture::BC1 == 19 && QRhiTexture::ETC2_RGBA8 == 28,
+                      "QRhiTexture format constant value missmatch.");
+    if (format < QRhiTexture::BC1)
+        s *= pixelSizes[format];
+    else if (format >= QRhiTexture::BC1 && format <= QRhiTexture::ETC2_RGBA8)
+        s /= blockSizes[format - QRhiTexture::BC1];
+    else
+        s /= 16;
+
+    if (texture->flags() & QRhiTexture::MipMapped)
+        s += s / 4;
+    if (texture->flags() & QRhiTexture::CubeMap)
+        s *= 6;
+    return s;
+}
+
+static inline quint64 bufferMemorySize(const QSSGRhiBufferPtr &buffer)
+{
+    quint64 s = 0;
+    if (!buffer)
+        return s;
+    s = buffer->buffer()->size();
+    return s;
+}
+
+static inline quint64 meshMemorySize(const QSSGRenderMesh *mesh)
+{
+    if (!mesh || mesh->subsets.isEmpty())
+        return 0;
+    // pooled meshes only account for their share of the pool buffers
+    if (mesh->pooledVertexData.isValid())
+        return mesh->pooledVertexData.size + mesh->pooledIndexData.size;
+    // submeshes ref into the same vertex and index buffer
+    return bufferMemorySize(mesh->subsets.at(0).rhi.vertexBuffer)
+            + bufferMemorySize(mesh->subsets.at(0).rhi.indexBuffer);
+}
+
+// Meshes quantized by the importer store some attributes as half floats,
+// which the backend may not be able to fetch. These are widened to 32-bit
+// floats when uploading then.
+static QSSGMesh::Mesh::VertexBuffer expandHalfFloatAttributes(const QSSGMesh::Mesh::VertexBuffer &vertexBuffer)
+{
+    using ComponentType = QSSGMesh::Mesh::ComponentType;
+    bool hasHalfFloats = false;
+    for (const QSSGMesh::Mesh::VertexBufferEntry &entry : vertexBuffer.entries)
+        hasHalfFloats |= entry.componentType == ComponentType::Float16;
+    if (!hasHalfFloats || !vertexBuffer.stride)
+        return vertexBuffer;
+
+    QSSGMesh::Mesh::VertexBuffer result;
+    for (const QSSGMesh::Mesh::VertexBufferEntry &entry : vertexBuffer.entries) {
+        QSSGMesh::Mesh::VertexBufferEntry newEntry = entry;
+        if (entry.componentType == ComponentType::Float16)
+            newEntry.componentType = ComponentType::Float32;
+        newEntry.offset = result.stride;
+        result.stride += QSSGMesh::MeshInternal::byteSizeForComponentType(newEntry.componentType) * newEntry.componentCount;
+        result.entries.append(newEntry);
+    }
+
+    const quint32 vertexCount = vertexBuffer.data.size() / vertexBuffer.stride;
+    result.data.resize(qsizetype(vertexCount) * result.stride);
+    const char *src = vertexBuffer.data.constData();
+    char *dst = result.data.data();
+    for (quint32 vertex = 0; vertex < vertexCount; ++vertex) {
+        for (qsizetype i = 0, count = vertexBuffer.entries.size(); i < count; ++i) {
+            const QSSGMesh::Mesh::VertexBufferEntry &from = vertexBuffer.entries.at(i);
+            const QSSGMesh::Mesh::VertexBufferEntry &to = result.entries.at(i);
+            const char *fromData = src + vertex * vertexBuffer.stride + from.offset;
+            char *toData = dst + vertex * result.stride + to.offset;
+            if (from.componentType == ComponentType::Float16) {
+                qFloatFromFloat16(reinterpret_cast<float *>(toData), reinterpret_cast<const qfloat16 *>(fromData), from.componentCount);
+            } else {
+                memcpy(toData, fromData, QSSGMesh::MeshInternal::byteSizeForComponentType(from.componentType) * from.componentCount);
+            }
+        }
+    }
+    return result;
+}
+
+static inline quint64 residentSize(const QSSGBufferManager::MeshData &meshData)
+{
+    return meshMemorySize(meshData.mesh);
+}
+
+static inline quint64 residentSize(const QSSGBufferManager::ImageData &imageData)
+{
+    return textureMemorySize(imageData.renderImageTexture.m_texture);
+}
+
 QSSGBufferManager::QSSGBufferManager()
 {
+    // Optional default for the residency budget, in megabytes
+    m_residencyBudget = quint64(qMax(0, qEnvironmentVariableIntValue("QT_QUICK3D_RESIDENCY_BUDGET_MB"))) * 1024 * 1024;
+    m_meshBufferPooling = qEnvironmentVariableIntValue("QT_QUICK3D_MESH_BUFFER_POOLING") != 0;
+    m_progressiveEnvironmentMaps = qEnvironmentVariableIntValue("QT_QUICK3D_PROGRESSIVE_IBL") != 0;
+    if (qEnvironmentVariableIsSet("QT_QUICK3D_IBL_PASSES_PER_FRAME"))
+        m_environmentMapPassesPerFrame = qMax(1, qEnvironmentVariableIntValue("QT_QUICK3D_IBL_PASSES_PER_FRAME"));
 }
 
 QSSGBufferManager::~QSSGBufferManager()
@@ -146,6 +290,23 @@ void QSSGBufferManager::releaseCachedResources()
     clear();
 }
 
+void QSSGBufferManager::setResidencyBudget(quint64 budget)
+{
+    // A lowered budget takes effect on the next cleanupUnreferencedBuffers()
+    m_residencyBudget = budget;
+}
+
+void QSSGBufferManager::touchResidency(ResidencyInfo &residency)
+{
+    if (residency.cached) {
+        residency.cached = false;
+        ++m_residencyStats.hits;
+        if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
+            qDebug() << "* residency hit" << currentLayer;
+    }
+    residency.lastUsed = m_residencySerial;
+}
+
 void QSSGBufferManager::releaseResourcesForLayer(QSSGRenderLayer *layer)
 {
     // frameResetIndex must be +1 since it's depending on being the
@@ -155,6 +316,39 @@ void QSSGBufferManager::releaseResourcesForLayer(QSSGRenderLayer *layer)
     cleanupUnreferencedBuffers(frameResetIndex + 1, layer);
 }
 
+// Written by the IBL baker, or by QSSGEnvironmentMapCache
+static bool isPrebakedEnvironmentMap(const QTextureFileData &texFileData)
+{
+    return texFileData.isValid() && texFileData.keyValueMetadata().contains("QT_IBL_BAKER_VERSION");
+}
+
+// The version of an image written by the texturecooker tool next to it, when
+// it is cooked from the same image data in a format the backend supports. The
+// image data is only read when its size and modification time do not tell.
+static QSSGLoadedTexture *loadCookedTexture(const QString &path, QRhi *rhi)
+{
+    QString fileName;
+    QSSGInputUtil::FileType fileType = QSSGInputUtil::UnknownFile;
+    QSharedPointer<QIODevice> source = QSSGInputUtil::getStreamForTextureFile(path, true, &fileName, &fileType);
+    if (!source || fileType != QSSGInputUtil::ImageFile)
+        return nullptr;
+    const QString cookedPath = QSSGTextureCooker::cookedPath(fileName);
+    if (!QFileInfo::exists(cookedPath))
+        return nullptr;
+    QScopedPointer<QSSGLoadedTexture> texture(QSSGLoadedTexture::loadCompressedImage(cookedPath));
+    if (!texture || !QSSGTextureCooker::isCooked(texture->textureFileData))
+        return nullptr;
+    if (!QSSGTextureCooker::isCookedFrom(texture->textureFileData, fileName, source.get())) {
+        qCWarning(PERF_WARNING, "Ignoring %s, the source image has changed since it was cooked", qPrintable(cookedPath));
+        return nullptr;
+    }
+    if (!rhi->isTextureFormatSupported(QSSGBufferManager::toRhiFormat(texture->format))) {
+        qCDebug(PERF_INFO, "Ignoring %s, the texture format is not supported", qPrintable(cookedPath));
+        return nullptr;
+    }
+    return texture.take();
+}
+
 QSSGRenderImageTexture QSSGBufferManager::loadRenderImage(const QSSGRenderImage *image,
                                                           MipMode inMipMode,
                                                           LoadRenderImageFlags flags)
@@ -214,23 +408,72 @@ QSSGRenderImageTexture QSSGBufferManager::loadRenderImage(const QSSGRenderImage
         const ImageCacheKey imageKey = { image->m_imagePath, inMipMode, int(image->type) };
         auto foundIt = imageMap.find(imageKey);
         if (foundIt != imageMap.cend()) {
+            if (inMipMode == MipModeBsdf)
+                advanceEnvironmentMapJob(imageKey, foundIt.value());
             result = foundIt.value().renderImageTexture;
         } else {
+            ++m_residencyStats.misses;
             Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DTextureLoad);
+            QElapsedTimer loadTimer;
+            loadTimer.start();
             QScopedPointer<QSSGLoadedTexture> theLoadedTexture;
             const auto &path = image->m_imagePath.path();
             const bool flipY = flags.testFlag(LoadWithFlippedY);
             Q_TRACE_SCOPE(QSSG_textureLoadPath, path);
-            theLoadedTexture.reset(QSSGLoadedTexture::load(path, image->m_format, flipY));
+            // A light probe prefiltered in an earlier run is loaded as is,
+            // skipping both the decoding of the source and the prefiltering
+            QString environmentMapCachePath;
+            if (inMipMode == MipModeBsdf && QSSGEnvironmentMapCache::isEnabled()) {
+                const QByteArray sourceKey = QSSGEnvironmentMapCache::sourceKey(path, image->m_format);
+                if (!sourceKey.isEmpty()) {
+                    environmentMapCachePath = QSSGEnvironmentMapCache::cachedMapPath(sourceKey);
+                    if (QFileInfo::exists(environmentMapCachePath))
+                        theLoadedTexture.reset(QSSGLoadedTexture::load(environmentMapCachePath, image->m_format, false));
+                }
+            }
+            // A cooked image is uploaded as is, with its own mip levels.
+            // Cooked files are stored flipped, the way images are uploaded
+            // by default.
+            bool cooked = false;
+            if (inMipMode != MipModeBsdf && flipY && image->type != QSSGRenderGraphObject::Type::ImageCube) {
+                theLoadedTexture.reset(loadCookedTexture(path, context->rhi()));
+                cooked = !theLoadedTexture.isNull();
+            }
+            if (!cooked && (!theLoadedTexture || !isPrebakedEnvironmentMap(theLoadedTexture->textureFileData)))
+                theLoadedTexture.reset(QSSGLoadedTexture::load(path, image->m_format, flipY));
+            else
+                environmentMapCachePath.clear();
             if (theLoadedTexture) {
                 foundIt = imageMap.insert(imageKey, ImageData());
                 CreateRhiTextureFlags rhiTexFlags = ScanForTransparency;
                 if (image->type == QSSGRenderGraphObject::Type::ImageCube)
                     rhiTexFlags |= CubeMap;
-                if (!setRhiTexture(foundIt.value().renderImageTexture, theLoadedTexture.data(), inMipMode, rhiTexFlags, QFileInfo(path).fileName())) {
+                const bool needsEnvironmentMap = inMipMode == MipModeBsdf
+                        && !isPrebakedEnvironmentMap(theLoadedTexture->textureFileData);
+                bool created = false;
+                if (needsEnvironmentMap && m_progressiveEnvironmentMaps) {
+                    created = createEnvironmentMapProgressively(imageKey, theLoadedTexture.data(), &foundIt.value().renderImageTexture,
+                                                                QFileInfo(path).fileName(), environmentMapCachePath);
+                    if (!created)
+                        qWarning() << "Failed to create environment map";
+                } else {
+                    created = setRhiTexture(foundIt.value().renderImageTexture, theLoadedTexture.data(), inMipMode, rhiTexFlags, QFileInfo(path).fileName());
+                    const QSSGRenderImageTexture &texture = foundIt.value().renderImageTexture;
+                    if (created && needsEnvironmentMap && !environmentMapCachePath.isEmpty())
+                        environmentMapCache()->store(context.get(), texture.m_texture, texture.m_mipmapCount, environmentMapCachePath);
+                }
+                if (!created) {
                     foundIt.value() = ImageData();
-                } else if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug)) {
-                    qDebug() << "+ uploadTexture: " << image->m_imagePath.path() << currentLayer;
+                } else {
+                    QSSGRhiContextStats::get(*context).textureLoaded(foundIt.value().renderImageTexture.m_texture,
+                                                                     loadTimer.nsecsElapsed() / 1000,
+                                                                     QSSGTextureCooker::isCooked(theLoadedTexture->textureFileData));
+                    QSSGRHICTX_STAT(context.get(), expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::TextureUpload,
+                                                                  path.toUtf8(),
+                                                                  loadTimer.nsecsElapsed(),
+                                                                  textureMemorySize(foundIt.value().renderImageTexture.m_texture)));
+                    if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
+                        qDebug() << "+ uploadTexture: " << image->m_imagePath.path() << currentLayer;
                 }
                 result = foundIt.value().renderImageTexture;
                 increaseMemoryStat(result.m_texture);
@@ -244,6 +487,7 @@ QSSGRenderImageTexture QSSGBufferManager::loadRenderImage(const QSSGRenderImage
             Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DTextureLoad, stats.imageDataSize, path.toUtf8());
         }
         foundIt.value().usageCounts[currentLayer]++;
+        touchResidency(foundIt.value().residency);
     } else if (image->m_extensionsSource) {
         auto it = renderExtensionTexture.find(image->m_extensionsSource);
         if (it != renderExtensionTexture.end()) {
@@ -262,20 +506,37 @@ QSSGRenderImageTexture QSSGBufferManager::loadTextureData(QSSGRenderTextureData
     const CustomImageCacheKey imageKey = { data, data->size(), inMipMode };
     auto theImageData = customTextureMap.find(imageKey);
     if (theImageData == customTextureMap.end()) {
+        ++m_residencyStats.misses;
         theImageData = customTextureMap.insert(imageKey, ImageData{{}, {}, data->version()});
-    } else if (data->version() == theImageData->version) {
-        // Return the currently loaded texture
+    } else if (data->version() == theImageData->version
+               && updateTextureDataRegions(data, theImageData.value())) {
+        // Return the currently loaded texture (with the changed regions uploaded, if any)
         theImageData.value().usageCounts[currentLayer]++;
+        touchResidency(theImageData.value().residency);
         return theImageData.value().renderImageTexture;
     } else {
         // Optimization: If only the version number has changed, we can attempt to reuse the texture.
         // Just update the version number and let setRhiTexture handle the rest.
         theImageData->version = data->version();
+        // The size is part of the key, but the storage can only be reused
+        // when the format and the depth are the same as well.
+        QRhiTexture *texture = theImageData->renderImageTexture.m_texture;
+        if (texture && (texture->format() != toRhiFormat(data->format().format)
+                        || texture->flags().testFlag(QRhiTexture::ThreeDimensional) != (data->depth() > 0)
+                        || (data->depth() > 0 && texture->depth() != data->depth()))) {
+            decreaseMemoryStat(texture);
+            QSSGRhiContextPrivate::get(m_contextInterface->rhiContext().get())->releaseTexture(texture);
+            theImageData->renderImageTexture = {};
+        }
     }
+    theImageData->updateVersion = data->updateVersion();
+    data->clearDirtyRegions();
 
     // Load the texture
     QScopedPointer<QSSGLoadedTexture> theLoadedTexture;
     if (!data->textureData().isNull()) {
+        QElapsedTimer uploadTimer;
+        uploadTimer.start();
         theLoadedTexture.reset(QSSGLoadedTexture::loadTextureData(data));
         theLoadedTexture->ownsData = false;
         CreateRhiTextureFlags rhiTexFlags = {};
@@ -285,6 +546,12 @@ QSSGRenderImageTexture QSSGBufferManager::loadTextureData(QSSGRenderTextureData
         bool wasTextureCreated = false;
 
         if (setRhiTexture(theImageData.value().renderImageTexture, theLoadedTexture.data(), inMipMode, rhiTexFlags, data->debugObjectName, &wasTextureCreated)) {
+            m_textureDataUploadStats.uploadedSize += theLoadedTexture->dataSizeInBytes;
+            QSSGRHICTX_STAT(m_contextInterface->rhiContext().get(),
+                            expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::TextureUpload,
+                                           data->debugObjectName.toUtf8(),
+                                           uploadTimer.nsecsElapsed(),
+                                           theLoadedTexture->dataSizeInBytes));
             if (wasTextureCreated) {
                 if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
                     qDebug() << "+ uploadTexture: " << data << theImageData.value().renderImageTexture.m_texture << currentLayer;
@@ -296,9 +563,68 @@ QSSGRenderImageTexture QSSGBufferManager::loadTextureData(QSSGRenderTextureData
     }
 
     theImageData.value().usageCounts[currentLayer]++;
+    touchResidency(theImageData.value().residency);
     return theImageData.value().renderImageTexture;
 }
 
+// Uploads only the regions that were changed with the partial update function
+// of QQuick3DTextureData to the existing texture. Returns false when the
+// texture has to be uploaded fully instead.
+bool QSSGBufferManager::updateTextureDataRegions(QSSGRenderTextureData *data, ImageData &imageData)
+{
+    if (data->updateVersion() == imageData.updateVersion)
+        return true;
+
+    // Environment maps are cube maps generated from the data, they cannot be
+    // patched.
+    QRhiTexture *texture = imageData.renderImageTexture.m_texture;
+    if (!texture || texture->flags().testFlag(QRhiTexture::CubeMap) || data->format().isCompressedTextureFormat())
+        return false;
+
+    if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
+        qDebug() << "+ updateTexture: " << data << texture << currentLayer;
+
+    const qsizetype pixelSize = data->format().getSizeofFormat();
+    const qsizetype lineSize = QSSGRenderTextureData::bytesPerLine(data->size().width(), data->depth(), data->format());
+    const qsizetype sliceSize = lineSize * data->size().height();
+    QVarLengthArray<QRhiTextureUploadEntry, 16> textureUploads;
+    for (const QSSGRenderTextureData::DirtyRegion &region : data->dirtyRegions()) {
+        // Pack the rows of the region the same way as the full data
+        const QRect &rect = region.rect;
+        const qsizetype rowSize = rect.width() * pixelSize;
+        const qsizetype packedLineSize = data->depth() > 0 ? rowSize : (rowSize + 3) & ~3;
+        QByteArray pixels(packedLineSize * rect.height(), Qt::Uninitialized);
+        const char *src = data->textureData().constData() + region.slice * sliceSize + rect.y() * lineSize + rect.x() * pixelSize;
+        char *dst = pixels.data();
+        for (int y = 0; y < rect.height(); ++y) {
+            memcpy(dst, src, rowSize);
+            src += lineSize;
+            dst += packedLineSize;
+        }
+        m_textureDataUploadStats.uploadedSize += pixels.size();
+
+        QRhiTextureSubresourceUploadDescription subDesc(pixels);
+        subDesc.setSourceSize(rect.size());
+        subDesc.setDestinationTopLeft(rect.topLeft());
+        textureUploads << QRhiTextureUploadEntry { region.slice, 0, subDesc };
+    }
+
+    const auto &context = m_contextInterface->rhiContext();
+    QRhiTextureUploadDescription uploadDescription;
+    uploadDescription.setEntries(textureUploads.cbegin(), textureUploads.cend());
+    auto *rub = context->rhi()->nextResourceUpdateBatch();
+    rub->uploadTexture(texture, uploadDescription);
+    // There is no way to regenerate only parts of the mip chain
+    if (texture->flags().testFlag(QRhiTexture::UsedWithGenerateMips))
+        rub->generateMips(texture);
+    context->commandBuffer()->resourceUpdate(rub);
+    ++m_textureDataUploadStats.partialUpdates;
+
+    data->clearDirtyRegions();
+    imageData.updateVersion = data->updateVersion();
+    return true;
+}
+
 QSSGRenderImageTexture QSSGBufferManager::loadLightmap(const QSSGRenderModel &model)
 {
     static const QSSGRenderTextureFormat format = QSSGRenderTextureFormat::RGBA16F;
@@ -310,6 +636,7 @@ QSSGRenderImageTexture QSSGBufferManager::loadLightmap(const QSSGRenderModel &mo
     if (foundIt != imageMap.end()) {
         result = foundIt.value().renderImageTexture;
     } else {
+        ++m_residencyStats.misses;
         Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DTextureLoad);
         Q_TRACE_SCOPE(QSSG_textureLoadPath, imagePath);
         QScopedPointer<QSSGLoadedTexture> theLoadedTexture;
@@ -328,6 +655,41 @@ QSSGRenderImageTexture QSSGBufferManager::loadLightmap(const QSSGRenderModel &mo
         Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DTextureLoad, stats.imageDataSize, imagePath.toUtf8());
     }
     foundIt.value().usageCounts[currentLayer]++;
+    touchResidency(foundIt.value().residency);
+    return result;
+}
+
+QSSGRenderImageTexture QSSGBufferManager::loadBakedReflectionMap(const QString &path)
+{
+    QSSGRenderImageTexture result;
+    const ImageCacheKey imageKey = { QSSGRenderPath(path), MipModeDisable, int(QSSGRenderGraphObject::Type::ReflectionProbe) };
+    auto foundIt = imageMap.find(imageKey);
+    if (foundIt != imageMap.end()) {
+        result = foundIt.value().renderImageTexture;
+    } else {
+        // Probes that were not baked, or whose content changed since, are rendered instead
+        if (!QFileInfo::exists(path))
+            return result;
+        ++m_residencyStats.misses;
+        Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DTextureLoad);
+        Q_TRACE_SCOPE(QSSG_textureLoadPath, path);
+        QScopedPointer<QSSGLoadedTexture> theLoadedTexture;
+        theLoadedTexture.reset(QSSGLoadedTexture::load(path, QSSGRenderTextureFormat::RGBA16F));
+        if (!theLoadedTexture)
+            qCWarning(WARNING, "Failed to load baked reflection probe: %s", qPrintable(path));
+        foundIt = imageMap.insert(imageKey, ImageData());
+        if (theLoadedTexture) {
+            if (!setRhiTexture(foundIt.value().renderImageTexture, theLoadedTexture.data(), MipModeDisable, CubeMap, path))
+                foundIt.value() = ImageData();
+            else if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
+                qDebug() << "+ uploadTexture: " << path << currentLayer;
+            result = foundIt.value().renderImageTexture;
+        }
+        increaseMemoryStat(result.m_texture);
+        Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DTextureLoad, stats.imageDataSize, path.toUtf8());
+    }
+    foundIt.value().usageCounts[currentLayer]++;
+    touchResidency(foundIt.value().residency);
     return result;
 }
 
@@ -513,45 +875,95 @@ static const float cube[] = {
     1.0f, 0.0f,
 };
 
-bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, QSSGRenderImageTexture *outTexture, const QString &debugObjectName)
+// The parameters of the prefiltering. Bump the CacheVersion in
+// qssgenvironmentmapcache.cpp when changing these, otherwise stale cached
+// files are picked up.
+static constexpr int EnvironmentMapMinSize = 512;
+static constexpr int EnvironmentMapMaxMipLevels = 6;
+static constexpr int EnvironmentMapSampleCount = 1024;
+
+// The stand-in while an environment map is prefiltered progressively. Few
+// samples are enough for a small map, the sampled mip level of the
+// intermediate cube map is selected based on the sample count.
+static constexpr int FallbackEnvironmentMapSize = 128;
+static constexpr int FallbackEnvironmentMapSampleCount = 64;
+
+// Holds the resources for creating an environment map, see
+// createEnvironmentMap(). The first phase, converting the equirectangular
+// texture to the intermediate cube map, is always recorded right away in
+// create(). The prefiltering into a target cube map can be recorded all at
+// once as well, or a few passes per frame.
+struct QSSGBufferManager::EnvironmentMapJob
 {
-    // The objective of this method is to take the equirectangular texture
-    // provided by inImage and create a cubeMap that contains both pre-filtered
-    // specular environment maps, as well as a irradiance map for diffuse
-    // operations.
-    // To achieve this though we first convert convert the Equirectangular texture
-    // to a cubeMap with genereated mip map levels (no filtering) to make the
-    // process of creating the prefiltered and irradiance maps eaiser. This
-    // intermediate texture as well as the original equirectangular texture are
-    // destroyed after this frame completes, and all further associations with
-    // the source lightProbe texture are instead associated with the final
-    // generated environment map.
-    // The intermediate environment cubemap is used to generate the final
-    // cubemap. This cubemap will generate 6 mip levels for each face
-    // (the remaining faces are unused).  This is what the contents of each
-    // face mip level looks like:
-    // 0: Pre-filtered with roughness 0 (basically unfiltered)
-    // 1: Pre-filtered with roughness 0.25
-    // 2: Pre-filtered with roughness 0.5
-    // 3: Pre-filtered with roughness 0.75
-    // 4: Pre-filtered with rougnness 1.0
-    // 5: Irradiance map (ideally at least 16x16)
-    // It would be better if we could use a separate cubemap for irradiance, but
-    // right now there is a 1:1 association between texture sources on the front-
-    // end and backend.
-    const auto &context = m_contextInterface->rhiContext();
+    struct Target
+    {
+        QRhiTexture *texture = nullptr;
+        int mipmapCount = 0;
+        QVarLengthArray<QSize, EnvironmentMapMaxMipLevels> mipLevelSizes;
+        QVarLengthArray<QRhiTextureRenderTarget *, EnvironmentMapMaxMipLevels * 6> renderTargets; // six faces per level
+        QRhiShaderResourceBindings *srb = nullptr;
+        QRhiGraphicsPipeline *pipeline = nullptr;
+        int ubufPrefilterElementSize = 0;
+        qsizetype nextPass = 0;
+
+        bool isDone() const { return nextPass >= renderTargets.size(); }
+    };
+
+    ~EnvironmentMapJob();
+
+    bool create(QSSGRenderContextInterface *contextInterface, const QSSGLoadedTexture *inImage, const QString &debugObjectName);
+    bool createTarget(Target &target, const QSize &size, int sampleCount, QRhiTexture::Flags extraFlags = {});
+    void render(Target &target, qsizetype maxPassCount = -1);
+    QRhiTexture *takeTexture(Target &target);
+
+    QSSGRenderContextInterface *contextInterface = nullptr;
+    QByteArray rtName;
+    bool isRGBE = false;
+    QRhiTexture::Format cubeTextureFormat = QRhiTexture::RGBA16F;
+    QSize environmentMapSize;
+    QRhiTexture *envCubeMap = nullptr;
+    QRhiSampler *envMapCubeSampler = nullptr;
+    QRhiBuffer *vertexBuffer = nullptr;
+    QRhiBuffer *uBuf = nullptr;
+    int ubufElementSize = 0;
+    QRhiVertexInputLayout inputLayout;
+    // Everything that is released together with the job, except for the
+    // target textures that are not taken
+    QVarLengthArray<QRhiResource *, 16> resources;
+
+    Target target;
+
+    // Progressive prefiltering only
+    QRhiTexture *fallbackTexture = nullptr;
+    QString cachePath;
+    quint32 lastRenderedFrame = 0;
+};
+
+QSSGBufferManager::EnvironmentMapJob::~EnvironmentMapJob()
+{
+    // The passes may still be in flight
+    for (QRhiResource *resource : std::as_const(resources))
+        resource->deleteLater();
+    if (target.texture)
+        target.texture->deleteLater();
+}
+
+bool QSSGBufferManager::EnvironmentMapJob::create(QSSGRenderContextInterface *ctx, const QSSGLoadedTexture *inImage, const QString &debugObjectName)
+{
+    contextInterface = ctx;
+    const auto &context = contextInterface->rhiContext();
     auto *rhi = context->rhi();
     // Right now minimum face size needs to be 512x512 to be able to have 6 reasonably sized mips
     int suggestedSize = inImage->height * 0.5f;
-    suggestedSize = qMax(512, suggestedSize);
-    const QSize environmentMapSize(suggestedSize, suggestedSize);
-    const bool isRGBE = inImage->format.format == QSSGRenderTextureFormat::Format::RGBE8;
+    suggestedSize = qMax(EnvironmentMapMinSize, suggestedSize);
+    environmentMapSize = QSize(suggestedSize, suggestedSize);
+    isRGBE = inImage->format.format == QSSGRenderTextureFormat::Format::RGBE8;
     const QRhiTexture::Format sourceTextureFormat = toRhiFormat(inImage->format.format);
     // Check if we can use the source texture at all
     if (!rhi->isTextureFormatSupported(sourceTextureFormat))
         return false;
 
-    QRhiTexture::Format cubeTextureFormat = inImage->format.isCompressedTextureFormat()
+    cubeTextureFormat = inImage->format.isCompressedTextureFormat()
             ? QRhiTexture::RGBA16F // let's just assume that if compressed textures are available, then it's at least a GLES 3.0 level API
             : sourceTextureFormat;
 #ifdef Q_OS_IOS
@@ -563,23 +975,15 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
     const int colorSpace = inImage->isSRGB ? 1 : 0; // 0 Linear | 1 sRGB
 
     // Phase 1: Convert the Equirectangular texture to a Cubemap
-    QRhiTexture *envCubeMap = rhi->newTexture(cubeTextureFormat, environmentMapSize, 1,
-                                              QRhiTexture::RenderTarget | QRhiTexture::CubeMap | QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips);
+    envCubeMap = rhi->newTexture(cubeTextureFormat, environmentMapSize, 1,
+                                 QRhiTexture::RenderTarget | QRhiTexture::CubeMap | QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips);
+    resources.append(envCubeMap);
     if (!envCubeMap->create()) {
         qWarning("Failed to create Environment Cube Map");
         return false;
     }
-    envCubeMap->deleteLater();
-
-    // Create a renderbuffer the size of a the cubeMap face
-    QRhiRenderBuffer *envMapRenderBuffer = rhi->newRenderBuffer(QRhiRenderBuffer::Color, environmentMapSize);
-    if (!envMapRenderBuffer->create()) {
-        qWarning("Failed to create Environment Map Render Buffer");
-        return false;
-    }
-    envMapRenderBuffer->deleteLater();
 
-    const QByteArray rtName = debugObjectName.toLatin1();
+    rtName = debugObjectName.toLatin1();
 
     // Setup the 6 render targets for each cube face
     QVarLengthArray<QRhiTextureRenderTarget *, 6> renderTargets;
@@ -592,26 +996,27 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
         auto renderTarget = rhi->newTextureRenderTarget(rtDesc);
         renderTarget->setName(rtName + QByteArrayLiteral(" env cube face: ") + QSSGBaseTypeHelpers::displayName(face));
         renderTarget->setDescription(rtDesc);
-        if (!renderPassDesc)
+        if (!renderPassDesc) {
             renderPassDesc = renderTarget->newCompatibleRenderPassDescriptor();
+            renderPassDesc->deleteLater();
+        }
         renderTarget->setRenderPassDescriptor(renderPassDesc);
+        renderTarget->deleteLater();
         if (!renderTarget->create()) {
             qWarning("Failed to build env map render target");
             return false;
         }
-        renderTarget->deleteLater();
         renderTargets << renderTarget;
     }
-    renderPassDesc->deleteLater();
 
     // Setup the sampler for reading the equirectangular loaded texture
     QSize size(inImage->width, inImage->height);
     auto *sourceTexture = rhi->newTexture(sourceTextureFormat, size, 1);
+    sourceTexture->deleteLater();
     if (!sourceTexture->create()) {
         qWarning("failed to create source env map texture");
         return false;
     }
-    sourceTexture->deleteLater();
 
     // Upload the equirectangular texture
     const auto desc = inImage->textureFileData.isValid()
@@ -633,20 +1038,20 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
     QRhiSampler *sampler = context->sampler(samplerDesc);
 
     // Load shader and setup render pipeline
-    const auto &shaderCache = m_contextInterface->shaderCache();
+    const auto &shaderCache = contextInterface->shaderCache();
     const auto &envMapShaderStages = shaderCache->getBuiltInRhiShaders().getRhiEnvironmentmapShader();
 
     // Vertex Buffer - Just a single cube that will be viewed from inside
-    QRhiBuffer *vertexBuffer = rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, sizeof(cube));
+    vertexBuffer = rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, sizeof(cube));
+    resources.append(vertexBuffer);
     vertexBuffer->create();
-    vertexBuffer->deleteLater();
     rub->uploadStaticBuffer(vertexBuffer, cube);
 
     // Uniform Buffer - 2x mat4
-    int ubufElementSize = rhi->ubufAligned(128);
-    QRhiBuffer *uBuf = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, ubufElementSize * 6);
+    ubufElementSize = rhi->ubufAligned(128);
+    uBuf = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, ubufElementSize * 6);
+    resources.append(uBuf);
     uBuf->create();
-    uBuf->deleteLater();
 
     int ubufEnvMapElementSize = rhi->ubufAligned(4);
     QRhiBuffer *uBufEnvMap = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, ubufEnvMapElementSize * 6);
@@ -672,7 +1077,6 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
                             *envMapShaderStages->fragmentStage()
                         });
 
-    QRhiVertexInputLayout inputLayout;
     inputLayout.setBindings({
                                 { 3 * sizeof(float) }
                             });
@@ -683,11 +1087,12 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
     envMapPipeline->setVertexInputLayout(inputLayout);
     envMapPipeline->setShaderResourceBindings(envMapSrb);
     envMapPipeline->setRenderPassDescriptor(renderPassDesc);
+    envMapPipeline->deleteLater();
     if (!envMapPipeline->create()) {
         qWarning("failed to create source env map pipeline state");
+        rub->release();
         return false;
     }
-    envMapPipeline->deleteLater();
 
     // Do the actual render passes
     auto *cb = context->commandBuffer();
@@ -758,27 +1163,47 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
         cb->resourceUpdate(rub);
     }
 
+    // Create a new Sampler
+    const QSSGRhiSamplerDescription samplerMipMapDesc {
+        QRhiSampler::Linear,
+        QRhiSampler::Linear,
+        QRhiSampler::Linear,
+        QRhiSampler::ClampToEdge,
+        QRhiSampler::ClampToEdge,
+        QRhiSampler::Repeat
+    };
+
+    // Only use mipmap interpoliation if not using RGBE
+    if (!isRGBE)
+        envMapCubeSampler = context->sampler(samplerMipMapDesc);
+    else
+        envMapCubeSampler = sampler;
+
+    return true;
+}
+
+bool QSSGBufferManager::EnvironmentMapJob::createTarget(Target &target, const QSize &size, int sampleCount, QRhiTexture::Flags extraFlags)
+{
     // Phase 2: Generate the pre-filtered environment cubemap
-    cb->debugMarkBegin("Pre-filtered Environment Cubemap Generation");
-    Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
-    Q_TRACE(QSSG_renderPass_entry, QStringLiteral("Pre-filtered Environment Cubemap Generation"));
-    QRhiTexture *preFilteredEnvCubeMap = rhi->newTexture(cubeTextureFormat, environmentMapSize, 1, QRhiTexture::RenderTarget | QRhiTexture::CubeMap| QRhiTexture::MipMapped);
+    const auto &context = contextInterface->rhiContext();
+    auto *rhi = context->rhi();
+    QRhiTexture *preFilteredEnvCubeMap = rhi->newTexture(cubeTextureFormat, size, 1,
+                                                         QRhiTexture::RenderTarget | QRhiTexture::CubeMap | QRhiTexture::MipMapped | extraFlags);
+    target.texture = preFilteredEnvCubeMap;
     if (!preFilteredEnvCubeMap->create())
         qWarning("Failed to create Pre-filtered Environment Cube Map");
     preFilteredEnvCubeMap->setName(rtName);
-    int mipmapCount = rhi->mipLevelsForSize(environmentMapSize);
-    mipmapCount = qMin(mipmapCount, 6);  // don't create more than 6 mip levels
-    QMap<int, QSize> mipLevelSizes;
-    QMap<int, QVarLengthArray<QRhiTextureRenderTarget *, 6>> renderTargetsMap;
+    int mipmapCount = rhi->mipLevelsForSize(size);
+    mipmapCount = qMin(mipmapCount, EnvironmentMapMaxMipLevels);  // don't create more than 6 mip levels
+    target.mipmapCount = mipmapCount;
     QRhiRenderPassDescriptor *renderPassDescriptorPhase2 = nullptr;
 
     // Create a renderbuffer for each mip level
     for (int mipLevel = 0; mipLevel < mipmapCount; ++mipLevel) {
-        const QSize levelSize = QSize(environmentMapSize.width() * std::pow(0.5, mipLevel),
-                                      environmentMapSize.height() * std::pow(0.5, mipLevel));
-        mipLevelSizes.insert(mipLevel, levelSize);
+        const QSize levelSize = QSize(size.width() * std::pow(0.5, mipLevel),
+                                      size.height() * std::pow(0.5, mipLevel));
+        target.mipLevelSizes.append(levelSize);
         // Setup Render targets (6 * mipmapCount)
-        QVarLengthArray<QRhiTextureRenderTarget *, 6> renderTargets;
         for (const auto face : QSSGRenderTextureCubeFaces) {
             QRhiColorAttachment att(preFilteredEnvCubeMap);
             att.setLayer(quint8(face));
@@ -789,38 +1214,22 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
             renderTarget->setName(rtName + QByteArrayLiteral(" env prefilter mip/face: ")
                                   + QByteArray::number(mipLevel) + QByteArrayLiteral("/") + QSSGBaseTypeHelpers::displayName(face));
             renderTarget->setDescription(rtDesc);
-            if (!renderPassDescriptorPhase2)
+            if (!renderPassDescriptorPhase2) {
                 renderPassDescriptorPhase2 = renderTarget->newCompatibleRenderPassDescriptor();
+                resources.append(renderPassDescriptorPhase2);
+            }
             renderTarget->setRenderPassDescriptor(renderPassDescriptorPhase2);
             if (!renderTarget->create())
                 qWarning("Failed to build prefilter env map render target");
-            renderTarget->deleteLater();
-            renderTargets << renderTarget;
+            resources.append(renderTarget);
+            target.renderTargets << renderTarget;
         }
-        renderTargetsMap.insert(mipLevel, renderTargets);
-        renderPassDescriptorPhase2->deleteLater();
     }
 
     // Load the prefilter shader stages
+    const auto &shaderCache = contextInterface->shaderCache();
     const auto &prefilterShaderStages = shaderCache->getBuiltInRhiShaders().getRhienvironmentmapPreFilterShader(isRGBE);
 
-    // Create a new Sampler
-    const QSSGRhiSamplerDescription samplerMipMapDesc {
-        QRhiSampler::Linear,
-        QRhiSampler::Linear,
-        QRhiSampler::Linear,
-        QRhiSampler::ClampToEdge,
-        QRhiSampler::ClampToEdge,
-        QRhiSampler::Repeat
-    };
-
-    QRhiSampler *envMapCubeSampler = nullptr;
-    // Only use mipmap interpoliation if not using RGBE
-    if (!isRGBE)
-        envMapCubeSampler = context->sampler(samplerMipMapDesc);
-    else
-        envMapCubeSampler = sampler;
-
     // Reuse Vertex Buffer from phase 1
     // Reuse UniformBuffer from phase 1 (for vertex shader)
 
@@ -831,10 +1240,11 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
     // int sampleCount;
     // int distribution;
 
-    int ubufPrefilterElementSize = rhi->ubufAligned(20);
+    const int ubufPrefilterElementSize = rhi->ubufAligned(20);
+    target.ubufPrefilterElementSize = ubufPrefilterElementSize;
     QRhiBuffer *uBufPrefilter = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, ubufPrefilterElementSize * mipmapCount);
+    resources.append(uBufPrefilter);
     uBufPrefilter->create();
-    uBufPrefilter->deleteLater();
 
     // Shader Resource Bindings
     QRhiShaderResourceBindings *preFilterSrb = rhi->newShaderResourceBindings();
@@ -843,8 +1253,9 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
                           QRhiShaderResourceBinding::uniformBufferWithDynamicOffset(2, QRhiShaderResourceBinding::FragmentStage, uBufPrefilter, 20),
                           QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage, envCubeMap, envMapCubeSampler)
                       });
+    resources.append(preFilterSrb);
     preFilterSrb->create();
-    preFilterSrb->deleteLater();
+    target.srb = preFilterSrb;
 
     // Pipeline
     QRhiGraphicsPipeline *prefilterPipeline = rhi->newGraphicsPipeline();
@@ -859,18 +1270,19 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
     prefilterPipeline->setVertexInputLayout(inputLayout);
     prefilterPipeline->setShaderResourceBindings(preFilterSrb);
     prefilterPipeline->setRenderPassDescriptor(renderPassDescriptorPhase2);
+    resources.append(prefilterPipeline);
     if (!prefilterPipeline->create()) {
         qWarning("failed to create pre-filter env map pipeline state");
         return false;
     }
-    prefilterPipeline->deleteLater();
+    target.pipeline = prefilterPipeline;
 
     // Uniform Data
     // set the roughness uniform buffer data
-    rub = rhi->nextResourceUpdateBatch();
+    auto *rub = rhi->nextResourceUpdateBatch();
+    // The resolution of the intermediate cube map that is sampled
     const float resolution = environmentMapSize.width();
     const float lodBias = 0.0f;
-    const int sampleCount = 1024;
     for (int mipLevel = 0; mipLevel < mipmapCount; ++mipLevel) {
         Q_ASSERT(mipmapCount - 2);
         const float roughness = float(mipLevel) / float(mipmapCount - 2);
@@ -882,41 +1294,193 @@ bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, Q
         rub->updateDynamicBuffer(uBufPrefilter, mipLevel * ubufPrefilterElementSize + 4 + 4 + 4 + 4, 4, &distribution);
     }
 
-    cb->resourceUpdate(rub);
+    context->commandBuffer()->resourceUpdate(rub);
+    return true;
+}
+
+void QSSGBufferManager::EnvironmentMapJob::render(Target &target, qsizetype maxPassCount)
+{
+    const auto &context = contextInterface->rhiContext();
+    auto *cb = context->commandBuffer();
+    const qsizetype endPass = maxPassCount < 0 ? target.renderTargets.size()
+                                               : qMin(target.renderTargets.size(), target.nextPass + maxPassCount);
+    if (target.nextPass >= endPass)
+        return;
+
+    cb->debugMarkBegin("Pre-filtered Environment Cubemap Generation");
+    Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
+    Q_TRACE(QSSG_renderPass_entry, QStringLiteral("Pre-filtered Environment Cubemap Generation"));
+    const QRhiCommandBuffer::VertexInput vbufBinding(vertexBuffer, 0);
 
     // Render
-    for (int mipLevel = 0; mipLevel < mipmapCount; ++mipLevel) {
-        for (const auto face : QSSGRenderTextureCubeFaces) {
-            cb->beginPass(renderTargetsMap[mipLevel][quint8(face)], QColor(0, 0, 0, 1), { 1.0f, 0 }, nullptr, context->commonPassFlags());
-            QSSGRHICTX_STAT(context, beginRenderPass(renderTargetsMap[mipLevel][quint8(face)]));
-            Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
-            cb->setGraphicsPipeline(prefilterPipeline);
-            cb->setVertexInput(0, 1, &vbufBinding);
-            cb->setViewport(QRhiViewport(0, 0, mipLevelSizes[mipLevel].width(), mipLevelSizes[mipLevel].height()));
-            QVector<QPair<int, quint32>> dynamicOffsets = {
-                { 0, quint32(ubufElementSize * quint8(face)) },
-                { 2, quint32(ubufPrefilterElementSize * mipLevel) }
-            };
-            Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderCall);
-
-            cb->setShaderResources(preFilterSrb, 2, dynamicOffsets.constData());
-            cb->draw(36);
-            QSSGRHICTX_STAT(context, draw(36, 1));
-            Q_QUICK3D_PROFILE_END_WITH_PAYLOAD(QQuick3DProfiler::Quick3DRenderCall, 36llu | (1llu << 32));
-            cb->endPass();
-            QSSGRHICTX_STAT(context, endRenderPass());
-            Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DRenderPass, 0, QSSG_RENDERPASS_NAME("environment_map", mipLevel, face));
-        }
+    for (; target.nextPass < endPass; ++target.nextPass) {
+        const int mipLevel = int(target.nextPass / 6);
+        const auto face = QSSGRenderTextureCubeFace(quint8(target.nextPass % 6));
+        QRhiTextureRenderTarget *renderTarget = target.renderTargets[target.nextPass];
+        cb->beginPass(renderTarget, QColor(0, 0, 0, 1), { 1.0f, 0 }, nullptr, context->commonPassFlags());
+        QSSGRHICTX_STAT(context, beginRenderPass(renderTarget));
+        Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
+        cb->setGraphicsPipeline(target.pipeline);
+        cb->setVertexInput(0, 1, &vbufBinding);
+        cb->setViewport(QRhiViewport(0, 0, target.mipLevelSizes[mipLevel].width(), target.mipLevelSizes[mipLevel].height()));
+        QVector<QPair<int, quint32>> dynamicOffsets = {
+            { 0, quint32(ubufElementSize * quint8(face)) },
+            { 2, quint32(target.ubufPrefilterElementSize * mipLevel) }
+        };
+        Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderCall);
+
+        cb->setShaderResources(target.srb, 2, dynamicOffsets.constData());
+        cb->draw(36);
+        QSSGRHICTX_STAT(context, draw(36, 1));
+        Q_QUICK3D_PROFILE_END_WITH_PAYLOAD(QQuick3DProfiler::Quick3DRenderCall, 36llu | (1llu << 32));
+        cb->endPass();
+        QSSGRHICTX_STAT(context, endRenderPass());
+        Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DRenderPass, 0, QSSG_RENDERPASS_NAME("environment_map", mipLevel, face));
     }
     cb->debugMarkEnd();
     Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DRenderPass, 0, QByteArrayLiteral("environment_cube_prefilter"));
     Q_TRACE(QSSG_renderPass_exit);
+}
+
+QRhiTexture *QSSGBufferManager::EnvironmentMapJob::takeTexture(Target &target)
+{
+    return std::exchange(target.texture, nullptr);
+}
 
-    outTexture->m_texture = preFilteredEnvCubeMap;
-    outTexture->m_mipmapCount = mipmapCount;
+bool QSSGBufferManager::createEnvironmentMap(const QSSGLoadedTexture *inImage, QSSGRenderImageTexture *outTexture, const QString &debugObjectName)
+{
+    // The objective of this method is to take the equirectangular texture
+    // provided by inImage and create a cubeMap that contains both pre-filtered
+    // specular environment maps, as well as a irradiance map for diffuse
+    // operations.
+    // To achieve this though we first convert convert the Equirectangular texture
+    // to a cubeMap with genereated mip map levels (no filtering) to make the
+    // process of creating the prefiltered and irradiance maps eaiser. This
+    // intermediate texture as well as the original equirectangular texture are
+    // destroyed after this frame completes, and all further associations with
+    // the source lightProbe texture are instead associated with the final
+    // generated environment map.
+    // The intermediate environment cubemap is used to generate the final
+    // cubemap. This cubemap will generate 6 mip levels for each face
+    // (the remaining faces are unused).  This is what the contents of each
+    // face mip level looks like:
+    // 0: Pre-filtered with roughness 0 (basically unfiltered)
+    // 1: Pre-filtered with roughness 0.25
+    // 2: Pre-filtered with roughness 0.5
+    // 3: Pre-filtered with roughness 0.75
+    // 4: Pre-filtered with rougnness 1.0
+    // 5: Irradiance map (ideally at least 16x16)
+    // It would be better if we could use a separate cubemap for irradiance, but
+    // right now there is a 1:1 association between texture sources on the front-
+    // end and backend.
+    EnvironmentMapJob job;
+    if (!job.create(m_contextInterface, inImage, debugObjectName))
+        return false;
+    // Keep it readable for the disk cache
+    const QRhiTexture::Flags extraFlags = QSSGEnvironmentMapCache::isEnabled() ? QRhiTexture::UsedAsTransferSource
+                                                                               : QRhiTexture::Flags();
+    if (!job.createTarget(job.target, job.environmentMapSize, EnvironmentMapSampleCount, extraFlags))
+        return false;
+    job.render(job.target);
+
+    outTexture->m_mipmapCount = job.target.mipmapCount;
+    outTexture->m_texture = job.takeTexture(job.target);
+    return true;
+}
+
+bool QSSGBufferManager::createEnvironmentMapProgressively(const ImageCacheKey &key,
+                                                          const QSSGLoadedTexture *inImage,
+                                                          QSSGRenderImageTexture *outTexture,
+                                                          const QString &debugObjectName,
+                                                          const QString &cachePath)
+{
+    // Like createEnvironmentMap(), but only a small, roughly prefiltered map
+    // is created right away. The full one is prefiltered a few passes per
+    // frame in advanceEnvironmentMapJob(), and replaces the small one once
+    // done. The intermediate cube map is shared, so the source is uploaded
+    // and converted only once.
+    auto job = std::make_unique<EnvironmentMapJob>();
+    if (!job->create(m_contextInterface, inImage, debugObjectName))
+        return false;
+
+    EnvironmentMapJob::Target fallback;
+    const QSize fallbackSize(FallbackEnvironmentMapSize, FallbackEnvironmentMapSize);
+    const bool fallbackCreated = job->createTarget(fallback, fallbackSize, FallbackEnvironmentMapSampleCount);
+    QRhiTexture *fallbackTexture = job->takeTexture(fallback);
+    if (!fallbackCreated) {
+        if (fallbackTexture)
+            fallbackTexture->deleteLater();
+        return false;
+    }
+    job->render(fallback);
+
+    const QRhiTexture::Flags extraFlags = cachePath.isEmpty() ? QRhiTexture::Flags() : QRhiTexture::UsedAsTransferSource;
+    if (!job->createTarget(job->target, job->environmentMapSize, EnvironmentMapSampleCount, extraFlags)) {
+        fallbackTexture->deleteLater();
+        return false;
+    }
+
+    if (inImage->format.format == QSSGRenderTextureFormat::Format::RGBE8)
+        outTexture->m_flags.setRgbe8(true);
+    if (!inImage->isSRGB)
+        outTexture->m_flags.setLinear(true);
+    outTexture->m_texture = fallbackTexture;
+    outTexture->m_mipmapCount = fallback.mipmapCount;
+    QSSGRhiContextPrivate::get(m_contextInterface->rhiContext().get())->registerTexture(fallbackTexture);
+
+    job->fallbackTexture = fallbackTexture;
+    job->cachePath = cachePath;
+    job->lastRenderedFrame = frameResetIndex;
+    releaseEnvironmentMapJob(key);
+    m_environmentMapJobs.insert(key, job.release());
     return true;
 }
 
+void QSSGBufferManager::advanceEnvironmentMapJob(const ImageCacheKey &key, ImageData &imageData)
+{
+    const auto it = m_environmentMapJobs.constFind(key);
+    if (it == m_environmentMapJobs.cend())
+        return;
+
+    EnvironmentMapJob *job = it.value();
+    // Once per frame, no matter how many layers use the light probe. The
+    // frame id is the one of the renderer, set in resetUsageCounters().
+    if (job->lastRenderedFrame == frameResetIndex)
+        return;
+    job->lastRenderedFrame = frameResetIndex;
+
+    job->render(job->target, m_environmentMapPassesPerFrame);
+    if (!job->target.isDone())
+        return;
+
+    // Swap the full environment map in for the fallback
+    QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(m_contextInterface->rhiContext().get());
+    QSSGRenderImageTexture &texture = imageData.renderImageTexture;
+    if (texture.m_texture == job->fallbackTexture) {
+        decreaseMemoryStat(texture.m_texture);
+        rhiCtxD->releaseTexture(texture.m_texture);
+        texture.m_mipmapCount = job->target.mipmapCount;
+        texture.m_texture = job->takeTexture(job->target);
+        rhiCtxD->registerTexture(texture.m_texture);
+        increaseMemoryStat(texture.m_texture);
+        if (!job->cachePath.isEmpty())
+            environmentMapCache()->store(m_contextInterface->rhiContext().get(), texture.m_texture, texture.m_mipmapCount, job->cachePath);
+    }
+    releaseEnvironmentMapJob(key);
+}
+
+void QSSGBufferManager::releaseEnvironmentMapJob(const ImageCacheKey &key)
+{
+    delete m_environmentMapJobs.take(key);
+}
+
+QSSGEnvironmentMapCache *QSSGBufferManager::environmentMapCache()
+{
+    if (!m_environmentMapCache)
+        m_environmentMapCache = std::make_unique<QSSGEnvironmentMapCache>();
+    return m_environmentMapCache.get();
+}
+
 bool QSSGBufferManager::setRhiTexture(QSSGRenderImageTexture &texture,
                                       const QSSGLoadedTexture *inTexture,
                                       MipMode inMipMode,
@@ -961,7 +1525,7 @@ bool QSSGBufferManager::setRhiTexture(QSSGRenderImageTexture &texture,
         if (inMipMode == MipModeBsdf && (inTexture->data || texFileData.isValid())) {
             // Before creating an environment map, check if the provided texture is a
             // pre-baked environment map
-            if (texFileData.isValid() && texFileData.keyValueMetadata().contains("QT_IBL_BAKER_VERSION")) {
+            if (isPrebakedEnvironmentMap(texFileData)) {
                 Q_ASSERT(texFileData.numFaces() == 6);
                 Q_ASSERT(texFileData.numLevels() >= 5);
 
@@ -1010,7 +1574,7 @@ bool QSSGBufferManager::setRhiTexture(QSSGRenderImageTexture &texture,
 
     // Update resources
     if (inMipMode == MipModeBsdf && (inTexture->data || texFileData.isValid())) {
-        if (texFileData.isValid() && texFileData.keyValueMetadata().contains("QT_IBL_BAKER_VERSION")) {
+        if (isPrebakedEnvironmentMap(texFileData)) {
             const int faceCount = texFileData.numFaces();
             for (int layer = 0; layer < faceCount; ++layer) {
                 for (int level = 0; level < mipmapCount; ++level) {
@@ -1037,15 +1601,22 @@ bool QSSGBufferManager::setRhiTexture(QSSGRenderImageTexture &texture,
         if (texFileData.numFaces() == 6 && inFlags.testFlag(CubeMap))
             numFaces = 6;
 
+        // Uncompressed rows in KTX files are padded to 4 bytes
+        const bool paddedRows = inTexture->format.format == QSSGRenderTextureFormat::R8;
         for (int level = 0; level < texFileData.numLevels(); ++level) {
             QRhiTextureSubresourceUploadDescription subDesc;
-            subDesc.setSourceSize(sizeForMipLevel(level, size));
+            const QSize levelSize = sizeForMipLevel(level, size);
+            subDesc.setSourceSize(levelSize);
+            if (paddedRows)
+                subDesc.setDataStride((levelSize.width() + 3) & ~3);
             for (int face = 0; face < numFaces; ++face) {
                 subDesc.setData(texFileData.getDataView(level, face).toByteArray());
                 textureUploads << QRhiTextureUploadEntry{ face, level, subDesc };
             }
         }
-        if (checkTransp) {
+        if (checkTransp && QSSGTextureCooker::isCooked(texFileData)) {
+            hasTransp = QSSGTextureCooker::hasAlpha(texFileData);
+        } else if (checkTransp) {
             auto glFormat = texFileData.glInternalFormat() ? texFileData.glInternalFormat() : texFileData.glFormat();
             hasTransp = !QSGCompressedTexture::formatIsOpaque(glFormat);
         }
@@ -1190,11 +1761,13 @@ QSSGBounds3 QSSGBufferManager::getModelBounds(const QSSGRenderModel *model) cons
     return retval;
 }
 
-QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh, const QString &debugObjectName)
+QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh, const QString &debugObjectName, bool allowPooling)
 {
     QSSGRenderMesh *newMesh = new QSSGRenderMesh(QSSGRenderDrawMode(mesh.drawMode()),
                                                  QSSGRenderWinding(mesh.winding()));
-    const QSSGMesh::Mesh::VertexBuffer vertexBuffer = mesh.vertexBuffer();
+    QSSGMesh::Mesh::VertexBuffer vertexBuffer = mesh.vertexBuffer();
+    if (!m_contextInterface->rhiContext()->rhi()->isFeatureSupported(QRhi::HalfAttributes))
+        vertexBuffer = expandHalfFloatAttributes(vertexBuffer);
     const QSSGMesh::Mesh::IndexBuffer indexBuffer = mesh.indexBuffer();
     const QSSGMesh::Mesh::TargetBuffer targetBuffer = mesh.targetBuffer();
 
@@ -1221,27 +1794,69 @@ QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh,
         QSSGRhiBufferPtr indexBuffer;
         QSSGRhiInputAssemblerState ia;
         QRhiTexture *targetsTexture = nullptr;
+        quint32 baseVertex = 0;
+        quint32 baseIndex = 0;
     } rhi;
 
     QRhiResourceUpdateBatch *rub = meshBufferUpdateBatch();
     const auto &context = m_contextInterface->rhiContext();
     QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(context.get());
-    rhi.vertexBuffer = std::make_shared<QSSGRhiBuffer>(*context.get(),
-                                                       QRhiBuffer::Static,
-                                                       QRhiBuffer::VertexBuffer,
-                                                       vertexBuffer.stride,
-                                                       vertexBuffer.data.size());
-    rhi.vertexBuffer->buffer()->setName(debugObjectName.toLatin1()); // this is what shows up in DebugView
-    rub->uploadStaticBuffer(rhi.vertexBuffer->buffer(), vertexBuffer.data);
 
-    if (!indexBuffer.data.isEmpty()) {
-        rhi.indexBuffer = std::make_shared<QSSGRhiBuffer>(*context.get(),
-                                                          QRhiBuffer::Static,
-                                                          QRhiBuffer::IndexBuffer,
-                                                          0,
-                                                          indexBuffer.data.size(),
-                                                          rhiIndexFormat);
-        rub->uploadStaticBuffer(rhi.indexBuffer->buffer(), indexBuffer.data);
+    // Skinned and morphed meshes may be animated by a compute pass, which
+    // reads the vertices as a storage buffer of their own.
+    bool hasJoints = false;
+    bool hasWeights = false;
+    for (const QSSGMesh::Mesh::VertexBufferEntry &entry : vertexBuffer.entries) {
+        hasJoints |= entry.name == QSSGMesh::MeshInternal::getJointAttrName();
+        hasWeights |= entry.name == QSSGMesh::MeshInternal::getWeightAttrName();
+    }
+    const bool storageVertexData = QSSGRhiSkinning::needsStorageVertexData(context->rhi(),
+                                                                          hasJoints && hasWeights,
+                                                                          !targetBuffer.data.isEmpty());
+
+    // Morph targets are looked up by the vertex index in the shader, which
+    // does not work with a base vertex, so such meshes are never pooled.
+    if (allowPooling && targetBuffer.data.isEmpty() && !storageVertexData && QSSGRhiMeshPool::isSupported(context->rhi())) {
+        QSSGRhiMeshPool *pool = rhiCtxD->meshPool();
+        newMesh->pooledVertexData = pool->allocateVertexData(vertexBuffer.stride, vertexBuffer.data, rub);
+        if (newMesh->pooledVertexData.isValid() && !indexBuffer.data.isEmpty()) {
+            newMesh->pooledIndexData = pool->allocateIndexData(rhiIndexFormat, indexBuffer.data, rub);
+            if (!newMesh->pooledIndexData.isValid()) {
+                // all or nothing
+                pool->release(newMesh->pooledVertexData);
+                newMesh->pooledVertexData = {};
+            }
+        }
+        if (newMesh->pooledVertexData.isValid()) {
+            rhi.vertexBuffer = newMesh->pooledVertexData.buffer;
+            rhi.baseVertex = newMesh->pooledVertexData.offset / vertexBuffer.stride;
+            if (newMesh->pooledIndexData.isValid()) {
+                rhi.indexBuffer = newMesh->pooledIndexData.buffer;
+                rhi.baseIndex = newMesh->pooledIndexData.offset
+                        / quint32(QSSGBaseTypeHelpers::getSizeOfType(indexBufComponentType));
+            }
+        }
+    }
+
+    if (!rhi.vertexBuffer) {
+        rhi.vertexBuffer = std::make_shared<QSSGRhiBuffer>(*context.get(),
+                                                           QRhiBuffer::Static,
+                                                           storageVertexData ? QRhiBuffer::VertexBuffer | QRhiBuffer::StorageBuffer
+                                                                             : QRhiBuffer::UsageFlags(QRhiBuffer::VertexBuffer),
+                                                           vertexBuffer.stride,
+                                                           vertexBuffer.data.size());
+        rhi.vertexBuffer->buffer()->setName(debugObjectName.toLatin1()); // this is what shows up in DebugView
+        rub->uploadStaticBuffer(rhi.vertexBuffer->buffer(), vertexBuffer.data);
+
+        if (!indexBuffer.data.isEmpty()) {
+            rhi.indexBuffer = std::make_shared<QSSGRhiBuffer>(*context.get(),
+                                                              QRhiBuffer::Static,
+                                                              QRhiBuffer::IndexBuffer,
+                                                              0,
+                                                              indexBuffer.data.size(),
+                                                              rhiIndexFormat);
+            rub->uploadStaticBuffer(rhi.indexBuffer->buffer(), indexBuffer.data);
+        }
     }
 
     if (!targetBuffer.data.isEmpty()) {
@@ -1359,9 +1974,12 @@ QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh,
         if (rhi.vertexBuffer) {
             subset.rhi.vertexBuffer = rhi.vertexBuffer;
             subset.rhi.ia = rhi.ia;
+            subset.rhi.baseVertex = rhi.baseVertex;
         }
-        if (rhi.indexBuffer)
+        if (rhi.indexBuffer) {
             subset.rhi.indexBuffer = rhi.indexBuffer;
+            subset.rhi.baseIndex = rhi.baseIndex;
+        }
         if (rhi.targetsTexture)
             subset.rhi.targetsTexture = rhi.targetsTexture;
 
@@ -1464,6 +2082,7 @@ void QSSGBufferManager::releaseImage(const ImageCacheKey &key)
                                                stats.imageDataSize, key.path.path().toUtf8());
         }
         imageMap.erase(imageItr);
+        releaseEnvironmentMapJob(key);
     }
 }
 
@@ -1484,12 +2103,29 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
         return true;
     };
 
+    // Unused resources holding GPU data are kept resident (and so can be
+    // revived without reloading) when there is a residency budget. Whether
+    // they actually stay depends on evictUnreferencedResources() below.
+    const bool keepResident = m_residencyBudget > 0;
+    auto retain = [keepResident](ResidencyInfo &residency, quint64 size) -> bool {
+        if (!keepResident || size == 0)
+            return false;
+        residency.cached = true;
+        return true;
+    };
+
     {
         QMutexLocker meshMutexLocker(&meshBufferMutex);
         // Meshes (by path)
-        auto meshIterator = meshMap.cbegin();
-        while (meshIterator != meshMap.cend()) {
+        auto meshIterator = meshMap.begin();
+        while (meshIterator != meshMap.end()) {
             if (isUnused(meshIterator.value().usageCounts)) {
+                // Meshes reaped due to incompatible processing options can never be hit again
+                const bool reaped = meshIterator.key().path().endsWith(u"@reaped");
+                if (!reaped && retain(meshIterator.value().residency, residentSize(meshIterator.value()))) {
+                    ++meshIterator;
+                    continue;
+                }
                 if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
                    qDebug() << "- releaseGeometry: " << meshIterator.key().path() << currentLayer;
                 decreaseMemoryStat(meshIterator.value().mesh);
@@ -1501,9 +2137,13 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
         }
 
         // Meshes (custom)
-        auto customMeshIterator = customMeshMap.cbegin();
-        while (customMeshIterator != customMeshMap.cend()) {
+        auto customMeshIterator = customMeshMap.begin();
+        while (customMeshIterator != customMeshMap.end()) {
             if (isUnused(customMeshIterator.value().usageCounts)) {
+                if (retain(customMeshIterator.value().residency, residentSize(customMeshIterator.value()))) {
+                    ++customMeshIterator;
+                    continue;
+                }
                 if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
                    qDebug() << "- releaseGeometry: " << customMeshIterator.key() << currentLayer;
                 decreaseMemoryStat(customMeshIterator.value().mesh);
@@ -1529,9 +2169,13 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
     }
 
     // Images
-    auto imageKeyIterator = imageMap.cbegin();
-    while (imageKeyIterator != imageMap.cend()) {
+    auto imageKeyIterator = imageMap.begin();
+    while (imageKeyIterator != imageMap.end()) {
         if (isUnused(imageKeyIterator.value().usageCounts)) {
+            if (retain(imageKeyIterator.value().residency, residentSize(imageKeyIterator.value()))) {
+                ++imageKeyIterator;
+                continue;
+            }
             auto rhiTexture = imageKeyIterator.value().renderImageTexture.m_texture;
             if (rhiTexture) {
                 if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
@@ -1539,6 +2183,7 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
                 decreaseMemoryStat(rhiTexture);
                 rhiCtxD->releaseTexture(rhiTexture);
             }
+            releaseEnvironmentMapJob(imageKeyIterator.key());
             imageKeyIterator = imageMap.erase(imageKeyIterator);
         } else {
             ++imageKeyIterator;
@@ -1546,9 +2191,13 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
     }
 
     // Custom Texture Data
-    auto textureDataIterator = customTextureMap.cbegin();
-    while (textureDataIterator != customTextureMap.cend()) {
+    auto textureDataIterator = customTextureMap.begin();
+    while (textureDataIterator != customTextureMap.end()) {
         if (isUnused(textureDataIterator.value().usageCounts)) {
+            if (retain(textureDataIterator.value().residency, residentSize(textureDataIterator.value()))) {
+                ++textureDataIterator;
+                continue;
+            }
             auto rhiTexture = textureDataIterator.value().renderImageTexture.m_texture;
             if (rhiTexture) {
                 if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
@@ -1579,6 +2228,18 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
         }
     }
 
+    if (keepResident)
+        evictUnreferencedResources();
+    updateResidencyStats();
+
+    if (rhiCtxD->m_meshPool) {
+        const QSSGRhiMeshPool::Stats poolStats = rhiCtxD->m_meshPool->stats();
+        QSSGRhiContextStats::get(*m_contextInterface->rhiContext()).meshPoolStatsChanged(poolStats.bufferCount,
+                                                                                          poolStats.allocationCount,
+                                                                                          poolStats.reservedSize,
+                                                                                          poolStats.usedSize);
+    }
+
     // Resource Tracking Debug Code
     frameCleanupIndex = frameId;
     if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Usage)) {
@@ -1589,9 +2250,119 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
         qDebug() << "Textures(qsg):     " << qsgImageMap.count();
         qDebug() << "Geometry(by path): " << meshMap.count();
         qDebug() << "Geometry(custom):  " << customMeshMap.count();
+        qDebug() << "Resident(unused):  " << m_residencyStats.cachedCount << m_residencyStats.cachedSize << "bytes";
     }
 }
 
+void QSSGBufferManager::evictUnreferencedResources()
+{
+    quint64 totalSize = stats.meshDataSize + stats.imageDataSize;
+    if (totalSize <= m_residencyBudget)
+        return;
+
+    enum class Kind : quint8 { Mesh, CustomMesh, Image, CustomTexture };
+    struct Candidate {
+        quint64 lastUsed;
+        quint64 size;
+        Kind kind;
+        const void *key;
+    };
+
+    // The keys are pointers into the hashes, which stay valid as the
+    // candidates are only collected here and nothing is inserted before they
+    // are consumed.
+    QVarLengthArray<Candidate, 64> candidates;
+    for (auto it = meshMap.cbegin(), end = meshMap.cend(); it != end; ++it) {
+        if (it->residency.cached)
+            candidates.append({ it->residency.lastUsed, residentSize(it.value()), Kind::Mesh, &it.key() });
+    }
+    for (auto it = customMeshMap.cbegin(), end = customMeshMap.cend(); it != end; ++it) {
+        if (it->residency.cached)
+            candidates.append({ it->residency.lastUsed, residentSize(it.value()), Kind::CustomMesh, &it.key() });
+    }
+    for (auto it = imageMap.cbegin(), end = imageMap.cend(); it != end; ++it) {
+        if (it->residency.cached)
+            candidates.append({ it->residency.lastUsed, residentSize(it.value()), Kind::Image, &it.key() });
+    }
+    for (auto it = customTextureMap.cbegin(), end = customTextureMap.cend(); it != end; ++it) {
+        if (it->residency.cached)
+            candidates.append({ it->residency.lastUsed, residentSize(it.value()), Kind::CustomTexture, &it.key() });
+    }
+
+    // Least recently used first
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        return a.lastUsed < b.lastUsed;
+    });
+
+    // Collect first, then release, since releasing invalidates the keys
+    QVarLengthArray<QSSGRenderPath, 16> meshes;
+    QVarLengthArray<QSSGRenderGeometry *, 16> customMeshes;
+    QVarLengthArray<ImageCacheKey, 16> images;
+    QVarLengthArray<CustomImageCacheKey, 16> customTextures;
+    for (const Candidate &c : std::as_const(candidates)) {
+        if (totalSize <= m_residencyBudget)
+            break;
+        switch (c.kind) {
+        case Kind::Mesh:
+            meshes.append(*static_cast<const QSSGRenderPath *>(c.key));
+            break;
+        case Kind::CustomMesh:
+            customMeshes.append(*static_cast<QSSGRenderGeometry * const *>(c.key));
+            break;
+        case Kind::Image:
+            images.append(*static_cast<const ImageCacheKey *>(c.key));
+            break;
+        case Kind::CustomTexture:
+            customTextures.append(*static_cast<const CustomImageCacheKey *>(c.key));
+            break;
+        }
+        totalSize -= qMin(totalSize, c.size);
+        ++m_residencyStats.evictions;
+    }
+
+    if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug)) {
+        qDebug() << "- evict (residency budget" << m_residencyBudget << "):"
+                 << meshes.size() + customMeshes.size() << "meshes,"
+                 << images.size() + customTextures.size() << "textures";
+    }
+
+    for (const QSSGRenderPath &path : std::as_const(meshes))
+        releaseMesh(path);
+    for (QSSGRenderGeometry *geometry : std::as_const(customMeshes))
+        releaseGeometry(geometry);
+    for (const ImageCacheKey &key : std::as_const(images))
+        releaseImage(key);
+    for (const CustomImageCacheKey &key : std::as_const(customTextures))
+        releaseTextureData(key);
+}
+
+void QSSGBufferManager::updateResidencyStats()
+{
+    m_residencyStats.cachedSize = 0;
+    m_residencyStats.cachedCount = 0;
+    if (m_residencyBudget > 0) {
+        auto accumulate = [this](const auto &map) {
+            for (const auto &data : map) {
+                if (data.residency.cached) {
+                    m_residencyStats.cachedSize += residentSize(data);
+                    ++m_residencyStats.cachedCount;
+                }
+            }
+        };
+        accumulate(meshMap);
+        accumulate(customMeshMap);
+        accumulate(imageMap);
+        accumulate(customTextureMap);
+    }
+
+    QSSGRhiContextStats::get(*m_contextInterface->rhiContext()).residencyStatsChanged(m_residencyStats.hits,
+                                                                                       m_residencyStats.misses,
+                                                                                       m_residencyStats.evictions,
+                                                                                       m_residencyStats.cachedSize);
+    QSSGRhiContextStats::get(*m_contextInterface->rhiContext()).geometryUploadStatsChanged(m_geometryUploadStats.uploadedSize,
+                                                                                            m_geometryUploadStats.partialUpdates);
+}
+
 void QSSGBufferManager::resetUsageCounters(quint32 frameId, QSSGRenderLayer *layer)
 {
     currentLayer = layer;
@@ -1625,6 +2396,7 @@ void QSSGBufferManager::resetUsageCounters(quint32 frameId, QSSGRenderLayer *lay
         retData.usageCounts[layer] = uint32_t(hasTexture) * 1;
     }
 
+    ++m_residencySerial;
     frameResetIndex = frameId;
 }
 
@@ -1654,6 +2426,7 @@ QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(const QSSGRenderPath &inMeshPa
     if (meshItr != meshMap.cend()) {
         if (options.isCompatible(meshItr.value().options)) {
             meshItr.value().usageCounts[currentLayer]++;
+            touchResidency(meshItr.value().residency);
             return meshItr.value().mesh;
         } else {
             // Re-Insert the mesh with a new name and a "zero" usage count, this will cause the
@@ -1664,8 +2437,11 @@ QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(const QSSGRenderPath &inMeshPa
         }
     }
 
+    ++m_residencyStats.misses;
     Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DMeshLoad);
     Q_TRACE_SCOPE(QSSG_meshLoadPath, inMeshPath.path());
+    QElapsedTimer loadTimer;
+    loadTimer.start();
 
     QSSGMesh::Mesh result;
     QString resultSourcePath;
@@ -1701,11 +2477,16 @@ QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(const QSSGRenderPath &inMeshPa
         result.createLightmapUVChannel(options.lightmapBaseResolution);
     }
 
-    auto ret = createRenderMesh(result, QFileInfo(resultSourcePath).fileName());
-    meshMap.insert(inMeshPath, { ret, {{currentLayer, 1}}, 0, options });
+    auto ret = createRenderMesh(result, QFileInfo(resultSourcePath).fileName(), m_meshBufferPooling);
+    meshMap.insert(inMeshPath, { ret, {{currentLayer, 1}}, 0, options, { m_residencySerial, false } });
     QSSGRhiContextPrivate *rhiCtxD = QSSGRhiContextPrivate::get(m_contextInterface->rhiContext().get());
     rhiCtxD->registerMesh(ret);
     increaseMemoryStat(ret);
+    QSSGRHICTX_STAT(m_contextInterface->rhiContext().get(),
+                    expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::MeshUpload,
+                                   inMeshPath.path().toUtf8(),
+                                   loadTimer.nsecsElapsed(),
+                                   meshMemorySize(ret)));
     Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DMeshLoad,
                                        stats.meshDataSize, inMeshPath.path().toUtf8());
     return ret;
@@ -1718,18 +2499,25 @@ QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(QSSGRenderGeometry *geometry,
     auto meshIterator = customMeshMap.find(geometry);
     if (meshIterator == customMeshMap.end()) {
         meshIterator = customMeshMap.insert(geometry, MeshData());
-    } else if (geometry->generationId() != meshIterator->generationId || !options.isCompatible(meshIterator->options)) {
+    } else if (geometry->generationId() != meshIterator->generationId
+               || !options.isCompatible(meshIterator->options)
+               || !updateRenderMeshData(geometry, meshIterator.value())) {
         // Release old data
         releaseGeometry(geometry);
         meshIterator = customMeshMap.insert(geometry, MeshData());
     } else {
         // An up-to-date mesh was found
         meshIterator.value().usageCounts[currentLayer]++;
+        touchResidency(meshIterator.value().residency);
         return meshIterator.value().mesh;
     }
 
+    ++m_residencyStats.misses;
+
     Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DCustomMeshLoad);
     Q_TRACE_SCOPE(QSSG_customMeshLoad);
+    QElapsedTimer loadTimer;
+    loadTimer.start();
 
     if (!geometry->meshData().m_vertexBuffer.isEmpty()) {
         // Mesh data needs to be loaded
@@ -1747,20 +2535,82 @@ QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(QSSGRenderGeometry *geometry,
             meshIterator->mesh = createRenderMesh(mesh, geometry->debugObjectName);
             meshIterator->usageCounts[currentLayer] = 1;
             meshIterator->generationId = geometry->generationId();
+            meshIterator->dataGenerationId = geometry->dataGenerationId();
+            m_geometryUploadStats.uploadedSize += mesh.vertexBuffer().data.size() + mesh.indexBuffer().data.size();
             meshIterator->options = options;
+            meshIterator->residency.lastUsed = m_residencySerial;
             rhiCtxD->registerMesh(meshIterator->mesh);
             increaseMemoryStat(meshIterator->mesh);
+            QSSGRHICTX_STAT(m_contextInterface->rhiContext().get(),
+                            expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::MeshUpload,
+                                           geometry->debugObjectName.toUtf8(),
+                                           loadTimer.nsecsElapsed(),
+                                           meshMemorySize(meshIterator->mesh)));
         } else {
             qWarning("Mesh building failed: %s", qPrintable(error));
         }
     }
     // else an empty mesh is not an error, leave the QSSGRenderMesh null, it will not be rendered then
 
+    // Whatever was changed partially is part of the data uploaded above
+    geometry->clearDirtyRanges();
+
     Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DCustomMeshLoad,
                                        stats.meshDataSize, geometry->profilingId);
     return meshIterator->mesh;
 }
 
+// Uploads only the ranges of the vertex and index data that were changed with
+// the partial update functions of QQuick3DGeometry, keeping the existing
+// buffers. Returns false when the mesh has to be rebuilt instead.
+bool QSSGBufferManager::updateRenderMeshData(QSSGRenderGeometry *geometry, MeshData &meshData)
+{
+    if (geometry->dataGenerationId() == meshData.dataGenerationId)
+        return true;
+
+    QSSGRenderMesh *mesh = meshData.mesh;
+    // The generated lightmap UV channel changes the layout (and possibly the
+    // number) of the vertices, the ranges do not map to the buffer then.
+    if (!mesh || mesh->subsets.isEmpty() || meshData.options.wantsLightmapUVs)
+        return false;
+
+    const QSSGRhiBuffer *vertexBuffer = mesh->subsets.first().rhi.vertexBuffer.get();
+    const QSSGRhiBuffer *indexBuffer = mesh->subsets.first().rhi.indexBuffer.get();
+    const QByteArray &vertexData = geometry->vertexBuffer();
+    const QByteArray &indexData = geometry->indexBuffer();
+    if (!vertexBuffer || quint32(vertexBuffer->buffer()->size()) != quint32(vertexData.size()))
+        return false;
+    if (!geometry->dirtyIndexRanges().isEmpty()
+            && (!indexBuffer || quint32(indexBuffer->buffer()->size()) != quint32(indexData.size())))
+        return false;
+
+    if (QSSGBufferManagerStat::enabled(QSSGBufferManagerStat::Level::Debug))
+        qDebug() << "+ updateGeometry: " << geometry << currentLayer;
+
+    QRhiResourceUpdateBatch *rub = meshBufferUpdateBatch();
+    for (const QSSGRenderGeometry::DirtyRange &range : geometry->dirtyVertexRanges()) {
+        rub->uploadStaticBuffer(vertexBuffer->buffer(), range.offset, range.size, vertexData.constData() + range.offset);
+        m_geometryUploadStats.uploadedSize += range.size;
+    }
+    for (const QSSGRenderGeometry::DirtyRange &range : geometry->dirtyIndexRanges()) {
+        rub->uploadStaticBuffer(indexBuffer->buffer(), range.offset, range.size, indexData.constData() + range.offset);
+        m_geometryUploadStats.uploadedSize += range.size;
+    }
+    ++m_geometryUploadStats.partialUpdates;
+
+    // The picking data was built from the old vertices, generate it again
+    // when needed.
+    if (mesh->bvh) {
+        mesh->bvh.reset();
+        for (QSSGRenderSubset &subset : mesh->subsets)
+            subset.bvhRoot = {};
+    }
+
+    geometry->clearDirtyRanges();
+    meshData.dataGenerationId = geometry->dataGenerationId();
+    return true;
+}
+
 std::unique_ptr<QSSGMeshBVH> QSSGBufferManager::loadMeshBVH(const QSSGRenderPath &inSourcePath)
 {
     const QSSGMesh::Mesh mesh = loadMeshData(inSourcePath);
@@ -1786,6 +2636,7 @@ std::unique_ptr<QSSGMeshBVH> QSSGBufferManager::loadMeshBVH(QSSGRenderGeometry *
     QSSGRenderComponentType indexBufferFormat = QSSGRenderComponentType::Int32;
     bool hasUV = false;
     int uvOffset = -1;
+    QSSGRenderComponentType uvComponentType = QSSGRenderComponentType::Float32;
     int posOffset = -1;
 
     for (int i = 0; i < geometry->attributeCount(); ++i) {
@@ -1795,9 +2646,11 @@ std::unique_ptr<QSSGMeshBVH> QSSGBufferManager::loadMeshBVH(QSSGRenderGeometry *
         } else if (attribute.semantic == QSSGMesh::RuntimeMeshData::Attribute::TexCoord0Semantic) {
             hasUV = true;
             uvOffset = attribute.offset;
+            uvComponentType = QSSGRenderComponentType(attribute.componentType);
         } else if (!hasUV && attribute.semantic == QSSGMesh::RuntimeMeshData::Attribute::TexCoord1Semantic) {
             hasUV = true;
             uvOffset = attribute.offset;
+            uvComponentType = QSSGRenderComponentType(attribute.componentType);
         } else if (attribute.semantic == QSSGMesh::RuntimeMeshData::Attribute::IndexSemantic) {
             hasIndexBuffer = true;
             if (attribute.componentType == QSSGMesh::Mesh::ComponentType::Int16)
@@ -1814,7 +2667,8 @@ std::unique_ptr<QSSGMeshBVH> QSSGBufferManager::loadMeshBVH(QSSGRenderGeometry *
                                       uvOffset,
                                       hasIndexBuffer,
                                       geometry->indexBuffer(),
-                                      indexBufferFormat);
+                                      indexBufferFormat,
+                                      uvComponentType);
     return meshBVHBuilder.buildTree();
 }
 
@@ -1936,6 +2790,8 @@ void QSSGBufferManager::clear()
         releaseImage(it.key());
 
     imageMap.clear();
+    qDeleteAll(m_environmentMapJobs);
+    m_environmentMapJobs.clear();
 
     // Textures (custom)
     for (auto it = customTextureMap.cbegin(), end = customTextureMap.cend(); it != end; ++it)
@@ -1980,75 +2836,6 @@ void QSSGBufferManager::processResourceLoader(const QSSGRenderResourceLoader *lo
     commitBufferResourceUpdates();
 }
 
-static inline quint64 textureMemorySize(QRhiTexture *texture)
-{
-    quint64 s = 0;
-    if (!texture)
-        return s;
-
-    auto format = texture->format();
-    if (format == QRhiTexture::UnknownFormat)
-        return 0;
-
-    s = texture->pixelSize().width() * texture->pixelSize().height();
-    /*
-        UnknownFormat,
-        RGBA8,
-        BGRA8,
-        R8,
-        RG8,
-        R16,
-        RG16,
-        RED_OR_ALPHA8,
-        RGBA16F,
-        RGBA32F,
-        R16F,
-        R32F,
-        RGB10A2,
-        R8UI,
-        D16,
-        D24,
-        D24S8,
-        D32F,
-        D32FS8*/
-    static const quint64 pixelSizes[] = {0, 4, 4, 1, 2, 2, 4, 1, 2, 4, 2, 4, 4, 1, 2, 4, 4, 4, 8};
-    /*
-        BC1,
-        BC2,
-        BC3,
-        BC4,
-        BC5,
-        BC6H,
-        BC7,
-        ETC2_RGB8,
-        ETC2_RGB8A1,
-        ETC2_RGBA8,*/
-    static const quint64 blockSizes[] = {8, 16, 16, 8, 16, 16, 16, 8, 8, 16};
-    Q_STATIC_ASSERT_X(QRhiTexture::BC1 == 19 && QRhiTexture::ETC2_RGBA8 == 28,
-                      "QRhiTexture format constant value missmatch.");
-    if (format < QRhiTexture::BC1)
-        s *= pixelSizes[format];
-    else if (format >= QRhiTexture::BC1 && format <= QRhiTexture::ETC2_RGBA8)
-        s /= blockSizes[format - QRhiTexture::BC1];
-    else
-        s /= 16;
-
-    if (texture->flags() & QRhiTexture::MipMapped)
-        s += s / 4;
-    if (texture->flags() & QRhiTexture::CubeMap)
-        s *= 6;
-    return s;
-}
-
-static inline quint64 bufferMemorySize(const QSSGRhiBufferPtr &buffer)
-{
-    quint64 s = 0;
-    if (!buffer)
-        return s;
-    s = buffer->buffer()->size();
-    return s;
-}
-
 void QSSGBufferManager::increaseMemoryStat(QRhiTexture *texture)
 {
     stats.imageDataSize += textureMemorySize(texture);
@@ -2063,17 +2850,13 @@ void QSSGBufferManager::decreaseMemoryStat(QRhiTexture *texture)
 
 void QSSGBufferManager::increaseMemoryStat(QSSGRenderMesh *mesh)
 {
-    stats.meshDataSize += bufferMemorySize(mesh->subsets.at(0).rhi.vertexBuffer)
-            + bufferMemorySize(mesh->subsets.at(0).rhi.indexBuffer);
+    stats.meshDataSize += meshMemorySize(mesh);
     QSSGRhiContextStats::get(*m_contextInterface->rhiContext()).meshDataSizeChanges(stats.meshDataSize);
 }
 
 void QSSGBufferManager::decreaseMemoryStat(QSSGRenderMesh *mesh)
 {
-    quint64 s = 0;
-    if (mesh)
-    s = bufferMemorySize(mesh->subsets.at(0).rhi.vertexBuffer)
-            + bufferMemorySize(mesh->subsets.at(0).rhi.indexBuffer);
+    const quint64 s = meshMemorySize(mesh);
     stats.meshDataSize = qMax(0u, stats.meshDataSize - s);
     QSSGRhiContextStats::get(*m_contextInterface->rhiContext()).meshDataSizeChanges(stats.meshDataSize);
 }
@@ -53,6 +53,7 @@ struct QSSGRenderSkin;
 
 class QSSGRenderContextInterface;
 class QQuick3DRenderExtension;
+class QSSGEnvironmentMapCache;
 
 struct QSSGMeshProcessingOptions
 {
@@ -104,17 +105,28 @@ public:
         MipMode mipMode;
     };
 
+    // Bookkeeping for resources that are no longer referenced by any layer
+    // but are kept alive (resident) until the residency budget is exceeded.
+    struct ResidencyInfo {
+        quint64 lastUsed = 0; // residency serial of the last frame the resource was used in
+        bool cached = false;  // true while unreferenced but still resident
+    };
+
     struct ImageData {
         QSSGRenderImageTexture renderImageTexture;
         QHash<QSSGRenderLayer*, uint32_t> usageCounts;
         uint32_t version = 0;
+        uint32_t updateVersion = 0; // QSSGRenderTextureData only
+        ResidencyInfo residency;
     };
 
     struct MeshData {
         QSSGRenderMesh *mesh = nullptr;
         QHash<QSSGRenderLayer*, uint32_t> usageCounts;
         uint32_t generationId = 0;
+        uint32_t dataGenerationId = 0; // QSSGRenderGeometry only
         QSSGMeshProcessingOptions options;
+        ResidencyInfo residency;
     };
 
     struct MemoryStats {
@@ -122,12 +134,55 @@ public:
         quint64 imageDataSize = 0;
     };
 
+    struct ResidencyStats {
+        quint64 hits = 0;        // unreferenced resources revived without reloading
+        quint64 misses = 0;      // resources that had to be (re)loaded
+        quint64 evictions = 0;   // unreferenced resources released due to the budget
+        quint64 cachedSize = 0;  // bytes held by unreferenced, resident resources
+        qsizetype cachedCount = 0;
+    };
+
+    // For custom geometry and texture data
+    struct UploadStats {
+        quint64 uploadedSize = 0;    // bytes of data uploaded
+        quint64 partialUpdates = 0;  // updates that only uploaded the changed parts
+    };
+
     QSSGBufferManager();
     ~QSSGBufferManager();
 
     void setRenderContextInterface(QSSGRenderContextInterface *ctx);
 
     void releaseCachedResources();
+
+    // The residency budget (in bytes) is the amount of mesh and texture data
+    // that is allowed to stay resident. Resources that are no longer
+    // referenced are only released when the total exceeds the budget, in
+    // least recently used order. A budget of 0 (the default) releases
+    // unreferenced resources right away.
+    void setResidencyBudget(quint64 budget);
+    quint64 residencyBudget() const { return m_residencyBudget; }
+    const ResidencyStats &residencyStats() const { return m_residencyStats; }
+    const UploadStats &geometryUploadStats() const { return m_geometryUploadStats; }
+    const UploadStats &textureDataUploadStats() const { return m_textureDataUploadStats; }
+
+    // When enabled, the vertex and index data of meshes loaded from files is
+    // sub-allocated from large, shared buffers (see QSSGRhiMeshPool) instead
+    // of getting dedicated buffers. Only affects meshes loaded afterwards.
+    void setMeshBufferPoolingEnabled(bool enable) { m_meshBufferPooling = enable; }
+    bool isMeshBufferPoolingEnabled() const { return m_meshBufferPooling; }
+
+    // When enabled, light probes that are not prefiltered yet (see
+    // QSSGEnvironmentMapCache) get a small, roughly prefiltered environment
+    // map right away, while the full one is prefiltered a few passes per
+    // frame and replaces the small one once done. This bounds the time the
+    // first frame using a light probe takes. Only affects light probes loaded
+    // afterwards.
+    void setProgressiveEnvironmentMapsEnabled(bool enable) { m_progressiveEnvironmentMaps = enable; }
+    bool isProgressiveEnvironmentMapsEnabled() const { return m_progressiveEnvironmentMaps; }
+    // Light probes whose full environment map is still being prefiltered
+    qsizetype pendingEnvironmentMapCount() const { return m_environmentMapJobs.size(); }
+
     // called on the destuction of a layer to release its referenced resources
     void releaseResourcesForLayer(QSSGRenderLayer *layer);
 
@@ -135,6 +190,9 @@ public:
                                            MipMode inMipMode = MipModeFollowRenderImage,
                                            LoadRenderImageFlags flags = LoadWithFlippedY);
     QSSGRenderImageTexture loadLightmap(const QSSGRenderModel &model);
+    // A prefiltered reflection probe cube map written by QSSGReflectionProbeBaker.
+    // Returns an empty texture, without a warning, when the file does not exist.
+    QSSGRenderImageTexture loadBakedReflectionMap(const QString &path);
     QSSGRenderImageTexture loadSkinmap(QSSGRenderTextureData *skin);
 
     QSSGRenderMesh *getMeshForPicking(const QSSGRenderModel &model) const;
@@ -204,14 +262,29 @@ private:
 
     QSSGRenderMesh *loadRenderMesh(const QSSGRenderPath &inSourcePath, QSSGMeshProcessingOptions options);
     QSSGRenderMesh *loadRenderMesh(QSSGRenderGeometry *geometry, QSSGMeshProcessingOptions options);
+    bool updateRenderMeshData(QSSGRenderGeometry *geometry, MeshData &meshData);
 
-    QSSGRenderMesh *createRenderMesh(const QSSGMesh::Mesh &mesh, const QString &debugObjectName = {});
+    QSSGRenderMesh *createRenderMesh(const QSSGMesh::Mesh &mesh, const QString &debugObjectName = {}, bool allowPooling = false);
     QSSGRenderImageTexture loadTextureData(QSSGRenderTextureData *data, MipMode inMipMode);
+    bool updateTextureDataRegions(QSSGRenderTextureData *data, ImageData &imageData);
+    struct EnvironmentMapJob;
     bool createEnvironmentMap(const QSSGLoadedTexture *inImage, QSSGRenderImageTexture *outTexture, const QString &debugObjectName);
+    bool createEnvironmentMapProgressively(const ImageCacheKey &key,
+                                           const QSSGLoadedTexture *inImage,
+                                           QSSGRenderImageTexture *outTexture,
+                                           const QString &debugObjectName,
+                                           const QString &cachePath);
+    void advanceEnvironmentMapJob(const ImageCacheKey &key, ImageData &imageData);
+    void releaseEnvironmentMapJob(const ImageCacheKey &key);
+    QSSGEnvironmentMapCache *environmentMapCache();
 
     void releaseMesh(const QSSGRenderPath &inSourcePath);
     void releaseImage(const ImageCacheKey &key);
 
+    void touchResidency(ResidencyInfo &residency);
+    void evictUnreferencedResources();
+    void updateResidencyStats();
+
     QSSGRenderContextInterface *m_contextInterface = nullptr; // ContextInterfaces owns BufferManager
 
     // These store the actual buffer handles
@@ -229,6 +302,17 @@ private:
     quint32 frameResetIndex = 0;
     QSSGRenderLayer *currentLayer = nullptr;
     MemoryStats stats;
+
+    quint64 m_residencyBudget = 0;
+    quint64 m_residencySerial = 0;
+    ResidencyStats m_residencyStats;
+    UploadStats m_geometryUploadStats;
+    UploadStats m_textureDataUploadStats;
+    bool m_meshBufferPooling = false;
+    bool m_progressiveEnvironmentMaps = false;
+    int m_environmentMapPassesPerFrame = 6;
+    QHash<ImageCacheKey, EnvironmentMapJob *> m_environmentMapJobs; // light probes prefiltered progressively
+    std::unique_ptr<QSSGEnvironmentMapCache> m_environmentMapCache;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QSSGBufferManager::LoadRenderImageFlags)
@@ -6,6 +6,7 @@
 #include <QtQuick3DRuntimeRender/private/qssgrendererutil_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgruntimerenderlogging_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendertexturedata_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgtexturecooker_p.h>
 #include <QtGui/QImageReader>
 #include <QtGui/QColorSpace>
 #include <QtMath>
@@ -267,9 +268,8 @@ static inline QSSGRenderTextureFormat fromGLtoTextureFormat(quint32 internalForm
     }
 }
 
-static QImage loadImage(const QString &inPath, bool flipVertical)
+QImage QSSGLoadedTexture::convertToUploadFormat(const QImage &image)
 {
-    QImage image(inPath);
     if (image.isNull())
         return image;
     const QPixelFormat pixFormat = image.pixelFormat();
@@ -283,7 +283,12 @@ static QImage loadImage(const QString &inPath, bool flipVertical)
     else if (pixFormat.premultiplied() == QPixelFormat::NotPremultiplied)
         targetFormat = QImage::Format_RGBA8888;
 
-    image.convertTo(targetFormat); // convert to a format mappable to QRhiTexture::Format
+    return image.convertedTo(targetFormat);
+}
+
+static QImage loadImage(const QString &inPath, bool flipVertical)
+{
+    QImage image = QSSGLoadedTexture::convertToUploadFormat(QImage(inPath));
     if (flipVertical)
         image.mirror(); // Flip vertically to the conventional Y-up orientation
     return image;
@@ -327,6 +332,10 @@ QSSGLoadedTexture *QSSGLoadedTexture::loadCompressedImage(const QString &inPath)
     }
     retval = new QSSGLoadedTexture;
     retval->textureFileData = reader->read();
+    if (!retval->textureFileData.isValid() && imageFile.seek(0))
+        retval->textureFileData = QSSGTextureCooker::read(imageFile.readAll(), inPath.toUtf8());
+    if (QSSGTextureCooker::isCooked(retval->textureFileData))
+        retval->isSRGB = QSSGTextureCooker::isSRGB(retval->textureFileData);
 
     // Fill out what makes sense, leave the rest at the default 0 and null.
     retval->width = retval->textureFileData.size().width();
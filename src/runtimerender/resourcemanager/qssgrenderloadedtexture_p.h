@@ -93,6 +93,8 @@ public:
                                    const QSSGRenderTextureFormat &inFormat,
                                    bool inFlipY = true);
     static QSSGLoadedTexture *loadQImage(const QString &inPath, qint32 flipVertical);
+    // The format a decoded image is uploaded in, mappable to QRhiTexture::Format
+    static QImage convertToUploadFormat(const QImage &image);
     static QSSGLoadedTexture *loadCompressedImage(const QString &inPath);
     static QSSGLoadedTexture *loadHdrImage(const QSharedPointer<QIODevice> &source, const QSSGRenderTextureFormat &inFormat);
     static QSSGLoadedTexture *loadTextureData(QSSGRenderTextureData *textureData);
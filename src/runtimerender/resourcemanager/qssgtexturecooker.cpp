@@ -0,0 +1,509 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgtexturecooker_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderloadedtexture_p.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qiodevice.h>
+#include <QtGui/qcolorspace.h>
+#include <QtGui/qimage.h>
+#include <QtGui/private/qimage_p.h>
+#include <QtGui/private/qtexturefiledata_p.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+// Bump when the content of cooked files changes
+static constexpr char CookerVersion[] = "3";
+
+static const char KtxIdentifier[12] = { '\xAB', 'K', 'T', 'X', ' ', '1', '1', '\xBB', '\r', '\n', '\x1A', '\n' };
+static constexpr qsizetype KtxHeaderSize = sizeof(KtxIdentifier) + 13 * sizeof(quint32);
+
+// GL enums written to and read from the KTX header
+static constexpr quint32 GL_UNSIGNED_BYTE_ = 0x1401;
+static constexpr quint32 GL_RED_ = 0x1903;
+static constexpr quint32 GL_RGB_ = 0x1907;
+static constexpr quint32 GL_RGBA_ = 0x1908;
+static constexpr quint32 GL_R8_ = 0x8229;
+static constexpr quint32 GL_RGBA8_ = 0x8058;
+static constexpr quint32 GL_COMPRESSED_RGB_S3TC_DXT1_EXT_ = 0x83F0;
+static constexpr quint32 GL_COMPRESSED_RGBA_S3TC_DXT5_EXT_ = 0x83F3;
+
+static void appendUInt16(QByteArray &data, quint16 value)
+{
+    const quint16 littleEndian = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char *>(&littleEndian), sizeof(littleEndian));
+}
+
+static void appendUInt32(QByteArray &data, quint32 value)
+{
+    const quint32 littleEndian = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char *>(&littleEndian), sizeof(littleEndian));
+}
+
+static quint16 toRgb565(const float color[3])
+{
+    const int r = qBound(0, qRound(color[0] * 31.0f / 255.0f), 31);
+    const int g = qBound(0, qRound(color[1] * 63.0f / 255.0f), 63);
+    const int b = qBound(0, qRound(color[2] * 31.0f / 255.0f), 31);
+    return quint16((r << 11) | (g << 5) | b);
+}
+
+static void fromRgb565(quint16 value, float color[3])
+{
+    const int r = (value >> 11) & 31;
+    const int g = (value >> 5) & 63;
+    const int b = value & 31;
+    color[0] = float((r << 3) | (r >> 2));
+    color[1] = float((g << 2) | (g >> 4));
+    color[2] = float((b << 3) | (b >> 2));
+}
+
+// The endpoints are the extremes of the pixels along the principal axis of
+// their colors, which gets close to the best fit for the cost of a few matrix
+// multiplications.
+static void appendColorBlock(QByteArray &data, const uchar pixels[16][4])
+{
+    float mean[3] = {};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c)
+            mean[c] += pixels[i][c] / 16.0f;
+    }
+
+    float covariance[6] = {}; // rr, rg, rb, gg, gb, bb
+    for (int i = 0; i < 16; ++i) {
+        const float r = pixels[i][0] - mean[0];
+        const float g = pixels[i][1] - mean[1];
+        const float b = pixels[i][2] - mean[2];
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    // Power iteration
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+        const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+        const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+        const float length = qMax(qAbs(x), qMax(qAbs(y), qAbs(z)));
+        if (length < 1e-6f)
+            break; // a single color, any axis does
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+    const float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        const float projection = ((pixels[i][0] - mean[0]) * axis[0]
+                                  + (pixels[i][1] - mean[1]) * axis[1]
+                                  + (pixels[i][2] - mean[2]) * axis[2]) / axisLengthSquared;
+        minProjection = qMin(minProjection, projection);
+        maxProjection = qMax(maxProjection, projection);
+    }
+
+    float endpoint0[3];
+    float endpoint1[3];
+    for (int c = 0; c < 3; ++c) {
+        endpoint0[c] = mean[c] + axis[c] * maxProjection;
+        endpoint1[c] = mean[c] + axis[c] * minProjection;
+    }
+    quint16 color0 = toRgb565(endpoint0);
+    quint16 color1 = toRgb565(endpoint1);
+    // color0 > color1 selects the four color mode in BC1, BC3 always uses it
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    quint32 indices = 0;
+    if (color0 != color1) {
+        float palette[4][3];
+        fromRgb565(color0, palette[0]);
+        fromRgb565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+        for (int i = 0; i < 16; ++i) {
+            quint32 bestIndex = 0;
+            float bestDistance = std::numeric_limits<float>::max();
+            for (quint32 index = 0; index < 4; ++index) {
+                float distance = 0.0f;
+                for (int c = 0; c < 3; ++c) {
+                    const float d = pixels[i][c] - palette[index][c];
+                    distance += d * d;
+                }
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+            indices |= bestIndex << (2 * i);
+        }
+    }
+
+    appendUInt16(data, color0);
+    appendUInt16(data, color1);
+    appendUInt32(data, indices);
+}
+
+static void appendAlphaBlock(QByteArray &data, const uchar pixels[16][4])
+{
+    int alpha0 = 0;
+    int alpha1 = 255;
+    for (int i = 0; i < 16; ++i) {
+        alpha0 = qMax(alpha0, int(pixels[i][3]));
+        alpha1 = qMin(alpha1, int(pixels[i][3]));
+    }
+
+    quint64 indices = 0;
+    if (alpha0 != alpha1) {
+        // alpha0 > alpha1 selects the eight value mode
+        int palette[8] = { alpha0, alpha1 };
+        for (int index = 2; index < 8; ++index)
+            palette[index] = ((8 - index) * alpha0 + (index - 1) * alpha1 + 3) / 7;
+        for (int i = 0; i < 16; ++i) {
+            quint64 bestIndex = 0;
+            int bestDistance = 256;
+            for (int index = 0; index < 8; ++index) {
+                const int distance = qAbs(int(pixels[i][3]) - palette[index]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestIndex = quint64(index);
+                }
+            }
+            indices |= bestIndex << (3 * i);
+        }
+    }
+
+    data.append(char(alpha0));
+    data.append(char(alpha1));
+    for (int i = 0; i < 6; ++i)
+        data.append(char((indices >> (8 * i)) & 0xFF));
+}
+
+// BC1 or BC3 from an RGBA8888, RGBA8888_Premultiplied or RGBX8888 image.
+// Levels smaller than a block repeat their last row and column.
+static QByteArray compressBlocks(const QImage &image, bool withAlpha)
+{
+    const int blocksX = (image.width() + 3) / 4;
+    const int blocksY = (image.height() + 3) / 4;
+    QByteArray data;
+    data.reserve(qsizetype(blocksX) * blocksY * (withAlpha ? 16 : 8));
+    uchar pixels[16][4];
+    for (int blockY = 0; blockY < blocksY; ++blockY) {
+        for (int blockX = 0; blockX < blocksX; ++blockX) {
+            for (int y = 0; y < 4; ++y) {
+                const uchar *line = image.constScanLine(qMin(blockY * 4 + y, image.height() - 1));
+                for (int x = 0; x < 4; ++x)
+                    memcpy(pixels[y * 4 + x], line + qMin(blockX * 4 + x, image.width() - 1) * 4, 4);
+            }
+            if (withAlpha)
+                appendAlphaBlock(data, pixels);
+            appendColorBlock(data, pixels);
+        }
+    }
+    return data;
+}
+
+static float srgbToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linearToSrgb(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// Box filtered from the previous level, in an RGBA8888, RGBA8888_Premultiplied,
+// RGBX8888 or Grayscale8 image. Averaging sRGB values directly would darken
+// the smaller levels, so they are averaged in linear space. Colors are
+// weighted by their alpha so that transparent pixels do not bleed into the
+// opaque ones.
+static QImage downsample(const QImage &image, const QSize &size, bool isSRGB)
+{
+    QImage result(size, image.format());
+    const int channelCount = image.format() == QImage::Format_Grayscale8 ? 1 : 4;
+    const bool hasAlphaChannel = channelCount == 4 && image.format() != QImage::Format_RGBX8888;
+    const bool premultiplied = image.format() == QImage::Format_RGBA8888_Premultiplied;
+    const int colorCount = qMin(channelCount, 3);
+    const auto decode = [isSRGB](float value) {
+        return isSRGB ? srgbToLinear(value) : value;
+    };
+    const auto encode = [isSRGB](float value) {
+        value = qBound(0.0f, value, 1.0f);
+        return isSRGB ? linearToSrgb(value) : value;
+    };
+
+    for (int y = 0; y < size.height(); ++y) {
+        const int y0 = y * image.height() / size.height();
+        const int y1 = qMax(y0 + 1, (y + 1) * image.height() / size.height());
+        uchar *dst = result.scanLine(y);
+        for (int x = 0; x < size.width(); ++x) {
+            const int x0 = x * image.width() / size.width();
+            const int x1 = qMax(x0 + 1, (x + 1) * image.width() / size.width());
+            float colorSum[3] = {};
+            float alphaSum = 0.0f;
+            for (int sy = y0; sy < y1; ++sy) {
+                const uchar *line = image.constScanLine(sy);
+                for (int sx = x0; sx < x1; ++sx) {
+                    const uchar *pixel = line + sx * channelCount;
+                    const float alpha = hasAlphaChannel ? pixel[3] / 255.0f : 1.0f;
+                    if (alpha <= 0.0f)
+                        continue;
+                    for (int c = 0; c < colorCount; ++c) {
+                        const float value = premultiplied ? qMin(1.0f, pixel[c] / 255.0f / alpha) : pixel[c] / 255.0f;
+                        colorSum[c] += decode(value) * alpha;
+                    }
+                    alphaSum += alpha;
+                }
+            }
+            const float alpha = alphaSum / ((x1 - x0) * (y1 - y0));
+            for (int c = 0; c < colorCount; ++c) {
+                float value = alphaSum > 0.0f ? encode(colorSum[c] / alphaSum) : 0.0f;
+                if (premultiplied)
+                    value *= alpha;
+                dst[c] = uchar(qRound(value * 255.0f));
+            }
+            if (channelCount == 4)
+                dst[3] = hasAlphaChannel ? uchar(qRound(alpha * 255.0f)) : 255;
+            dst += channelCount;
+        }
+    }
+    return result;
+}
+
+QSSGTextureCooker::Result QSSGTextureCooker::cook(const QImage &image, const QByteArray &sourceKey, bool compress,
+                                                  const SourceStamp &sourceStamp)
+{
+    Result result;
+    // Flipped vertically, like images loaded at run time by default
+    QImage base = QSSGLoadedTexture::convertToUploadFormat(image);
+    if (base.isNull())
+        return result;
+    base.mirror();
+
+    const bool singleChannel = base.format() == QImage::Format_Grayscale8;
+    const bool hasAlpha = QImageData::get(base)->checkForAlphaPixels();
+    result.compressed = compress && !singleChannel && base.width() % 4 == 0 && base.height() % 4 == 0;
+
+    quint32 glFormat = singleChannel ? GL_RED_ : GL_RGBA_;
+    quint32 glInternalFormat = singleChannel ? GL_R8_ : GL_RGBA8_;
+    quint32 glBaseInternalFormat = glFormat;
+    quint32 glType = GL_UNSIGNED_BYTE_;
+    if (result.compressed) {
+        glFormat = 0;
+        glType = 0;
+        glInternalFormat = hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT_ : GL_COMPRESSED_RGB_S3TC_DXT1_EXT_;
+        glBaseInternalFormat = hasAlpha ? GL_RGBA_ : GL_RGB_;
+    }
+
+    // Same as what QSSGLoadedTexture tells from the color space at run time
+    const bool isSRGB = base.colorSpace().transferFunction() != QColorSpace::TransferFunction::Linear;
+    const QList<std::pair<QByteArray, QByteArray>> keyValues = {
+        { QByteArrayLiteral("QT_TEXTURE_COOKER_VERSION"), QByteArray(CookerVersion) },
+        { QByteArrayLiteral("QT_TEXTURE_COOKER_SOURCE_KEY"), sourceKey.toHex() },
+        { QByteArrayLiteral("QT_TEXTURE_COOKER_SOURCE_SIZE"), QByteArray::number(sourceStamp.size) },
+        { QByteArrayLiteral("QT_TEXTURE_COOKER_SOURCE_MODIFIED"), QByteArray::number(sourceStamp.lastModified) },
+        { QByteArrayLiteral("QT_TEXTURE_COOKER_SRGB"), isSRGB ? QByteArrayLiteral("1") : QByteArrayLiteral("0") },
+        { QByteArrayLiteral("QT_TEXTURE_COOKER_ALPHA"), hasAlpha ? QByteArrayLiteral("1") : QByteArrayLiteral("0") }
+    };
+    QByteArray keyValueData;
+    for (const auto &[key, value] : keyValues) {
+        const quint32 keyAndValueByteSize = quint32(key.size() + 1 + value.size() + 1);
+        appendUInt32(keyValueData, keyAndValueByteSize);
+        keyValueData.append(key).append('\0');
+        keyValueData.append(value).append('\0');
+        // Pad until next multiple of 4
+        keyValueData.append(QByteArray(3 - ((keyAndValueByteSize + 3) % 4), '\0'));
+    }
+
+    int levelCount = 1;
+    while (qMax(base.width(), base.height()) >> levelCount)
+        ++levelCount;
+
+    QByteArray &data = result.ktxData;
+    data.append(KtxIdentifier, sizeof(KtxIdentifier));
+    appendUInt32(data, 0x04030201); // endianness
+    appendUInt32(data, glType);
+    appendUInt32(data, 1); // glTypeSize
+    appendUInt32(data, glFormat);
+    appendUInt32(data, glInternalFormat);
+    appendUInt32(data, glBaseInternalFormat);
+    appendUInt32(data, quint32(base.width()));
+    appendUInt32(data, quint32(base.height()));
+    appendUInt32(data, 0); // pixelDepth
+    appendUInt32(data, 0); // numberOfArrayElements
+    appendUInt32(data, 1); // numberOfFaces
+    appendUInt32(data, quint32(levelCount));
+    appendUInt32(data, quint32(keyValueData.size()));
+    data.append(keyValueData);
+
+    // Each level is downsampled from the previous one. Block sizes and QImage
+    // rows are multiples of 4, so neither the rows nor the levels need padding.
+    QImage level = base;
+    for (int i = 0; i < levelCount; ++i) {
+        if (i > 0)
+            level = downsample(level, QSize(qMax(1, base.width() >> i), qMax(1, base.height() >> i)), isSRGB);
+        const QByteArray levelData = result.compressed
+                ? compressBlocks(level, hasAlpha)
+                : QByteArray(reinterpret_cast<const char *>(level.constBits()), level.sizeInBytes());
+        appendUInt32(data, quint32(levelData.size()));
+        data.append(levelData);
+    }
+
+    result.levelCount = levelCount;
+    return result;
+}
+
+QByteArray QSSGTextureCooker::sourceKey(const QByteArray &sourceData)
+{
+    return QCryptographicHash::hash(sourceData, QCryptographicHash::Sha1);
+}
+
+QSSGTextureCooker::SourceStamp QSSGTextureCooker::sourceStamp(const QString &sourcePath)
+{
+    SourceStamp stamp;
+    const QFileInfo info(sourcePath);
+    if (!info.exists())
+        return stamp;
+    stamp.size = info.size();
+    const QDateTime lastModified = info.lastModified();
+    if (lastModified.isValid())
+        stamp.lastModified = lastModified.toMSecsSinceEpoch();
+    return stamp;
+}
+
+QString QSSGTextureCooker::cookedPath(const QString &sourcePath)
+{
+    return sourcePath + QStringLiteral(".ktx");
+}
+
+QTextureFileData QSSGTextureCooker::read(const QByteArray &ktxData, const QByteArray &logName)
+{
+    if (ktxData.size() < KtxHeaderSize || !ktxData.startsWith(QByteArrayView(KtxIdentifier, sizeof(KtxIdentifier))))
+        return {};
+    const auto readUInt32 = [&ktxData](qsizetype offset) {
+        return qFromLittleEndian<quint32>(ktxData.constData() + offset);
+    };
+    const auto headerField = [&readUInt32](int index) {
+        return readUInt32(qsizetype(sizeof(KtxIdentifier)) + index * 4);
+    };
+    // Only 2D files in the byte order they are written in
+    if (headerField(0) != 0x04030201 || headerField(8) != 0 || headerField(9) != 0 || headerField(10) != 1)
+        return {};
+
+    qsizetype offset = KtxHeaderSize;
+    const qsizetype keyValueEnd = offset + headerField(12);
+    if (keyValueEnd > ktxData.size())
+        return {};
+    QMap<QByteArray, QByteArray> keyValues;
+    while (offset + 4 <= keyValueEnd) {
+        const qsizetype keyAndValueByteSize = readUInt32(offset);
+        offset += 4;
+        if (offset + keyAndValueByteSize > keyValueEnd)
+            return {};
+        const QByteArray keyAndValue = ktxData.mid(offset, keyAndValueByteSize);
+        const qsizetype separator = keyAndValue.indexOf('\0');
+        if (separator > 0)
+            keyValues.insert(keyAndValue.left(separator), keyAndValue.mid(separator + 1));
+        offset += (keyAndValueByteSize + 3) & ~qsizetype(3);
+    }
+
+    QTextureFileData result;
+    result.setData(ktxData);
+    const int levelCount = qMax(1, int(headerField(11)));
+    offset = keyValueEnd;
+    for (int level = 0; level < levelCount; ++level) {
+        if (offset + 4 > ktxData.size())
+            return {};
+        const qsizetype imageSize = readUInt32(offset);
+        offset += 4;
+        if (offset + imageSize > ktxData.size())
+            return {};
+        result.setDataOffset(int(offset), level);
+        result.setDataLength(int(imageSize), level);
+        offset += (imageSize + 3) & ~qsizetype(3);
+    }
+    result.setNumLevels(levelCount);
+    result.setNumFaces(1);
+    result.setSize(QSize(int(headerField(6)), int(headerField(7))));
+    result.setGLFormat(headerField(3));
+    result.setGLInternalFormat(headerField(4));
+    result.setGLBaseInternalFormat(headerField(5));
+    result.setKeyValueMetadata(keyValues);
+    result.setLogName(logName);
+    return result;
+}
+
+// Values read by QTextureFileReader keep their terminating null
+static QByteArray keyValue(const QTextureFileData &data, const QByteArray &key)
+{
+    QByteArray value = data.keyValueMetadata().value(key);
+    while (value.endsWith('\0'))
+        value.chop(1);
+    return value;
+}
+
+bool QSSGTextureCooker::isCooked(const QTextureFileData &data)
+{
+    return data.isValid() && keyValue(data, QByteArrayLiteral("QT_TEXTURE_COOKER_VERSION")) == CookerVersion;
+}
+
+QByteArray QSSGTextureCooker::cookedSourceKey(const QTextureFileData &data)
+{
+    return QByteArray::fromHex(keyValue(data, QByteArrayLiteral("QT_TEXTURE_COOKER_SOURCE_KEY")));
+}
+
+QSSGTextureCooker::SourceStamp QSSGTextureCooker::cookedSourceStamp(const QTextureFileData &data)
+{
+    SourceStamp stamp;
+    bool ok = false;
+    const qint64 size = keyValue(data, QByteArrayLiteral("QT_TEXTURE_COOKER_SOURCE_SIZE")).toLongLong(&ok);
+    if (ok)
+        stamp.size = size;
+    const qint64 lastModified = keyValue(data, QByteArrayLiteral("QT_TEXTURE_COOKER_SOURCE_MODIFIED")).toLongLong(&ok);
+    if (ok)
+        stamp.lastModified = lastModified;
+    return stamp;
+}
+
+bool QSSGTextureCooker::isCookedFrom(const QTextureFileData &data, const QString &sourcePath, QIODevice *source)
+{
+    const SourceStamp cooked = cookedSourceStamp(data);
+    const SourceStamp current = sourceStamp(sourcePath);
+    if (cooked.size >= 0 && current.size >= 0 && cooked.size != current.size)
+        return false;
+    if (cooked.size >= 0 && cooked.lastModified >= 0
+            && cooked.size == current.size && cooked.lastModified == current.lastModified) {
+        return true;
+    }
+    return source && cookedSourceKey(data) == sourceKey(source->readAll());
+}
+
+bool QSSGTextureCooker::isSRGB(const QTextureFileData &data)
+{
+    return keyValue(data, QByteArrayLiteral("QT_TEXTURE_COOKER_SRGB")) == "1";
+}
+
+bool QSSGTextureCooker::hasAlpha(const QTextureFileData &data)
+{
+    return keyValue(data, QByteArrayLiteral("QT_TEXTURE_COOKER_ALPHA")) == "1";
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,93 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGTEXTURECOOKER_P_H
+#define QSSGTEXTURECOOKER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+
+class QImage;
+class QIODevice;
+class QTextureFileData;
+
+// Offline conversion of images into what the renderer uploads, used by the
+// texturecooker tool.
+//
+// A cooked texture is a KTX 1.1 file holding the image converted and flipped
+// vertically the same way as images decoded at run time, together with its
+// full mip chain, downsampled in linear space for sRGB images, and
+// optionally BC1 (opaque) or BC3 (with alpha) compressed. It is written next
+// to the source image as <source>.ktx. When loading an image, the buffer
+// manager picks the cooked file up instead as long as it was cooked from the
+// same image data and the backend supports its format, then uploads the
+// levels as they are, without decoding, converting or generating mipmaps.
+// Without the source image, the cooked file is found through the usual
+// lookup of texture file extensions.
+//
+// The size and modification time of the source are stored too. The source
+// only gets hashed to compare it with the cooked one when its size is the
+// same but it was modified at another time, which is the case after copying
+// or deploying the files.
+//
+// Uncompressed levels are GL_RGBA8 or GL_R8 with rows padded to 4 bytes, like
+// the QImage they come from.
+
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGTextureCooker
+{
+public:
+    struct Result
+    {
+        QByteArray ktxData; // empty on failure
+        int levelCount = 0;
+        bool compressed = false;
+    };
+
+    struct SourceStamp
+    {
+        qint64 size = -1;
+        qint64 lastModified = -1; // msecs since the epoch
+    };
+
+    // Block compression needs a size divisible by 4 and is not done for
+    // single channel images, these are stored uncompressed.
+    static Result cook(const QImage &image, const QByteArray &sourceKey, bool compress,
+                       const SourceStamp &sourceStamp = {});
+
+    static QByteArray sourceKey(const QByteArray &sourceData);
+    static SourceStamp sourceStamp(const QString &sourcePath);
+
+    static QString cookedPath(const QString &sourcePath);
+
+    // QTextureFileReader only reads 2D KTX files that are block compressed,
+    // this reads the uncompressed ones too.
+    static QTextureFileData read(const QByteArray &ktxData, const QByteArray &logName);
+
+    // Metadata of a loaded texture file
+    static bool isCooked(const QTextureFileData &data);
+    static QByteArray cookedSourceKey(const QTextureFileData &data);
+    static SourceStamp cookedSourceStamp(const QTextureFileData &data);
+    // Reads source only when the stamps do not tell
+    static bool isCookedFrom(const QTextureFileData &data, const QString &sourcePath, QIODevice *source);
+    static bool isSRGB(const QTextureFileData &data);
+    static bool hasAlpha(const QTextureFileData &data);
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGTEXTURECOOKER_P_H
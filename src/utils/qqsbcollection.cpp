@@ -7,6 +7,8 @@
 #include <QtCore/QCryptographicHash>
 #include <rhi/qrhi.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 QQsbCollection::~QQsbCollection()
@@ -115,7 +117,11 @@ void QQsbCollection::writeEndHeader(QIODevice *device, const EntryMap &entries)
     QDataStream ds(device);
     ds.setVersion(QDataStream::Qt_6_0);
     const qint64 startPos = device->pos();
-    ds << entries;
+    // Written in key order so that the same entries always produce the same
+    // file, the stream format is the same as for the set itself.
+    QList<Entry> sortedEntries(entries.cbegin(), entries.cend());
+    std::sort(sortedEntries.begin(), sortedEntries.end(), [](const Entry &l, const Entry &r) { return l.key < r.key; });
+    ds << sortedEntries;
     writeEndHeader(ds, startPos, quint8(Version::Two), MagicaDS);
 }
 
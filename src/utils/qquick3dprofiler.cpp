@@ -2,11 +2,14 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include "qquick3dprofiler_p.h"
+#include "qquick3dprofilertracewriter_p.h"
 
 #include <QtQml/qqmlfile.h>
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qthread.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qtimer.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -89,6 +92,10 @@ int QQuick3DProfiler::registerString(const QByteArray &string)
 
 void QQuick3DProfiler::initialize(QObject *parent)
 {
+    if (s_instance && s_instance->m_traceWriter) {
+        qWarning("Quick3D profiling data is written to a trace file and not sent to the QML profiler");
+        return;
+    }
     Q_ASSERT(s_instance == nullptr);
     s_instance = new QQuick3DProfiler(parent);
 }
@@ -106,15 +113,84 @@ QQuick3DProfiler::~QQuick3DProfiler()
     s_instance = nullptr;
 }
 
+bool QQuick3DProfiler::startTrace(const QString &fileName)
+{
+    if (s_instance) {
+        qWarning("Quick3D profiling is already active, not recording a trace");
+        return false;
+    }
+
+    auto traceFile = std::make_unique<QFile>(fileName);
+    if (!traceFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Could not open %s for writing the Quick3D trace", qPrintable(fileName));
+        return false;
+    }
+
+    s_instance = new QQuick3DProfiler(nullptr);
+    s_instance->m_traceWriter = std::make_unique<QQuick3DProfilerTraceWriter>(traceFile.get());
+    s_instance->m_traceFile = std::move(traceFile);
+
+    // Keep the memory use bounded in long captures, the rest is written on exit
+    QTimer *flushTimer = new QTimer(s_instance);
+    connect(flushTimer, &QTimer::timeout, s_instance, &QQuick3DProfiler::flushTrace);
+    flushTimer->start(1000);
+    qAddPostRoutine(stopTrace);
+
+    featuresEnabled = 1 << ProfileQuick3D;
+    return true;
+}
+
+void QQuick3DProfiler::stopTrace()
+{
+    if (!s_instance || !s_instance->m_traceWriter)
+        return;
+
+    featuresEnabled = 0;
+    s_instance->flushTrace();
+    s_instance->m_traceWriter->finish();
+    s_instance->m_traceFile->close();
+    delete s_instance;
+}
+
+void QQuick3DProfiler::flushTrace()
+{
+    QVector<QQuick3DProfilerData> data;
+    {
+        QMutexLocker lock(&m_dataMutex);
+        data.swap(m_data);
+    }
+    // All ids in data are registered by now. Not holding both locks at the
+    // same time, registerString() locks them in the opposite order.
+    QHash<int, QByteArray> eventData;
+    {
+        QMutexLocker lock(&s_eventDataMutex);
+        eventData = s_eventDataRev;
+    }
+    m_traceWriter->write(data, eventData);
+    m_traceFile->flush();
+}
+
+static void startTraceFromEnvironment()
+{
+    const QString fileName = qEnvironmentVariable("QT_QUICK3D_PROFILE_TRACE");
+    if (!fileName.isEmpty())
+        QQuick3DProfiler::startTrace(fileName);
+}
+Q_COREAPP_STARTUP_FUNCTION(startTraceFromEnvironment)
+
 void QQuick3DProfiler::startProfilingImpl(quint64 features)
 {
     QMutexLocker lock(&m_dataMutex);
+    if (m_traceWriter)
+        return;
     featuresEnabled = features;
 }
 
 void QQuick3DProfiler::stopProfilingImpl()
 {
     QMutexLocker lock(&m_dataMutex);
+    if (m_traceWriter)
+        return;
     featuresEnabled = 0;
     emit dataReady(m_data, s_eventDataRev);
     m_data.clear();
@@ -123,6 +199,8 @@ void QQuick3DProfiler::stopProfilingImpl()
 void QQuick3DProfiler::reportDataImpl()
 {
     QMutexLocker lock(&m_dataMutex);
+    if (m_traceWriter)
+        return;
     emit dataReady(m_data, s_eventDataRev);
     m_data.clear();
 }
@@ -28,6 +28,9 @@
 #include <QtCore/qsize.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qthreadstorage.h>
+#include <QtCore/qthread.h>
+
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -83,6 +86,7 @@ struct Q_QUICK3DUTILS_EXPORT QQuick3DProfilerData
     qint64 subdata1 = 0;
     qint64 subdata2 = 0;
     qint32 ids[s_numSupportedIds] = {0}; // keep this even sized
+    quintptr threadId = 0; // QThread::currentThreadId() of the thread reporting the event
 };
 
 Q_DECLARE_TYPEINFO(QQuick3DProfilerData, Q_RELOCATABLE_TYPE);
@@ -120,6 +124,9 @@ public:
     }
 };
 
+class QFile;
+class QQuick3DProfilerTraceWriter;
+
 class Q_QUICK3DUTILS_EXPORT QQuick3DProfiler : public QObject, public QQmlProfilerDefinitions {
     Q_OBJECT
 public:
@@ -209,6 +216,12 @@ public:
     static int registerObject(const QObject *object);
     static int registerString(const QByteArray &string);
 
+    // Records the events into a Chrome trace file instead of sending them
+    // to the QML profiler, until the application exits. Started by setting
+    // QT_QUICK3D_PROFILE_TRACE to the name of the file.
+    static bool startTrace(const QString &fileName);
+    static void stopTrace();
+
 signals:
     void dataReady(const QVector<QQuick3DProfilerData> &data, const QHash<int, QByteArray> &eventData);
 
@@ -222,6 +235,8 @@ protected:
     QElapsedTimer m_timer;
     QVector<QQuick3DProfilerData> m_data;
     QQuick3DProfilerSceneGraphData m_sceneGraphData;
+    std::unique_ptr<QFile> m_traceFile;
+    std::unique_ptr<QQuick3DProfilerTraceWriter> m_traceWriter;
 
     QQuick3DProfiler(QObject *parent);
 
@@ -229,8 +244,11 @@ protected:
     {
         QMutexLocker lock(&m_dataMutex);
         m_data.append(message);
+        m_data.last().threadId = quintptr(QThread::currentThreadId());
     }
 
+    void flushTrace();
+
     void startProfilingImpl(quint64 features);
     void stopProfilingImpl();
     void reportDataImpl();
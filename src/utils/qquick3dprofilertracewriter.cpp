@@ -0,0 +1,178 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qquick3dprofilertracewriter_p.h"
+
+#if QT_CONFIG(qml_debug)
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+
+QT_BEGIN_NAMESPACE
+
+QQuick3DProfilerTraceWriter::QQuick3DProfilerTraceWriter(QIODevice *device)
+    : m_device(device),
+      m_pid(QCoreApplication::applicationPid())
+{
+}
+
+QLatin1StringView QQuick3DProfilerTraceWriter::eventName(int detailType)
+{
+    switch (detailType) {
+    case QQuick3DProfiler::Quick3DRenderFrame:
+        return QLatin1StringView("Render Frame");
+    case QQuick3DProfiler::Quick3DSynchronizeFrame:
+        return QLatin1StringView("Synchronize Frame");
+    case QQuick3DProfiler::Quick3DPrepareFrame:
+        return QLatin1StringView("Prepare Frame");
+    case QQuick3DProfiler::Quick3DMeshLoad:
+        return QLatin1StringView("Mesh Load");
+    case QQuick3DProfiler::Quick3DCustomMeshLoad:
+        return QLatin1StringView("Custom Mesh Load");
+    case QQuick3DProfiler::Quick3DTextureLoad:
+        return QLatin1StringView("Texture Load");
+    case QQuick3DProfiler::Quick3DGenerateShader:
+        return QLatin1StringView("Generate Shader");
+    case QQuick3DProfiler::Quick3DLoadShader:
+        return QLatin1StringView("Load Shader");
+    case QQuick3DProfiler::Quick3DParticleUpdate:
+        return QLatin1StringView("Particle Update");
+    case QQuick3DProfiler::Quick3DRenderCall:
+        return QLatin1StringView("Render Call");
+    case QQuick3DProfiler::Quick3DRenderPass:
+        return QLatin1StringView("Render Pass");
+    default:
+        break;
+    }
+    return QLatin1StringView("Unknown");
+}
+
+static inline void insertSize(QJsonObject *args, qint64 payload)
+{
+    args->insert(QLatin1StringView("width"), payload & 0xFFFFFFFF);
+    args->insert(QLatin1StringView("height"), payload >> 32);
+}
+
+QJsonObject QQuick3DProfilerTraceWriter::toTraceEvent(const QQuick3DProfilerData &data,
+                                                      const QHash<int, QByteArray> &eventData,
+                                                      qint64 pid,
+                                                      int tid)
+{
+    // The ids are marked by QQuick3DProfilerData, objects and strings are
+    // registered the same way.
+    QJsonArray resources;
+    for (qint32 id : data.ids) {
+        if (id) {
+            const QByteArray resource = eventData.value(id & 0x00FFFFFF);
+            if (!resource.isEmpty())
+                resources.append(QString::fromUtf8(resource));
+        }
+    }
+
+    // The meaning of the payload depends on the event, see the
+    // Q_QUICK3D_PROFILE_END_* calls
+    const qint64 payload = data.subdata2;
+    QString name = eventName(data.detailType);
+    QJsonObject args;
+    switch (data.detailType) {
+    case QQuick3DProfiler::Quick3DRenderFrame:
+        args.insert(QLatin1StringView("drawCalls"), payload & 0xFFFFFFFF);
+        args.insert(QLatin1StringView("renderPasses"), payload >> 32);
+        break;
+    case QQuick3DProfiler::Quick3DSynchronizeFrame:
+    case QQuick3DProfiler::Quick3DPrepareFrame:
+        insertSize(&args, payload);
+        break;
+    case QQuick3DProfiler::Quick3DRenderPass:
+        // Named after the pass, for a readable flame chart
+        if (!resources.isEmpty())
+            name = resources.first().toString();
+        if (payload)
+            insertSize(&args, payload);
+        break;
+    case QQuick3DProfiler::Quick3DRenderCall:
+        args.insert(QLatin1StringView("primitives"), payload & 0xFFFFFFFF);
+        args.insert(QLatin1StringView("instances"), payload >> 32);
+        break;
+    case QQuick3DProfiler::Quick3DMeshLoad:
+    case QQuick3DProfiler::Quick3DCustomMeshLoad:
+    case QQuick3DProfiler::Quick3DTextureLoad:
+        args.insert(QLatin1StringView("dataSize"), payload);
+        break;
+    case QQuick3DProfiler::Quick3DGenerateShader:
+        if (payload)
+            args.insert(QLatin1StringView("shaderKeyHash"), QString::number(quint64(payload), 16));
+        break;
+    case QQuick3DProfiler::Quick3DParticleUpdate:
+        args.insert(QLatin1StringView("particles"), payload);
+        break;
+    default:
+        break;
+    }
+    if (!resources.isEmpty())
+        args.insert(QLatin1StringView("resources"), resources);
+
+    // The time is when the event ended, subdata1 its duration, both in
+    // nanoseconds while the trace is in microseconds.
+    QJsonObject event;
+    event.insert(QLatin1StringView("name"), name);
+    event.insert(QLatin1StringView("cat"), QLatin1StringView("Quick3D"));
+    event.insert(QLatin1StringView("ph"), QLatin1StringView("X"));
+    event.insert(QLatin1StringView("ts"), double(data.time - data.subdata1) / 1000.0);
+    event.insert(QLatin1StringView("dur"), double(data.subdata1) / 1000.0);
+    event.insert(QLatin1StringView("pid"), pid);
+    event.insert(QLatin1StringView("tid"), tid);
+    event.insert(QLatin1StringView("args"), args);
+    return event;
+}
+
+void QQuick3DProfilerTraceWriter::writeEvent(const QJsonObject &event)
+{
+    m_device->write(m_empty ? "[\n" : ",\n");
+    m_device->write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    m_empty = false;
+}
+
+void QQuick3DProfilerTraceWriter::write(const QVector<QQuick3DProfilerData> &data, const QHash<int, QByteArray> &eventData)
+{
+    Q_ASSERT(!m_finished);
+
+    if (m_empty) {
+        QJsonObject processName;
+        processName.insert(QLatin1StringView("name"), QLatin1StringView("process_name"));
+        processName.insert(QLatin1StringView("ph"), QLatin1StringView("M"));
+        processName.insert(QLatin1StringView("pid"), m_pid);
+        QJsonObject args;
+        args.insert(QLatin1StringView("name"), QCoreApplication::applicationName());
+        processName.insert(QLatin1StringView("args"), args);
+        writeEvent(processName);
+    }
+
+    for (const QQuick3DProfilerData &event : data) {
+        // Registering a string or an object is not an event of its own
+        if (event.messageType != QQuick3DProfiler::Quick3DFrame
+                || event.detailType == QQuick3DProfiler::Quick3DEventData) {
+            continue;
+        }
+
+        auto it = m_threadIds.constFind(event.threadId);
+        if (it == m_threadIds.cend())
+            it = m_threadIds.insert(event.threadId, int(m_threadIds.size()) + 1);
+
+        writeEvent(toTraceEvent(event, eventData, m_pid, it.value()));
+    }
+}
+
+void QQuick3DProfilerTraceWriter::finish()
+{
+    if (m_finished)
+        return;
+    m_device->write(m_empty ? "[]\n" : "\n]\n");
+    m_finished = true;
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_CONFIG(qml_debug)
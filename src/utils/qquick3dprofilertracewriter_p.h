@@ -0,0 +1,69 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QQUICK3DPROFILERTRACEWRITER_P_H
+#define QQUICK3DPROFILERTRACEWRITER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DUtils/private/qquick3dprofiler_p.h>
+
+#if QT_CONFIG(qml_debug)
+
+#include <QtCore/qhash.h>
+#include <QtCore/qjsonobject.h>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+
+// Writes QQuick3DProfiler events in the Chrome trace event format, as a JSON
+// array of complete ("X") events that chrome://tracing and the Perfetto UI
+// open directly. Nested scopes on a thread, like the render passes within a
+// frame, show up nested since each event has its start time and duration.
+// The objects and strings attached to an event, such as the mesh path or the
+// shader key, are listed in its arguments.
+//
+// The array is only closed in finish(), viewers accept the file without the
+// closing bracket as well, so a trace is usable even when the application
+// did not exit normally.
+
+class Q_QUICK3DUTILS_EXPORT QQuick3DProfilerTraceWriter
+{
+public:
+    explicit QQuick3DProfilerTraceWriter(QIODevice *device);
+
+    // eventData maps the ids in the events to the registered strings
+    void write(const QVector<QQuick3DProfilerData> &data, const QHash<int, QByteArray> &eventData);
+    void finish();
+
+    static QJsonObject toTraceEvent(const QQuick3DProfilerData &data,
+                                    const QHash<int, QByteArray> &eventData,
+                                    qint64 pid,
+                                    int tid);
+    static QLatin1StringView eventName(int detailType);
+
+private:
+    void writeEvent(const QJsonObject &event);
+
+    QIODevice *m_device;
+    qint64 m_pid;
+    QHash<quintptr, int> m_threadIds; // QThread::currentThreadId() to a small number
+    bool m_empty = true;
+    bool m_finished = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QT_CONFIG(qml_debug)
+
+#endif // QQUICK3DPROFILERTRACEWRITER_P_H
@@ -1047,19 +1047,19 @@ bool Mesh::createLightmapUVChannel(uint lightmapBaseResolution)
 
     for (const VertexBufferEntry &vbe : std::as_const(m_vertexBuffer.entries)) {
         if (vbe.name == posAttrName) {
-            if (vbe.componentCount != 3) {
+            if (vbe.componentType != ComponentType::Float32 || vbe.componentCount != 3) {
                 qWarning("Lightmap UV unwrapping encountered a Mesh non-float3 position data, this cannot happen");
                 return false;
             }
             positionOffset = vbe.offset;
         } else if (vbe.name == normalAttrName) {
-            if (vbe.componentCount != 3) {
+            if (vbe.componentType != ComponentType::Float32 || vbe.componentCount != 3) {
                 qWarning("Lightmap UV unwrapping encountered a Mesh non-float3 normal data, this cannot happen");
                 return false;
             }
             normalOffset = vbe.offset;
         } else if (vbe.name == uvAttrName) {
-            if (vbe.componentCount != 2) {
+            if (vbe.componentType != ComponentType::Float32 || vbe.componentCount != 2) {
                 qWarning("Lightmap UV unwrapping encountered a Mesh non-float2 UV0 data, this cannot happen");
                 return false;
             }
@@ -1261,6 +1261,28 @@ void optimizeVertexCache(unsigned int *destination, const unsigned int *indices,
     meshopt_optimizeVertexCache(destination, indices, indexCount, vertexCount);
 }
 
+void optimizeOverdraw(unsigned int *destination, const unsigned int *indices, size_t indexCount, const float *vertexPositions, size_t vertexCount, size_t vertexPositionsStride, float threshold)
+{
+    meshopt_optimizeOverdraw(destination, indices, indexCount, vertexPositions, vertexCount, vertexPositionsStride, threshold);
+}
+
+size_t optimizeVertexFetchRemap(unsigned int *destination, const unsigned int *indices, size_t indexCount, size_t vertexCount)
+{
+    return meshopt_optimizeVertexFetchRemap(destination, indices, indexCount, vertexCount);
+}
+
+VertexCacheStatistics analyzeVertexCache(const unsigned int *indices, size_t indexCount, size_t vertexCount)
+{
+    // A plain FIFO cache of 16 entries, what the optimizer assumes as well
+    const meshopt_VertexCacheStatistics stats = meshopt_analyzeVertexCache(indices, indexCount, vertexCount, 16, 0, 0);
+    return { stats.acmr, stats.atvr };
+}
+
+float analyzeVertexFetch(const unsigned int *indices, size_t indexCount, size_t vertexCount, size_t vertexSize)
+{
+    return meshopt_analyzeVertexFetch(indices, indexCount, vertexCount, vertexSize).overfetch;
+}
+
 } // namespace QSSGMesh
 
 QT_END_NAMESPACE
@@ -429,6 +429,34 @@ void Q_QUICK3DUTILS_EXPORT optimizeVertexCache(unsigned int* destination,
                                                size_t indexCount,
                                                size_t vertexCount);
 
+void Q_QUICK3DUTILS_EXPORT optimizeOverdraw(unsigned int* destination,
+                                            const unsigned int* indices,
+                                            size_t indexCount,
+                                            const float* vertexPositions,
+                                            size_t vertexCount,
+                                            size_t vertexPositionsStride,
+                                            float threshold);
+
+size_t Q_QUICK3DUTILS_EXPORT optimizeVertexFetchRemap(unsigned int* destination,
+                                                      const unsigned int* indices,
+                                                      size_t indexCount,
+                                                      size_t vertexCount);
+
+struct VertexCacheStatistics
+{
+    float acmr = 0.0f; // transformed vertices per triangle
+    float atvr = 0.0f; // transformed vertices per vertex
+};
+
+VertexCacheStatistics Q_QUICK3DUTILS_EXPORT analyzeVertexCache(const unsigned int* indices,
+                                                               size_t indexCount,
+                                                               size_t vertexCount);
+
+float Q_QUICK3DUTILS_EXPORT analyzeVertexFetch(const unsigned int* indices,
+                                               size_t indexCount,
+                                               size_t vertexCount,
+                                               size_t vertexSize);
+
 } // namespace QSSGMesh
 
 QT_END_NAMESPACE
@@ -3,6 +3,7 @@
 
 #include "qssgmeshbvhbuilder_p.h"
 #include <QtQuick3DUtils/private/qssgassert_p.h>
+#include <QtCore/qfloat16.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -33,9 +34,11 @@ QSSGMeshBVHBuilder::QSSGMeshBVHBuilder(const QSSGMesh::Mesh &mesh)
         } else if (!strcmp(entry.m_name, QSSGMesh::MeshInternal::getUV0AttrName())) {
             m_hasUVData = true;
             m_vertexUVOffset = entry.m_firstItemOffset;
+            m_vertexUVComponentType = entry.m_componentType;
         } else if (!m_hasUVData && !strcmp(entry.m_name, QSSGMesh::MeshInternal::getUV1AttrName())) {
             m_hasUVData = true;
             m_vertexUVOffset = entry.m_firstItemOffset;
+            m_vertexUVComponentType = entry.m_componentType;
         }
     }
     m_vertexStride = vb.stride;
@@ -48,7 +51,8 @@ QSSGMeshBVHBuilder::QSSGMeshBVHBuilder(const QByteArray &vertexBuffer,
                                        int uvOffset,
                                        bool hasIndexBuffer,
                                        const QByteArray &indexBuffer,
-                                       QSSGRenderComponentType indexBufferType)
+                                       QSSGRenderComponentType indexBufferType,
+                                       QSSGRenderComponentType uvComponentType)
 {
     m_vertexBufferData = vertexBuffer;
     m_vertexStride = stride;
@@ -56,6 +60,7 @@ QSSGMeshBVHBuilder::QSSGMeshBVHBuilder(const QByteArray &vertexBuffer,
     m_vertexPosOffset = posOffset;
     m_hasUVData = hasUV;
     m_vertexUVOffset = uvOffset;
+    m_vertexUVComponentType = uvComponentType;
     m_hasIndexBuffer = hasIndexBuffer;
     m_indexBufferData = indexBuffer;
     m_indexBufferComponentType = indexBufferType;
@@ -137,12 +142,35 @@ static inline QVector3D getVertexBufferValuePosition(quint32 index, const quint3
     return *position;
 }
 
-static inline QVector2D getVertexBufferValueUV(quint32 index, const quint32 vertexStride, const quint32 vertexUVOffset, const QByteArray &vertexBufferData)
+template <typename T>
+static inline QVector2D readUV(const char *data)
 {
-    const quint32 offset = index * vertexStride + vertexUVOffset;
-    const QVector2D *uv = reinterpret_cast<const QVector2D *>(vertexBufferData.begin() + offset);
+    T uv[2];
+    memcpy(uv, data, sizeof(uv));
+    return QVector2D(float(uv[0]), float(uv[1]));
+}
 
-    return *uv;
+// Quantized meshes store the UVs as half floats, custom geometry can use any
+// of the component types the renderer takes for vertex inputs.
+static inline QVector2D getVertexBufferValueUV(quint32 index,
+                                               const quint32 vertexStride,
+                                               const quint32 vertexUVOffset,
+                                               const QSSGRenderComponentType vertexUVComponentType,
+                                               const QByteArray &vertexBufferData)
+{
+    const char *data = vertexBufferData.begin() + index * vertexStride + vertexUVOffset;
+
+    switch (vertexUVComponentType) {
+    case QSSGRenderComponentType::Float16:
+        return readUV<qfloat16>(data);
+    case QSSGRenderComponentType::Int32:
+        return readUV<qint32>(data);
+    case QSSGRenderComponentType::UnsignedInt32:
+        return readUV<quint32>(data);
+    default:
+        break;
+    }
+    return readUV<float>(data);
 }
 
 template <QSSGRenderComponentType ComponentType, bool hasIndexBuffer, bool hasPositionData, bool hasUVData>
@@ -152,6 +180,7 @@ static void calculateTriangleBoundsImpl(quint32 indexOffset,
                                         const QByteArray &vertexBufferData,
                                         [[maybe_unused]] const quint32 vertexStride,
                                         [[maybe_unused]] const quint32 vertexUVOffset,
+                                        [[maybe_unused]] const QSSGRenderComponentType vertexUVComponentType,
                                         [[maybe_unused]] const quint32 vertexPosOffset,
                                         QSSGMeshBVHTriangles &triangleBounds)
 {
@@ -181,9 +210,9 @@ static void calculateTriangleBoundsImpl(quint32 indexOffset,
             }
 
             if constexpr (hasUVData) {
-                triangle.uvCoord1 = getVertexBufferValueUV(index1, vertexStride, vertexUVOffset, vertexBufferData);
-                triangle.uvCoord2 = getVertexBufferValueUV(index2, vertexStride, vertexUVOffset, vertexBufferData);
-                triangle.uvCoord3 = getVertexBufferValueUV(index3, vertexStride, vertexUVOffset, vertexBufferData);
+                triangle.uvCoord1 = getVertexBufferValueUV(index1, vertexStride, vertexUVOffset, vertexUVComponentType, vertexBufferData);
+                triangle.uvCoord2 = getVertexBufferValueUV(index2, vertexStride, vertexUVOffset, vertexUVComponentType, vertexBufferData);
+                triangle.uvCoord3 = getVertexBufferValueUV(index3, vertexStride, vertexUVOffset, vertexUVComponentType, vertexBufferData);
             }
         }
 
@@ -198,7 +227,7 @@ QSSGMeshBVHTriangles QSSGMeshBVHBuilder::calculateTriangleBounds(quint32 indexOf
 {
     QSSGMeshBVHTriangles data;
 
-    using CalcTriangleBoundsFn = void (*)(quint32, quint32, const QByteArray &, const QByteArray &, const quint32, const quint32, const quint32, QSSGMeshBVHTriangles &);
+    using CalcTriangleBoundsFn = void (*)(quint32, quint32, const QByteArray &, const QByteArray &, const quint32, const quint32, const QSSGRenderComponentType, const quint32, QSSGMeshBVHTriangles &);
     static const CalcTriangleBoundsFn calcTriangleBounds16Fns[] { &calculateTriangleBoundsImpl<QSSGRenderComponentType::UnsignedInt16, false, false, false>,
                                                                   &calculateTriangleBoundsImpl<QSSGRenderComponentType::UnsignedInt16, false, false, true>,
                                                                   &calculateTriangleBoundsImpl<QSSGRenderComponentType::UnsignedInt16, false, true, false>,
@@ -221,9 +250,9 @@ QSSGMeshBVHTriangles QSSGMeshBVHBuilder::calculateTriangleBounds(quint32 indexOf
     const size_t idx = (size_t(m_hasIndexBuffer) << 2u) | (size_t(m_hasPositionData) << 1u) | (size_t(m_hasUVData));
 
     if (m_indexBufferComponentType == QSSGRenderComponentType::UnsignedInt16)
-        calcTriangleBounds16Fns[idx](indexOffset, indexCount, m_indexBufferData, m_vertexBufferData, m_vertexStride, m_vertexUVOffset, m_vertexPosOffset, data);
+        calcTriangleBounds16Fns[idx](indexOffset, indexCount, m_indexBufferData, m_vertexBufferData, m_vertexStride, m_vertexUVOffset, m_vertexUVComponentType, m_vertexPosOffset, data);
     else if (m_indexBufferComponentType == QSSGRenderComponentType::UnsignedInt32)
-        calcTriangleBounds32Fns[idx](indexOffset, indexCount, m_indexBufferData, m_vertexBufferData, m_vertexStride, m_vertexUVOffset, m_vertexPosOffset, data);
+        calcTriangleBounds32Fns[idx](indexOffset, indexCount, m_indexBufferData, m_vertexBufferData, m_vertexStride, m_vertexUVOffset, m_vertexUVComponentType, m_vertexPosOffset, data);
     return data;
 }
 
@@ -31,7 +31,8 @@ public:
                        int uvOffset = -1,
                        bool hasIndexBuffer = false,
                        const QByteArray &indexBuffer = QByteArray(),
-                       QSSGRenderComponentType indexBufferType = QSSGRenderComponentType::Int32);
+                       QSSGRenderComponentType indexBufferType = QSSGRenderComponentType::Int32,
+                       QSSGRenderComponentType uvComponentType = QSSGRenderComponentType::Float32);
 
     std::unique_ptr<QSSGMeshBVH> buildTree();
 
@@ -66,6 +67,7 @@ private:
     quint32 m_vertexPosOffset;
     bool m_hasUVData = false;
     quint32 m_vertexUVOffset;
+    QSSGRenderComponentType m_vertexUVComponentType = QSSGRenderComponentType::Float32;
     bool m_hasIndexBuffer = true;
 };
 
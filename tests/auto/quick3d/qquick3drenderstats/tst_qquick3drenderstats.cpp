@@ -0,0 +1,164 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QSignalSpy>
+
+#include <QtGui/rhi/qrhi.h>
+
+#include <QtQuick3D/private/qquick3drenderstats_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderlayer_p.h>
+
+#include <algorithm>
+
+// Drives the render stats the way the scene renderer and the window do, with
+// the expensive events recorded by hand in the stats of a Null QRhi context.
+class tst_QQuick3DRenderStats : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void hitchThreshold();
+    void hitchUploadThreshold();
+    void hitchEventsAfterDrop();
+
+private:
+    static void renderFrame(QQuick3DRenderStats *stats, int msecs);
+
+    std::unique_ptr<QRhi> m_rhi;
+    std::unique_ptr<QSSGRhiContext> m_rhiContext;
+    QSSGRenderLayer m_layer;
+};
+
+using EventType = QSSGRhiContextStats::ExpensiveEventInfo::Type;
+
+void tst_QQuick3DRenderStats::initTestCase()
+{
+    m_rhi.reset(QRhi::create(QRhi::Null, nullptr));
+    QVERIFY(m_rhi);
+    m_rhiContext = std::make_unique<QSSGRhiContext>(m_rhi.get());
+}
+
+void tst_QQuick3DRenderStats::cleanupTestCase()
+{
+    m_rhiContext.reset();
+    m_rhi.reset();
+}
+
+// A frame taking at least msecs. Longer than the 200 ms between the updates
+// of the properties, so every frame is reported.
+void tst_QQuick3DRenderStats::renderFrame(QQuick3DRenderStats *stats, int msecs)
+{
+    stats->startRender();
+    stats->endRender(false);
+    QTest::qSleep(msecs);
+    QVERIFY(QMetaObject::invokeMethod(stats, "onFrameSwapped", Qt::DirectConnection));
+}
+
+void tst_QQuick3DRenderStats::hitchThreshold()
+{
+    QQuick3DRenderStats stats;
+    stats.setRhiContext(m_rhiContext.get(), &m_layer);
+    QSignalSpy spy(&stats, &QQuick3DRenderStats::hitchesChanged);
+
+    stats.setHitchThreshold(10000.0f);
+    renderFrame(&stats, 210);
+    QCOMPARE(stats.hitchCount(), quint64(0));
+    QVERIFY(stats.hitchList().isEmpty());
+    QCOMPARE(spy.size(), 0);
+
+    stats.setHitchThreshold(100.0f);
+    renderFrame(&stats, 210);
+    QCOMPARE(stats.hitchCount(), quint64(1));
+    QCOMPARE(spy.size(), 1);
+    const QList<QQuick3DRenderStats::Hitch> hitches = stats.hitchList();
+    QCOMPARE(hitches.size(), 1);
+    QCOMPARE(hitches.first().frame, quint64(2));
+    QVERIFY(hitches.first().frameTime > 100.0f);
+
+    stats.setHitchThreshold(10000.0f);
+    renderFrame(&stats, 210);
+    QCOMPARE(stats.hitchCount(), quint64(1));
+    QCOMPARE(spy.size(), 1);
+}
+
+void tst_QQuick3DRenderStats::hitchUploadThreshold()
+{
+    QSSGRhiContextStats &contextStats = QSSGRhiContextStats::get(*m_rhiContext);
+    QQuick3DRenderStats stats;
+    stats.setRhiContext(m_rhiContext.get(), &m_layer);
+    stats.setHitchThreshold(100.0f);
+    stats.setHitchUploadThreshold(1000);
+
+    contextStats.expensiveEvent(EventType::TextureUpload, "small texture", 1000, 999);
+    contextStats.expensiveEvent(EventType::TextureUpload, "large texture", 1000, 1000);
+    contextStats.expensiveEvent(EventType::MeshUpload, "small mesh", 1000, 10);
+    contextStats.expensiveEvent(EventType::PipelineCreation, "pipeline", 1000);
+    renderFrame(&stats, 210);
+
+    QList<QQuick3DRenderStats::Hitch> hitches = stats.hitchList();
+    QCOMPARE(hitches.size(), 1);
+    QList<QSSGRhiContextStats::ExpensiveEventInfo> events = hitches.last().events;
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events.at(0).name, QByteArray("large texture"));
+    QCOMPARE(events.at(1).name, QByteArray("pipeline"));
+
+    // Events are attributed to the frame they happened in only
+    stats.setHitchUploadThreshold(0);
+    contextStats.expensiveEvent(EventType::MeshUpload, "next mesh", 1000, 10);
+    renderFrame(&stats, 210);
+    hitches = stats.hitchList();
+    QCOMPARE(hitches.size(), 2);
+    events = hitches.last().events;
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.first().name, QByteArray("next mesh"));
+}
+
+void tst_QQuick3DRenderStats::hitchEventsAfterDrop()
+{
+    QSSGRhiContextStats &contextStats = QSSGRhiContextStats::get(*m_rhiContext);
+    QQuick3DRenderStats stats;
+    stats.setRhiContext(m_rhiContext.get(), &m_layer);
+    stats.setHitchThreshold(100.0f);
+
+    // More events in one frame than are kept, the oldest ones are dropped
+    // before the frame ends
+    const quint64 firstEvent = contextStats.expensiveEventOffset + quint64(contextStats.expensiveEvents.size());
+    const int eventCount = 1100;
+    for (int i = 0; i < eventCount; ++i)
+        contextStats.expensiveEvent(EventType::ShaderGeneration, QByteArray::number(firstEvent + quint64(i)), 1000);
+    QVERIFY(contextStats.expensiveEventOffset > firstEvent);
+    const quint64 firstKept = contextStats.expensiveEventOffset;
+    const quint64 end = firstKept + quint64(contextStats.expensiveEvents.size());
+    renderFrame(&stats, 210);
+
+    QList<QQuick3DRenderStats::Hitch> hitches = stats.hitchList();
+    QCOMPARE(hitches.size(), 1);
+    QList<QSSGRhiContextStats::ExpensiveEventInfo> events = hitches.last().events;
+    QCOMPARE(quint64(events.size()), end - firstKept);
+    QCOMPARE(events.first().name, QByteArray::number(firstKept));
+    QCOMPARE(events.last().name, QByteArray::number(firstEvent + quint64(eventCount - 1)));
+
+    // Dropping more events after they were seen does not bring back any of
+    // them in the next hitch
+    for (int i = 0; i < eventCount; ++i)
+        contextStats.expensiveEvent(EventType::ShaderGeneration, "later", 1000);
+    contextStats.expensiveEvent(EventType::ShaderGeneration, "last", 1000);
+    const quint64 laterEnd = contextStats.expensiveEventOffset + quint64(contextStats.expensiveEvents.size());
+    const quint64 laterFirst = qMax(end, contextStats.expensiveEventOffset);
+    renderFrame(&stats, 210);
+
+    hitches = stats.hitchList();
+    QCOMPARE(hitches.size(), 2);
+    events = hitches.last().events;
+    QCOMPARE(quint64(events.size()), laterEnd - laterFirst);
+    QVERIFY(std::all_of(events.cbegin(), events.cend() - 1,
+                        [](const QSSGRhiContextStats::ExpensiveEventInfo &event) { return event.name == "later"; }));
+    QCOMPARE(events.last().name, QByteArray("last"));
+}
+
+QTEST_APPLESS_MAIN(tst_QQuick3DRenderStats)
+#include "tst_qquick3drenderstats.moc"
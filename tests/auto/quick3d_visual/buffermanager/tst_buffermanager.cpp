@@ -7,7 +7,11 @@
 #include <private/qquick3dviewport_p.h>
 #include <ssg/qssgrendercontextcore.h>
 #include <private/qssgrenderbuffermanager_p.h>
+#include <private/qssgrhimeshpool_p.h>
+#include <private/qssgrendermesh_p.h>
 #include <private/qquick3dresourceloader_p.h>
+#include <private/qquick3dobject_p.h>
+#include <QtQuick3D/qquick3dgeometry.h>
 
 #if QT_CONFIG(vulkan)
 #include <QVulkanInstance>
@@ -38,6 +42,9 @@ private slots:
     void staticScene_data();
     void staticScene();
     void dynamicScene();
+    void residencyBudget();
+    void meshBufferPooling();
+    void partialGeometryUpdate();
 
 private:
     bool initRenderer(QQuick3DTestOffscreenRenderer *renderer, const QString &filename);
@@ -327,6 +334,231 @@ void tst_BufferManager::dynamicScene()
     QCOMPARE(bufferManager->getCustomMeshMap().size(), 0);
 }
 
+void tst_BufferManager::residencyBudget()
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    QVERIFY(initRenderer(&renderer, QString("dynamic.qml")));
+
+    if (renderer.quickWindow->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL) {
+#ifdef Q_OS_MACOS
+        QSKIP("Skipping test due to sofware OpenGL renderer problems on macOS");
+#endif
+    }
+
+    bool readCompleted = false;
+    QRhiReadbackResult readResult;
+    QImage result;
+
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    const auto &context = QQuick3DSceneManager::getOrSetWindowAttachment(*renderer.quickWindow)->rci();
+    QVERIFY(context);
+
+    const auto &bufferManager = context->bufferManager();
+    bufferManager->setResidencyBudget(quint64(256) * 1024 * 1024);
+
+    const auto controller = renderer.rootItem->property("controller").value<QQuick3DNode*>();
+    QVERIFY(controller);
+
+    auto addModel = [controller](const QString &path) -> QQuick3DModel* {
+        QQuick3DModel *model = nullptr;
+        QMetaObject::invokeMethod(controller, "addModel", Q_RETURN_ARG(QQuick3DModel*, model), Q_ARG(QString, path));
+        return model;
+    };
+
+    auto addTexture = [controller](const QString &path) -> QQuick3DTexture* {
+        QQuick3DTexture *texture = nullptr;
+        QMetaObject::invokeMethod(controller, "addTexture", Q_RETURN_ARG(QQuick3DTexture*, texture), Q_ARG(QString, path));
+        return texture;
+    };
+
+    // Unreferenced resources stay resident while within the budget
+    QQuick3DModel *model = addModel("#Cube");
+    auto texture = addTexture("noise1.jpg");
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getMeshMap().size(), 2);
+    QCOMPARE(bufferManager->getImageMap().size(), 1);
+    QMetaObject::invokeMethod(controller, "removeModel", Qt::DirectConnection);
+    delete model;
+    QMetaObject::invokeMethod(controller, "removeTexture");
+    delete texture;
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getMeshMap().size(), 2);
+    QCOMPARE(bufferManager->getImageMap().size(), 1);
+    QCOMPARE(bufferManager->residencyStats().cachedCount, 2);
+    QVERIFY(bufferManager->residencyStats().cachedSize > 0);
+
+    // Requesting them again revives them without a reload
+    const quint64 misses = bufferManager->residencyStats().misses;
+    const quint64 hits = bufferManager->residencyStats().hits;
+    model = addModel("#Cube");
+    texture = addTexture("noise1.jpg");
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->residencyStats().misses, misses);
+    QCOMPARE(bufferManager->residencyStats().hits, hits + 2);
+    QCOMPARE(bufferManager->residencyStats().cachedCount, 0);
+
+    // Exceeding the budget evicts the unreferenced resources
+    QMetaObject::invokeMethod(controller, "removeModel", Qt::DirectConnection);
+    delete model;
+    QMetaObject::invokeMethod(controller, "removeTexture");
+    delete texture;
+    bufferManager->setResidencyBudget(1);
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getMeshMap().size(), 1);
+    QCOMPARE(bufferManager->getImageMap().size(), 0);
+    QCOMPARE(bufferManager->residencyStats().cachedCount, 0);
+    QVERIFY(bufferManager->residencyStats().evictions >= 2);
+
+    bufferManager->setResidencyBudget(0);
+}
+
+void tst_BufferManager::meshBufferPooling()
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    QVERIFY(initRenderer(&renderer, QString("dynamic.qml")));
+
+    if (renderer.quickWindow->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL) {
+#ifdef Q_OS_MACOS
+        QSKIP("Skipping test due to sofware OpenGL renderer problems on macOS");
+#endif
+    }
+
+    bool readCompleted = false;
+    QRhiReadbackResult readResult;
+    QImage result;
+
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    const auto &context = QQuick3DSceneManager::getOrSetWindowAttachment(*renderer.quickWindow)->rci();
+    QVERIFY(context);
+    if (!QSSGRhiMeshPool::isSupported(context->rhiContext()->rhi()))
+        QSKIP("Mesh buffer pooling needs QRhi::BaseVertex");
+
+    const auto &bufferManager = context->bufferManager();
+    bufferManager->setMeshBufferPoolingEnabled(true);
+
+    const auto controller = renderer.rootItem->property("controller").value<QQuick3DNode*>();
+    QVERIFY(controller);
+
+    auto addModel = [controller](const QString &path) -> QQuick3DModel* {
+        QQuick3DModel *model = nullptr;
+        QMetaObject::invokeMethod(controller, "addModel", Q_RETURN_ARG(QQuick3DModel*, model), Q_ARG(QString, path));
+        return model;
+    };
+
+    QQuick3DModel *cone = addModel("#Cone");
+    QQuick3DModel *cylinder = addModel("#Cylinder");
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    const QSSGRenderMesh *coneMesh = bufferManager->getMeshMap().value(QSSGRenderPath(QStringLiteral("#Cone"))).mesh;
+    const QSSGRenderMesh *cylinderMesh = bufferManager->getMeshMap().value(QSSGRenderPath(QStringLiteral("#Cylinder"))).mesh;
+    QVERIFY(coneMesh && cylinderMesh);
+    QVERIFY(coneMesh->pooledVertexData.isValid());
+    QVERIFY(cylinderMesh->pooledVertexData.isValid());
+
+    // Same vertex layout, so both live in the same buffer, one after the other
+    QCOMPARE(coneMesh->pooledVertexData.buffer, cylinderMesh->pooledVertexData.buffer);
+    QCOMPARE(coneMesh->subsets[0].rhi.vertexBuffer, cylinderMesh->subsets[0].rhi.vertexBuffer);
+    QVERIFY(coneMesh->pooledVertexData.offset != cylinderMesh->pooledVertexData.offset);
+    const quint32 stride = cylinderMesh->subsets[0].rhi.vertexBuffer->stride();
+    QCOMPARE(cylinderMesh->subsets[0].rhi.baseVertex, cylinderMesh->pooledVertexData.offset / stride);
+
+    QSSGRhiMeshPool *pool = QSSGRhiContextPrivate::get(context->rhiContext().get())->m_meshPool;
+    QVERIFY(pool);
+    const quint32 allocationCount = pool->stats().allocationCount;
+    QVERIFY(allocationCount >= 2);
+
+    // Releasing the meshes gives the ranges back to the pool
+    QMetaObject::invokeMethod(controller, "removeModel", Qt::DirectConnection);
+    delete cylinder;
+    QMetaObject::invokeMethod(controller, "removeModel", Qt::DirectConnection);
+    delete cone;
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QVERIFY(pool->stats().allocationCount < allocationCount);
+
+    bufferManager->setMeshBufferPoolingEnabled(false);
+}
+
+void tst_BufferManager::partialGeometryUpdate()
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    QVERIFY(initRenderer(&renderer, QString("dynamic.qml")));
+
+    if (renderer.quickWindow->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL) {
+#ifdef Q_OS_MACOS
+        QSKIP("Skipping test due to sofware OpenGL renderer problems on macOS");
+#endif
+    }
+
+    bool readCompleted = false;
+    QRhiReadbackResult readResult;
+    QImage result;
+
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    const auto &context = QQuick3DSceneManager::getOrSetWindowAttachment(*renderer.quickWindow)->rci();
+    QVERIFY(context);
+    const auto &bufferManager = context->bufferManager();
+
+    const auto controller = renderer.rootItem->property("controller").value<QQuick3DNode*>();
+    QVERIFY(controller);
+
+    QQuick3DModel *model = nullptr;
+    QMetaObject::invokeMethod(controller, "addModel", Q_RETURN_ARG(QQuick3DModel*, model), Q_ARG(QString, QString()));
+    QVERIFY(model);
+
+    // A triangle strip with 64 vertices
+    constexpr int vertexCount = 64;
+    QByteArray vertices(vertexCount * 3 * sizeof(float), Qt::Uninitialized);
+    float *p = reinterpret_cast<float *>(vertices.data());
+    for (int i = 0; i < vertexCount; ++i) {
+        *p++ = float(i / 2) * 10.0f;
+        *p++ = float(i % 2) * 10.0f;
+        *p++ = 0.0f;
+    }
+
+    auto geometry = new QQuick3DGeometry(model);
+    geometry->setStride(3 * sizeof(float));
+    geometry->setPrimitiveType(QQuick3DGeometry::PrimitiveType::TriangleStrip);
+    geometry->addAttribute(QQuick3DGeometry::Attribute::PositionSemantic, 0, QQuick3DGeometry::Attribute::F32Type);
+    geometry->setBounds(QVector3D(0, 0, 0), QVector3D(320, 10, 0));
+    geometry->setVertexData(vertices);
+    model->setGeometry(geometry);
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    auto *geometryNode = static_cast<QSSGRenderGeometry *>(QQuick3DObjectPrivate::get(geometry)->spatialNode);
+    QVERIFY(geometryNode);
+    const QSSGRenderMesh *mesh = bufferManager->getCustomMeshMap().value(geometryNode).mesh;
+    QVERIFY(mesh);
+    const quint64 uploadedSize = bufferManager->geometryUploadStats().uploadedSize;
+    const quint64 partialUpdates = bufferManager->geometryUploadStats().partialUpdates;
+    QVERIFY(uploadedSize >= quint64(vertices.size()));
+
+    // Changing a few vertices keeps the buffers and uploads only the change
+    const QByteArray changed(2 * 3 * sizeof(float), 0);
+    geometry->setVertexData(12 * 3 * sizeof(float), changed);
+    geometry->update();
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    QCOMPARE(bufferManager->getCustomMeshMap().value(geometryNode).mesh, mesh);
+    QCOMPARE(bufferManager->geometryUploadStats().partialUpdates, partialUpdates + 1);
+    QCOMPARE(bufferManager->geometryUploadStats().uploadedSize, uploadedSize + quint64(changed.size()));
+    QCOMPARE(geometryNode->vertexBuffer(), geometry->vertexData());
+
+    // Replacing all the data rebuilds the mesh
+    geometry->setVertexData(vertices);
+    geometry->update();
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    QCOMPARE(bufferManager->geometryUploadStats().partialUpdates, partialUpdates + 1);
+    QCOMPARE(bufferManager->geometryUploadStats().uploadedSize,
+             uploadedSize + quint64(changed.size()) + quint64(vertices.size()));
+
+    QMetaObject::invokeMethod(controller, "removeModel", Qt::DirectConnection);
+    delete model;
+}
+
 bool tst_BufferManager::initRenderer(QQuick3DTestOffscreenRenderer *renderer, const QString &filename)
 {
     const bool initSuccess = renderer->init(testFileUrl(filename),
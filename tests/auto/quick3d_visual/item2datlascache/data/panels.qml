@@ -0,0 +1,65 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+import QtQuick
+import QtQuick3D
+
+View3D {
+    width: 320
+    height: 240
+
+    environment: SceneEnvironment {
+        backgroundMode: SceneEnvironment.Color
+        clearColor: "black"
+    }
+
+    PerspectiveCamera {
+        z: 300
+    }
+
+    DirectionalLight { }
+
+    // Partly in front of the second panel, which is depth tested against it
+    Model {
+        source: "#Cube"
+        x: 60
+        z: 50
+        scale: Qt.vector3d(0.5, 0.5, 0.5)
+        materials: PrincipledMaterial { baseColor: "white" }
+    }
+
+    Node {
+        x: -140
+        y: 60
+        Rectangle {
+            width: 100
+            height: 60
+            color: "red"
+            Text {
+                anchors.centerIn: parent
+                text: "Static"
+                color: "white"
+            }
+        }
+    }
+
+    Node {
+        x: 20
+        y: 20
+        eulerRotation.y: 20
+        Rectangle {
+            objectName: "panel"
+            width: 120
+            height: 80
+            color: "blue"
+            Rectangle {
+                x: 10
+                y: 10
+                width: 40
+                height: 40
+                radius: 20
+                color: "yellow"
+            }
+        }
+    }
+}
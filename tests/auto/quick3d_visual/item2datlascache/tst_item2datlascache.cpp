@@ -0,0 +1,185 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QQuickWindow>
+#include <QQuickRenderControl>
+#include <QQuickItem>
+
+#include <private/qquick3dviewport_p.h>
+#include <private/qquick3dscenemanager_p.h>
+#include <private/qquick3drenderstats_p.h>
+#include <ssg/qssgrendercontextcore.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhiitem2dcache_p.h>
+
+#if QT_CONFIG(vulkan)
+#include <QVulkanInstance>
+#endif
+
+#include "../shared/util.h"
+
+// Item2Ds cached in the atlas are drawn as textured quads. They have to look
+// the same as when their 2D scene graph is rendered inline, also after their
+// content changes.
+class tst_Item2DAtlasCache : public QQuick3DDataTest
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() override;
+    void cleanup();
+    void cachedMatchesInline();
+
+private:
+    bool initRenderer(QQuick3DTestOffscreenRenderer *renderer, const QString &filename);
+    QImage renderFrame(QQuick3DTestOffscreenRenderer *renderer);
+    QSSGRhiContextStats::Item2DAtlasInfo atlasInfo(QQuick3DTestOffscreenRenderer *renderer);
+
+#if QT_CONFIG(vulkan)
+    QVulkanInstance vulkanInstance;
+#endif
+};
+
+void tst_Item2DAtlasCache::initTestCase()
+{
+    QQuick3DDataTest::initTestCase();
+    if (!initialized())
+        return;
+
+#if QT_CONFIG(vulkan)
+    vulkanInstance.create(); // may fail, which is fine is Vulkan is not used in the first place
+#endif
+}
+
+void tst_Item2DAtlasCache::cleanup()
+{
+    QSSGRhiItem2DCache::setEnabled(false);
+}
+
+bool tst_Item2DAtlasCache::initRenderer(QQuick3DTestOffscreenRenderer *renderer, const QString &filename)
+{
+    const bool initSuccess = renderer->init(testFileUrl(filename),
+#if QT_CONFIG(vulkan)
+                                            &vulkanInstance
+#else
+                                            nullptr
+#endif
+        );
+    if (!initSuccess)
+        return false;
+
+    // Records the atlas usage from the first frame on
+    auto *view3D = qobject_cast<QQuick3DViewport *>(renderer->rootItem);
+    if (!view3D)
+        return false;
+    view3D->renderStats()->setExtendedDataCollectionEnabled(true);
+    return true;
+}
+
+QImage tst_Item2DAtlasCache::renderFrame(QQuick3DTestOffscreenRenderer *renderer)
+{
+    bool readCompleted = false;
+    QRhiReadbackResult readResult;
+    QImage result;
+
+    renderer->renderControl->polishItems();
+    renderer->renderControl->beginFrame();
+    renderer->renderControl->sync();
+    renderer->renderControl->render();
+    renderer->enqueueReadback(&readCompleted, &readResult, &result);
+    renderer->renderControl->endFrame();
+
+    return readCompleted ? result : QImage();
+}
+
+QSSGRhiContextStats::Item2DAtlasInfo tst_Item2DAtlasCache::atlasInfo(QQuick3DTestOffscreenRenderer *renderer)
+{
+    const auto &context = QQuick3DSceneManager::getOrSetWindowAttachment(*renderer->quickWindow)->rci();
+    if (!context)
+        return {};
+    const QSSGRhiContextStats &stats = QSSGRhiContextStats::get(*context->rhiContext());
+    // One View3D, so one layer
+    if (stats.perLayerInfo.isEmpty())
+        return {};
+    return stats.perLayerInfo.cbegin()->item2DAtlas;
+}
+
+// The quads are sampled with bilinear filtering, so the edges of the items
+// may be off by a little. Allows for about a one pixel wide outline around
+// each of them.
+static bool compareImages(const QImage &actual, const QImage &expected)
+{
+    if (actual.size() != expected.size() || actual.isNull()) {
+        qWarning() << "Image size" << actual.size() << "expected" << expected.size();
+        return false;
+    }
+    const int fuzz = 8;
+    const int maxDifferentPixels = 2 * (actual.width() + actual.height());
+    const QImage a = actual.convertToFormat(QImage::Format_RGBA8888);
+    const QImage e = expected.convertToFormat(QImage::Format_RGBA8888);
+    int differentPixels = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        const uchar *aLine = a.constScanLine(y);
+        const uchar *eLine = e.constScanLine(y);
+        for (int x = 0; x < a.width() * 4; x += 4) {
+            for (int c = 0; c < 4; ++c) {
+                if (qAbs(int(aLine[x + c]) - int(eLine[x + c])) > fuzz) {
+                    ++differentPixels;
+                    break;
+                }
+            }
+        }
+    }
+    if (differentPixels > maxDifferentPixels) {
+        qWarning() << differentPixels << "pixels differ, at most" << maxDifferentPixels << "allowed";
+        return false;
+    }
+    return true;
+}
+
+void tst_Item2DAtlasCache::cachedMatchesInline()
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    QVERIFY(initRenderer(&renderer, QStringLiteral("panels.qml")));
+
+    QSSGRhiItem2DCache::setEnabled(false);
+    const QImage inlineImage = renderFrame(&renderer);
+    QVERIFY(!inlineImage.isNull());
+    QCOMPARE(atlasInfo(&renderer).cachedItemCount, 0);
+
+    QSSGRhiItem2DCache::setEnabled(true);
+    QVERIFY(compareImages(renderFrame(&renderer), inlineImage));
+    QCOMPARE(atlasInfo(&renderer).cachedItemCount, 2);
+
+    // Unchanged items are drawn from the atlas without rendering them again,
+    // once the 2D scene graphs have settled after the first frames
+    renderFrame(&renderer);
+    const QImage cachedImage = renderFrame(&renderer);
+    QCOMPARE(atlasInfo(&renderer).renderedItemCount, 0);
+    QVERIFY(compareImages(cachedImage, inlineImage));
+
+    // Only the changed item is rendered again, with its new content
+    QObject *panel = renderer.rootItem->findChild<QObject *>(QStringLiteral("panel"));
+    QVERIFY(panel);
+    panel->setProperty("color", QColor(Qt::green));
+    const QImage changedCachedImage = renderFrame(&renderer);
+    QCOMPARE(atlasInfo(&renderer).renderedItemCount, 1);
+    QVERIFY(!compareImages(changedCachedImage, cachedImage));
+
+    QSSGRhiItem2DCache::setEnabled(false);
+    const QImage changedInlineImage = renderFrame(&renderer);
+    QCOMPARE(atlasInfo(&renderer).cachedItemCount, 0);
+    QVERIFY(compareImages(changedCachedImage, changedInlineImage));
+
+    // A resized item gets a new slot
+    QSSGRhiItem2DCache::setEnabled(true);
+    panel->setProperty("width", 200.0);
+    const QImage resizedCachedImage = renderFrame(&renderer);
+    QSSGRhiItem2DCache::setEnabled(false);
+    QVERIFY(compareImages(resizedCachedImage, renderFrame(&renderer)));
+}
+
+QTEST_MAIN(tst_Item2DAtlasCache)
+
+#include "tst_item2datlascache.moc"
@@ -0,0 +1,31 @@
+import QtQuick
+import QtQuick3D
+
+View3D {
+    width: 320
+    height: 240
+    environment: SceneEnvironment {
+        backgroundMode: SceneEnvironment.Color
+        clearColor: "black"
+    }
+    PerspectiveCamera { z: 600 }
+    DirectionalLight { }
+    ReflectionProbe {
+        boxSize: Qt.vector3d(1000, 1000, 1000)
+        refreshMode: ReflectionProbe.FirstFrame
+        clearColor: "gray"
+    }
+    Model {
+        source: "#Sphere"
+        receivesReflections: true
+        materials: PrincipledMaterial {
+            metalness: 1
+            roughness: 0.1
+        }
+    }
+    Model {
+        source: "#Cube"
+        x: 200
+        materials: PrincipledMaterial { baseColor: "red" }
+    }
+}
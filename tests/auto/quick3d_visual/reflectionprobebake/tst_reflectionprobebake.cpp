@@ -0,0 +1,164 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QQuickWindow>
+#include <QQuickRenderControl>
+#include <QQuickItem>
+#include <QTemporaryDir>
+#include <QBuffer>
+#include <QDir>
+
+#include <algorithm>
+
+#include <QtGui/private/qtexturefilereader_p.h>
+
+#if QT_CONFIG(vulkan)
+#include <QVulkanInstance>
+#endif
+
+#include "../shared/util.h"
+
+// Bakes with the platform's default backend: the Null backend reads back
+// zeros, which would make any two bakes compare equal.
+class tst_ReflectionProbeBake : public QQuick3DDataTest
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() override;
+    void bakeIsStable();
+    void bakeFollowsSceneChanges_data();
+    void bakeFollowsSceneChanges();
+
+private:
+    QByteArray bake(const char *filename, QString *fileName);
+
+    QTemporaryDir m_bakeDir;
+#if QT_CONFIG(vulkan)
+    QVulkanInstance vulkanInstance;
+#endif
+};
+
+void tst_ReflectionProbeBake::initTestCase()
+{
+    QVERIFY(m_bakeDir.isValid());
+    qputenv("QT_QUICK3D_BAKE_REFLECTION_PROBES", "1");
+    qputenv("QT_QUICK3D_REFLECTION_PROBE_BAKE_PATH", m_bakeDir.path().toLocal8Bit());
+
+    QQuick3DDataTest::initTestCase();
+}
+
+QByteArray tst_ReflectionProbeBake::bake(const char *filename, QString *fileName)
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    const bool initSuccess = renderer.init(testFileUrl(QString::fromLatin1(filename)),
+#if QT_CONFIG(vulkan)
+                                           &vulkanInstance
+#else
+                                           nullptr
+#endif
+        );
+    if (!initSuccess)
+        return {};
+
+    // The readbacks of the first frame have completed after the second
+    for (int frame = 0; frame < 2; ++frame) {
+        renderer.renderControl->polishItems();
+        renderer.renderControl->beginFrame();
+        renderer.renderControl->sync();
+        renderer.renderControl->render();
+        renderer.renderControl->endFrame();
+    }
+
+    QDir dir(m_bakeDir.path());
+    const QStringList files = dir.entryList({ QStringLiteral("qrp_*.ktx") }, QDir::Files);
+    if (files.size() != 1)
+        return {};
+
+    QFile file(dir.filePath(files.first()));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    const QByteArray data = file.readAll();
+    file.close();
+    file.remove();
+    *fileName = files.first();
+    return data;
+}
+
+// The six faces of the first mip level
+static QByteArray baseLevel(const QByteArray &ktx, const QString &fileName)
+{
+    QByteArray data = ktx;
+    QBuffer buffer(&data);
+    if (!buffer.open(QIODevice::ReadOnly))
+        return {};
+    QTextureFileReader reader(&buffer, fileName);
+    const QTextureFileData fileData = reader.read();
+    if (!fileData.isValid())
+        return {};
+    QByteArray level;
+    for (int face = 0; face < fileData.numFaces(); ++face)
+        level.append(fileData.data().constData() + fileData.dataOffset(0, face), fileData.dataLength(0, face));
+    return level;
+}
+
+static bool hasContent(const QByteArray &ktx, const QString &fileName)
+{
+    const QByteArray level = baseLevel(ktx, fileName);
+    return std::any_of(level.cbegin(), level.cend(), [](char c) { return c != 0; });
+}
+
+void tst_ReflectionProbeBake::bakeIsStable()
+{
+    QString firstFileName;
+    const QByteArray first = bake("static_probe.qml", &firstFileName);
+    QVERIFY(!first.isEmpty());
+
+    QByteArray data = first;
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QTextureFileReader reader(&buffer, firstFileName);
+    QVERIFY(reader.canRead());
+    const QTextureFileData fileData = reader.read();
+    QVERIFY(fileData.isValid());
+    QCOMPARE(fileData.numFaces(), 6);
+    QVERIFY(fileData.numLevels() > 1);
+    QCOMPARE(fileData.size(), QSize(256, 256));
+    QVERIFY(hasContent(first, firstFileName));
+
+    // Same scene, same key, same bytes
+    QString secondFileName;
+    const QByteArray second = bake("static_probe.qml", &secondFileName);
+    QCOMPARE(secondFileName, firstFileName);
+    QCOMPARE(second, first);
+}
+
+void tst_ReflectionProbeBake::bakeFollowsSceneChanges_data()
+{
+    QTest::addColumn<QString>("filename");
+    QTest::newRow("light") << QStringLiteral("static_probe_light.qml");
+    QTest::newRow("material") << QStringLiteral("static_probe_material.qml");
+}
+
+// An edited scene gets a different key, so the probe is baked again instead
+// of showing the map of the original scene.
+void tst_ReflectionProbeBake::bakeFollowsSceneChanges()
+{
+    QFETCH(QString, filename);
+
+    QString originalFileName;
+    const QByteArray original = bake("static_probe.qml", &originalFileName);
+    QVERIFY(!original.isEmpty());
+
+    QString changedFileName;
+    const QByteArray changed = bake(qPrintable(filename), &changedFileName);
+    QVERIFY(!changed.isEmpty());
+    QVERIFY(changedFileName != originalFileName);
+    QVERIFY(hasContent(changed, changedFileName));
+    QVERIFY(baseLevel(changed, changedFileName) != baseLevel(original, originalFileName));
+}
+
+QTEST_MAIN(tst_ReflectionProbeBake)
+
+#include "tst_reflectionprobebake.moc"
@@ -0,0 +1,47 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+import QtQuick
+import QtQuick3D
+
+View3D {
+    width: 320
+    height: 240
+
+    environment: SceneEnvironment {
+        backgroundMode: SceneEnvironment.Color
+        clearColor: "black"
+    }
+
+    PerspectiveCamera {
+        position: Qt.vector3d(0, 300, 600)
+        eulerRotation.x: -25
+    }
+
+    DirectionalLight {
+        eulerRotation.x: -60
+        castsShadow: true
+        csmNumSplits: 0
+    }
+
+    Model {
+        objectName: "caster"
+        source: "#Cube"
+        materials: PrincipledMaterial {
+            alphaMode: PrincipledMaterial.Mask
+            baseColorMap: Texture {
+                objectName: "alphaTexture"
+                source: "alpha1.png"
+            }
+        }
+    }
+
+    Model {
+        source: "#Rectangle"
+        y: -50
+        scale: Qt.vector3d(10, 10, 1)
+        eulerRotation.x: -90
+        castsShadows: false
+        materials: PrincipledMaterial { }
+    }
+}
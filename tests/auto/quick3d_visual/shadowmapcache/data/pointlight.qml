@@ -0,0 +1,49 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+import QtQuick
+import QtQuick3D
+
+// One caster on the +X side and one on the -X side of the light, each one
+// within the frustum of a single cube face.
+View3D {
+    width: 320
+    height: 240
+
+    environment: SceneEnvironment {
+        backgroundMode: SceneEnvironment.Color
+        clearColor: "black"
+    }
+
+    PerspectiveCamera {
+        position: Qt.vector3d(0, 200, 800)
+        eulerRotation.x: -15
+    }
+
+    PointLight {
+        castsShadow: true
+        shadowMapFar: 1000
+    }
+
+    Model {
+        objectName: "rightCaster"
+        source: "#Cube"
+        x: 300
+        materials: PrincipledMaterial { }
+    }
+
+    Model {
+        source: "#Cube"
+        x: -300
+        materials: PrincipledMaterial { }
+    }
+
+    Model {
+        source: "#Rectangle"
+        y: -200
+        scale: Qt.vector3d(20, 20, 1)
+        eulerRotation.x: -90
+        castsShadows: false
+        materials: PrincipledMaterial { }
+    }
+}
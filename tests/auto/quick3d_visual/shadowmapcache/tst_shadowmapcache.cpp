@@ -0,0 +1,158 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QTest>
+#include <QQuickWindow>
+#include <QQuickRenderControl>
+#include <QQuickItem>
+
+#include <private/qquick3dviewport_p.h>
+#include <private/qquick3dscenemanager_p.h>
+#include <private/qquick3drenderstats_p.h>
+#include <ssg/qssgrendercontextcore.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+
+#if QT_CONFIG(vulkan)
+#include <QVulkanInstance>
+#endif
+
+#include "../shared/util.h"
+
+// Shadow maps are only rendered again when what the casters would draw into
+// them changes. Which maps got rendered in a frame is told by the render
+// passes recorded in the stats of the window's QSSGRhiContext.
+class tst_ShadowMapCache : public QQuick3DDataTest
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase() override;
+    void staticCastersReuseMaps();
+    void cubeFacesCullCasters();
+
+private:
+    bool initRenderer(QQuick3DTestOffscreenRenderer *renderer, const QString &filename);
+    QList<QSSGRhiContextStats::RenderPassInfo> renderFrame(QQuick3DTestOffscreenRenderer *renderer);
+
+#if QT_CONFIG(vulkan)
+    QVulkanInstance vulkanInstance;
+#endif
+};
+
+void tst_ShadowMapCache::initTestCase()
+{
+    QQuick3DDataTest::initTestCase();
+    if (!initialized())
+        return;
+
+#if QT_CONFIG(vulkan)
+    vulkanInstance.create(); // may fail, which is fine is Vulkan is not used in the first place
+#endif
+}
+
+bool tst_ShadowMapCache::initRenderer(QQuick3DTestOffscreenRenderer *renderer, const QString &filename)
+{
+    const bool initSuccess = renderer->init(testFileUrl(filename),
+#if QT_CONFIG(vulkan)
+                                            &vulkanInstance
+#else
+                                            nullptr
+#endif
+        );
+    if (!initSuccess)
+        return false;
+
+    // Records the render passes from the first frame on
+    auto *view3D = qobject_cast<QQuick3DViewport *>(renderer->rootItem);
+    if (!view3D)
+        return false;
+    view3D->renderStats()->setExtendedDataCollectionEnabled(true);
+    return true;
+}
+
+// The shadow map passes of the frame
+QList<QSSGRhiContextStats::RenderPassInfo> tst_ShadowMapCache::renderFrame(QQuick3DTestOffscreenRenderer *renderer)
+{
+    renderer->renderControl->polishItems();
+    renderer->renderControl->beginFrame();
+    renderer->renderControl->sync();
+    renderer->renderControl->render();
+    renderer->renderControl->endFrame();
+
+    QList<QSSGRhiContextStats::RenderPassInfo> passes;
+    const auto &context = QQuick3DSceneManager::getOrSetWindowAttachment(*renderer->quickWindow)->rci();
+    if (!context)
+        return passes;
+    const QSSGRhiContextStats &stats = QSSGRhiContextStats::get(*context->rhiContext());
+    for (const auto &layerInfo : stats.perLayerInfo) {
+        for (const auto &pass : layerInfo.renderPasses) {
+            if (pass.rtName.contains("shadow"))
+                passes.append(pass);
+        }
+    }
+    return passes;
+}
+
+static quint64 drawCallCount(const QList<QSSGRhiContextStats::RenderPassInfo> &passes)
+{
+    quint64 count = 0;
+    for (const auto &pass : passes)
+        count += QSSGRhiContextStats::totalDrawCallCountForPass(pass);
+    return count;
+}
+
+void tst_ShadowMapCache::staticCastersReuseMaps()
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    QVERIFY(initRenderer(&renderer, QStringLiteral("directional.qml")));
+
+    QVERIFY(!renderFrame(&renderer).isEmpty());
+    // The material is no longer dirty after the first frames
+    renderFrame(&renderer);
+    QVERIFY(renderFrame(&renderer).isEmpty());
+    QVERIFY(renderFrame(&renderer).isEmpty());
+
+    // A moved caster renders the map once, then it is reused again
+    QObject *caster = renderer.rootItem->findChild<QObject *>(QStringLiteral("caster"));
+    QVERIFY(caster);
+    caster->setProperty("x", 20.0);
+    const auto movedPasses = renderFrame(&renderer);
+    QCOMPARE(movedPasses.size(), 1);
+    QCOMPARE(drawCallCount(movedPasses), quint64(1));
+    QVERIFY(renderFrame(&renderer).isEmpty());
+
+    // The alpha mask of the caster decides where it casts a shadow
+    QObject *alphaTexture = renderer.rootItem->findChild<QObject *>(QStringLiteral("alphaTexture"));
+    QVERIFY(alphaTexture);
+    alphaTexture->setProperty("source", testFileUrl("alpha2.png"));
+    QVERIFY(!renderFrame(&renderer).isEmpty());
+    QVERIFY(renderFrame(&renderer).isEmpty());
+}
+
+void tst_ShadowMapCache::cubeFacesCullCasters()
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    QVERIFY(initRenderer(&renderer, QStringLiteral("pointlight.qml")));
+
+    // Each face draws only the caster within its frustum
+    const auto firstPasses = renderFrame(&renderer);
+    QCOMPARE(firstPasses.size(), 6);
+    QCOMPARE(drawCallCount(firstPasses), quint64(2));
+
+    renderFrame(&renderer);
+    QVERIFY(renderFrame(&renderer).isEmpty());
+
+    // Only the face the moved caster is in is rendered again
+    QObject *caster = renderer.rootItem->findChild<QObject *>(QStringLiteral("rightCaster"));
+    QVERIFY(caster);
+    caster->setProperty("y", 10.0);
+    const auto movedPasses = renderFrame(&renderer);
+    QCOMPARE(movedPasses.size(), 1);
+    QVERIFY(movedPasses.first().rtName.contains("shadow cube face"));
+    QCOMPARE(drawCallCount(movedPasses), quint64(1));
+    QVERIFY(renderFrame(&renderer).isEmpty());
+}
+
+QTEST_MAIN(tst_ShadowMapCache)
+
+#include "tst_shadowmapcache.moc"
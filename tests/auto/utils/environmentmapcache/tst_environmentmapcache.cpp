@@ -0,0 +1,254 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgenvironmentmapcache_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgreflectionprobebaker_p.h>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <ssg/qssgrendercontextcore.h>
+
+#include <QtGui/private/qtexturefilereader_p.h>
+
+#include "../../../shared/nullrendercontext.h"
+
+class tst_QSSGEnvironmentMapCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGEnvironmentMapCache() = default;
+    ~tst_QSSGEnvironmentMapCache() = default;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void test_sourceKey();
+    void test_sourceKeyFromFile();
+    void test_cachedMapPath();
+    void test_cachedMapIsPrebaked();
+    void test_cacheHitSkipsPrefilter();
+    void test_progressiveSwap();
+
+private:
+    void nextFrame();
+    QString writeLightProbe(const QString &name, int size, uchar value) const;
+    int framesUntilSwapped(const QSSGRenderImage &image, int loadsPerFrame);
+
+    std::unique_ptr<NullRenderContext> m_context;
+    QTemporaryDir m_dir;
+    quint32 m_frameId = 0;
+};
+
+void tst_QSSGEnvironmentMapCache::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    // Read once, before the first light probe is loaded
+    qputenv("QT_QUICK3D_IBL_CACHE_PATH", QFile::encodeName(m_dir.filePath(QStringLiteral("cache"))));
+
+    m_context = std::make_unique<NullRenderContext>();
+    QVERIFY(m_context->isValid());
+}
+
+void tst_QSSGEnvironmentMapCache::cleanupTestCase()
+{
+    QThreadPool::globalInstance()->waitForDone();
+    m_context.reset();
+    qunsetenv("QT_QUICK3D_IBL_CACHE_PATH");
+}
+
+void tst_QSSGEnvironmentMapCache::nextFrame()
+{
+    m_context->nextFrame();
+    m_context->renderContext()->bufferManager()->resetUsageCounters(++m_frameId, nullptr);
+}
+
+// A flat colored Radiance HDR image, size x size pixels
+QString tst_QSSGEnvironmentMapCache::writeLightProbe(const QString &name, int size, uchar value) const
+{
+    const QString path = m_dir.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return {};
+    file.write("#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n");
+    file.write(QByteArray("-Y ") + QByteArray::number(size) + " +X " + QByteArray::number(size) + "\n");
+    const uchar channels[4] = { value, value, value, 128 };
+    for (int y = 0; y < size; ++y) {
+        QByteArray line;
+        line.append(char(2)).append(char(2)).append(char(size >> 8)).append(char(size & 0xFF));
+        for (uchar channel : channels) {
+            for (int x = 0; x < size; x += 128) {
+                const int count = qMin(128, size - x);
+                line.append(char(count)).append(QByteArray(count, char(channel)));
+            }
+        }
+        file.write(line);
+    }
+    return path;
+}
+
+void tst_QSSGEnvironmentMapCache::test_sourceKey()
+{
+    const QSSGRenderTextureFormat rgba16f(QSSGRenderTextureFormat::RGBA16F);
+    const QSSGRenderTextureFormat rgbe8(QSSGRenderTextureFormat::RGBE8);
+    const QByteArray source = QByteArrayLiteral("#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y 1 +X 1\n");
+
+    const QByteArray key = QSSGEnvironmentMapCache::sourceKey(source, rgba16f);
+    QVERIFY(!key.isEmpty());
+    QCOMPARE(QSSGEnvironmentMapCache::sourceKey(source, rgba16f), key);
+
+    // The contents and the requested format are both part of the key
+    QVERIFY(QSSGEnvironmentMapCache::sourceKey(source + '\0', rgba16f) != key);
+    QVERIFY(QSSGEnvironmentMapCache::sourceKey(source, rgbe8) != key);
+
+    QVERIFY(QSSGEnvironmentMapCache::sourceKey(QByteArray(), rgba16f).isEmpty());
+}
+
+void tst_QSSGEnvironmentMapCache::test_sourceKeyFromFile()
+{
+    const QSSGRenderTextureFormat rgba16f(QSSGRenderTextureFormat::RGBA16F);
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("probe.hdr"));
+    const QByteArray source = QByteArrayLiteral("not really an image");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(source);
+    file.close();
+
+    QCOMPARE(QSSGEnvironmentMapCache::sourceKey(path, rgba16f), QSSGEnvironmentMapCache::sourceKey(source, rgba16f));
+    QVERIFY(QSSGEnvironmentMapCache::sourceKey(dir.filePath(QStringLiteral("missing.hdr")), rgba16f).isEmpty());
+}
+
+void tst_QSSGEnvironmentMapCache::test_cachedMapPath()
+{
+    const QByteArray key = QByteArray::fromHex("00ff");
+    const QByteArray cachePath = qgetenv("QT_QUICK3D_IBL_CACHE_PATH");
+    qputenv("QT_QUICK3D_IBL_CACHE_PATH", "cache");
+    QCOMPARE(QSSGEnvironmentMapCache::cachedMapPath(key), QStringLiteral("cache/qibl_00ff.ktx"));
+    qputenv("QT_QUICK3D_IBL_CACHE_PATH", cachePath);
+}
+
+void tst_QSSGEnvironmentMapCache::test_cachedMapIsPrebaked()
+{
+    // The files are loaded through the same path as the ones from the IBL
+    // baker, which is recognized by the QT_IBL_BAKER_VERSION key
+    constexpr int Size = 32;
+    constexpr int LevelCount = 6;
+    QList<QByteArray> faces;
+    for (int level = 0; level < LevelCount; ++level) {
+        for (int face = 0; face < 6; ++face)
+            faces.append(QByteArray((Size >> level) * (Size >> level) * 8, char(face)));
+    }
+    QByteArray data = QSSGReflectionProbeBaker::ktxData(QSize(Size, Size), faces,
+                                                        { { QByteArrayLiteral("QT_IBL_BAKER_VERSION"), QByteArrayLiteral("1") } });
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QTextureFileReader reader(&buffer, QStringLiteral("qibl_test.ktx"));
+    QVERIFY(reader.canRead());
+    const QTextureFileData fileData = reader.read();
+    QVERIFY(fileData.isValid());
+    QCOMPARE(fileData.numFaces(), 6);
+    QCOMPARE(fileData.numLevels(), LevelCount);
+    QVERIFY(fileData.keyValueMetadata().value("QT_IBL_BAKER_VERSION").startsWith('1'));
+    QVERIFY(!fileData.keyValueMetadata().contains("QT_REFLECTION_PROBE_BAKER_VERSION"));
+}
+
+void tst_QSSGEnvironmentMapCache::test_cacheHitSkipsPrefilter()
+{
+    QVERIFY(QSSGEnvironmentMapCache::isEnabled());
+    const auto &bufferManager = m_context->renderContext()->bufferManager();
+    bufferManager->setProgressiveEnvironmentMapsEnabled(false);
+
+    QSSGRenderImage image;
+    image.m_imagePath = QSSGRenderPath(writeLightProbe(QStringLiteral("hit.hdr"), 64, 200));
+    const QString cachedPath = QSSGEnvironmentMapCache::cachedMapPath(
+            QSSGEnvironmentMapCache::sourceKey(image.m_imagePath.path(), image.m_format));
+    QVERIFY(!QFileInfo::exists(cachedPath));
+
+    // A miss prefilters into a render target, and writes the result once
+    // the readbacks complete
+    const QSSGRenderImageTexture prefiltered = bufferManager->loadRenderImage(&image, QSSGBufferManager::MipModeBsdf);
+    QVERIFY(prefiltered.m_texture);
+    QVERIFY(prefiltered.m_texture->flags().testFlag(QRhiTexture::RenderTarget));
+    const QSize size = prefiltered.m_texture->pixelSize();
+    const int mipmapCount = prefiltered.m_mipmapCount;
+    nextFrame();
+    QThreadPool::globalInstance()->waitForDone();
+    QVERIFY(QFileInfo::exists(cachedPath));
+
+    // A hit uploads the file as is, no render target means no prefiltering
+    bufferManager->releaseCachedResources();
+    nextFrame();
+    const QSSGRenderImageTexture cached = bufferManager->loadRenderImage(&image, QSSGBufferManager::MipModeBsdf);
+    QVERIFY(cached.m_texture);
+    QVERIFY(!cached.m_texture->flags().testFlag(QRhiTexture::RenderTarget));
+    QVERIFY(cached.m_texture->flags().testFlag(QRhiTexture::CubeMap));
+    QCOMPARE(cached.m_texture->pixelSize(), size);
+    QCOMPARE(cached.m_mipmapCount, mipmapCount);
+
+    bufferManager->releaseCachedResources();
+    nextFrame();
+}
+
+int tst_QSSGEnvironmentMapCache::framesUntilSwapped(const QSSGRenderImage &image, int loadsPerFrame)
+{
+    const auto &bufferManager = m_context->renderContext()->bufferManager();
+    const QSSGRenderImageTexture fallback = bufferManager->loadRenderImage(&image, QSSGBufferManager::MipModeBsdf);
+    if (!fallback.m_texture || bufferManager->pendingEnvironmentMapCount() != 1)
+        return -1;
+
+    for (int frame = 1; frame < 1000; ++frame) {
+        nextFrame();
+        QSSGRenderImageTexture texture;
+        // As if several layers used the light probe
+        for (int i = 0; i < loadsPerFrame; ++i)
+            texture = bufferManager->loadRenderImage(&image, QSSGBufferManager::MipModeBsdf);
+        if (bufferManager->pendingEnvironmentMapCount() == 0) {
+            if (texture.m_texture == fallback.m_texture || texture.m_mipmapCount <= fallback.m_mipmapCount)
+                return -1;
+            return frame;
+        }
+        if (texture.m_texture != fallback.m_texture)
+            return -1;
+    }
+    return -1;
+}
+
+void tst_QSSGEnvironmentMapCache::test_progressiveSwap()
+{
+    const auto &bufferManager = m_context->renderContext()->bufferManager();
+    bufferManager->setProgressiveEnvironmentMapsEnabled(true);
+
+    // The fallback is used until the full map is prefiltered, which takes
+    // the same number of frames no matter how many layers use the light probe
+    QSSGRenderImage image;
+    image.m_imagePath = QSSGRenderPath(writeLightProbe(QStringLiteral("progressive1.hdr"), 64, 100));
+    const int frames = framesUntilSwapped(image, 1);
+    QVERIFY(frames > 1);
+    bufferManager->releaseCachedResources();
+    nextFrame();
+
+    QSSGRenderImage sharedImage;
+    sharedImage.m_imagePath = QSSGRenderPath(writeLightProbe(QStringLiteral("progressive2.hdr"), 64, 150));
+    QCOMPARE(framesUntilSwapped(sharedImage, 3), frames);
+
+    // The swapped in map is cached like a synchronously prefiltered one
+    nextFrame();
+    QThreadPool::globalInstance()->waitForDone();
+    QVERIFY(QFileInfo::exists(QSSGEnvironmentMapCache::cachedMapPath(
+            QSSGEnvironmentMapCache::sourceKey(sharedImage.m_imagePath.path(), sharedImage.m_format))));
+
+    bufferManager->releaseCachedResources();
+    bufferManager->setProgressiveEnvironmentMapsEnabled(false);
+    nextFrame();
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGEnvironmentMapCache)
+
+#include "tst_environmentmapcache.moc"
@@ -0,0 +1,81 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <QtGui/rhi/qrhi.h>
+
+class tst_QSSGExpensiveEvents : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGExpensiveEvents() = default;
+    ~tst_QSSGExpensiveEvents() = default;
+
+private slots:
+    void test_historyCapacity();
+    void test_events();
+    void test_eventTrimming();
+};
+
+void tst_QSSGExpensiveEvents::test_historyCapacity()
+{
+    QSSGRhiContextStats::TimingHistory history(4);
+    QCOMPARE(history.capacity(), 4);
+    for (int i = 1; i <= 6; ++i)
+        history.add(i * 10);
+    QCOMPARE(history.size(), 4);
+    QList<qint64> samples = history.samples();
+    std::sort(samples.begin(), samples.end());
+    QCOMPARE(samples, QList<qint64>({ 30, 40, 50, 60 }));
+    QCOMPARE(history.percentile(100), qint64(60));
+    QCOMPARE(history.percentile(1), qint64(30));
+
+    QCOMPARE(QSSGRhiContextStats::TimingHistory(0).capacity(), 1);
+    QCOMPARE(QSSGRhiContextStats::TimingHistory().capacity(), QSSGRhiContextStats::TimingHistory::SampleCount);
+}
+
+void tst_QSSGExpensiveEvents::test_events()
+{
+    std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, nullptr));
+    QVERIFY(rhi);
+    QSSGRhiContext rhiCtx(rhi.get());
+    QSSGRhiContextStats &stats = QSSGRhiContextStats::get(rhiCtx);
+    QVERIFY(stats.expensiveEvents.isEmpty());
+
+    stats.expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::TextureUpload, "maps/wood.png", 2000000, 4194304);
+    stats.expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::PipelineCreation, QByteArray(), 500000);
+    QCOMPARE(stats.expensiveEvents.size(), 2);
+    QCOMPARE(stats.expensiveEventOffset, quint64(0));
+    QCOMPARE(stats.expensiveEvents[0].type, QSSGRhiContextStats::ExpensiveEventInfo::TextureUpload);
+    QCOMPARE(stats.expensiveEvents[0].name, QByteArrayLiteral("maps/wood.png"));
+    QCOMPARE(stats.expensiveEvents[0].time, qint64(2000000));
+    QCOMPARE(stats.expensiveEvents[0].size, quint64(4194304));
+    QCOMPARE(stats.expensiveEvents[1].type, QSSGRhiContextStats::ExpensiveEventInfo::PipelineCreation);
+    QCOMPARE(stats.expensiveEvents[1].size, quint64(0));
+}
+
+void tst_QSSGExpensiveEvents::test_eventTrimming()
+{
+    std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, nullptr));
+    QVERIFY(rhi);
+    QSSGRhiContext rhiCtx(rhi.get());
+    QSSGRhiContextStats &stats = QSSGRhiContextStats::get(rhiCtx);
+
+    // The oldest half is dropped when full, the offset keeps the position
+    // of an event stable for readers that remember where they stopped.
+    for (int i = 0; i < 1025; ++i)
+        stats.expensiveEvent(QSSGRhiContextStats::ExpensiveEventInfo::ShaderGeneration, QByteArray::number(i), i);
+    QCOMPARE(stats.expensiveEventOffset, quint64(512));
+    QCOMPARE(stats.expensiveEvents.size(), 513);
+    QCOMPARE(stats.expensiveEvents.first().name, QByteArrayLiteral("512"));
+    QCOMPARE(stats.expensiveEvents.last().name, QByteArrayLiteral("1024"));
+    const quint64 position = 700;
+    QCOMPARE(stats.expensiveEvents[qsizetype(position - stats.expensiveEventOffset)].time, qint64(position));
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGExpensiveEvents)
+
+#include "tst_expensiveevents.moc"
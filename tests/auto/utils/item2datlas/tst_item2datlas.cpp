@@ -0,0 +1,79 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgrhiitem2dcache_p.h>
+
+class tst_QSSGItem2DAtlasPacker : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGItem2DAtlasPacker() = default;
+    ~tst_QSSGItem2DAtlasPacker() = default;
+
+private slots:
+    void test_allocate();
+    void test_shelfReuse();
+    void test_full();
+    void test_reset();
+};
+
+void tst_QSSGItem2DAtlasPacker::test_allocate()
+{
+    QSSGItem2DAtlasPacker packer(QSize(256, 256));
+    QCOMPARE(packer.size(), QSize(256, 256));
+    QCOMPARE(packer.usedPixelCount(), 0);
+
+    const QRect a = packer.allocate(QSize(100, 20));
+    const QRect b = packer.allocate(QSize(100, 20));
+    QCOMPARE(a, QRect(0, 0, 100, 20));
+    QCOMPARE(b, QRect(100, 0, 100, 20));
+    QCOMPARE(packer.usedPixelCount(), 4000);
+
+    // Does not fit next to the others, starts a new shelf
+    const QRect c = packer.allocate(QSize(100, 20));
+    QCOMPARE(c, QRect(0, 20, 100, 20));
+    QVERIFY(!c.intersects(a) && !c.intersects(b));
+
+    QVERIFY(packer.allocate(QSize()).isEmpty());
+    QVERIFY(packer.allocate(QSize(257, 10)).isEmpty());
+    QVERIFY(packer.allocate(QSize(10, 257)).isEmpty());
+}
+
+void tst_QSSGItem2DAtlasPacker::test_shelfReuse()
+{
+    QSSGItem2DAtlasPacker packer(QSize(256, 256));
+    packer.allocate(QSize(64, 64));
+    packer.allocate(QSize(64, 16));
+    // A second, lower shelf is started for the next tall one, and the low
+    // rectangles go to the lowest shelf they fit on.
+    QCOMPARE(packer.allocate(QSize(200, 32)), QRect(0, 64, 200, 32));
+    QCOMPARE(packer.allocate(QSize(32, 32)), QRect(200, 64, 32, 32));
+    QCOMPARE(packer.allocate(QSize(32, 48)), QRect(128, 0, 32, 48));
+}
+
+void tst_QSSGItem2DAtlasPacker::test_full()
+{
+    QSSGItem2DAtlasPacker packer(QSize(64, 64));
+    for (int i = 0; i < 16; ++i)
+        QVERIFY(!packer.allocate(QSize(16, 16)).isEmpty());
+    QCOMPARE(packer.usedPixelCount(), 64 * 64);
+    QVERIFY(packer.allocate(QSize(1, 1)).isEmpty());
+}
+
+void tst_QSSGItem2DAtlasPacker::test_reset()
+{
+    QSSGItem2DAtlasPacker packer(QSize(64, 64));
+    QVERIFY(!packer.allocate(QSize(64, 64)).isEmpty());
+    QVERIFY(packer.allocate(QSize(8, 8)).isEmpty());
+
+    packer.reset(QSize(128, 128));
+    QCOMPARE(packer.usedPixelCount(), 0);
+    QCOMPARE(packer.allocate(QSize(8, 8)), QRect(0, 0, 8, 8));
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGItem2DAtlasPacker)
+
+#include "tst_item2datlas.moc"
@@ -0,0 +1,190 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssglightclustergrid_p.h>
+
+class tst_QSSGLightClusterGrid : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGLightClusterGrid() = default;
+    ~tst_QSSGLightClusterGrid() = default;
+
+private slots:
+    void test_slices();
+    void test_clusterBounds();
+    void test_assignPointLight();
+    void test_cullLights();
+    void test_cameraMovement();
+    void test_maxLightsPerCluster();
+    void test_lightRange();
+
+private:
+    static constexpr float clipNear = 1.0f;
+    static constexpr float clipFar = 100.0f;
+
+    static QMatrix4x4 projection()
+    {
+        QMatrix4x4 m;
+        m.perspective(60.0f, 16.0f / 9.0f, clipNear, clipFar);
+        return m;
+    }
+
+    static QList<quint32> lightsInCluster(const QSSGLightClusterGrid &grid, int cluster)
+    {
+        const QSSGLightClusterGrid::Cluster &c = grid.clusters().at(cluster);
+        return grid.lightIndices().mid(c.offset, c.count);
+    }
+};
+
+void tst_QSSGLightClusterGrid::test_slices()
+{
+    QSSGLightClusterGrid grid;
+    grid.setup(QMatrix4x4(), projection(), clipNear, clipFar);
+
+    QCOMPARE(grid.sliceForDepth(0.0f), 0);
+    QCOMPARE(grid.sliceForDepth(clipNear), 0);
+    QCOMPARE(grid.sliceForDepth(clipFar), QSSGLightClusterGrid::SliceCount - 1);
+    QCOMPARE(grid.sliceForDepth(clipFar * 2.0f), QSSGLightClusterGrid::SliceCount - 1);
+
+    // Exponential distribution: slice k starts at near * (far / near)^(k / SliceCount)
+    for (int k = 0; k < QSSGLightClusterGrid::SliceCount; ++k) {
+        const float sliceStart = clipNear * std::pow(clipFar / clipNear, float(k) / QSSGLightClusterGrid::SliceCount);
+        QCOMPARE(grid.sliceForDepth(sliceStart * 1.01f), k);
+    }
+
+    // The same mapping as the shader uses
+    const float depth = 7.0f;
+    QCOMPARE(int(std::log(depth) * grid.sliceScale() + grid.sliceBias()), grid.sliceForDepth(depth));
+}
+
+void tst_QSSGLightClusterGrid::test_clusterBounds()
+{
+    QSSGLightClusterGrid grid;
+    grid.setup(QMatrix4x4(), projection(), clipNear, clipFar);
+
+    // Every point in the frustum is inside the bounds of the cluster it maps to
+    const QList<QVector3D> points = { { 0.0f, 0.0f, -5.0f }, { 1.0f, -0.5f, -2.0f },
+                                      { -20.0f, 10.0f, -60.0f }, { 0.1f, 0.1f, -99.0f } };
+    for (const QVector3D &p : points) {
+        const QSSGBounds3 bounds = grid.clusterBounds(grid.clusterForPosition(p));
+        for (int i = 0; i < 3; ++i) {
+            QVERIFY(p[i] >= bounds.minimum[i] - 0.001f);
+            QVERIFY(p[i] <= bounds.maximum[i] + 0.001f);
+        }
+    }
+
+    const float viewDepth = QVector4D::dotProduct(grid.viewDepthPlane(), QVector4D(0.0f, 0.0f, -5.0f, 1.0f));
+    QCOMPARE(viewDepth, 5.0f);
+}
+
+void tst_QSSGLightClusterGrid::test_assignPointLight()
+{
+    QSSGLightClusterGrid grid;
+    grid.setup(QMatrix4x4(), projection(), clipNear, clipFar);
+
+    const QVector3D lightPos(2.0f, 1.0f, -10.0f);
+    grid.assign({ { lightPos, 1.0f } });
+
+    QVERIFY(!grid.lightIndices().isEmpty());
+    QCOMPARE(lightsInCluster(grid, grid.clusterForPosition(lightPos)), QList<quint32>{ 0 });
+    QCOMPARE(lightsInCluster(grid, grid.clusterForPosition(lightPos + QVector3D(0.5f, 0.0f, 0.0f))), QList<quint32>{ 0 });
+
+    // Far away from the light in depth and on screen
+    QVERIFY(lightsInCluster(grid, grid.clusterForPosition(QVector3D(0.0f, 0.0f, -50.0f))).isEmpty());
+    QVERIFY(lightsInCluster(grid, grid.clusterForPosition(QVector3D(-5.0f, -3.0f, -10.0f))).isEmpty());
+
+    // Only a handful of clusters are touched by a small light
+    int touched = 0;
+    for (const QSSGLightClusterGrid::Cluster &c : grid.clusters())
+        touched += (c.count > 0);
+    QVERIFY(touched > 0);
+    QVERIFY(touched < QSSGLightClusterGrid::ClusterCount / 50);
+
+    grid.clear();
+    QVERIFY(grid.lightIndices().isEmpty());
+}
+
+void tst_QSSGLightClusterGrid::test_cullLights()
+{
+    QSSGLightClusterGrid grid;
+    grid.setup(QMatrix4x4(), projection(), clipNear, clipFar);
+
+    grid.assign({ { QVector3D(0.0f, 0.0f, 10.0f), 1.0f }, // behind the camera
+                  { QVector3D(0.0f, 0.0f, -200.0f), 1.0f }, // beyond the far plane
+                  { QVector3D(100.0f, 0.0f, -10.0f), 1.0f }, // outside to the right
+                  { QVector3D(0.0f, 0.0f, -10.0f), 0.0f } }); // no range
+    QVERIFY(grid.lightIndices().isEmpty());
+
+    // A light without falloff ends up everywhere
+    grid.assign({ { QVector3D(0.0f, 0.0f, 10.0f), std::numeric_limits<float>::infinity() } });
+    QCOMPARE(grid.lightIndices().size(), qsizetype(QSSGLightClusterGrid::ClusterCount));
+}
+
+void tst_QSSGLightClusterGrid::test_cameraMovement()
+{
+    QSSGLightClusterGrid grid;
+    QMatrix4x4 cameraTransform;
+    cameraTransform.translate(50.0f, 0.0f, 20.0f);
+    cameraTransform.rotate(45.0f, 0.0f, 1.0f, 0.0f);
+    grid.setup(cameraTransform.inverted(), projection(), clipNear, clipFar);
+
+    // 12 units in front of the camera, the other light is much further away
+    const QVector3D lightPos = cameraTransform.map(QVector3D(0.0f, 0.0f, -12.0f));
+    grid.assign({ { QVector3D(0.0f, 0.0f, -10.0f), 1.0f }, { lightPos, 1.0f } });
+
+    const int cluster = grid.clusterForPosition(lightPos);
+    QCOMPARE(lightsInCluster(grid, cluster), QList<quint32>{ 1 });
+    QCOMPARE(cluster / (QSSGLightClusterGrid::TileCountX * QSSGLightClusterGrid::TileCountY), grid.sliceForDepth(12.0f));
+}
+
+void tst_QSSGLightClusterGrid::test_maxLightsPerCluster()
+{
+    QSSGLightClusterGrid grid;
+    grid.setup(QMatrix4x4(), projection(), clipNear, clipFar);
+
+    QList<QSSGLightClusterGrid::LightVolume> lights;
+    for (int i = 0; i < QSSGLightClusterGrid::MaxLightsPerCluster + 10; ++i)
+        lights.append({ QVector3D(0.0f, 0.0f, -10.0f), 0.5f });
+    grid.assign(lights);
+
+    const QList<quint32> indices = lightsInCluster(grid, grid.clusterForPosition(QVector3D(0.0f, 0.0f, -10.0f)));
+    QCOMPARE(indices.size(), qsizetype(QSSGLightClusterGrid::MaxLightsPerCluster));
+    for (int i = 0; i < indices.size(); ++i)
+        QCOMPARE(indices[i], quint32(i));
+
+    // Lights beyond MaxLightCount are ignored
+    lights.clear();
+    for (int i = 0; i < QSSGLightClusterGrid::MaxLightCount + 1; ++i)
+        lights.append({ QVector3D(-50.0f + i * 0.1f, 0.0f, -60.0f), 0.01f });
+    grid.assign(lights);
+    for (quint32 index : grid.lightIndices())
+        QVERIFY(index < quint32(QSSGLightClusterGrid::MaxLightCount));
+}
+
+void tst_QSSGLightClusterGrid::test_lightRange()
+{
+    const QVector3D white(1.0f, 1.0f, 1.0f);
+    const float cutoff = QSSGLightClusterGrid::AttenuationCutoff;
+
+    // Quadratic falloff: 1 / (1 + d^2) = cutoff
+    const float quadraticRange = QSSGLightClusterGrid::lightRange(white, 1.0f, 0.0f, 1.0f);
+    QVERIFY(qFuzzyCompare(quadraticRange, std::sqrt(1.0f / cutoff - 1.0f)));
+
+    // Linear falloff: 1 / (1 + d) = cutoff
+    const float linearRange = QSSGLightClusterGrid::lightRange(white, 1.0f, 1.0f, 0.0f);
+    QVERIFY(qFuzzyCompare(linearRange, 1.0f / cutoff - 1.0f));
+
+    // Brighter lights reach further, the brightest channel counts
+    QVERIFY(QSSGLightClusterGrid::lightRange(QVector3D(0.0f, 4.0f, 0.0f), 1.0f, 0.0f, 1.0f) > quadraticRange);
+
+    QCOMPARE(QSSGLightClusterGrid::lightRange(QVector3D(), 1.0f, 0.0f, 1.0f), 0.0f);
+    QVERIFY(qIsInf(QSSGLightClusterGrid::lightRange(white, 1.0f, 0.0f, 0.0f)));
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGLightClusterGrid)
+
+#include "tst_lightclustergrid.moc"
@@ -0,0 +1,111 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <QtGui/rhi/qrhi.h>
+
+class tst_QSSGPassTimings : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGPassTimings() = default;
+    ~tst_QSSGPassTimings() = default;
+
+private slots:
+    void test_percentiles();
+    void test_rollingWindow();
+    void test_passTimings();
+};
+
+void tst_QSSGPassTimings::test_percentiles()
+{
+    QSSGRhiContextStats::TimingHistory history;
+    QCOMPARE(history.size(), 0);
+    QCOMPARE(history.percentile(50), qint64(0));
+
+    // Added out of order, 1..100
+    for (int i = 0; i < 100; ++i)
+        history.add((i * 37) % 100 + 1);
+    QCOMPARE(history.size(), 100);
+    QCOMPARE(history.percentile(0), qint64(1));
+    QCOMPARE(history.percentile(50), qint64(50));
+    QCOMPARE(history.percentile(95), qint64(95));
+    QCOMPARE(history.percentile(99), qint64(99));
+    QCOMPARE(history.percentile(100), qint64(100));
+
+    QSSGRhiContextStats::TimingHistory single;
+    single.add(7);
+    QCOMPARE(single.percentile(1), qint64(7));
+    QCOMPARE(single.percentile(99), qint64(7));
+}
+
+void tst_QSSGPassTimings::test_rollingWindow()
+{
+    constexpr int sampleCount = QSSGRhiContextStats::TimingHistory::SampleCount;
+    QSSGRhiContextStats::TimingHistory history;
+    for (int i = 0; i < sampleCount; ++i)
+        history.add(1000);
+    QCOMPARE(history.percentile(99), qint64(1000));
+
+    // A slow frame shows up in the tail, and leaves the window after
+    // SampleCount frames.
+    history.add(5000);
+    QCOMPARE(history.size(), sampleCount);
+    QCOMPARE(history.percentile(100), qint64(5000));
+    QCOMPARE(history.percentile(50), qint64(1000));
+    for (int i = 0; i < sampleCount - 1; ++i)
+        history.add(1000);
+    QCOMPARE(history.percentile(100), qint64(5000));
+    history.add(1000);
+    QCOMPARE(history.percentile(100), qint64(1000));
+}
+
+void tst_QSSGPassTimings::test_passTimings()
+{
+    std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, nullptr));
+    QVERIFY(rhi);
+    QSSGRhiContext rhiCtx(rhi.get());
+    QSSGRhiContextStats &stats = QSSGRhiContextStats::get(rhiCtx);
+    QSSGRenderLayer *layer = reinterpret_cast<QSSGRenderLayer *>(quintptr(0x1));
+
+    for (int frame = 0; frame < 2; ++frame) {
+        stats.start(layer);
+        stats.passPrepared("ShadowMap", 100);
+        stats.passPrepared("Opaque", 200);
+        stats.passRecorded("ShadowMap", 300);
+        stats.passRecorded("Opaque", 400);
+        // A pass running twice in a frame is accumulated
+        stats.passRecorded("Opaque", 50);
+        stats.passRecorded("Effects", 1000);
+        stats.stop(layer);
+    }
+
+    const QSSGRhiContextStats::PerLayerInfo &info = stats.perLayerInfo[layer];
+    QCOMPARE(info.passTimings.size(), 3);
+    QCOMPARE(info.passTimings[0].name, QByteArrayLiteral("ShadowMap"));
+    QCOMPARE(info.passTimings[0].prepareTime, qint64(100));
+    QCOMPARE(info.passTimings[0].recordTime, qint64(300));
+    QCOMPARE(info.passTimings[1].name, QByteArrayLiteral("Opaque"));
+    QCOMPARE(info.passTimings[1].prepareTime, qint64(200));
+    QCOMPARE(info.passTimings[1].recordTime, qint64(450));
+    QCOMPARE(info.passTimings[2].name, QByteArrayLiteral("Effects"));
+    QCOMPARE(info.passTimings[2].prepareTime, qint64(0));
+
+    // One sample per frame in the history
+    QCOMPARE(info.passTimingHistory.size(), 3);
+    QCOMPARE(info.passTimingHistory.value("Opaque").size(), 2);
+    QCOMPARE(info.passTimingHistory.value("Opaque").percentile(50), qint64(650));
+    QCOMPARE(info.passTimingHistory.value("Effects").percentile(50), qint64(1000));
+
+    // The timings of the last frame are reset by the next one, the history is not
+    stats.start(layer);
+    QVERIFY(stats.perLayerInfo[layer].passTimings.isEmpty());
+    QCOMPARE(stats.perLayerInfo[layer].passTimingHistory.size(), 3);
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGPassTimings)
+
+#include "tst_passtimings.moc"
@@ -4,6 +4,7 @@
 #include <QtTest>
 
 #include <QtQuick3DRuntimeRender/private/qssgrenderray_p.h>
+#include <QtQuick3DUtils/private/qssgmeshbvhbuilder_p.h>
 
 class intersection : public QObject
 {
@@ -18,6 +19,7 @@ private slots:
     void test_aabbIntersectionScaledv2();
     void test_aabbIntersectionTranslatedv2();
     void test_aabbIntersectionRotatedv2();
+    void test_bvhQuantizedUV();
 
 private:
     static QSSGRenderRay::IntersectionResult intersectWithAABBv2_proxy(const QMatrix4x4 &inGlobalTransform,
@@ -57,6 +59,74 @@ void intersection::test_aabbIntersectionRotatedv2()
     aabbIntersectionRotated(&intersection::intersectWithAABBv2_proxy);
 }
 
+// A unit quad in the XY plane with its UVs stored as half floats, the way the
+// importer writes them when quantizing the vertex attributes
+static QVector2D quadUV(float x, float y)
+{
+    return QVector2D(0.1f + 0.8f * x, 0.2f + 0.6f * y);
+}
+
+static QVector2D pickUV(const QSSGMeshBVH &bvh, float x, float y)
+{
+    const QMatrix4x4 globalTransform;
+    const QSSGRenderRay pickRay(/*Origin=*/{x, y, 10.0f}, /*Direction=*/{0.0f, 0.0f, -1.0f});
+    const QSSGRenderRay::RayData data = QSSGRenderRay::createRayData(globalTransform, pickRay);
+    const auto results = QSSGRenderRay::intersectWithBVHTriangles(data, bvh.triangles(), 0, int(bvh.triangles().size()));
+    return results.isEmpty() ? QVector2D(-1.0f, -1.0f) : results.first().relXY;
+}
+
+static bool fuzzyCompareUV(const QVector2D &actual, const QVector2D &expected)
+{
+    // Half floats keep about three decimal digits in [0, 1]
+    if (qAbs(actual.x() - expected.x()) < 1e-3f && qAbs(actual.y() - expected.y()) < 1e-3f)
+        return true;
+    qWarning() << "UV" << actual << "expected" << expected;
+    return false;
+}
+
+void intersection::test_bvhQuantizedUV()
+{
+    const float corners[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+    const quint16 indices[6] = { 0, 1, 2, 0, 2, 3 };
+    QByteArray positionData;
+    QByteArray uvData;
+    QByteArray interleavedData;
+    for (const auto &corner : corners) {
+        const float position[3] = { corner[0], corner[1], 0.0f };
+        const QVector2D uv = quadUV(corner[0], corner[1]);
+        const qfloat16 halfUV[2] = { qfloat16(uv.x()), qfloat16(uv.y()) };
+        positionData.append(reinterpret_cast<const char *>(position), sizeof(position));
+        uvData.append(reinterpret_cast<const char *>(halfUV), sizeof(halfUV));
+        interleavedData.append(reinterpret_cast<const char *>(position), sizeof(position));
+        interleavedData.append(reinterpret_cast<const char *>(halfUV), sizeof(halfUV));
+    }
+    const QByteArray indexData(reinterpret_cast<const char *>(indices), sizeof(indices));
+
+    // From a mesh file
+    QSSGMesh::AssetMeshSubset subset;
+    subset.count = 6;
+    subset.boundsPositionEntryIndex = 0;
+    const QSSGMesh::Mesh mesh = QSSGMesh::Mesh::fromAssetData(
+            { { QSSGMesh::MeshInternal::getPositionAttrName(), positionData, QSSGMesh::Mesh::ComponentType::Float32, 3 },
+              { QSSGMesh::MeshInternal::getUV0AttrName(), uvData, QSSGMesh::Mesh::ComponentType::Float16, 2 } },
+            indexData, QSSGMesh::Mesh::ComponentType::UnsignedInt16, { subset });
+    QVERIFY(mesh.isValid());
+    QSSGMeshBVHBuilder meshBuilder(mesh);
+    const auto meshBvh = meshBuilder.buildTree();
+    QVERIFY(meshBvh);
+    QVERIFY(fuzzyCompareUV(pickUV(*meshBvh, 0.25f, 0.5f), quadUV(0.25f, 0.5f)));
+    QVERIFY(fuzzyCompareUV(pickUV(*meshBvh, 0.75f, 0.1f), quadUV(0.75f, 0.1f)));
+
+    // From custom geometry
+    QSSGMeshBVHBuilder geometryBuilder(interleavedData, 16, 0, true, 12, true, indexData,
+                                       QSSGRenderComponentType::UnsignedInt16,
+                                       QSSGRenderComponentType::Float16);
+    const auto geometryBvh = geometryBuilder.buildTree();
+    QVERIFY(geometryBvh);
+    QVERIFY(fuzzyCompareUV(pickUV(*geometryBvh, 0.25f, 0.5f), quadUV(0.25f, 0.5f)));
+    QVERIFY(fuzzyCompareUV(pickUV(*geometryBvh, 0.75f, 0.1f), quadUV(0.75f, 0.1f)));
+}
+
 void intersection::aabbIntersection(const IntersectionFunc &intersectFunc)
 {
     QSSGRenderRay::IntersectionResult res;
@@ -0,0 +1,194 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DUtils/private/qquick3dprofiler_p.h>
+#include <QtQuick3DUtils/private/qquick3dprofilertracewriter_p.h>
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+
+class tst_QQuick3DProfilerTrace : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QQuick3DProfilerTrace() = default;
+    ~tst_QQuick3DProfilerTrace() = default;
+
+private slots:
+    void test_traceEvent();
+    void test_writer();
+    void test_unfinishedTrace();
+    void test_recordTrace();
+};
+
+#if QT_CONFIG(qml_debug)
+
+static QQuick3DProfilerData frameEvent(int detailType, qint64 end, qint64 duration, qint64 payload, const QList<int> &ids = {})
+{
+    return QQuick3DProfilerData(end, QQuick3DProfiler::Quick3DFrame, detailType, duration, payload, ids);
+}
+
+static QJsonArray parseTrace(const QByteArray &json)
+{
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &error);
+    if (error.error != QJsonParseError::NoError)
+        qWarning() << error.errorString();
+    return document.array();
+}
+
+#endif
+
+void tst_QQuick3DProfilerTrace::test_traceEvent()
+{
+#if QT_CONFIG(qml_debug)
+    const QHash<int, QByteArray> eventData { { 1, QByteArrayLiteral("meshes/teapot.mesh") } };
+    const QJsonObject event = QQuick3DProfilerTraceWriter::toTraceEvent(
+            frameEvent(QQuick3DProfiler::Quick3DMeshLoad, 5000000, 2000000, 4096, { 1 }), eventData, 10, 2);
+    QCOMPARE(event.value("name").toString(), QStringLiteral("Mesh Load"));
+    QCOMPARE(event.value("ph").toString(), QStringLiteral("X"));
+    QCOMPARE(event.value("ts").toDouble(), 3000.0); // microseconds
+    QCOMPARE(event.value("dur").toDouble(), 2000.0);
+    QCOMPARE(event.value("pid").toInteger(), 10);
+    QCOMPARE(event.value("tid").toInteger(), 2);
+    const QJsonObject args = event.value("args").toObject();
+    QCOMPARE(args.value("dataSize").toInteger(), 4096);
+    QCOMPARE(args.value("resources").toArray().first().toString(), QStringLiteral("meshes/teapot.mesh"));
+
+    // Render passes are named after the pass
+    const QJsonObject pass = QQuick3DProfilerTraceWriter::toTraceEvent(
+            frameEvent(QQuick3DProfiler::Quick3DRenderPass, 100, 10, quint64(640) | quint64(480) << 32, { 1 }), eventData, 10, 1);
+    QCOMPARE(pass.value("name").toString(), QStringLiteral("meshes/teapot.mesh"));
+    QCOMPARE(pass.value("args").toObject().value("width").toInteger(), 640);
+    QCOMPARE(pass.value("args").toObject().value("height").toInteger(), 480);
+
+    const QJsonObject shader = QQuick3DProfilerTraceWriter::toTraceEvent(
+            frameEvent(QQuick3DProfiler::Quick3DGenerateShader, 100, 10, 0xabcdef), eventData, 10, 1);
+    QCOMPARE(shader.value("args").toObject().value("shaderKeyHash").toString(), QStringLiteral("abcdef"));
+#else
+    QSKIP("Requires the qml_debug feature");
+#endif
+}
+
+void tst_QQuick3DProfilerTrace::test_writer()
+{
+#if QT_CONFIG(qml_debug)
+    QByteArray json;
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+
+    QQuick3DProfilerTraceWriter writer(&buffer);
+    QVector<QQuick3DProfilerData> data;
+    // Frame on one thread with a nested pass, a texture load on another
+    data.append(QQuick3DProfilerData(0, QQuick3DProfiler::Quick3DFrame, QQuick3DProfiler::Quick3DEventData, 1, 0));
+    data.append(frameEvent(QQuick3DProfiler::Quick3DRenderPass, 3000, 1000, 0, { 1 }));
+    data.last().threadId = 100;
+    data.append(frameEvent(QQuick3DProfiler::Quick3DRenderFrame, 4000, 4000, 5 | quint64(2) << 32));
+    data.last().threadId = 100;
+    writer.write(data, { { 1, QByteArrayLiteral("opaque_pass") } });
+    data.clear();
+    data.append(frameEvent(QQuick3DProfiler::Quick3DTextureLoad, 8000, 2000, 1024));
+    data.last().threadId = 200;
+    writer.write(data, {});
+    writer.finish();
+
+    const QJsonArray events = parseTrace(json);
+    QCOMPARE(events.size(), 4); // process name, without the string registration
+    QCOMPARE(events[0].toObject().value("ph").toString(), QStringLiteral("M"));
+    const QJsonObject pass = events[1].toObject();
+    const QJsonObject frame = events[2].toObject();
+    const QJsonObject load = events[3].toObject();
+    QCOMPARE(pass.value("name").toString(), QStringLiteral("opaque_pass"));
+    QCOMPARE(frame.value("name").toString(), QStringLiteral("Render Frame"));
+    QCOMPARE(frame.value("args").toObject().value("drawCalls").toInteger(), 5);
+    QCOMPARE(frame.value("args").toObject().value("renderPasses").toInteger(), 2);
+
+    // The pass is within the frame on the same thread
+    QCOMPARE(pass.value("tid").toInteger(), frame.value("tid").toInteger());
+    QVERIFY(load.value("tid").toInteger() != frame.value("tid").toInteger());
+    QVERIFY(pass.value("ts").toDouble() >= frame.value("ts").toDouble());
+    QVERIFY(pass.value("ts").toDouble() + pass.value("dur").toDouble()
+            <= frame.value("ts").toDouble() + frame.value("dur").toDouble());
+#else
+    QSKIP("Requires the qml_debug feature");
+#endif
+}
+
+void tst_QQuick3DProfilerTrace::test_unfinishedTrace()
+{
+#if QT_CONFIG(qml_debug)
+    QByteArray json;
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QQuick3DProfilerTraceWriter writer(&buffer);
+    writer.write({ frameEvent(QQuick3DProfiler::Quick3DRenderFrame, 10, 10, 0) }, {});
+
+    // Viewers accept the array without the closing bracket
+    QVERIFY(json.startsWith("[\n"));
+    QVERIFY(!json.trimmed().endsWith(']'));
+    QCOMPARE(parseTrace(json + "\n]").size(), 2);
+
+    QByteArray emptyJson;
+    QBuffer emptyBuffer(&emptyJson);
+    QVERIFY(emptyBuffer.open(QIODevice::WriteOnly));
+    QQuick3DProfilerTraceWriter emptyWriter(&emptyBuffer);
+    emptyWriter.finish();
+    QCOMPARE(parseTrace(emptyJson).size(), 0);
+    QVERIFY(QJsonDocument::fromJson(emptyJson).isArray());
+#else
+    QSKIP("Requires the qml_debug feature");
+#endif
+}
+
+void tst_QQuick3DProfilerTrace::test_recordTrace()
+{
+#if QT_CONFIG(qml_debug)
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("trace.json"));
+    QVERIFY(QQuick3DProfiler::startTrace(fileName));
+    QVERIFY(Q_QUICK3D_PROFILING_ENABLED);
+
+    Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DTextureLoad);
+    Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DTextureLoad, 256, QByteArrayLiteral("maps/wood.png"));
+
+    QThread *thread = QThread::create([] {
+        Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderFrame);
+        Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
+        Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DRenderPass, 0, QByteArrayLiteral("opaque_pass"));
+        Q_QUICK3D_PROFILE_END(QQuick3DProfiler::Quick3DRenderFrame);
+    });
+    thread->start();
+    QVERIFY(thread->wait());
+    delete thread;
+
+    QQuick3DProfiler::stopTrace();
+    QVERIFY(!Q_QUICK3D_PROFILING_ENABLED);
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonArray events = parseTrace(file.readAll());
+    QCOMPARE(events.size(), 4);
+    const QJsonObject load = events[1].toObject();
+    QCOMPARE(load.value("name").toString(), QStringLiteral("Texture Load"));
+    QCOMPARE(load.value("args").toObject().value("resources").toArray().first().toString(),
+             QStringLiteral("maps/wood.png"));
+    const QJsonObject pass = events[2].toObject();
+    const QJsonObject frame = events[3].toObject();
+    QCOMPARE(pass.value("name").toString(), QStringLiteral("opaque_pass"));
+    QCOMPARE(frame.value("name").toString(), QStringLiteral("Render Frame"));
+    QCOMPARE(pass.value("tid").toInteger(), frame.value("tid").toInteger());
+    QVERIFY(load.value("tid").toInteger() != frame.value("tid").toInteger());
+#else
+    QSKIP("Requires the qml_debug feature");
+#endif
+}
+
+QTEST_GUILESS_MAIN(tst_QQuick3DProfilerTrace)
+
+#include "tst_profilertrace.moc"
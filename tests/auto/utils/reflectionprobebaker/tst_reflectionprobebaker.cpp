@@ -0,0 +1,138 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgreflectionprobebaker_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderreflectionprobe_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderlayer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
+
+#include <QtGui/private/qtexturefilereader_p.h>
+
+class tst_QSSGReflectionProbeBaker : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGReflectionProbeBaker() = default;
+    ~tst_QSSGReflectionProbeBaker() = default;
+
+private slots:
+    void test_ktxStable();
+    void test_ktxRoundTrip();
+    void test_contentKey();
+    void test_bakedMapPath();
+
+private:
+    static constexpr int Size = 16;
+    static constexpr int LevelCount = 5;
+
+    static QList<QByteArray> faces()
+    {
+        QList<QByteArray> result;
+        for (int level = 0; level < LevelCount; ++level) {
+            const int levelSize = Size >> level;
+            for (int face = 0; face < 6; ++face)
+                result.append(QByteArray(levelSize * levelSize * 8, char(level * 6 + face)));
+        }
+        return result;
+    }
+};
+
+void tst_QSSGReflectionProbeBaker::test_ktxStable()
+{
+    const QByteArray key = QByteArray::fromHex("0123456789abcdef0123456789abcdef01234567");
+    const QByteArray data = QSSGReflectionProbeBaker::ktxData(QSize(Size, Size), faces(), key);
+    QCOMPARE(QSSGReflectionProbeBaker::ktxData(QSize(Size, Size), faces(), key), data);
+    QVERIFY(data.startsWith("\xABKTX 11\xBB\r\n\x1A\n"));
+    QVERIFY(data.contains(key.toHex()));
+
+    // Missing readback data is written as zeros, the file stays valid
+    QList<QByteArray> truncated = faces();
+    truncated[3].clear();
+    const QByteArray padded = QSSGReflectionProbeBaker::ktxData(QSize(Size, Size), truncated, key);
+    QCOMPARE(padded.size(), data.size());
+}
+
+void tst_QSSGReflectionProbeBaker::test_ktxRoundTrip()
+{
+    const QList<QByteArray> input = faces();
+    QByteArray data = QSSGReflectionProbeBaker::ktxData(QSize(Size, Size), input, QByteArrayLiteral("key"));
+
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QTextureFileReader reader(&buffer, QStringLiteral("qrp_test.ktx"));
+    QVERIFY(reader.canRead());
+    const QTextureFileData fileData = reader.read();
+    QVERIFY(fileData.isValid());
+    QCOMPARE(fileData.size(), QSize(Size, Size));
+    QCOMPARE(fileData.numFaces(), 6);
+    QCOMPARE(fileData.numLevels(), LevelCount);
+    QCOMPARE(fileData.glInternalFormat(), quint32(0x881A)); // GL_RGBA16F
+    QVERIFY(fileData.keyValueMetadata().contains("QT_REFLECTION_PROBE_BAKER_VERSION"));
+    QVERIFY(fileData.keyValueMetadata().value("QT_REFLECTION_PROBE_CONTENT_KEY").startsWith("6b6579"));
+
+    for (int level = 0; level < LevelCount; ++level) {
+        for (int face = 0; face < 6; ++face)
+            QCOMPARE(fileData.getDataView(level, face).toByteArray(), input.at(level * 6 + face));
+    }
+}
+
+void tst_QSSGReflectionProbeBaker::test_contentKey()
+{
+    QSSGRenderLayer layer;
+    QSSGRenderReflectionProbe probe;
+    const QSSGRenderableObjectList noCasters;
+
+    const QByteArray key = QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters);
+    QVERIFY(!key.isEmpty());
+    QCOMPARE(QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters), key);
+
+    probe.clearColor = Qt::red;
+    const QByteArray clearColorKey = QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters);
+    QVERIFY(clearColorKey != key);
+
+    probe.reflectionMapRes = 9;
+    QVERIFY(QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters) != clearColorKey);
+
+    probe.reflectionMapRes = 8;
+    QCOMPARE(QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters), clearColorKey);
+
+    probe.globalTransform.translate(0, 100, 0);
+    layer.background = QSSGRenderLayer::Background::Color;
+    const QByteArray movedKey = QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters);
+    QVERIFY(movedKey != clearColorKey);
+
+    // The light probe lights the scene without being the background
+    QSSGRenderImage lightProbe;
+    lightProbe.m_imagePath = QSSGRenderPath(QStringLiteral("maps/ibl.hdr"));
+    layer.lightProbe = &lightProbe;
+    const QByteArray lightProbeKey = QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters);
+    QVERIFY(lightProbeKey != movedKey);
+
+    layer.lightProbeSettings.probeExposure = 2.0f;
+    QVERIFY(QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters) != lightProbeKey);
+    layer.lightProbeSettings.probeExposure = 1.0f;
+    QCOMPARE(QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters), lightProbeKey);
+
+    layer.lightProbeSettings.probeOrientation(0, 1) = 1.0f;
+    QVERIFY(QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters) != lightProbeKey);
+
+    layer.lightProbe = nullptr;
+    QCOMPARE(QSSGReflectionProbeBaker::contentKey(probe, layer, noCasters), movedKey);
+}
+
+void tst_QSSGReflectionProbeBaker::test_bakedMapPath()
+{
+    const QByteArray key = QByteArray::fromHex("00ff");
+    qunsetenv("QT_QUICK3D_REFLECTION_PROBE_BAKE_PATH");
+    QCOMPARE(QSSGReflectionProbeBaker::bakedMapPath(key), QStringLiteral("qrp_00ff.ktx"));
+    qputenv("QT_QUICK3D_REFLECTION_PROBE_BAKE_PATH", "baked");
+    QCOMPARE(QSSGReflectionProbeBaker::bakedMapPath(key), QStringLiteral("baked/qrp_00ff.ktx"));
+    qunsetenv("QT_QUICK3D_REFLECTION_PROBE_BAKE_PATH");
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGReflectionProbeBaker)
+
+#include "tst_reflectionprobebaker.moc"
@@ -0,0 +1,192 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgreflectionprobescheduler_p.h>
+
+using Candidate = QSSGReflectionProbeScheduler::Candidate;
+
+class tst_QSSGReflectionProbeScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGReflectionProbeScheduler() = default;
+    ~tst_QSSGReflectionProbeScheduler() = default;
+
+private slots:
+    void test_noBudget();
+    void test_faceBudget();
+    void test_timeBudget();
+    void test_forcedFirst();
+    void test_priority();
+    void test_ageAvoidsStarvation();
+    void test_screenCoverage();
+
+private:
+    static Candidate candidate(int probeIndex, float distance, quint32 age = 1, bool contentChanged = false)
+    {
+        Candidate c;
+        c.probeIndex = probeIndex;
+        c.distance = distance;
+        c.age = age;
+        c.contentChanged = contentChanged;
+        return c;
+    }
+
+    static QList<int> probeIndices(const QList<Candidate> &candidates, qsizetype count)
+    {
+        QList<int> indices;
+        for (qsizetype i = 0; i < count; ++i)
+            indices.append(candidates.at(i).probeIndex);
+        return indices;
+    }
+};
+
+void tst_QSSGReflectionProbeScheduler::test_noBudget()
+{
+    QSSGReflectionProbeScheduler scheduler;
+    QVERIFY(!scheduler.hasBudget());
+
+    QList<Candidate> candidates;
+    for (int i = 0; i < 20; ++i)
+        candidates.append(candidate(i, 100.0f * i));
+    QCOMPARE(scheduler.schedule(candidates), 20);
+    // Nearest first
+    QCOMPARE(candidates.first().probeIndex, 0);
+    QCOMPARE(candidates.last().probeIndex, 19);
+}
+
+void tst_QSSGReflectionProbeScheduler::test_faceBudget()
+{
+    QSSGReflectionProbeScheduler scheduler;
+    scheduler.setBudget(12, 0.0f);
+    QVERIFY(scheduler.hasBudget());
+
+    QList<Candidate> candidates;
+    for (int i = 0; i < 20; ++i)
+        candidates.append(candidate(i, 100.0f * i));
+    QCOMPARE(scheduler.schedule(candidates), 2);
+    QCOMPARE(probeIndices(candidates, 2), QList<int>({ 0, 1 }));
+
+    // Time sliced probes only render one face per frame
+    candidates.clear();
+    for (int i = 0; i < 20; ++i) {
+        candidates.append(candidate(i, 100.0f * i));
+        candidates.last().faceCount = 1;
+    }
+    QCOMPARE(scheduler.schedule(candidates), 12);
+
+    // One probe is always rendered, even when it does not fit
+    scheduler.setBudget(3, 0.0f);
+    candidates = { candidate(0, 0.0f), candidate(1, 10.0f) };
+    QCOMPARE(scheduler.schedule(candidates), 1);
+}
+
+void tst_QSSGReflectionProbeScheduler::test_timeBudget()
+{
+    QSSGReflectionProbeScheduler scheduler;
+    scheduler.setBudget(0, 2.0f);
+
+    // No estimate yet, everything fits
+    QList<Candidate> candidates;
+    for (int i = 0; i < 4; ++i)
+        candidates.append(candidate(i, 100.0f * i));
+    QCOMPARE(scheduler.schedule(candidates), 4);
+
+    scheduler.recordFaceTime(1.2f, 6);
+    QCOMPARE(scheduler.estimatedFaceTime(), 0.2f);
+    // 6 faces * 0.2 ms per probe
+    QCOMPARE(scheduler.schedule(candidates), 1);
+
+    // The estimate follows the measurements
+    for (int i = 0; i < 50; ++i)
+        scheduler.recordFaceTime(0.6f, 6);
+    QVERIFY(qAbs(scheduler.estimatedFaceTime() - 0.1f) < 0.001f);
+    QCOMPARE(scheduler.schedule(candidates), 3);
+
+    // Both limits apply
+    scheduler.setBudget(6, 2.0f);
+    QCOMPARE(scheduler.schedule(candidates), 1);
+}
+
+void tst_QSSGReflectionProbeScheduler::test_forcedFirst()
+{
+    QSSGReflectionProbeScheduler scheduler;
+    scheduler.setBudget(6, 0.0f);
+
+    QList<Candidate> candidates = { candidate(0, 0.0f, 100, true), candidate(1, 10000.0f, 1) };
+    candidates[1].forced = true;
+    QCOMPARE(scheduler.schedule(candidates), 1);
+    QCOMPARE(candidates.first().probeIndex, 1);
+}
+
+void tst_QSSGReflectionProbeScheduler::test_priority()
+{
+    const Candidate near = candidate(0, 0.0f);
+    const Candidate far = candidate(1, 10000.0f);
+    QVERIFY(QSSGReflectionProbeScheduler::priority(near) > QSSGReflectionProbeScheduler::priority(far));
+
+    Candidate covering = far;
+    covering.screenCoverage = 1.0f;
+    QVERIFY(QSSGReflectionProbeScheduler::priority(covering) > QSSGReflectionProbeScheduler::priority(far));
+
+    const Candidate changed = candidate(2, 0.0f, 1, true);
+    QVERIFY(QSSGReflectionProbeScheduler::priority(changed) > QSSGReflectionProbeScheduler::priority(near));
+
+    const Candidate old = candidate(3, 0.0f, 10);
+    QVERIFY(QSSGReflectionProbeScheduler::priority(old) > QSSGReflectionProbeScheduler::priority(near));
+}
+
+void tst_QSSGReflectionProbeScheduler::test_ageAvoidsStarvation()
+{
+    QSSGReflectionProbeScheduler scheduler;
+    scheduler.setBudget(6, 0.0f);
+
+    // A near probe whose content changes every frame, and a far static one.
+    // The ages are maintained the way the renderer does it.
+    quint32 ages[2] = { 1, 1 };
+    bool farRendered = false;
+    for (int frame = 0; frame < 100 && !farRendered; ++frame) {
+        QList<Candidate> candidates = { candidate(0, 0.0f, ages[0], true), candidate(1, 5000.0f, ages[1]) };
+        const qsizetype count = scheduler.schedule(candidates);
+        QCOMPARE(count, 1);
+        const int rendered = candidates.first().probeIndex;
+        farRendered = rendered == 1;
+        ages[rendered] = 1;
+        ++ages[1 - rendered];
+    }
+    QVERIFY(farRendered);
+}
+
+void tst_QSSGReflectionProbeScheduler::test_screenCoverage()
+{
+    QMatrix4x4 projection;
+    projection.perspective(90.0f, 1.0f, 1.0f, 1000.0f);
+    QMatrix4x4 view;
+    view.lookAt(QVector3D(0, 0, 0), QVector3D(0, 0, -1), QVector3D(0, 1, 0));
+    const QMatrix4x4 viewProjection = projection * view;
+
+    // Fills the view exactly at a 90 degree field of view
+    const QSSGBounds3 filling(QVector3D(-10, -10, -20), QVector3D(10, 10, -10));
+    QCOMPARE(QSSGReflectionProbeScheduler::screenCoverage(filling, viewProjection), 1.0f);
+
+    // A quarter of the width and height of the view
+    const QSSGBounds3 small(QVector3D(-2.5f, -2.5f, -10.0f), QVector3D(2.5f, 2.5f, -10.0f));
+    QCOMPARE(QSSGReflectionProbeScheduler::screenCoverage(small, viewProjection), 0.0625f);
+
+    // Outside of the view
+    const QSSGBounds3 outside(QVector3D(100, 0, -20), QVector3D(110, 10, -10));
+    QCOMPARE(QSSGReflectionProbeScheduler::screenCoverage(outside, viewProjection), 0.0f);
+
+    // The camera is inside
+    const QSSGBounds3 around(QVector3D(-10, -10, -10), QVector3D(10, 10, 10));
+    QCOMPARE(QSSGReflectionProbeScheduler::screenCoverage(around, viewProjection), 1.0f);
+
+    QCOMPARE(QSSGReflectionProbeScheduler::screenCoverage(QSSGBounds3(), viewProjection), 0.0f);
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGReflectionProbeScheduler)
+
+#include "tst_reflectionprobescheduler.moc"
@@ -0,0 +1,208 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderskeleton_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderjoint_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgskinningsystem_p.h>
+
+#include <memory>
+#include <vector>
+
+// The palettes are compared with the ones computed with QMatrix4x4, which is
+// how the palettes used to be computed before the flattened evaluation.
+class tst_QSSGSkinningSystem : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGSkinningSystem() = default;
+    ~tst_QSSGSkinningSystem() = default;
+
+private slots:
+    void test_palette_data();
+    void test_palette();
+    void test_parallelPalettes();
+
+private:
+    // skeleton -> joint 0 -> node -> joint 1 -> joint 2
+    struct Rig {
+        Rig();
+
+        QSSGRenderSkeleton skeleton;
+        QSSGRenderJoint joint0;
+        QSSGRenderNode node;
+        QSSGRenderJoint joint1;
+        QSSGRenderJoint joint2;
+    };
+
+    static void setTransforms(Rig &rig, const QMatrix4x4 &skeletonTransform, const QList<QMatrix4x4> &localTransforms);
+    static QByteArray referencePalette(const Rig &rig, const QList<QMatrix4x4> &inverseBindPoses);
+    static bool comparePalettes(const QByteArray &actual, const QByteArray &expected);
+};
+
+tst_QSSGSkinningSystem::Rig::Rig()
+{
+    joint0.index = 0;
+    joint1.index = 1;
+    joint2.index = 2;
+    joint0.skeletonRoot = &skeleton;
+    joint1.skeletonRoot = &skeleton;
+    joint2.skeletonRoot = &skeleton;
+    skeleton.maxIndex = 2;
+    skeleton.addChild(joint0);
+    joint0.addChild(node);
+    node.addChild(joint1);
+    joint1.addChild(joint2);
+}
+
+void tst_QSSGSkinningSystem::setTransforms(Rig &rig, const QMatrix4x4 &skeletonTransform, const QList<QMatrix4x4> &localTransforms)
+{
+    rig.skeleton.localTransform = skeletonTransform;
+    rig.joint0.localTransform = localTransforms.at(0);
+    rig.node.localTransform = localTransforms.at(1);
+    rig.joint1.localTransform = localTransforms.at(2);
+    rig.joint2.localTransform = localTransforms.at(3);
+    // Marks the whole subtree dirty
+    rig.skeleton.markDirty(QSSGRenderNode::DirtyFlag::TransformDirty);
+}
+
+QByteArray tst_QSSGSkinningSystem::referencePalette(const Rig &rig, const QList<QMatrix4x4> &inverseBindPoses)
+{
+    const QMatrix4x4 joint0 = rig.skeleton.localTransform * rig.joint0.localTransform;
+    const QMatrix4x4 joint1 = joint0 * rig.node.localTransform * rig.joint1.localTransform;
+    const QMatrix4x4 joint2 = joint1 * rig.joint2.localTransform;
+    const QMatrix4x4 globalTransforms[] = { joint0, joint1, joint2 };
+
+    QByteArray palette(rig.skeleton.pendingBoneData.size(), '\0');
+    float *data = reinterpret_cast<float *>(palette.data());
+    for (int i = 0; i < 3; ++i) {
+        const QMatrix4x4 bone = globalTransforms[i] * inverseBindPoses.at(i);
+        memcpy(data + 16 * i * 2, bone.constData(), sizeof(float) * 16);
+        memcpy(data + 16 * (i * 2 + 1), QMatrix4x4(bone.normalMatrix()).constData(), sizeof(float) * 12);
+    }
+    return palette;
+}
+
+bool tst_QSSGSkinningSystem::comparePalettes(const QByteArray &actual, const QByteArray &expected)
+{
+    if (actual.size() != expected.size()) {
+        qWarning() << "Palette size" << actual.size() << "expected" << expected.size();
+        return false;
+    }
+    const float *a = reinterpret_cast<const float *>(actual.constData());
+    const float *e = reinterpret_cast<const float *>(expected.constData());
+    for (qsizetype i = 0, count = actual.size() / qsizetype(sizeof(float)); i < count; ++i) {
+        const float tolerance = 1e-4f * qMax(1.0f, qMax(qAbs(a[i]), qAbs(e[i])));
+        if (qAbs(a[i] - e[i]) > tolerance) {
+            qWarning() << "Palette float" << i << "is" << a[i] << "expected" << e[i];
+            return false;
+        }
+    }
+    return true;
+}
+
+static QMatrix4x4 transform(const QVector3D &position, const QVector3D &scale, const QVector3D &eulerRotation)
+{
+    return QSSGRenderNode::calculateTransformMatrix(position, scale, QVector3D(), QQuaternion::fromEulerAngles(eulerRotation));
+}
+
+void tst_QSSGSkinningSystem::test_palette_data()
+{
+    QTest::addColumn<QMatrix4x4>("skeletonTransform");
+    QTest::addColumn<QList<QMatrix4x4>>("localTransforms");
+    QTest::addColumn<QList<QMatrix4x4>>("inverseBindPoses");
+
+    const QList<QMatrix4x4> affineTransforms = {
+        transform(QVector3D(1.0f, 2.0f, 3.0f), QVector3D(1.0f, 1.0f, 1.0f), QVector3D(10.0f, 20.0f, 30.0f)),
+        transform(QVector3D(0.0f, 1.0f, 0.0f), QVector3D(2.0f, 0.5f, 1.0f), QVector3D(-45.0f, 0.0f, 15.0f)),
+        transform(QVector3D(0.0f, 1.5f, 0.5f), QVector3D(1.0f, 1.0f, 1.0f), QVector3D(0.0f, 90.0f, 0.0f)),
+        transform(QVector3D(-0.5f, 1.0f, 0.0f), QVector3D(0.3f, 0.3f, 3.0f), QVector3D(5.0f, -60.0f, 120.0f)),
+    };
+    QList<QMatrix4x4> affinePoses;
+    for (int i = 0; i < 3; ++i)
+        affinePoses.append(transform(QVector3D(0.0f, -1.0f * i, 0.0f), QVector3D(1.0f, 1.0f, 1.0f), QVector3D(0.0f, 0.0f, 10.0f * i)));
+
+    QTest::newRow("affine")
+            << transform(QVector3D(5.0f, 0.0f, -5.0f), QVector3D(2.0f, 2.0f, 2.0f), QVector3D(0.0f, 30.0f, 0.0f))
+            << affineTransforms
+            << affinePoses;
+
+    // Matrices with a non-trivial bottom row, which the SIMD multiply has to
+    // treat like any other row
+    QMatrix4x4 perspective;
+    perspective.perspective(60.0f, 1.5f, 0.1f, 100.0f);
+    QList<QMatrix4x4> projectiveTransforms = affineTransforms;
+    projectiveTransforms[1] = QMatrix4x4(1.0f, 0.2f, 0.0f, 1.0f,
+                                         0.0f, 1.0f, 0.3f, 2.0f,
+                                         0.1f, 0.0f, 1.0f, 3.0f,
+                                         0.05f, 0.1f, 0.2f, 1.0f);
+    projectiveTransforms[3] = QMatrix4x4(2.0f, 0.0f, 0.0f, 0.0f,
+                                         0.0f, 1.0f, 0.0f, 0.0f,
+                                         0.0f, 0.0f, 1.0f, 0.0f,
+                                         0.0f, 0.0f, -0.5f, 1.0f);
+    QList<QMatrix4x4> projectivePoses = affinePoses;
+    projectivePoses[2] = QMatrix4x4(1.0f, 0.0f, 0.0f, 0.0f,
+                                    0.0f, 1.0f, 0.0f, -2.0f,
+                                    0.0f, 0.0f, 1.0f, 0.0f,
+                                    0.3f, 0.0f, 0.0f, 2.0f);
+    QTest::newRow("non-affine") << perspective << projectiveTransforms << projectivePoses;
+
+    // The normal matrix of a joint scaled to zero is the identity, as with
+    // QMatrix4x4::normalMatrix()
+    QList<QMatrix4x4> singularTransforms = affineTransforms;
+    singularTransforms[2] = transform(QVector3D(0.0f, 1.0f, 0.0f), QVector3D(1.0f, 0.0f, 1.0f), QVector3D());
+    QTest::newRow("singular") << QMatrix4x4() << singularTransforms << affinePoses;
+
+    // Joints without an inverse bind pose use the identity
+    QTest::newRow("no poses") << QMatrix4x4() << affineTransforms << QList<QMatrix4x4>();
+}
+
+void tst_QSSGSkinningSystem::test_palette()
+{
+    QFETCH(QMatrix4x4, skeletonTransform);
+    QFETCH(QList<QMatrix4x4>, localTransforms);
+    QFETCH(QList<QMatrix4x4>, inverseBindPoses);
+
+    Rig rig;
+    setTransforms(rig, skeletonTransform, localTransforms);
+    QSSGSkinningSystem::prepare(rig.skeleton);
+    QCOMPARE(rig.skeleton.joints.size(), 4);
+    QVERIFY(rig.skeleton.containsNonJointNodes);
+    QSSGSkinningSystem::evaluatePalette(rig.skeleton, inverseBindPoses);
+
+    QList<QMatrix4x4> poses = inverseBindPoses;
+    poses.resize(3);
+    QVERIFY(comparePalettes(rig.skeleton.pendingBoneData, referencePalette(rig, poses)));
+}
+
+// Enough joints to be evaluated on several threads give the same palettes as
+// evaluating the skeletons one by one
+void tst_QSSGSkinningSystem::test_parallelPalettes()
+{
+    const int rigCount = QSSGSkinningSystem::MinParallelJointCount / 4 + 1;
+    std::vector<std::unique_ptr<Rig>> rigs;
+    QList<QMatrix4x4> inverseBindPoses;
+    for (int i = 0; i < 3; ++i)
+        inverseBindPoses.append(transform(QVector3D(0.0f, -1.0f * i, 0.0f), QVector3D(1.0f, 1.0f, 1.0f), QVector3D()));
+    QList<QSSGSkinningSystem::SkeletonPose> poses;
+    for (int r = 0; r < rigCount; ++r) {
+        auto rig = std::make_unique<Rig>();
+        QList<QMatrix4x4> localTransforms;
+        for (int i = 0; i < 4; ++i)
+            localTransforms.append(transform(QVector3D(0.0f, 1.0f, 0.0f), QVector3D(1.0f, 1.0f, 1.0f), QVector3D(float(r), float(i * 10), 0.0f)));
+        setTransforms(*rig, transform(QVector3D(float(r), 0.0f, 0.0f), QVector3D(1.0f, 1.0f, 1.0f), QVector3D()), localTransforms);
+        QSSGSkinningSystem::prepare(rig->skeleton);
+        poses.append({ &rig->skeleton, &inverseBindPoses });
+        rigs.push_back(std::move(rig));
+    }
+
+    QSSGSkinningSystem::evaluatePalettes(poses);
+    for (const auto &rig : rigs)
+        QVERIFY(comparePalettes(rig->skeleton.pendingBoneData, referencePalette(*rig, inverseBindPoses)));
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGSkinningSystem)
+
+#include "tst_skinningsystem.moc"
@@ -0,0 +1,342 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgtexturecooker_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderloadedtexture_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <ssg/qssgrendercontextcore.h>
+
+#include <QtGui/QColorSpace>
+#include <QtGui/QImage>
+#include <QtGui/private/qtexturefiledata_p.h>
+#include <QtGui/private/qtexturefilereader_p.h>
+#include <QtGui/rhi/qrhi.h>
+
+#include "../../../shared/nullrendercontext.h"
+
+class tst_QSSGTextureCooker : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QSSGTextureCooker() = default;
+    ~tst_QSSGTextureCooker() = default;
+
+private slots:
+    void test_sourceKey();
+    void test_cookedPath();
+    void test_uncompressed();
+    void test_singleChannel();
+    void test_compressed_data();
+    void test_compressed();
+    void test_compressedBlock();
+    void test_compressedUnalignedSize();
+    void test_colorSpace();
+    void test_linearMips();
+    void test_sourceStamp();
+    void test_loadRenderImage();
+};
+
+void tst_QSSGTextureCooker::test_sourceKey()
+{
+    const QByteArray source = QByteArrayLiteral("not really an image");
+    const QByteArray key = QSSGTextureCooker::sourceKey(source);
+    QVERIFY(!key.isEmpty());
+    QCOMPARE(QSSGTextureCooker::sourceKey(source), key);
+    QVERIFY(QSSGTextureCooker::sourceKey(source + '\0') != key);
+}
+
+void tst_QSSGTextureCooker::test_cookedPath()
+{
+    QCOMPARE(QSSGTextureCooker::cookedPath(QStringLiteral("maps/wood.png")), QStringLiteral("maps/wood.png.ktx"));
+}
+
+void tst_QSSGTextureCooker::test_uncompressed()
+{
+    QImage image(20, 12, QImage::Format_RGB32);
+    image.fill(QColor(10, 20, 30));
+    const QByteArray key = QSSGTextureCooker::sourceKey(QByteArrayLiteral("wood.png"));
+
+    const QSSGTextureCooker::Result result = QSSGTextureCooker::cook(image, key, false);
+    QVERIFY(!result.ktxData.isEmpty());
+    QVERIFY(!result.compressed);
+    QCOMPARE(result.levelCount, 5); // 20x12, 10x6, 5x3, 2x1, 1x1
+
+    const QTextureFileData data = QSSGTextureCooker::read(result.ktxData, QByteArrayLiteral("wood.png.ktx"));
+    QVERIFY(data.isValid());
+    QVERIFY(QSSGTextureCooker::isCooked(data));
+    QCOMPARE(QSSGTextureCooker::cookedSourceKey(data), key);
+    QVERIFY(!QSSGTextureCooker::hasAlpha(data));
+    QCOMPARE(data.size(), QSize(20, 12));
+    QCOMPARE(data.numLevels(), 5);
+    QCOMPARE(data.glInternalFormat(), quint32(0x8058)); // GL_RGBA8
+
+    // Level 0 is what would be uploaded after loading the image, flipped
+    const QImage converted = QSSGLoadedTexture::convertToUploadFormat(image).mirrored();
+    QCOMPARE(converted.format(), QImage::Format_RGBX8888);
+    QCOMPARE(data.getDataView(0).toByteArray(),
+             QByteArray(reinterpret_cast<const char *>(converted.constBits()), converted.sizeInBytes()));
+    QCOMPARE(data.dataLength(2), 5 * 3 * 4);
+    QCOMPARE(data.dataLength(4), 4);
+    const QByteArray smallest = data.getDataView(4).toByteArray();
+    QCOMPARE(uchar(smallest[0]), uchar(10));
+    QCOMPARE(uchar(smallest[1]), uchar(20));
+    QCOMPARE(uchar(smallest[2]), uchar(30));
+
+    QVERIFY(!QSSGTextureCooker::isCooked(QTextureFileData()));
+}
+
+void tst_QSSGTextureCooker::test_singleChannel()
+{
+    // Not block compressed, with the rows padded to 4 bytes
+    QImage image(6, 3, QImage::Format_Grayscale8);
+    image.fill(Qt::gray);
+    const QSSGTextureCooker::Result result = QSSGTextureCooker::cook(image, QByteArrayLiteral("key"), true);
+    QVERIFY(!result.compressed);
+    QCOMPARE(result.levelCount, 3);
+
+    const QTextureFileData data = QSSGTextureCooker::read(result.ktxData, QByteArray());
+    QVERIFY(data.isValid());
+    QCOMPARE(data.glInternalFormat(), quint32(0x8229)); // GL_R8
+    QCOMPARE(data.dataLength(0), 8 * 3);
+    QCOMPARE(data.dataLength(1), 4 * 1);
+}
+
+void tst_QSSGTextureCooker::test_compressed_data()
+{
+    QTest::addColumn<bool>("alpha");
+    QTest::addColumn<quint32>("glInternalFormat");
+    QTest::addColumn<int>("blockSize");
+
+    QTest::newRow("BC1") << false << quint32(0x83F0) << 8;
+    QTest::newRow("BC3") << true << quint32(0x83F3) << 16;
+}
+
+void tst_QSSGTextureCooker::test_compressed()
+{
+    QFETCH(bool, alpha);
+    QFETCH(quint32, glInternalFormat);
+    QFETCH(int, blockSize);
+
+    QImage image(16, 8, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixelColor(x, y, QColor(x * 16, y * 32, 128, alpha && x > 7 ? 64 : 255));
+    }
+
+    const QSSGTextureCooker::Result result = QSSGTextureCooker::cook(image, QByteArrayLiteral("key"), true);
+    QVERIFY(result.compressed);
+    QCOMPARE(result.levelCount, 5);
+
+    // Compressed files go through QTextureFileReader, like at run time
+    QByteArray ktxData = result.ktxData;
+    QBuffer buffer(&ktxData);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QTextureFileReader reader(&buffer, QStringLiteral("test.png.ktx"));
+    QVERIFY(reader.canRead());
+    const QTextureFileData data = reader.read();
+    QVERIFY(data.isValid());
+    QVERIFY(QSSGTextureCooker::isCooked(data));
+    QCOMPARE(QSSGTextureCooker::cookedSourceKey(data), QByteArrayLiteral("key"));
+    QCOMPARE(QSSGTextureCooker::hasAlpha(data), alpha);
+    QCOMPARE(data.glInternalFormat(), glInternalFormat);
+    QCOMPARE(data.numLevels(), 5);
+    QCOMPARE(data.dataLength(0), 4 * 2 * blockSize); // 16x8
+    QCOMPARE(data.dataLength(1), 2 * 1 * blockSize); // 8x4
+    QCOMPARE(data.dataLength(2), blockSize); // 4x2
+    QCOMPARE(data.dataLength(4), blockSize); // 1x1
+}
+
+void tst_QSSGTextureCooker::test_compressedBlock()
+{
+    // Two colors end up as the endpoints, with every pixel at one of them.
+    // The rows are flipped, so the black rows come first.
+    QImage image(4, 4, QImage::Format_RGB32);
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x)
+            image.setPixelColor(x, y, y < 2 ? Qt::white : Qt::black);
+    }
+    const QSSGTextureCooker::Result result = QSSGTextureCooker::cook(image, QByteArrayLiteral("key"), true);
+    const QTextureFileData data = QSSGTextureCooker::read(result.ktxData, QByteArray());
+    QVERIFY(data.isValid());
+    const QByteArray block = data.getDataView(0).toByteArray();
+    QCOMPARE(block.size(), 8);
+    QCOMPARE(qFromLittleEndian<quint16>(block.constData()), quint16(0xFFFF));
+    QCOMPARE(qFromLittleEndian<quint16>(block.constData() + 2), quint16(0x0000));
+    QCOMPARE(qFromLittleEndian<quint32>(block.constData() + 4), quint32(0x00005555));
+}
+
+void tst_QSSGTextureCooker::test_compressedUnalignedSize()
+{
+    QImage image(10, 8, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    const QSSGTextureCooker::Result result = QSSGTextureCooker::cook(image, QByteArrayLiteral("key"), true);
+    QVERIFY(!result.ktxData.isEmpty());
+    QVERIFY(!result.compressed);
+}
+
+void tst_QSSGTextureCooker::test_colorSpace()
+{
+    QImage image(4, 4, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    QVERIFY(QSSGTextureCooker::isSRGB(QSSGTextureCooker::read(QSSGTextureCooker::cook(image, QByteArrayLiteral("key"), false).ktxData, QByteArray())));
+    image.setColorSpace(QColorSpace::SRgbLinear);
+    QVERIFY(!QSSGTextureCooker::isSRGB(QSSGTextureCooker::read(QSSGTextureCooker::cook(image, QByteArrayLiteral("key"), false).ktxData, QByteArray())));
+}
+
+void tst_QSSGTextureCooker::test_linearMips()
+{
+    // Black and white pixels average to the middle gray of the linear values
+    QImage image(2, 2, QImage::Format_RGB32);
+    image.setPixelColor(0, 0, Qt::black);
+    image.setPixelColor(1, 0, Qt::white);
+    image.setPixelColor(0, 1, Qt::white);
+    image.setPixelColor(1, 1, Qt::black);
+
+    const QTextureFileData srgb = QSSGTextureCooker::read(QSSGTextureCooker::cook(image, QByteArrayLiteral("key"), false).ktxData, QByteArray());
+    QCOMPARE(srgb.numLevels(), 2);
+    QCOMPARE(srgb.getDataView(1).toByteArray(), QByteArray::fromHex("bcbcbcff"));
+
+    image.setColorSpace(QColorSpace::SRgbLinear);
+    const QTextureFileData linear = QSSGTextureCooker::read(QSSGTextureCooker::cook(image, QByteArrayLiteral("key"), false).ktxData, QByteArray());
+    QCOMPARE(linear.getDataView(1).toByteArray(), QByteArray::fromHex("808080ff"));
+
+    // Transparent pixels do not darken the opaque ones
+    QImage transparent(2, 1, QImage::Format_RGBA8888);
+    transparent.setPixelColor(0, 0, Qt::white);
+    transparent.setPixelColor(1, 0, Qt::transparent);
+    const QTextureFileData withAlpha = QSSGTextureCooker::read(QSSGTextureCooker::cook(transparent, QByteArrayLiteral("key"), false).ktxData, QByteArray());
+    QCOMPARE(withAlpha.getDataView(1).toByteArray(), QByteArray::fromHex("ffffff80"));
+}
+
+void tst_QSSGTextureCooker::test_sourceStamp()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString sourcePath = dir.filePath(QStringLiteral("wood.png"));
+    const QByteArray sourceData = QByteArrayLiteral("not really an image");
+    QFile sourceFile(sourcePath);
+    QVERIFY(sourceFile.open(QIODevice::WriteOnly));
+    QCOMPARE(sourceFile.write(sourceData), qint64(sourceData.size()));
+    sourceFile.close();
+
+    const QSSGTextureCooker::SourceStamp stamp = QSSGTextureCooker::sourceStamp(sourcePath);
+    QCOMPARE(stamp.size, qint64(sourceData.size()));
+    QVERIFY(stamp.lastModified >= 0);
+    QCOMPARE(QSSGTextureCooker::sourceStamp(dir.filePath(QStringLiteral("missing.png"))).size, qint64(-1));
+
+    QImage image(4, 4, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    const QByteArray key = QSSGTextureCooker::sourceKey(sourceData);
+    const QByteArray otherKey = QSSGTextureCooker::sourceKey(QByteArrayLiteral("another image"));
+    const QTextureFileData cooked = QSSGTextureCooker::read(QSSGTextureCooker::cook(image, key, false, stamp).ktxData, QByteArray());
+    QCOMPARE(QSSGTextureCooker::cookedSourceStamp(cooked).size, stamp.size);
+    QCOMPARE(QSSGTextureCooker::cookedSourceStamp(cooked).lastModified, stamp.lastModified);
+    const QTextureFileData otherCooked = QSSGTextureCooker::read(QSSGTextureCooker::cook(image, otherKey, false, stamp).ktxData, QByteArray());
+    const QTextureFileData unstamped = QSSGTextureCooker::read(QSSGTextureCooker::cook(image, key, false).ktxData, QByteArray());
+
+    // Matching stamps skip reading the source
+    QVERIFY(sourceFile.open(QIODevice::ReadOnly));
+    QVERIFY(QSSGTextureCooker::isCookedFrom(otherCooked, sourcePath, &sourceFile));
+    QCOMPARE(sourceFile.pos(), qint64(0));
+    // Without stamps the source is compared
+    QVERIFY(QSSGTextureCooker::isCookedFrom(unstamped, sourcePath, &sourceFile));
+    sourceFile.close();
+
+    // Another modification time falls back to comparing the source
+    QVERIFY(sourceFile.open(QIODevice::ReadWrite));
+    QVERIFY(sourceFile.setFileTime(QDateTime::fromMSecsSinceEpoch(stamp.lastModified).addSecs(-3600), QFileDevice::FileModificationTime));
+    sourceFile.close();
+    QVERIFY(sourceFile.open(QIODevice::ReadOnly));
+    QVERIFY(QSSGTextureCooker::isCookedFrom(cooked, sourcePath, &sourceFile));
+    sourceFile.close();
+    QVERIFY(sourceFile.open(QIODevice::ReadOnly));
+    QVERIFY(!QSSGTextureCooker::isCookedFrom(otherCooked, sourcePath, &sourceFile));
+    sourceFile.close();
+
+    // Another size is enough to tell the source changed
+    QVERIFY(sourceFile.open(QIODevice::WriteOnly | QIODevice::Append));
+    sourceFile.write("!");
+    sourceFile.close();
+    QVERIFY(sourceFile.open(QIODevice::ReadOnly));
+    QVERIFY(!QSSGTextureCooker::isCookedFrom(cooked, sourcePath, &sourceFile));
+    QCOMPARE(sourceFile.pos(), qint64(0));
+    sourceFile.close();
+}
+
+void tst_QSSGTextureCooker::test_loadRenderImage()
+{
+    // Top half red, bottom half blue, so that the orientation shows
+    QImage image(16, 8, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixelColor(x, y, y < 4 ? Qt::red : Qt::blue);
+    }
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString sourcePath = dir.filePath(QStringLiteral("wood.png"));
+    QVERIFY(image.save(sourcePath));
+    QFile sourceFile(sourcePath);
+    QVERIFY(sourceFile.open(QIODevice::ReadOnly));
+    const QSSGTextureCooker::Result cooked = QSSGTextureCooker::cook(image, QSSGTextureCooker::sourceKey(sourceFile.readAll()), false,
+                                                                     QSSGTextureCooker::sourceStamp(sourcePath));
+    sourceFile.close();
+    QFile cookedFile(QSSGTextureCooker::cookedPath(sourcePath));
+    QVERIFY(cookedFile.open(QIODevice::WriteOnly));
+    QCOMPARE(cookedFile.write(cooked.ktxData), qint64(cooked.ktxData.size()));
+    cookedFile.close();
+
+    QtQuick3DEditorHelpers::ShaderCache::setAutomaticDiskCache(false);
+    {
+        NullRenderContext context;
+        QVERIFY(context.isValid());
+        const QSSGRenderContextInterface &renderContext = *context.renderContext();
+        const auto &bufferManager = renderContext.bufferManager();
+        const QSSGRhiContextStats &stats = QSSGRhiContextStats::get(*renderContext.rhiContext());
+
+        // With the default flags the cooked file is used instead of the image
+        QSSGRenderImage renderImage;
+        renderImage.m_imagePath = QSSGRenderPath(sourcePath);
+        const QSSGRenderImageTexture texture = bufferManager->loadRenderImage(&renderImage);
+        QVERIFY(texture.m_texture);
+        QCOMPARE(texture.m_texture->pixelSize(), QSize(16, 8));
+        QVERIFY(stats.textureLoads.value(texture.m_texture).cooked);
+
+        // Without flipping the image is loaded, the cooked file is flipped.
+        // The flags are not part of the image cache key.
+        bufferManager->releaseCachedResources();
+        QSSGRenderImage unflippedImage;
+        unflippedImage.m_imagePath = QSSGRenderPath(sourcePath);
+        const QSSGRenderImageTexture unflipped = bufferManager->loadRenderImage(&unflippedImage, QSSGBufferManager::MipModeFollowRenderImage, {});
+        QVERIFY(unflipped.m_texture);
+        QVERIFY(!stats.textureLoads.value(unflipped.m_texture).cooked);
+
+        // Without the source, the cooked file is found through its extension
+        // and holds the same data as the image loaded with flipping
+        QScopedPointer<QSSGLoadedTexture> loadedImage(QSSGLoadedTexture::load(sourcePath, QSSGRenderTextureFormat::Unknown, true));
+        QVERIFY(loadedImage);
+        QVERIFY(QFile::remove(sourcePath));
+        QScopedPointer<QSSGLoadedTexture> loadedCooked(QSSGLoadedTexture::load(sourcePath, QSSGRenderTextureFormat::Unknown, true));
+        QVERIFY(loadedCooked);
+        QVERIFY(QSSGTextureCooker::isCooked(loadedCooked->textureFileData));
+        QCOMPARE(loadedCooked->textureFileData.getDataView(0).toByteArray(),
+                 QByteArray(reinterpret_cast<const char *>(loadedImage->image.constBits()), loadedImage->image.sizeInBytes()));
+
+        QSSGRenderImage missingSourceImage;
+        missingSourceImage.m_imagePath = QSSGRenderPath(sourcePath);
+        bufferManager->releaseCachedResources();
+        const QSSGRenderImageTexture fromCooked = bufferManager->loadRenderImage(&missingSourceImage);
+        QVERIFY(fromCooked.m_texture);
+        QVERIFY(stats.textureLoads.value(fromCooked.m_texture).cooked);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_QSSGTextureCooker)
+
+#include "tst_texturecooker.moc"
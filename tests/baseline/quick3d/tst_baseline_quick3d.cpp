@@ -26,11 +26,14 @@ private Q_SLOTS:
     void cleanup();
     void testRendering_data();
     void testRendering();
+    void testComputeSkinning_data();
+    void testComputeSkinning();
 
 private:
     void setupTestSuite(const QByteArray& filter = QByteArray());
     void runTest(const QStringList& extraArgs = QStringList());
-    bool renderAndGrab(const QString& qmlFile, const QStringList& extraArgs, QImage *screenshot, QString *errMsg);
+    bool renderAndGrab(const QString& qmlFile, const QStringList& extraArgs, QImage *screenshot, QString *errMsg,
+                       const QProcessEnvironment& env = QProcessEnvironment::systemEnvironment());
     quint16 checksumFileOrDir(const QString &path);
 
     QString testSuitePath;
@@ -99,6 +102,67 @@ void tst_Quick3D::testRendering()
 }
 
 
+void tst_Quick3D::testComputeSkinning_data()
+{
+    QTest::addColumn<QString>("qmlFile");
+
+    // Not compared to the baselines, so plain rows
+    QDirIterator it(testSuitePath + QLatin1String("/skinanim"), { QStringLiteral("*.qml") }, QDir::Files);
+    QStringList itemFiles;
+    while (it.hasNext())
+        itemFiles.append(it.next());
+    std::sort(itemFiles.begin(), itemFiles.end());
+    for (const QString &filePath : std::as_const(itemFiles))
+        QTest::newRow(filePath.mid(testSuitePath.length() + 1).toLatin1()) << filePath;
+
+    if (itemFiles.isEmpty())
+        QSKIP("No skinned .qml test files found in " + testSuitePath.toLatin1());
+}
+
+
+// The skinned scenes rendered with the compute pre-skinning pass must look
+// the same as when the vertex shader skins them. Scenes the compute pass does
+// not handle (custom vertex shaders), and backends without compute support,
+// render the same way both times.
+void tst_Quick3D::testComputeSkinning()
+{
+    QFETCH(QString, qmlFile);
+
+    QProcessEnvironment vertexEnv = QProcessEnvironment::systemEnvironment();
+    vertexEnv.remove(QStringLiteral("QT_QUICK3D_COMPUTE_SKINNING"));
+    QProcessEnvironment computeEnv = vertexEnv;
+    computeEnv.insert(QStringLiteral("QT_QUICK3D_COMPUTE_SKINNING"), QStringLiteral("1"));
+
+    QImage vertexSkinned;
+    QImage computeSkinned;
+    QString errorMessage;
+    if (!renderAndGrab(qmlFile, QStringList(), &vertexSkinned, &errorMessage, vertexEnv)
+            || !renderAndGrab(qmlFile, QStringList(), &computeSkinned, &errorMessage, computeEnv)) {
+        QFAIL(qPrintable("QuickView grabbing failed: " + errorMessage));
+    }
+    QCOMPARE(computeSkinned.size(), vertexSkinned.size());
+
+    // Allow for rounding differences along the edges of the triangles
+    vertexSkinned.convertTo(QImage::Format_RGB32);
+    computeSkinned.convertTo(QImage::Format_RGB32);
+    const int fuzz = 8;
+    int differentPixels = 0;
+    for (int y = 0; y < vertexSkinned.height(); ++y) {
+        const QRgb *a = reinterpret_cast<const QRgb *>(vertexSkinned.constScanLine(y));
+        const QRgb *b = reinterpret_cast<const QRgb *>(computeSkinned.constScanLine(y));
+        for (int x = 0; x < vertexSkinned.width(); ++x) {
+            if (qAbs(qRed(a[x]) - qRed(b[x])) > fuzz
+                    || qAbs(qGreen(a[x]) - qGreen(b[x])) > fuzz
+                    || qAbs(qBlue(a[x]) - qBlue(b[x])) > fuzz) {
+                ++differentPixels;
+            }
+        }
+    }
+    QVERIFY2(differentPixels <= vertexSkinned.width() + vertexSkinned.height(),
+             qPrintable(QString::number(differentPixels) + " pixels differ"));
+}
+
+
 void tst_Quick3D::setupTestSuite(const QByteArray& filter)
 {
     QTest::addColumn<QString>("qmlFile");
@@ -161,7 +225,8 @@ void tst_Quick3D::runTest(const QStringList& extraArgs)
 }
 
 
-bool tst_Quick3D::renderAndGrab(const QString& qmlFile, const QStringList& extraArgs, QImage *screenshot, QString *errMsg)
+bool tst_Quick3D::renderAndGrab(const QString& qmlFile, const QStringList& extraArgs, QImage *screenshot, QString *errMsg,
+                                const QProcessEnvironment& env)
 {
     bool usePipe = true;  // Whether to transport the grabbed image using temp. file or pipe. TBD: cmdline option
 #if defined(Q_OS_WIN)
@@ -169,6 +234,7 @@ bool tst_Quick3D::renderAndGrab(const QString& qmlFile, const QStringList& extra
 #endif
     QProcess grabber;
     grabber.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    grabber.setProcessEnvironment(env);
     QString cmd = QCoreApplication::applicationDirPath() + "/qquick3d_qmlscenegrabber";
     QStringList args = extraArgs;
 #if defined(Q_OS_WIN)
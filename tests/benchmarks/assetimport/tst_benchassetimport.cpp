@@ -0,0 +1,164 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDirIterator>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+
+#include <QtQuick3DAssetImport/private/qssgassetimportmanager_p.h>
+
+#include <cmath>
+
+// Imports a generated scene with a lot of dense meshes with levels of detail
+// enabled, with different numbers of mesh worker threads, and checks that the
+// generated files do not depend on the number of threads.
+//
+// tst_meshes and tst_segments change the number of meshes and the density of
+// each one (a sphere with segments * segments * 2 triangles).
+
+class tst_benchassetimport : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_benchassetimport() = default;
+    ~tst_benchassetimport() = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void bench_import_data();
+    void bench_import();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_sourceFile;
+    int m_meshCount = 200;
+    int m_segments = 96;
+    QByteArray m_reference;
+};
+
+static bool writeScene(const QString &fileName, int meshCount, int segments)
+{
+    // Each object is a separate mesh in the imported scene, slightly deformed
+    // so that the simplification does different work for each of them.
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    QTextStream out(&file);
+    int vertexBase = 1;
+    for (int mesh = 0; mesh < meshCount; ++mesh) {
+        out << "o plant" << mesh << "\n";
+        const float x = float(mesh % 20) * 3.0f;
+        const float z = float(mesh / 20) * 3.0f;
+        const float wobble = 0.05f + 0.01f * float(mesh % 7);
+        for (int ring = 0; ring <= segments; ++ring) {
+            const float theta = qDegreesToRadians(180.0f * float(ring) / float(segments));
+            for (int seg = 0; seg <= segments; ++seg) {
+                const float phi = qDegreesToRadians(360.0f * float(seg) / float(segments));
+                const float r = 1.0f + wobble * std::sin(5.0f * phi) * std::sin(3.0f * theta);
+                out << "v " << x + r * std::sin(theta) * std::cos(phi)
+                    << ' ' << r * std::cos(theta)
+                    << ' ' << z + r * std::sin(theta) * std::sin(phi) << "\n";
+            }
+        }
+        const int rowLength = segments + 1;
+        for (int ring = 0; ring < segments; ++ring) {
+            for (int seg = 0; seg < segments; ++seg) {
+                const int a = vertexBase + ring * rowLength + seg;
+                const int b = a + rowLength;
+                out << "f " << a << ' ' << b << ' ' << a + 1 << "\n";
+                out << "f " << a + 1 << ' ' << b << ' ' << b + 1 << "\n";
+            }
+        }
+        vertexBase += rowLength * rowLength;
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+static QByteArray hashMeshFiles(const QDir &dir)
+{
+    QStringList files;
+    QDirIterator it(dir.path(), { QStringLiteral("*.mesh") }, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        files.append(it.next());
+    files.sort();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &fileName : std::as_const(files)) {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return {};
+        hash.addData(dir.relativeFilePath(fileName).toUtf8());
+        hash.addData(file.readAll());
+    }
+    return hash.result();
+}
+
+void tst_benchassetimport::initTestCase()
+{
+    bool ok = false;
+    const int meshes = qEnvironmentVariableIntValue("tst_meshes", &ok);
+    if (ok && meshes > 0)
+        m_meshCount = meshes;
+    const int segments = qEnvironmentVariableIntValue("tst_segments", &ok);
+    if (ok && segments > 2)
+        m_segments = segments;
+
+    QVERIFY(m_dir.isValid());
+    m_sourceFile = m_dir.filePath(QStringLiteral("plants.obj"));
+    QVERIFY(writeScene(m_sourceFile, m_meshCount, m_segments));
+}
+
+void tst_benchassetimport::bench_import_data()
+{
+    QTest::addColumn<int>("workerCount");
+
+    // The first row is the reference for the output of the others
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("all cores") << 0;
+}
+
+void tst_benchassetimport::bench_import()
+{
+    QFETCH(int, workerCount);
+
+    QSSGAssetImportManager importManager;
+    QJsonObject options = importManager.getOptionsForFile(m_sourceFile);
+    QJsonObject optionsObject = options.value(QStringLiteral("options")).toObject();
+    const auto setOption = [&optionsObject](const QString &name, const QJsonValue &value) {
+        QJsonObject option = optionsObject.value(name).toObject();
+        option.insert(QStringLiteral("value"), value);
+        optionsObject.insert(name, option);
+    };
+    setOption(QStringLiteral("generateMeshLevelsOfDetail"), true);
+    setOption(QStringLiteral("meshWorkerCount"), workerCount);
+    options.insert(QStringLiteral("options"), optionsObject);
+
+    const QDir outputDir(m_dir.filePath(QString::number(workerCount)));
+    QVERIFY(outputDir.mkpath(QStringLiteral(".")));
+
+    QString error;
+    QElapsedTimer timer;
+    timer.start();
+    const auto state = importManager.importFile(m_sourceFile, outputDir, options, &error);
+    const qint64 elapsed = timer.elapsed();
+    QVERIFY2(state == QSSGAssetImportManager::ImportState::Success, qPrintable(error));
+
+    const QByteArray hash = hashMeshFiles(outputDir);
+    QVERIFY(!hash.isEmpty());
+    if (m_reference.isEmpty())
+        m_reference = hash;
+    QCOMPARE(hash, m_reference);
+
+    qInfo("%d meshes with %d triangles each imported in %lld ms", m_meshCount, m_segments * m_segments * 2, elapsed);
+    QTest::setBenchmarkResult(elapsed, QTest::WalltimeMilliseconds);
+}
+
+QTEST_MAIN(tst_benchassetimport)
+
+#include "tst_benchassetimport.moc"
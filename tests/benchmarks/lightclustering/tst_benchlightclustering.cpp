@@ -0,0 +1,90 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssglightclustergrid_p.h>
+
+#include <random>
+
+// Bins a warehouse-like scene of small point lights, spread over a large
+// floor, into the cluster grid. This is the per-frame CPU cost of clustered
+// lighting, it does not need a QRhi.
+class tst_benchlightclustering : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_benchlightclustering() = default;
+    ~tst_benchlightclustering() = default;
+
+private Q_SLOTS:
+    void bench_setup();
+    void bench_assign_data();
+    void bench_assign();
+
+private:
+    static QMatrix4x4 cameraTransform()
+    {
+        QMatrix4x4 m;
+        m.translate(0.0f, 500.0f, 2000.0f);
+        m.rotate(-15.0f, 1.0f, 0.0f, 0.0f);
+        return m;
+    }
+
+    static QMatrix4x4 projection()
+    {
+        QMatrix4x4 m;
+        m.perspective(60.0f, 16.0f / 9.0f, 10.0f, 10000.0f);
+        return m;
+    }
+};
+
+void tst_benchlightclustering::bench_setup()
+{
+    // Includes recomputing the cluster bounds, which happens whenever the
+    // projection changes.
+    QSSGLightClusterGrid grid;
+    float fov = 60.0f;
+    QBENCHMARK {
+        QMatrix4x4 m;
+        m.perspective(fov, 16.0f / 9.0f, 10.0f, 10000.0f);
+        grid.setup(cameraTransform().inverted(), m, 10.0f, 10000.0f);
+        fov = fov > 80.0f ? 60.0f : fov + 0.1f;
+    }
+}
+
+void tst_benchlightclustering::bench_assign_data()
+{
+    QTest::addColumn<int>("lightCount");
+    QTest::addColumn<float>("radius");
+
+    QTest::newRow("100 lights, radius 100") << 100 << 100.0f;
+    QTest::newRow("500 lights, radius 100") << 500 << 100.0f;
+    QTest::newRow("1000 lights, radius 100") << 1000 << 100.0f;
+    QTest::newRow("1000 lights, radius 400") << 1000 << 400.0f;
+}
+
+void tst_benchlightclustering::bench_assign()
+{
+    QFETCH(int, lightCount);
+    QFETCH(float, radius);
+
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<float> floor(-4000.0f, 4000.0f);
+    std::uniform_real_distribution<float> height(0.0f, 300.0f);
+    QList<QSSGLightClusterGrid::LightVolume> lights;
+    for (int i = 0; i < lightCount; ++i)
+        lights.append({ QVector3D(floor(generator), height(generator), floor(generator) - 4000.0f), radius });
+
+    QSSGLightClusterGrid grid;
+    grid.setup(cameraTransform().inverted(), projection(), 10.0f, 10000.0f);
+    QBENCHMARK {
+        grid.assign(lights);
+    }
+    QVERIFY(!grid.lightIndices().isEmpty());
+}
+
+QTEST_MAIN(tst_benchlightclustering)
+
+#include "tst_benchlightclustering.moc"
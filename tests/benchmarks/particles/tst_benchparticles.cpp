@@ -0,0 +1,277 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DParticles/private/qquick3dparticlesystem_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticleemitter_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticletrailemitter_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticlespriteparticle_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticlemodelparticle_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticlevectordirection_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticlegravity_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticlewander_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticleattractor_p.h>
+#include <QtQuick3DParticles/private/qquick3dparticlerepeller_p.h>
+
+#include <memory>
+
+// Runs particle systems without a window, advancing the time by one frame at
+// 60 Hz per iteration once every emitted particle is alive. The time spent in
+// each stage of the update, emitting, preparing the affectors and animating
+// the particles into their sprite data or instance table, is printed after
+// each benchmark.
+class tst_benchparticles : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_benchparticles() = default;
+    ~tst_benchparticles() = default;
+
+private Q_SLOTS:
+    void bench_sprite_data();
+    void bench_sprite();
+    void bench_model_data();
+    void bench_model();
+    void bench_trail_data();
+    void bench_trail();
+
+private:
+    enum Affector {
+        NoAffectors = 0x0,
+        Gravity = 0x1,
+        Wander = 0x2,
+        Attractor = 0x4,
+        Repeller = 0x8,
+        AllAffectors = 0xf
+    };
+
+    // componentComplete() is what QML would call
+    class TestSystem : public QQuick3DParticleSystem
+    {
+    public:
+        void init() { QQuick3DParticleSystem::componentComplete(); }
+    };
+
+    class TestModelParticle : public QQuick3DParticleModelParticle
+    {
+    public:
+        TestModelParticle(QQuick3DNode *parent) : QQuick3DParticleModelParticle(parent) { }
+        void init() { QQuick3DParticleModelParticle::componentComplete(); }
+    };
+
+    static constexpr int FrameTime = 16; // ms
+    static constexpr int LifeSpan = 2000; // ms
+
+    static void addRows(int maxCount, const QList<int> &affectorStacks);
+    static std::unique_ptr<TestSystem> createSystem();
+    static QQuick3DParticleEmitter *addEmitter(TestSystem *system, QQuick3DParticle *particle, int count);
+    static void addAffectors(TestSystem *system, int affectors);
+    static void run(TestSystem *system);
+};
+
+void tst_benchparticles::addRows(int maxCount, const QList<int> &affectorStacks)
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("affectors");
+
+    const auto stackName = [](int affectors) -> QByteArray {
+        switch (affectors) {
+        case NoAffectors:
+            return QByteArrayLiteral("none");
+        case Gravity:
+            return QByteArrayLiteral("gravity");
+        case Wander:
+            return QByteArrayLiteral("wander");
+        case Attractor:
+            return QByteArrayLiteral("attractor");
+        case Repeller:
+            return QByteArrayLiteral("repeller");
+        default:
+            break;
+        }
+        return QByteArrayLiteral("all");
+    };
+
+    for (int count = 1000; count <= maxCount; count *= 10) {
+        for (int affectors : affectorStacks)
+            QTest::addRow("%d, %s", count, stackName(affectors).constData()) << count << affectors;
+    }
+}
+
+std::unique_ptr<tst_benchparticles::TestSystem> tst_benchparticles::createSystem()
+{
+    auto system = std::make_unique<TestSystem>();
+    // Only updateCurrentTime() advances the time
+    system->setRunning(false);
+    system->setUseRandomSeed(false);
+    system->setSeed(1234);
+    system->init();
+    return system;
+}
+
+QQuick3DParticleEmitter *tst_benchparticles::addEmitter(TestSystem *system, QQuick3DParticle *particle, int count)
+{
+    auto *direction = new QQuick3DParticleVectorDirection(system);
+    direction->setDirection(QVector3D(0.0f, 100.0f, 0.0f));
+    direction->setDirectionVariation(QVector3D(50.0f, 20.0f, 50.0f));
+
+    auto *emitter = new QQuick3DParticleEmitter(system);
+    emitter->setSystem(system);
+    emitter->setParticle(particle);
+    emitter->setVelocity(direction);
+    emitter->setLifeSpan(LifeSpan);
+    emitter->setEmitRate(float(count) * 1000.0f / LifeSpan);
+    emitter->setParticleScaleVariation(0.5f);
+    emitter->setParticleRotationVelocity(QVector3D(0.0f, 90.0f, 0.0f));
+    return emitter;
+}
+
+void tst_benchparticles::addAffectors(TestSystem *system, int affectors)
+{
+    if (affectors & Gravity) {
+        auto *gravity = new QQuick3DParticleGravity(system);
+        gravity->setMagnitude(200.0f);
+        gravity->setSystem(system);
+    }
+    if (affectors & Wander) {
+        auto *wander = new QQuick3DParticleWander(system);
+        wander->setGlobalAmount(QVector3D(20.0f, 0.0f, 20.0f));
+        wander->setGlobalPace(QVector3D(0.5f, 0.0f, 0.5f));
+        wander->setUniqueAmount(QVector3D(10.0f, 10.0f, 10.0f));
+        wander->setUniquePace(QVector3D(1.0f, 1.0f, 1.0f));
+        wander->setUniqueAmountVariation(0.5f);
+        wander->setUniquePaceVariation(0.5f);
+        wander->setSystem(system);
+    }
+    if (affectors & Attractor) {
+        auto *attractor = new QQuick3DParticleAttractor(system);
+        attractor->setPosition(QVector3D(0.0f, 300.0f, 0.0f));
+        attractor->setPositionVariation(QVector3D(20.0f, 20.0f, 20.0f));
+        attractor->setDuration(LifeSpan);
+        attractor->setSystem(system);
+    }
+    if (affectors & Repeller) {
+        auto *repeller = new QQuick3DParticleRepeller(system);
+        repeller->setPosition(QVector3D(0.0f, 100.0f, 0.0f));
+        repeller->setRadius(20.0f);
+        repeller->setOuterRadius(100.0f);
+        repeller->setStrength(100.0f);
+        repeller->setSystem(system);
+    }
+}
+
+void tst_benchparticles::run(TestSystem *system)
+{
+    // Until the first particles die, fewer of them are alive
+    int time = 0;
+    for (; time <= LifeSpan; time += FrameTime)
+        system->updateCurrentTime(time);
+
+    QQuick3DParticleSystem::UpdateTimings total;
+    qint64 updates = 0;
+    QBENCHMARK {
+        system->updateCurrentTime(time += FrameTime);
+        const auto &timings = system->lastUpdateTimings();
+        total.emitParticles += timings.emitParticles;
+        total.prepareAffectors += timings.prepareAffectors;
+        total.spriteParticles += timings.spriteParticles;
+        total.modelParticles += timings.modelParticles;
+        total.modelBlendParticles += timings.modelBlendParticles;
+        ++updates;
+    }
+
+    const auto ms = [updates](qint64 nsecs) { return double(nsecs) / updates / 1000000.0; };
+    qInfo("per update: emit %.3f ms, prepare affectors %.3f ms, sprite particles %.3f ms, model particles %.3f ms, "
+          "model blend particles %.3f ms",
+          ms(total.emitParticles), ms(total.prepareAffectors), ms(total.spriteParticles), ms(total.modelParticles),
+          ms(total.modelBlendParticles));
+}
+
+void tst_benchparticles::bench_sprite_data()
+{
+    addRows(1000000, { NoAffectors, Gravity, Wander, Attractor, Repeller, AllAffectors });
+}
+
+void tst_benchparticles::bench_sprite()
+{
+    QFETCH(int, count);
+    QFETCH(int, affectors);
+
+    auto system = createSystem();
+    auto *particle = new QQuick3DParticleSpriteParticle(system.get());
+    particle->setMaxAmount(count);
+    particle->setSystem(system.get());
+    particle->setFadeInDuration(100);
+    particle->setFadeOutDuration(200);
+    addEmitter(system.get(), particle, count);
+    addAffectors(system.get(), affectors);
+
+    run(system.get());
+}
+
+void tst_benchparticles::bench_model_data()
+{
+    addRows(1000000, { NoAffectors, AllAffectors });
+}
+
+void tst_benchparticles::bench_model()
+{
+    QFETCH(int, count);
+    QFETCH(int, affectors);
+
+    auto system = createSystem();
+    auto *particle = new TestModelParticle(system.get());
+    particle->setMaxAmount(count);
+    particle->setSystem(system.get());
+    // Creates the instance table, filled in each update
+    particle->init();
+    QVERIFY(particle->instanceTable());
+    addEmitter(system.get(), particle, count);
+    addAffectors(system.get(), affectors);
+
+    run(system.get());
+}
+
+void tst_benchparticles::bench_trail_data()
+{
+    addRows(100000, { NoAffectors, AllAffectors });
+}
+
+void tst_benchparticles::bench_trail()
+{
+    QFETCH(int, count);
+    QFETCH(int, affectors);
+
+    // A tenth of the particles lead, each followed by a trail of nine
+    constexpr int TrailLength = 9;
+    constexpr int TrailLifeSpan = 450; // ms
+    const int leadCount = count / (TrailLength + 1);
+
+    auto system = createSystem();
+    auto *lead = new QQuick3DParticleSpriteParticle(system.get());
+    lead->setMaxAmount(leadCount);
+    lead->setSystem(system.get());
+    addEmitter(system.get(), lead, leadCount);
+
+    auto *trail = new QQuick3DParticleSpriteParticle(system.get());
+    trail->setMaxAmount(count - leadCount);
+    trail->setSystem(system.get());
+    trail->setFadeOutDuration(TrailLifeSpan);
+
+    auto *trailEmitter = new QQuick3DParticleTrailEmitter(system.get());
+    trailEmitter->setSystem(system.get());
+    trailEmitter->setParticle(trail);
+    trailEmitter->setFollow(lead);
+    trailEmitter->setLifeSpan(TrailLifeSpan);
+    trailEmitter->setEmitRate(TrailLength * 1000.0f / TrailLifeSpan);
+
+    addAffectors(system.get(), affectors);
+
+    run(system.get());
+}
+
+QTEST_APPLESS_MAIN(tst_benchparticles)
+
+#include "tst_benchparticles.moc"
@@ -0,0 +1,829 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/qfloat16.h>
+#include <QtGui/QImage>
+
+#include <ssg/qssgrendercontextcore.h>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderloadedtexture_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgtexturecooker_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendertexturedata_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendergeometry_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+#include "../../shared/nullrendercontext.h"
+
+// Loads generated meshes and images in the formats the renderer supports, and
+// uploads them on the Null backend. The images and meshes are written to a
+// temporary directory at startup, in a few sizes.
+//
+// Each benchmark covers one step: decoding the file (QSSGLoadedTexture::load,
+// QSSGMesh::Mesh::loadMesh), converting a decoded image to the format it is
+// uploaded in, uploading data that is already in memory, and the whole of
+// QSSGBufferManager::loadRenderImage / loadMesh, including the prefiltering
+// of light probes. Besides the time, the throughput in MB/s of the input and
+// how much more heap is in use right after the step than before it are
+// printed, and the peak heap usage when built with QSSG_BENCHMARK_HEAP_PEAK.
+
+// Heap usage, from the statistics of the C library allocator. Only with glibc
+// 2.33 or newer, elsewhere it is not reported.
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#  if __GLIBC_PREREQ(2, 33)
+#    define QSSG_BENCHMARK_MALLINFO2
+#  endif
+#endif
+
+#if defined(QSSG_BENCHMARK_MALLINFO2)
+static qint64 heapInUse()
+{
+    const struct mallinfo2 info = mallinfo2();
+    // Large blocks, like most decoded images, are mapped separately
+    return qint64(info.uordblks + info.hblkhd);
+}
+#else
+static qint64 heapInUse()
+{
+    return -1;
+}
+#endif
+
+// The peak heap usage within a step needs the allocator to be wrapped, which
+// is opt-in by defining QSSG_BENCHMARK_HEAP_PEAK, and never done when a
+// sanitizer brings its own allocator.
+#if defined(__has_feature)
+#  if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer) || __has_feature(thread_sanitizer)
+#    define QSSG_BENCHMARK_SANITIZED
+#  endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#  define QSSG_BENCHMARK_SANITIZED
+#endif
+
+#if defined(QSSG_BENCHMARK_HEAP_PEAK) && defined(__GLIBC__) && !defined(QSSG_BENCHMARK_SANITIZED)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<qint64> s_heapInUse { 0 };
+static std::atomic<qint64> s_heapPeak { 0 };
+
+static void *countAllocation(void *ptr)
+{
+    if (ptr) {
+        const qint64 inUse = s_heapInUse += qint64(malloc_usable_size(ptr));
+        qint64 peak = s_heapPeak.load(std::memory_order_relaxed);
+        while (inUse > peak && !s_heapPeak.compare_exchange_weak(peak, inUse, std::memory_order_relaxed)) { }
+    }
+    return ptr;
+}
+
+static void countRelease(void *ptr)
+{
+    if (ptr)
+        s_heapInUse -= qint64(malloc_usable_size(ptr));
+}
+
+// Every allocation function of glibc is replaced, otherwise the memory it
+// hands out would be released through the wrapped free without having been
+// counted. What C++ allocates goes through malloc. Memory mapped directly with
+// mmap, like by the graphics drivers, is not counted.
+//
+// Declared __THROW like in the C library headers
+extern "C" {
+void *malloc(size_t size) __THROW
+{
+    return countAllocation(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+    return countAllocation(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, size_t size) __THROW
+{
+    const size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+    void *result = __libc_realloc(ptr, size);
+    if (result || size == 0) {
+        s_heapInUse -= qint64(oldSize);
+        countAllocation(result);
+    }
+    return result;
+}
+
+void *reallocarray(void *ptr, size_t count, size_t size) __THROW
+{
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(ptr, total);
+}
+
+void *memalign(size_t alignment, size_t size) __THROW
+{
+    return countAllocation(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size) __THROW
+{
+    return countAllocation(__libc_memalign(alignment, size));
+}
+
+void *valloc(size_t size) __THROW
+{
+    return countAllocation(__libc_memalign(size_t(sysconf(_SC_PAGESIZE)), size));
+}
+
+void *pvalloc(size_t size) __THROW
+{
+    // Rounded up to whole pages, at least one
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    const size_t pagedSize = size ? (size + pageSize - 1) & ~(pageSize - 1) : pageSize;
+    return countAllocation(__libc_memalign(pageSize, pagedSize));
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) __THROW
+{
+    void *result = __libc_memalign(alignment, size);
+    if (!result)
+        return ENOMEM;
+    *ptr = countAllocation(result);
+    return 0;
+}
+
+void free(void *ptr) __THROW
+{
+    countRelease(ptr);
+    __libc_free(ptr);
+}
+}
+
+static qint64 resetHeapPeak()
+{
+    const qint64 inUse = s_heapInUse.load();
+    s_heapPeak = inUse;
+    return inUse;
+}
+
+static qint64 heapPeak()
+{
+    return s_heapPeak.load();
+}
+#else
+static qint64 resetHeapPeak()
+{
+    return -1;
+}
+
+static qint64 heapPeak()
+{
+    return -1;
+}
+#endif
+
+// Accumulates the time and the amount of data of each iteration
+class LoadMeter
+{
+public:
+    void start()
+    {
+        m_heapBase = heapInUse();
+        m_peakBase = resetHeapPeak();
+        m_timer.start();
+    }
+
+    // Records how much more heap is in use than at start(). Called by stop(),
+    // and before that by the steps that release what they loaded.
+    void sampleHeap()
+    {
+        if (m_heapBase >= 0)
+            m_held = qMax(m_held, heapInUse() - m_heapBase);
+    }
+
+    void stop(qint64 bytes)
+    {
+        m_nsecs += m_timer.nsecsElapsed();
+        m_bytes += bytes;
+        sampleHeap();
+        if (m_peakBase >= 0)
+            m_peak = qMax(m_peak, heapPeak() - m_peakBase);
+    }
+
+    void report() const
+    {
+        const double seconds = m_nsecs / 1000000000.0;
+        const double megabytes = m_bytes / (1024.0 * 1024.0);
+        QByteArray line = QByteArray::number(seconds > 0.0 ? megabytes / seconds : 0.0, 'f', 1) + " MB/s";
+        if (m_heapBase >= 0)
+            line += ", heap held " + QByteArray::number(m_held / (1024.0 * 1024.0), 'f', 2) + " MB";
+        if (m_peakBase >= 0)
+            line += ", peak heap " + QByteArray::number(m_peak / (1024.0 * 1024.0), 'f', 2) + " MB";
+        qInfo("%s", line.constData());
+    }
+
+private:
+    QElapsedTimer m_timer;
+    qint64 m_nsecs = 0;
+    qint64 m_bytes = 0;
+    qint64 m_heapBase = -1;
+    qint64 m_held = 0;
+    qint64 m_peakBase = -1;
+    qint64 m_peak = 0;
+};
+
+class tst_benchresourceloading : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_benchresourceloading() = default;
+    ~tst_benchresourceloading() = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void bench_decodeImage_data();
+    void bench_decodeImage();
+    void bench_convertImage_data();
+    void bench_convertImage();
+    void bench_uploadTextureData_data();
+    void bench_uploadTextureData();
+    void bench_loadRenderImage_data();
+    void bench_loadRenderImage();
+    void bench_environmentMap_data();
+    void bench_environmentMap();
+    void bench_decodeMesh_data();
+    void bench_decodeMesh();
+    void bench_loadRenderMesh_data();
+    void bench_loadRenderMesh();
+    void bench_uploadGeometry_data();
+    void bench_uploadGeometry();
+
+private:
+    void nextFrame();
+    QString imagePath(const QByteArray &format, int size) const;
+    QString meshPath(int gridSize) const;
+    static void addImageRows(const QList<QByteArray> &formats);
+    static void addMeshRows();
+    static void fillGeometry(QSSGRenderGeometry *geometry, int gridSize);
+
+    std::unique_ptr<NullRenderContext> m_context;
+    QTemporaryDir m_dir;
+};
+
+static const int ImageSizes[] = { 256, 1024, 2048 };
+static const int MeshGridSizes[] = { 64, 256, 1024 }; // vertices per side
+
+// A smooth gradient with some noise, so that PNG compresses it like a photo
+// rather than like a flat color, and some values above 1 for HDR formats
+static QVector3D imageColor(int x, int y, int size)
+{
+    const quint32 hash = quint32(x) * 73856093u ^ quint32(y) * 19349663u;
+    const float noise = float(hash % 64u) / 255.0f;
+    return QVector3D(float(x) / size + noise,
+                     float(y) / size,
+                     0.5f + 0.5f * std::sin(float(x + y) * 0.05f)) * (1.0f + 4.0f * float(x) / size);
+}
+
+static QImage generateImage(int size)
+{
+    QImage image(size, size, QImage::Format_RGB32);
+    for (int y = 0; y < size; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < size; ++x) {
+            const QVector3D c = imageColor(x, y, size) * (255.0f / 5.0f);
+            line[x] = qRgb(qBound(0, int(c.x()), 255), qBound(0, int(c.y()), 255), qBound(0, int(c.z()), 255));
+        }
+    }
+    return image;
+}
+
+// Radiance HDR, with the scanlines run length encoded per channel but without
+// any runs, the way most tools write them
+static bool writeRadianceHdr(const QString &fileName, int size)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write("#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n");
+    file.write(QByteArray("-Y ") + QByteArray::number(size) + " +X " + QByteArray::number(size) + "\n");
+
+    QByteArray channels[4];
+    for (int y = 0; y < size; ++y) {
+        for (QByteArray &channel : channels)
+            channel.resize(size);
+        for (int x = 0; x < size; ++x) {
+            const QVector3D c = imageColor(x, y, size);
+            const float v = qMax(c.x(), qMax(c.y(), c.z()));
+            if (v < 1e-32f) {
+                for (QByteArray &channel : channels)
+                    channel[x] = 0;
+                continue;
+            }
+            int e = 0;
+            const float scale = std::frexp(v, &e) * 256.0f / v;
+            channels[0][x] = char(uchar(c.x() * scale));
+            channels[1][x] = char(uchar(c.y() * scale));
+            channels[2][x] = char(uchar(c.z() * scale));
+            channels[3][x] = char(uchar(e + 128));
+        }
+        QByteArray line;
+        line.reserve(4 + size * 4 + size / 32 + 4);
+        line.append(char(2)).append(char(2)).append(char(size >> 8)).append(char(size & 0xFF));
+        for (const QByteArray &channel : channels) {
+            for (int x = 0; x < size; x += 128) {
+                const int count = qMin(128, size - x);
+                line.append(char(count));
+                line.append(channel.constData() + x, count);
+            }
+        }
+        file.write(line);
+    }
+    return file.error() == QFileDevice::NoError;
+}
+
+// OpenEXR, scanlines of half floats without compression
+static bool writeOpenExr(const QString &fileName, int size)
+{
+    QByteArray header;
+    const auto appendInt = [&header](qint32 value) {
+        const qint32 le = qToLittleEndian(value);
+        header.append(reinterpret_cast<const char *>(&le), sizeof(le));
+    };
+    const auto appendFloat = [&appendInt](float value) {
+        qint32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        appendInt(bits);
+    };
+    const auto appendAttribute = [&header, &appendInt](const char *name, const char *type, qint32 size) {
+        header.append(name).append('\0').append(type).append('\0');
+        appendInt(size);
+    };
+
+    header.append("\x76\x2f\x31\x01", 4); // magic
+    header.append("\x02\x00\x00\x00", 4); // version 2, single part scanlines
+    // The channels in alphabetical order
+    appendAttribute("channels", "chlist", 4 * (2 + 16) + 1);
+    for (const char *name : { "A", "B", "G", "R" }) {
+        header.append(name).append('\0');
+        appendInt(1); // HALF
+        header.append(4, '\0'); // pLinear and reserved
+        appendInt(1); // x sampling
+        appendInt(1); // y sampling
+    }
+    header.append('\0');
+    appendAttribute("compression", "compression", 1);
+    header.append('\0'); // NO_COMPRESSION
+    for (const char *window : { "dataWindow", "displayWindow" }) {
+        appendAttribute(window, "box2i", 16);
+        appendInt(0);
+        appendInt(0);
+        appendInt(size - 1);
+        appendInt(size - 1);
+    }
+    appendAttribute("lineOrder", "lineOrder", 1);
+    header.append('\0'); // INCREASING_Y
+    appendAttribute("pixelAspectRatio", "float", 4);
+    appendFloat(1.0f);
+    appendAttribute("screenWindowCenter", "v2f", 8);
+    appendFloat(0.0f);
+    appendFloat(0.0f);
+    appendAttribute("screenWindowWidth", "float", 4);
+    appendFloat(1.0f);
+    header.append('\0');
+
+    // One scanline per block, each with its y and size
+    const qint32 lineSize = size * 4 * qint32(sizeof(qfloat16));
+    const quint64 firstBlock = quint64(header.size()) + quint64(size) * sizeof(quint64);
+    for (int y = 0; y < size; ++y) {
+        const quint64 offset = qToLittleEndian(firstBlock + quint64(y) * quint64(8 + lineSize));
+        header.append(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(header);
+    QList<qfloat16> line(size * 4);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const QVector3D c = imageColor(x, y, size);
+            line[x] = qfloat16(1.0f);
+            line[size + x] = qfloat16(c.z());
+            line[2 * size + x] = qfloat16(c.y());
+            line[3 * size + x] = qfloat16(c.x());
+        }
+        const qint32 blockHeader[2] = { qToLittleEndian(qint32(y)), qToLittleEndian(lineSize) };
+        file.write(reinterpret_cast<const char *>(blockHeader), sizeof(blockHeader));
+        file.write(reinterpret_cast<const char *>(line.constData()), lineSize);
+    }
+    return file.error() == QFileDevice::NoError;
+}
+
+void tst_benchresourceloading::fillGeometry(QSSGRenderGeometry *geometry, int gridSize)
+{
+    // A rippled grid with positions, normals and texture coordinates
+    struct Vertex {
+        QVector3D position;
+        QVector3D normal;
+        QVector2D uv;
+    };
+    QByteArray vertexData(gridSize * gridSize * qsizetype(sizeof(Vertex)), Qt::Uninitialized);
+    Vertex *v = reinterpret_cast<Vertex *>(vertexData.data());
+    for (int y = 0; y < gridSize; ++y) {
+        for (int x = 0; x < gridSize; ++x) {
+            const float u = float(x) / (gridSize - 1);
+            const float w = float(y) / (gridSize - 1);
+            const float height = 0.05f * std::sin(u * 20.0f) * std::cos(w * 20.0f);
+            *v++ = { QVector3D(u - 0.5f, height, w - 0.5f),
+                     QVector3D(-std::cos(u * 20.0f), 1.0f, std::sin(w * 20.0f)).normalized(),
+                     QVector2D(u, w) };
+        }
+    }
+
+    const int quadsPerSide = gridSize - 1;
+    QByteArray indexData(quadsPerSide * quadsPerSide * 6 * qsizetype(sizeof(quint32)), Qt::Uninitialized);
+    quint32 *i = reinterpret_cast<quint32 *>(indexData.data());
+    for (int y = 0; y < quadsPerSide; ++y) {
+        for (int x = 0; x < quadsPerSide; ++x) {
+            const quint32 a = quint32(y * gridSize + x);
+            const quint32 b = a + quint32(gridSize);
+            *i++ = a;
+            *i++ = b;
+            *i++ = a + 1;
+            *i++ = a + 1;
+            *i++ = b;
+            *i++ = b + 1;
+        }
+    }
+
+    const QVector3D boundsMin(-0.5f, -0.05f, -0.5f);
+    const QVector3D boundsMax(0.5f, 0.05f, 0.5f);
+    geometry->clear();
+    geometry->setStride(sizeof(Vertex));
+    geometry->setVertexData(vertexData);
+    geometry->setIndexData(indexData);
+    geometry->setPrimitiveType(QSSGMesh::Mesh::DrawMode::Triangles);
+    geometry->setBounds(boundsMin, boundsMax);
+    geometry->addAttribute(QSSGMesh::RuntimeMeshData::Attribute::PositionSemantic, 0, QSSGMesh::Mesh::ComponentType::Float32);
+    geometry->addAttribute(QSSGMesh::RuntimeMeshData::Attribute::NormalSemantic, offsetof(Vertex, normal), QSSGMesh::Mesh::ComponentType::Float32);
+    geometry->addAttribute(QSSGMesh::RuntimeMeshData::Attribute::TexCoordSemantic, offsetof(Vertex, uv), QSSGMesh::Mesh::ComponentType::Float32);
+    geometry->addAttribute(QSSGMesh::RuntimeMeshData::Attribute::IndexSemantic, 0, QSSGMesh::Mesh::ComponentType::UnsignedInt32);
+    geometry->addSubset(0, quint32(quadsPerSide * quadsPerSide * 6), boundsMin, boundsMax);
+}
+
+void tst_benchresourceloading::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    m_context = std::make_unique<NullRenderContext>();
+    QVERIFY(m_context->isValid());
+
+    for (int size : ImageSizes) {
+        const QImage image = generateImage(size);
+        QVERIFY(image.save(imagePath("png", size), "PNG"));
+        QVERIFY(writeRadianceHdr(imagePath("hdr", size), size));
+        QVERIFY(writeOpenExr(imagePath("exr", size), size));
+        for (bool compress : { false, true }) {
+            const QSSGTextureCooker::Result cooked = QSSGTextureCooker::cook(image, QByteArrayLiteral("benchmark"), compress);
+            QVERIFY(cooked.compressed == compress);
+            QFile file(imagePath(compress ? "ktx bc1" : "ktx", size));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            QCOMPARE(file.write(cooked.ktxData), qint64(cooked.ktxData.size()));
+        }
+
+        // A source image with the file the texturecooker tool writes next to
+        // it, which loadRenderImage uploads instead of decoding the source
+        const QString cookedSourcePath = imagePath("png cooked", size);
+        QVERIFY(QFile::copy(imagePath("png", size), cookedSourcePath));
+        QFile source(cookedSourcePath);
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        const QSSGTextureCooker::Result cooked = QSSGTextureCooker::cook(image, QSSGTextureCooker::sourceKey(source.readAll()), false,
+                                                                         QSSGTextureCooker::sourceStamp(cookedSourcePath));
+        QFile cookedFile(QSSGTextureCooker::cookedPath(cookedSourcePath));
+        QVERIFY(cookedFile.open(QIODevice::WriteOnly));
+        QCOMPARE(cookedFile.write(cooked.ktxData), qint64(cooked.ktxData.size()));
+    }
+
+    for (int gridSize : MeshGridSizes) {
+        QSSGRenderGeometry geometry;
+        fillGeometry(&geometry, gridSize);
+        const QSSGMesh::Mesh mesh = m_context->renderContext()->bufferManager()->loadMeshData(&geometry);
+        QVERIFY(mesh.isValid());
+        QFile file(meshPath(gridSize));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(mesh.save(&file) != 0);
+    }
+}
+
+void tst_benchresourceloading::cleanupTestCase()
+{
+    m_context.reset();
+}
+
+void tst_benchresourceloading::nextFrame()
+{
+    m_context->nextFrame();
+}
+
+QString tst_benchresourceloading::imagePath(const QByteArray &format, int size) const
+{
+    if (format == "png cooked")
+        return m_dir.filePath(QStringLiteral("image%1cooked.png").arg(size));
+    if (format.startsWith("ktx"))
+        return m_dir.filePath(QStringLiteral("image%1%2.ktx").arg(size).arg(format.endsWith("bc1") ? QLatin1StringView("bc1") : QLatin1StringView()));
+    return m_dir.filePath(QStringLiteral("image%1.%2").arg(size).arg(QString::fromLatin1(format)));
+}
+
+QString tst_benchresourceloading::meshPath(int gridSize) const
+{
+    return m_dir.filePath(QStringLiteral("grid%1.mesh").arg(gridSize));
+}
+
+void tst_benchresourceloading::addImageRows(const QList<QByteArray> &formats)
+{
+    QTest::addColumn<QByteArray>("format");
+    QTest::addColumn<int>("size");
+    for (const QByteArray &format : formats) {
+        for (int size : ImageSizes)
+            QTest::addRow("%s %d", format.constData(), size) << format << size;
+    }
+}
+
+void tst_benchresourceloading::addMeshRows()
+{
+    QTest::addColumn<int>("gridSize");
+    for (int gridSize : MeshGridSizes)
+        QTest::addRow("%d vertices", gridSize * gridSize) << gridSize;
+}
+
+void tst_benchresourceloading::bench_decodeImage_data()
+{
+    addImageRows({ "png", "hdr", "exr", "ktx", "ktx bc1" });
+}
+
+void tst_benchresourceloading::bench_decodeImage()
+{
+    QFETCH(QByteArray, format);
+    QFETCH(int, size);
+
+    // PNG images are converted to RGBA8, HDR and EXR images to RGBA16F, as
+    // part of loading them
+    const QString path = imagePath(format, size);
+    const qint64 fileSize = QFileInfo(path).size();
+    LoadMeter meter;
+    QBENCHMARK {
+        meter.start();
+        std::unique_ptr<QSSGLoadedTexture> texture(QSSGLoadedTexture::load(path, QSSGRenderTextureFormat::Unknown));
+        meter.stop(fileSize);
+        QVERIFY(texture);
+    }
+    meter.report();
+}
+
+void tst_benchresourceloading::bench_convertImage_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("imageFormat");
+    for (int size : ImageSizes) {
+        QTest::addRow("RGB32 %d", size) << size << int(QImage::Format_RGB32);
+        QTest::addRow("ARGB32 %d", size) << size << int(QImage::Format_ARGB32);
+        QTest::addRow("Indexed8 %d", size) << size << int(QImage::Format_Indexed8);
+    }
+}
+
+void tst_benchresourceloading::bench_convertImage()
+{
+    QFETCH(int, size);
+    QFETCH(int, imageFormat);
+
+    // The formats QImage decodes common PNG and JPEG files to
+    const QImage image = generateImage(size).convertToFormat(QImage::Format(imageFormat));
+    LoadMeter meter;
+    QBENCHMARK {
+        meter.start();
+        const QImage converted = QSSGLoadedTexture::convertToUploadFormat(image);
+        meter.stop(image.sizeInBytes());
+        QVERIFY(!converted.isNull());
+    }
+    meter.report();
+}
+
+void tst_benchresourceloading::bench_uploadTextureData_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("format");
+    QTest::addColumn<bool>("mipmaps");
+    for (int size : ImageSizes) {
+        QTest::addRow("RGBA8 %d", size) << size << int(QSSGRenderTextureFormat::RGBA8) << false;
+        QTest::addRow("RGBA8 %d, mipmaps", size) << size << int(QSSGRenderTextureFormat::RGBA8) << true;
+        QTest::addRow("RGBA16F %d", size) << size << int(QSSGRenderTextureFormat::RGBA16F) << false;
+        QTest::addRow("RGBA32F %d", size) << size << int(QSSGRenderTextureFormat::RGBA32F) << false;
+    }
+}
+
+void tst_benchresourceloading::bench_uploadTextureData()
+{
+    QFETCH(int, size);
+    QFETCH(int, format);
+    QFETCH(bool, mipmaps);
+
+    const auto &bufferManager = m_context->renderContext()->bufferManager();
+    const QSSGRenderTextureFormat textureFormat = QSSGRenderTextureFormat::Format(format);
+    QSSGRenderTextureData textureData;
+    textureData.setSize(QSize(size, size));
+    textureData.setFormat(textureFormat);
+    textureData.setTextureData(QByteArray(size * size * textureFormat.getSizeofFormat(), 1));
+
+    QSSGRenderImage image;
+    image.m_rawTextureData = &textureData;
+    image.m_generateMipmaps = mipmaps;
+
+    LoadMeter meter;
+    QBENCHMARK {
+        meter.start();
+        const bool loaded = bufferManager->loadRenderImage(&image).m_texture != nullptr;
+        meter.sampleHeap();
+        bufferManager->releaseTextureData(&textureData);
+        nextFrame();
+        meter.stop(textureData.textureData().size());
+        QVERIFY(loaded);
+    }
+    meter.report();
+}
+
+void tst_benchresourceloading::bench_loadRenderImage_data()
+{
+    addImageRows({ "png", "png cooked", "hdr", "exr", "ktx", "ktx bc1" });
+}
+
+void tst_benchresourceloading::bench_loadRenderImage()
+{
+    QFETCH(QByteArray, format);
+    QFETCH(int, size);
+
+    const auto &bufferManager = m_context->renderContext()->bufferManager();
+    const QString path = imagePath(format, size);
+    const qint64 fileSize = QFileInfo(path).size();
+    QSSGRenderImage image;
+    image.m_imagePath = QSSGRenderPath(path);
+    image.m_generateMipmaps = true;
+    // The KTX files are written by the cooker as well
+    const bool expectCooked = format == "png cooked" || format.startsWith("ktx");
+    const QSSGRhiContextStats &stats = QSSGRhiContextStats::get(*m_context->renderContext()->rhiContext());
+
+    LoadMeter meter;
+    QBENCHMARK {
+        meter.start();
+        const QRhiTexture *texture = bufferManager->loadRenderImage(&image).m_texture;
+        meter.sampleHeap();
+        const bool cooked = stats.textureLoads.value(texture).cooked;
+        bufferManager->releaseCachedResources();
+        nextFrame();
+        meter.stop(fileSize);
+        QVERIFY(texture);
+        QCOMPARE(cooked, expectCooked);
+    }
+    meter.report();
+}
+
+void tst_benchresourceloading::bench_environmentMap_data()
+{
+    addImageRows({ "hdr", "exr" });
+}
+
+void tst_benchresourceloading::bench_environmentMap()
+{
+    QFETCH(QByteArray, format);
+    QFETCH(int, size);
+
+    // Loads the image as a light probe, converting it to a cube map and
+    // prefiltering it
+    const auto &bufferManager = m_context->renderContext()->bufferManager();
+    const QString path = imagePath(format, size);
+    const qint64 fileSize = QFileInfo(path).size();
+    QSSGRenderImage image;
+    image.m_imagePath = QSSGRenderPath(path);
+
+    LoadMeter meter;
+    QBENCHMARK {
+        meter.start();
+        const bool loaded = bufferManager->loadRenderImage(&image, QSSGBufferManager::MipModeBsdf).m_texture != nullptr;
+        meter.sampleHeap();
+        bufferManager->releaseCachedResources();
+        nextFrame();
+        meter.stop(fileSize);
+        QVERIFY(loaded);
+    }
+    meter.report();
+}
+
+void tst_benchresourceloading::bench_decodeMesh_data()
+{
+    addMeshRows();
+}
+
+void tst_benchresourceloading::bench_decodeMesh()
+{
+    QFETCH(int, gridSize);
+
+    QFile file(meshPath(gridSize));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    LoadMeter meter;
+    QBENCHMARK {
+        meter.start();
+        file.seek(0);
+        const QSSGMesh::Mesh mesh = QSSGMesh::Mesh::loadMesh(&file);
+        meter.stop(file.size());
+        QVERIFY(mesh.isValid());
+    }
+    meter.report();
+}
+
+void tst_benchresourceloading::bench_loadRenderMesh_data()
+{
+    addMeshRows();
+}
+
+void tst_benchresourceloading::bench_loadRenderMesh()
+{
+    QFETCH(int, gridSize);
+
+    const auto &bufferManager = m_context->renderContext()->bufferManager();
+    const QString path = meshPath(gridSize);
+    const qint64 fileSize = QFileInfo(path).size();
+    QSSGRenderModel model;
+    model.meshPath = QSSGRenderPath(path);
+
+    LoadMeter meter;
+    QBENCHMARK {
+        meter.start();
+        const bool loaded = bufferManager->loadMesh(&model) != nullptr;
+        bufferManager->commitBufferResourceUpdates();
+        meter.sampleHeap();
+        bufferManager->releaseCachedResources();
+        nextFrame();
+        meter.stop(fileSize);
+        QVERIFY(loaded);
+    }
+    meter.report();
+}
+
+void tst_benchresourceloading::bench_uploadGeometry_data()
+{
+    addMeshRows();
+}
+
+void tst_benchresourceloading::bench_uploadGeometry()
+{
+    QFETCH(int, gridSize);
+
+    // Custom geometry, converted to a mesh and uploaded
+    const auto &bufferManager = m_context->renderContext()->bufferManager();
+    QSSGRenderGeometry geometry;
+    fillGeometry(&geometry, gridSize);
+    QSSGRenderModel model;
+    model.geometry = &geometry;
+    const qint64 dataSize = geometry.vertexBuffer().size() + geometry.indexBuffer().size();
+
+    LoadMeter meter;
+    QBENCHMARK {
+        meter.start();
+        const bool loaded = bufferManager->loadMesh(&model) != nullptr;
+        bufferManager->commitBufferResourceUpdates();
+        meter.sampleHeap();
+        bufferManager->releaseGeometry(&geometry);
+        nextFrame();
+        meter.stop(dataSize);
+        QVERIFY(loaded);
+    }
+    meter.report();
+}
+
+QTEST_APPLESS_MAIN(tst_benchresourceloading)
+
+#include "tst_benchresourceloading.moc"
@@ -0,0 +1,537 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtCore/QTemporaryDir>
+
+#include <ssg/qssgrendercontextcore.h>
+
+#include <QtQuick3DUtils/private/qqsbcollection_p.h>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercodegenerator_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershaderkeys_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderdefaultmaterialshadergenerator_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgvertexpipelineimpl_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderableobjects_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderdefaultmaterial_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderlight_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+
+#include "../../shared/nullrendercontext.h"
+
+// Generates, bakes and looks up the shaders of a PrincipledMaterial, headless
+// on the Null backend. The material keys are filled in the way
+// QSSGLayerRenderData does it, for typical combinations of lights, shadows,
+// textures, skinning, morph targets, instancing and multiview.
+//
+// Each step of getting a pipeline for the first frame is measured on its own:
+// generating the shader sources (generateMaterialRhiShader, with the baking
+// deferred like shadergen does), baking them with QShaderBaker, finding an
+// already built shader pipeline in QSSGShaderCache, finding a graphics
+// pipeline in QSSGRhiContext, and saving, loading and reading the persistent
+// shader cache.
+
+enum MaterialFlag {
+    Shadows = 0x01,
+    Textures = 0x02,
+    Skinning = 0x04,
+    Morphing = 0x08,
+    Instancing = 0x10,
+    Multiview = 0x20
+};
+
+struct MaterialVariant
+{
+    const char *name;
+    int lightCount;
+    int flags;
+};
+
+static const MaterialVariant MaterialVariants[] = {
+    { "1 light", 1, 0 },
+    { "4 lights", 4, 0 },
+    { "8 lights", 8, 0 },
+    { "4 lights, shadows", 4, Shadows },
+    { "textures", 1, Textures },
+    { "skinning", 1, Skinning },
+    { "morphing", 1, Morphing },
+    { "instancing", 1, Instancing },
+    { "multiview", 1, Multiview },
+    { "all", 4, Shadows | Textures | Skinning | Morphing | Instancing | Multiview }
+};
+
+static const QByteArray ShaderKeyPrefix = QByteArrayLiteral("benchmark material pipeline-- ");
+
+// What the renderer has for a model with a PrincipledMaterial when it gets
+// its shaders: the material, the lights affecting it, the textures in use,
+// and the key with these and the parts of the mesh that matter.
+struct MaterialSetup
+{
+    MaterialSetup(QSSGShaderDefaultMaterialKeyProperties &properties, int lightCount, int flags);
+    Q_DISABLE_COPY(MaterialSetup)
+
+    QSSGRenderDefaultMaterial material { QSSGRenderGraphObject::Type::PrincipledMaterial };
+    std::vector<std::unique_ptr<QSSGRenderLight>> lightNodes;
+    QSSGShaderLightList lights;
+    std::vector<std::unique_ptr<QSSGRenderImage>> imageNodes;
+    std::vector<std::unique_ptr<QSSGRenderableImage>> images;
+    QSSGShaderFeatures features;
+    QSSGShaderDefaultMaterialKey key;
+    QByteArray keyString;
+};
+
+MaterialSetup::MaterialSetup(QSSGShaderDefaultMaterialKeyProperties &properties, int lightCount, int flags)
+{
+    const bool shadows = flags & Shadows;
+    features.set(QSSGShaderFeatures::Feature::Ssm, shadows);
+    key = QSSGShaderDefaultMaterialKey(qHash(features));
+
+    // Cycles through the light types, as generateLightingKey() does it
+    static const QSSGRenderLight::Type lightTypes[] = { QSSGRenderLight::Type::DirectionalLight,
+                                                        QSSGRenderLight::Type::PointLight,
+                                                        QSSGRenderLight::Type::SpotLight };
+    properties.m_hasLighting.setValue(key, true);
+    properties.m_lightCount.setValue(key, quint32(lightCount));
+    for (int i = 0; i < lightCount; ++i) {
+        auto light = std::make_unique<QSSGRenderLight>(lightTypes[i % 3]);
+        light->m_castShadow = shadows;
+        lights.push_back({ light.get(), shadows, QVector3D(0.0f, 0.0f, -1.0f) });
+        properties.m_lightFlags[i].setValue(key, light->type != QSSGRenderLight::Type::DirectionalLight);
+        properties.m_lightSpotFlags[i].setValue(key, light->type == QSSGRenderLight::Type::SpotLight);
+        properties.m_lightShadowFlags[i].setValue(key, shadows);
+        properties.m_lightShadowMapSize[i].setValue(key, light->m_shadowMapRes);
+        properties.m_lightSoftShadowQuality[i].setValue(key, quint32(light->m_softShadowQuality));
+        lightNodes.push_back(std::move(light));
+    }
+
+    quint32 vertexAttributes = QSSGShaderKeyVertexAttribute::Position | QSSGShaderKeyVertexAttribute::Normal
+            | QSSGShaderKeyVertexAttribute::TexCoord0;
+
+    if (flags & Textures) {
+        static const std::pair<QSSGRenderableImage::Type, QSSGShaderDefaultMaterialKeyProperties::ImageMapNames> maps[] = {
+            { QSSGRenderableImage::Type::BaseColor, QSSGShaderDefaultMaterialKeyProperties::BaseColorMap },
+            { QSSGRenderableImage::Type::Normal, QSSGShaderDefaultMaterialKeyProperties::NormalMap },
+            { QSSGRenderableImage::Type::Roughness, QSSGShaderDefaultMaterialKeyProperties::RoughnessMap },
+            { QSSGRenderableImage::Type::Metalness, QSSGShaderDefaultMaterialKeyProperties::MetalnessMap },
+            { QSSGRenderableImage::Type::Occlusion, QSSGShaderDefaultMaterialKeyProperties::OcclusionMap },
+            { QSSGRenderableImage::Type::Emissive, QSSGShaderDefaultMaterialKeyProperties::EmissiveMap }
+        };
+        // The single channel maps all use the red channel, which is what the
+        // key has when it is not set
+        for (const auto &map : maps) {
+            imageNodes.push_back(std::make_unique<QSSGRenderImage>());
+            images.push_back(std::make_unique<QSSGRenderableImage>(map.first, *imageNodes.back(), QSSGRenderImageTexture()));
+            if (images.size() > 1)
+                images[images.size() - 2]->m_nextImage = images.back().get();
+            QSSGShaderKeyImageMap &imageKey = properties.m_imageMaps[map.second];
+            imageKey.setEnabled(key, true);
+            imageKey.setIdentityTransform(key, true);
+        }
+        vertexAttributes |= QSSGShaderKeyVertexAttribute::Tangent | QSSGShaderKeyVertexAttribute::Binormal;
+    }
+
+    if (flags & Skinning) {
+        properties.m_boneCount.setValue(key, 64);
+        vertexAttributes |= QSSGShaderKeyVertexAttribute::JointAndWeight;
+    }
+    properties.m_vertexAttributes.setValue(key, vertexAttributes);
+
+    // Offsets of UINT8_MAX mean that the targets do not have the attribute
+    properties.m_targetPositionOffset.setValue(key, UINT8_MAX);
+    properties.m_targetNormalOffset.setValue(key, UINT8_MAX);
+    properties.m_targetTangentOffset.setValue(key, UINT8_MAX);
+    properties.m_targetBinormalOffset.setValue(key, UINT8_MAX);
+    properties.m_targetTexCoord0Offset.setValue(key, UINT8_MAX);
+    properties.m_targetTexCoord1Offset.setValue(key, UINT8_MAX);
+    properties.m_targetColorOffset.setValue(key, UINT8_MAX);
+    if (flags & Morphing) {
+        properties.m_targetCount.setValue(key, 4);
+        properties.m_targetPositionOffset.setValue(key, 0);
+        properties.m_targetNormalOffset.setValue(key, 4);
+    }
+
+    properties.m_usesInstancing.setValue(key, bool(flags & Instancing));
+
+    const int viewCount = (flags & Multiview) ? 2 : 1;
+    properties.m_viewCount.setValue(key, viewCount);
+    properties.m_usesViewIndex.setValue(key, viewCount >= 2);
+
+    keyString = ShaderKeyPrefix;
+    key.toString(keyString, properties);
+}
+
+struct ShaderSources
+{
+    QByteArray vertexCode;
+    QByteArray fragmentCode;
+    int viewCount = 1;
+    bool perTargetCompilation = false;
+};
+
+class tst_benchshadergeneration : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_benchshadergeneration() = default;
+    ~tst_benchshadergeneration() = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void bench_generate_data();
+    void bench_generate();
+    void bench_bake_data();
+    void bench_bake();
+    void bench_shaderCacheLookup_data();
+    void bench_shaderCacheLookup();
+    void bench_pipelineLookup_data();
+    void bench_pipelineLookup();
+    void bench_persistentCacheSave_data();
+    void bench_persistentCacheSave();
+    void bench_persistentCacheLoad_data();
+    void bench_persistentCacheLoad();
+    void bench_persistentCacheLookup_data();
+    void bench_persistentCacheLookup();
+
+private:
+    static void addVariantRows();
+    static void addEntryCountRows();
+    QSSGRhiShaderPipelinePtr generate(const MaterialSetup &setup);
+    ShaderSources generateSources(const MaterialSetup &setup);
+    void fillCollection(QQsbInMemoryCollection *collection, int entryCount) const;
+
+    std::unique_ptr<NullRenderContext> m_context;
+    QSSGShaderDefaultMaterialKeyProperties m_keyProperties;
+    QList<QQsbCollection::EntryDesc> m_bakedEntries;
+    QSSGRhiShaderPipelinePtr m_basePipeline;
+    std::unique_ptr<QRhiTexture> m_texture;
+    std::unique_ptr<QRhiTextureRenderTarget> m_renderTarget;
+    std::unique_ptr<QRhiRenderPassDescriptor> m_rpDesc;
+    std::unique_ptr<QRhiShaderResourceBindings> m_srb;
+    QTemporaryDir m_dir;
+};
+
+void tst_benchshadergeneration::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    // Neither read nor write the shader cache of the user
+    QtQuick3DEditorHelpers::ShaderCache::setAutomaticDiskCache(false);
+
+    m_context = std::make_unique<NullRenderContext>();
+    QVERIFY(m_context->isValid());
+
+    m_texture.reset(m_context->rhi()->newTexture(QRhiTexture::RGBA8, QSize(64, 64), 1, QRhiTexture::RenderTarget));
+    QVERIFY(m_texture->create());
+    m_renderTarget.reset(m_context->rhi()->newTextureRenderTarget({ m_texture.get() }));
+    m_rpDesc.reset(m_renderTarget->newCompatibleRenderPassDescriptor());
+    m_renderTarget->setRenderPassDescriptor(m_rpDesc.get());
+    QVERIFY(m_renderTarget->create());
+    m_srb.reset(m_context->rhi()->newShaderResourceBindings());
+    QVERIFY(m_srb->create());
+
+    // Bakes every variant once, which also fills the persistent cache of the
+    // QSSGShaderCache
+    for (const MaterialVariant &variant : MaterialVariants) {
+        const MaterialSetup setup(m_keyProperties, variant.lightCount, variant.flags);
+        const QSSGRhiShaderPipelinePtr pipeline = generate(setup);
+        QVERIFY2(pipeline && pipeline->vertexStage() && pipeline->fragmentStage(), variant.name);
+        m_bakedEntries.append({ setup.keyString,
+                                QQsbCollection::toFeatureSet(setup.features),
+                                pipeline->vertexStage()->shader(),
+                                pipeline->fragmentStage()->shader() });
+        if (!m_basePipeline)
+            m_basePipeline = pipeline;
+    }
+}
+
+void tst_benchshadergeneration::cleanupTestCase()
+{
+    m_basePipeline.reset();
+    m_srb.reset();
+    m_renderTarget.reset();
+    m_rpDesc.reset();
+    m_texture.reset();
+    m_context.reset();
+}
+
+void tst_benchshadergeneration::addVariantRows()
+{
+    QTest::addColumn<int>("lightCount");
+    QTest::addColumn<int>("flags");
+
+    for (const MaterialVariant &variant : MaterialVariants)
+        QTest::addRow("%s", variant.name) << variant.lightCount << variant.flags;
+}
+
+void tst_benchshadergeneration::addEntryCountRows()
+{
+    QTest::addColumn<int>("entryCount");
+
+    for (int entryCount : { 16, 128, 1024 })
+        QTest::addRow("%d entries", entryCount) << entryCount;
+}
+
+QSSGRhiShaderPipelinePtr tst_benchshadergeneration::generate(const MaterialSetup &setup)
+{
+    const QSSGRenderContextInterface &context = *m_context->renderContext();
+    QSSGMaterialVertexPipeline vertexPipeline(*context.shaderProgramGenerator(), m_keyProperties, setup.material.adapter);
+    return QSSGMaterialShaderGenerator::generateMaterialRhiShader(ShaderKeyPrefix,
+                                                                  vertexPipeline,
+                                                                  setup.key,
+                                                                  m_keyProperties,
+                                                                  setup.features,
+                                                                  setup.material,
+                                                                  QSSGShaderLightListView(setup.lights),
+                                                                  setup.images.empty() ? nullptr : setup.images.front().get(),
+                                                                  *context.shaderLibraryManager(),
+                                                                  *context.shaderCache());
+}
+
+ShaderSources tst_benchshadergeneration::generateSources(const MaterialSetup &setup)
+{
+    const auto &shaderCache = m_context->renderContext()->shaderCache();
+    ShaderSources sources;
+    shaderCache->setDeferredBakeFunc([&sources](const QByteArray &, const QSSGShaderFeatures &,
+                                                const QByteArray &vertexCode, const QByteArray &fragmentCode,
+                                                int viewCount, bool perTargetCompilation) {
+        sources = { vertexCode, fragmentCode, viewCount, perTargetCompilation };
+    });
+    shaderCache->releaseCachedResources();
+    generate(setup);
+    shaderCache->setDeferredBakeFunc(nullptr);
+
+    // Drops the empty pipeline left behind for the deferred bake
+    shaderCache->releaseCachedResources();
+    return sources;
+}
+
+void tst_benchshadergeneration::fillCollection(QQsbInMemoryCollection *collection, int entryCount) const
+{
+    // Repeats the baked variants under different keys, the shaders are
+    // similar in size to what a scene bakes for its materials and passes
+    for (int i = 0; i < entryCount; ++i) {
+        QQsbCollection::EntryDesc entryDesc = m_bakedEntries.at(i % m_bakedEntries.size());
+        entryDesc.materialKey += QByteArray::number(i);
+        collection->addEntry(entryDesc.generateSha(), entryDesc);
+    }
+}
+
+void tst_benchshadergeneration::bench_generate_data()
+{
+    addVariantRows();
+}
+
+void tst_benchshadergeneration::bench_generate()
+{
+    QFETCH(int, lightCount);
+    QFETCH(int, flags);
+
+    const MaterialSetup setup(m_keyProperties, lightCount, flags);
+    const auto &shaderCache = m_context->renderContext()->shaderCache();
+    qsizetype sourceSize = 0;
+    shaderCache->setDeferredBakeFunc([&sourceSize](const QByteArray &, const QSSGShaderFeatures &,
+                                                   const QByteArray &vertexCode, const QByteArray &fragmentCode,
+                                                   int, bool) {
+        sourceSize = vertexCode.size() + fragmentCode.size();
+    });
+
+    QBENCHMARK {
+        // Otherwise the generated variant comes back from the cache
+        shaderCache->releaseCachedResources();
+        generate(setup);
+    }
+
+    shaderCache->setDeferredBakeFunc(nullptr);
+    shaderCache->releaseCachedResources();
+    QVERIFY(sourceSize > 0);
+    qInfo("%lld bytes of source", qint64(sourceSize));
+}
+
+void tst_benchshadergeneration::bench_bake_data()
+{
+    addVariantRows();
+}
+
+void tst_benchshadergeneration::bench_bake()
+{
+    QFETCH(int, lightCount);
+    QFETCH(int, flags);
+
+    const MaterialSetup setup(m_keyProperties, lightCount, flags);
+    const ShaderSources sources = generateSources(setup);
+    QVERIFY(!sources.vertexCode.isEmpty());
+    QVERIFY(!sources.fragmentCode.isEmpty());
+
+    const auto &shaderCache = m_context->renderContext()->shaderCache();
+    QShader vertexShader;
+    QShader fragmentShader;
+    QString errorMessage;
+    QBENCHMARK {
+        const bool baked = shaderCache->bakeForRhi(sources.vertexCode,
+                                                   sources.fragmentCode,
+                                                   sources.viewCount,
+                                                   sources.perTargetCompilation,
+                                                   &vertexShader,
+                                                   &fragmentShader,
+                                                   &errorMessage);
+        QVERIFY2(baked, qPrintable(errorMessage));
+    }
+    qInfo("%lld bytes of shaders", qint64(vertexShader.serialized().size() + fragmentShader.serialized().size()));
+}
+
+void tst_benchshadergeneration::bench_shaderCacheLookup_data()
+{
+    QTest::addColumn<int>("lightCount");
+    QTest::addColumn<int>("flags");
+    QTest::addColumn<bool>("buildKeyString");
+
+    // The renderer builds the key string before each lookup, see
+    // QSSGRendererPrivate::generateRhiShaderPipelineImpl()
+    for (const MaterialVariant &variant : MaterialVariants) {
+        QTest::addRow("%s", variant.name) << variant.lightCount << variant.flags << false;
+        QTest::addRow("%s, key string", variant.name) << variant.lightCount << variant.flags << true;
+    }
+}
+
+void tst_benchshadergeneration::bench_shaderCacheLookup()
+{
+    QFETCH(int, lightCount);
+    QFETCH(int, flags);
+    QFETCH(bool, buildKeyString);
+
+    const MaterialSetup setup(m_keyProperties, lightCount, flags);
+    QVERIFY(generate(setup));
+
+    const auto &shaderCache = m_context->renderContext()->shaderCache();
+    QByteArray keyString = setup.keyString;
+    QBENCHMARK {
+        if (buildKeyString) {
+            keyString = ShaderKeyPrefix;
+            setup.key.toString(keyString, m_keyProperties);
+        }
+        QVERIFY(shaderCache->tryGetRhiShaderPipeline(keyString, setup.features));
+    }
+}
+
+void tst_benchshadergeneration::bench_pipelineLookup_data()
+{
+    QTest::addColumn<int>("pipelineCount");
+    QTest::addColumn<bool>("prebuiltKey");
+
+    // With a prebuilt key the serialized render pass and shader resource
+    // layouts are not collected on each lookup
+    for (int pipelineCount : { 16, 256, 4096 }) {
+        QTest::addRow("%d pipelines", pipelineCount) << pipelineCount << false;
+        QTest::addRow("%d pipelines, prebuilt key", pipelineCount) << pipelineCount << true;
+    }
+}
+
+void tst_benchshadergeneration::bench_pipelineLookup()
+{
+    QFETCH(int, pipelineCount);
+    QFETCH(bool, prebuiltKey);
+
+    auto *rhiCtxD = QSSGRhiContextPrivate::get(m_context->renderContext()->rhiContext().get());
+    rhiCtxD->releaseCachedResources();
+
+    // The states only differ in the depth bias, which is enough for each of
+    // them to get a pipeline of its own
+    QSSGRhiGraphicsPipelineState ps;
+    ps.flags |= QSSGRhiGraphicsPipelineState::Flag::DepthTestEnabled;
+    ps.flags |= QSSGRhiGraphicsPipelineState::Flag::DepthWriteEnabled;
+    QSSGRhiInputAssemblerStatePrivate::get(ps).topology = QRhiGraphicsPipeline::Triangles;
+    QSSGRhiGraphicsPipelineStatePrivate::setShaderPipeline(ps, m_basePipeline.get());
+    for (int i = 0; i < pipelineCount; ++i) {
+        ps.depthBias = i;
+        QVERIFY(rhiCtxD->pipeline(ps, m_rpDesc.get(), m_srb.get()));
+    }
+    QCOMPARE(rhiCtxD->m_pipelines.size(), qsizetype(pipelineCount));
+
+    ps.depthBias = pipelineCount / 2;
+    const QSSGGraphicsPipelineStateKey key = QSSGGraphicsPipelineStateKey::create(ps, m_rpDesc.get(), m_srb.get());
+    QBENCHMARK {
+        if (prebuiltKey)
+            QVERIFY(rhiCtxD->pipeline(key, m_rpDesc.get(), m_srb.get()));
+        else
+            QVERIFY(rhiCtxD->pipeline(ps, m_rpDesc.get(), m_srb.get()));
+    }
+    QCOMPARE(rhiCtxD->m_pipelines.size(), qsizetype(pipelineCount));
+
+    rhiCtxD->releaseCachedResources();
+}
+
+void tst_benchshadergeneration::bench_persistentCacheSave_data()
+{
+    addEntryCountRows();
+}
+
+void tst_benchshadergeneration::bench_persistentCacheSave()
+{
+    QFETCH(int, entryCount);
+
+    QQsbInMemoryCollection collection;
+    fillCollection(&collection, entryCount);
+    const QString path = m_dir.filePath(QStringLiteral("save%1.qsbc").arg(entryCount));
+
+    QBENCHMARK {
+        QVERIFY(collection.save(path));
+    }
+    qInfo("%lld KiB", QFileInfo(path).size() / 1024);
+}
+
+void tst_benchshadergeneration::bench_persistentCacheLoad_data()
+{
+    addEntryCountRows();
+}
+
+void tst_benchshadergeneration::bench_persistentCacheLoad()
+{
+    QFETCH(int, entryCount);
+
+    const QString path = m_dir.filePath(QStringLiteral("load%1.qsbc").arg(entryCount));
+    {
+        QQsbInMemoryCollection collection;
+        fillCollection(&collection, entryCount);
+        QVERIFY(collection.save(path));
+    }
+
+    QQsbInMemoryCollection collection;
+    QBENCHMARK {
+        collection.clear();
+        QVERIFY(collection.load(path));
+    }
+    QCOMPARE(collection.availableEntries().size(), qsizetype(entryCount));
+}
+
+void tst_benchshadergeneration::bench_persistentCacheLookup_data()
+{
+    addVariantRows();
+}
+
+void tst_benchshadergeneration::bench_persistentCacheLookup()
+{
+    QFETCH(int, lightCount);
+    QFETCH(int, flags);
+
+    // The variants were added to the persistent cache when baking them in
+    // initTestCase(). The lookup includes the hash of the key, as in
+    // QSSGRendererPrivate::generateRhiShaderPipelineImpl(), and creating the
+    // shader pipeline from the cached shaders.
+    const MaterialSetup setup(m_keyProperties, lightCount, flags);
+    const auto &shaderCache = m_context->renderContext()->shaderCache();
+    QBENCHMARK {
+        const QByteArray qsbcKey = QQsbCollection::EntryDesc::generateSha(setup.keyString,
+                                                                          QQsbCollection::toFeatureSet(setup.features));
+        QVERIFY(shaderCache->tryNewPipelineFromPersistentCache(qsbcKey, setup.keyString, setup.features));
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_benchshadergeneration)
+
+#include "tst_benchshadergeneration.moc"
@@ -0,0 +1,187 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderskeleton_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderjoint_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgskinningsystem_p.h>
+
+#include <memory>
+#include <vector>
+
+// Evaluates the bone palettes of a crowd of animated characters, each with a
+// skeleton of JointCount joints. The reference walks the joints recursively
+// and inverts each normal matrix with QMatrix4x4, the way the palettes used to
+// be computed.
+class tst_benchskinning : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_benchskinning() = default;
+    ~tst_benchskinning() = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void bench_reference();
+    void bench_flatten();
+    void bench_evaluate();
+    void bench_evaluate_parallel();
+    void bench_commit_unchanged();
+
+private:
+    static constexpr int SkeletonCount = 300;
+    static constexpr int JointCount = 64;
+
+    void animate(float time);
+    static void referenceCollect(QSSGRenderNode *node, QSSGRenderSkeleton *skeleton, const QList<QMatrix4x4> &poses);
+
+    std::vector<std::unique_ptr<QSSGRenderSkeleton>> m_skeletons;
+    std::vector<std::unique_ptr<QSSGRenderJoint>> m_joints;
+    QList<QMatrix4x4> m_inverseBindPoses;
+    QList<QSSGSkinningSystem::SkeletonPose> m_poses;
+};
+
+void tst_benchskinning::initTestCase()
+{
+    for (int i = 0; i < JointCount; ++i) {
+        QMatrix4x4 m;
+        m.translate(0.0f, -0.1f * i, 0.0f);
+        m_inverseBindPoses.append(m);
+    }
+
+    for (int s = 0; s < SkeletonCount; ++s) {
+        auto skeleton = std::make_unique<QSSGRenderSkeleton>();
+        skeleton->localTransform.translate(float(s % 20), 0.0f, float(s / 20));
+        skeleton->maxIndex = JointCount - 1;
+        // A spine with two limbs branching off every few joints
+        QList<QSSGRenderJoint *> joints;
+        for (int i = 0; i < JointCount; ++i) {
+            auto joint = std::make_unique<QSSGRenderJoint>();
+            joint->index = i;
+            joint->skeletonRoot = skeleton.get();
+            QSSGRenderNode *parent = i == 0 ? static_cast<QSSGRenderNode *>(skeleton.get())
+                                            : joints.at(i % 4 == 0 ? i - 4 : i - 1);
+            parent->addChild(*joint);
+            joints.append(joint.get());
+            m_joints.push_back(std::move(joint));
+        }
+        m_poses.append({ skeleton.get(), &m_inverseBindPoses });
+        m_skeletons.push_back(std::move(skeleton));
+    }
+
+    animate(0.0f);
+}
+
+void tst_benchskinning::cleanupTestCase()
+{
+    m_poses.clear();
+    m_joints.clear();
+    m_skeletons.clear();
+}
+
+void tst_benchskinning::animate(float time)
+{
+    for (int i = 0, count = int(m_joints.size()); i < count; ++i) {
+        const QQuaternion rotation = QQuaternion::fromEulerAngles(10.0f * qSin(time + i), 5.0f * qCos(time + i), 0.0f);
+        m_joints[i]->localTransform = QSSGRenderNode::calculateTransformMatrix(QVector3D(0.0f, 0.1f, 0.0f),
+                                                                               QSSGRenderNode::initScale,
+                                                                               QVector3D(),
+                                                                               rotation);
+        m_joints[i]->markDirty(QSSGRenderNode::DirtyFlag::TransformDirty);
+    }
+}
+
+void tst_benchskinning::referenceCollect(QSSGRenderNode *node, QSSGRenderSkeleton *skeleton, const QList<QMatrix4x4> &poses)
+{
+    if (node->type == QSSGRenderGraphObject::Type::Joint) {
+        QSSGRenderJoint *joint = static_cast<QSSGRenderJoint *>(node);
+        joint->calculateGlobalVariables();
+        QMatrix4x4 globalTrans = joint->globalTransform;
+        if (poses.size() > joint->index)
+            globalTrans *= poses[joint->index];
+        float *data = reinterpret_cast<float *>(skeleton->boneData.data());
+        memcpy(data + 16 * joint->index * 2, globalTrans.constData(), sizeof(float) * 16);
+        memcpy(data + 16 * (joint->index * 2 + 1), QMatrix4x4(globalTrans.normalMatrix()).constData(), sizeof(float) * 11);
+    }
+    for (auto &child : node->children)
+        referenceCollect(&child, skeleton, poses);
+}
+
+void tst_benchskinning::bench_reference()
+{
+    for (auto &skeleton : m_skeletons)
+        skeleton->boneData.resize(JointCount * 2 * 16 * sizeof(float));
+
+    float time = 0.0f;
+    QBENCHMARK {
+        // Marking dirty is part of the frame in both cases, but only the
+        // reference depends on it
+        animate(time += 0.016f);
+        for (auto &skeleton : m_skeletons) {
+            skeleton->calculateGlobalVariables();
+            for (auto &child : skeleton->children)
+                referenceCollect(&child, skeleton.get(), m_inverseBindPoses);
+        }
+    }
+}
+
+void tst_benchskinning::bench_flatten()
+{
+    QBENCHMARK {
+        for (auto &skeleton : m_skeletons)
+            QSSGSkinningSystem::flatten(*skeleton);
+    }
+    QCOMPARE(m_skeletons.front()->joints.size(), qsizetype(JointCount));
+}
+
+void tst_benchskinning::bench_evaluate()
+{
+    for (auto &skeleton : m_skeletons)
+        QSSGSkinningSystem::prepare(*skeleton);
+
+    float time = 0.0f;
+    QBENCHMARK {
+        animate(time += 0.016f);
+        for (auto &skeleton : m_skeletons)
+            QSSGSkinningSystem::evaluatePalette(*skeleton, m_inverseBindPoses);
+    }
+}
+
+void tst_benchskinning::bench_evaluate_parallel()
+{
+    for (auto &skeleton : m_skeletons)
+        QSSGSkinningSystem::prepare(*skeleton);
+
+    float time = 0.0f;
+    QBENCHMARK {
+        animate(time += 0.016f);
+        QSSGSkinningSystem::evaluatePalettes(m_poses);
+    }
+}
+
+void tst_benchskinning::bench_commit_unchanged()
+{
+    for (auto &skeleton : m_skeletons) {
+        QSSGSkinningSystem::prepare(*skeleton);
+        QSSGSkinningSystem::evaluatePalette(*skeleton, m_inverseBindPoses);
+        QSSGSkinningSystem::commitPalette(*skeleton);
+    }
+
+    // The pose does not change, so nothing is handed to the texture data
+    int changed = 0;
+    QBENCHMARK {
+        for (auto &skeleton : m_skeletons)
+            QSSGSkinningSystem::prepare(*skeleton);
+        QSSGSkinningSystem::evaluatePalettes(m_poses);
+        for (auto &skeleton : m_skeletons)
+            changed += QSSGSkinningSystem::commitPalette(*skeleton);
+    }
+    QCOMPARE(changed, 0);
+}
+
+QTEST_MAIN(tst_benchskinning)
+
+#include "tst_benchskinning.moc"
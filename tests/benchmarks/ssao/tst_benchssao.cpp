@@ -0,0 +1,293 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtCore/QElapsedTimer>
+#include <QtQml/QQmlComponent>
+#include <QtQml/QQmlEngine>
+#include <QtQuick/QQuickGraphicsConfiguration>
+#include <QtQuick/QQuickItem>
+#include <QtQuick/QQuickRenderControl>
+#include <QtQuick/QQuickRenderTarget>
+#include <QtQuick/QQuickWindow>
+
+#include <rhi/qrhi.h>
+
+#if QT_CONFIG(vulkan)
+#include <QtGui/QVulkanInstance>
+#endif
+
+#include <cmath>
+#include <memory>
+
+// Renders a scene with a lot of contact occlusion offscreen with the
+// ambient occlusion at full, half and quarter resolution, with and without
+// temporal accumulation, and reports the GPU time of the frames and the PSNR
+// of the final image against the full resolution one. The cost of the AO
+// passes is the difference to the frames rendered without AO.
+//
+// Runs headless, for example on lavapipe with
+//   QT_QPA_PLATFORM=offscreen QSG_RHI_BACKEND=vulkan
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json
+//
+// tst_width, tst_height and tst_frames change the size and the number of
+// measured frames. GPU times need timestamp support in the backend, the CPU
+// time of the frames, which includes waiting for the GPU, is always reported.
+
+static const char SceneQml[] = R"(
+import QtQuick
+import QtQuick3D
+
+Item {
+    id: root
+    property bool aoEnabled: true
+
+    View3D {
+        anchors.fill: parent
+        environment: SceneEnvironment {
+            backgroundMode: SceneEnvironment.Color
+            clearColor: "white"
+            aoEnabled: root.aoEnabled
+            aoStrength: 100
+            aoDistance: 20
+            aoSoftness: 50
+            aoSampleRate: 3
+            aoDither: true
+        }
+        PerspectiveCamera {
+            position: Qt.vector3d(0, 250, 500)
+            eulerRotation.x: -25
+            clipNear: 10
+            clipFar: 2000
+        }
+        DirectionalLight {
+            eulerRotation.x: -45
+            eulerRotation.y: 30
+        }
+        Model {
+            source: "#Rectangle"
+            scale: Qt.vector3d(12, 12, 1)
+            eulerRotation.x: -90
+            materials: PrincipledMaterial { baseColor: "#d0d0d0" }
+        }
+        Repeater3D {
+            model: 100
+            Model {
+                source: index % 2 ? "#Cube" : "#Sphere"
+                position: Qt.vector3d((index % 10) * 70 - 315, 25 + (index % 3) * 10, Math.floor(index / 10) * 70 - 315)
+                eulerRotation.y: index * 17
+                scale: Qt.vector3d(0.5 + (index % 4) * 0.1, 0.5 + (index % 5) * 0.2, 0.5)
+                materials: PrincipledMaterial { baseColor: "#f0f0f0" }
+            }
+        }
+    }
+}
+)";
+
+class tst_benchssao : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_benchssao() = default;
+    ~tst_benchssao() = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void bench_ssao_data();
+    void bench_ssao();
+
+private:
+    struct FrameTimes {
+        double gpuMs = 0.0;
+        double cpuMs = 0.0;
+    };
+
+    bool render(bool aoEnabled, FrameTimes *times, QImage *image);
+
+    QSize m_size { 1920, 1080 };
+    int m_warmupFrames = 16;
+    int m_frames = 32;
+    FrameTimes m_baseline;
+    QImage m_reference;
+#if QT_CONFIG(vulkan)
+    QVulkanInstance m_vulkanInstance;
+#endif
+};
+
+static double psnr(const QImage &image, const QImage &reference)
+{
+    if (image.size() != reference.size())
+        return 0.0;
+    double squaredError = 0.0;
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar *p = image.constScanLine(y);
+        const uchar *r = reference.constScanLine(y);
+        for (int x = 0; x < image.width(); ++x) {
+            for (int c = 0; c < 3; ++c) {
+                const double d = double(p[x * 4 + c]) - double(r[x * 4 + c]);
+                squaredError += d * d;
+            }
+        }
+    }
+    if (squaredError == 0.0)
+        return qInf();
+    const double mse = squaredError / (3.0 * image.width() * image.height());
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+void tst_benchssao::initTestCase()
+{
+    bool ok = false;
+    const int width = qEnvironmentVariableIntValue("tst_width", &ok);
+    if (ok && width > 0)
+        m_size.setWidth(width);
+    const int height = qEnvironmentVariableIntValue("tst_height", &ok);
+    if (ok && height > 0)
+        m_size.setHeight(height);
+    const int frames = qEnvironmentVariableIntValue("tst_frames", &ok);
+    if (ok && frames > 0)
+        m_frames = frames;
+
+#if QT_CONFIG(vulkan)
+    if (QQuickWindow::graphicsApi() == QSGRendererInterface::Vulkan)
+        m_vulkanInstance.create(); // may fail, which is fine when Vulkan is not used in the end
+#endif
+}
+
+bool tst_benchssao::render(bool aoEnabled, FrameTimes *times, QImage *image)
+{
+    QQuickRenderControl renderControl;
+    QQuickWindow window(&renderControl);
+#if QT_CONFIG(vulkan)
+    if (m_vulkanInstance.isValid())
+        window.setVulkanInstance(&m_vulkanInstance);
+#endif
+    QQuickGraphicsConfiguration config;
+    config.setTimestamps(true);
+    window.setGraphicsConfiguration(config);
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData(QByteArray(SceneQml), QUrl());
+    std::unique_ptr<QObject> rootObject(component.create());
+    auto *rootItem = qobject_cast<QQuickItem *>(rootObject.get());
+    if (!rootItem) {
+        qWarning() << component.errors();
+        return false;
+    }
+    rootItem->setProperty("aoEnabled", aoEnabled);
+    rootItem->setSize(m_size);
+    window.contentItem()->setSize(m_size);
+    window.setGeometry(0, 0, m_size.width(), m_size.height());
+    rootItem->setParentItem(window.contentItem());
+
+    if (!renderControl.initialize()) {
+        qWarning("Failed to initialize the render control");
+        return false;
+    }
+    QRhi *rhi = renderControl.rhi();
+
+    std::unique_ptr<QRhiTexture> texture(rhi->newTexture(QRhiTexture::RGBA8, m_size, 1,
+                                                         QRhiTexture::RenderTarget | QRhiTexture::UsedAsTransferSource));
+    std::unique_ptr<QRhiRenderBuffer> depthStencil(rhi->newRenderBuffer(QRhiRenderBuffer::DepthStencil, m_size, 1));
+    if (!texture->create() || !depthStencil->create())
+        return false;
+    QRhiTextureRenderTargetDescription rtDesc(QRhiColorAttachment(texture.get()));
+    rtDesc.setDepthStencilBuffer(depthStencil.get());
+    std::unique_ptr<QRhiTextureRenderTarget> rt(rhi->newTextureRenderTarget(rtDesc));
+    std::unique_ptr<QRhiRenderPassDescriptor> rpDesc(rt->newCompatibleRenderPassDescriptor());
+    rt->setRenderPassDescriptor(rpDesc.get());
+    if (!rt->create())
+        return false;
+    window.setRenderTarget(QQuickRenderTarget::fromRhiRenderTarget(rt.get()));
+
+    QRhiReadbackResult readResult;
+    double gpuTime = 0.0;
+    qint64 cpuTime = 0;
+    const int frameCount = m_warmupFrames + m_frames;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        const bool measured = frame >= m_warmupFrames;
+        QElapsedTimer timer;
+        timer.start();
+        renderControl.polishItems();
+        renderControl.beginFrame();
+        renderControl.sync();
+        renderControl.render();
+        QRhiCommandBuffer *cb = renderControl.commandBuffer();
+        if (frame == frameCount - 1) {
+            QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+            rub->readBackTexture(texture.get(), &readResult);
+            cb->resourceUpdate(rub);
+        }
+        renderControl.endFrame();
+        if (measured) {
+            // Offscreen frames wait for the GPU in endFrame(), so the
+            // timestamps are the ones of this frame.
+            cpuTime += timer.nsecsElapsed();
+            gpuTime += cb->lastCompletedGpuTime();
+        }
+    }
+
+    times->gpuMs = gpuTime * 1000.0 / m_frames;
+    times->cpuMs = double(cpuTime) / 1000000.0 / m_frames;
+    const QImage wrapper(reinterpret_cast<const uchar *>(readResult.data.constData()),
+                         readResult.pixelSize.width(), readResult.pixelSize.height(), QImage::Format_RGBA8888);
+    *image = rhi->isYUpInFramebuffer() ? wrapper.mirrored() : wrapper.copy();
+    return true;
+}
+
+void tst_benchssao::bench_ssao_data()
+{
+    QTest::addColumn<bool>("aoEnabled");
+    QTest::addColumn<int>("divisor");
+    QTest::addColumn<bool>("temporal");
+
+    // The first two rows are the baseline and the reference of the others
+    QTest::newRow("no ao") << false << 1 << false;
+    QTest::newRow("full") << true << 1 << false;
+    QTest::newRow("full temporal") << true << 1 << true;
+    QTest::newRow("half") << true << 2 << false;
+    QTest::newRow("half temporal") << true << 2 << true;
+    QTest::newRow("quarter") << true << 4 << false;
+    QTest::newRow("quarter temporal") << true << 4 << true;
+}
+
+void tst_benchssao::bench_ssao()
+{
+    QFETCH(bool, aoEnabled);
+    QFETCH(int, divisor);
+    QFETCH(bool, temporal);
+
+    // Read when the layer is created
+    qputenv("QT_QUICK3D_SSAO_RESOLUTION_DIVISOR", QByteArray::number(divisor));
+    qputenv("QT_QUICK3D_SSAO_TEMPORAL", temporal ? "1" : "0");
+
+    FrameTimes times;
+    QImage image;
+    const bool rendered = render(aoEnabled, &times, &image);
+    qunsetenv("QT_QUICK3D_SSAO_RESOLUTION_DIVISOR");
+    qunsetenv("QT_QUICK3D_SSAO_TEMPORAL");
+    QVERIFY(rendered);
+    QCOMPARE(image.size(), m_size);
+
+    if (!aoEnabled) {
+        m_baseline = times;
+        qInfo("%dx%d, %.3f ms GPU, %.3f ms CPU per frame",
+              m_size.width(), m_size.height(), times.gpuMs, times.cpuMs);
+    } else {
+        if (m_reference.isNull())
+            m_reference = image;
+        qInfo("%.3f ms GPU (AO %.3f ms), %.3f ms CPU (AO %.3f ms) per frame, PSNR %.2f dB",
+              times.gpuMs, times.gpuMs - m_baseline.gpuMs,
+              times.cpuMs, times.cpuMs - m_baseline.cpuMs,
+              psnr(image, m_reference));
+    }
+
+    QTest::setBenchmarkResult(times.gpuMs > 0.0 ? times.gpuMs : times.cpuMs, QTest::WalltimeMilliseconds);
+}
+
+QTEST_MAIN(tst_benchssao)
+
+#include "tst_benchssao.moc"
@@ -0,0 +1,120 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <ssg/qssgrendercontextcore.h>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendertexturedata_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercodegenerator_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicustommaterialsystem_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
+
+// Compares uploading all of the texture data every frame with uploading only
+// the region that changed, the way a video-like or heat map texture would be
+// driven from C++.
+class tst_texturedata : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_texturedata() = default;
+    ~tst_texturedata() = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void bench_upload_data();
+    void bench_upload();
+
+private:
+    QRhi *rhi = nullptr;
+    std::shared_ptr<QSSGRenderContextInterface> renderContext;
+};
+
+void tst_texturedata::initTestCase()
+{
+    rhi = QRhi::create(QRhi::Null, nullptr);
+    QRhiCommandBuffer *cb;
+    rhi->beginOffscreenFrame(&cb);
+
+    std::unique_ptr<QSSGRhiContext> rhiContext = std::make_unique<QSSGRhiContext>(rhi);
+    QSSGRhiContextPrivate::get(rhiContext.get())->setCommandBuffer(cb);
+
+    renderContext = std::make_shared<QSSGRenderContextInterface>(std::make_unique<QSSGBufferManager>(),
+                                                                 std::make_unique<QSSGRenderer>(),
+                                                                 std::make_shared<QSSGShaderLibraryManager>(),
+                                                                 std::make_unique<QSSGShaderCache>(*rhiContext),
+                                                                 std::make_unique<QSSGCustomMaterialSystem>(),
+                                                                 std::make_unique<QSSGProgramGenerator>(),
+                                                                 std::move(rhiContext));
+}
+
+void tst_texturedata::bench_upload_data()
+{
+    QTest::addColumn<bool>("partial");
+    QTest::addColumn<int>("textureSize");
+    QTest::addColumn<int>("regionSize");
+    QTest::addColumn<bool>("mipmaps");
+
+    QTest::newRow("full 1024, 128 changed") << false << 1024 << 128 << false;
+    QTest::newRow("partial 1024, 128 changed") << true << 1024 << 128 << false;
+    QTest::newRow("full 2048, 64 changed") << false << 2048 << 64 << false;
+    QTest::newRow("partial 2048, 64 changed") << true << 2048 << 64 << false;
+    QTest::newRow("full 1024, 128 changed, mipmaps") << false << 1024 << 128 << true;
+    QTest::newRow("partial 1024, 128 changed, mipmaps") << true << 1024 << 128 << true;
+}
+
+void tst_texturedata::bench_upload()
+{
+    QFETCH(bool, partial);
+    QFETCH(int, textureSize);
+    QFETCH(int, regionSize);
+    QFETCH(bool, mipmaps);
+
+    const auto &bufferManager = renderContext->bufferManager();
+
+    const QSize size(textureSize, textureSize);
+    QByteArray pixels(textureSize * textureSize * 4, 0);
+
+    QSSGRenderTextureData textureData;
+    textureData.setSize(size);
+    textureData.setFormat(QSSGRenderTextureFormat::RGBA8);
+    textureData.setTextureData(pixels);
+
+    QSSGRenderImage image;
+    image.m_rawTextureData = &textureData;
+    image.m_generateMipmaps = mipmaps;
+    QVERIFY(bufferManager->loadRenderImage(&image).m_texture);
+
+    const quint64 uploadedSizeBefore = bufferManager->textureDataUploadStats().uploadedSize;
+    quint64 frames = 0;
+
+    QBENCHMARK {
+        // Move the changed region around, like a cursor over a heat map
+        const int cells = textureSize / regionSize;
+        const QRect rect(QPoint(int(frames % cells) * regionSize, int((frames / cells) % cells) * regionSize),
+                         QSize(regionSize, regionSize));
+        const char value = char(frames);
+        for (int y = rect.top(); y <= rect.bottom(); ++y)
+            memset(pixels.data() + (y * textureSize + rect.x()) * 4, value, regionSize * 4);
+
+        if (partial)
+            textureData.updateTextureData(rect, 0, pixels);
+        else
+            textureData.setTextureData(pixels);
+        bufferManager->loadRenderImage(&image);
+        ++frames;
+    }
+
+    const quint64 uploaded = bufferManager->textureDataUploadStats().uploadedSize - uploadedSizeBefore;
+    qInfo("%llu bytes uploaded per update", frames ? uploaded / frames : 0);
+
+    bufferManager->releaseTextureData(&textureData);
+}
+
+QTEST_APPLESS_MAIN(tst_texturedata)
+
+#include "tst_texturedata.moc"
@@ -0,0 +1,74 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QUICK3D_TEST_NULLRENDERCONTEXT_H
+#define QUICK3D_TEST_NULLRENDERCONTEXT_H
+
+#include <QtGui/rhi/qrhi.h>
+
+#include <ssg/qssgrendercontextcore.h>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercodegenerator_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicustommaterialsystem_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+
+#include <memory>
+
+// A render context on the Null backend, for the tests and benchmarks that use
+// the renderer without a window. A frame is recorded for as long as it lives,
+// like between QQuickWindow's beginFrame and endFrame.
+class NullRenderContext
+{
+public:
+    NullRenderContext()
+        : m_rhi(QRhi::create(QRhi::Null, nullptr))
+    {
+        if (!m_rhi)
+            return;
+        QRhiCommandBuffer *cb;
+        m_rhi->beginOffscreenFrame(&cb);
+
+        std::unique_ptr<QSSGRhiContext> rhiContext = std::make_unique<QSSGRhiContext>(m_rhi.get());
+        QSSGRhiContextPrivate::get(rhiContext.get())->setCommandBuffer(cb);
+
+        m_renderContext = std::make_shared<QSSGRenderContextInterface>(std::make_unique<QSSGBufferManager>(),
+                                                                       std::make_unique<QSSGRenderer>(),
+                                                                       std::make_shared<QSSGShaderLibraryManager>(),
+                                                                       std::make_unique<QSSGShaderCache>(*rhiContext),
+                                                                       std::make_unique<QSSGCustomMaterialSystem>(),
+                                                                       std::make_unique<QSSGProgramGenerator>(),
+                                                                       std::move(rhiContext));
+    }
+
+    ~NullRenderContext()
+    {
+        m_renderContext.reset();
+        if (m_rhi)
+            m_rhi->endOffscreenFrame();
+    }
+
+    Q_DISABLE_COPY_MOVE(NullRenderContext)
+
+    bool isValid() const { return m_renderContext != nullptr; }
+    QRhi *rhi() const { return m_rhi.get(); }
+    const std::shared_ptr<QSSGRenderContextInterface> &renderContext() const { return m_renderContext; }
+
+    // Releases the resources destroyed in the frame and completes the
+    // readbacks, as a window would
+    void nextFrame()
+    {
+        m_rhi->endOffscreenFrame();
+        QRhiCommandBuffer *cb;
+        m_rhi->beginOffscreenFrame(&cb);
+        QSSGRhiContextPrivate::get(m_renderContext->rhiContext().get())->setCommandBuffer(cb);
+    }
+
+private:
+    std::unique_ptr<QRhi> m_rhi;
+    std::shared_ptr<QSSGRenderContextInterface> m_renderContext;
+};
+
+#endif // QUICK3D_TEST_NULLRENDERCONTEXT_H
@@ -8,10 +8,58 @@
 
 #include <QtQuick3DUtils/private/qssgmesh_p.h>
 
+#include <algorithm>
+
 using Qt::hex;
 
 using namespace QSSGMesh;
 
+// Index values of a range of the index buffer, relative to the lowest vertex
+// they use, so the statistics do not depend on the other subsets.
+static QVector<quint32> rangeIndices(const Mesh::IndexBuffer &ib, quint32 offset, quint32 count, quint32 *vertexCount)
+{
+    QVector<quint32> indices;
+    *vertexCount = 0;
+    const quint32 indexSize = MeshInternal::byteSizeForComponentType(ib.componentType);
+    if (indexSize != 2 && indexSize != 4)
+        return indices;
+    if (quint64(offset + quint64(count)) * indexSize > quint64(ib.data.size()))
+        return indices;
+
+    indices.reserve(count);
+    for (quint32 i = offset; i < offset + count; ++i) {
+        if (indexSize == 2)
+            indices.append(reinterpret_cast<const quint16 *>(ib.data.constData())[i]);
+        else
+            indices.append(reinterpret_cast<const quint32 *>(ib.data.constData())[i]);
+    }
+    if (indices.isEmpty())
+        return indices;
+
+    const auto [minIndex, maxIndex] = std::minmax_element(indices.cbegin(), indices.cend());
+    const quint32 firstVertex = *minIndex;
+    *vertexCount = *maxIndex - firstVertex + 1;
+    for (quint32 &index : indices)
+        index -= firstVertex;
+    return indices;
+}
+
+// ACMR is the number of vertex shader invocations per triangle (0.5 to 3.0)
+// and ATVR per vertex (1.0 at best), with a 16 entry FIFO cache. Overfetch is
+// the number of bytes fetched per byte of vertex data (1.0 at best).
+static QString efficiencyString(const Mesh::IndexBuffer &ib, quint32 stride, quint32 offset, quint32 count)
+{
+    quint32 vertexCount = 0;
+    const QVector<quint32> indices = rangeIndices(ib, offset, count, &vertexCount);
+    if (indices.isEmpty() || !stride)
+        return QStringLiteral("n/a");
+    const VertexCacheStatistics cache = analyzeVertexCache(indices.constData(), indices.size(), vertexCount);
+    const float overfetch = analyzeVertexFetch(indices.constData(), indices.size(), vertexCount, stride);
+    return QStringLiteral("ACMR %1 ATVR %2 overfetch %3").arg(cache.acmr, 0, 'f', 3)
+                                                         .arg(cache.atvr, 0, 'f', 3)
+                                                         .arg(overfetch, 0, 'f', 3);
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -84,6 +132,7 @@ int main(int argc, char *argv[])
                     qDebug() << "\t\t\tstart offset:" << entry.offset;
                 }
                 qDebug() << "\t\tstride:" << vb.stride;
+                qDebug() << "\t\tvertex count:" << (vb.stride ? vb.data.size() / vb.stride : 0);
                 qDebug() << "\t\tdata size in bytes:" << vb.data.size();
 
                 // Target Buffer
@@ -109,6 +158,8 @@ int main(int argc, char *argv[])
                 qDebug() << "\t\tcomponentType:" << QSSGBaseTypeHelpers::toString(QSSGRenderComponentType(ib.componentType));
                 qDebug() << "\t\tdata size in bytes:" << ib.data.size();
 
+                qDebug() << "\t\ttotal size in bytes:" << vb.data.size() + ib.data.size() + mesh.targetBuffer().data.size();
+
                 // Subsets
                 const QVector<Mesh::Subset> subsets = mesh.subsets();
                 qDebug() << "\t\t -- Subsets --";
@@ -126,12 +177,14 @@ int main(int argc, char *argv[])
                                 subset.bounds.max.y() << "," <<
                                 subset.bounds.max.z() << ")";
                     qDebug() << "\t\tname:" << subset.name;
+                    qDebug() << "\t\tvertex efficiency:" << qPrintable(efficiencyString(ib, vb.stride, subset.offset, subset.count));
                     if (header.hasLightmapSizeHint())
                         qDebug() << "\t\tlightmap size hint:" << subset.lightmapSizeHint;
                     if (header.hasLodDataHint()) {
                         qDebug() << "\t\tlods: ";
                         for (auto lod : subset.lods) {
-                            qDebug() << "\t\t\tcount: " << lod.count << "offset: " << lod.offset << "distance: " << lod.distance;
+                            qDebug() << "\t\t\tcount: " << lod.count << "offset: " << lod.offset << "distance: " << lod.distance
+                                     << "efficiency: " << qPrintable(efficiencyString(ib, vb.stride, lod.offset, lod.count));
                         }
                     }
                 }
@@ -4,6 +4,9 @@
 #include "genshaders.h"
 
 #include <QtCore/qdir.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qthreadpool.h>
 
 #include <QtQml/qqmllist.h>
 
@@ -35,6 +38,77 @@ static inline void qDryRunPrintQsbcAdd(const QByteArray &id)
     printf("Shader pipeline generated for (dry run):\n %s\n\n", qPrintable(id));
 }
 
+// Version of the file with the source hashes next to the collection, bump when
+// the baker setup in initBaker() changes so that all entries are baked again.
+static constexpr quint32 SourceHashesVersion = 1;
+
+static QString sourceHashesFile(const QString &collectionFile)
+{
+    return collectionFile + QLatin1String(".sources");
+}
+
+static QHash<QByteArray, QByteArray> readSourceHashes(const QString &fileName)
+{
+    QHash<QByteArray, QByteArray> hashes;
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return hashes;
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_6_0);
+    quint32 version = 0;
+    ds >> version;
+    if (version == SourceHashesVersion)
+        ds >> hashes;
+    if (ds.status() != QDataStream::Ok)
+        hashes.clear();
+    return hashes;
+}
+
+static bool writeSourceHashes(const QString &fileName, const QMap<QByteArray, QByteArray> &hashes)
+{
+    QSaveFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_6_0);
+    ds << SourceHashesVersion << hashes;
+    return f.commit();
+}
+
+// A variant is only reused when everything that goes into the baker is the
+// same, the generated sources as well as the baker itself.
+static QByteArray sourceHash(const QByteArray &vertexCode,
+                             const QByteArray &fragmentCode,
+                             int viewCount,
+                             bool perTargetCompilation)
+{
+    QCryptographicHash h(QCryptographicHash::Algorithm::Sha1);
+    h.addData(QByteArrayLiteral(QT_VERSION_STR));
+    h.addData(QByteArray::number(viewCount));
+    h.addData(perTargetCompilation ? QByteArrayLiteral("1") : QByteArrayLiteral("0"));
+    h.addData(QByteArray::number(qEnvironmentVariableIntValue("QT_QUICK3D_MEDIUM_PRECISION")));
+    h.addData(QByteArray::number(vertexCode.size()));
+    h.addData(vertexCode);
+    h.addData(fragmentCode);
+    return h.result().toHex();
+}
+
+struct ShaderVariant
+{
+    QByteArray materialKey;
+    QQsbCollection::FeatureSet featureSet;
+    QByteArray vertexCode;
+    QByteArray fragmentCode;
+    int viewCount = 1;
+    bool perTargetCompilation = false;
+    QByteArray sourceHash;
+    QShader vertexShader;
+    QShader fragmentShader;
+    QString errorMessage;
+    bool reused = false;
+    bool valid = false;
+};
+
 static void initBaker(QShaderBaker *baker, QRhi *rhi)
 {
     Q_UNUSED(rhi); // that's a Null-backed rhi here anyways
@@ -80,7 +154,8 @@ bool GenShaders::process(const MaterialParser::SceneData &sceneData,
                          QVector<QString> &qsbcFiles,
                          const QDir &outDir,
                          bool generateMultipleLights,
-                         bool dryRun)
+                         bool dryRun,
+                         int jobCount)
 {
     Q_UNUSED(generateMultipleLights);
 
@@ -192,10 +267,60 @@ bool GenShaders::process(const MaterialParser::SceneData &sceneData,
     QQuick3DRenderLayerHelpers::updateLayerNodeHelper(*view3D, layer, aaIsDirty, temporalIsDirty, ssaaMultiplier);
 
     const QString outCollectionFile = outputFolder + QString::fromLatin1(QSSGShaderCache::shaderCollectionFile());
+
+    // The previous output is the cache, entries that would be baked from the
+    // very same sources are taken over as is.
+    QQsbInMemoryCollection previousQsbc;
+    QHash<QByteArray, QByteArray> previousSourceHashes;
+    if (!dryRun && QFileInfo::exists(outCollectionFile)) {
+        previousSourceHashes = readSourceHashes(sourceHashesFile(outCollectionFile));
+        if (previousSourceHashes.isEmpty() || !previousQsbc.load(outCollectionFile))
+            previousSourceHashes.clear();
+    }
+
     QQsbIODeviceCollection qsbc(outCollectionFile);
     if (!dryRun && !qsbc.map(QQsbIODeviceCollection::Write))
         return false;
 
+    QElapsedTimer timer;
+    timer.start();
+
+    // Generating the shaders is serial, baking them is not: the shader cache
+    // only hands out the final sources here, which are baked further down.
+    // Keyed and so written in the order of the collection keys, which makes
+    // the output independent of the order of the input files.
+    QMap<QByteArray, ShaderVariant> variants;
+    ShaderVariant pendingVariant;
+    bool hasPendingVariant = false;
+    shaderCache->setDeferredBakeFunc([&](const QByteArray &, const QSSGShaderFeatures &,
+                                         const QByteArray &vertexCode, const QByteArray &fragmentCode,
+                                         int viewCount, bool perTargetCompilation) {
+        pendingVariant.vertexCode = vertexCode;
+        pendingVariant.fragmentCode = fragmentCode;
+        pendingVariant.viewCount = viewCount;
+        pendingVariant.perTargetCompilation = perTargetCompilation;
+        hasPendingVariant = true;
+    });
+
+    // Variants that were already generated come back from the shader cache
+    // without going through the callback, so there is nothing to add then.
+    const auto addVariant = [&](const QByteArray &materialKey, const QSSGShaderFeatures &features) {
+        if (!hasPendingVariant)
+            return;
+        hasPendingVariant = false;
+        const auto qsbcFeatureList = QQsbCollection::toFeatureSet(features);
+        const QByteArray qsbcKey = QQsbCollection::EntryDesc::generateSha(materialKey, qsbcFeatureList);
+        if (variants.contains(qsbcKey))
+            return;
+        if (dryRun)
+            qDryRunPrintQsbcAdd(materialKey);
+        ShaderVariant &variant = variants[qsbcKey];
+        variant = std::move(pendingVariant);
+        variant.materialKey = materialKey;
+        variant.featureSet = qsbcFeatureList;
+        pendingVariant = {};
+    };
+
     QByteArray shaderString;
     const auto generateShaderForModel = [&](QSSGRenderModel &model) {
         layerData.resetForFrame();
@@ -216,20 +341,11 @@ bool GenShaders::process(const MaterialParser::SceneData &sceneData,
             renderable = transparentObjects[0].obj;
 
         auto generateShader = [&](const QSSGShaderFeatures &features) {
+            hasPendingVariant = false;
             if ((renderable->type == QSSGSubsetRenderable::Type::DefaultMaterialMeshSubset)) {
                 auto shaderPipeline = QSSGRendererPrivate::generateRhiShaderPipelineImpl(*static_cast<QSSGSubsetRenderable *>(renderable), *shaderLibraryManager, *shaderCache, *shaderProgramGenerator, propertyTable, features, shaderString);
-                if (shaderPipeline != nullptr) {
-                    const auto qsbcFeatureList = QQsbCollection::toFeatureSet(features);
-                    const QByteArray qsbcKey = QQsbCollection::EntryDesc::generateSha(shaderString, qsbcFeatureList);
-                    const auto vertexStage = shaderPipeline->vertexStage();
-                    const auto fragmentStage = shaderPipeline->fragmentStage();
-                    if (vertexStage && fragmentStage) {
-                        if (dryRun)
-                            qDryRunPrintQsbcAdd(shaderString);
-                        else
-                            qsbc.addEntry(qsbcKey, { shaderString, qsbcFeatureList, vertexStage->shader(), fragmentStage->shader() });
-                    }
-                }
+                if (shaderPipeline != nullptr)
+                    addVariant(shaderString, features);
             } else if ((renderable->type == QSSGSubsetRenderable::Type::CustomMaterialMeshSubset)) {
                 Q_ASSERT(!layerData.renderedCameras.isEmpty());
                 QSSGSubsetRenderable &cmr(static_cast<QSSGSubsetRenderable &>(*renderable));
@@ -244,16 +360,7 @@ bool GenShaders::process(const MaterialParser::SceneData &sceneData,
 
                 if (shaderPipeline) {
                     shaderString = material.m_shaderPathKey[QSSGRenderCustomMaterial::RegularShaderPathKeyIndex];
-                    const auto qsbcFeatureList = QQsbCollection::toFeatureSet(features);
-                    const QByteArray qsbcKey = QQsbCollection::EntryDesc::generateSha(shaderString, qsbcFeatureList);
-                    const auto vertexStage = shaderPipeline->vertexStage();
-                    const auto fragmentStage = shaderPipeline->fragmentStage();
-                    if (vertexStage && fragmentStage) {
-                        if (dryRun)
-                            qDryRunPrintQsbcAdd(shaderString);
-                        else
-                            qsbc.addEntry(qsbcKey, { shaderString, qsbcFeatureList, vertexStage->shader(), fragmentStage->shader() });
-                    }
+                    addVariant(shaderString, features);
                 }
             }
         };
@@ -309,6 +416,7 @@ bool GenShaders::process(const MaterialParser::SceneData &sceneData,
             if (command->m_type == CommandType::BindShader) {
                 auto bindShaderCommand = static_cast<const QSSGBindShader &>(*command);
                 for (const auto isYUpInFramebuffer : { true, false }) { // Generate effects for both up-directions.
+                    hasPendingVariant = false;
                     const auto shaderPipeline = QSSGRhiEffectSystem::buildShaderForEffect(bindShaderCommand,
                                                                                           *shaderProgramGenerator,
                                                                                           *shaderLibraryManager,
@@ -318,16 +426,7 @@ bool GenShaders::process(const MaterialParser::SceneData &sceneData,
                     if (shaderPipeline) {
                         const auto &key = bindShaderCommand.m_shaderPathKey;
                         const QSSGShaderFeatures features = shaderLibraryManager->getShaderMetaData(key, QSSGShaderCache::ShaderType::Fragment).features;
-                        const auto qsbcFeatureList = QQsbCollection::toFeatureSet(features);
-                        QByteArray qsbcKey = QQsbCollection::EntryDesc::generateSha(key, qsbcFeatureList);
-                        const auto vertexStage = shaderPipeline->vertexStage();
-                        const auto fragmentStage = shaderPipeline->fragmentStage();
-                        if (vertexStage && fragmentStage) {
-                            if (dryRun)
-                                qDryRunPrintQsbcAdd(key);
-                            else
-                                qsbc.addEntry(qsbcKey, { key, qsbcFeatureList, vertexStage->shader(), fragmentStage->shader() });
-                        }
+                        addVariant(key, features);
                     }
                 }
             }
@@ -349,6 +448,79 @@ bool GenShaders::process(const MaterialParser::SceneData &sceneData,
     for (const auto &effect : std::as_const(sceneData.effects))
         generateEffectShader(*effect);
 
+    shaderCache->setDeferredBakeFunc(nullptr);
+    const qint64 generateTime = timer.restart();
+
+    // Bake what is not in the previous output yet. Each variant only writes
+    // to itself, so no locking is needed. Every bake uses its own
+    // QShaderBaker, the only state the bakers share is glslang's process-wide
+    // initialization, which happens on the first compilation. That one is
+    // therefore baked on this thread before the others are started.
+    QThreadPool bakePool;
+    if (jobCount > 0)
+        bakePool.setMaxThreadCount(jobCount);
+    int reusedCount = 0;
+    int bakedCount = 0;
+    const auto bake = [cache = shaderCache.get()](ShaderVariant &variant) {
+        variant.valid = cache->bakeForRhi(variant.vertexCode,
+                                          variant.fragmentCode,
+                                          variant.viewCount,
+                                          variant.perTargetCompilation,
+                                          &variant.vertexShader,
+                                          &variant.fragmentShader,
+                                          &variant.errorMessage);
+    };
+    for (auto it = variants.begin(), end = variants.end(); it != end; ++it) {
+        ShaderVariant &variant = it.value();
+        variant.sourceHash = sourceHash(variant.vertexCode, variant.fragmentCode, variant.viewCount, variant.perTargetCompilation);
+        if (previousSourceHashes.value(it.key()) == variant.sourceHash) {
+            QQsbCollection::EntryDesc entryDesc;
+            if (previousQsbc.extractEntry(QQsbCollection::Entry(it.key()), entryDesc)
+                    && entryDesc.vertShader.isValid() && entryDesc.fragShader.isValid()) {
+                variant.vertexShader = entryDesc.vertShader;
+                variant.fragmentShader = entryDesc.fragShader;
+                variant.reused = variant.valid = true;
+                ++reusedCount;
+                continue;
+            }
+        }
+        if (bakedCount++ == 0)
+            bake(variant);
+        else
+            bakePool.start([&variant, &bake] { bake(variant); });
+    }
+    bakePool.waitForDone();
+    const qint64 bakeTime = timer.elapsed();
+
+    int failedCount = 0;
+    QMap<QByteArray, QByteArray> sourceHashes;
+    for (auto it = variants.cbegin(), end = variants.cend(); it != end; ++it) {
+        const ShaderVariant &variant = it.value();
+        if (!variant.valid) {
+            qWarning("%s\n%s\n", qPrintable(variant.errorMessage), variant.materialKey.constData());
+            ++failedCount;
+            continue;
+        }
+        if (!dryRun) {
+            qsbc.addEntry(it.key(), { variant.materialKey, variant.featureSet, variant.vertexShader, variant.fragmentShader });
+            sourceHashes.insert(it.key(), variant.sourceHash);
+        }
+    }
+
+    const int variantCount = int(variants.size());
+    printf("Shader variants: %d, reused: %d (%.1f%%), baked: %d on %d threads, failed: %d. "
+           "Generating took %lld ms, baking %lld ms.\n",
+           variantCount, reusedCount, variantCount > 0 ? 100.0 * reusedCount / variantCount : 0.0,
+           bakedCount, bakePool.maxThreadCount(), failedCount, generateTime, bakeTime);
+
+    if (!dryRun) {
+        const QString sourceHashesFileName = sourceHashesFile(outCollectionFile);
+        if (sourceHashes.isEmpty())
+            QFile::remove(sourceHashesFileName);
+        else if (!writeSourceHashes(sourceHashesFileName, sourceHashes))
+            qWarning("Unable to write %s", qPrintable(sourceHashesFileName));
+    }
+
     if (!qsbc.availableEntries().isEmpty())
         qsbcFiles.push_back(resourceFolderRelative + QDir::separator() + QString::fromLatin1(QSSGShaderCache::shaderCollectionFile()));
     qsbc.unmap();
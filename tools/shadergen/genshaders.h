@@ -25,7 +25,7 @@ struct GenShaders
     explicit GenShaders();
     ~GenShaders();
     bool process(const MaterialParser::SceneData &sceneData, QVector<QString> &qsbcFiles, const QDir &outDir,
-                 bool generateMultipleLights, bool dryRun);
+                 bool generateMultipleLights, bool dryRun, int jobCount = 0);
 
     QRhi *rhi = nullptr;
     std::shared_ptr<QSSGRenderContextInterface> renderContext;
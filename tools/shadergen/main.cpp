@@ -26,13 +26,14 @@ static int generateShaders(QVector<QString> &qsbcFiles,
                            const QDir &outDir,
                            bool multilight,
                            bool verboseOutput,
-                           bool dryRun)
+                           bool dryRun,
+                           int jobCount)
 {
     MaterialParser::SceneData sceneData;
     if (MaterialParser::parseQmlFiles(filePaths, sourceDir, sceneData, verboseOutput) == 0) {
         if (sceneData.hasData()) {
             GenShaders genShaders;
-            if (!genShaders.process(sceneData, qsbcFiles, outDir, multilight, dryRun))
+            if (!genShaders.process(sceneData, qsbcFiles, outDir, multilight, dryRun, jobCount))
                 return -1;
         } else if (verboseOutput) {
             if (!sceneData.viewport)
@@ -135,6 +136,9 @@ int main(int argc, char *argv[])
     QCommandLineOption dirDepthOption(QLatin1String("depth"), QLatin1String("Override default max depth (16) value when traversing the filesystem."), QLatin1String("number"));
     cmdLineparser.addOption(dirDepthOption);
 
+    QCommandLineOption jobsOption({QChar(u'j'), QLatin1String("jobs")}, QLatin1String("Number of threads used for baking shaders (default: one per core)."), QLatin1String("number"));
+    cmdLineparser.addOption(jobsOption);
+
     cmdLineparser.process(a);
 
     if (cmdLineparser.isSet(changeDirOption)) {
@@ -259,11 +263,19 @@ int main(int argc, char *argv[])
     const bool verboseOutput = cmdLineparser.isSet(verboseOutputOption);
     const bool multilight = false;
 
+    int jobCount = 0;
+    if (cmdLineparser.isSet(jobsOption)) {
+        bool ok = false;
+        const int v = cmdLineparser.value(jobsOption).toInt(&ok);
+        if (ok && v > 0)
+            jobCount = v;
+    }
+
     QVector<QString> qsbcFiles;
 
     int ret = 0;
     if (filePaths.size())
-        ret = generateShaders(qsbcFiles, filePaths.values(), QDir::currentPath(), outDir, multilight, verboseOutput, dryRun);
+        ret = generateShaders(qsbcFiles, filePaths.values(), QDir::currentPath(), outDir, multilight, verboseOutput, dryRun, jobCount);
 
     if (ret == 0 && !dryRun)
         writeResourceFile(resourceFile, qsbcFiles, outDir);
@@ -0,0 +1,98 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtGui/QImage>
+
+#include <QtQuick3DRuntimeRender/private/qssgtexturecooker_p.h>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser cmdLineParser;
+    cmdLineParser.setApplicationDescription(
+            "Converts images into textures ready for uploading with Qt Quick 3D, with all their mip levels. "
+            "The result is written next to each image with an additional .ktx extension, where the "
+            "renderer picks it up instead of the image.");
+    cmdLineParser.addHelpOption();
+    QCommandLineOption compressOption({ QStringLiteral("c"), QStringLiteral("compress") },
+                                      QStringLiteral("Block compress to BC1, or BC3 for images with alpha, "
+                                                     "when the width and height are multiples of 4."));
+    cmdLineParser.addOption(compressOption);
+    QCommandLineOption outputDirOption({ QStringLiteral("o"), QStringLiteral("output-dir") },
+                                       QStringLiteral("Write the textures to <dir> instead of next to the images."),
+                                       QStringLiteral("dir"));
+    cmdLineParser.addOption(outputDirOption);
+    cmdLineParser.addPositionalArgument(QStringLiteral("images"), QStringLiteral("The images to cook."));
+    cmdLineParser.process(app);
+
+    const QStringList imageFileNames = cmdLineParser.positionalArguments();
+    if (imageFileNames.isEmpty())
+        cmdLineParser.showHelp(-1);
+
+    const bool compress = cmdLineParser.isSet(compressOption);
+    const QString outputDir = cmdLineParser.value(outputDirOption);
+    if (!outputDir.isEmpty() && !QDir().mkpath(outputDir)) {
+        qWarning("Could not create %s", qPrintable(outputDir));
+        return -1;
+    }
+
+    int failures = 0;
+    for (const QString &imageFileName : imageFileNames) {
+        QFile imageFile(imageFileName);
+        if (!imageFile.open(QIODevice::ReadOnly)) {
+            qWarning("Could not open %s", qPrintable(imageFileName));
+            ++failures;
+            continue;
+        }
+        const QByteArray sourceData = imageFile.readAll();
+
+        QElapsedTimer timer;
+        timer.start();
+        const QImage image = QImage::fromData(sourceData);
+        const qint64 decodeTime = timer.nsecsElapsed();
+        if (image.isNull()) {
+            qWarning("Could not decode %s", qPrintable(imageFileName));
+            ++failures;
+            continue;
+        }
+
+        timer.restart();
+        const QSSGTextureCooker::Result result = QSSGTextureCooker::cook(image, QSSGTextureCooker::sourceKey(sourceData), compress,
+                                                                         QSSGTextureCooker::sourceStamp(imageFileName));
+        const qint64 cookTime = timer.nsecsElapsed();
+        if (result.ktxData.isEmpty()) {
+            qWarning("Could not cook %s", qPrintable(imageFileName));
+            ++failures;
+            continue;
+        }
+
+        QString cookedPath = QSSGTextureCooker::cookedPath(imageFileName);
+        if (!outputDir.isEmpty())
+            cookedPath = QDir(outputDir).filePath(QFileInfo(cookedPath).fileName());
+        QSaveFile cookedFile(cookedPath);
+        if (!cookedFile.open(QIODevice::WriteOnly) || cookedFile.write(result.ktxData) != result.ktxData.size()
+                || !cookedFile.commit()) {
+            qWarning("Could not write %s", qPrintable(cookedPath));
+            ++failures;
+            continue;
+        }
+
+        // The decode time is what loading the image costs at run time on
+        // top of converting it and generating the mipmaps.
+        qInfo("%s: %dx%d, %d levels%s, %lld KiB -> %lld KiB, decoded in %.2f ms, cooked in %.2f ms",
+              qPrintable(cookedPath), image.width(), image.height(), result.levelCount,
+              result.compressed ? ", compressed" : "",
+              qint64(sourceData.size() / 1024), qint64(result.ktxData.size() / 1024),
+              decodeTime / 1000000.0, cookTime / 1000000.0);
+    }
+
+    return failures ? -1 : 0;
+}